@@ -43,10 +43,7 @@ Write-Host "Reinstalando dependências..." -ForegroundColor Yellow
 pio lib uninstall "*"
 pio lib install `
     "knolleary/PubSubClient" `
-    "bblanchon/ArduinoJson" `
-    "adafruit/DHT sensor library" `
-    "adafruit/Adafruit Unified Sensor" `
-    "z3t0/IRremote"
+    "bblanchon/ArduinoJson"
 
 # Reconfigura projeto
 Write-Host "Reconfigurando projeto..." -ForegroundColor Yellow
@@ -4,8 +4,10 @@ Import('env')
 env.Append(CPPPATH=[
     env.get('PROJECT_DIR') + '/include',
     env.get('PROJECT_DIR') + '/lib/AC/include',
+    env.get('PROJECT_DIR') + '/lib/Codec/include',
     env.get('PROJECT_DIR') + '/lib/IR/include',
     env.get('PROJECT_DIR') + '/lib/Network/include',
+    env.get('PROJECT_DIR') + '/lib/Tasks/include',
     env.get('PROJECT_DIR') + '/src'
 ])
 
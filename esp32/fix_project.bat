@@ -33,9 +33,6 @@ echo monitor_speed = 115200>> platformio.ini
 echo lib_deps =>> platformio.ini
 echo     knolleary/PubSubClient@^2.8>> platformio.ini
 echo     bblanchon/ArduinoJson@^6.21.3>> platformio.ini
-echo     adafruit/DHT sensor library@^1.4.4>> platformio.ini
-echo     adafruit/Adafruit Unified Sensor@^1.1.9>> platformio.ini
-echo     z3t0/IRremote@2.6.0>> platformio.ini
 echo build_flags =>> platformio.ini
 echo     -D MQTT_MAX_PACKET_SIZE=1024>> platformio.ini
 echo     -std=gnu++17>> platformio.ini
@@ -3,28 +3,15 @@
 
 #include <Arduino.h>
 #include "IRSender.h"
-#include <DHT.h>
-#include <ArduinoJson.h>
-
-// Modos de operação do ar condicionado
-enum class ACMode {
-    AUTO,
-    COOL,
-    DRY,
-    FAN
-};
-
-// Velocidades do ventilador
-enum class FanSpeed {
-    AUTO,
-    LOW,
-    MEDIUM,
-    HIGH
-};
+#include "ACState.h"
+#include "SensorPipeline.h"
+#include "Thermostat.h"
 
 class ACController {
 public:
-    ACController(uint8_t irPin, uint8_t dhtPin);
+    // Vários aparelhos no mesmo ESP32 (ACUnits) transmitem cada um no seu
+    // canal RMT
+    ACController(uint8_t irPin, uint8_t dhtPin, rmt_channel_t irChannel = RMT_CHANNEL_0);
     void begin();
     void update();
 
@@ -34,30 +21,120 @@ public:
     void setTemperature(uint8_t temp);
     void setMode(ACMode mode);
     void setFanSpeed(FanSpeed speed);
+    void execute(const ACCommand& command);
+
+    // Leva o aparelho ao estado desejado (só os campos em fields) com o
+    // mínimo de quadros IR: nos protocolos de estado completo (Coolix, Gree,
+    // Midea, LG) um único quadro, em NEC um quadro por campo que mudou.
+    // Retorna os campos alterados.
+    uint8_t applyState(const ACSettings& desired, uint8_t fields);
+    // Estado gravado (ACStateStore), no boot: o aparelho já está nele, então
+    // nada vai ao ar; o status completo sai na conexão
+    void restore(const ACSettings& settings);
+    void setProtocol(IRProtocol protocol) { _protocol = protocol; }
+    IRProtocol getProtocol() const { return _protocol; }
+
+    // Os comandos só enfileiram os quadros IR (ver IRSender); updateIR()
+    // os coloca no ar e precisa ser chamado a cada passo do loop/tarefa.
+    // update() já chama.
+    void updateIR();
+    bool irIdle() const { return _irSender.idle(); }
+    const IRSender& irSender() const { return _irSender; }
+
+    // Comando rastreado (ACCommand::trace): updateIR() marca o início do
+    // primeiro quadro depois dele e o fim da fila do IR. finishedTrace() dá
+    // a medida pronta até markTraceReported(); outro comando rastreado antes
+    // disso toma o lugar do anterior.
+    const CommandTiming* finishedTrace() const { return _traceState == TraceState::FINISHED ? &_trace : nullptr; }
+    void markTraceReported() { _traceState = TraceState::NONE; }
+
+    // Sensores: na firmware em tarefas as amostras chegam da tarefa de
+    // sensores por applySample(). Sem ela (laço único), update() amostra o
+    // DHT22 pelo próprio SensorPipeline, iniciado na primeira chamada para
+    // não disputar o pino com SensorSampler.
+    void applySample(const SensorSample& sample);
+    void applyReading(float temperature, float humidity);
+
+    // Termostato local (ver Thermostat): só atua com a política ativa e o
+    // aparelho ligado em REFRIGERAR, trocando o modo enviado entre
+    // REFRIGERAR e VENTILAR. regulate() decide com a última leitura e envia
+    // a correção; update() já chama, a tarefa de controle chama a cada passo.
+    void regulate();
+    // false (e nada muda) se a política resultante for inválida
+    bool setThermostat(const ThermostatPolicy& policy, uint8_t fields);
+    const Thermostat& thermostat() const { return _thermostat; }
+    // Modo que o aparelho recebeu: VENTILAR enquanto o termostato segura o
+    // compressor, senão o modo escolhido
+    ACMode getEffectiveMode() const;
 
     // Estado
     bool isOn() const { return _isOn; }
     float getCurrentTemperature() const { return _currentTemp; }
     float getCurrentHumidity() const { return _currentHumidity; }
+    SensorHealth getTemperatureHealth() const { return _temperatureHealth; }
+    SensorHealth getHumidityHealth() const { return _humidityHealth; }
     uint8_t getTargetTemperature() const { return _targetTemp; }
     ACMode getMode() const { return _mode; }
     FanSpeed getFanSpeed() const { return _fanSpeed; }
 
+    ACStatus getStatus() const;
+    ACSettings getSettings() const;
+
+    // Publicação por alteração: campos (StatusField) mudados desde a última
+    // publicação. Temperatura e umidade só contam como alteradas quando se
+    // afastam do último valor publicado por mais que a banda morta.
+    uint8_t dirtyFields() const { return _dirtyFields; }
+    void markPublished(uint8_t fields);
+    void setDeadbands(float temperatureC, float humidityPct);
+
     // MQTT
-    String getStatusJson() const;
+    // Escreve o status JSON em buf sem alocar; retorna o comprimento ou 0
+    size_t serializeStatus(char* buf, size_t cap) const;
+    // O mesmo na codificação pedida (ver WireFormat)
+    size_t serializeStatus(WireFormat format, uint8_t* buf, size_t cap) const;
 
 private:
     IRSender _irSender;
-    DHT _dht;
+    SensorPipeline _sensors;
+    bool _sensorsStarted;
     bool _isOn;
     float _currentTemp;
     float _currentHumidity;
     uint8_t _targetTemp;
     ACMode _mode;
     FanSpeed _fanSpeed;
-    unsigned long _lastSensorUpdate;
+    IRProtocol _protocol;
+    SensorHealth _temperatureHealth;
+    SensorHealth _humidityHealth;
+    SensorStats _temperatureStats;
+    SensorStats _humidityStats;
+    bool _hasTemperature;
+
+    Thermostat _thermostat;
+    bool _thermostatCalling;    // último valor de "demanda" no status
+    ACMode _sentMode;           // último modo efetivo transmitido
+
+    enum class TraceState : uint8_t {
+        NONE,
+        RUNNING,
+        FINISHED
+    };
+    CommandTiming _trace;
+    TraceState _traceState;
+    uint32_t _traceFrames;      // framesSent() quando o comando chegou
+
+    uint8_t _dirtyFields;
+    float _reportedTemp;
+    float _reportedHumidity;
+    float _tempDeadband;
+    float _humidityDeadband;
 
-    void readSensors();
+    bool regulating() const;
+    void decide();
+    ACSettings transmittedSettings() const;
+    void transmit(uint8_t fields);
+    void sendCode(uint32_t code, IRSlot slot) { _irSender.sendNECCommand(code >> 16, code & 0xFFFF, slot); }
+    void markDirty(uint8_t fields) { _dirtyFields |= fields; }
 };
 
 #endif // AC_CONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef AC_STATE_STORE_H
+#define AC_STATE_STORE_H
+
+#include <Arduino.h>
+#include "ACState.h"
+#include "ACUnits.h"
+#include "config.h"
+
+// Último estado de cada aparelho na NVS. Depois de uma queda de energia o
+// ESP32 volta com o estado gravado (ACController::restore) e o status retido
+// sai certo na conexão, em vez de "desligado, 23 °C" até o próximo comando.
+//
+// Mudanças seguidas (o usuário subindo o setpoint grau a grau) viram uma
+// gravação só, STATE_SAVE_QUIET depois da última ou no máximo
+// STATE_SAVE_MAX_DELAY depois da primeira; voltar ao estado gravado não
+// grava nada. Cada registro é um inteiro de 64 bits, que na NVS ocupa uma
+// entrada de 32 bytes (um blob do mesmo tamanho ocuparia três). O rodízio
+// contra o desgaste é o da própria NVS: cada gravação é uma entrada nova
+// no fim da página ativa e as páginas são apagadas em sequência.
+//
+// Uso de uma tarefa só (a de rede), como a agenda.
+class ACStateStore {
+public:
+    ACStateStore();
+
+    // Lê os registros gravados; chamar antes de restaurar os aparelhos
+    void begin();
+    // false sem registro (primeiro boot) ou com registro inválido
+    bool stored(uint8_t unit, ACSettings& settings) const;
+
+    // Estado atual da unidade; barato, chamar a cada passo
+    void note(uint8_t unit, const ACSettings& settings);
+    // Grava os registros vencidos; true se gravou algum
+    bool poll();
+    // Grava já tudo o que estiver pendente (antes de reiniciar)
+    bool flush();
+    bool pending() const;
+
+    uint32_t writes() const { return _writes; }
+    uint32_t failures() const { return _failures; }
+
+    static uint64_t pack(const ACSettings& settings);
+    static bool unpack(uint64_t record, ACSettings& settings);
+
+private:
+    struct Slot {
+        ACSettings stored;
+        ACSettings pending;
+        bool hasStored;
+        bool dirty;
+        unsigned long firstChange;
+        unsigned long lastChange;
+    };
+
+    bool save(uint8_t unit);
+
+    Slot _slots[AC_MAX_UNITS];
+    uint32_t _writes;
+    uint32_t _failures;
+};
+
+#endif // AC_STATE_STORE_H
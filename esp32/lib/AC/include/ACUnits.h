@@ -0,0 +1,47 @@
+#ifndef AC_UNITS_H
+#define AC_UNITS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include "ACController.h"
+
+// Canais RMT dos LEDs IR, um por aparelho. O transmissor ocupa dois blocos
+// de memória (canal e canal + 1) e o DHT22 recebe no canal 4, então cabem
+// três aparelhos por ESP32.
+constexpr rmt_channel_t AC_UNIT_IR_CHANNELS[] = {RMT_CHANNEL_0, RMT_CHANNEL_2, RMT_CHANNEL_6};
+constexpr size_t AC_MAX_UNITS = sizeof(AC_UNIT_IR_CHANNELS) / sizeof(AC_UNIT_IR_CHANNELS[0]);
+
+// Aparelhos de um mesmo ESP32 (salas grandes, com duas ou três
+// evaporadoras): N controladores num array de tamanho fixo, sem heap, cada
+// um com o seu LED IR. O DHT22 é o da sala; a tarefa de controle aplica
+// cada leitura a todos (ControlLoop). Só a tarefa de controle os toca.
+template <size_t N>
+class ACUnits {
+    static_assert(N >= 1 && N <= AC_MAX_UNITS, "de 1 a 3 aparelhos por ESP32 (canais RMT)");
+
+public:
+    // irPins: um pino por aparelho, na ordem das unidades
+    ACUnits(const uint8_t* irPins, uint8_t dhtPin)
+        : ACUnits(irPins, dhtPin, std::make_index_sequence<N>()) {
+    }
+
+    void begin() {
+        for (ACController& unit : _units) unit.begin();
+    }
+
+    ACController& operator[](size_t index) { return _units[index]; }
+    const ACController& operator[](size_t index) const { return _units[index]; }
+    ACController* data() { return _units; }
+    static constexpr uint8_t size() { return uint8_t(N); }
+
+private:
+    template <size_t... I>
+    ACUnits(const uint8_t* irPins, uint8_t dhtPin, std::index_sequence<I...>)
+        : _units{ACController(irPins[I], dhtPin, AC_UNIT_IR_CHANNELS[I])...} {
+    }
+
+    ACController _units[N];
+};
+
+#endif // AC_UNITS_H
@@ -0,0 +1,44 @@
+#ifndef THERMOSTAT_H
+#define THERMOSTAT_H
+
+#include <stdint.h>
+#include "ACState.h"
+
+// Controle liga/desliga do compressor com histerese: chama acima de
+// setpoint + banda/2 e libera abaixo de setpoint - banda/2. Uma troca só
+// acontece depois do tempo mínimo no estado atual, contado da última troca,
+// mesmo que ela tenha vindo de fora (aparelho ligado/desligado à mão).
+// Sem leitura válida devolve o controle ao aparelho (compressor chamado).
+// Não lê relógio nem sensor: tudo entra por parâmetro, então é determinístico.
+class Thermostat {
+public:
+    Thermostat();
+
+    // Aplica só os campos presentes (ThermostatField); false se o resultado
+    // for inválido, e nesse caso nada muda
+    bool setPolicy(const ThermostatPolicy& policy, uint8_t fields);
+    const ThermostatPolicy& policy() const { return _policy; }
+    bool enabled() const { return _policy.enabled; }
+
+    // Decide com a leitura atual; true se a chamada do compressor mudou
+    bool update(float temperature, bool valid, uint8_t setpoint, uint32_t nowMs);
+    // Fora do controle local: registra o estado real do compressor para que
+    // os tempos mínimos valham também na volta
+    void follow(bool compressorOn, uint32_t nowMs);
+
+    bool demand() const { return _demand; }
+    uint8_t clampSetpoint(uint8_t setpoint) const;
+    // Partidas do compressor desde o boot
+    uint32_t starts() const { return _starts; }
+
+private:
+    void set(bool demand, uint32_t nowMs);
+
+    ThermostatPolicy _policy;
+    bool _demand;
+    bool _switched;             // houve troca: os tempos mínimos valem
+    uint32_t _lastSwitchMs;
+    uint32_t _starts;
+};
+
+#endif // THERMOSTAT_H
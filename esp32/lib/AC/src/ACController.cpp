@@ -1,160 +1,389 @@
 #include "ACController.h"
-#include <ArduinoJson.h>
-#include "../../src/config.h"
+#include "StatusCodec.h"
+#include "Metrics.h"
+#include "config.h"
 
-ACController::ACController(uint8_t irPin, uint8_t dhtPin)
-    : _irSender(irPin),
-      _dht(dhtPin, DHT22),
+ACController::ACController(uint8_t irPin, uint8_t dhtPin, rmt_channel_t irChannel)
+    : _irSender(irPin, irChannel),
+      _sensors(dhtPin),
+      _sensorsStarted(false),
       _isOn(false),
       _currentTemp(0.0f),
       _currentHumidity(0.0f),
       _targetTemp(23),
       _mode(ACMode::AUTO),
       _fanSpeed(FanSpeed::AUTO),
-      _lastSensorUpdate(0)
+      _protocol(irProtocolFromName(AC_IR_PROTOCOL)),
+      _temperatureHealth(SensorHealth::UNKNOWN),
+      _humidityHealth(SensorHealth::UNKNOWN),
+      _temperatureStats{NAN, NAN, NAN, 0},
+      _humidityStats{NAN, NAN, NAN, 0},
+      _hasTemperature(false),
+      _thermostatCalling(false),
+      _sentMode(ACMode::AUTO),
+      _traceState(TraceState::NONE),
+      _traceFrames(0),
+      _dirtyFields(STATUS_FIELD_ALL),
+      _reportedTemp(0.0f),
+      _reportedHumidity(0.0f),
+      _tempDeadband(STATUS_TEMP_DEADBAND),
+      _humidityDeadband(STATUS_HUMIDITY_DEADBAND)
 {
 }
 
 void ACController::begin() {
     _irSender.begin();
-    _dht.begin();
 }
 
 void ACController::update() {
-    unsigned long now = millis();
-    if (now - _lastSensorUpdate >= 2000) { // Atualiza a cada 2 segundos
-        readSensors();
-        _lastSensorUpdate = now;
+    updateIR();
+
+    if (!_sensorsStarted) {
+        _sensors.begin();
+        _sensorsStarted = true;
+    }
+    if (_sensors.step()) {
+        applySample(_sensors.sample());
+    }
+    regulate();
+}
+
+void ACController::updateIR() {
+    _irSender.poll();
+    if (_traceState != TraceState::RUNNING) return;
+
+    // Quadros saem com FRAME_GAP_MS entre eles: entre dois poll() começa no
+    // máximo um, então o último início é o do primeiro depois do comando
+    if (!_trace.transmitted && _irSender.framesSent() != _traceFrames) {
+        _trace.transmitted = true;
+        _trace.irStartUs = uint32_t(_irSender.lastFrameStartUs());
+    }
+    if (_irSender.idle()) {
+        _trace.irDoneUs = uint32_t(micros());
+        _traceState = TraceState::FINISHED;
+    }
+}
+
+void ACController::applySample(const SensorSample& sample) {
+    applyReading(sample.temperature, sample.humidity);
+    if (sample.temperatureHealth != _temperatureHealth || sample.humidityHealth != _humidityHealth) {
+        _temperatureHealth = sample.temperatureHealth;
+        _humidityHealth = sample.humidityHealth;
+        markDirty(STATUS_FIELD_SENSOR);
+    }
+    // As estatísticas seguem no próximo status completo, sem forçá-lo
+    if (sample.windowClosed) {
+        _temperatureStats = sample.temperatureStats;
+        _humidityStats = sample.humidityStats;
     }
 }
 
-void ACController::readSensors() {
-    float temp = _dht.readTemperature();
-    float humidity = _dht.readHumidity();
-    
+void ACController::applyReading(float temp, float humidity) {
     if (!isnan(temp)) {
         _currentTemp = temp;
+        _hasTemperature = true;
+        float delta = fabsf(temp - _reportedTemp);
+        if (delta > 0.0f && delta >= _tempDeadband) {
+            markDirty(STATUS_FIELD_CURRENT_TEMP);
+        }
     }
     if (!isnan(humidity)) {
         _currentHumidity = humidity;
+        float delta = fabsf(humidity - _reportedHumidity);
+        if (delta > 0.0f && delta >= _humidityDeadband) {
+            markDirty(STATUS_FIELD_HUMIDITY);
+        }
+    }
+}
+
+void ACController::markPublished(uint8_t fields) {
+    if (fields & STATUS_FIELD_CURRENT_TEMP) {
+        _reportedTemp = _currentTemp;
+    }
+    if (fields & STATUS_FIELD_HUMIDITY) {
+        _reportedHumidity = _currentHumidity;
+    }
+    _dirtyFields &= ~fields;
+}
+
+void ACController::setDeadbands(float temperatureC, float humidityPct) {
+    _tempDeadband = temperatureC;
+    _humidityDeadband = humidityPct;
+}
+
+bool ACController::regulating() const {
+    return _thermostat.enabled() && _isOn && _mode == ACMode::COOL;
+}
+
+ACMode ACController::getEffectiveMode() const {
+    return regulating() && !_thermostat.demand() ? ACMode::FAN : _mode;
+}
+
+// Reavalia o termostato com o estado atual, sem transmitir
+void ACController::decide() {
+    uint32_t now = millis();
+    if (regulating()) {
+        bool valid = _hasTemperature && _temperatureHealth != SensorHealth::FAILED;
+        _thermostat.update(_currentTemp, valid, _targetTemp, now);
+    } else {
+        // VENTILAR é o único modo sem compressor
+        _thermostat.follow(_isOn && _mode != ACMode::FAN, now);
+    }
+    bool calling = regulating() && _thermostat.demand();
+    if (calling != _thermostatCalling) {
+        _thermostatCalling = calling;
+        markDirty(STATUS_FIELD_THERMOSTAT);
+    }
+}
+
+void ACController::regulate() {
+    decide();
+    // Só vai ao ar se o modo efetivo mudou (ver transmit)
+    transmit(0);
+}
+
+bool ACController::setThermostat(const ThermostatPolicy& policy, uint8_t fields) {
+    bool wasEnabled = _thermostat.enabled();
+    if (!_thermostat.setPolicy(policy, fields)) return false;
+    if (_thermostat.enabled() != wasEnabled) {
+        markDirty(STATUS_FIELD_THERMOSTAT);
     }
+    regulate();
+    return true;
 }
 
 void ACController::turnOn() {
     if (!_isOn) {
         _isOn = true;
-        _irSender.sendNECCommand(IRCodes::POWER_ON >> 16, IRCodes::POWER_ON & 0xFFFF);
+        decide();
+        markDirty(STATUS_FIELD_POWER);
+        transmit(STATUS_FIELD_POWER);
     }
 }
 
 void ACController::turnOff() {
     if (_isOn) {
         _isOn = false;
-        _irSender.sendNECCommand(IRCodes::POWER_OFF >> 16, IRCodes::POWER_OFF & 0xFFFF);
+        decide();
+        markDirty(STATUS_FIELD_POWER);
+        transmit(STATUS_FIELD_POWER);
     }
 }
 
 void ACController::setTemperature(uint8_t temp) {
     if (temp >= 16 && temp <= 30) {
+        if (temp != _targetTemp) {
+            markDirty(STATUS_FIELD_TARGET_TEMP);
+        }
         _targetTemp = temp;
+        decide();
         if (_isOn) {
-            uint32_t cmd = IRCodes::TEMP_BASE + (temp - 16);
-            _irSender.sendNECCommand(cmd >> 16, cmd & 0xFFFF);
+            transmit(STATUS_FIELD_TARGET_TEMP);
         }
     }
 }
 
 void ACController::setMode(ACMode mode) {
+    if (mode != _mode) {
+        markDirty(STATUS_FIELD_MODE);
+    }
     _mode = mode;
+    decide();
+    if (_isOn) {
+        transmit(STATUS_FIELD_MODE);
+    }
+}
+
+void ACController::setFanSpeed(FanSpeed speed) {
+    if (speed != _fanSpeed) {
+        markDirty(STATUS_FIELD_FAN_SPEED);
+    }
+    _fanSpeed = speed;
     if (_isOn) {
-        uint32_t cmd;
-        switch (mode) {
+        transmit(STATUS_FIELD_FAN_SPEED);
+    }
+}
+
+uint8_t ACController::applyState(const ACSettings& desired, uint8_t fields) {
+    uint8_t changed = 0;
+    if ((fields & STATUS_FIELD_POWER) && desired.isOn != _isOn) {
+        _isOn = desired.isOn;
+        changed |= STATUS_FIELD_POWER;
+    }
+    if ((fields & STATUS_FIELD_TARGET_TEMP) && desired.targetTemp >= 16 && desired.targetTemp <= 30
+        && desired.targetTemp != _targetTemp) {
+        _targetTemp = desired.targetTemp;
+        changed |= STATUS_FIELD_TARGET_TEMP;
+    }
+    if ((fields & STATUS_FIELD_MODE) && desired.mode != _mode) {
+        _mode = desired.mode;
+        changed |= STATUS_FIELD_MODE;
+    }
+    if ((fields & STATUS_FIELD_FAN_SPEED) && desired.fanSpeed != _fanSpeed) {
+        _fanSpeed = desired.fanSpeed;
+        changed |= STATUS_FIELD_FAN_SPEED;
+    }
+
+    markDirty(changed);
+    decide();
+    // Desligado, só a mudança de energia vai ao ar; o resto fica guardado
+    if (_isOn || (changed & STATUS_FIELD_POWER)) {
+        transmit(changed);
+    }
+    return changed;
+}
+
+void ACController::restore(const ACSettings& settings) {
+    _isOn = settings.isOn;
+    if (settings.targetTemp >= 16 && settings.targetTemp <= 30) {
+        _targetTemp = settings.targetTemp;
+    }
+    _mode = settings.mode;
+    _fanSpeed = settings.fanSpeed;
+    decide();
+    _sentMode = getEffectiveMode();
+    markDirty(STATUS_FIELD_ALL);
+}
+
+ACSettings ACController::transmittedSettings() const {
+    ACSettings settings = getSettings();
+    settings.mode = getEffectiveMode();
+    return settings;
+}
+
+// Envia ao aparelho os campos indicados do estado atual, mais o modo se o
+// termostato o trocou desde o último envio
+void ACController::transmit(uint8_t fields) {
+    ACMode effective = getEffectiveMode();
+    if (_isOn && effective != _sentMode) {
+        fields |= STATUS_FIELD_MODE;
+    }
+    if (!fields) return;
+
+    // Protocolos de estado completo: um quadro com tudo, seja qual for o campo
+    const IREncoder* encoder = irEncoderFor(_protocol);
+    if (encoder) {
+        _irSender.sendState(*encoder, transmittedSettings());
+        _sentMode = effective;
+        return;
+    }
+
+    if (fields & STATUS_FIELD_POWER) {
+        sendCode(_isOn ? IRCodes::POWER_ON : IRCodes::POWER_OFF, IRSlot::POWER);
+    }
+    if (!_isOn) return;
+
+    if (fields & STATUS_FIELD_TARGET_TEMP) {
+        sendCode(IRCodes::TEMP_BASE + (_targetTemp - 16), IRSlot::TEMPERATURE);
+    }
+    if (fields & STATUS_FIELD_MODE) {
+        _sentMode = effective;
+        switch (effective) {
             case ACMode::COOL:
-                cmd = IRCodes::MODE_COOL;
+                sendCode(IRCodes::MODE_COOL, IRSlot::MODE);
                 break;
             case ACMode::DRY:
-                return; // Modo DRY não implementado no exemplo
+                break; // Modo DRY não implementado no exemplo
             case ACMode::FAN:
-                cmd = IRCodes::MODE_FAN;
+                sendCode(IRCodes::MODE_FAN, IRSlot::MODE);
                 break;
             case ACMode::AUTO:
             default:
-                cmd = IRCodes::MODE_AUTO;
+                sendCode(IRCodes::MODE_AUTO, IRSlot::MODE);
                 break;
         }
-        _irSender.sendNECCommand(cmd >> 16, cmd & 0xFFFF);
     }
-}
-
-void ACController::setFanSpeed(FanSpeed speed) {
-    _fanSpeed = speed;
-    if (_isOn) {
-        uint32_t cmd;
-        switch (speed) {
-            case FanSpeed::LOW:
-                cmd = IRCodes::FAN_LOW;
+    if (fields & STATUS_FIELD_FAN_SPEED) {
+        switch (_fanSpeed) {
+            case FanSpeed::SLOW:
+                sendCode(IRCodes::FAN_LOW, IRSlot::FAN_SPEED);
                 break;
             case FanSpeed::MEDIUM:
-                cmd = IRCodes::FAN_MED;
+                sendCode(IRCodes::FAN_MED, IRSlot::FAN_SPEED);
                 break;
-            case FanSpeed::HIGH:
-                cmd = IRCodes::FAN_HIGH;
+            case FanSpeed::FAST:
+                sendCode(IRCodes::FAN_HIGH, IRSlot::FAN_SPEED);
                 break;
             case FanSpeed::AUTO:
             default:
-                cmd = IRCodes::FAN_AUTO;
+                sendCode(IRCodes::FAN_AUTO, IRSlot::FAN_SPEED);
                 break;
         }
-        _irSender.sendNECCommand(cmd >> 16, cmd & 0xFFFF);
-    }
-}
-
-String ACController::getStatusJson() const {
-    StaticJsonDocument<200> doc;
-    
-    doc["online"] = true;
-    doc["ligado"] = _isOn;
-    doc["temperaturaAtual"] = _currentTemp;
-    doc["umidade"] = _currentHumidity;
-    doc["temperaturaDesejada"] = _targetTemp;
-    
-    const char* modeStr;
-    switch (_mode) {
-        case ACMode::COOL:
-            modeStr = "REFRIGERAR";
+    }
+}
+
+void ACController::execute(const ACCommand& command) {
+    Metrics::Timer timer(Metrics::Latency::COMMAND_EXECUTE);
+    if (command.trace) {
+        _trace = CommandTiming{};
+        _trace.trace = command.trace;
+        _traceFrames = _irSender.framesSent();
+        _traceState = TraceState::RUNNING;
+    }
+    switch (command.type) {
+        case ACCommandType::TURN_ON:
+            turnOn();
             break;
-        case ACMode::DRY:
-            modeStr = "DESUMIDIFICAR";
+        case ACCommandType::TURN_OFF:
+            turnOff();
             break;
-        case ACMode::FAN:
-            modeStr = "VENTILAR";
+        case ACCommandType::SET_TEMPERATURE:
+            setTemperature(command.value);
             break;
-        case ACMode::AUTO:
-        default:
-            modeStr = "AUTOMATICO";
+        case ACCommandType::SET_MODE:
+            setMode(ACMode(command.value));
             break;
-    }
-    doc["modoOperacao"] = modeStr;
-
-    const char* fanStr;
-    switch (_fanSpeed) {
-        case FanSpeed::LOW:
-            fanStr = "BAIXA";
+        case ACCommandType::SET_FAN_SPEED:
+            setFanSpeed(FanSpeed(command.value));
             break;
-        case FanSpeed::MEDIUM:
-            fanStr = "MEDIA";
+        case ACCommandType::SET_STATE:
+            applyState(command.settings, command.fields);
             break;
-        case FanSpeed::HIGH:
-            fanStr = "ALTA";
+        case ACCommandType::SET_THERMOSTAT:
+            setThermostat(command.policy, command.fields);
             break;
-        case FanSpeed::AUTO:
-        default:
-            fanStr = "AUTOMATICO";
+        case ACCommandType::SET_SCHEDULE:
+        case ACCommandType::SET_FORMAT:
+        case ACCommandType::OTA_OFFER:
+        case ACCommandType::LEARN_IR:
+        case ACCommandType::UPLOAD_RECORDING:
+            // Tratados pela tarefa de rede; nada a fazer aqui
             break;
     }
-    doc["velocidadeVentilador"] = fanStr;
+}
+
+ACStatus ACController::getStatus() const {
+    ACStatus status;
+    status.isOn = _isOn;
+    status.currentTemp = _currentTemp;
+    status.currentHumidity = _currentHumidity;
+    status.targetTemp = _targetTemp;
+    status.mode = _mode;
+    status.fanSpeed = _fanSpeed;
+    status.temperatureHealth = _temperatureHealth;
+    status.humidityHealth = _humidityHealth;
+    status.temperatureStats = _temperatureStats;
+    status.humidityStats = _humidityStats;
+    status.thermostatEnabled = _thermostat.enabled();
+    status.thermostatDemand = _thermostatCalling;
+    return status;
+}
 
-    String output;
-    serializeJson(doc, output);
-    return output;
-}
\ No newline at end of file
+ACSettings ACController::getSettings() const {
+    ACSettings settings;
+    settings.isOn = _isOn;
+    settings.targetTemp = _targetTemp;
+    settings.mode = _mode;
+    settings.fanSpeed = _fanSpeed;
+    return settings;
+}
+
+size_t ACController::serializeStatus(char* buf, size_t cap) const {
+    return serializeStatusJson(getStatus(), buf, cap);
+}
+
+size_t ACController::serializeStatus(WireFormat format, uint8_t* buf, size_t cap) const {
+    ACStatus status = getStatus();
+    status.wireFormat = format;
+    return ::serializeStatus(status, format, buf, cap);
+}
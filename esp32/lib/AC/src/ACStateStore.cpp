@@ -0,0 +1,139 @@
+#include "ACStateStore.h"
+#include <Preferences.h>
+#include "HeapGuard.h"
+
+namespace {
+
+// Registro (bytes do menos significativo): versão, ligado, temperatura,
+// modo, velocidade; o resto é zero. A NVS já confere cada entrada por CRC.
+const uint8_t RECORD_VERSION = 1;
+const char* const NVS_KEYS[] = {"unidade0", "unidade1", "unidade2"};
+static_assert(sizeof(NVS_KEYS) / sizeof(NVS_KEYS[0]) == AC_MAX_UNITS, "uma chave por unidade");
+
+bool sameSettings(const ACSettings& a, const ACSettings& b) {
+    return a.isOn == b.isOn && a.targetTemp == b.targetTemp && a.mode == b.mode && a.fanSpeed == b.fanSpeed;
+}
+
+}  // namespace
+
+ACStateStore::ACStateStore()
+    : _slots{},
+      _writes(0),
+      _failures(0) {
+}
+
+void ACStateStore::begin() {
+    for (Slot& slot : _slots) slot = Slot{};
+
+    Preferences nvs;
+    if (!nvs.begin(STATE_NVS_NAMESPACE, true)) return;
+    for (uint8_t i = 0; i < AC_MAX_UNITS; i++) {
+        if (!nvs.isKey(NVS_KEYS[i])) continue;
+        Slot& slot = _slots[i];
+        slot.hasStored = unpack(nvs.getULong64(NVS_KEYS[i]), slot.stored);
+        if (!slot.hasStored) {
+            Serial.println("Estado gravado inválido; ignorado");
+        }
+    }
+    nvs.end();
+}
+
+bool ACStateStore::stored(uint8_t unit, ACSettings& settings) const {
+    if (unit >= AC_MAX_UNITS || !_slots[unit].hasStored) return false;
+    settings = _slots[unit].stored;
+    return true;
+}
+
+void ACStateStore::note(uint8_t unit, const ACSettings& settings) {
+    if (unit >= AC_MAX_UNITS) return;
+    Slot& slot = _slots[unit];
+    if (slot.hasStored && sameSettings(settings, slot.stored)) {
+        // Voltou ao que já está gravado antes do prazo: nada a gravar
+        slot.dirty = false;
+        return;
+    }
+    if (slot.dirty && sameSettings(settings, slot.pending)) return;
+
+    unsigned long now = millis();
+    slot.pending = settings;
+    slot.lastChange = now;
+    if (!slot.dirty) {
+        slot.dirty = true;
+        slot.firstChange = now;
+    }
+}
+
+bool ACStateStore::poll() {
+    unsigned long now = millis();
+    bool saved = false;
+    for (uint8_t i = 0; i < AC_MAX_UNITS; i++) {
+        const Slot& slot = _slots[i];
+        if (!slot.dirty) continue;
+        if (now - slot.lastChange >= STATE_SAVE_QUIET || now - slot.firstChange >= STATE_SAVE_MAX_DELAY) {
+            saved |= save(i);
+        }
+    }
+    return saved;
+}
+
+bool ACStateStore::flush() {
+    bool ok = true;
+    for (uint8_t i = 0; i < AC_MAX_UNITS; i++) {
+        if (_slots[i].dirty) ok &= save(i);
+    }
+    return ok;
+}
+
+bool ACStateStore::pending() const {
+    for (const Slot& slot : _slots) {
+        if (slot.dirty) return true;
+    }
+    return false;
+}
+
+bool ACStateStore::save(uint8_t unit) {
+    Slot& slot = _slots[unit];
+    // Abrir a NVS aloca dentro do ESP-IDF
+    HeapGuard::Vendor vendor;
+    Preferences nvs;
+    bool stored = nvs.begin(STATE_NVS_NAMESPACE, false)
+        && nvs.putULong64(NVS_KEYS[unit], pack(slot.pending)) == sizeof(uint64_t);
+    nvs.end();
+    if (!stored) {
+        // Tenta de novo depois de mais um intervalo, sem martelar a flash
+        _failures++;
+        slot.lastChange = millis();
+        slot.firstChange = slot.lastChange;
+        return false;
+    }
+    _writes++;
+    slot.stored = slot.pending;
+    slot.hasStored = true;
+    slot.dirty = false;
+    return true;
+}
+
+uint64_t ACStateStore::pack(const ACSettings& settings) {
+    return uint64_t(RECORD_VERSION)
+        | uint64_t(settings.isOn ? 1 : 0) << 8
+        | uint64_t(settings.targetTemp) << 16
+        | uint64_t(settings.mode) << 24
+        | uint64_t(settings.fanSpeed) << 32;
+}
+
+bool ACStateStore::unpack(uint64_t record, ACSettings& settings) {
+    uint8_t version = uint8_t(record);
+    uint8_t on = uint8_t(record >> 8);
+    uint8_t temp = uint8_t(record >> 16);
+    uint8_t mode = uint8_t(record >> 24);
+    uint8_t fan = uint8_t(record >> 32);
+    if (version != RECORD_VERSION || on > 1 || temp < 16 || temp > 30 || mode >= AC_MODE_COUNT
+        || fan >= FAN_SPEED_COUNT || record >> 40) {
+        return false;
+    }
+    settings.isOn = on;
+    settings.targetTemp = temp;
+    settings.mode = ACMode(mode);
+    settings.fanSpeed = FanSpeed(fan);
+    return true;
+}
@@ -0,0 +1,67 @@
+#include "Thermostat.h"
+#include "config.h"
+
+Thermostat::Thermostat()
+    : _policy{THERMOSTAT_ENABLED, THERMOSTAT_HYSTERESIS, THERMOSTAT_MIN_ON, THERMOSTAT_MIN_OFF,
+              THERMOSTAT_TEMP_MIN, THERMOSTAT_TEMP_MAX},
+      _demand(false),
+      _switched(false),
+      _lastSwitchMs(0),
+      _starts(0) {
+}
+
+bool Thermostat::setPolicy(const ThermostatPolicy& policy, uint8_t fields) {
+    ThermostatPolicy next = _policy;
+    if (fields & THERMOSTAT_FIELD_ENABLED) next.enabled = policy.enabled;
+    if (fields & THERMOSTAT_FIELD_HYSTERESIS) next.hysteresis = policy.hysteresis;
+    if (fields & THERMOSTAT_FIELD_MIN_ON) next.minOnSeconds = policy.minOnSeconds;
+    if (fields & THERMOSTAT_FIELD_MIN_OFF) next.minOffSeconds = policy.minOffSeconds;
+    if (fields & THERMOSTAT_FIELD_MIN_TEMP) next.minTemp = policy.minTemp;
+    if (fields & THERMOSTAT_FIELD_MAX_TEMP) next.maxTemp = policy.maxTemp;
+
+    if (next.hysteresis == 0 || next.minTemp < 16 || next.maxTemp > 30 || next.minTemp > next.maxTemp) {
+        return false;
+    }
+    _policy = next;
+    return true;
+}
+
+uint8_t Thermostat::clampSetpoint(uint8_t setpoint) const {
+    if (setpoint < _policy.minTemp) return _policy.minTemp;
+    if (setpoint > _policy.maxTemp) return _policy.maxTemp;
+    return setpoint;
+}
+
+bool Thermostat::update(float temperature, bool valid, uint8_t setpoint, uint32_t nowMs) {
+    bool want = _demand;
+    if (!valid) {
+        want = true;
+    } else {
+        float half = float(_policy.hysteresis) / 20.0f;
+        float target = float(clampSetpoint(setpoint));
+        if (temperature >= target + half) {
+            want = true;
+        } else if (temperature <= target - half) {
+            want = false;
+        }
+    }
+    if (want == _demand) return false;
+
+    uint32_t minimumMs = uint32_t(_demand ? _policy.minOnSeconds : _policy.minOffSeconds) * 1000UL;
+    if (_switched && nowMs - _lastSwitchMs < minimumMs) return false;
+    set(want, nowMs);
+    return true;
+}
+
+void Thermostat::follow(bool compressorOn, uint32_t nowMs) {
+    if (compressorOn != _demand) {
+        set(compressorOn, nowMs);
+    }
+}
+
+void Thermostat::set(bool demand, uint32_t nowMs) {
+    _demand = demand;
+    _switched = true;
+    _lastSwitchMs = nowMs;
+    if (demand) _starts++;
+}
@@ -0,0 +1,238 @@
+#ifndef AC_STATE_H
+#define AC_STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Modos de operação do ar condicionado
+enum class ACMode : uint8_t {
+    AUTO,
+    COOL,
+    DRY,
+    FAN
+};
+
+// Velocidades do ventilador
+enum class FanSpeed : uint8_t {
+    AUTO,
+    SLOW,
+    MEDIUM,
+    FAST
+};
+
+// Nomes usados no protocolo MQTT (ver MQTT.md), na ordem dos enums
+constexpr const char* AC_MODE_NAMES[] = {
+    "AUTOMATICO",
+    "REFRIGERAR",
+    "DESUMIDIFICAR",
+    "VENTILAR"
+};
+
+constexpr const char* FAN_SPEED_NAMES[] = {
+    "AUTOMATICO",
+    "BAIXA",
+    "MEDIA",
+    "ALTA"
+};
+
+constexpr size_t AC_MODE_COUNT = sizeof(AC_MODE_NAMES) / sizeof(AC_MODE_NAMES[0]);
+constexpr size_t FAN_SPEED_COUNT = sizeof(FAN_SPEED_NAMES) / sizeof(FAN_SPEED_NAMES[0]);
+
+static_assert(AC_MODE_COUNT == size_t(ACMode::FAN) + 1, "AC_MODE_NAMES fora de sincronia com ACMode");
+static_assert(FAN_SPEED_COUNT == size_t(FanSpeed::FAST) + 1, "FAN_SPEED_NAMES fora de sincronia com FanSpeed");
+
+constexpr const char* acModeName(ACMode mode) {
+    return size_t(mode) < AC_MODE_COUNT ? AC_MODE_NAMES[size_t(mode)] : AC_MODE_NAMES[0];
+}
+
+constexpr const char* fanSpeedName(FanSpeed speed) {
+    return size_t(speed) < FAN_SPEED_COUNT ? FAN_SPEED_NAMES[size_t(speed)] : FAN_SPEED_NAMES[0];
+}
+
+constexpr bool namesEqual(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// Nome do protocolo -> enum; nomes desconhecidos viram AUTOMATICO, como nos
+// comandos MODO_OPERACAO e VELOCIDADE
+constexpr ACMode acModeFromName(const char* name) {
+    for (size_t i = 0; name && i < AC_MODE_COUNT; i++) {
+        if (namesEqual(name, AC_MODE_NAMES[i])) return ACMode(i);
+    }
+    return ACMode::AUTO;
+}
+
+constexpr FanSpeed fanSpeedFromName(const char* name) {
+    for (size_t i = 0; name && i < FAN_SPEED_COUNT; i++) {
+        if (namesEqual(name, FAN_SPEED_NAMES[i])) return FanSpeed(i);
+    }
+    return FanSpeed::AUTO;
+}
+
+// Saúde de cada grandeza do sensor, publicada em "sensorStatus"
+enum class SensorHealth : uint8_t {
+    UNKNOWN,    // nenhuma leitura tentada ainda
+    OK,
+    DEGRADED,   // alguma das últimas 8 leituras falhou
+    FAILED      // SENSOR_FAIL_AFTER leituras seguidas inválidas
+};
+
+constexpr const char* SENSOR_HEALTH_NAMES[] = {
+    "DESCONHECIDO",
+    "OK",
+    "INSTAVEL",
+    "FALHA"
+};
+
+constexpr size_t SENSOR_HEALTH_COUNT = sizeof(SENSOR_HEALTH_NAMES) / sizeof(SENSOR_HEALTH_NAMES[0]);
+static_assert(SENSOR_HEALTH_COUNT == size_t(SensorHealth::FAILED) + 1, "SENSOR_HEALTH_NAMES fora de sincronia com SensorHealth");
+
+constexpr const char* sensorHealthName(SensorHealth health) {
+    return size_t(health) < SENSOR_HEALTH_COUNT ? SENSOR_HEALTH_NAMES[size_t(health)] : SENSOR_HEALTH_NAMES[0];
+}
+
+// Codificação do status e dos comandos no MQTT. Os comandos são aceitos nas
+// duas a qualquer momento; o status sai na escolhida com FORMATO e informada
+// em "formato" (MQTT.md)
+enum class WireFormat : uint8_t {
+    JSON,
+    CBOR
+};
+
+constexpr const char* WIRE_FORMAT_NAMES[] = {
+    "JSON",
+    "CBOR"
+};
+
+constexpr size_t WIRE_FORMAT_COUNT = sizeof(WIRE_FORMAT_NAMES) / sizeof(WIRE_FORMAT_NAMES[0]);
+static_assert(WIRE_FORMAT_COUNT == size_t(WireFormat::CBOR) + 1, "WIRE_FORMAT_NAMES fora de sincronia com WireFormat");
+
+constexpr const char* wireFormatName(WireFormat format) {
+    return size_t(format) < WIRE_FORMAT_COUNT ? WIRE_FORMAT_NAMES[size_t(format)] : WIRE_FORMAT_NAMES[0];
+}
+
+// Mínimo, máximo e média das leituras filtradas numa janela de relatório
+struct SensorStats {
+    float min;
+    float max;
+    float mean;
+    uint16_t samples;       // 0: janela sem leitura válida
+};
+
+// Campos do status, usados como máscara para publicação por alteração
+enum StatusField : uint8_t {
+    STATUS_FIELD_POWER        = 1 << 0,
+    STATUS_FIELD_CURRENT_TEMP = 1 << 1,
+    STATUS_FIELD_HUMIDITY     = 1 << 2,
+    STATUS_FIELD_TARGET_TEMP  = 1 << 3,
+    STATUS_FIELD_MODE         = 1 << 4,
+    STATUS_FIELD_FAN_SPEED    = 1 << 5,
+    STATUS_FIELD_SENSOR       = 1 << 6,     // sensorStatus
+    STATUS_FIELD_THERMOSTAT   = 1 << 7,     // termostato
+    STATUS_FIELD_ALL          = 0xFF
+};
+
+// Política do termostato local, definida pelo servidor
+struct ThermostatPolicy {
+    bool enabled;
+    uint8_t hysteresis;         // largura da banda em décimos de °C
+    uint16_t minOnSeconds;      // compressor ligado no mínimo por isso
+    uint16_t minOffSeconds;     // e parado no mínimo por isso
+    uint8_t minTemp;            // faixa em que o setpoint é mantido
+    uint8_t maxTemp;
+};
+
+// Campos presentes num comando TERMOSTATO; os ausentes ficam como estão
+enum ThermostatField : uint8_t {
+    THERMOSTAT_FIELD_ENABLED    = 1 << 0,
+    THERMOSTAT_FIELD_HYSTERESIS = 1 << 1,
+    THERMOSTAT_FIELD_MIN_ON     = 1 << 2,
+    THERMOSTAT_FIELD_MIN_OFF    = 1 << 3,
+    THERMOSTAT_FIELD_MIN_TEMP   = 1 << 4,
+    THERMOSTAT_FIELD_MAX_TEMP   = 1 << 5
+};
+
+// Fotografia do estado publicado no tópico de status
+struct ACStatus {
+    bool isOn;
+    float currentTemp;
+    float currentHumidity;
+    uint8_t targetTemp;
+    ACMode mode;
+    FanSpeed fanSpeed;
+    SensorHealth temperatureHealth = SensorHealth::UNKNOWN;
+    SensorHealth humidityHealth = SensorHealth::UNKNOWN;
+    SensorStats temperatureStats{};     // última janela fechada
+    SensorStats humidityStats{};
+    bool thermostatEnabled = false;
+    bool thermostatDemand = false;      // compressor chamado pelo termostato
+    // Agenda semanal; preenchido pela tarefa de rede, que é dona do Scheduler
+    uint32_t scheduleVersion = 0;       // 0: nenhuma agenda instalada
+    bool scheduleEnabled = false;
+    bool clockSynced = false;           // hora do NTP disponível
+    WireFormat wireFormat = WireFormat::JSON;   // da tarefa de rede, como a agenda
+};
+
+// Leitura já validada e filtrada pela tarefa de sensores. Uma grandeza sem
+// leitura válida vem como NAN e mantém o último valor no controlador.
+struct SensorSample {
+    float temperature;
+    float humidity;
+    SensorHealth temperatureHealth = SensorHealth::OK;
+    SensorHealth humidityHealth = SensorHealth::OK;
+    bool windowClosed = false;          // true: as estatísticas abaixo são novas
+    SensorStats temperatureStats{};
+    SensorStats humidityStats{};
+};
+
+// Parte do estado que o servidor controla (SET_STATE)
+struct ACSettings {
+    bool isOn;
+    uint8_t targetTemp;
+    ACMode mode;
+    FanSpeed fanSpeed;
+};
+
+// Comando já interpretado, pronto para ACController::execute ou para a fila
+// entre a tarefa de rede e a de controle
+enum class ACCommandType : uint8_t {
+    TURN_ON,
+    TURN_OFF,
+    SET_TEMPERATURE,
+    SET_MODE,
+    SET_FAN_SPEED,
+    SET_STATE,
+    SET_THERMOSTAT,
+    SET_SCHEDULE,           // AGENDA: a tabela vem de parseSchedule
+    SET_FORMAT,             // FORMATO: value = WireFormat do status
+    OTA_OFFER,              // OTA: a oferta vem de parseOtaOffer
+    LEARN_IR,               // APRENDER_IR: settings = tecla; value 1 = apagar a biblioteca
+    UPLOAD_RECORDING        // GRAVACAO: value 1 = a gravação do boot anterior
+};
+
+struct ACCommand {
+    ACCommandType type;
+    uint8_t value;          // temperatura, ACMode ou FanSpeed conforme o tipo
+    uint8_t fields = 0;     // SET_STATE: StatusField presentes em settings;
+                            // SET_THERMOSTAT: ThermostatField presentes em policy
+    ACSettings settings{};  // SET_STATE: estado desejado; LEARN_IR: a tecla
+    ThermostatPolicy policy{};
+    uint8_t unit = 0;       // aparelho do ESP32 (ACUnits); pelo tópico, não pelo JSON
+    uint8_t trace = 0;      // rastreio do comando com "id" (CommandTracer); 0 sem
+};
+
+// IR de um comando rastreado, medido pela tarefa que transmite: início do
+// primeiro quadro que saiu depois do comando e o poll() que viu a fila do
+// IR vazia, em micros()
+struct CommandTiming {
+    uint8_t trace = 0;
+    bool transmitted = false;   // false: o comando não gerou quadro
+    uint32_t irStartUs = 0;
+    uint32_t irDoneUs = 0;
+};
+
+#endif // AC_STATE_H
@@ -0,0 +1,60 @@
+#ifndef CBOR_READER_H
+#define CBOR_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "JsonReader.h"
+#include "WireKeys.h"
+
+// Leitor CBOR (RFC 8949) incremental sobre o buffer recebido, sem alocação
+// e sem cópia, com a mesma interface do JsonReader para os codecs serem um
+// template só. Chaves inteiras são traduzidas pelo dicionário (WireKeys.h);
+// uma fora dele vira nome vazio, e o valor é pulado como o de qualquer
+// membro desconhecido. Aceita mapas e arrays de tamanho definido ou não;
+// strings de texto só de tamanho definido (o trecho precisa ser contíguo).
+// Bytes, tags e os demais simples aparecem como NONE em peek() e só podem
+// ser pulados. Nunca lê além de length; erro marca failed().
+class CborReader {
+public:
+    static const uint8_t MAX_DEPTH = 8;
+
+    CborReader(const uint8_t* data, size_t length);
+
+    bool beginObject();
+    // Próximo membro do mapa corrente; false no fim dele ou em erro
+    bool nextMember(JsonSlice& key);
+
+    bool beginArray();
+    // true se há mais um elemento a ler no array corrente
+    bool nextElement();
+
+    // Tipo do próximo valor, sem consumi-lo
+    JsonType peek();
+
+    bool readString(JsonSlice& out);
+    // Inteiro com a parte fracionária truncada, saturado em int32
+    bool readInteger(int32_t& out);
+    // Número com a parte fracionária (temperaturas, umidade)
+    bool readNumber(float& out);
+    bool readBool(bool& out);
+    bool skipValue();
+
+    bool failed() const { return _failed; }
+
+private:
+    static const uint32_t INDEFINITE = UINT32_MAX;
+
+    const uint8_t* _pos;
+    const uint8_t* _end;
+    uint8_t _depth;
+    uint32_t _remaining[MAX_DEPTH];     // itens restantes de cada container aberto
+    bool _failed;
+
+    bool fail();
+    bool readHead(uint8_t& major, uint8_t& info, uint64_t& argument);
+    bool enter(uint8_t expectedMajor);
+    bool next();
+    bool skipItem(uint8_t depth);
+};
+
+#endif // CBOR_READER_H
@@ -0,0 +1,53 @@
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WireKeys.h"
+
+// Escritor CBOR (RFC 8949) sobre um buffer do chamador, sem alocação, com a
+// mesma interface do JsonWriter para os codecs serem um template só.
+// Objetos saem como mapas de tamanho definido, corrigido no endObject: até
+// 23 membros e MAX_DEPTH níveis, mais que isso marca overflowed(). Chaves do
+// dicionário (WireKeys.h) saem como inteiros. Números reais têm a precisão
+// de float, como os sensores, e usam meia precisão quando ela é exata;
+// NaN/infinito viram null, como no JSON.
+class CborWriter {
+public:
+    static const uint8_t MAX_DEPTH = 8;
+    static const uint8_t MAX_MEMBERS = 23;      // contagem no byte inicial
+
+    CborWriter(uint8_t* buffer, size_t capacity);
+
+    void beginObject();
+    void endObject();
+    void key(WireKey name);
+    // Nome fora do dicionário sai como texto
+    void key(const char* name);
+
+    void value(bool b);
+    void value(uint32_t n);
+    void value(int32_t n);
+    void value(double d);
+    void value(const char* str);
+    void null();
+
+    // Comprimento escrito, ou 0 se o buffer não coube
+    size_t finish();
+    bool overflowed() const { return _overflow; }
+
+private:
+    uint8_t* _buffer;
+    size_t _capacity;
+    size_t _length;
+    bool _overflow;
+    uint8_t _depth;
+    size_t _mapStart[MAX_DEPTH];    // posição do byte inicial de cada mapa aberto
+
+    void raw(uint8_t byte);
+    void raw(const void* data, size_t length);
+    void head(uint8_t major, uint32_t argument);
+    bool countMember();
+};
+
+#endif // CBOR_WRITER_H
@@ -0,0 +1,48 @@
+#ifndef COMMAND_CODEC_H
+#define COMMAND_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ACState.h"
+#include "JsonReader.h"
+
+enum class CommandParseResult : uint8_t {
+    OK,
+    MALFORMED,          // JSON ou CBOR inválido ou truncado
+    MISSING_VERB,       // sem "comando" string
+    UNKNOWN_VERB,
+    INVALID_PARAMETER   // parâmetro obrigatório ausente ou fora da faixa
+};
+
+// Texto para o log e o "detalhe" de .../erro
+const char* commandParseResultName(CommandParseResult result);
+// Código estável (ASCII) para a "mensagem" de .../erro: MALFORMED,
+// MISSING_VERB, UNKNOWN_VERB, INVALID_PARAMETER
+const char* commandParseResultCode(CommandParseResult result);
+
+// Maior "id" de correlação aceito (um UUID tem 36 caracteres)
+constexpr size_t COMMAND_ID_MAX = 40;
+
+// Interpreta um comando recebido em .../comando (formato em MQTT.md)
+// diretamente sobre o payload do MQTT: sem cópia, sem '\0' e sem heap.
+// 'command' só é válido quando o retorno é OK.
+CommandParseResult parseCommandJson(const uint8_t* payload, size_t length, ACCommand& command);
+// O mesmo comando em CBOR, com as chaves do dicionário de WireKeys.h ou
+// por extenso
+CommandParseResult parseCommandCbor(const uint8_t* payload, size_t length, ACCommand& command);
+
+// Codificação de um payload recebido: um mapa CBOR começa em 0xA0-0xBF,
+// bytes que nunca abrem um JSON
+inline WireFormat payloadWireFormat(const uint8_t* payload, size_t length) {
+    return length && (payload[0] & 0xE0) == 0xA0 ? WireFormat::CBOR : WireFormat::JSON;
+}
+
+// Aceita as duas codificações, pelo primeiro byte
+CommandParseResult parseCommand(const uint8_t* payload, size_t length, ACCommand& command);
+// O mesmo, devolvendo também o "id" opcional do comando (trecho do payload,
+// vazio sem ele). O id vale mesmo quando o comando é rejeitado, para que a
+// confirmação diga qual foi; um id maior que COMMAND_ID_MAX é
+// INVALID_PARAMETER e volta vazio.
+CommandParseResult parseCommand(const uint8_t* payload, size_t length, ACCommand& command, JsonSlice& id);
+
+#endif // COMMAND_CODEC_H
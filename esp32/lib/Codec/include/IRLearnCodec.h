@@ -0,0 +1,49 @@
+#ifndef IR_LEARN_CODEC_H
+#define IR_LEARN_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ACState.h"
+
+// Aprendizado de códigos IR (formato em MQTT.md): o comando APRENDER_IR
+// arma o receptor para um estado e o dispositivo responde em
+// .../ir/aprendizado quando a tecla chega, o prazo vence ou a biblioteca
+// termina de ser apagada.
+
+enum class IRLearnState : uint8_t {
+    IDLE,           // OCIOSO
+    WAITING,        // AGUARDANDO: receptor armado, falta a tecla
+    STORED,         // GRAVADO: código comprimido na biblioteca
+    TIMEOUT,        // TEMPO_ESGOTADO: nenhuma tecla no prazo
+    IRREGULAR,      // IRREGULAR: curto ou com durações distintas demais
+    TOO_LONG,       // LONGO_DEMAIS: não coube na memória do receptor
+    FULL,           // BIBLIOTECA_CHEIA: apagar antes de aprender mais
+    FLASH,          // FALHA_FLASH: gravar ou apagar falhou
+    ERASING,        // APAGANDO: um setor por passo da tarefa de rede
+    ERASED,         // APAGADA
+    UNAVAILABLE     // INDISPONIVEL: sem partição irlib ou sem receptor
+};
+
+const char* irLearnStateName(IRLearnState state);
+
+// Publicado em .../ir/aprendizado
+struct IRLearnReport {
+    IRLearnState state;
+    bool hasKey;                // o estado aprendido vale (AGUARDANDO em diante)
+    ACSettings settings;
+    uint16_t durations;         // do quadro capturado; 0 sem captura
+    uint16_t bytes;             // do código gravado
+    uint16_t tickUs;
+    uint16_t codes;             // chaves aprendidas na biblioteca
+    uint32_t freeBytes;
+};
+
+constexpr size_t IR_LEARN_REPORT_JSON_CAPACITY = 256;
+
+// Ex.: {"estado":"GRAVADO","ligado":true,"modo":"REFRIGERAR",
+//       "temperatura":23,"velocidade":"MEDIA","duracoes":199,"bytes":66,
+//       "tick":492,"codigos":12,"livre":125408}
+// O estado aprendido e a captura só aparecem quando existem
+size_t serializeIRLearnReportJson(const IRLearnReport& report, char* buffer, size_t capacity);
+
+#endif // IR_LEARN_CODEC_H
@@ -0,0 +1,73 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Trecho do payload original (sem cópia e sem '\0'). Strings com escapes
+// ficam cruas: os nomes do protocolo nunca precisam deles.
+struct JsonSlice {
+    const char* data;
+    size_t length;
+
+    bool equals(const char* literal) const;
+};
+
+enum class JsonType : uint8_t {
+    NONE,       // fim do buffer ou erro
+    OBJECT,
+    ARRAY,
+    STRING,
+    NUMBER,
+    BOOL,
+    NUL
+};
+
+// Leitor JSON incremental sobre o buffer recebido, sem alocação e sem cópia.
+// Nunca lê além de length; qualquer erro de sintaxe marca failed() e faz as
+// chamadas seguintes retornarem false.
+class JsonReader {
+public:
+    static const uint8_t MAX_DEPTH = 8;    // aninhamento aceito em skipValue
+
+    JsonReader(const uint8_t* data, size_t length);
+
+    bool beginObject();
+    // Próximo membro do objeto corrente; false no '}' final ou em erro
+    bool nextMember(JsonSlice& key);
+
+    bool beginArray();
+    // true se há mais um elemento a ler no array corrente; false no ']'
+    // final ou em erro
+    bool nextElement();
+
+    // Tipo do próximo valor, sem consumi-lo
+    JsonType peek();
+
+    bool readString(JsonSlice& out);
+    // Inteiro com a parte fracionária truncada, saturado em int32
+    bool readInteger(int32_t& out);
+    // Número com a parte fracionária (temperaturas, umidade)
+    bool readNumber(float& out);
+    bool readBool(bool& out);
+    bool skipValue();
+
+    bool failed() const { return _failed; }
+
+private:
+    const char* _pos;
+    const char* _end;
+    uint8_t _depth;
+    bool _expectComma;
+    bool _failed;
+
+    bool fail();
+    void skipWhitespace();
+    bool consume(char c);
+    bool skipLiteral(const char* literal);
+    bool readDecimal(bool& negative, uint32_t& mantissa, int32_t& scale);
+    bool skipNumber();
+    bool skipContainer(char open, char close);
+};
+
+#endif // JSON_READER_H
@@ -0,0 +1,47 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WireKeys.h"
+
+// Escritor JSON sobre um buffer do chamador, sem alocação.
+// Números reais saem no mesmo formato do ArduinoJson 6 (double, até 9
+// dígitos significativos, sem zeros à direita; NaN/infinito viram null),
+// para que os payloads continuem idênticos aos gerados com serializeJson.
+class JsonWriter {
+public:
+    JsonWriter(char* buffer, size_t capacity);
+
+    void beginObject();
+    void endObject();
+    void key(const char* name);
+    void key(WireKey name) { key(wireKeyName(name).data); }
+
+    void value(bool b);
+    void value(uint32_t n);
+    void value(int32_t n);
+    void value(double d);
+    void value(const char* str);
+    void null();
+
+    // Comprimento escrito (sem o '\0'), ou 0 se o buffer não coube
+    size_t finish();
+    bool overflowed() const { return _overflow; }
+
+private:
+    char* _buffer;
+    size_t _capacity;
+    size_t _length;
+    bool _overflow;
+    bool _needComma;
+
+    void separator();
+    void raw(char c);
+    void raw(const char* str);
+    void raw(const char* begin, const char* end);
+    void writeUnsigned(uint32_t n);
+    void writeDecimals(uint32_t decimal, int8_t places);
+};
+
+#endif // JSON_WRITER_H
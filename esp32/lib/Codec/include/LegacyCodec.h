@@ -0,0 +1,23 @@
+#ifndef LEGACY_CODEC_H
+#define LEGACY_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ACState.h"
+#include "CommandCodec.h"
+
+// Mensagens do firmware climaControl antigo (MQTT.md, "Esquema legado"),
+// para que os dispositivos e o servidor que ainda falam nele funcionem com
+// este firmware (MQTT_SCHEMA_LEGACY). Só JSON, sem cópia e sem heap.
+//
+// Comando em climaControl/{id}/command:
+//   {"acao":"ligar"}                       liga em REFRIGERAR, ventilação automática
+//   {"acao":"desligar"}
+//   {"acao":"set_temperatura","valor":22}  ajusta e liga
+CommandParseResult parseLegacyCommand(const uint8_t* payload, size_t length, ACCommand& command);
+
+// Status em climaControl/{id}/status: {"ligado":true,"temperatura":22},
+// com a temperatura desejada. Retorna o comprimento (sem '\0') ou 0.
+size_t serializeLegacyStatus(const ACStatus& status, char* buffer, size_t capacity);
+
+#endif // LEGACY_CODEC_H
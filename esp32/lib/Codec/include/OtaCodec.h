@@ -0,0 +1,92 @@
+#ifndef OTA_CODEC_H
+#define OTA_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommandCodec.h"
+
+// Atualização de firmware pelo MQTT (formato em MQTT.md): a oferta chega
+// pelo comando OTA, os blocos em .../ota/bloco e o dispositivo responde em
+// .../ota/estado com o próximo bloco que espera.
+
+// Bytes de imagem por bloco: cabeçalho, tópico e imagem cabem no pacote
+// de 1024 bytes do PubSubClient, e 8 blocos fecham um setor de 4 KB
+constexpr size_t OTA_CHUNK_SIZE = 512;
+// sessão (4) | índice (u32 big-endian)
+constexpr size_t OTA_CHUNK_HEADER_BYTES = 8;
+constexpr size_t OTA_SHA256_BYTES = 32;
+constexpr size_t OTA_VERSION_SIZE = 24;         // com o '\0'
+
+struct OtaOffer {
+    bool cancel;                // "cancelar": true descarta a transferência
+    uint32_t size;
+    uint8_t sha256[OTA_SHA256_BYTES];
+    char version[OTA_VERSION_SIZE];
+};
+
+// Interpreta os parâmetros do comando OTA; sem cancelar, versão, tamanho
+// e sha256 (64 dígitos hex) são obrigatórios. 'offer' só é válida com OK.
+CommandParseResult parseOtaOfferJson(const uint8_t* payload, size_t length, OtaOffer& offer);
+CommandParseResult parseOtaOfferCbor(const uint8_t* payload, size_t length, OtaOffer& offer);
+// Pelo primeiro byte, como parseCommand
+CommandParseResult parseOtaOffer(const uint8_t* payload, size_t length, OtaOffer& offer);
+
+// Identifica a transferência nos blocos: os 4 primeiros bytes do SHA-256,
+// para um bloco atrasado de uma oferta anterior não entrar na imagem
+inline uint32_t otaSessionTag(const uint8_t* sha256) {
+    return uint32_t(sha256[0]) << 24 | uint32_t(sha256[1]) << 16 | uint32_t(sha256[2]) << 8 | sha256[3];
+}
+
+// Bloco recebido, apontando para o payload do MQTT
+struct OtaChunk {
+    uint32_t session;
+    uint32_t index;
+    const uint8_t* data;
+    size_t length;
+};
+
+// false se o payload não tem cabeçalho ou traz mais que OTA_CHUNK_SIZE
+bool parseOtaChunk(const uint8_t* payload, size_t length, OtaChunk& chunk);
+void packOtaChunkHeader(uint32_t session, uint32_t index, uint8_t* out);
+
+enum class OtaState : uint8_t {
+    IDLE,           // OCIOSO: nenhuma transferência
+    RECEIVING,      // RECEBENDO: gravando blocos na partição inativa
+    REBOOTING,      // REINICIANDO: imagem verificada, boot trocado
+    TESTING,        // TESTANDO: rodando a imagem nova, falta confirmar
+    CONFIRMED,      // CONFIRMADO: a imagem nova conectou e ficou
+    ROLLED_BACK,    // REVERTIDO: a imagem nova não confirmou; voltou a anterior
+    FAILED          // FALHA: transferência abandonada (ver OtaError)
+};
+
+enum class OtaError : uint8_t {
+    NONE,
+    SIZE,           // TAMANHO: zero ou maior que a partição
+    FLASH,          // FLASH: apagar ou gravar falhou
+    SHA256,         // SHA256: a imagem recebida não confere
+    IMAGE           // IMAGEM: o bootloader não aceitou a imagem
+};
+
+const char* otaStateName(OtaState state);
+const char* otaErrorName(OtaError error);
+
+// Publicado (retido) em .../ota/estado
+struct OtaReport {
+    OtaState state;
+    OtaError error;
+    uint32_t nextChunk;         // próximo bloco esperado
+    uint32_t size;
+    uint8_t window;             // blocos que o servidor pode enviar adiante
+    bool gap;                   // faltou um bloco: reenviar a partir de nextChunk
+    char version[OTA_VERSION_SIZE];     // da transferência; "" sem nenhuma
+    const char* firmware;       // versão em execução
+};
+
+constexpr size_t OTA_REPORT_JSON_CAPACITY = 256;
+
+// Ex.: {"estado":"RECEBENDO","firmware":"1.0.0","versao":"1.1.0",
+//       "proximo":96,"tamanho":917504,"bloco":512,"janela":4}
+// "lacuna":true e "erro" só aparecem quando valem
+size_t serializeOtaReportJson(const OtaReport& report, char* buffer, size_t capacity);
+
+#endif // OTA_CODEC_H
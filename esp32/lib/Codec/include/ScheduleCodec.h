@@ -0,0 +1,57 @@
+#ifndef SCHEDULE_CODEC_H
+#define SCHEDULE_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ACState.h"
+#include "CommandCodec.h"
+
+// Agenda semanal compilada: transições em ordem de minuto da semana (hora
+// local, 0 = domingo 00:00). Cada uma aplica um estado parcial como o
+// SET_STATE; campos ausentes ficam como estão.
+constexpr uint16_t MINUTES_PER_DAY = 24 * 60;
+constexpr uint16_t MINUTES_PER_WEEK = 7 * MINUTES_PER_DAY;
+
+// Transições por agenda depois de expandir os dias (4 bytes cada)
+constexpr size_t SCHEDULE_MAX_TRANSITIONS = 64;
+
+struct ScheduleTransition {
+    uint16_t minute;            // minuto da semana
+    uint8_t targetTemp;         // 0 = mantém
+    uint8_t flags;              // bit 0 = ligado, bit 7 = liga/desliga presente,
+                                // bits 1-3 = ACMode + 1, bits 4-6 = FanSpeed + 1 (0 = mantém)
+
+    // Estado desejado e StatusField presentes, prontos para SET_STATE
+    ACCommand command() const;
+};
+
+static_assert(sizeof(ScheduleTransition) == 4, "ScheduleTransition deve ocupar 4 bytes");
+
+struct ScheduleTable {
+    uint32_t version;           // definida pelo servidor; 0 = sem agenda
+    int16_t utcOffset;          // minutos somados ao UTC para a hora local
+    bool enabled;
+    uint8_t count;
+    ScheduleTransition transitions[SCHEDULE_MAX_TRANSITIONS];
+};
+
+// Interpreta os parâmetros do comando AGENDA (formato em MQTT.md) e compila
+// a tabela: expande os dias, ordena e, em dois itens no mesmo minuto, o
+// último da mensagem vence. Sem heap; 'table' só é válida com OK.
+CommandParseResult parseScheduleJson(const uint8_t* payload, size_t length, ScheduleTable& table);
+// A mesma agenda em CBOR; parseSchedule escolhe pelo primeiro byte
+CommandParseResult parseScheduleCbor(const uint8_t* payload, size_t length, ScheduleTable& table);
+CommandParseResult parseSchedule(const uint8_t* payload, size_t length, ScheduleTable& table);
+
+// Forma gravada na NVS (little-endian, sem padding):
+//   formato (1) | quantidade (1) | fuso (i16) | versão (u32) | ativa (1)
+//   | transições (4 cada: minuto u16, temperatura, flags)
+constexpr uint8_t SCHEDULE_BLOB_FORMAT = 1;
+constexpr size_t SCHEDULE_BLOB_HEADER_BYTES = 9;
+constexpr size_t SCHEDULE_BLOB_CAPACITY = SCHEDULE_BLOB_HEADER_BYTES + 4 * SCHEDULE_MAX_TRANSITIONS;
+
+size_t packScheduleTable(const ScheduleTable& table, uint8_t* out);
+// false se o blob não é de uma agenda válida (formato, tamanho ou ordem)
+bool unpackScheduleTable(const uint8_t* in, size_t length, ScheduleTable& table);
+
+#endif // SCHEDULE_CODEC_H
@@ -0,0 +1,41 @@
+#ifndef STATUS_CODEC_H
+#define STATUS_CODEC_H
+
+#include <stddef.h>
+#include "ACState.h"
+
+// Tamanho de buffer suficiente para qualquer status JSON (e, com folga,
+// CBOR)
+constexpr size_t STATUS_JSON_CAPACITY = 512;
+
+// Serializa o status no formato publicado em .../status. As estatísticas
+// da última janela de sensores ("janela"), a agenda ("agenda", só com uma
+// instalada) e a codificação ("formato") só saem aqui, nunca no delta.
+// Retorna o comprimento (sem '\0') ou 0 se o buffer for pequeno demais.
+size_t serializeStatusJson(const ACStatus& status, char* buffer, size_t capacity);
+
+// Payload compacto com apenas os campos de 'fields' (máscara de StatusField),
+// publicado em .../status/delta. Ex.: {"temperaturaAtual":23.6}
+size_t serializeStatusDeltaJson(const ACStatus& status, uint8_t fields,
+                                char* buffer, size_t capacity);
+
+// Os mesmos payloads em CBOR, com as chaves do dicionário de WireKeys.h.
+// Ex. do delta: A1 04 FA 41 BC CC CD ({4: 23.6})
+size_t serializeStatusCbor(const ACStatus& status, uint8_t* buffer, size_t capacity);
+size_t serializeStatusDeltaCbor(const ACStatus& status, uint8_t fields,
+                                uint8_t* buffer, size_t capacity);
+
+// Na codificação escolhida; em JSON o buffer recebe também o '\0'
+size_t serializeStatus(const ACStatus& status, WireFormat format, uint8_t* buffer, size_t capacity);
+size_t serializeStatusDelta(const ACStatus& status, uint8_t fields, WireFormat format,
+                            uint8_t* buffer, size_t capacity);
+
+// Caminho inverso, para quem assina os status (o gateway de lib/Gateway):
+// status ou delta, em JSON ou CBOR pelo primeiro byte. Só os campos de
+// StatusField são lidos; os presentes voltam em 'fields' e os ausentes
+// ficam como estavam, então ler um delta por cima do último status o
+// atualiza. Leitura nula do sensor vira NAN. false (e 'status' intocado)
+// se o payload for inválido.
+bool parseStatus(const uint8_t* payload, size_t length, ACStatus& status, uint8_t& fields);
+
+#endif // STATUS_CODEC_H
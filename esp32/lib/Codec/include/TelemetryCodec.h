@@ -0,0 +1,59 @@
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ACState.h"
+
+// Amostra de telemetria: o que os relatórios de energia precisam, em
+// grandezas inteiras para caber em 9 bytes no log de flash.
+struct TelemetryRecord {
+    uint32_t time;              // segundos do relógio de telemetria
+    int16_t temperature;        // décimos de °C; TELEMETRY_NO_TEMPERATURE sem leitura
+    uint16_t humidity;          // décimos de %UR; TELEMETRY_NO_HUMIDITY sem leitura
+    uint8_t state;              // bit 7 = ligado, bits 0-6 = temperatura desejada
+
+    bool isOn() const { return state & 0x80; }
+    uint8_t targetTemp() const { return state & 0x7F; }
+};
+
+constexpr int16_t TELEMETRY_NO_TEMPERATURE = INT16_MIN;
+constexpr uint16_t TELEMETRY_NO_HUMIDITY = UINT16_MAX;
+
+// Forma fixa no log (little-endian, sem padding)
+constexpr size_t TELEMETRY_RECORD_BYTES = 9;
+
+TelemetryRecord telemetryRecordFromStatus(const ACStatus& status, uint32_t time);
+void packTelemetryRecord(const TelemetryRecord& record, uint8_t* out);
+TelemetryRecord unpackTelemetryRecord(const uint8_t* in);
+
+// Lote publicado em .../telemetria:
+//   versão (1) | quantidade (1) | relógio no envio (u32) | 1º registro (9)
+//   e, para cada seguinte, em varint:
+//   (Δtempo << 1 | estado mudou), Δtemperatura e Δumidade em zigzag,
+//   e o byte de estado só quando mudou.
+// Com uma amostra por minuto e o ambiente estável são 3 bytes por amostra.
+constexpr uint8_t TELEMETRY_BATCH_VERSION = 1;
+constexpr size_t TELEMETRY_BATCH_HEADER_BYTES = 6;
+constexpr size_t TELEMETRY_BATCH_MAX_RECORDS = 255;
+
+// Pior caso de um registro delta: 5 + 3 + 3 + 1 bytes
+constexpr size_t TELEMETRY_DELTA_MAX_BYTES = 12;
+
+constexpr size_t telemetryBatchCapacity(size_t records) {
+    return TELEMETRY_BATCH_HEADER_BYTES + TELEMETRY_RECORD_BYTES
+        + (records > 1 ? records - 1 : 0) * TELEMETRY_DELTA_MAX_BYTES;
+}
+
+// Codifica até 'count' registros (em ordem de tempo) que caibam no buffer.
+// Retorna o comprimento e, em 'encoded', quantos registros entraram; 0 se
+// nem o primeiro coube.
+size_t encodeTelemetryBatch(const TelemetryRecord* records, size_t count, uint32_t now,
+                            uint8_t* buffer, size_t capacity, size_t& encoded);
+
+// Lado do servidor (e dos testes): devolve a quantidade decodificada ou 0
+// se o lote está malformado ou não cabe em 'out'.
+size_t decodeTelemetryBatch(const uint8_t* buffer, size_t length,
+                            TelemetryRecord* out, size_t capacity, uint32_t& now);
+
+#endif // TELEMETRY_CODEC_H
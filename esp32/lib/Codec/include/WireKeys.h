@@ -0,0 +1,94 @@
+#ifndef WIRE_KEYS_H
+#define WIRE_KEYS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "JsonReader.h"
+
+// Dicionário de chaves do formato CBOR: no lugar do nome, o payload leva o
+// número (1 byte até 23). A tabela é do protocolo (MQTT.md e
+// src/lib/cbor.ts): só se acrescenta no fim, nunca se reordena.
+enum class WireKey : uint8_t {
+    COMANDO,
+    PARAMETROS,
+    ONLINE,
+    LIGADO,
+    TEMPERATURA_ATUAL,
+    UMIDADE,
+    TEMPERATURA_DESEJADA,
+    MODO_OPERACAO,
+    VELOCIDADE_VENTILADOR,
+    SENSOR_STATUS,
+    TEMPERATURA,
+    TERMOSTATO,
+    ATIVO,
+    DEMANDA,
+    JANELA,
+    MIN,
+    MAX,
+    MEDIA,
+    AMOSTRAS,
+    AGENDA,
+    VERSAO,
+    ATIVA,
+    RELOGIO,
+    FORMATO,
+    MODO,
+    VELOCIDADE,
+    HISTERESE,
+    MIN_LIGADO,
+    MIN_DESLIGADO,
+    TEMPERATURA_MIN,
+    TEMPERATURA_MAX,
+    FUSO,
+    TRANSICOES
+};
+
+#define WIRE_KEY(name) {name, sizeof(name) - 1}
+
+constexpr JsonSlice WIRE_KEYS[] = {
+    WIRE_KEY("comando"),
+    WIRE_KEY("parametros"),
+    WIRE_KEY("online"),
+    WIRE_KEY("ligado"),
+    WIRE_KEY("temperaturaAtual"),
+    WIRE_KEY("umidade"),
+    WIRE_KEY("temperaturaDesejada"),
+    WIRE_KEY("modoOperacao"),
+    WIRE_KEY("velocidadeVentilador"),
+    WIRE_KEY("sensorStatus"),
+    WIRE_KEY("temperatura"),
+    WIRE_KEY("termostato"),
+    WIRE_KEY("ativo"),
+    WIRE_KEY("demanda"),
+    WIRE_KEY("janela"),
+    WIRE_KEY("min"),
+    WIRE_KEY("max"),
+    WIRE_KEY("media"),
+    WIRE_KEY("amostras"),
+    WIRE_KEY("agenda"),
+    WIRE_KEY("versao"),
+    WIRE_KEY("ativa"),
+    WIRE_KEY("relogio"),
+    WIRE_KEY("formato"),
+    WIRE_KEY("modo"),
+    WIRE_KEY("velocidade"),
+    WIRE_KEY("histerese"),
+    WIRE_KEY("minLigado"),
+    WIRE_KEY("minDesligado"),
+    WIRE_KEY("temperaturaMin"),
+    WIRE_KEY("temperaturaMax"),
+    WIRE_KEY("fuso"),
+    WIRE_KEY("transicoes")
+};
+
+#undef WIRE_KEY
+
+constexpr size_t WIRE_KEY_COUNT = sizeof(WIRE_KEYS) / sizeof(WIRE_KEYS[0]);
+static_assert(WIRE_KEY_COUNT == size_t(WireKey::TRANSICOES) + 1, "WIRE_KEYS fora de sincronia com WireKey");
+
+constexpr const JsonSlice& wireKeyName(WireKey key) {
+    return WIRE_KEYS[size_t(key)];
+}
+
+#endif // WIRE_KEYS_H
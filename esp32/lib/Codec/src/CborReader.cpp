@@ -0,0 +1,286 @@
+#include "CborReader.h"
+#include <math.h>
+#include <string.h>
+
+namespace {
+
+constexpr uint8_t MAJOR_UNSIGNED = 0;
+constexpr uint8_t MAJOR_NEGATIVE = 1;
+constexpr uint8_t MAJOR_BYTES = 2;
+constexpr uint8_t MAJOR_TEXT = 3;
+constexpr uint8_t MAJOR_ARRAY = 4;
+constexpr uint8_t MAJOR_MAP = 5;
+constexpr uint8_t MAJOR_TAG = 6;
+constexpr uint8_t MAJOR_SIMPLE = 7;
+
+constexpr uint8_t INFO_INDEFINITE = 31;
+constexpr uint8_t BREAK = 0xFF;
+
+constexpr uint8_t SIMPLE_FALSE = 20;
+constexpr uint8_t SIMPLE_TRUE = 21;
+constexpr uint8_t SIMPLE_NULL = 22;
+constexpr uint8_t SIMPLE_UNDEFINED = 23;
+constexpr uint8_t FLOAT_HALF = 25;
+constexpr uint8_t FLOAT_SINGLE = 26;
+constexpr uint8_t FLOAT_DOUBLE = 27;
+
+double halfToDouble(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    double mantissa = half & 0x3FF;
+    double value;
+    if (exponent == 0) {
+        value = ldexp(mantissa, -24);
+    } else if (exponent == 31) {
+        value = mantissa ? NAN : INFINITY;
+    } else {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+// Real de 16, 32 ou 64 bits; false para outro tipo e para NaN
+bool floatValue(uint8_t major, uint8_t info, uint64_t argument, double& out) {
+    if (major != MAJOR_SIMPLE || info < FLOAT_HALF || info > FLOAT_DOUBLE) return false;
+    if (info == FLOAT_HALF) {
+        out = halfToDouble(uint16_t(argument));
+    } else if (info == FLOAT_SINGLE) {
+        uint32_t bits = uint32_t(argument);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        out = f;
+    } else {
+        memcpy(&out, &argument, sizeof(out));
+    }
+    return !isnan(out);
+}
+
+int32_t saturate(double value) {
+    if (value >= double(INT32_MAX)) return INT32_MAX;
+    if (value <= -double(INT32_MAX)) return -INT32_MAX;
+    return int32_t(value);
+}
+
+}  // namespace
+
+CborReader::CborReader(const uint8_t* data, size_t length)
+    : _pos(data),
+      _end(data ? data + length : data),
+      _depth(0),
+      _failed(false) {
+}
+
+bool CborReader::fail() {
+    _failed = true;
+    return false;
+}
+
+// Byte inicial e argumento (comprimento, valor ou bits do real); em tamanho
+// indefinido o argumento é 0
+bool CborReader::readHead(uint8_t& major, uint8_t& info, uint64_t& argument) {
+    if (_failed || _pos >= _end) return fail();
+    major = *_pos >> 5;
+    info = *_pos & 0x1F;
+    _pos++;
+    argument = 0;
+    if (info < 24) {
+        argument = info;
+        return true;
+    }
+    if (info == INFO_INDEFINITE) {
+        // Só containers e strings têm tamanho indefinido; 0xFF solto é erro
+        return (major >= MAJOR_BYTES && major <= MAJOR_MAP) || fail();
+    }
+    if (info > 27) return fail();
+    size_t bytes = size_t(1) << (info - 24);
+    if (size_t(_end - _pos) < bytes) return fail();
+    for (size_t i = 0; i < bytes; i++) argument = argument << 8 | *_pos++;
+    return true;
+}
+
+bool CborReader::enter(uint8_t expectedMajor) {
+    uint8_t major, info;
+    uint64_t count;
+    if (!readHead(major, info, count) || major != expectedMajor || _depth >= MAX_DEPTH) return fail();
+    // Um tamanho maior que o payload já é truncado
+    if (info != INFO_INDEFINITE && count > uint64_t(_end - _pos)) return fail();
+    _remaining[_depth++] = info == INFO_INDEFINITE ? INDEFINITE : uint32_t(count);
+    return true;
+}
+
+// Avança um item do container corrente; false no fim dele
+bool CborReader::next() {
+    if (_failed || _depth == 0) return fail();
+    uint32_t& remaining = _remaining[_depth - 1];
+    if (remaining == INDEFINITE) {
+        if (_pos >= _end) return fail();
+        if (*_pos != BREAK) return true;
+        _pos++;
+    } else if (remaining) {
+        remaining--;
+        return true;
+    }
+    _depth--;
+    return false;
+}
+
+bool CborReader::beginObject() {
+    return enter(MAJOR_MAP);
+}
+
+bool CborReader::nextMember(JsonSlice& key) {
+    if (!next()) return false;
+    JsonType type = peek();
+    if (type == JsonType::STRING) return readString(key) || fail();
+    uint8_t major, info;
+    uint64_t id;
+    if (!readHead(major, info, id) || major != MAJOR_UNSIGNED) return fail();
+    key = id < WIRE_KEY_COUNT ? WIRE_KEYS[id] : JsonSlice{"", 0};
+    return true;
+}
+
+bool CborReader::beginArray() {
+    return enter(MAJOR_ARRAY);
+}
+
+bool CborReader::nextElement() {
+    return next();
+}
+
+JsonType CborReader::peek() {
+    if (_failed || _pos >= _end) return JsonType::NONE;
+    uint8_t major = *_pos >> 5;
+    uint8_t info = *_pos & 0x1F;
+    switch (major) {
+        case MAJOR_UNSIGNED:
+        case MAJOR_NEGATIVE: return JsonType::NUMBER;
+        case MAJOR_TEXT:     return JsonType::STRING;
+        case MAJOR_ARRAY:    return JsonType::ARRAY;
+        case MAJOR_MAP:      return JsonType::OBJECT;
+        case MAJOR_SIMPLE:
+            switch (info) {
+                case SIMPLE_FALSE:
+                case SIMPLE_TRUE:       return JsonType::BOOL;
+                case SIMPLE_NULL:
+                case SIMPLE_UNDEFINED:  return JsonType::NUL;
+                case FLOAT_HALF:
+                case FLOAT_SINGLE:
+                case FLOAT_DOUBLE:      return JsonType::NUMBER;
+                default:                return JsonType::NONE;
+            }
+        default:             return JsonType::NONE;
+    }
+}
+
+bool CborReader::readString(JsonSlice& out) {
+    uint8_t major, info;
+    uint64_t length;
+    if (!readHead(major, info, length) || major != MAJOR_TEXT || info == INFO_INDEFINITE) return fail();
+    if (length > uint64_t(_end - _pos)) return fail();
+    out.data = reinterpret_cast<const char*>(_pos);
+    out.length = size_t(length);
+    _pos += length;
+    return true;
+}
+
+bool CborReader::readInteger(int32_t& out) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(major, info, argument)) return false;
+    if (major == MAJOR_UNSIGNED) {
+        out = argument > uint64_t(INT32_MAX) ? INT32_MAX : int32_t(argument);
+        return true;
+    }
+    if (major == MAJOR_NEGATIVE) {
+        // -1 - n, com a mesma saturação simétrica do JsonReader
+        out = argument >= uint64_t(INT32_MAX) ? -INT32_MAX : -1 - int32_t(argument);
+        return true;
+    }
+    double value;
+    if (!floatValue(major, info, argument, value)) return fail();
+    out = saturate(value);
+    return true;
+}
+
+bool CborReader::readNumber(float& out) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(major, info, argument)) return false;
+    double value;
+    if (major == MAJOR_UNSIGNED) {
+        value = double(argument);
+    } else if (major == MAJOR_NEGATIVE) {
+        value = -1.0 - double(argument);
+    } else if (!floatValue(major, info, argument, value)) {
+        return fail();
+    }
+    out = float(value);
+    return true;
+}
+
+bool CborReader::readBool(bool& out) {
+    if (_failed || _pos >= _end) return fail();
+    if (*_pos == (MAJOR_SIMPLE << 5 | SIMPLE_TRUE)) {
+        out = true;
+    } else if (*_pos == (MAJOR_SIMPLE << 5 | SIMPLE_FALSE)) {
+        out = false;
+    } else {
+        return fail();
+    }
+    _pos++;
+    return true;
+}
+
+bool CborReader::skipValue() {
+    return skipItem(_depth);
+}
+
+bool CborReader::skipItem(uint8_t depth) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(major, info, argument)) return false;
+    switch (major) {
+        case MAJOR_BYTES:
+        case MAJOR_TEXT:
+            if (info == INFO_INDEFINITE) {
+                // Pedaços de tamanho definido do mesmo tipo até o 0xFF
+                while (_pos < _end && *_pos != BREAK) {
+                    uint8_t chunkMajor = *_pos >> 5;
+                    if (chunkMajor != major || (*_pos & 0x1F) == INFO_INDEFINITE) return fail();
+                    if (!skipItem(depth)) return false;
+                }
+                if (_pos >= _end) return fail();
+                _pos++;
+                return true;
+            }
+            if (argument > uint64_t(_end - _pos)) return fail();
+            _pos += argument;
+            return true;
+        case MAJOR_ARRAY:
+        case MAJOR_MAP: {
+            if (depth >= MAX_DEPTH) return fail();
+            uint8_t perEntry = major == MAJOR_MAP ? 2 : 1;
+            if (info == INFO_INDEFINITE) {
+                while (_pos < _end && *_pos != BREAK) {
+                    for (uint8_t i = 0; i < perEntry; i++) {
+                        if (!skipItem(uint8_t(depth + 1))) return false;
+                    }
+                }
+                if (_pos >= _end) return fail();
+                _pos++;
+                return true;
+            }
+            if (argument > uint64_t(_end - _pos)) return fail();
+            for (uint64_t i = 0; i < argument * perEntry; i++) {
+                if (!skipItem(uint8_t(depth + 1))) return false;
+            }
+            return true;
+        }
+        case MAJOR_TAG:
+            // Conta como um nível: uma sequência de tags não pode esgotar a pilha
+            if (depth >= MAX_DEPTH) return fail();
+            return skipItem(uint8_t(depth + 1));
+        default:
+            // Inteiros, simples e reais: o argumento já era todo o item
+            return true;
+    }
+}
@@ -0,0 +1,175 @@
+#include "CborWriter.h"
+#include <math.h>
+#include <string.h>
+
+namespace {
+
+constexpr uint8_t MAJOR_UNSIGNED = 0;
+constexpr uint8_t MAJOR_NEGATIVE = 1;
+constexpr uint8_t MAJOR_TEXT = 3;
+constexpr uint8_t MAJOR_MAP = 5;
+
+constexpr uint8_t SIMPLE_FALSE = 0xF4;
+constexpr uint8_t SIMPLE_TRUE = 0xF5;
+constexpr uint8_t SIMPLE_NULL = 0xF6;
+constexpr uint8_t FLOAT_HALF = 0xF9;
+constexpr uint8_t FLOAT_SINGLE = 0xFA;
+
+// Meia precisão exata do float, se houver (sem subnormais: os valores dos
+// sensores nunca chegam perto de 6e-5)
+bool toHalf(float value, uint16_t& half) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    int32_t exponent = int32_t((bits >> 23) & 0xFF) - 127;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if (exponent == -127 && mantissa == 0) {
+        half = sign;    // ±0
+        return true;
+    }
+    if (exponent < -14 || exponent > 15 || (mantissa & 0x1FFF)) return false;
+    half = uint16_t(sign | uint32_t(exponent + 15) << 10 | mantissa >> 13);
+    return true;
+}
+
+}  // namespace
+
+CborWriter::CborWriter(uint8_t* buffer, size_t capacity)
+    : _buffer(buffer),
+      _capacity(capacity),
+      _length(0),
+      _overflow(capacity == 0),
+      _depth(0) {
+}
+
+void CborWriter::raw(uint8_t byte) {
+    if (_length >= _capacity) {
+        _overflow = true;
+        return;
+    }
+    _buffer[_length++] = byte;
+}
+
+void CborWriter::raw(const void* data, size_t length) {
+    if (_overflow || length > _capacity - _length) {
+        _overflow = true;
+        return;
+    }
+    memcpy(_buffer + _length, data, length);
+    _length += length;
+}
+
+// Cabeçalho de um item: tipo maior e o argumento na menor forma
+void CborWriter::head(uint8_t major, uint32_t argument) {
+    major = uint8_t(major << 5);
+    if (argument < 24) {
+        raw(uint8_t(major | argument));
+    } else if (argument <= 0xFF) {
+        raw(uint8_t(major | 24));
+        raw(uint8_t(argument));
+    } else if (argument <= 0xFFFF) {
+        raw(uint8_t(major | 25));
+        raw(uint8_t(argument >> 8));
+        raw(uint8_t(argument));
+    } else {
+        raw(uint8_t(major | 26));
+        for (int shift = 24; shift >= 0; shift -= 8) raw(uint8_t(argument >> shift));
+    }
+}
+
+void CborWriter::beginObject() {
+    if (_depth >= MAX_DEPTH) {
+        _overflow = true;
+        return;
+    }
+    _mapStart[_depth++] = _length;
+    raw(uint8_t(MAJOR_MAP << 5));
+}
+
+void CborWriter::endObject() {
+    if (_depth == 0) {
+        _overflow = true;
+        return;
+    }
+    _depth--;
+}
+
+// O byte inicial do mapa aberto (0xA0 + n) é a própria contagem
+bool CborWriter::countMember() {
+    if (_overflow) return false;
+    if (_depth == 0 || (_buffer[_mapStart[_depth - 1]] & 0x1F) == MAX_MEMBERS) {
+        _overflow = true;
+        return false;
+    }
+    _buffer[_mapStart[_depth - 1]]++;
+    return true;
+}
+
+void CborWriter::key(WireKey name) {
+    if (countMember()) head(MAJOR_UNSIGNED, uint32_t(name));
+}
+
+void CborWriter::key(const char* name) {
+    size_t length = strlen(name);
+    for (size_t i = 0; i < WIRE_KEY_COUNT; i++) {
+        if (WIRE_KEYS[i].length == length && memcmp(WIRE_KEYS[i].data, name, length) == 0) {
+            key(WireKey(i));
+            return;
+        }
+    }
+    if (countMember()) value(name);
+}
+
+void CborWriter::value(bool b) {
+    raw(b ? SIMPLE_TRUE : SIMPLE_FALSE);
+}
+
+void CborWriter::null() {
+    raw(SIMPLE_NULL);
+}
+
+void CborWriter::value(uint32_t n) {
+    head(MAJOR_UNSIGNED, n);
+}
+
+void CborWriter::value(int32_t n) {
+    if (n < 0) {
+        head(MAJOR_NEGATIVE, uint32_t(-(n + 1)));
+    } else {
+        head(MAJOR_UNSIGNED, uint32_t(n));
+    }
+}
+
+void CborWriter::value(double d) {
+    float f = float(d);
+    if (isnan(f) || isinf(f)) {
+        null();
+        return;
+    }
+    uint16_t half;
+    if (toHalf(f, half)) {
+        raw(FLOAT_HALF);
+        raw(uint8_t(half >> 8));
+        raw(uint8_t(half));
+        return;
+    }
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    raw(FLOAT_SINGLE);
+    for (int shift = 24; shift >= 0; shift -= 8) raw(uint8_t(bits >> shift));
+}
+
+void CborWriter::value(const char* str) {
+    if (!str) {
+        null();
+        return;
+    }
+    size_t length = strlen(str);
+    head(MAJOR_TEXT, uint32_t(length));
+    raw(str, length);
+}
+
+size_t CborWriter::finish() {
+    if (_overflow || _depth) return 0;
+    return _length;
+}
@@ -0,0 +1,390 @@
+#include "CommandCodec.h"
+#include "CborReader.h"
+#include "JsonReader.h"
+#include <string.h>
+
+namespace {
+
+// Campos de "parametros" que algum comando usa; os demais são ignorados
+struct CommandParameters {
+    bool hasTemperature;
+    bool hasMode;
+    bool hasFanSpeed;
+    bool hasPower;
+    bool power;
+    int32_t temperature;
+    JsonSlice mode;
+    JsonSlice fanSpeed;
+    // TERMOSTATO
+    uint8_t thermostatFields;       // ThermostatField presentes
+    bool enabled;
+    int32_t hysteresis;
+    int32_t minOn;
+    int32_t minOff;
+    int32_t minTemp;
+    int32_t maxTemp;
+    // FORMATO
+    bool hasFormat;
+    JsonSlice format;
+    // APRENDER_IR
+    bool erase;
+    // GRAVACAO
+    bool previous;
+};
+
+size_t literalLength(const char* s) {
+    size_t n = 0;
+    while (s[n]) n++;
+    return n;
+}
+
+template <size_t N>
+uint8_t indexFromName(const JsonSlice& name, const char* const (&names)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        if (name.equals(names[i])) return uint8_t(i);
+    }
+    return 0;   // AUTOMATICO, como acModeFromName/fanSpeedFromName
+}
+
+bool inRange(int32_t value, int32_t low, int32_t high) {
+    return value >= low && value <= high;
+}
+
+// Faixa do ACController: antes, 99 passava aqui e era ignorado sem erro
+CommandParseResult temperatureValue(const CommandParameters& params, uint8_t& value) {
+    if (!params.hasTemperature || !inRange(params.temperature, 16, 30)) {
+        return CommandParseResult::INVALID_PARAMETER;
+    }
+    value = uint8_t(params.temperature);
+    return CommandParseResult::OK;
+}
+
+CommandParseResult parseTurnOn(const CommandParameters&, ACCommand& command) {
+    command = ACCommand{ACCommandType::TURN_ON, 0};
+    return CommandParseResult::OK;
+}
+
+CommandParseResult parseTurnOff(const CommandParameters&, ACCommand& command) {
+    command = ACCommand{ACCommandType::TURN_OFF, 0};
+    return CommandParseResult::OK;
+}
+
+CommandParseResult parseTemperature(const CommandParameters& params, ACCommand& command) {
+    uint8_t temp = 0;
+    CommandParseResult result = temperatureValue(params, temp);
+    command = ACCommand{ACCommandType::SET_TEMPERATURE, temp};
+    return result;
+}
+
+CommandParseResult parseMode(const CommandParameters& params, ACCommand& command) {
+    if (!params.hasMode) return CommandParseResult::INVALID_PARAMETER;
+    command = ACCommand{ACCommandType::SET_MODE, indexFromName(params.mode, AC_MODE_NAMES)};
+    return CommandParseResult::OK;
+}
+
+CommandParseResult parseFanSpeed(const CommandParameters& params, ACCommand& command) {
+    if (!params.hasFanSpeed) return CommandParseResult::INVALID_PARAMETER;
+    command = ACCommand{ACCommandType::SET_FAN_SPEED, indexFromName(params.fanSpeed, FAN_SPEED_NAMES)};
+    return CommandParseResult::OK;
+}
+
+// Estado completo numa mensagem; campos ausentes ficam como estão
+CommandParseResult parseSetState(const CommandParameters& params, ACCommand& command) {
+    command = ACCommand{ACCommandType::SET_STATE, 0};
+    if (params.hasPower) {
+        command.settings.isOn = params.power;
+        command.fields |= STATUS_FIELD_POWER;
+    }
+    if (params.hasTemperature) {
+        if (temperatureValue(params, command.settings.targetTemp) != CommandParseResult::OK) {
+            return CommandParseResult::INVALID_PARAMETER;
+        }
+        command.fields |= STATUS_FIELD_TARGET_TEMP;
+    }
+    if (params.hasMode) {
+        command.settings.mode = ACMode(indexFromName(params.mode, AC_MODE_NAMES));
+        command.fields |= STATUS_FIELD_MODE;
+    }
+    if (params.hasFanSpeed) {
+        command.settings.fanSpeed = FanSpeed(indexFromName(params.fanSpeed, FAN_SPEED_NAMES));
+        command.fields |= STATUS_FIELD_FAN_SPEED;
+    }
+    return CommandParseResult::OK;
+}
+
+// Política do termostato; a validação cruzada (mínima <= máxima) fica com
+// o Thermostat, que conhece os valores atuais dos campos ausentes
+CommandParseResult parseThermostat(const CommandParameters& params, ACCommand& command) {
+    command = ACCommand{ACCommandType::SET_THERMOSTAT, 0};
+    uint8_t fields = params.thermostatFields;
+    if (!fields) return CommandParseResult::INVALID_PARAMETER;
+    if (((fields & THERMOSTAT_FIELD_HYSTERESIS) && !inRange(params.hysteresis, 1, 100))
+        || ((fields & THERMOSTAT_FIELD_MIN_ON) && !inRange(params.minOn, 0, 3600))
+        || ((fields & THERMOSTAT_FIELD_MIN_OFF) && !inRange(params.minOff, 0, 3600))
+        || ((fields & THERMOSTAT_FIELD_MIN_TEMP) && !inRange(params.minTemp, 16, 30))
+        || ((fields & THERMOSTAT_FIELD_MAX_TEMP) && !inRange(params.maxTemp, 16, 30))) {
+        return CommandParseResult::INVALID_PARAMETER;
+    }
+    command.fields = fields;
+    command.policy.enabled = params.enabled;
+    command.policy.hysteresis = uint8_t(params.hysteresis);
+    command.policy.minOnSeconds = uint16_t(params.minOn);
+    command.policy.minOffSeconds = uint16_t(params.minOff);
+    command.policy.minTemp = uint8_t(params.minTemp);
+    command.policy.maxTemp = uint8_t(params.maxTemp);
+    return CommandParseResult::OK;
+}
+
+// A codificação do status é da tarefa de rede; um nome desconhecido é erro,
+// não JSON em silêncio
+CommandParseResult parseFormat(const CommandParameters& params, ACCommand& command) {
+    if (!params.hasFormat) return CommandParseResult::INVALID_PARAMETER;
+    for (size_t i = 0; i < WIRE_FORMAT_COUNT; i++) {
+        if (params.format.equals(WIRE_FORMAT_NAMES[i])) {
+            command = ACCommand{ACCommandType::SET_FORMAT, uint8_t(i)};
+            return CommandParseResult::OK;
+        }
+    }
+    return CommandParseResult::INVALID_PARAMETER;
+}
+
+// A tabela da agenda não cabe num ACCommand; a tarefa de rede interpreta o
+// mesmo payload com parseSchedule
+CommandParseResult parseSchedule(const CommandParameters&, ACCommand& command) {
+    command = ACCommand{ACCommandType::SET_SCHEDULE, 0};
+    return CommandParseResult::OK;
+}
+
+// Também a oferta de firmware, com parseOtaOffer
+CommandParseResult parseOta(const CommandParameters&, ACCommand& command) {
+    command = ACCommand{ACCommandType::OTA_OFFER, 0};
+    return CommandParseResult::OK;
+}
+
+// Tecla do controle a gravar: o estado inteiro, que é a chave da biblioteca
+// (desligado é uma tecla só), ou {"apagar": true} para apagar tudo
+CommandParseResult parseLearnIR(const CommandParameters& params, ACCommand& command) {
+    command = ACCommand{ACCommandType::LEARN_IR, 0};
+    if (params.erase) {
+        command.value = 1;
+        return CommandParseResult::OK;
+    }
+    if (!params.hasPower) return CommandParseResult::INVALID_PARAMETER;
+    command.settings.isOn = params.power;
+    if (!params.power) return CommandParseResult::OK;
+    if (!params.hasMode || !params.hasFanSpeed || !params.hasTemperature
+        || !inRange(params.temperature, 16, 30)) {
+        return CommandParseResult::INVALID_PARAMETER;
+    }
+    command.settings.mode = ACMode(indexFromName(params.mode, AC_MODE_NAMES));
+    command.settings.fanSpeed = FanSpeed(indexFromName(params.fanSpeed, FAN_SPEED_NAMES));
+    command.settings.targetTemp = uint8_t(params.temperature);
+    return CommandParseResult::OK;
+}
+
+// Envio da gravação de entradas (InputRecorder): a deste boot ou, com
+// {"anterior": true}, a de antes do último reinício
+CommandParseResult parseUploadRecording(const CommandParameters& params, ACCommand& command) {
+    command = ACCommand{ACCommandType::UPLOAD_RECORDING, uint8_t(params.previous ? 1 : 0)};
+    return CommandParseResult::OK;
+}
+
+typedef CommandParseResult (*CommandHandler)(const CommandParameters&, ACCommand&);
+
+struct VerbEntry {
+    const char* name;
+    CommandHandler handler;
+};
+
+// Ordenada por nome para a busca binária (verificado em compilação abaixo)
+constexpr VerbEntry VERBS[] = {
+    {"AGENDA",        parseSchedule},
+    {"APRENDER_IR",   parseLearnIR},
+    {"DESLIGAR",      parseTurnOff},
+    {"FORMATO",       parseFormat},
+    {"GRAVACAO",      parseUploadRecording},
+    {"LIGAR",         parseTurnOn},
+    {"MODO_OPERACAO", parseMode},
+    {"OTA",           parseOta},
+    {"SET_STATE",     parseSetState},
+    {"TEMPERATURA",   parseTemperature},
+    {"TERMOSTATO",    parseThermostat},
+    {"VELOCIDADE",    parseFanSpeed},
+};
+
+constexpr size_t VERB_COUNT = sizeof(VERBS) / sizeof(VERBS[0]);
+
+constexpr int compareNames(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return int(uint8_t(*a)) - int(uint8_t(*b));
+}
+
+constexpr bool verbsSorted(size_t i = 1) {
+    return i >= VERB_COUNT || (compareNames(VERBS[i - 1].name, VERBS[i].name) < 0 && verbsSorted(i + 1));
+}
+
+static_assert(verbsSorted(), "VERBS precisa estar em ordem alfabética");
+
+// Compara o trecho (sem '\0') com um nome da tabela, na mesma ordem de compareNames
+int compareSlice(const JsonSlice& slice, const char* name) {
+    size_t nameLength = literalLength(name);
+    size_t n = slice.length < nameLength ? slice.length : nameLength;
+    int c = memcmp(slice.data, name, n);
+    if (c != 0) return c;
+    return slice.length < nameLength ? -1 : (slice.length > nameLength ? 1 : 0);
+}
+
+const VerbEntry* findVerb(const JsonSlice& verb) {
+    size_t low = 0;
+    size_t high = VERB_COUNT;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int c = compareSlice(verb, VERBS[mid].name);
+        if (c == 0) return &VERBS[mid];
+        if (c < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+bool readThermostatField(bool ok, uint8_t field, CommandParameters& params) {
+    if (ok) params.thermostatFields |= field;
+    return ok;
+}
+
+// Um valor de tipo diferente do esperado é tratado como ausente, como o
+// ArduinoJson fazia com doc["parametros"]["..."]. Reader é JsonReader ou
+// CborReader: as chaves inteiras do CBOR já chegam traduzidas em nomes.
+template <typename Reader>
+bool readParameters(Reader& reader, CommandParameters& params) {
+    if (reader.peek() != JsonType::OBJECT) return reader.skipValue();
+    reader.beginObject();
+
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        JsonType type = reader.peek();
+        bool ok;
+        if (key.equals("temperatura") && type == JsonType::NUMBER) {
+            ok = params.hasTemperature = reader.readInteger(params.temperature);
+        } else if (key.equals("modo") && type == JsonType::STRING) {
+            ok = params.hasMode = reader.readString(params.mode);
+        } else if (key.equals("velocidade") && type == JsonType::STRING) {
+            ok = params.hasFanSpeed = reader.readString(params.fanSpeed);
+        } else if (key.equals("ligado") && type == JsonType::BOOL) {
+            ok = params.hasPower = reader.readBool(params.power);
+        } else if (key.equals("ativo") && type == JsonType::BOOL) {
+            ok = readThermostatField(reader.readBool(params.enabled), THERMOSTAT_FIELD_ENABLED, params);
+        } else if (key.equals("histerese") && type == JsonType::NUMBER) {
+            ok = readThermostatField(reader.readInteger(params.hysteresis), THERMOSTAT_FIELD_HYSTERESIS, params);
+        } else if (key.equals("minLigado") && type == JsonType::NUMBER) {
+            ok = readThermostatField(reader.readInteger(params.minOn), THERMOSTAT_FIELD_MIN_ON, params);
+        } else if (key.equals("minDesligado") && type == JsonType::NUMBER) {
+            ok = readThermostatField(reader.readInteger(params.minOff), THERMOSTAT_FIELD_MIN_OFF, params);
+        } else if (key.equals("temperaturaMin") && type == JsonType::NUMBER) {
+            ok = readThermostatField(reader.readInteger(params.minTemp), THERMOSTAT_FIELD_MIN_TEMP, params);
+        } else if (key.equals("temperaturaMax") && type == JsonType::NUMBER) {
+            ok = readThermostatField(reader.readInteger(params.maxTemp), THERMOSTAT_FIELD_MAX_TEMP, params);
+        } else if (key.equals("formato") && type == JsonType::STRING) {
+            ok = params.hasFormat = reader.readString(params.format);
+        } else if (key.equals("apagar") && type == JsonType::BOOL) {
+            ok = reader.readBool(params.erase);
+        } else if (key.equals("anterior") && type == JsonType::BOOL) {
+            ok = reader.readBool(params.previous);
+        } else {
+            ok = reader.skipValue();
+        }
+        if (!ok) return false;
+    }
+    return !reader.failed();
+}
+
+template <typename Reader>
+CommandParseResult parseCommandWith(Reader& reader, ACCommand& command, JsonSlice& id) {
+    id = JsonSlice{nullptr, 0};
+    if (!reader.beginObject()) return CommandParseResult::MALFORMED;
+
+    bool hasVerb = false;
+    JsonSlice verb{nullptr, 0};
+    CommandParameters params{};
+
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        bool ok;
+        if (key.equals("comando") && reader.peek() == JsonType::STRING) {
+            ok = hasVerb = reader.readString(verb);
+        } else if (key.equals("id") && reader.peek() == JsonType::STRING) {
+            ok = reader.readString(id);
+        } else if (key.equals("parametros")) {
+            ok = readParameters(reader, params);
+        } else {
+            ok = reader.skipValue();
+        }
+        if (!ok) break;
+    }
+    if (reader.failed()) return CommandParseResult::MALFORMED;
+    if (id.length > COMMAND_ID_MAX) {
+        id = JsonSlice{nullptr, 0};
+        return CommandParseResult::INVALID_PARAMETER;
+    }
+    if (!hasVerb) return CommandParseResult::MISSING_VERB;
+
+    const VerbEntry* entry = findVerb(verb);
+    if (!entry) return CommandParseResult::UNKNOWN_VERB;
+    return entry->handler(params, command);
+}
+
+}  // namespace
+
+const char* commandParseResultName(CommandParseResult result) {
+    switch (result) {
+        case CommandParseResult::OK:                return "OK";
+        case CommandParseResult::MALFORMED:         return "payload inválido";
+        case CommandParseResult::MISSING_VERB:      return "sem comando";
+        case CommandParseResult::UNKNOWN_VERB:      return "comando desconhecido";
+        case CommandParseResult::INVALID_PARAMETER: return "parâmetro inválido";
+    }
+    return "?";
+}
+
+const char* commandParseResultCode(CommandParseResult result) {
+    switch (result) {
+        case CommandParseResult::OK:                return "OK";
+        case CommandParseResult::MALFORMED:         return "MALFORMED";
+        case CommandParseResult::MISSING_VERB:      return "MISSING_VERB";
+        case CommandParseResult::UNKNOWN_VERB:      return "UNKNOWN_VERB";
+        case CommandParseResult::INVALID_PARAMETER: return "INVALID_PARAMETER";
+    }
+    return "?";
+}
+
+CommandParseResult parseCommandJson(const uint8_t* payload, size_t length, ACCommand& command) {
+    JsonReader reader(payload, length);
+    JsonSlice id;
+    return parseCommandWith(reader, command, id);
+}
+
+CommandParseResult parseCommandCbor(const uint8_t* payload, size_t length, ACCommand& command) {
+    CborReader reader(payload, length);
+    JsonSlice id;
+    return parseCommandWith(reader, command, id);
+}
+
+CommandParseResult parseCommand(const uint8_t* payload, size_t length, ACCommand& command) {
+    JsonSlice id;
+    return parseCommand(payload, length, command, id);
+}
+
+CommandParseResult parseCommand(const uint8_t* payload, size_t length, ACCommand& command, JsonSlice& id) {
+    if (payloadWireFormat(payload, length) == WireFormat::CBOR) {
+        CborReader reader(payload, length);
+        return parseCommandWith(reader, command, id);
+    }
+    JsonReader reader(payload, length);
+    return parseCommandWith(reader, command, id);
+}
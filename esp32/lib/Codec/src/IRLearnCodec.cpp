@@ -0,0 +1,63 @@
+#include "IRLearnCodec.h"
+#include "JsonWriter.h"
+
+namespace {
+
+const char* const IR_LEARN_STATE_NAMES[] = {
+    "OCIOSO",
+    "AGUARDANDO",
+    "GRAVADO",
+    "TEMPO_ESGOTADO",
+    "IRREGULAR",
+    "LONGO_DEMAIS",
+    "BIBLIOTECA_CHEIA",
+    "FALHA_FLASH",
+    "APAGANDO",
+    "APAGADA",
+    "INDISPONIVEL"
+};
+
+static_assert(sizeof(IR_LEARN_STATE_NAMES) / sizeof(IR_LEARN_STATE_NAMES[0]) == size_t(IRLearnState::UNAVAILABLE) + 1,
+              "IR_LEARN_STATE_NAMES fora de sincronia com IRLearnState");
+
+}  // namespace
+
+const char* irLearnStateName(IRLearnState state) {
+    size_t i = size_t(state);
+    return i < sizeof(IR_LEARN_STATE_NAMES) / sizeof(IR_LEARN_STATE_NAMES[0]) ? IR_LEARN_STATE_NAMES[i] : "?";
+}
+
+size_t serializeIRLearnReportJson(const IRLearnReport& report, char* buffer, size_t capacity) {
+    JsonWriter json(buffer, capacity);
+    json.beginObject();
+    json.key("estado");
+    json.value(irLearnStateName(report.state));
+    if (report.hasKey) {
+        json.key("ligado");
+        json.value(report.settings.isOn);
+        if (report.settings.isOn) {
+            json.key("modo");
+            json.value(acModeName(report.settings.mode));
+            json.key("temperatura");
+            json.value(uint32_t(report.settings.targetTemp));
+            json.key("velocidade");
+            json.value(fanSpeedName(report.settings.fanSpeed));
+        }
+    }
+    if (report.durations) {
+        json.key("duracoes");
+        json.value(uint32_t(report.durations));
+    }
+    if (report.bytes) {
+        json.key("bytes");
+        json.value(uint32_t(report.bytes));
+        json.key("tick");
+        json.value(uint32_t(report.tickUs));
+    }
+    json.key("codigos");
+    json.value(uint32_t(report.codes));
+    json.key("livre");
+    json.value(report.freeBytes);
+    json.endObject();
+    return json.finish();
+}
@@ -0,0 +1,261 @@
+#include "JsonReader.h"
+#include <math.h>
+#include <string.h>
+
+bool JsonSlice::equals(const char* literal) const {
+    return strlen(literal) == length && memcmp(data, literal, length) == 0;
+}
+
+JsonReader::JsonReader(const uint8_t* data, size_t length)
+    : _pos(reinterpret_cast<const char*>(data)),
+      _end(reinterpret_cast<const char*>(data) + (data ? length : 0)),
+      _depth(0),
+      _expectComma(false),
+      _failed(false) {
+}
+
+bool JsonReader::fail() {
+    _failed = true;
+    return false;
+}
+
+void JsonReader::skipWhitespace() {
+    while (_pos < _end && (*_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r')) {
+        _pos++;
+    }
+}
+
+bool JsonReader::consume(char c) {
+    skipWhitespace();
+    if (_pos < _end && *_pos == c) {
+        _pos++;
+        return true;
+    }
+    return false;
+}
+
+bool JsonReader::beginObject() {
+    if (_failed || !consume('{')) return fail();
+    _expectComma = false;
+    return true;
+}
+
+bool JsonReader::nextMember(JsonSlice& key) {
+    if (_failed) return false;
+    if (consume('}')) {
+        // O objeto inteiro foi um valor: o próximo membro de fora pede vírgula
+        _expectComma = true;
+        return false;
+    }
+    if (_expectComma && !consume(',')) return fail();
+    if (!readString(key) || !consume(':')) return fail();
+    _expectComma = true;
+    return true;
+}
+
+bool JsonReader::beginArray() {
+    if (_failed || !consume('[')) return fail();
+    _expectComma = false;
+    return true;
+}
+
+bool JsonReader::nextElement() {
+    if (_failed) return false;
+    if (consume(']')) {
+        _expectComma = true;
+        return false;
+    }
+    if (_expectComma && !consume(',')) return fail();
+    _expectComma = true;
+    return true;
+}
+
+JsonType JsonReader::peek() {
+    skipWhitespace();
+    if (_failed || _pos >= _end) return JsonType::NONE;
+    switch (*_pos) {
+        case '{': return JsonType::OBJECT;
+        case '[': return JsonType::ARRAY;
+        case '"': return JsonType::STRING;
+        case 't':
+        case 'f': return JsonType::BOOL;
+        case 'n': return JsonType::NUL;
+        default:  return JsonType::NUMBER;
+    }
+}
+
+bool JsonReader::readString(JsonSlice& out) {
+    if (_failed || !consume('"')) return fail();
+    const char* start = _pos;
+    while (_pos < _end) {
+        char c = *_pos;
+        if (c == '"') {
+            out.data = start;
+            out.length = size_t(_pos - start);
+            _pos++;
+            return true;
+        }
+        if (uint8_t(c) < 0x20) return fail();
+        if (c == '\\') {
+            _pos++;
+            if (_pos >= _end) break;
+            if (*_pos == 'u') {
+                for (int i = 0; i < 4; i++) {
+                    _pos++;
+                    if (_pos >= _end || !strchr("0123456789abcdefABCDEF", *_pos) || *_pos == '\0') return fail();
+                }
+            } else if (!strchr("\"\\/bfnrt", *_pos) || *_pos == '\0') {
+                return fail();
+            }
+        }
+        _pos++;
+    }
+    return fail();
+}
+
+// Mantissa com até 9 dígitos significativos; o resto só conta a escala
+bool JsonReader::readDecimal(bool& negative, uint32_t& mantissa, int32_t& scale) {
+    skipWhitespace();
+    if (_failed || _pos >= _end) return fail();
+
+    negative = false;
+    if (*_pos == '-') {
+        negative = true;
+        _pos++;
+    }
+    if (_pos >= _end || *_pos < '0' || *_pos > '9') return fail();
+
+    mantissa = 0;
+    scale = 0;
+    uint8_t digits = 0;
+    while (_pos < _end && *_pos >= '0' && *_pos <= '9') {
+        if (digits < 9) {
+            mantissa = mantissa * 10 + uint32_t(*_pos - '0');
+            if (mantissa) digits++;
+        } else {
+            scale++;
+        }
+        _pos++;
+    }
+    if (_pos < _end && *_pos == '.') {
+        _pos++;
+        if (_pos >= _end || *_pos < '0' || *_pos > '9') return fail();
+        while (_pos < _end && *_pos >= '0' && *_pos <= '9') {
+            if (digits < 9) {
+                mantissa = mantissa * 10 + uint32_t(*_pos - '0');
+                if (mantissa) digits++;
+                scale--;
+            }
+            _pos++;
+        }
+    }
+    if (_pos < _end && (*_pos == 'e' || *_pos == 'E')) {
+        _pos++;
+        bool negativeExponent = false;
+        if (_pos < _end && (*_pos == '+' || *_pos == '-')) {
+            negativeExponent = *_pos == '-';
+            _pos++;
+        }
+        if (_pos >= _end || *_pos < '0' || *_pos > '9') return fail();
+        int32_t exponent = 0;
+        while (_pos < _end && *_pos >= '0' && *_pos <= '9') {
+            if (exponent < 1000) exponent = exponent * 10 + (*_pos - '0');
+            _pos++;
+        }
+        scale += negativeExponent ? -exponent : exponent;
+    }
+    return true;
+}
+
+bool JsonReader::readInteger(int32_t& out) {
+    bool negative;
+    uint32_t mantissa;
+    int32_t scale;
+    if (!readDecimal(negative, mantissa, scale)) return false;
+
+    uint64_t value = mantissa;
+    for (; scale > 0 && value <= INT32_MAX; scale--) value *= 10;
+    for (; scale < 0 && value > 0; scale++) value /= 10;
+    if (value > INT32_MAX) value = INT32_MAX;
+    out = negative ? -int32_t(value) : int32_t(value);
+    return true;
+}
+
+bool JsonReader::readNumber(float& out) {
+    bool negative;
+    uint32_t mantissa;
+    int32_t scale;
+    if (!readDecimal(negative, mantissa, scale)) return false;
+
+    // Além de ±45 a escala já saturou o float (0 ou infinito)
+    double value = mantissa;
+    for (; scale > 0 && scale <= 45; scale--) value *= 10;
+    for (; scale < 0 && scale >= -45; scale++) value /= 10;
+    if (scale > 0 && value) value = HUGE_VAL;
+    if (scale < 0) value = 0;
+    out = float(negative ? -value : value);
+    return true;
+}
+
+bool JsonReader::readBool(bool& out) {
+    skipWhitespace();
+    if (_failed || _pos >= _end) return fail();
+    if (*_pos == 't' && skipLiteral("true")) {
+        out = true;
+        return true;
+    }
+    if (*_pos == 'f' && skipLiteral("false")) {
+        out = false;
+        return true;
+    }
+    return fail();
+}
+
+bool JsonReader::skipLiteral(const char* literal) {
+    size_t length = strlen(literal);
+    if (size_t(_end - _pos) < length || memcmp(_pos, literal, length) != 0) return fail();
+    _pos += length;
+    return true;
+}
+
+bool JsonReader::skipNumber() {
+    int32_t ignored;
+    return readInteger(ignored);
+}
+
+bool JsonReader::skipValue() {
+    skipWhitespace();
+    if (_failed || _pos >= _end) return fail();
+    JsonSlice ignored;
+    switch (*_pos) {
+        case '"': return readString(ignored);
+        case '{': return skipContainer('{', '}');
+        case '[': return skipContainer('[', ']');
+        case 't': return skipLiteral("true");
+        case 'f': return skipLiteral("false");
+        case 'n': return skipLiteral("null");
+        default:  return skipNumber();
+    }
+}
+
+bool JsonReader::skipContainer(char open, char close) {
+    if (_depth >= MAX_DEPTH) return fail();
+    _depth++;
+    _pos++;     // open
+    (void)open;
+
+    bool first = true;
+    while (true) {
+        if (consume(close)) break;
+        if (!first && !consume(',')) return fail();
+        if (close == '}') {
+            JsonSlice key;
+            if (!readString(key) || !consume(':')) return fail();
+        }
+        if (!skipValue()) return fail();
+        first = false;
+    }
+    _depth--;
+    _expectComma = true;
+    return true;
+}
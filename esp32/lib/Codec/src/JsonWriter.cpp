@@ -0,0 +1,231 @@
+#include "JsonWriter.h"
+#include <math.h>
+
+namespace {
+
+// Potências binárias de 10 usadas pelo ArduinoJson para normalizar o expoente
+constexpr double POSITIVE_POWERS[] = {1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256};
+constexpr double NEGATIVE_POWERS[] = {1e-1, 1e-2, 1e-4, 1e-8, 1e-16, 1e-32, 1e-64, 1e-128, 1e-256};
+constexpr double NEGATIVE_POWERS_PLUS_ONE[] = {1e0, 1e-1, 1e-3, 1e-7, 1e-15, 1e-31, 1e-63, 1e-127, 1e-255};
+
+constexpr double POSITIVE_EXPONENTIATION_THRESHOLD = 1e7;
+constexpr double NEGATIVE_EXPONENTIATION_THRESHOLD = 1e-5;
+
+int16_t normalize(double& value) {
+    int16_t powersOf10 = 0;
+    int8_t index = 8;
+    int bit = 1 << index;
+
+    if (value >= POSITIVE_EXPONENTIATION_THRESHOLD) {
+        for (; index >= 0; index--) {
+            if (value >= POSITIVE_POWERS[index]) {
+                value *= NEGATIVE_POWERS[index];
+                powersOf10 = int16_t(powersOf10 + bit);
+            }
+            bit >>= 1;
+        }
+    }
+
+    if (value > 0 && value <= NEGATIVE_EXPONENTIATION_THRESHOLD) {
+        for (; index >= 0; index--) {
+            if (value < NEGATIVE_POWERS_PLUS_ONE[index]) {
+                value *= POSITIVE_POWERS[index];
+                powersOf10 = int16_t(powersOf10 - bit);
+            }
+            bit >>= 1;
+        }
+    }
+
+    return powersOf10;
+}
+
+} // namespace
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity)
+    : _buffer(buffer),
+      _capacity(capacity),
+      _length(0),
+      _overflow(capacity == 0),
+      _needComma(false) {
+}
+
+void JsonWriter::raw(char c) {
+    // Reserva sempre um byte para o '\0'
+    if (_length + 1 >= _capacity) {
+        _overflow = true;
+        return;
+    }
+    _buffer[_length++] = c;
+}
+
+void JsonWriter::raw(const char* str) {
+    while (*str) {
+        raw(*str++);
+    }
+}
+
+void JsonWriter::raw(const char* begin, const char* end) {
+    while (begin < end) {
+        raw(*begin++);
+    }
+}
+
+void JsonWriter::separator() {
+    if (_needComma) {
+        raw(',');
+    }
+    _needComma = true;
+}
+
+void JsonWriter::beginObject() {
+    separator();
+    raw('{');
+    _needComma = false;
+}
+
+void JsonWriter::endObject() {
+    raw('}');
+    _needComma = true;
+}
+
+void JsonWriter::key(const char* name) {
+    value(name);
+    raw(':');
+    _needComma = false;
+}
+
+void JsonWriter::value(bool b) {
+    separator();
+    raw(b ? "true" : "false");
+}
+
+void JsonWriter::null() {
+    separator();
+    raw("null");
+}
+
+void JsonWriter::writeUnsigned(uint32_t n) {
+    char digits[10];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    do {
+        *--begin = char('0' + n % 10);
+        n /= 10;
+    } while (n);
+    raw(begin, end);
+}
+
+void JsonWriter::value(uint32_t n) {
+    separator();
+    writeUnsigned(n);
+}
+
+void JsonWriter::value(int32_t n) {
+    separator();
+    if (n < 0) {
+        raw('-');
+        writeUnsigned(uint32_t(0) - uint32_t(n));
+    } else {
+        writeUnsigned(uint32_t(n));
+    }
+}
+
+void JsonWriter::writeDecimals(uint32_t decimal, int8_t places) {
+    char digits[16];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    while (places--) {
+        *--begin = char('0' + decimal % 10);
+        decimal /= 10;
+    }
+    *--begin = '.';
+    raw(begin, end);
+}
+
+void JsonWriter::value(double d) {
+    separator();
+
+    if (isnan(d) || isinf(d)) {
+        raw("null");
+        return;
+    }
+
+    if (d < 0.0) {
+        raw('-');
+        d = -d;
+    }
+
+    // Mesmo algoritmo de FloatParts<double> do ArduinoJson 6
+    uint32_t maxDecimalPart = 1000000000;
+    int8_t decimalPlaces = 9;
+    int16_t exponent = normalize(d);
+
+    uint32_t integral = uint32_t(d);
+    for (uint32_t tmp = integral; tmp >= 10; tmp /= 10) {
+        maxDecimalPart /= 10;
+        decimalPlaces--;
+    }
+
+    double remainder = (d - double(integral)) * double(maxDecimalPart);
+    uint32_t decimal = uint32_t(remainder);
+    remainder = remainder - double(decimal);
+
+    decimal += uint32_t(remainder * 2);
+    if (decimal >= maxDecimalPart) {
+        decimal = 0;
+        integral++;
+        if (exponent && integral >= 10) {
+            exponent++;
+            integral = 1;
+        }
+    }
+
+    while (decimal % 10 == 0 && decimalPlaces > 0) {
+        decimal /= 10;
+        decimalPlaces--;
+    }
+
+    writeUnsigned(integral);
+    if (decimalPlaces) {
+        writeDecimals(decimal, decimalPlaces);
+    }
+    if (exponent) {
+        raw('e');
+        if (exponent < 0) {
+            raw('-');
+            writeUnsigned(uint32_t(-exponent));
+        } else {
+            writeUnsigned(uint32_t(exponent));
+        }
+    }
+}
+
+void JsonWriter::value(const char* str) {
+    separator();
+    if (!str) {
+        raw("null");
+        return;
+    }
+    raw('"');
+    for (; *str; str++) {
+        char c = *str;
+        switch (c) {
+            case '"':  raw("\\\""); break;
+            case '\\': raw("\\\\"); break;
+            case '\n': raw("\\n"); break;
+            case '\r': raw("\\r"); break;
+            case '\t': raw("\\t"); break;
+            default:   raw(c); break;
+        }
+    }
+    raw('"');
+}
+
+size_t JsonWriter::finish() {
+    if (_overflow) {
+        if (_capacity) _buffer[0] = '\0';
+        return 0;
+    }
+    _buffer[_length] = '\0';
+    return _length;
+}
@@ -0,0 +1,55 @@
+#include "LegacyCodec.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
+
+CommandParseResult parseLegacyCommand(const uint8_t* payload, size_t length, ACCommand& command) {
+    JsonReader reader(payload, length);
+    if (!reader.beginObject()) return CommandParseResult::MALFORMED;
+
+    bool hasAction = false;
+    bool hasValue = false;
+    JsonSlice action{nullptr, 0};
+    int32_t value = 0;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        if (key.equals("acao") && reader.peek() == JsonType::STRING) {
+            hasAction = reader.readString(action);
+        } else if (key.equals("valor") && reader.peek() == JsonType::NUMBER) {
+            hasValue = reader.readInteger(value);
+        } else {
+            reader.skipValue();
+        }
+    }
+    if (reader.failed()) return CommandParseResult::MALFORMED;
+    if (!hasAction) return CommandParseResult::MISSING_VERB;
+
+    if (action.equals("ligar")) {
+        command = ACCommand{ACCommandType::SET_STATE, 0};
+        command.settings = ACSettings{true, 0, ACMode::COOL, FanSpeed::AUTO};
+        command.fields = STATUS_FIELD_POWER | STATUS_FIELD_MODE | STATUS_FIELD_FAN_SPEED;
+        return CommandParseResult::OK;
+    }
+    if (action.equals("desligar")) {
+        command = ACCommand{ACCommandType::TURN_OFF, 0};
+        return CommandParseResult::OK;
+    }
+    if (action.equals("set_temperatura")) {
+        if (!hasValue || value < 0 || value > 255) return CommandParseResult::INVALID_PARAMETER;
+        command = ACCommand{ACCommandType::SET_STATE, 0};
+        command.settings = ACSettings{true, uint8_t(value), ACMode::AUTO, FanSpeed::AUTO};
+        command.fields = STATUS_FIELD_POWER | STATUS_FIELD_TARGET_TEMP;
+        return CommandParseResult::OK;
+    }
+    return CommandParseResult::UNKNOWN_VERB;
+}
+
+size_t serializeLegacyStatus(const ACStatus& status, char* buffer, size_t capacity) {
+    JsonWriter json(buffer, capacity);
+    json.beginObject();
+    json.key("ligado");
+    json.value(status.isOn);
+    json.key("temperatura");
+    json.value(uint32_t(status.targetTemp));
+    json.endObject();
+    return json.finish();
+}
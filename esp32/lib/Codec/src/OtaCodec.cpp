@@ -0,0 +1,195 @@
+#include "OtaCodec.h"
+#include "CborReader.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
+#include <string.h>
+
+namespace {
+
+const char* const OTA_STATE_NAMES[] = {
+    "OCIOSO",
+    "RECEBENDO",
+    "REINICIANDO",
+    "TESTANDO",
+    "CONFIRMADO",
+    "REVERTIDO",
+    "FALHA",
+};
+
+const char* const OTA_ERROR_NAMES[] = {
+    "NONE",
+    "TAMANHO",
+    "FLASH",
+    "SHA256",
+    "IMAGEM",
+};
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parseSha256(const JsonSlice& text, uint8_t* out) {
+    if (text.length != 2 * OTA_SHA256_BYTES) return false;
+    for (size_t i = 0; i < OTA_SHA256_BYTES; i++) {
+        int high = hexDigit(text.data[2 * i]);
+        int low = hexDigit(text.data[2 * i + 1]);
+        if (high < 0 || low < 0) return false;
+        out[i] = uint8_t(high << 4 | low);
+    }
+    return true;
+}
+
+// A versão volta no relatório JSON: só ASCII visível, sem aspas nem escape
+bool copyVersion(const JsonSlice& text, char* out) {
+    if (text.length == 0 || text.length >= OTA_VERSION_SIZE) return false;
+    for (size_t i = 0; i < text.length; i++) {
+        char c = text.data[i];
+        if (c <= ' ' || c > '~' || c == '"' || c == '\\') return false;
+        out[i] = c;
+    }
+    out[text.length] = '\0';
+    return true;
+}
+
+template <typename Reader>
+CommandParseResult readOfferParameters(Reader& reader, OtaOffer& offer) {
+    if (reader.peek() != JsonType::OBJECT) return CommandParseResult::INVALID_PARAMETER;
+    reader.beginObject();
+
+    bool hasVersion = false;
+    bool hasSize = false;
+    bool hasSha = false;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        JsonType type = reader.peek();
+        bool valid = true;
+        if (key.equals("versao") && type == JsonType::STRING) {
+            JsonSlice version{nullptr, 0};
+            valid = reader.readString(version) && copyVersion(version, offer.version);
+            hasVersion = true;
+        } else if (key.equals("tamanho") && type == JsonType::NUMBER) {
+            int32_t size = 0;
+            valid = reader.readInteger(size) && size > 0;
+            offer.size = uint32_t(size);
+            hasSize = true;
+        } else if (key.equals("sha256") && type == JsonType::STRING) {
+            JsonSlice sha{nullptr, 0};
+            valid = reader.readString(sha) && parseSha256(sha, offer.sha256);
+            hasSha = true;
+        } else if (key.equals("cancelar") && type == JsonType::BOOL) {
+            reader.readBool(offer.cancel);
+        } else {
+            reader.skipValue();
+        }
+        if (reader.failed()) return CommandParseResult::MALFORMED;
+        if (!valid) return CommandParseResult::INVALID_PARAMETER;
+    }
+    if (reader.failed()) return CommandParseResult::MALFORMED;
+    return offer.cancel || (hasVersion && hasSize && hasSha) ? CommandParseResult::OK
+                                                             : CommandParseResult::INVALID_PARAMETER;
+}
+
+template <typename Reader>
+CommandParseResult parseOtaOfferWith(Reader& reader, OtaOffer& offer) {
+    if (!reader.beginObject()) return CommandParseResult::MALFORMED;
+
+    offer.cancel = false;
+    offer.size = 0;
+    offer.version[0] = '\0';
+    memset(offer.sha256, 0, sizeof(offer.sha256));
+
+    bool hasParameters = false;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        if (key.equals("parametros") && !hasParameters) {
+            CommandParseResult result = readOfferParameters(reader, offer);
+            if (result != CommandParseResult::OK) return result;
+            hasParameters = true;
+        } else if (!reader.skipValue()) {
+            break;
+        }
+    }
+    if (reader.failed()) return CommandParseResult::MALFORMED;
+    return hasParameters ? CommandParseResult::OK : CommandParseResult::INVALID_PARAMETER;
+}
+
+}  // namespace
+
+CommandParseResult parseOtaOfferJson(const uint8_t* payload, size_t length, OtaOffer& offer) {
+    JsonReader reader(payload, length);
+    return parseOtaOfferWith(reader, offer);
+}
+
+CommandParseResult parseOtaOfferCbor(const uint8_t* payload, size_t length, OtaOffer& offer) {
+    CborReader reader(payload, length);
+    return parseOtaOfferWith(reader, offer);
+}
+
+CommandParseResult parseOtaOffer(const uint8_t* payload, size_t length, OtaOffer& offer) {
+    if (payloadWireFormat(payload, length) == WireFormat::CBOR) {
+        return parseOtaOfferCbor(payload, length, offer);
+    }
+    return parseOtaOfferJson(payload, length, offer);
+}
+
+bool parseOtaChunk(const uint8_t* payload, size_t length, OtaChunk& chunk) {
+    if (length <= OTA_CHUNK_HEADER_BYTES || length - OTA_CHUNK_HEADER_BYTES > OTA_CHUNK_SIZE) {
+        return false;
+    }
+    chunk.session = otaSessionTag(payload);
+    chunk.index = uint32_t(payload[4]) << 24 | uint32_t(payload[5]) << 16 | uint32_t(payload[6]) << 8 | payload[7];
+    chunk.data = payload + OTA_CHUNK_HEADER_BYTES;
+    chunk.length = length - OTA_CHUNK_HEADER_BYTES;
+    return true;
+}
+
+void packOtaChunkHeader(uint32_t session, uint32_t index, uint8_t* out) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = uint8_t(session >> (24 - 8 * i));
+        out[4 + i] = uint8_t(index >> (24 - 8 * i));
+    }
+}
+
+const char* otaStateName(OtaState state) {
+    size_t i = size_t(state);
+    return i < sizeof(OTA_STATE_NAMES) / sizeof(OTA_STATE_NAMES[0]) ? OTA_STATE_NAMES[i] : "?";
+}
+
+const char* otaErrorName(OtaError error) {
+    size_t i = size_t(error);
+    return i < sizeof(OTA_ERROR_NAMES) / sizeof(OTA_ERROR_NAMES[0]) ? OTA_ERROR_NAMES[i] : "?";
+}
+
+size_t serializeOtaReportJson(const OtaReport& report, char* buffer, size_t capacity) {
+    JsonWriter json(buffer, capacity);
+    json.beginObject();
+    json.key("estado");
+    json.value(otaStateName(report.state));
+    json.key("firmware");
+    json.value(report.firmware);
+    if (report.version[0]) {
+        json.key("versao");
+        json.value(report.version);
+        json.key("proximo");
+        json.value(report.nextChunk);
+        json.key("tamanho");
+        json.value(report.size);
+    }
+    json.key("bloco");
+    json.value(uint32_t(OTA_CHUNK_SIZE));
+    json.key("janela");
+    json.value(uint32_t(report.window));
+    if (report.gap) {
+        json.key("lacuna");
+        json.value(true);
+    }
+    if (report.error != OtaError::NONE) {
+        json.key("erro");
+        json.value(otaErrorName(report.error));
+    }
+    json.endObject();
+    return json.finish();
+}
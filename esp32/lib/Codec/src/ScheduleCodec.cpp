@@ -0,0 +1,278 @@
+#include "ScheduleCodec.h"
+#include "CborReader.h"
+#include "JsonReader.h"
+
+namespace {
+
+constexpr uint8_t FLAG_ON = 1 << 0;
+constexpr uint8_t FLAG_POWER = 1 << 7;
+constexpr uint8_t MODE_SHIFT = 1;
+constexpr uint8_t FAN_SHIFT = 4;
+
+// Nome do protocolo -> índice + 1; 0 se desconhecido (na agenda gravada um
+// nome errado não pode virar AUTOMATICO em silêncio)
+template <size_t N>
+uint8_t codeFromName(const JsonSlice& name, const char* const (&names)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        if (name.equals(names[i])) return uint8_t(i + 1);
+    }
+    return 0;
+}
+
+bool digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// "HH:MM" -> minuto do dia
+bool parseTime(const JsonSlice& text, uint16_t& minute) {
+    const char* s = text.data;
+    if (text.length != 5 || !digit(s[0]) || !digit(s[1]) || s[2] != ':' || !digit(s[3]) || !digit(s[4])) {
+        return false;
+    }
+    int hours = (s[0] - '0') * 10 + (s[1] - '0');
+    int minutes = (s[3] - '0') * 10 + (s[4] - '0');
+    if (hours > 23 || minutes > 59) return false;
+    minute = uint16_t(hours * 60 + minutes);
+    return true;
+}
+
+// "12345" -> máscara de dias (bit 0 = domingo)
+bool parseDays(const JsonSlice& text, uint8_t& days) {
+    days = 0;
+    for (size_t i = 0; i < text.length; i++) {
+        char c = text.data[i];
+        if (c < '0' || c > '6') return false;
+        days |= uint8_t(1 << (c - '0'));
+    }
+    return days != 0;
+}
+
+// Insere em ordem; no mesmo minuto a transição nova substitui a anterior
+bool insertTransition(ScheduleTable& table, const ScheduleTransition& transition) {
+    size_t low = 0;
+    size_t high = table.count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (table.transitions[mid].minute < transition.minute) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < table.count && table.transitions[low].minute == transition.minute) {
+        table.transitions[low] = transition;
+        return true;
+    }
+    if (table.count == SCHEDULE_MAX_TRANSITIONS) return false;
+    for (size_t i = table.count; i > low; i--) {
+        table.transitions[i] = table.transitions[i - 1];
+    }
+    table.transitions[low] = transition;
+    table.count++;
+    return true;
+}
+
+// [dias, "HH:MM", ligado, temperatura, modo, velocidade]; do terceiro em
+// diante podem faltar ou ser null. Reader é JsonReader ou CborReader.
+template <typename Reader>
+CommandParseResult readTransition(Reader& reader, ScheduleTable& table) {
+    if (reader.peek() != JsonType::ARRAY) return CommandParseResult::INVALID_PARAMETER;
+    reader.beginArray();
+
+    JsonSlice days{nullptr, 0};
+    JsonSlice time{nullptr, 0};
+    ScheduleTransition transition{0, 0, 0};
+    size_t index = 0;
+    while (reader.nextElement()) {
+        JsonType type = reader.peek();
+        bool valid = true;
+        if (type == JsonType::NUL) {
+            valid = index >= 2 && reader.skipValue();
+        } else if (index == 0) {
+            valid = type == JsonType::STRING && reader.readString(days);
+        } else if (index == 1) {
+            valid = type == JsonType::STRING && reader.readString(time);
+        } else if (index == 2) {
+            bool on = false;
+            valid = type == JsonType::BOOL && reader.readBool(on);
+            transition.flags |= FLAG_POWER | (on ? FLAG_ON : 0);
+        } else if (index == 3) {
+            int32_t temp = 0;
+            valid = type == JsonType::NUMBER && reader.readInteger(temp) && temp >= 16 && temp <= 30;
+            transition.targetTemp = uint8_t(temp);
+        } else if (index == 4 || index == 5) {
+            JsonSlice name{nullptr, 0};
+            valid = type == JsonType::STRING && reader.readString(name);
+            uint8_t code = index == 4 ? codeFromName(name, AC_MODE_NAMES) : codeFromName(name, FAN_SPEED_NAMES);
+            valid = valid && code;
+            transition.flags |= uint8_t(code << (index == 4 ? MODE_SHIFT : FAN_SHIFT));
+        } else {
+            valid = false;
+        }
+        if (reader.failed()) return CommandParseResult::MALFORMED;
+        if (!valid) return CommandParseResult::INVALID_PARAMETER;
+        index++;
+    }
+    if (reader.failed()) return CommandParseResult::MALFORMED;
+
+    uint8_t dayMask = 0;
+    uint16_t minuteOfDay = 0;
+    if (index < 2 || !parseDays(days, dayMask) || !parseTime(time, minuteOfDay)) {
+        return CommandParseResult::INVALID_PARAMETER;
+    }
+    // Uma transição que não muda nada é erro de quem montou a agenda
+    if (!transition.targetTemp && !transition.flags) return CommandParseResult::INVALID_PARAMETER;
+
+    for (uint8_t day = 0; day < 7; day++) {
+        if (!(dayMask & (1 << day))) continue;
+        transition.minute = uint16_t(day * MINUTES_PER_DAY + minuteOfDay);
+        if (!insertTransition(table, transition)) return CommandParseResult::INVALID_PARAMETER;
+    }
+    return CommandParseResult::OK;
+}
+
+template <typename Reader>
+CommandParseResult readScheduleParameters(Reader& reader, ScheduleTable& table) {
+    if (reader.peek() != JsonType::OBJECT) return CommandParseResult::INVALID_PARAMETER;
+    reader.beginObject();
+
+    bool hasVersion = false;
+    bool hasTransitions = false;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        JsonType type = reader.peek();
+        CommandParseResult result = CommandParseResult::OK;
+        if (key.equals("versao") && type == JsonType::NUMBER) {
+            int32_t version = 0;
+            if (reader.readInteger(version) && version < 1) result = CommandParseResult::INVALID_PARAMETER;
+            table.version = uint32_t(version);
+            hasVersion = true;
+        } else if (key.equals("fuso") && type == JsonType::NUMBER) {
+            int32_t offset = 0;
+            if (reader.readInteger(offset) && (offset < -720 || offset > 840)) {
+                result = CommandParseResult::INVALID_PARAMETER;
+            }
+            table.utcOffset = int16_t(offset);
+        } else if (key.equals("ativa") && type == JsonType::BOOL) {
+            reader.readBool(table.enabled);
+        } else if (key.equals("transicoes") && type == JsonType::ARRAY) {
+            reader.beginArray();
+            while (result == CommandParseResult::OK && reader.nextElement()) {
+                result = readTransition(reader, table);
+            }
+            hasTransitions = true;
+        } else {
+            reader.skipValue();
+        }
+        if (reader.failed()) return CommandParseResult::MALFORMED;
+        if (result != CommandParseResult::OK) return result;
+    }
+    if (reader.failed()) return CommandParseResult::MALFORMED;
+    return hasVersion && hasTransitions ? CommandParseResult::OK : CommandParseResult::INVALID_PARAMETER;
+}
+
+template <typename Reader>
+CommandParseResult parseScheduleWith(Reader& reader, ScheduleTable& table) {
+    if (!reader.beginObject()) return CommandParseResult::MALFORMED;
+
+    table.version = 0;
+    table.utcOffset = 0;
+    table.enabled = true;
+    table.count = 0;
+
+    bool hasParameters = false;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        if (key.equals("parametros") && !hasParameters) {
+            CommandParseResult result = readScheduleParameters(reader, table);
+            if (result != CommandParseResult::OK) return result;
+            hasParameters = true;
+        } else if (!reader.skipValue()) {
+            break;
+        }
+    }
+    if (reader.failed()) return CommandParseResult::MALFORMED;
+    return hasParameters ? CommandParseResult::OK : CommandParseResult::INVALID_PARAMETER;
+}
+
+}  // namespace
+
+ACCommand ScheduleTransition::command() const {
+    ACCommand command{ACCommandType::SET_STATE, 0};
+    if (flags & FLAG_POWER) {
+        command.settings.isOn = flags & FLAG_ON;
+        command.fields |= STATUS_FIELD_POWER;
+    }
+    if (targetTemp) {
+        command.settings.targetTemp = targetTemp;
+        command.fields |= STATUS_FIELD_TARGET_TEMP;
+    }
+    uint8_t mode = (flags >> MODE_SHIFT) & 7;
+    if (mode) {
+        command.settings.mode = ACMode(mode - 1);
+        command.fields |= STATUS_FIELD_MODE;
+    }
+    uint8_t fan = (flags >> FAN_SHIFT) & 7;
+    if (fan) {
+        command.settings.fanSpeed = FanSpeed(fan - 1);
+        command.fields |= STATUS_FIELD_FAN_SPEED;
+    }
+    return command;
+}
+
+CommandParseResult parseScheduleJson(const uint8_t* payload, size_t length, ScheduleTable& table) {
+    JsonReader reader(payload, length);
+    return parseScheduleWith(reader, table);
+}
+
+CommandParseResult parseScheduleCbor(const uint8_t* payload, size_t length, ScheduleTable& table) {
+    CborReader reader(payload, length);
+    return parseScheduleWith(reader, table);
+}
+
+CommandParseResult parseSchedule(const uint8_t* payload, size_t length, ScheduleTable& table) {
+    if (payloadWireFormat(payload, length) == WireFormat::CBOR) {
+        return parseScheduleCbor(payload, length, table);
+    }
+    return parseScheduleJson(payload, length, table);
+}
+
+size_t packScheduleTable(const ScheduleTable& table, uint8_t* out) {
+    out[0] = SCHEDULE_BLOB_FORMAT;
+    out[1] = table.count;
+    out[2] = uint8_t(uint16_t(table.utcOffset));
+    out[3] = uint8_t(uint16_t(table.utcOffset) >> 8);
+    for (int i = 0; i < 4; i++) out[4 + i] = uint8_t(table.version >> (8 * i));
+    out[8] = table.enabled ? 1 : 0;
+    uint8_t* p = out + SCHEDULE_BLOB_HEADER_BYTES;
+    for (size_t i = 0; i < table.count; i++) {
+        const ScheduleTransition& t = table.transitions[i];
+        *p++ = uint8_t(t.minute);
+        *p++ = uint8_t(t.minute >> 8);
+        *p++ = t.targetTemp;
+        *p++ = t.flags;
+    }
+    return size_t(p - out);
+}
+
+bool unpackScheduleTable(const uint8_t* in, size_t length, ScheduleTable& table) {
+    if (length < SCHEDULE_BLOB_HEADER_BYTES || in[0] != SCHEDULE_BLOB_FORMAT) return false;
+    size_t count = in[1];
+    if (count > SCHEDULE_MAX_TRANSITIONS || length != SCHEDULE_BLOB_HEADER_BYTES + 4 * count) return false;
+
+    table.count = uint8_t(count);
+    table.utcOffset = int16_t(uint16_t(in[2] | in[3] << 8));
+    table.version = 0;
+    for (int i = 0; i < 4; i++) table.version |= uint32_t(in[4 + i]) << (8 * i);
+    table.enabled = in[8] != 0;
+    const uint8_t* p = in + SCHEDULE_BLOB_HEADER_BYTES;
+    for (size_t i = 0; i < count; i++, p += 4) {
+        ScheduleTransition& t = table.transitions[i];
+        t.minute = uint16_t(p[0] | p[1] << 8);
+        t.targetTemp = p[2];
+        t.flags = p[3];
+        // A busca binária depende da ordem estrita
+        if (t.minute >= MINUTES_PER_WEEK || (i && t.minute <= table.transitions[i - 1].minute)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,265 @@
+#include "StatusCodec.h"
+#include "CborReader.h"
+#include "CborWriter.h"
+#include "CommandCodec.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
+#include <math.h>
+
+// Os dois formatos saem do mesmo código: Writer é JsonWriter ou CborWriter
+template <typename Writer>
+static void writeFields(Writer& json, const ACStatus& status, uint8_t fields) {
+    if (fields & STATUS_FIELD_POWER) {
+        json.key(WireKey::LIGADO);
+        json.value(status.isOn);
+    }
+    if (fields & STATUS_FIELD_CURRENT_TEMP) {
+        json.key(WireKey::TEMPERATURA_ATUAL);
+        json.value(double(status.currentTemp));
+    }
+    if (fields & STATUS_FIELD_HUMIDITY) {
+        json.key(WireKey::UMIDADE);
+        json.value(double(status.currentHumidity));
+    }
+    if (fields & STATUS_FIELD_TARGET_TEMP) {
+        json.key(WireKey::TEMPERATURA_DESEJADA);
+        json.value(uint32_t(status.targetTemp));
+    }
+    if (fields & STATUS_FIELD_MODE) {
+        json.key(WireKey::MODO_OPERACAO);
+        json.value(acModeName(status.mode));
+    }
+    if (fields & STATUS_FIELD_FAN_SPEED) {
+        json.key(WireKey::VELOCIDADE_VENTILADOR);
+        json.value(fanSpeedName(status.fanSpeed));
+    }
+    if (fields & STATUS_FIELD_SENSOR) {
+        json.key(WireKey::SENSOR_STATUS);
+        json.beginObject();
+        json.key(WireKey::TEMPERATURA);
+        json.value(sensorHealthName(status.temperatureHealth));
+        json.key(WireKey::UMIDADE);
+        json.value(sensorHealthName(status.humidityHealth));
+        json.endObject();
+    }
+    if (fields & STATUS_FIELD_THERMOSTAT) {
+        json.key(WireKey::TERMOSTATO);
+        json.beginObject();
+        json.key(WireKey::ATIVO);
+        json.value(status.thermostatEnabled);
+        json.key(WireKey::DEMANDA);
+        json.value(status.thermostatDemand);
+        json.endObject();
+    }
+}
+
+// Na resolução do sensor (0,1): a média não tem mais precisão que isso
+static double tenths(float value) {
+    return double(roundf(value * 10.0f)) / 10.0;
+}
+
+template <typename Writer>
+static void writeStats(Writer& json, WireKey name, const SensorStats& stats) {
+    if (!stats.samples) return;
+    json.key(name);
+    json.beginObject();
+    json.key(WireKey::MIN);
+    json.value(tenths(stats.min));
+    json.key(WireKey::MAX);
+    json.value(tenths(stats.max));
+    json.key(WireKey::MEDIA);
+    json.value(tenths(stats.mean));
+    json.key(WireKey::AMOSTRAS);
+    json.value(uint32_t(stats.samples));
+    json.endObject();
+}
+
+template <typename Writer>
+static void writeStatus(Writer& json, const ACStatus& status) {
+    json.beginObject();
+    json.key(WireKey::ONLINE);
+    json.value(true);
+    writeFields(json, status, STATUS_FIELD_ALL);
+    if (status.temperatureStats.samples || status.humidityStats.samples) {
+        json.key(WireKey::JANELA);
+        json.beginObject();
+        writeStats(json, WireKey::TEMPERATURA, status.temperatureStats);
+        writeStats(json, WireKey::UMIDADE, status.humidityStats);
+        json.endObject();
+    }
+    if (status.scheduleVersion) {
+        json.key(WireKey::AGENDA);
+        json.beginObject();
+        json.key(WireKey::VERSAO);
+        json.value(status.scheduleVersion);
+        json.key(WireKey::ATIVA);
+        json.value(status.scheduleEnabled);
+        json.key(WireKey::RELOGIO);
+        json.value(status.clockSynced);
+        json.endObject();
+    }
+    // Anuncia a codificação: quem lê em JSON fica sabendo que pode pedir CBOR
+    json.key(WireKey::FORMATO);
+    json.value(wireFormatName(status.wireFormat));
+    json.endObject();
+}
+
+size_t serializeStatusJson(const ACStatus& status, char* buffer, size_t capacity) {
+    JsonWriter json(buffer, capacity);
+    writeStatus(json, status);
+    return json.finish();
+}
+
+size_t serializeStatusDeltaJson(const ACStatus& status, uint8_t fields,
+                                char* buffer, size_t capacity) {
+    JsonWriter json(buffer, capacity);
+
+    json.beginObject();
+    writeFields(json, status, fields);
+    json.endObject();
+
+    return json.finish();
+}
+
+size_t serializeStatusCbor(const ACStatus& status, uint8_t* buffer, size_t capacity) {
+    CborWriter cbor(buffer, capacity);
+    writeStatus(cbor, status);
+    return cbor.finish();
+}
+
+size_t serializeStatusDeltaCbor(const ACStatus& status, uint8_t fields,
+                                uint8_t* buffer, size_t capacity) {
+    CborWriter cbor(buffer, capacity);
+
+    cbor.beginObject();
+    writeFields(cbor, status, fields);
+    cbor.endObject();
+
+    return cbor.finish();
+}
+
+size_t serializeStatus(const ACStatus& status, WireFormat format, uint8_t* buffer, size_t capacity) {
+    if (format == WireFormat::CBOR) return serializeStatusCbor(status, buffer, capacity);
+    return serializeStatusJson(status, reinterpret_cast<char*>(buffer), capacity);
+}
+
+size_t serializeStatusDelta(const ACStatus& status, uint8_t fields, WireFormat format,
+                            uint8_t* buffer, size_t capacity) {
+    if (format == WireFormat::CBOR) return serializeStatusDeltaCbor(status, fields, buffer, capacity);
+    return serializeStatusDeltaJson(status, fields, reinterpret_cast<char*>(buffer), capacity);
+}
+
+// Número ou null (sensor sem leitura)
+template <typename Reader>
+static bool readReading(Reader& reader, float& value) {
+    if (reader.peek() == JsonType::NUL) {
+        value = NAN;
+        return reader.skipValue();
+    }
+    return reader.peek() == JsonType::NUMBER && reader.readNumber(value);
+}
+
+template <typename Reader>
+static bool readEnum(Reader& reader, const char* const* names, size_t count, uint8_t& index) {
+    JsonSlice name;
+    if (reader.peek() != JsonType::STRING || !reader.readString(name)) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (name.equals(names[i])) {
+            index = uint8_t(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Reader, size_t N>
+static bool readEnum(Reader& reader, const char* const (&names)[N], uint8_t& index) {
+    return readEnum(reader, names, N, index);
+}
+
+// Objeto de dois campos do mesmo tipo: sensorStatus e termostato
+template <typename Reader, typename Read>
+static bool readPair(Reader& reader, const char* first, const char* second, Read read) {
+    if (reader.peek() != JsonType::OBJECT || !reader.beginObject()) return false;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        bool ok;
+        if (key.equals(first)) {
+            ok = read(reader, 0);
+        } else if (key.equals(second)) {
+            ok = read(reader, 1);
+        } else {
+            ok = reader.skipValue();
+        }
+        if (!ok) return false;
+    }
+    return !reader.failed();
+}
+
+template <typename Reader>
+static bool readStatus(Reader& reader, ACStatus& status, uint8_t& fields) {
+    if (!reader.beginObject()) return false;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        bool ok;
+        uint8_t index = 0;
+        if (key.equals("ligado")) {
+            ok = reader.peek() == JsonType::BOOL && reader.readBool(status.isOn);
+            fields |= STATUS_FIELD_POWER;
+        } else if (key.equals("temperaturaAtual")) {
+            ok = readReading(reader, status.currentTemp);
+            fields |= STATUS_FIELD_CURRENT_TEMP;
+        } else if (key.equals("umidade")) {
+            ok = readReading(reader, status.currentHumidity);
+            fields |= STATUS_FIELD_HUMIDITY;
+        } else if (key.equals("temperaturaDesejada")) {
+            int32_t temp = 0;
+            ok = reader.peek() == JsonType::NUMBER && reader.readInteger(temp) && temp >= 0 && temp <= 255;
+            status.targetTemp = uint8_t(temp);
+            fields |= STATUS_FIELD_TARGET_TEMP;
+        } else if (key.equals("modoOperacao")) {
+            ok = readEnum(reader, AC_MODE_NAMES, index);
+            status.mode = ACMode(index);
+            fields |= STATUS_FIELD_MODE;
+        } else if (key.equals("velocidadeVentilador")) {
+            ok = readEnum(reader, FAN_SPEED_NAMES, index);
+            status.fanSpeed = FanSpeed(index);
+            fields |= STATUS_FIELD_FAN_SPEED;
+        } else if (key.equals("sensorStatus")) {
+            ok = readPair(reader, "temperatura", "umidade", [&status](Reader& r, int which) {
+                uint8_t health = 0;
+                if (!readEnum(r, SENSOR_HEALTH_NAMES, health)) return false;
+                (which ? status.humidityHealth : status.temperatureHealth) = SensorHealth(health);
+                return true;
+            });
+            fields |= STATUS_FIELD_SENSOR;
+        } else if (key.equals("termostato")) {
+            ok = readPair(reader, "ativo", "demanda", [&status](Reader& r, int which) {
+                return r.peek() == JsonType::BOOL
+                    && r.readBool(which ? status.thermostatDemand : status.thermostatEnabled);
+            });
+            fields |= STATUS_FIELD_THERMOSTAT;
+        } else {
+            ok = reader.skipValue();
+        }
+        if (!ok) return false;
+    }
+    return !reader.failed();
+}
+
+bool parseStatus(const uint8_t* payload, size_t length, ACStatus& status, uint8_t& fields) {
+    ACStatus parsed = status;
+    uint8_t present = 0;
+    bool ok;
+    if (payloadWireFormat(payload, length) == WireFormat::CBOR) {
+        CborReader reader(payload, length);
+        ok = readStatus(reader, parsed, present);
+    } else {
+        JsonReader reader(payload, length);
+        ok = readStatus(reader, parsed, present);
+    }
+    if (!ok) return false;
+    status = parsed;
+    fields = present;
+    return true;
+}
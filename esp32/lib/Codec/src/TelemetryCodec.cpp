@@ -0,0 +1,141 @@
+#include "TelemetryCodec.h"
+#include <math.h>
+#include <string.h>
+
+TelemetryRecord telemetryRecordFromStatus(const ACStatus& status, uint32_t time) {
+    TelemetryRecord record;
+    record.time = time;
+    record.temperature = isnan(status.currentTemp)
+        ? TELEMETRY_NO_TEMPERATURE
+        : int16_t(lroundf(status.currentTemp * 10.0f));
+    record.humidity = isnan(status.currentHumidity) || status.currentHumidity < 0.0f
+        ? TELEMETRY_NO_HUMIDITY
+        : uint16_t(lroundf(status.currentHumidity * 10.0f));
+    record.state = uint8_t((status.isOn ? 0x80 : 0) | (status.targetTemp & 0x7F));
+    return record;
+}
+
+void packTelemetryRecord(const TelemetryRecord& record, uint8_t* out) {
+    out[0] = uint8_t(record.time);
+    out[1] = uint8_t(record.time >> 8);
+    out[2] = uint8_t(record.time >> 16);
+    out[3] = uint8_t(record.time >> 24);
+    out[4] = uint8_t(uint16_t(record.temperature));
+    out[5] = uint8_t(uint16_t(record.temperature) >> 8);
+    out[6] = uint8_t(record.humidity);
+    out[7] = uint8_t(record.humidity >> 8);
+    out[8] = record.state;
+}
+
+TelemetryRecord unpackTelemetryRecord(const uint8_t* in) {
+    TelemetryRecord record;
+    record.time = uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+    record.temperature = int16_t(uint16_t(in[4] | in[5] << 8));
+    record.humidity = uint16_t(in[6] | in[7] << 8);
+    record.state = in[8];
+    return record;
+}
+
+namespace {
+
+uint32_t zigzag(int32_t value) {
+    return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+}
+
+int32_t unzigzag(uint32_t value) {
+    return int32_t(value >> 1) ^ -int32_t(value & 1);
+}
+
+size_t putVarint(uint8_t* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = uint8_t(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = uint8_t(value);
+    return n;
+}
+
+bool getVarint(const uint8_t* in, size_t length, size_t& pos, uint32_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (pos >= length) return false;
+        uint8_t byte = in[pos++];
+        value |= uint32_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+size_t encodeTelemetryBatch(const TelemetryRecord* records, size_t count, uint32_t now,
+                            uint8_t* buffer, size_t capacity, size_t& encoded) {
+    encoded = 0;
+    if (count == 0 || capacity < TELEMETRY_BATCH_HEADER_BYTES + TELEMETRY_RECORD_BYTES) {
+        return 0;
+    }
+    if (count > TELEMETRY_BATCH_MAX_RECORDS) count = TELEMETRY_BATCH_MAX_RECORDS;
+
+    buffer[0] = TELEMETRY_BATCH_VERSION;
+    buffer[2] = uint8_t(now);
+    buffer[3] = uint8_t(now >> 8);
+    buffer[4] = uint8_t(now >> 16);
+    buffer[5] = uint8_t(now >> 24);
+    size_t length = TELEMETRY_BATCH_HEADER_BYTES;
+    packTelemetryRecord(records[0], buffer + length);
+    length += TELEMETRY_RECORD_BYTES;
+    encoded = 1;
+
+    // Cada registro é montado num rascunho e só entra se couber inteiro
+    uint8_t scratch[TELEMETRY_DELTA_MAX_BYTES];
+    for (size_t i = 1; i < count; i++) {
+        const TelemetryRecord& prev = records[i - 1];
+        const TelemetryRecord& cur = records[i];
+        bool stateChanged = cur.state != prev.state;
+        size_t n = putVarint(scratch, (cur.time - prev.time) << 1 | (stateChanged ? 1 : 0));
+        n += putVarint(scratch + n, zigzag(int32_t(cur.temperature) - prev.temperature));
+        n += putVarint(scratch + n, zigzag(int32_t(cur.humidity) - prev.humidity));
+        if (stateChanged) scratch[n++] = cur.state;
+        if (length + n > capacity) break;
+        memcpy(buffer + length, scratch, n);
+        length += n;
+        encoded++;
+    }
+    buffer[1] = uint8_t(encoded);
+    return length;
+}
+
+size_t decodeTelemetryBatch(const uint8_t* buffer, size_t length,
+                            TelemetryRecord* out, size_t capacity, uint32_t& now) {
+    if (length < TELEMETRY_BATCH_HEADER_BYTES + TELEMETRY_RECORD_BYTES
+        || buffer[0] != TELEMETRY_BATCH_VERSION) {
+        return 0;
+    }
+    size_t count = buffer[1];
+    if (count == 0 || count > capacity) return 0;
+    now = uint32_t(buffer[2]) | uint32_t(buffer[3]) << 8 | uint32_t(buffer[4]) << 16 | uint32_t(buffer[5]) << 24;
+
+    size_t pos = TELEMETRY_BATCH_HEADER_BYTES;
+    out[0] = unpackTelemetryRecord(buffer + pos);
+    pos += TELEMETRY_RECORD_BYTES;
+    for (size_t i = 1; i < count; i++) {
+        uint32_t timeTag, temperature, humidity;
+        if (!getVarint(buffer, length, pos, timeTag)
+            || !getVarint(buffer, length, pos, temperature)
+            || !getVarint(buffer, length, pos, humidity)) {
+            return 0;
+        }
+        TelemetryRecord& cur = out[i];
+        const TelemetryRecord& prev = out[i - 1];
+        cur.time = prev.time + (timeTag >> 1);
+        cur.temperature = int16_t(prev.temperature + unzigzag(temperature));
+        cur.humidity = uint16_t(prev.humidity + unzigzag(humidity));
+        cur.state = prev.state;
+        if (timeTag & 1) {
+            if (pos >= length) return 0;
+            cur.state = buffer[pos++];
+        }
+    }
+    return pos == length ? count : 0;
+}
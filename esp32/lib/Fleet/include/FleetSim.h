@@ -0,0 +1,143 @@
+#ifndef FLEET_SIM_H
+#define FLEET_SIM_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include <memory>
+#include <vector>
+#include "ACState.h"
+#include "config.h"
+
+// Frota simulada para planejar a capacidade do broker: N dispositivos com o
+// firmware de verdade (NetworkManager + ControlLoop + ACController, filas e
+// telemetria como em main.cpp; IR no RMT substituto e leituras sintéticas no
+// lugar do DHT22) e um servidor que envia SET_STATE a uma taxa fixa e mede o
+// tempo até o status que confirma cada um.
+//
+// Sem 'broker' tudo roda no FakeBroker em tempo virtual (rápido e
+// determinístico: mede o tráfego que o firmware gera). Com 'broker' os
+// dispositivos abrem cada um o seu socket para um broker de verdade, como o
+// Mosquitto de mosquitto/, e o relógio virtual acompanha o tempo real.
+//
+// Só para o host: usa o heap e é dona dos substitutos globais (relógio,
+// WiFi, FakeBroker) enquanto roda, então só uma FleetSim por vez.
+struct FleetConfig {
+    uint16_t devices = 100;
+    float commandsPerSecond = 5.0f;     // total da frota
+    uint32_t durationMs = 600000;       // janela medida, depois de todos conectarem
+    uint32_t connectTimeoutMs = 60000;
+    uint32_t stepMs = 10;               // passo do loop, como o vTaskDelay da tarefa de rede
+    uint32_t sampleIntervalMs = 2000;   // leituras sintéticas do sensor
+    const char* broker = nullptr;       // host do broker real; nullptr = FakeBroker
+    uint16_t port = MQTT_PORT;
+    const char* user = MQTT_USER;
+    const char* password = MQTT_PASSWORD;
+    const char* idPrefix = "SIM";
+    uint32_t seed = 1;
+    WireFormat wireFormat = WireFormat::JSON;   // de comandos e status
+};
+
+// Publicações vistas pelo servidor, por tipo de tópico
+struct FleetTraffic {
+    uint32_t status = 0;
+    uint32_t delta = 0;
+    uint32_t telemetry = 0;
+    uint32_t diagnostics = 0;
+    uint32_t errors = 0;
+    uint32_t commands = 0;
+    uint32_t other = 0;
+    uint64_t bytes = 0;
+
+    uint32_t fromDevices() const { return status + delta + telemetry + diagnostics + errors; }
+};
+
+struct FleetReport {
+    uint16_t devices = 0;
+    uint16_t connected = 0;             // assinando comandos ao fim da janela
+    bool realBroker = false;
+    uint32_t windowMs = 0;              // janela medida (tempo virtual ou real)
+    double wallSeconds = 0;             // tempo real gasto na janela
+
+    uint32_t commandsSent = 0;
+    uint32_t commandsAnswered = 0;
+    uint32_t commandsUnanswered = 0;    // sem status até o fim da janela
+    uint32_t commandsDeferred = 0;      // taxa maior que a frota: todos ocupados
+
+    // Comando -> primeiro status com o estado pedido, em microssegundos
+    uint32_t latencyP50Us = 0;
+    uint32_t latencyP90Us = 0;
+    uint32_t latencyP99Us = 0;
+    uint32_t latencyMaxUs = 0;
+
+    FleetTraffic traffic;
+
+    // Contadores do próprio broker na janela: FakeBroker, ou os $SYS do
+    // Mosquitto (publicados a cada sys_interval; ausentes em janelas curtas)
+    bool brokerCountsAvailable = false;
+    uint32_t brokerReceived = 0;
+    uint32_t brokerSent = 0;
+
+    // Publicações dos dispositivos por segundo na janela
+    double publishRate() const { return windowMs ? traffic.fromDevices() * 1000.0 / windowMs : 0; }
+};
+
+class FleetSim {
+public:
+    explicit FleetSim(const FleetConfig& config);
+    ~FleetSim();
+
+    // Cria os dispositivos, conecta o servidor e roda até todos assinarem
+    // os comandos (ou connectTimeoutMs). false se a frota não coube ou o
+    // servidor não conectou.
+    bool begin();
+    // Janela medida: zera as contagens e roda durationMs
+    void run();
+    void runFor(uint32_t ms);
+    FleetReport report() const;
+
+    size_t size() const { return _devices.size(); }
+    const char* deviceId(size_t index) const;
+    bool deviceConnected(size_t index) const;
+    uint8_t deviceTargetTemp(size_t index) const;
+
+private:
+    struct Device;
+
+    void step();
+    void sampleSensors();
+    void sendCommands();
+    void sendCommand(size_t index);
+    void pollServer();
+    void onMessage(const char* topic, const uint8_t* payload, size_t length);
+    int deviceIndex(const char* id, size_t length) const;
+    void resetWindow();
+    uint64_t nowMicros() const;
+    void syncClock();
+    uint32_t nextRandom();
+
+    static void observe(const FakeMessage& message, void* context);
+
+    FleetConfig _config;
+    bool _real;
+    std::vector<std::unique_ptr<Device>> _devices;
+
+    WiFiClient _serverSocket;
+    PubSubClient _server;
+    char _serverId[32];
+
+    uint64_t _wallOrigin;
+    uint64_t _windowStart;
+    uint64_t _windowEnd;
+    uint32_t _random;
+    float _commandCredit;
+    unsigned long _lastCommandAt;
+
+    std::vector<uint32_t> _latencies;
+    FleetReport _counts;
+    uint32_t _brokerBase[2];
+    uint32_t _brokerLast[2];
+    uint8_t _brokerReadings[2];
+};
+
+#endif // FLEET_SIM_H
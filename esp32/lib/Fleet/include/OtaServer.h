@@ -0,0 +1,89 @@
+#ifndef OTA_SERVER_H
+#define OTA_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "OtaCodec.h"
+
+struct FakeMessage;
+
+// Lado servidor da atualização OTA (formato em MQTT.md), para testes e
+// benchmarks no host: oferece uma imagem a um dispositivo pelo comando OTA
+// e injeta os blocos no FakeBroker, como o backend faria.
+//
+// Janela deslizante com confirmação cumulativa: no máximo "janela" blocos
+// adiante do "proximo" do último relatório. Um relatório com "lacuna", ou
+// nenhum relatório em retryMs (quando a oferta é repetida), faz voltar a
+// partir de "proximo" (go-back-N).
+//
+// Usa o observador do FakeBroker enquanto existe (não junto com a
+// FleetSim) e guarda a imagem só pelo ponteiro.
+class OtaServer {
+public:
+    OtaServer(const char* deviceId, const uint8_t* image, size_t size, const char* version);
+    ~OtaServer();
+
+    void offer();
+    void cancel();
+    // Envia o que a janela permite; chamar a cada passo do laço
+    void step();
+
+    // Descarta um a cada 'every' blocos enviados, como QoS 0 num link ruim
+    void setLossEvery(uint32_t every) { _lossEvery = every; }
+    void setRetryMs(uint32_t ms) { _retryMs = ms; }
+
+    // Último relatório desta versão: REINICIANDO (imagem aceita) ou FALHA
+    bool finished() const;
+    const char* deviceState() const { return _deviceState; }
+    const char* deviceError() const { return _deviceError; }
+    uint32_t acked() const { return _acked; }
+    uint32_t totalChunks() const { return _totalChunks; }
+    const uint8_t* sha256() const { return _sha256; }
+
+    uint32_t chunksSent() const { return _chunksSent; }     // inclui os perdidos
+    uint32_t chunksLost() const { return _chunksLost; }
+    uint32_t chunksResent() const { return _chunksResent; }
+    uint32_t reports() const { return _reports; }
+    uint32_t offers() const { return _offers; }
+    uint64_t bytesSent() const { return _bytesSent; }       // cabeçalho + dados
+
+private:
+    void sendChunk(uint32_t index);
+    void onReport(const uint8_t* payload, size_t length);
+
+    static void observe(const FakeMessage& message, void* context);
+
+    const uint8_t* _image;
+    size_t _size;
+    uint32_t _totalChunks;
+    char _version[OTA_VERSION_SIZE];
+    uint8_t _sha256[OTA_SHA256_BYTES];
+    uint32_t _session;
+
+    char _commandTopic[96];
+    char _chunkTopic[96];
+    char _stateTopic[96];
+
+    bool _active;
+    bool _resync;               // o próximo relatório diz de onde continuar
+    uint32_t _acked;
+    uint32_t _next;
+    uint32_t _window;
+    unsigned long _lastReportAt;
+    uint32_t _retryMs;
+    uint32_t _lossEvery;
+
+    char _deviceState[16];
+    char _deviceError[16];
+
+    uint32_t _chunksSent;
+    uint32_t _chunksLost;
+    uint32_t _chunksResent;
+    uint32_t _reports;
+    uint32_t _offers;
+    uint64_t _bytesSent;
+
+    uint8_t _packet[OTA_CHUNK_HEADER_BYTES + OTA_CHUNK_SIZE];
+};
+
+#endif // OTA_SERVER_H
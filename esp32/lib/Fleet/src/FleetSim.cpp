@@ -0,0 +1,459 @@
+#include "FleetSim.h"
+#include <FakeBroker.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ACController.h"
+#include "CborReader.h"
+#include "CborWriter.h"
+#include "CommandCodec.h"
+#include "ControlLoop.h"
+#include "NetworkManager.h"
+#include "TaskQueues.h"
+#include "TelemetryStore.h"
+
+namespace {
+
+const char TOPIC_ROOT[] = "ac-control/dispositivos/";
+const char* const BROKER_COUNTERS[2] = {
+    "$SYS/broker/messages/received",
+    "$SYS/broker/messages/sent"
+};
+
+// Depois de todos conectarem, na rede real: o SUBACK não é esperado, então
+// dá tempo ao broker de registrar as inscrições antes do primeiro comando
+const uint32_t REAL_SETTLE_MS = 1000;
+
+uint64_t wallMicros() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, uint32_t per1000) {
+    if (sorted.empty()) return 0;
+    size_t index = (sorted.size() * per1000 + 999) / 1000;
+    return sorted[index ? index - 1 : 0];
+}
+
+// Valor de "temperaturaDesejada" num status ou delta; 0 se ausente
+uint8_t targetTempIn(const uint8_t* payload, size_t length) {
+    if (payloadWireFormat(payload, length) == WireFormat::CBOR) {
+        CborReader reader(payload, length);
+        reader.beginObject();
+        JsonSlice key;
+        int32_t value = 0;
+        while (reader.nextMember(key)) {
+            if (key.equals("temperaturaDesejada")) {
+                return reader.readInteger(value) && value > 0 && value <= 255 ? uint8_t(value) : 0;
+            }
+            reader.skipValue();
+        }
+        return 0;
+    }
+    static const char KEY[] = "\"temperaturaDesejada\":";
+    const size_t keyLength = sizeof(KEY) - 1;
+    for (size_t i = 0; i + keyLength < length; i++) {
+        if (memcmp(payload + i, KEY, keyLength) != 0) continue;
+        unsigned value = 0;
+        for (size_t j = i + keyLength; j < length && payload[j] >= '0' && payload[j] <= '9'; j++) {
+            value = value * 10 + (payload[j] - '0');
+        }
+        return value <= 255 ? uint8_t(value) : 0;
+    }
+    return 0;
+}
+
+}  // namespace
+
+// Um ESP32 inteiro: as três tarefas de main.cpp viram passos do mesmo laço
+struct FleetSim::Device {
+    std::string id;
+    std::string commandTopic;
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACController ac;
+    ControlLoop control;
+    TelemetryStore telemetry;
+    NetworkManager network;
+
+    float temperature;
+    float humidity;
+    unsigned long nextSample;
+
+    uint8_t targetTemp;         // último pedido pelo servidor
+    bool pending;               // aguardando o status que o confirma
+    uint64_t sentAt;
+
+    explicit Device(const std::string& name)
+        : id(name),
+          commandTopic(TOPIC_ROOT + name + "/comando"),
+          ac(PIN_IR_LED, PIN_DHT),
+          control(ac, commands, samples, status),
+          network(id.c_str(), ac),
+          temperature(26.0f),
+          humidity(55.0f),
+          nextSample(0),
+          targetTemp(0),
+          pending(false),
+          sentAt(0) {
+    }
+};
+
+FleetSim::FleetSim(const FleetConfig& config)
+    : _config(config),
+      _real(config.broker != nullptr),
+      _server(_serverSocket),
+      _wallOrigin(0),
+      _windowStart(0),
+      _windowEnd(0),
+      _random(config.seed ? config.seed : 1),
+      _commandCredit(0),
+      _lastCommandAt(0),
+      _brokerBase{0, 0},
+      _brokerLast{0, 0},
+      _brokerReadings{0, 0} {
+    snprintf(_serverId, sizeof(_serverId), "%s_servidor", _config.idPrefix);
+}
+
+FleetSim::~FleetSim() {
+    _server.disconnect();
+    if (!_real) FakeBroker::instance().setObserver(nullptr, nullptr);
+}
+
+bool FleetSim::begin() {
+    HostClock::reset();
+    WiFi.hostReset();
+    WiFi.hostUseRealNetwork(_real);
+    _wallOrigin = wallMicros();
+
+    if (!_real) {
+        FakeBroker::instance().reset();
+        if (_config.devices > FAKE_BROKER_MAX_CLIENTS) {
+            fprintf(stderr, "FakeBroker comporta %d clientes (FAKE_BROKER_MAX_CLIENTS)\n", FAKE_BROKER_MAX_CLIENTS);
+            return false;
+        }
+        // O servidor vê tudo pelo observador, sem inscrição nem fila
+        FakeBroker::instance().setObserver(observe, this);
+    } else {
+        WiFi.begin(nullptr, nullptr);
+        _server.setServer(_config.broker, _config.port);
+        _server.setBufferSize(FAKE_BROKER_TOPIC_SIZE + FAKE_BROKER_PAYLOAD_SIZE);
+        _server.setCallback([this](char* topic, byte* payload, unsigned int length) {
+            onMessage(topic, payload, length);
+        });
+        if (!_serverSocket.connect(_config.broker, _config.port, MQTT_CONNECT_TIMEOUT)
+            || !_server.connect(_serverId, _config.user, _config.password)) {
+            fprintf(stderr, "Servidor não conectou a %s:%u (estado %d)\n",
+                    _config.broker, _config.port, _server.state());
+            return false;
+        }
+        _server.subscribe("ac-control/dispositivos/#");
+        for (const char* counter : BROKER_COUNTERS) _server.subscribe(counter);
+    }
+
+    _devices.clear();
+    _devices.reserve(_config.devices);
+    for (uint16_t i = 0; i < _config.devices; i++) {
+        char name[24];
+        snprintf(name, sizeof(name), "%s_%05u", _config.idPrefix, i);
+        std::unique_ptr<Device> device(new Device(name));
+        device->ac.begin();
+        device->telemetry.begin();
+        device->network.attachQueues(device->commands, device->status);
+        device->network.attachTelemetry(device->telemetry);
+        device->network.setWireFormat(_config.wireFormat);
+        device->network.begin(WIFI_SSID, WIFI_PASSWORD,
+                              _real ? _config.broker : MQTT_SERVER, _real ? _config.port : MQTT_PORT,
+                              _config.user, _config.password);
+        // Leituras espalhadas, como sensores ligados em instantes diferentes
+        device->nextSample = millis() + nextRandom() % (_config.sampleIntervalMs + 1);
+        device->targetTemp = device->ac.getStatus().targetTemp;
+        _devices.push_back(std::move(device));
+    }
+
+    uint64_t deadline = nowMicros() + uint64_t(_config.connectTimeoutMs) * 1000;
+    size_t connected = 0;
+    while (nowMicros() < deadline) {
+        step();
+        connected = 0;
+        for (const auto& device : _devices) connected += device->network.isConnected();
+        if (connected == _devices.size()) break;
+    }
+    if (_real) {
+        uint64_t settle = nowMicros() + uint64_t(REAL_SETTLE_MS) * 1000;
+        while (nowMicros() < settle) step();
+    }
+    return true;
+}
+
+void FleetSim::run() {
+    runFor(_config.durationMs);
+}
+
+void FleetSim::runFor(uint32_t ms) {
+    resetWindow();
+    uint64_t wallStart = wallMicros();
+    uint64_t end = nowMicros() + uint64_t(ms) * 1000;
+    while (nowMicros() < end) {
+        step();
+    }
+    _windowEnd = nowMicros();
+    _counts.wallSeconds = (wallMicros() - wallStart) / 1e6;
+}
+
+void FleetSim::resetWindow() {
+    _counts = FleetReport();
+    _latencies.clear();
+    _commandCredit = 0;
+    _lastCommandAt = millis();
+    for (auto& device : _devices) device->pending = false;
+    for (int i = 0; i < 2; i++) _brokerReadings[i] = 0;
+    if (!_real) {
+        _brokerBase[0] = FakeBroker::instance().publishCount();
+        _brokerBase[1] = FakeBroker::instance().deliveryCount();
+    }
+    _windowStart = _windowEnd = nowMicros();
+}
+
+// Um passo de todos os dispositivos e do servidor
+void FleetSim::step() {
+    for (auto& device : _devices) {
+        device->network.update();
+        device->control.step();
+    }
+    sampleSensors();
+    pollServer();
+    sendCommands();
+
+    if (_real) {
+        // Dorme o resto do passo e alcança o tempo real
+        uint64_t next = (nowMicros() / 1000 / _config.stepMs + 1) * _config.stepMs * 1000;
+        uint64_t now = nowMicros();
+        if (next > now) std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+        syncClock();
+    } else {
+        HostClock::advanceMillis(_config.stepMs);
+    }
+}
+
+// Passeio aleatório lento, dentro e fora das zonas mortas do status
+void FleetSim::sampleSensors() {
+    unsigned long now = millis();
+    for (auto& device : _devices) {
+        if (long(now - device->nextSample) < 0) continue;
+        device->nextSample += _config.sampleIntervalMs;
+        device->temperature += (int(nextRandom() % 21) - 10) * 0.01f;
+        device->humidity += (int(nextRandom() % 21) - 10) * 0.05f;
+        SensorSample sample{device->temperature, device->humidity};
+        device->samples.push(sample);
+    }
+}
+
+void FleetSim::sendCommands() {
+    unsigned long now = millis();
+    _commandCredit += _config.commandsPerSecond * (now - _lastCommandAt) / 1000.0f;
+    _lastCommandAt = now;
+    if (_devices.empty()) return;
+
+    while (_commandCredit >= 1.0f) {
+        _commandCredit -= 1.0f;
+        // Um comando por vez por dispositivo, para casar cada status
+        size_t start = nextRandom() % _devices.size();
+        size_t index = start;
+        while (_devices[index]->pending) {
+            index = (index + 1) % _devices.size();
+            if (index == start) break;
+        }
+        if (_devices[index]->pending) {
+            _counts.commandsDeferred++;
+            continue;
+        }
+        sendCommand(index);
+    }
+}
+
+void FleetSim::sendCommand(size_t index) {
+    Device& device = *_devices[index];
+    // Sempre uma temperatura diferente da atual, para o status ser inequívoco
+    uint8_t temp = uint8_t(16 + nextRandom() % 14);
+    if (temp >= device.targetTemp) temp++;
+
+    char payload[96];
+    size_t length;
+    if (_config.wireFormat == WireFormat::CBOR) {
+        CborWriter cbor(reinterpret_cast<uint8_t*>(payload), sizeof(payload));
+        cbor.beginObject();
+        cbor.key(WireKey::COMANDO);
+        cbor.value("SET_STATE");
+        cbor.key(WireKey::PARAMETROS);
+        cbor.beginObject();
+        cbor.key(WireKey::LIGADO);
+        cbor.value(true);
+        cbor.key(WireKey::TEMPERATURA);
+        cbor.value(uint32_t(temp));
+        cbor.endObject();
+        cbor.endObject();
+        length = cbor.finish();
+    } else {
+        length = size_t(snprintf(payload, sizeof(payload),
+                                 "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":%u}}", temp));
+    }
+    device.targetTemp = temp;
+    device.pending = true;
+    device.sentAt = nowMicros();
+    _counts.commandsSent++;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(payload);
+    bool sent = _real ? _server.publish(device.commandTopic.c_str(), bytes, length, false)
+                      : FakeBroker::instance().inject(device.commandTopic.c_str(), bytes, length);
+    if (!sent) {
+        // Falha local (sem conexão): não conta como latência do broker
+        device.pending = false;
+        _counts.commandsSent--;
+        _counts.commandsDeferred++;
+    }
+}
+
+void FleetSim::pollServer() {
+    if (_real && !_server.loop()) {
+        // Perder o servidor no meio invalida a medição, mas não trava o laço
+        _server.connect(_serverId, _config.user, _config.password);
+    }
+}
+
+void FleetSim::observe(const FakeMessage& message, void* context) {
+    static_cast<FleetSim*>(context)->onMessage(message.topic, message.payload, message.length);
+}
+
+void FleetSim::onMessage(const char* topic, const uint8_t* payload, size_t length) {
+    for (int i = 0; i < 2; i++) {
+        if (strcmp(topic, BROKER_COUNTERS[i]) != 0) continue;
+        char text[16];
+        size_t n = length < sizeof(text) - 1 ? length : sizeof(text) - 1;
+        memcpy(text, payload, n);
+        text[n] = '\0';
+        uint32_t value = uint32_t(strtoul(text, nullptr, 10));
+        if (_brokerReadings[i]++ == 0) _brokerBase[i] = value;
+        _brokerLast[i] = value;
+        return;
+    }
+
+    _counts.traffic.bytes += length;
+    const size_t rootLength = sizeof(TOPIC_ROOT) - 1;
+    const char* id = strncmp(topic, TOPIC_ROOT, rootLength) == 0 ? topic + rootLength : nullptr;
+    const char* kind = id ? strchr(id, '/') : nullptr;
+    if (!kind) {
+        _counts.traffic.other++;
+        return;
+    }
+    kind++;
+
+    bool status = false;
+    if (strcmp(kind, "status") == 0) {
+        _counts.traffic.status++;
+        status = true;
+    } else if (strcmp(kind, "status/delta") == 0) {
+        _counts.traffic.delta++;
+        status = true;
+    } else if (strcmp(kind, "telemetria") == 0) {
+        _counts.traffic.telemetry++;
+    } else if (strcmp(kind, "diagnostico") == 0) {
+        _counts.traffic.diagnostics++;
+    } else if (strcmp(kind, "erro") == 0) {
+        _counts.traffic.errors++;
+    } else if (strcmp(kind, "comando") == 0) {
+        _counts.traffic.commands++;
+    } else {
+        _counts.traffic.other++;
+    }
+    if (!status) return;
+
+    int index = deviceIndex(id, size_t(kind - 1 - id));
+    if (index < 0) return;
+    Device& device = *_devices[index];
+    if (device.pending && targetTempIn(payload, length) == device.targetTemp) {
+        device.pending = false;
+        _latencies.push_back(uint32_t(nowMicros() - device.sentAt));
+        _counts.commandsAnswered++;
+    }
+}
+
+// "<prefixo>_<número>" -> posição na frota; -1 se não é desta frota
+int FleetSim::deviceIndex(const char* id, size_t length) const {
+    size_t prefixLength = strlen(_config.idPrefix);
+    if (length <= prefixLength + 1 || strncmp(id, _config.idPrefix, prefixLength) != 0
+        || id[prefixLength] != '_') {
+        return -1;
+    }
+    size_t index = 0;
+    for (size_t i = prefixLength + 1; i < length; i++) {
+        if (id[i] < '0' || id[i] > '9') return -1;
+        index = index * 10 + size_t(id[i] - '0');
+    }
+    return index < _devices.size() ? int(index) : -1;
+}
+
+FleetReport FleetSim::report() const {
+    FleetReport report = _counts;
+    report.devices = uint16_t(_devices.size());
+    report.realBroker = _real;
+    report.windowMs = uint32_t((_windowEnd - _windowStart) / 1000);
+    for (size_t i = 0; i < _devices.size(); i++) {
+        report.connected += deviceConnected(i);
+        report.commandsUnanswered += _devices[i]->pending;
+    }
+
+    std::vector<uint32_t> sorted(_latencies);
+    std::sort(sorted.begin(), sorted.end());
+    report.latencyP50Us = percentile(sorted, 500);
+    report.latencyP90Us = percentile(sorted, 900);
+    report.latencyP99Us = percentile(sorted, 990);
+    report.latencyMaxUs = sorted.empty() ? 0 : sorted.back();
+
+    if (!_real) {
+        report.brokerCountsAvailable = true;
+        report.brokerReceived = FakeBroker::instance().publishCount() - _brokerBase[0];
+        report.brokerSent = FakeBroker::instance().deliveryCount() - _brokerBase[1];
+    } else if (_brokerReadings[0] >= 2 && _brokerReadings[1] >= 2) {
+        report.brokerCountsAvailable = true;
+        report.brokerReceived = _brokerLast[0] - _brokerBase[0];
+        report.brokerSent = _brokerLast[1] - _brokerBase[1];
+    }
+    return report;
+}
+
+const char* FleetSim::deviceId(size_t index) const {
+    return _devices[index]->id.c_str();
+}
+
+bool FleetSim::deviceConnected(size_t index) const {
+    return _devices[index]->network.getConnectionState() == NetworkManager::ConnectionState::SUBSCRIBED;
+}
+
+uint8_t FleetSim::deviceTargetTemp(size_t index) const {
+    return _devices[index]->ac.getStatus().targetTemp;
+}
+
+// Tempo virtual; na rede real o relógio virtual segue o real (syncClock)
+uint64_t FleetSim::nowMicros() const {
+    return _real ? wallMicros() - _wallOrigin : HostClock::nowMicros();
+}
+
+void FleetSim::syncClock() {
+    uint64_t now = nowMicros();
+    uint64_t virtualNow = HostClock::nowMicros();
+    if (now > virtualNow) HostClock::advanceMicros(now - virtualNow);
+}
+
+// xorshift32: a mesma semente reproduz a mesma carga
+uint32_t FleetSim::nextRandom() {
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
@@ -0,0 +1,180 @@
+#include "OtaServer.h"
+#include <Arduino.h>
+#include <FakeBroker.h>
+#include <mbedtls/sha256.h>
+#include <stdio.h>
+#include <string.h>
+#include "JsonReader.h"
+
+namespace {
+
+const char TOPIC_ROOT[] = "ac-control/dispositivos/";
+const uint32_t DEFAULT_RETRY_MS = 5000;
+
+void copySlice(const JsonSlice& text, char* out, size_t capacity) {
+    size_t n = text.length < capacity - 1 ? text.length : capacity - 1;
+    memcpy(out, text.data, n);
+    out[n] = '\0';
+}
+
+}  // namespace
+
+OtaServer::OtaServer(const char* deviceId, const uint8_t* image, size_t size, const char* version)
+    : _image(image),
+      _size(size),
+      _totalChunks(uint32_t((size + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE)),
+      _session(0),
+      _active(false),
+      _resync(false),
+      _acked(0),
+      _next(0),
+      _window(1),
+      _lastReportAt(0),
+      _retryMs(DEFAULT_RETRY_MS),
+      _lossEvery(0),
+      _deviceState{},
+      _deviceError{},
+      _chunksSent(0),
+      _chunksLost(0),
+      _chunksResent(0),
+      _reports(0),
+      _offers(0),
+      _bytesSent(0) {
+    snprintf(_version, sizeof(_version), "%s", version);
+    snprintf(_commandTopic, sizeof(_commandTopic), "%s%s/comando", TOPIC_ROOT, deviceId);
+    snprintf(_chunkTopic, sizeof(_chunkTopic), "%s%s/ota/bloco", TOPIC_ROOT, deviceId);
+    snprintf(_stateTopic, sizeof(_stateTopic), "%s%s/ota/estado", TOPIC_ROOT, deviceId);
+
+    mbedtls_sha256_context hash;
+    mbedtls_sha256_init(&hash);
+    mbedtls_sha256_starts_ret(&hash, 0);
+    mbedtls_sha256_update_ret(&hash, image, size);
+    mbedtls_sha256_finish_ret(&hash, _sha256);
+    mbedtls_sha256_free(&hash);
+    _session = otaSessionTag(_sha256);
+
+    FakeBroker::instance().setObserver(observe, this);
+}
+
+OtaServer::~OtaServer() {
+    FakeBroker::instance().setObserver(nullptr, nullptr);
+}
+
+void OtaServer::offer() {
+    char sha[2 * OTA_SHA256_BYTES + 1];
+    for (size_t i = 0; i < OTA_SHA256_BYTES; i++) {
+        snprintf(sha + 2 * i, 3, "%02x", _sha256[i]);
+    }
+    char command[256];
+    snprintf(command, sizeof(command),
+             "{\"comando\":\"OTA\",\"parametros\":{\"versao\":\"%s\",\"tamanho\":%u,\"sha256\":\"%s\"}}",
+             _version, unsigned(_size), sha);
+
+    // Até o relatório chegar nada é enviado: ele diz de onde começar
+    _active = true;
+    _resync = true;
+    _next = _acked;
+    _window = 0;
+    _lastReportAt = millis();
+    _offers++;
+    FakeBroker::instance().inject(_commandTopic, command);
+}
+
+void OtaServer::cancel() {
+    _active = false;
+    FakeBroker::instance().inject(_commandTopic, "{\"comando\":\"OTA\",\"parametros\":{\"cancelar\":true}}");
+}
+
+void OtaServer::step() {
+    if (!_active) return;
+    if (millis() - _lastReportAt >= _retryMs) {
+        // Oferta ou relatório perdido: a mesma oferta retoma de onde parou
+        offer();
+        return;
+    }
+    while (_next < _totalChunks && _next - _acked < _window) {
+        sendChunk(_next++);
+    }
+}
+
+void OtaServer::sendChunk(uint32_t index) {
+    size_t offset = size_t(index) * OTA_CHUNK_SIZE;
+    size_t length = _size - offset < OTA_CHUNK_SIZE ? _size - offset : OTA_CHUNK_SIZE;
+    packOtaChunkHeader(_session, index, _packet);
+    memcpy(_packet + OTA_CHUNK_HEADER_BYTES, _image + offset, length);
+
+    _chunksSent++;
+    _bytesSent += OTA_CHUNK_HEADER_BYTES + length;
+    if (_lossEvery && _chunksSent % _lossEvery == 0) {
+        _chunksLost++;
+        return;
+    }
+    // Sem inscrição ou com a fila do cliente cheia o bloco se perde, como no broker
+    if (!FakeBroker::instance().inject(_chunkTopic, _packet, unsigned(OTA_CHUNK_HEADER_BYTES + length))) {
+        _chunksLost++;
+    }
+}
+
+// {"estado":"RECEBENDO","versao":"1.1.0","proximo":96,"janela":4,"lacuna":true,...}
+void OtaServer::onReport(const uint8_t* payload, size_t length) {
+    JsonReader reader(payload, length);
+    if (!reader.beginObject()) return;
+
+    char state[sizeof(_deviceState)] = "";
+    char error[sizeof(_deviceError)] = "";
+    char version[OTA_VERSION_SIZE] = "";
+    int32_t next = -1;
+    int32_t window = 0;
+    bool gap = false;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        JsonSlice text{nullptr, 0};
+        if (key.equals("estado") && reader.readString(text)) {
+            copySlice(text, state, sizeof(state));
+        } else if (key.equals("erro") && reader.readString(text)) {
+            copySlice(text, error, sizeof(error));
+        } else if (key.equals("versao") && reader.readString(text)) {
+            copySlice(text, version, sizeof(version));
+        } else if (key.equals("proximo")) {
+            reader.readInteger(next);
+        } else if (key.equals("janela")) {
+            reader.readInteger(window);
+        } else if (key.equals("lacuna")) {
+            reader.readBool(gap);
+        } else {
+            reader.skipValue();
+        }
+        if (reader.failed()) return;
+    }
+    // Relatório retido de outra transferência
+    if (strcmp(version, _version) != 0) return;
+
+    _reports++;
+    _lastReportAt = millis();
+    memcpy(_deviceState, state, sizeof(state));
+    memcpy(_deviceError, error, sizeof(error));
+    if (strcmp(state, "RECEBENDO") != 0) {
+        _active = false;
+        return;
+    }
+    if (next < 0 || uint32_t(next) > _totalChunks) return;
+
+    _acked = uint32_t(next);
+    _window = window > 0 ? uint32_t(window) : 1;
+    if (gap || _resync || _next < _acked) {
+        if (_next > _acked) _chunksResent += _next - _acked;
+        _next = _acked;
+        _resync = false;
+    }
+}
+
+void OtaServer::observe(const FakeMessage& message, void* context) {
+    OtaServer* server = static_cast<OtaServer*>(context);
+    if (strcmp(message.topic, server->_stateTopic) == 0) {
+        server->onReport(message.payload, message.length);
+    }
+}
+
+bool OtaServer::finished() const {
+    return strcmp(_deviceState, "REINICIANDO") == 0 || strcmp(_deviceState, "FALHA") == 0;
+}
@@ -0,0 +1,151 @@
+#ifndef FLEET_GATEWAY_H
+#define FLEET_GATEWAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ACState.h"
+#include "ACUnits.h"
+#include "Metrics.h"
+
+// Agregador da frota: assina os status dos dispositivos e publica o
+// resumo em ac-control/sistema/status e, por bloco e por sala,
+// ac-control/sistema/blocos/{bloco} e ac-control/sistema/salas/{bloco}/{sala}
+// (formato em MQTT.md). O backend lê um resumo em vez de N fluxos.
+//
+// Cada status ou delta é lido com o parseStatus do firmware por cima do
+// último estado da unidade e só a diferença na contribuição do dispositivo
+// (online, aparelhos ligados, temperatura) sobe pela cadeia
+// sala -> bloco -> sistema, então ingest() custa O(1) qualquer que seja o
+// tamanho da frota. Os resumos que mudaram saem juntos a cada intervalo
+// (várias mudanças na mesma sala viram uma publicação); o do sistema sai
+// sempre, com "ultimaAtualizacao".
+//
+// Sem LWT no firmware, "online" é ter publicado nos últimos offlineMs (o
+// heartbeat do status é STATUS_HEARTBEAT_INTERVAL). Os dispositivos ficam
+// numa lista pela ordem da última mensagem e só a cabeça é examinada.
+//
+// Só para o host (heap e std); uma thread.
+struct GatewayConfig {
+    uint32_t publishIntervalMs = 1000;
+    uint32_t offlineMs = 300000;        // o mesmo prazo do servidor web
+    size_t expectedDevices = 0;         // reserva a tabela de uma vez
+};
+
+struct GatewayStats {
+    uint32_t messages = 0;              // status e deltas aceitos
+    uint32_t rejected = 0;              // payload inválido
+    uint32_t ignored = 0;               // outros tópicos, unidade inexistente
+    uint32_t changes = 0;               // mensagens que mudaram algum resumo
+    uint32_t publishes = 0;
+    uint32_t publishFailures = 0;
+
+    // Mensagem que mudou um resumo -> publicação do resumo, em microssegundos
+    // (limite superior do balde, como os percentis de Metrics)
+    uint32_t lagSamples = 0;
+    uint32_t lagP50Us = 0;
+    uint32_t lagP90Us = 0;
+    uint32_t lagP99Us = 0;
+    uint32_t lagMaxUs = 0;
+};
+
+class FleetGateway {
+public:
+    // Publica um resumo; false mantém o resumo pendente para o próximo intervalo
+    typedef bool (*Publisher)(const char* topic, const uint8_t* payload, size_t length, bool retained,
+                              void* context);
+
+    explicit FleetGateway(const GatewayConfig& config = GatewayConfig());
+
+    // Sala do dispositivo (pode vir antes ou depois do primeiro status).
+    // Dispositivos sem sala contam só no sistema. false com nome inválido
+    // para um nível de tópico ('/', '+', '#' ou vazio).
+    bool assign(const char* id, const char* block, const char* room);
+    // Arquivo "idEsp32;bloco;sala" por linha ('#' comenta); o número de
+    // linhas aplicadas, ou -1 se o arquivo não abriu
+    int loadAssignments(const char* path);
+
+    // Mensagem de ac-control/dispositivos/+/status/#. originUs é quando ela
+    // chegou (ou, no banco de carga, quando o dispositivo a publicou): a
+    // defasagem é medida a partir dele, no mesmo relógio de publishDue().
+    void ingest(const char* topic, const uint8_t* payload, size_t length, uint64_t originUs);
+
+    // Chamar a cada passo: no intervalo, marca os dispositivos vencidos como
+    // offline e publica os resumos. epoch vai em "ultimaAtualizacao".
+    // Retorna quantos resumos publicou.
+    size_t publishDue(uint64_t nowUs, uint32_t epoch, Publisher publish, void* context);
+
+    size_t devices() const { return _devices.size(); }
+    size_t online() const { return _groups[SYSTEM].totals.online; }
+    GatewayStats stats() const;
+    void resetStats();
+
+private:
+    static const uint32_t NONE = UINT32_MAX;
+    static const uint32_t SYSTEM = 0;
+
+    // O que cada dispositivo soma nos resumos dos seus grupos
+    struct Totals {
+        uint32_t online;
+        uint32_t total;
+        uint32_t unitsOn;
+        uint32_t units;
+        uint32_t temperatures;
+        int64_t temperatureSum;         // centésimos de grau: a soma não deriva
+
+        bool operator==(const Totals& other) const;
+    };
+
+    struct Group {
+        std::string topic;
+        uint32_t parent;
+        Totals totals;
+        bool dirty;
+        bool system;
+    };
+
+    struct Device {
+        std::string id;
+        uint32_t room;                  // grupo da sala; NONE sem sala
+        uint32_t prev;                  // lista pela última mensagem
+        uint32_t next;
+        uint64_t lastSeenUs;
+        bool online;
+        uint8_t units;                  // máscara das unidades com status
+        ACStatus status[AC_MAX_UNITS];
+        int32_t temperature;            // centésimos; a última leitura válida
+        bool hasTemperature;
+    };
+
+    uint32_t deviceFor(const char* id, size_t length, bool create);
+    uint32_t groupFor(const std::string& topic, uint32_t parent);
+    Totals contribution(const Device& device) const;
+    void apply(uint32_t group, const Totals& totals, int sign);
+    void update(uint32_t index, const Totals& before, uint64_t originUs);
+    void markDirty(uint32_t group);
+    void touch(uint32_t index, uint64_t nowUs);
+    void unlink(uint32_t index);
+    void expire(uint64_t nowUs);
+    bool publishGroup(Group& group, uint32_t epoch, Publisher publish, void* context);
+
+    GatewayConfig _config;
+    std::vector<Device> _devices;
+    std::unordered_map<std::string, uint32_t> _index;
+    std::string _key;                   // reaproveitada na busca: sem alocação por mensagem
+    std::vector<Group> _groups;
+    std::unordered_map<std::string, uint32_t> _groupIndex;
+    std::vector<uint32_t> _dirty;
+    uint32_t _head;
+    uint32_t _tail;
+    uint64_t _nextPublishUs;
+
+    std::vector<uint64_t> _pendingOrigins;   // mudanças ainda não publicadas
+    uint32_t _lag[Metrics::BUCKETS];
+    uint32_t _lagMaxUs;
+    GatewayStats _counts;
+    char _payload[256];
+};
+
+#endif // FLEET_GATEWAY_H
@@ -0,0 +1,113 @@
+#ifndef GATEWAY_LOAD_H
+#define GATEWAY_LOAD_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ACState.h"
+#include "FleetGateway.h"
+#include "config.h"
+
+struct FakeMessage;
+
+// Banco de carga do gateway: N dispositivos sintéticos publicam status com
+// o codec do firmware e um FleetGateway os agrega, tudo em tempo real.
+//
+// Rajada: cada dispositivo publica o status completo de uma vez (como a
+// frota reconectando depois de uma queda do broker); mede mensagens/s até
+// a última ser agregada. Regime: cada dispositivo publica deltas de
+// temperatura (e às vezes liga ou desliga) à taxa configurada; mede a
+// defasagem de cada mudança até o resumo que a contém ir ao ar.
+//
+// Sem 'broker' as mensagens passam pelo FakeBroker (observador, sem
+// socket); com 'broker' saem por 'connections' conexões MQTT para um broker
+// de verdade, como o Mosquitto de mosquitto/, e o gateway as recebe pela
+// sua própria conexão. Os resumos saem sem retenção para não deixar
+// tópicos de carga no broker. Dispositivos em salas de 10 e blocos de 20
+// salas.
+//
+// Só para o host, e dona do FakeBroker e do WiFi substituto enquanto roda.
+struct GatewayLoadConfig {
+    uint32_t devices = 1000;
+    float statusPerSecond = 0.2f;       // por dispositivo, no regime
+    uint32_t durationMs = 10000;        // regime
+    uint32_t publishIntervalMs = 1000;
+    uint32_t stepMs = 10;
+    const char* broker = nullptr;       // host do broker real; nullptr = FakeBroker
+    uint16_t port = MQTT_PORT;
+    const char* user = MQTT_USER;
+    const char* password = MQTT_PASSWORD;
+    uint8_t connections = 8;            // publicadores no broker real
+    const char* idPrefix = "CARGA";
+    uint32_t seed = 1;
+    WireFormat wireFormat = WireFormat::JSON;
+};
+
+struct GatewayLoadReport {
+    uint32_t devices = 0;
+    bool realBroker = false;
+
+    uint32_t burstMessages = 0;         // agregadas na rajada
+    double burstSeconds = 0;
+
+    uint32_t windowMs = 0;              // regime
+    uint32_t sent = 0;
+    uint32_t summaries = 0;             // resumos publicados no regime
+    GatewayStats gateway;               // do regime
+
+    double burstRate() const { return burstSeconds > 0 ? burstMessages / burstSeconds : 0; }
+    double steadyRate() const { return windowMs ? gateway.messages * 1000.0 / windowMs : 0; }
+};
+
+class GatewayLoad {
+public:
+    explicit GatewayLoad(const GatewayLoadConfig& config);
+    ~GatewayLoad();
+
+    // Conexões e salas; false se o broker não aceitou
+    bool begin();
+    void runBurst();
+    void runSteady();
+    GatewayLoadReport report() const { return _report; }
+
+private:
+    struct Publisher {
+        WiFiClient socket;
+        PubSubClient client;
+        Publisher() : client(socket) {}
+    };
+
+    void send(uint32_t device, const uint8_t* payload, size_t length, bool delta);
+    void poll();
+    void onMessage(const char* topic, const uint8_t* payload, size_t length);
+    int deviceIndex(const char* id, size_t length) const;
+    uint64_t nowMicros() const;
+    void sleepUntil(uint64_t us);
+    uint32_t nextRandom();
+
+    static void observe(const FakeMessage& message, void* context);
+    static bool publishSummary(const char* topic, const uint8_t* payload, size_t length, bool retained,
+                               void* context);
+
+    GatewayLoadConfig _config;
+    bool _real;
+    FleetGateway _gateway;
+    uint64_t _origin;
+    uint32_t _random;
+
+    std::vector<std::string> _topics;   // ac-control/dispositivos/{id}/status
+    std::vector<std::string> _deltaTopics;
+    std::vector<uint64_t> _sentAt;
+    std::vector<ACStatus> _status;
+
+    WiFiClient _gatewaySocket;
+    PubSubClient _gatewayClient;
+    std::vector<std::unique_ptr<Publisher>> _publishers;
+
+    GatewayLoadReport _report;
+};
+
+#endif // GATEWAY_LOAD_H
@@ -0,0 +1,375 @@
+#include "FleetGateway.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "JsonWriter.h"
+#include "StatusCodec.h"
+
+namespace {
+
+const char DEVICE_ROOT[] = "ac-control/dispositivos/";
+const char SYSTEM_TOPIC[] = "ac-control/sistema/status";
+const char BLOCK_ROOT[] = "ac-control/sistema/blocos/";
+const char ROOM_ROOT[] = "ac-control/sistema/salas/";
+
+// Um nível de tópico MQTT, sem curingas
+bool validLevel(const char* name) {
+    return name && name[0] && !strpbrk(name, "/+#");
+}
+
+// Mesmo arredondamento de Metrics: limite superior do balde do percentil
+uint32_t percentile(const uint32_t (&buckets)[Metrics::BUCKETS], uint32_t count, uint32_t maxUs,
+                    uint32_t permille) {
+    uint32_t rank = uint32_t((uint64_t(count) * permille + 999) / 1000);
+    uint32_t seen = 0;
+    for (size_t i = 0; i < Metrics::BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            if (i + 1 == Metrics::BUCKETS) return maxUs;
+            uint32_t upper = Metrics::bucketLowerBound(i + 1) - 1;
+            return upper < maxUs ? upper : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+// Antes do primeiro status da unidade: um delta se aplica sobre isto
+ACStatus unknownStatus() {
+    ACStatus status{};
+    status.currentTemp = NAN;
+    status.currentHumidity = NAN;
+    return status;
+}
+
+char* trim(char* text) {
+    while (*text == ' ' || *text == '\t') text++;
+    char* end = text + strlen(text);
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) end--;
+    *end = '\0';
+    return text;
+}
+
+}  // namespace
+
+bool FleetGateway::Totals::operator==(const Totals& other) const {
+    return online == other.online && total == other.total && unitsOn == other.unitsOn && units == other.units
+        && temperatures == other.temperatures && temperatureSum == other.temperatureSum;
+}
+
+FleetGateway::FleetGateway(const GatewayConfig& config)
+    : _config(config),
+      _head(NONE),
+      _tail(NONE),
+      _nextPublishUs(0),
+      _lag{},
+      _lagMaxUs(0) {
+    _devices.reserve(config.expectedDevices);
+    _index.reserve(config.expectedDevices);
+    _groups.push_back(Group{SYSTEM_TOPIC, NONE, Totals{}, false, true});
+}
+
+bool FleetGateway::assign(const char* id, const char* block, const char* room) {
+    if (!validLevel(id) || !validLevel(block) || !validLevel(room)) return false;
+    uint32_t blockGroup = groupFor(std::string(BLOCK_ROOT) + block, SYSTEM);
+    uint32_t roomGroup = groupFor(std::string(ROOM_ROOT) + block + "/" + room, blockGroup);
+
+    uint32_t index = deviceFor(id, strlen(id), true);
+    Device& device = _devices[index];
+    if (device.room == roomGroup) return true;
+    Totals totals = contribution(device);
+    apply(device.room != NONE ? device.room : SYSTEM, totals, -1);
+    device.room = roomGroup;
+    apply(roomGroup, totals, +1);
+    return true;
+}
+
+int FleetGateway::loadAssignments(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    int applied = 0;
+    unsigned lineNumber = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* text = trim(line);
+        if (!text[0] || text[0] == '#') continue;
+        char* block = strchr(text, ';');
+        char* room = block ? strchr(block + 1, ';') : nullptr;
+        if (room) {
+            *block++ = '\0';
+            *room++ = '\0';
+            if (assign(trim(text), trim(block), trim(room))) {
+                applied++;
+                continue;
+            }
+        }
+        fprintf(stderr, "%s:%u: linha ignorada (esperado idEsp32;bloco;sala)\n", path, lineNumber);
+    }
+    fclose(file);
+    return applied;
+}
+
+void FleetGateway::ingest(const char* topic, const uint8_t* payload, size_t length, uint64_t originUs) {
+    // .../{id}/status, .../{id}/status/delta, .../{id}/status/{n}[/delta]
+    const size_t rootLength = sizeof(DEVICE_ROOT) - 1;
+    const char* id = strncmp(topic, DEVICE_ROOT, rootLength) == 0 ? topic + rootLength : nullptr;
+    const char* slash = id ? strchr(id, '/') : nullptr;
+    if (!slash || slash == id || strncmp(slash, "/status", 7) != 0) {
+        _counts.ignored++;
+        return;
+    }
+    const char* rest = slash + 7;
+    uint8_t unit = 0;
+    if (rest[0] == '/' && rest[1] >= '0' && rest[1] <= '9' && (rest[2] == '\0' || rest[2] == '/')) {
+        unit = uint8_t(rest[1] - '0');
+        rest += 2;
+    }
+    if ((rest[0] && strcmp(rest, "/delta") != 0) || unit >= AC_MAX_UNITS) {
+        _counts.ignored++;
+        return;
+    }
+
+    // Lido numa cópia: payload inválido não cria dispositivo nem muda nada
+    size_t idLength = size_t(slash - id);
+    uint32_t index = deviceFor(id, idLength, false);
+    ACStatus status = index != NONE ? _devices[index].status[unit] : unknownStatus();
+    uint8_t fields = 0;
+    if (!parseStatus(payload, length, status, fields)) {
+        _counts.rejected++;
+        return;
+    }
+    _counts.messages++;
+    if (index == NONE) index = deviceFor(id, idLength, true);
+    Device& device = _devices[index];
+    Totals before = contribution(device);
+    device.status[unit] = status;
+    device.units |= uint8_t(1u << unit);
+    if (fields & STATUS_FIELD_CURRENT_TEMP) {
+        // Leitura nula: o sensor falhou e a temperatura antiga sai da média
+        float temperature = device.status[unit].currentTemp;
+        device.hasTemperature = !isnan(temperature);
+        device.temperature = device.hasTemperature ? int32_t(lroundf(temperature * 100.0f)) : 0;
+    }
+    touch(index, originUs);
+    update(index, before, originUs);
+}
+
+size_t FleetGateway::publishDue(uint64_t nowUs, uint32_t epoch, Publisher publish, void* context) {
+    if (nowUs < _nextPublishUs) return 0;
+    _nextPublishUs = nowUs + uint64_t(_config.publishIntervalMs) * 1000;
+    expire(nowUs);
+
+    size_t published = 0;
+    bool failed = false;
+    size_t kept = 0;
+    for (size_t i = 0; i < _dirty.size(); i++) {
+        Group& group = _groups[_dirty[i]];
+        if (publishGroup(group, epoch, publish, context)) {
+            group.dirty = false;
+            published++;
+        } else {
+            _dirty[kept++] = _dirty[i];
+            failed = true;
+        }
+    }
+    _dirty.resize(kept);
+    if (publishGroup(_groups[SYSTEM], epoch, publish, context)) {
+        published++;
+    } else {
+        failed = true;
+    }
+
+    // Com tudo no ar, cada mudança pendente vira uma amostra de defasagem
+    if (!failed) {
+        for (uint64_t origin : _pendingOrigins) {
+            uint64_t lag = nowUs > origin ? nowUs - origin : 0;
+            uint32_t us = lag < Metrics::MAX_LATENCY_US ? uint32_t(lag) : Metrics::MAX_LATENCY_US;
+            _lag[Metrics::bucketIndex(us)]++;
+            if (us > _lagMaxUs) _lagMaxUs = us;
+        }
+        _counts.lagSamples += uint32_t(_pendingOrigins.size());
+        _pendingOrigins.clear();
+    }
+    return published;
+}
+
+GatewayStats FleetGateway::stats() const {
+    GatewayStats stats = _counts;
+    if (stats.lagSamples) {
+        stats.lagP50Us = percentile(_lag, stats.lagSamples, _lagMaxUs, 500);
+        stats.lagP90Us = percentile(_lag, stats.lagSamples, _lagMaxUs, 900);
+        stats.lagP99Us = percentile(_lag, stats.lagSamples, _lagMaxUs, 990);
+        stats.lagMaxUs = _lagMaxUs;
+    }
+    return stats;
+}
+
+void FleetGateway::resetStats() {
+    _counts = GatewayStats();
+    for (uint32_t& bucket : _lag) bucket = 0;
+    _lagMaxUs = 0;
+}
+
+uint32_t FleetGateway::deviceFor(const char* id, size_t length, bool create) {
+    _key.assign(id, length);
+    auto found = _index.find(_key);
+    if (found != _index.end()) return found->second;
+    if (!create) return NONE;
+
+    uint32_t index = uint32_t(_devices.size());
+    _devices.push_back(Device());
+    Device& device = _devices.back();
+    device.id = _key;
+    device.room = NONE;
+    device.prev = device.next = NONE;
+    device.lastSeenUs = 0;
+    device.online = false;
+    device.units = 0;
+    for (ACStatus& status : device.status) status = unknownStatus();
+    device.temperature = 0;
+    device.hasTemperature = false;
+    _index.emplace(_key, index);
+    apply(SYSTEM, contribution(device), +1);
+    return index;
+}
+
+uint32_t FleetGateway::groupFor(const std::string& topic, uint32_t parent) {
+    auto found = _groupIndex.find(topic);
+    if (found != _groupIndex.end()) return found->second;
+    uint32_t index = uint32_t(_groups.size());
+    _groups.push_back(Group{topic, parent, Totals{}, false, false});
+    _groupIndex.emplace(topic, index);
+    markDirty(index);
+    return index;
+}
+
+FleetGateway::Totals FleetGateway::contribution(const Device& device) const {
+    Totals totals{};
+    totals.total = 1;
+    if (!device.online) return totals;
+    totals.online = 1;
+    for (uint8_t unit = 0; unit < AC_MAX_UNITS; unit++) {
+        if (!(device.units & (1u << unit))) continue;
+        totals.units++;
+        totals.unitsOn += device.status[unit].isOn;
+    }
+    if (device.hasTemperature) {
+        totals.temperatures = 1;
+        totals.temperatureSum = device.temperature;
+    }
+    return totals;
+}
+
+// Soma (ou subtrai) a contribuição no grupo e em todos acima dele
+void FleetGateway::apply(uint32_t group, const Totals& totals, int sign) {
+    for (uint32_t g = group; g != NONE; g = _groups[g].parent) {
+        Totals& t = _groups[g].totals;
+        t.online += uint32_t(sign) * totals.online;
+        t.total += uint32_t(sign) * totals.total;
+        t.unitsOn += uint32_t(sign) * totals.unitsOn;
+        t.units += uint32_t(sign) * totals.units;
+        t.temperatures += uint32_t(sign) * totals.temperatures;
+        t.temperatureSum += sign * totals.temperatureSum;
+        markDirty(g);
+    }
+}
+
+void FleetGateway::update(uint32_t index, const Totals& before, uint64_t originUs) {
+    const Device& device = _devices[index];
+    Totals after = contribution(device);
+    if (after == before) return;
+    uint32_t start = device.room != NONE ? device.room : SYSTEM;
+    apply(start, before, -1);
+    apply(start, after, +1);
+    _counts.changes++;
+    if (originUs != UINT64_MAX) _pendingOrigins.push_back(originUs);
+}
+
+// O resumo do sistema sai a cada intervalo de qualquer forma
+void FleetGateway::markDirty(uint32_t group) {
+    Group& g = _groups[group];
+    if (g.dirty || g.system) return;
+    g.dirty = true;
+    _dirty.push_back(group);
+}
+
+// Online e no fim da lista (a lista contém exatamente os online)
+void FleetGateway::touch(uint32_t index, uint64_t nowUs) {
+    Device& device = _devices[index];
+    if (device.online) unlink(index);
+    device.online = true;
+    device.lastSeenUs = nowUs;
+    device.prev = _tail;
+    device.next = NONE;
+    if (_tail != NONE) {
+        _devices[_tail].next = index;
+    } else {
+        _head = index;
+    }
+    _tail = index;
+}
+
+void FleetGateway::unlink(uint32_t index) {
+    Device& device = _devices[index];
+    if (device.prev != NONE) {
+        _devices[device.prev].next = device.next;
+    } else {
+        _head = device.next;
+    }
+    if (device.next != NONE) {
+        _devices[device.next].prev = device.prev;
+    } else {
+        _tail = device.prev;
+    }
+    device.prev = device.next = NONE;
+}
+
+// Só a cabeça da lista pode ter vencido. Mensagens fora de ordem (originUs
+// menor que o do anterior) só atrasam o vencimento até a cabeça passar.
+void FleetGateway::expire(uint64_t nowUs) {
+    const uint64_t timeoutUs = uint64_t(_config.offlineMs) * 1000;
+    while (_head != NONE && _devices[_head].lastSeenUs + timeoutUs <= nowUs) {
+        uint32_t index = _head;
+        Totals before = contribution(_devices[index]);
+        unlink(index);
+        _devices[index].online = false;
+        update(index, before, UINT64_MAX);
+    }
+}
+
+bool FleetGateway::publishGroup(Group& group, uint32_t epoch, Publisher publish, void* context) {
+    const Totals& t = group.totals;
+    JsonWriter json(_payload, sizeof(_payload));
+    json.beginObject();
+    json.key("dispositivosOnline");
+    json.value(t.online);
+    json.key("dispositivosTotal");
+    json.value(t.total);
+    json.key("aparelhosLigados");
+    json.value(t.unitsOn);
+    json.key("aparelhosTotal");
+    json.value(t.units);
+    json.key("temperaturaMedia");
+    if (t.temperatures) {
+        // Na resolução do sensor (0,1), como no status do dispositivo
+        json.value(double(llround(double(t.temperatureSum) / t.temperatures / 10.0)) / 10.0);
+    } else {
+        json.null();
+    }
+    json.key("ultimaAtualizacao");
+    json.value(epoch);
+    if (group.system) {
+        json.key("systemStatus");
+        json.value(t.online == t.total ? "OK" : "DEGRADADO");
+    }
+    json.endObject();
+    size_t length = json.finish();
+
+    if (!length || !publish(group.topic.c_str(), reinterpret_cast<const uint8_t*>(_payload), length, true,
+                            context)) {
+        _counts.publishFailures++;
+        return false;
+    }
+    _counts.publishes++;
+    return true;
+}
@@ -0,0 +1,289 @@
+#include "GatewayLoad.h"
+#include <FakeBroker.h>
+#include <chrono>
+#include <thread>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "StatusCodec.h"
+
+namespace {
+
+const char TOPIC_ROOT[] = "ac-control/dispositivos/";
+const char GATEWAY_FILTER[] = "ac-control/dispositivos/+/status/#";
+
+const uint32_t DEVICES_PER_ROOM = 10;
+const uint32_t ROOMS_PER_BLOCK = 20;
+
+// Na rajada: o gateway lê a cada tantas publicações, e espera no máximo
+// isso pelas que ainda estão no broker
+const uint32_t BURST_BATCH = 256;
+const uint32_t BURST_TIMEOUT_MS = 30000;
+// Na rede real: o SUBACK não é esperado, então dá tempo ao broker de
+// registrar a inscrição do gateway antes da primeira publicação
+const uint32_t REAL_SETTLE_MS = 1000;
+
+uint64_t wallMicros() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t epochNow() {
+    return uint32_t(time(nullptr));
+}
+
+}  // namespace
+
+GatewayLoad::GatewayLoad(const GatewayLoadConfig& config)
+    : _config(config),
+      _real(config.broker != nullptr),
+      _gateway([&config] {
+          GatewayConfig gateway;
+          gateway.publishIntervalMs = config.publishIntervalMs;
+          gateway.expectedDevices = config.devices;
+          return gateway;
+      }()),
+      _origin(wallMicros()),
+      _random(config.seed ? config.seed : 1),
+      _gatewayClient(_gatewaySocket) {
+}
+
+GatewayLoad::~GatewayLoad() {
+    for (auto& publisher : _publishers) publisher->client.disconnect();
+    _gatewayClient.disconnect();
+    if (!_real) FakeBroker::instance().setObserver(nullptr, nullptr);
+}
+
+bool GatewayLoad::begin() {
+    HostClock::reset();
+    WiFi.hostReset();
+    WiFi.hostUseRealNetwork(_real);
+
+    _topics.clear();
+    _deltaTopics.clear();
+    _topics.reserve(_config.devices);
+    _deltaTopics.reserve(_config.devices);
+    _sentAt.assign(_config.devices, 0);
+    _status.clear();
+    for (uint32_t i = 0; i < _config.devices; i++) {
+        char id[24];
+        char block[16];
+        char room[16];
+        snprintf(id, sizeof(id), "%s_%05u", _config.idPrefix, i);
+        snprintf(block, sizeof(block), "BLOCO_%03u", i / DEVICES_PER_ROOM / ROOMS_PER_BLOCK);
+        snprintf(room, sizeof(room), "SALA_%02u", i / DEVICES_PER_ROOM % ROOMS_PER_BLOCK);
+        _gateway.assign(id, block, room);
+        _topics.push_back(std::string(TOPIC_ROOT) + id + "/status");
+        _deltaTopics.push_back(_topics.back() + "/delta");
+
+        ACStatus status{};
+        status.isOn = nextRandom() % 2;
+        status.currentTemp = 22.0f + (nextRandom() % 60) / 10.0f;
+        status.currentHumidity = 55.0f;
+        status.targetTemp = 23;
+        status.temperatureHealth = SensorHealth::OK;
+        status.humidityHealth = SensorHealth::OK;
+        _status.push_back(status);
+    }
+
+    if (!_real) {
+        FakeBroker::instance().reset();
+        // O gateway vê tudo pelo observador, sem inscrição nem fila
+        FakeBroker::instance().setObserver(observe, this);
+        return true;
+    }
+
+    WiFi.begin(nullptr, nullptr);
+    _gatewayClient.setServer(_config.broker, _config.port);
+    _gatewayClient.setBufferSize(FAKE_BROKER_TOPIC_SIZE + FAKE_BROKER_PAYLOAD_SIZE);
+    _gatewayClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
+        onMessage(topic, payload, length);
+    });
+    char clientId[32];
+    snprintf(clientId, sizeof(clientId), "%s_gateway", _config.idPrefix);
+    if (!_gatewaySocket.connect(_config.broker, _config.port, MQTT_CONNECT_TIMEOUT)
+        || !_gatewayClient.connect(clientId, _config.user, _config.password)) {
+        fprintf(stderr, "Gateway não conectou a %s:%u (estado %d)\n",
+                _config.broker, _config.port, _gatewayClient.state());
+        return false;
+    }
+    _gatewayClient.subscribe(GATEWAY_FILTER);
+
+    _publishers.clear();
+    for (uint8_t i = 0; i < (_config.connections ? _config.connections : 1); i++) {
+        std::unique_ptr<Publisher> publisher(new Publisher());
+        publisher->client.setServer(_config.broker, _config.port);
+        publisher->client.setBufferSize(FAKE_BROKER_TOPIC_SIZE + FAKE_BROKER_PAYLOAD_SIZE);
+        snprintf(clientId, sizeof(clientId), "%s_pub%u", _config.idPrefix, i);
+        if (!publisher->socket.connect(_config.broker, _config.port, MQTT_CONNECT_TIMEOUT)
+            || !publisher->client.connect(clientId, _config.user, _config.password)) {
+            fprintf(stderr, "Publicador %u não conectou (estado %d)\n", i, publisher->client.state());
+            return false;
+        }
+        _publishers.push_back(std::move(publisher));
+    }
+    sleepUntil(nowMicros() + uint64_t(REAL_SETTLE_MS) * 1000);
+    return true;
+}
+
+void GatewayLoad::runBurst() {
+    // Codificados antes: o tempo medido é o do broker e do gateway
+    std::vector<uint8_t> payloads(size_t(_config.devices) * STATUS_JSON_CAPACITY);
+    std::vector<uint16_t> lengths(_config.devices);
+    for (uint32_t i = 0; i < _config.devices; i++) {
+        lengths[i] = uint16_t(serializeStatus(_status[i], _config.wireFormat,
+                                              &payloads[size_t(i) * STATUS_JSON_CAPACITY], STATUS_JSON_CAPACITY));
+    }
+
+    _gateway.resetStats();
+    uint64_t start = nowMicros();
+    for (uint32_t i = 0; i < _config.devices; i++) {
+        send(i, &payloads[size_t(i) * STATUS_JSON_CAPACITY], lengths[i], false);
+        if ((i + 1) % BURST_BATCH == 0) {
+            poll();
+            _gateway.publishDue(nowMicros(), epochNow(), publishSummary, this);
+        }
+    }
+    uint64_t deadline = nowMicros() + uint64_t(BURST_TIMEOUT_MS) * 1000;
+    while (_gateway.stats().messages < _config.devices && nowMicros() < deadline) {
+        poll();
+    }
+    uint64_t end = nowMicros();
+    _gateway.publishDue(end, epochNow(), publishSummary, this);
+
+    _report.devices = _config.devices;
+    _report.realBroker = _real;
+    _report.burstMessages = _gateway.stats().messages;
+    _report.burstSeconds = (end - start) / 1e6;
+}
+
+void GatewayLoad::runSteady() {
+    // A janela só conta o que chegou nela; os resumos da rajada já saíram
+    while (_gateway.publishDue(nowMicros(), epochNow(), publishSummary, this) == 0) {
+        poll();
+        sleepUntil(nowMicros() + uint64_t(_config.stepMs) * 1000);
+    }
+    _gateway.resetStats();
+
+    uint8_t payload[STATUS_JSON_CAPACITY];
+    uint32_t sent = 0;
+    uint32_t cursor = 0;
+    double credit = 0;
+    uint64_t start = nowMicros();
+    uint64_t last = start;
+    uint64_t end = start + uint64_t(_config.durationMs) * 1000;
+    while (nowMicros() < end) {
+        uint64_t now = nowMicros();
+        credit += double(_config.statusPerSecond) * _config.devices * (now - last) / 1e6;
+        last = now;
+        // Em rodízio: cada dispositivo publica a cada 1/statusPerSecond
+        while (credit >= 1.0 && _config.devices) {
+            credit -= 1.0;
+            uint32_t device = cursor;
+            cursor = (cursor + 1) % _config.devices;
+            ACStatus& status = _status[device];
+            uint8_t fields = STATUS_FIELD_CURRENT_TEMP;
+            int step = int(nextRandom() % 5) - 2;
+            status.currentTemp = roundf((status.currentTemp + (step ? step : 1) * 0.1f) * 10.0f) / 10.0f;
+            if (nextRandom() % 20 == 0) {
+                status.isOn = !status.isOn;
+                fields |= STATUS_FIELD_POWER;
+            }
+            size_t length = serializeStatusDelta(status, fields, _config.wireFormat, payload, sizeof(payload));
+            send(device, payload, length, true);
+            sent++;
+        }
+        poll();
+        _gateway.publishDue(nowMicros(), epochNow(), publishSummary, this);
+        sleepUntil((nowMicros() / 1000 / _config.stepMs + 1) * _config.stepMs * 1000);
+    }
+    // As últimas mudanças ainda entram na janela, no intervalo seguinte
+    uint64_t flushDeadline = nowMicros() + uint64_t(_config.publishIntervalMs) * 2000;
+    while (_gateway.publishDue(nowMicros(), epochNow(), publishSummary, this) == 0
+           && nowMicros() < flushDeadline) {
+        poll();
+        sleepUntil(nowMicros() + uint64_t(_config.stepMs) * 1000);
+    }
+
+    _report.devices = _config.devices;
+    _report.realBroker = _real;
+    _report.windowMs = uint32_t((end - start) / 1000);
+    _report.sent = sent;
+    _report.gateway = _gateway.stats();
+    _report.summaries = _report.gateway.publishes;
+}
+
+void GatewayLoad::send(uint32_t device, const uint8_t* payload, size_t length, bool delta) {
+    const std::string& topic = delta ? _deltaTopics[device] : _topics[device];
+    _sentAt[device] = nowMicros();
+    if (_real) {
+        Publisher& publisher = *_publishers[device % _publishers.size()];
+        publisher.client.publish(topic.c_str(), payload, unsigned(length), false);
+    } else {
+        FakeBroker::instance().inject(topic.c_str(), payload, unsigned(length));
+    }
+}
+
+// Na rede real: o gateway lê tudo o que chegou e os publicadores mantêm a
+// conexão viva; o relógio virtual (keepalive) segue o real
+void GatewayLoad::poll() {
+    if (!_real) return;
+    uint64_t now = nowMicros();
+    uint64_t virtualNow = HostClock::nowMicros();
+    if (now > virtualNow) HostClock::advanceMicros(now - virtualNow);
+    _gatewayClient.loop();
+    for (auto& publisher : _publishers) publisher->client.loop();
+}
+
+void GatewayLoad::observe(const FakeMessage& message, void* context) {
+    static_cast<GatewayLoad*>(context)->onMessage(message.topic, message.payload, message.length);
+}
+
+bool GatewayLoad::publishSummary(const char* topic, const uint8_t* payload, size_t length, bool, void* context) {
+    GatewayLoad* self = static_cast<GatewayLoad*>(context);
+    if (self->_real) return self->_gatewayClient.publish(topic, payload, unsigned(length), false);
+    return FakeBroker::instance().publish(topic, payload, unsigned(length), false);
+}
+
+void GatewayLoad::onMessage(const char* topic, const uint8_t* payload, size_t length) {
+    // No FakeBroker o observador também vê os resumos
+    const size_t rootLength = sizeof(TOPIC_ROOT) - 1;
+    if (strncmp(topic, TOPIC_ROOT, rootLength) != 0) return;
+    const char* id = topic + rootLength;
+    const char* slash = strchr(id, '/');
+    int index = slash ? deviceIndex(id, size_t(slash - id)) : -1;
+    _gateway.ingest(topic, payload, length, index >= 0 ? _sentAt[index] : nowMicros());
+}
+
+// "<prefixo>_<número>" -> dispositivo; -1 se não é desta carga
+int GatewayLoad::deviceIndex(const char* id, size_t length) const {
+    size_t prefixLength = strlen(_config.idPrefix);
+    if (length <= prefixLength + 1 || strncmp(id, _config.idPrefix, prefixLength) != 0
+        || id[prefixLength] != '_') {
+        return -1;
+    }
+    size_t index = 0;
+    for (size_t i = prefixLength + 1; i < length; i++) {
+        if (id[i] < '0' || id[i] > '9') return -1;
+        index = index * 10 + size_t(id[i] - '0');
+    }
+    return index < _sentAt.size() ? int(index) : -1;
+}
+
+uint64_t GatewayLoad::nowMicros() const {
+    return wallMicros() - _origin;
+}
+
+void GatewayLoad::sleepUntil(uint64_t us) {
+    uint64_t now = nowMicros();
+    if (us > now) std::this_thread::sleep_for(std::chrono::microseconds(us - now));
+}
+
+// xorshift32: a mesma semente reproduz a mesma carga
+uint32_t GatewayLoad::nextRandom() {
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
@@ -0,0 +1,101 @@
+#ifndef COOLIX_H
+#define COOLIX_H
+
+#include <stdint.h>
+#include "ACState.h"
+#include "IREncoder.h"
+
+// Protocolo Coolix (Midea/Springer/Electrolux), o mesmo do IRCoolixAC usado em
+// esp32_climatizador_controller.cpp: um quadro de 24 bits leva o estado
+// completo (liga, modo, temperatura, ventilador).
+//   bits 23..16  0xB2 (fixo)
+//   bits 15..13  ventilador
+//   bits 12..8   temperatura do sensor (11111 = ignorar)
+//   bits  7..4   temperatura (código de Gray, 17..30 °C)
+//   bits  3..2   modo
+namespace Coolix {
+    constexpr uint32_t OFF_CODE = 0xB27BE0;
+    constexpr uint8_t MIN_TEMP = 17;
+    constexpr uint8_t MAX_TEMP = 30;
+
+    constexpr uint8_t MODE_COOL = 0b00;
+    constexpr uint8_t MODE_DRY  = 0b01;
+    constexpr uint8_t MODE_AUTO = 0b10;
+    constexpr uint8_t FAN_MODE_TEMP_CODE = 0b1110;  // modo ventilar = DRY + este código
+
+    constexpr uint8_t FAN_AUTO0 = 0b000;    // obrigatório em AUTO e DRY
+    constexpr uint8_t FAN_MAX   = 0b001;
+    constexpr uint8_t FAN_MED   = 0b010;
+    constexpr uint8_t FAN_MIN   = 0b100;
+    constexpr uint8_t FAN_AUTO  = 0b101;
+    constexpr uint8_t SENSOR_IGNORE = 0b11111;
+
+    constexpr uint8_t TEMP_CODES[MAX_TEMP - MIN_TEMP + 1] = {
+        0b0000, 0b0001, 0b0011, 0b0010, 0b0110, 0b0111, 0b0101,     // 17..23
+        0b0100, 0b1100, 0b1101, 0b1001, 0b1000, 0b1010, 0b1011      // 24..30
+    };
+
+    // Temporizações em µs (múltiplos do tick de 276 µs)
+    constexpr uint16_t TICK = 276;
+    constexpr IRTimings TIMINGS = {17 * TICK, 16 * TICK, 2 * TICK, 6 * TICK, 2 * TICK, 19 * TICK, 38};
+    constexpr uint8_t BITS = 24;
+    constexpr uint8_t COPIES = 2;           // o quadro é sempre enviado duas vezes
+
+    // Cada byte vai seguido do inverso: cabeçalho + 48 bits + marca final,
+    // por cópia, com o intervalo entre as cópias
+    constexpr uint16_t RAW_LENGTH = COPIES * (2 + 2 * 2 * BITS + 2) - 1;
+
+    constexpr uint8_t fanCode(FanSpeed speed) {
+        return speed == FanSpeed::SLOW ? FAN_MIN
+             : speed == FanSpeed::MEDIUM ? FAN_MED
+             : speed == FanSpeed::FAST ? FAN_MAX
+             : FAN_AUTO;
+    }
+
+    constexpr uint8_t tempCode(uint8_t temp) {
+        return TEMP_CODES[(temp < MIN_TEMP ? MIN_TEMP : temp > MAX_TEMP ? MAX_TEMP : temp) - MIN_TEMP];
+    }
+
+    // Código de 24 bits para o estado; desligado é um código à parte
+    constexpr uint32_t stateCode(const ACSettings& settings) {
+        if (!settings.isOn) {
+            return OFF_CODE;
+        }
+        uint8_t mode = MODE_AUTO;
+        uint8_t temp = tempCode(settings.targetTemp);
+        uint8_t fan = FAN_AUTO0;
+        switch (settings.mode) {
+            case ACMode::COOL:
+                mode = MODE_COOL;
+                fan = fanCode(settings.fanSpeed);
+                break;
+            case ACMode::DRY:
+                mode = MODE_DRY;
+                break;
+            case ACMode::FAN:
+                mode = MODE_DRY;
+                temp = FAN_MODE_TEMP_CODE;
+                fan = fanCode(settings.fanSpeed);
+                break;
+            case ACMode::AUTO:
+                break;
+        }
+        return 0xB20000UL
+             | uint32_t(fan) << 13
+             | uint32_t(SENSOR_IGNORE) << 8
+             | uint32_t(temp) << 4
+             | uint32_t(mode) << 2;
+    }
+
+    static_assert(stateCode(ACSettings{true, 22, ACMode::COOL, FanSpeed::FAST}) == 0xB23F70,
+                  "código Coolix diverge do IRCoolixAC");
+}
+
+class CoolixEncoder : public IREncoder {
+public:
+    IRProtocol protocol() const override { return IRProtocol::COOLIX; }
+    uint8_t carrierKhz() const override { return Coolix::TIMINGS.khz; }
+    uint16_t encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const override;
+};
+
+#endif // COOLIX_H
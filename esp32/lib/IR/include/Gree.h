@@ -0,0 +1,105 @@
+#ifndef GREE_H
+#define GREE_H
+
+#include <stdint.h>
+#include "ACState.h"
+#include "IREncoder.h"
+
+// Protocolo Gree (YAW1F/YBOFB, o mesmo do IRGreeAC do IRremoteESP8266):
+// estado de 8 bytes enviados LSB primeiro em dois blocos de 4, separados por
+// um rodapé de 3 bits e um espaço longo.
+//   byte 0  bits 0..2 modo, 3 liga, 4..5 ventilador
+//   byte 1  bits 0..3 temperatura - 16
+//   byte 2  bit 5 luz do painel, bit 6 liga (modelo YAW1F)
+//   byte 7  bits 4..7 soma de verificação
+namespace Gree {
+    constexpr uint8_t STATE_LENGTH = 8;
+    constexpr uint8_t MIN_TEMP = 16;
+    constexpr uint8_t MAX_TEMP = 30;
+    constexpr uint8_t AUTO_TEMP = 25;       // em AUTO o aparelho ignora a temperatura
+
+    constexpr uint8_t MODE_AUTO = 0;
+    constexpr uint8_t MODE_COOL = 1;
+    constexpr uint8_t MODE_DRY  = 2;
+    constexpr uint8_t MODE_FAN  = 3;
+
+    constexpr uint8_t FAN_AUTO = 0;
+    constexpr uint8_t FAN_MIN  = 1;
+    constexpr uint8_t FAN_MED  = 2;
+    constexpr uint8_t FAN_MAX  = 3;
+
+    constexpr uint8_t POWER_BIT = 1 << 3;
+    constexpr uint8_t POWER2_BIT = 1 << 6;
+
+    constexpr IRTimings TIMINGS = {9000, 4500, 620, 1600, 540, 19980, 38};
+    constexpr uint8_t BLOCK_FOOTER = 0b010;
+    constexpr uint8_t BLOCK_FOOTER_BITS = 3;
+
+    // Cabeçalho, 2 blocos de 32 bits, rodapé do bloco e marcas finais
+    constexpr uint16_t RAW_LENGTH = 2 + 2 * 32 + 2 * BLOCK_FOOTER_BITS + 2 + 2 * 32 + 1;
+
+    struct State {
+        uint8_t bytes[STATE_LENGTH];
+    };
+
+    // Estado de fábrica do controle (IRGreeAC::stateReset): luz acesa, 25 °C
+    constexpr State RESET_STATE = {{0x00, 0x09, 0x20, 0x50, 0x00, 0x20, 0x00, 0x50}};
+
+    // 10 + nibbles baixos dos bytes 0..3 + nibbles altos dos bytes 4..6
+    constexpr uint8_t checksum(const State& state) {
+        uint8_t sum = 10;
+        for (uint8_t i = 0; i < 4; i++) sum += state.bytes[i] & 0x0F;
+        for (uint8_t i = 4; i < STATE_LENGTH - 1; i++) sum += state.bytes[i] >> 4;
+        return sum & 0x0F;
+    }
+
+    constexpr uint8_t fanCode(FanSpeed speed) {
+        return speed == FanSpeed::SLOW ? FAN_MIN
+             : speed == FanSpeed::MEDIUM ? FAN_MED
+             : speed == FanSpeed::FAST ? FAN_MAX
+             : FAN_AUTO;
+    }
+
+    // Como IRGreeAC::setMode: AUTO fixa 25 °C e DRY fixa o ventilador mínimo
+    constexpr State state(const ACSettings& settings) {
+        State s = RESET_STATE;
+        uint8_t mode = MODE_AUTO;
+        uint8_t temp = settings.targetTemp < MIN_TEMP ? MIN_TEMP
+                     : settings.targetTemp > MAX_TEMP ? MAX_TEMP
+                     : settings.targetTemp;
+        uint8_t fan = fanCode(settings.fanSpeed);
+        switch (settings.mode) {
+            case ACMode::COOL:
+                mode = MODE_COOL;
+                break;
+            case ACMode::DRY:
+                mode = MODE_DRY;
+                fan = FAN_MIN;
+                break;
+            case ACMode::FAN:
+                mode = MODE_FAN;
+                break;
+            case ACMode::AUTO:
+                temp = AUTO_TEMP;
+                break;
+        }
+        s.bytes[0] = uint8_t(mode | (settings.isOn ? POWER_BIT : 0) | fan << 4);
+        s.bytes[1] = uint8_t((s.bytes[1] & 0xF0) | (temp - MIN_TEMP));
+        s.bytes[2] = uint8_t(settings.isOn ? (s.bytes[2] | POWER2_BIT) : (s.bytes[2] & ~POWER2_BIT));
+        s.bytes[7] = uint8_t(checksum(s) << 4 | (s.bytes[7] & 0x0F));
+        return s;
+    }
+
+    static_assert(checksum(RESET_STATE) == RESET_STATE.bytes[7] >> 4, "soma Gree diverge do IRGreeAC");
+    static_assert(state(ACSettings{true, 24, ACMode::COOL, FanSpeed::AUTO}).bytes[7] == 0xD0,
+                  "soma Gree diverge do IRGreeAC");
+}
+
+class GreeEncoder : public IREncoder {
+public:
+    IRProtocol protocol() const override { return IRProtocol::GREE; }
+    uint8_t carrierKhz() const override { return Gree::TIMINGS.khz; }
+    uint16_t encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const override;
+};
+
+#endif // GREE_H
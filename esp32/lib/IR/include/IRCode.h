@@ -0,0 +1,62 @@
+#ifndef IR_CODE_H
+#define IR_CODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "IREncoder.h"
+
+// Código IR aprendido, comprimido para a flash (IRLibrary). Um quadro de
+// ar condicionado tem centenas de durações, mas poucos valores distintos:
+// as durações são agrupadas (tolerância de 20 %, a do receptor), cada grupo
+// vira a média quantizada em 1/8 do tick do protocolo (o menor grupo) e
+// cada par (marca, espaço) vira um índice num dicionário de até 16 pares,
+// empacotado em 1 a 4 bits.
+//
+//   formato (1) | pares (1) | bits por par (1) | 0 (1)
+//   quantum em µs (u16) | pares no quadro (u16)          little-endian
+//   dicionário: pares x (marca, espaço) em quanta (u16, u16)
+//   índices dos pares, LSB primeiro
+//
+// Espaço 0 no dicionário = quadro termina na marca. Um Coolix (199
+// durações, 398 bytes crus) fica em 8 + 5 x 4 + 38 = 66 bytes.
+namespace IRCode {
+    constexpr uint8_t FORMAT = 1;
+    constexpr size_t HEADER_BYTES = 8;
+    constexpr uint8_t MAX_PAIRS = 16;
+    constexpr uint8_t MAX_LEVELS = 32;          // durações distintas antes dos pares
+    constexpr uint8_t QUANTA_PER_TICK = 8;
+    constexpr uint16_t MIN_DURATIONS = 8;       // menos que isso é ruído, não tecla
+    // Maior código possível: o dicionário cheio e IR_MAX_PULSES durações
+    constexpr size_t MAX_BYTES = HEADER_BYTES + MAX_PAIRS * 4 + ((IR_MAX_PULSES + 1) / 2 * 4 + 7) / 8;
+
+    enum class Result : uint8_t {
+        OK,
+        SHORT,          // menos que MIN_DURATIONS
+        TOO_LONG,       // mais que IR_MAX_PULSES, ou não coube em capacity
+        IRREGULAR       // durações ou pares distintos demais para o dicionário
+    };
+
+    struct Info {
+        uint16_t durations;     // do quadro capturado
+        uint16_t tickUs;        // menor grupo de durações
+        uint16_t quantumUs;
+        uint8_t pairs;          // entradas do dicionário
+        uint8_t bits;           // por par no quadro
+        uint16_t bytes;         // do código comprimido
+    };
+
+    // Comprime 'count' durações (marca, espaço, marca...) em out
+    Result compress(const uint16_t* durations, uint16_t count, uint8_t* out, size_t capacity, Info& info);
+
+    // Fonte dos bytes de um código: false se a leitura falhou
+    typedef bool (*Reader)(void* context, size_t offset, void* destination, size_t size);
+
+    // Descomprime direto em durations lendo o código aos poucos, sem o
+    // código inteiro em RAM (ver IRLibrary); retorna o número de durações
+    // ou 0 se o código é inválido ou não cabe em capacity
+    uint16_t expand(Reader read, void* context, size_t length, uint16_t* durations, uint16_t capacity);
+    // O mesmo com o código em memória
+    uint16_t expand(const uint8_t* code, size_t length, uint16_t* durations, uint16_t capacity);
+}
+
+#endif // IR_CODE_H
@@ -0,0 +1,106 @@
+#ifndef IR_ENCODER_H
+#define IR_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ACState.h"
+
+// Protocolo do aparelho. NEC usa um código por tecla (IRCodes em config.h);
+// os demais levam o estado completo num quadro, montado por um IREncoder.
+enum class IRProtocol : uint8_t {
+    NEC,
+    COOLIX,     // Midea/Springer/Electrolux de 24 bits
+    GREE,
+    MIDEA,      // Midea de 48 bits com soma de verificação
+    LG,
+    LEARNED     // quadros capturados do controle remoto (IRLibrary)
+};
+
+constexpr const char* IR_PROTOCOL_NAMES[] = {
+    "NEC",
+    "COOLIX",
+    "GREE",
+    "MIDEA",
+    "LG",
+    "APRENDIDO"
+};
+
+constexpr size_t IR_PROTOCOL_COUNT = sizeof(IR_PROTOCOL_NAMES) / sizeof(IR_PROTOCOL_NAMES[0]);
+
+static_assert(IR_PROTOCOL_COUNT == size_t(IRProtocol::LEARNED) + 1, "IR_PROTOCOL_NAMES fora de sincronia com IRProtocol");
+
+constexpr const char* irProtocolName(IRProtocol protocol) {
+    return size_t(protocol) < IR_PROTOCOL_COUNT ? IR_PROTOCOL_NAMES[size_t(protocol)] : IR_PROTOCOL_NAMES[0];
+}
+
+// Nome desconhecido vira NEC (códigos por tecla de config.h)
+constexpr IRProtocol irProtocolFromName(const char* name) {
+    for (size_t i = 0; name && i < IR_PROTOCOL_COUNT; i++) {
+        if (namesEqual(name, IR_PROTOCOL_NAMES[i])) return IRProtocol(i);
+    }
+    return IRProtocol::NEC;
+}
+
+// Maior trem de pulsos (marcas + espaços) que um quadro pode ter
+constexpr uint16_t IR_MAX_PULSES = 256;
+
+// Temporizações (µs) de um protocolo de distância de pulso: cada bit é uma
+// marca fixa seguida de um espaço curto (0) ou longo (1)
+struct IRTimings {
+    uint16_t headerMark;
+    uint16_t headerSpace;
+    uint16_t bitMark;
+    uint16_t oneSpace;
+    uint16_t zeroSpace;
+    uint16_t gap;           // entre blocos ou cópias do quadro
+    uint8_t khz;
+};
+
+// Monta o trem de pulsos (marca, espaço, marca...) num buffer do chamador
+class IRPulseWriter {
+public:
+    IRPulseWriter(uint16_t* durations, uint16_t capacity)
+        : _durations(durations), _capacity(capacity), _length(0), _overflow(false) {}
+
+    void mark(uint16_t us) { append(us, true); }
+    void space(uint16_t us) { append(us, false); }
+    void header(const IRTimings& t) { mark(t.headerMark); space(t.headerSpace); }
+    void bitsMSBFirst(uint64_t data, uint8_t bits, const IRTimings& t);
+    void bitsLSBFirst(uint64_t data, uint8_t bits, const IRTimings& t);
+    void bytesLSBFirst(const uint8_t* bytes, size_t count, const IRTimings& t);
+    // Marca final; gap 0 encerra o quadro
+    void footer(const IRTimings& t, uint16_t gap) { mark(t.bitMark); if (gap) space(gap); }
+
+    // 0 se o quadro não coube no buffer
+    uint16_t length() const { return _overflow ? 0 : _length; }
+
+private:
+    uint16_t* _durations;
+    uint16_t _capacity;
+    uint16_t _length;
+    bool _overflow;
+
+    void append(uint16_t us, bool isMark);
+};
+
+// Codificador de estado completo de uma marca. As implementações não têm
+// estado: uma instância constante por protocolo, obtida por irEncoderFor().
+class IREncoder {
+public:
+    virtual IRProtocol protocol() const = 0;
+    virtual uint8_t carrierKhz() const = 0;
+    // Escreve o quadro de 'settings' em durations; retorna o número de
+    // durações (marca/espaço) ou 0 se não couber em capacity
+    virtual uint16_t encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const = 0;
+
+protected:
+    // Trivial: as instâncias são constantes sem construtor em tempo de
+    // execução, e as de protocolos fora do binário somem com ele
+    ~IREncoder() = default;
+};
+
+// Codificador do protocolo, ou nullptr para NEC (um código por tecla) e
+// para protocolo fora do binário (ver AC_IR_PROTOCOL em config.h)
+const IREncoder* irEncoderFor(IRProtocol protocol);
+
+#endif // IR_ENCODER_H
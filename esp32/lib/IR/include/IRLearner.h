@@ -0,0 +1,74 @@
+#ifndef IR_LEARNER_H
+#define IR_LEARNER_H
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include "IRCode.h"
+#include "IRLearnCodec.h"
+#include "IRLibrary.h"
+#include "config.h"
+
+// Modo de aprendizado: um receptor IR (TSOP38238 ou parecido, saída ativa
+// em baixo) no RMT captura a tecla do controle remoto original e o quadro
+// vai comprimido (IRCode) para a IRLibrary, na chave do estado pedido pelo
+// servidor. Como no Dht22Reader, o RMT mede os pulsos e entrega o quadro
+// inteiro num ring buffer: poll() só consulta, nada espera.
+//
+// Também apaga a biblioteca, um setor por poll(). Uso de uma tarefa só (a
+// de rede, que recebe o comando APRENDER_IR e publica o relatório).
+class IRLearner {
+public:
+    // Fim do quadro: maior que o intervalo entre os blocos do Gree (20 ms)
+    // e menor que o limite de 15 bits do RMT
+    static const uint16_t IDLE_THRESHOLD_US = 25000;
+
+    // memBlocks: blocos de 64 itens do canal (canal até canal + memBlocks
+    // - 1); um Coolix capturado ocupa 100 itens
+    IRLearner(uint8_t pin, IRLibrary& library, rmt_channel_t channel = RMT_CHANNEL_5, uint8_t memBlocks = 3);
+    ~IRLearner();
+
+    // Instala o receptor; a biblioteca já deve ter passado por begin().
+    // false (e aprender fica INDISPONIVEL) sem o receptor ou sem a partição.
+    bool begin();
+
+    // Arma o receptor: a próxima tecla em até timeoutMs vira o código de
+    // 'settings'. Armar de novo troca a chave e reinicia o prazo.
+    void learn(const ACSettings& settings, uint32_t timeoutMs = IR_LEARN_TIMEOUT);
+    // Esquece todos os códigos e apaga a partição
+    void erase();
+    void poll();
+
+    IRLearnState state() const { return _state; }
+    bool busy() const { return _state == IRLearnState::WAITING || _state == IRLearnState::ERASING; }
+
+    bool reportDue() const { return _reportDue; }
+    IRLearnReport report() const;
+    void reportSent() { _reportDue = false; }
+
+private:
+    uint8_t _pin;
+    rmt_channel_t _channel;
+    uint8_t _memBlocks;
+    IRLibrary& _library;
+    RingbufHandle_t _ring;
+    bool _installed;
+
+    IRLearnState _state;
+    bool _reportDue;
+    ACSettings _settings;
+    bool _hasKey;
+    unsigned long _deadline;
+    uint16_t _eraseNext;
+    IRCode::Info _info;
+
+    // Captura antes da compressão; só este objeto tem um quadro em RAM
+    uint16_t _durations[IR_MAX_PULSES];
+    uint8_t _code[IRCode::MAX_BYTES];
+
+    void startCapture();
+    void stopCapture();
+    bool capture(const rmt_item32_t* items, size_t count);
+    void finish(IRLearnState state);
+};
+
+#endif // IR_LEARNER_H
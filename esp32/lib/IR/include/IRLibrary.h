@@ -0,0 +1,100 @@
+#ifndef IR_LIBRARY_H
+#define IR_LIBRARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <esp_partition.h>
+#include "ACState.h"
+#include "IRCode.h"
+#include "IREncoder.h"
+
+// Biblioteca de códigos aprendidos (protocolo APRENDIDO) na partição de
+// dados "irlib" (partitions.csv), por chave (ligado, modo, temperatura,
+// velocidade). Só o índice fica em RAM; o código comprimido (IRCode) é lido
+// da flash e descomprimido direto no buffer do IRSender na hora do quadro.
+//
+// A partição é um log: cada código aprendido é anexado ao fim e o índice
+// aponta para o mais novo de cada chave. Um registro só vale depois que o
+// número mágico é gravado, por último, então um corte de energia no meio
+// deixa um registro ignorado em vez de um código truncado. Cheia, só
+// apagando tudo (erase()).
+//
+//   mágico (u16) | chave (u16) | bytes do código (u16) | durações (u16)
+//   código, completado com 0xFF até múltiplo de 4
+//
+// A tarefa de rede grava e apaga (IRLearner) e a de controle lê (encode).
+// Cada entrada do índice é atômica: store() a publica com release depois
+// que o registro inteiro está na flash, clear() a zera, e expand() a lê com
+// acquire uma vez só. Se a entrada muda no meio da leitura (um apagamento
+// começou), ou o cabeçalho na flash não é o da chave, nada vai ao ar.
+class IRLibrary {
+public:
+    static const uint16_t MAGIC = 0x4C49;              // "IL"
+    static const size_t RECORD_HEADER_BYTES = 8;
+    static const uint8_t MIN_TEMP = 16;
+    static const uint8_t MAX_TEMP = 30;
+    // Desligado é uma chave só; ligado, uma por modo x temperatura x velocidade
+    static const uint16_t KEYS = 1 + AC_MODE_COUNT * (MAX_TEMP - MIN_TEMP + 1) * FAN_SPEED_COUNT;
+    static const uint16_t NO_KEY = 0xFFFF;
+
+    static uint16_t keyOf(const ACSettings& settings);
+
+    enum class StoreResult : uint8_t {
+        OK,
+        FULL,           // sem espaço: apagar a biblioteca
+        FLASH,          // partição ausente ou gravação falhou
+        INVALID         // código vazio ou chave fora da faixa
+    };
+
+    IRLibrary();
+
+    // Encontra a partição e monta o índice percorrendo o log; false sem a
+    // partição. Chamar de novo relê a flash.
+    bool begin(const char* label = "irlib");
+    bool ready() const { return _partition != nullptr; }
+
+    StoreResult store(uint16_t key, const uint8_t* code, size_t length, uint16_t durations);
+    bool contains(uint16_t key) const { return key < KEYS && _index[key].load(std::memory_order_acquire) != 0; }
+    // Descomprime o código da chave em durations; 0 se não aprendido
+    uint16_t expand(uint16_t key, uint16_t* durations, uint16_t capacity) const;
+
+    // Apagar a biblioteca: clear() esquece o índice na hora (nada mais é
+    // lido da partição) e eraseSector() apaga um setor por chamada, para
+    // não parar a flash por todos os setores de uma vez
+    void clear();
+    bool eraseSector(uint16_t sector);
+    uint16_t sectors() const { return _partition ? uint16_t(_partition->size / SPI_FLASH_SEC_SIZE) : 0; }
+
+    uint16_t codes() const { return _codes; }
+    size_t used() const { return _end; }
+    size_t capacity() const { return _partition ? _partition->size : 0; }
+
+private:
+    const esp_partition_t* _partition;
+    // Deslocamento / 4 + 1 do registro de cada chave; 0 = não aprendida
+    std::atomic<uint16_t> _index[KEYS];
+    uint16_t _codes;
+    size_t _end;            // primeiro byte livre do log
+};
+
+// Codificador do protocolo APRENDIDO: o quadro do estado vem de uma
+// biblioteca. Sem o código da chave, o quadro fica vazio e nada vai ao ar.
+class IRLibraryEncoder : public IREncoder {
+public:
+    explicit constexpr IRLibraryEncoder(const IRLibrary& library) : _library(library) {}
+
+    IRProtocol protocol() const override { return IRProtocol::LEARNED; }
+    // O receptor entrega o sinal já demodulado: a portadora é a de
+    // IR_LEARNED_KHZ (config.h), não a medida
+    uint8_t carrierKhz() const override;
+    uint16_t encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const override;
+
+private:
+    const IRLibrary& _library;
+};
+
+// A biblioteca do dispositivo, lida por irEncoderFor(IRProtocol::LEARNED)
+extern IRLibrary irLibrary;
+
+#endif // IR_LIBRARY_H
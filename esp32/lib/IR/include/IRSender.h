@@ -2,18 +2,101 @@
 #define IR_SENDER_H
 
 #include <Arduino.h>
-#include <IRremote.h>
+#include <driver/rmt.h>
+#include "IREncoder.h"
 
+// Chave de coalescência da fila: um quadro que ainda não foi ao ar é
+// substituído pelo próximo enviado com a mesma chave, sem perder a vez
+enum class IRSlot : uint8_t {
+    POWER,
+    TEMPERATURE,
+    MODE,
+    FAN_SPEED,
+    STATE,      // estado completo (IREncoder)
+    RAW
+};
+
+constexpr uint8_t IR_SLOT_COUNT = uint8_t(IRSlot::RAW) + 1;
+
+// Transmissor IR assíncrono sobre o periférico RMT do ESP32. Os send*()
+// só enfileiram e retornam; poll() inicia o próximo quadro quando o RMT
+// terminou o anterior e o intervalo entre quadros venceu. Nada aqui usa
+// delay(): quem chama poll() periodicamente (tarefa de controle) nunca
+// fica parado pelo tempo de ar dos quadros.
 class IRSender {
 public:
-    IRSender(uint8_t pin);
+    // Intervalo mínimo entre o fim de um quadro e o início do próximo
+    static const uint16_t FRAME_GAP_MS = 100;
+    // Maior quadro RAW aceito, em durações (marca/espaço)
+    static const uint16_t MAX_RAW_LENGTH = IR_MAX_PULSES;
+
+    IRSender(uint8_t pin, rmt_channel_t channel = RMT_CHANNEL_0);
+    ~IRSender();
     void begin();
-    void sendNECCommand(uint16_t address, uint16_t command);
+
+    void sendNECCommand(uint16_t address, uint16_t command, IRSlot slot);
+    // O quadro é montado pelo codificador só na hora de ir ao ar, então um
+    // estado substituído na fila não custa nada
+    void sendState(const IREncoder& encoder, const ACSettings& settings);
+    // Durações acima de 32767 µs (limite do RMT) são truncadas
     void sendRaw(const uint16_t buf[], uint16_t len, uint16_t hz = 38);
 
+    void poll();
+    // Nada na fila nem no ar
+    bool idle() const { return !_busy && !_queued; }
+    uint8_t queued() const { return _queued; }
+
+    // Quadros transmitidos e envios absorvidos por um quadro ainda na fila
+    uint32_t framesSent() const { return _framesSent; }
+    uint32_t framesCoalesced() const { return _framesCoalesced; }
+    // micros() do início do último quadro
+    unsigned long lastFrameStartUs() const { return _txStartUs; }
+
 private:
+    enum class Encoding : uint8_t {
+        NEC,
+        STATE,
+        RAW
+    };
+
+    struct Frame {
+        Encoding encoding;
+        uint32_t code;
+        const IREncoder* encoder;
+        ACSettings settings;
+    };
+
     uint8_t _pin;
-    IRsend _irsend;
+    rmt_channel_t _channel;
+    bool _installed;
+
+    // Fila FIFO de chaves; cada chave aparece no máximo uma vez
+    Frame _frames[IR_SLOT_COUNT];
+    uint8_t _order[IR_SLOT_COUNT];
+    uint8_t _head;
+    uint8_t _queued;
+    uint8_t _queuedMask;
+
+    uint16_t _raw[MAX_RAW_LENGTH];
+    uint16_t _rawLength;
+    uint16_t _rawKhz;
+
+    // Trem de pulsos do próximo quadro; o RMT lê de _items durante a transmissão
+    uint16_t _pulses[MAX_RAW_LENGTH];
+    rmt_item32_t _items[(MAX_RAW_LENGTH + 1) / 2];
+    uint16_t _carrierKhz;
+    bool _busy;
+    bool _sentAny;
+    unsigned long _txStartUs;
+    unsigned long _nextFrameAt;     // micros() a partir do qual o próximo pode sair
+
+    uint32_t _framesSent;
+    uint32_t _framesCoalesced;
+
+    void enqueue(IRSlot slot, const Frame& frame);
+    void startNext();
+    void setCarrier(uint16_t khz);
+    uint16_t loadItems(const uint16_t* durations, uint16_t length);
 };
 
-#endif // IR_SENDER_H
\ No newline at end of file
+#endif // IR_SENDER_H
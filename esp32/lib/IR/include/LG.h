@@ -0,0 +1,87 @@
+#ifndef LG_H
+#define LG_H
+
+#include <stdint.h>
+#include "ACState.h"
+#include "IREncoder.h"
+
+// Protocolo LG de 28 bits dos splits (IRLgAc do IRremoteESP8266), MSB primeiro.
+//   bits 27..20  assinatura 0x88
+//   bits 19..18  energia (00 liga/altera, 11 desliga)
+//   bits 14..12  modo
+//   bits 11..8   temperatura - 15
+//   bits  7..4   ventilador
+//   bits  3..0   soma dos quatro nibbles acima
+namespace LG {
+    constexpr uint32_t SIGNATURE = 0x88;
+    constexpr uint32_t OFF_CODE = 0x88C0051;
+    constexpr uint8_t POWER_ON = 0b00;
+    constexpr uint8_t MIN_TEMP = 16;
+    constexpr uint8_t MAX_TEMP = 30;
+    constexpr uint8_t TEMP_ADJUST = 15;
+
+    constexpr uint8_t MODE_COOL = 0;
+    constexpr uint8_t MODE_DRY  = 1;
+    constexpr uint8_t MODE_FAN  = 2;
+    constexpr uint8_t MODE_AUTO = 3;
+
+    constexpr uint8_t FAN_LOW    = 0;
+    constexpr uint8_t FAN_MEDIUM = 2;
+    constexpr uint8_t FAN_HIGH   = 4;
+    constexpr uint8_t FAN_AUTO   = 5;
+
+    constexpr IRTimings TIMINGS = {8500, 4250, 550, 1600, 550, 0, 38};
+    constexpr uint8_t BITS = 28;
+    constexpr uint16_t RAW_LENGTH = 2 + 2 * BITS + 1;
+
+    constexpr uint8_t checksum(uint32_t code) {
+        uint8_t sum = 0;
+        for (uint8_t i = 1; i <= 4; i++) {
+            sum += (code >> (4 * i)) & 0x0F;
+        }
+        return sum & 0x0F;
+    }
+
+    constexpr uint8_t fanCode(FanSpeed speed) {
+        return speed == FanSpeed::SLOW ? FAN_LOW
+             : speed == FanSpeed::MEDIUM ? FAN_MEDIUM
+             : speed == FanSpeed::FAST ? FAN_HIGH
+             : FAN_AUTO;
+    }
+
+    constexpr uint8_t modeCode(ACMode mode) {
+        return mode == ACMode::COOL ? MODE_COOL
+             : mode == ACMode::DRY ? MODE_DRY
+             : mode == ACMode::FAN ? MODE_FAN
+             : MODE_AUTO;
+    }
+
+    // Desligar é um código fixo
+    constexpr uint32_t stateCode(const ACSettings& settings) {
+        if (!settings.isOn) {
+            return OFF_CODE;
+        }
+        uint8_t temp = settings.targetTemp < MIN_TEMP ? MIN_TEMP
+                     : settings.targetTemp > MAX_TEMP ? MAX_TEMP
+                     : settings.targetTemp;
+        uint32_t code = SIGNATURE << 20
+                      | uint32_t(POWER_ON) << 18
+                      | uint32_t(modeCode(settings.mode)) << 12
+                      | uint32_t(temp - TEMP_ADJUST) << 8
+                      | uint32_t(fanCode(settings.fanSpeed)) << 4;
+        return code | checksum(code);
+    }
+
+    static_assert(checksum(OFF_CODE) == (OFF_CODE & 0x0F), "soma LG diverge do IRLgAc");
+    static_assert(stateCode(ACSettings{true, 18, ACMode::COOL, FanSpeed::FAST}) == 0x8800347,
+                  "código LG diverge do IRLgAc");
+}
+
+class LGEncoder : public IREncoder {
+public:
+    IRProtocol protocol() const override { return IRProtocol::LG; }
+    uint8_t carrierKhz() const override { return LG::TIMINGS.khz; }
+    uint16_t encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const override;
+};
+
+#endif // LG_H
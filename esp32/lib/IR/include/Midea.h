@@ -0,0 +1,96 @@
+#ifndef MIDEA_H
+#define MIDEA_H
+
+#include <stdint.h>
+#include "ACState.h"
+#include "IREncoder.h"
+
+// Protocolo Midea de 48 bits (IRMideaAC do IRremoteESP8266), enviado MSB
+// primeiro e repetido em seguida com todos os bits invertidos.
+//   byte 5  0xA1 (cabeçalho + tipo "comando")
+//   byte 4  bit 7 liga, bits 3..4 ventilador, bits 0..2 modo
+//   byte 3  bits 0..4 temperatura - 17 (°C), bit 6 fixo
+//   byte 2  temporizador desligado (0xFF)
+//   byte 1  sensor do controle desabilitado (0xFF)
+//   byte 0  soma de verificação
+namespace Midea {
+    constexpr uint8_t MIN_TEMP = 17;
+    constexpr uint8_t MAX_TEMP = 30;
+
+    constexpr uint8_t MODE_COOL = 0;
+    constexpr uint8_t MODE_DRY  = 1;
+    constexpr uint8_t MODE_AUTO = 2;
+    constexpr uint8_t MODE_FAN  = 4;
+
+    constexpr uint8_t FAN_AUTO = 0;
+    constexpr uint8_t FAN_LOW  = 1;
+    constexpr uint8_t FAN_MED  = 2;
+    constexpr uint8_t FAN_HIGH = 3;
+
+    constexpr uint64_t HEADER = 0xA1;
+    constexpr uint8_t TEMP_FIXED_BITS = 0x40;
+    constexpr uint16_t UNUSED_TIMER_SENSOR = 0xFFFF;
+
+    // Temporizações em µs (múltiplos do tick de 80 µs)
+    constexpr uint16_t TICK = 80;
+    constexpr IRTimings TIMINGS = {56 * TICK, 56 * TICK, 7 * TICK, 21 * TICK, 7 * TICK, 70 * TICK, 38};
+    constexpr uint8_t BITS = 48;
+    constexpr uint64_t MASK = (1ULL << BITS) - 1;
+    constexpr uint16_t RAW_LENGTH = 2 * (2 + 2 * BITS + 2) - 1;
+
+    constexpr uint8_t reverseBits(uint8_t value) {
+        uint8_t result = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            result = uint8_t(result << 1 | ((value >> i) & 1));
+        }
+        return result;
+    }
+
+    // 256 menos a soma dos bytes 1..5 com os bits invertidos, invertida
+    constexpr uint8_t checksum(uint64_t code) {
+        uint8_t sum = 0;
+        for (uint8_t i = 1; i < 6; i++) {
+            sum = uint8_t(sum + reverseBits(uint8_t(code >> (8 * i))));
+        }
+        return reverseBits(uint8_t(256 - sum));
+    }
+
+    constexpr uint8_t fanCode(FanSpeed speed) {
+        return speed == FanSpeed::SLOW ? FAN_LOW
+             : speed == FanSpeed::MEDIUM ? FAN_MED
+             : speed == FanSpeed::FAST ? FAN_HIGH
+             : FAN_AUTO;
+    }
+
+    constexpr uint8_t modeCode(ACMode mode) {
+        return mode == ACMode::COOL ? MODE_COOL
+             : mode == ACMode::DRY ? MODE_DRY
+             : mode == ACMode::FAN ? MODE_FAN
+             : MODE_AUTO;
+    }
+
+    constexpr uint64_t stateCode(const ACSettings& settings) {
+        uint8_t temp = settings.targetTemp < MIN_TEMP ? MIN_TEMP
+                     : settings.targetTemp > MAX_TEMP ? MAX_TEMP
+                     : settings.targetTemp;
+        uint64_t code = HEADER << 40
+                      | uint64_t((settings.isOn ? 0x80 : 0) | fanCode(settings.fanSpeed) << 3 | modeCode(settings.mode)) << 32
+                      | uint64_t(TEMP_FIXED_BITS | (temp - MIN_TEMP)) << 24
+                      | uint64_t(UNUSED_TIMER_SENSOR) << 8;
+        return code | checksum(code);
+    }
+
+    // Desligar conhecido do controle Midea (0xA1026FFFFFE2) confere a soma
+    static_assert(checksum(0xA1026FFFFF00ULL) == 0xE2, "soma Midea diverge do IRMideaAC");
+    static_assert(stateCode(ACSettings{true, 24, ACMode::COOL, FanSpeed::FAST}) == 0xA19847FFFF41ULL,
+                  "código Midea diverge do IRMideaAC");
+}
+
+class MideaEncoder : public IREncoder {
+public:
+    IRProtocol protocol() const override { return IRProtocol::MIDEA; }
+    uint8_t carrierKhz() const override { return Midea::TIMINGS.khz; }
+    uint16_t encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const override;
+};
+
+#endif // MIDEA_H
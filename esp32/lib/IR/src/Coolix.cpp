@@ -0,0 +1,16 @@
+#include "Coolix.h"
+
+uint16_t CoolixEncoder::encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const {
+    // Cada byte (MSB primeiro) seguido do seu inverso, quadro repetido
+    uint32_t code = Coolix::stateCode(settings);
+    IRPulseWriter writer(durations, capacity);
+    for (uint8_t copy = 0; copy < Coolix::COPIES; copy++) {
+        writer.header(Coolix::TIMINGS);
+        for (int8_t shift = Coolix::BITS - 8; shift >= 0; shift -= 8) {
+            uint8_t byte = uint8_t(code >> shift);
+            writer.bitsMSBFirst(uint16_t(byte) << 8 | uint8_t(~byte), 16, Coolix::TIMINGS);
+        }
+        writer.footer(Coolix::TIMINGS, copy + 1 < Coolix::COPIES ? Coolix::TIMINGS.gap : 0);
+    }
+    return writer.length();
+}
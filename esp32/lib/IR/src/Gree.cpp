@@ -0,0 +1,13 @@
+#include "Gree.h"
+
+uint16_t GreeEncoder::encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const {
+    Gree::State state = Gree::state(settings);
+    IRPulseWriter writer(durations, capacity);
+    writer.header(Gree::TIMINGS);
+    writer.bytesLSBFirst(state.bytes, 4, Gree::TIMINGS);
+    writer.bitsLSBFirst(Gree::BLOCK_FOOTER, Gree::BLOCK_FOOTER_BITS, Gree::TIMINGS);
+    writer.footer(Gree::TIMINGS, Gree::TIMINGS.gap);
+    writer.bytesLSBFirst(state.bytes + 4, Gree::STATE_LENGTH - 4, Gree::TIMINGS);
+    writer.footer(Gree::TIMINGS, 0);
+    return writer.length();
+}
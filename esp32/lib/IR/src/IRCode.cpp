@@ -0,0 +1,201 @@
+#include "IRCode.h"
+#include <string.h>
+
+namespace IRCode {
+
+namespace {
+
+// Duração que entra no grupo: até 20 % da média dele
+bool near(uint32_t value, uint32_t center) {
+    uint32_t tolerance = center / 5;
+    return value + tolerance >= center && value <= center + tolerance;
+}
+
+void put16(uint8_t* out, uint16_t value) {
+    out[0] = uint8_t(value);
+    out[1] = uint8_t(value >> 8);
+}
+
+uint16_t get16(const uint8_t* in) {
+    return uint16_t(in[0] | in[1] << 8);
+}
+
+struct Levels {
+    uint32_t sum[MAX_LEVELS];
+    uint16_t count[MAX_LEVELS];
+    uint8_t size;
+
+    uint32_t center(uint8_t level) const { return (sum[level] + count[level] / 2) / count[level]; }
+
+    // Grupo mais próximo de value; com 'strict', MAX_LEVELS se nenhum está
+    // na tolerância
+    uint8_t nearest(uint32_t value, bool strict) const {
+        uint8_t best = MAX_LEVELS;
+        uint32_t bestDistance = UINT32_MAX;
+        for (uint8_t i = 0; i < size; i++) {
+            uint32_t c = center(i);
+            uint32_t distance = value > c ? value - c : c - value;
+            if (distance < bestDistance && (!strict || near(value, c))) {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+        return best;
+    }
+};
+
+// Código em memória como Reader
+bool readMemory(void* context, size_t offset, void* destination, size_t size) {
+    memcpy(destination, static_cast<const uint8_t*>(context) + offset, size);
+    return true;
+}
+
+}  // namespace
+
+Result compress(const uint16_t* durations, uint16_t count, uint8_t* out, size_t capacity, Info& info) {
+    info = Info{};
+    info.durations = count;
+    if (count < MIN_DURATIONS) return Result::SHORT;
+    if (count > IR_MAX_PULSES) return Result::TOO_LONG;
+
+    // Agrupa as durações; a média de cada grupo se ajusta a cada membro
+    Levels levels{};
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t level = levels.nearest(durations[i], true);
+        if (level == MAX_LEVELS) {
+            if (levels.size == MAX_LEVELS) return Result::IRREGULAR;
+            level = levels.size++;
+        }
+        levels.sum[level] += durations[i];
+        levels.count[level]++;
+    }
+
+    // O menor grupo é o tick do protocolo (a marca de bit, em geral)
+    uint32_t tick = UINT32_MAX;
+    for (uint8_t i = 0; i < levels.size; i++) {
+        if (levels.center(i) < tick) tick = levels.center(i);
+    }
+    uint32_t quantum = (tick + QUANTA_PER_TICK / 2) / QUANTA_PER_TICK;
+    if (quantum == 0) quantum = 1;
+
+    uint16_t quanta[MAX_LEVELS];
+    for (uint8_t i = 0; i < levels.size; i++) {
+        uint32_t q = (levels.center(i) + quantum / 2) / quantum;
+        quanta[i] = q > UINT16_MAX ? UINT16_MAX : uint16_t(q);
+    }
+
+    // Dicionário de pares (marca, espaço) em quanta; um só índice por par.
+    // As médias andaram desde o agrupamento: cada duração vai para a mais
+    // próxima, dentro da tolerância ou não.
+    uint16_t pairs[MAX_PAIRS][2];
+    uint8_t pairCount = 0;
+    uint8_t symbols[(IR_MAX_PULSES + 1) / 2];
+    uint16_t symbolCount = 0;
+    for (uint16_t i = 0; i < count; i += 2) {
+        uint16_t mark = quanta[levels.nearest(durations[i], false)];
+        uint16_t space = i + 1 < count ? quanta[levels.nearest(durations[i + 1], false)] : 0;
+        uint8_t index = 0;
+        while (index < pairCount && (pairs[index][0] != mark || pairs[index][1] != space)) index++;
+        if (index == pairCount) {
+            if (pairCount == MAX_PAIRS) return Result::IRREGULAR;
+            pairs[pairCount][0] = mark;
+            pairs[pairCount][1] = space;
+            pairCount++;
+        }
+        symbols[symbolCount++] = index;
+    }
+
+    uint8_t bits = 1;
+    while ((1u << bits) < pairCount) bits++;
+    size_t length = HEADER_BYTES + size_t(pairCount) * 4 + (size_t(symbolCount) * bits + 7) / 8;
+    if (length > capacity) return Result::TOO_LONG;
+
+    out[0] = FORMAT;
+    out[1] = pairCount;
+    out[2] = bits;
+    out[3] = 0;
+    put16(out + 4, uint16_t(quantum));
+    put16(out + 6, symbolCount);
+    uint8_t* at = out + HEADER_BYTES;
+    for (uint8_t i = 0; i < pairCount; i++, at += 4) {
+        put16(at, pairs[i][0]);
+        put16(at + 2, pairs[i][1]);
+    }
+    memset(at, 0, length - size_t(at - out));
+    for (uint16_t i = 0; i < symbolCount; i++) {
+        size_t bit = size_t(i) * bits;
+        uint16_t value = uint16_t(symbols[i]) << (bit % 8);
+        at[bit / 8] |= uint8_t(value);
+        if (value >> 8) at[bit / 8 + 1] |= uint8_t(value >> 8);
+    }
+
+    info.tickUs = uint16_t(tick);
+    info.quantumUs = uint16_t(quantum);
+    info.pairs = pairCount;
+    info.bits = bits;
+    info.bytes = uint16_t(length);
+    return Result::OK;
+}
+
+uint16_t expand(Reader read, void* context, size_t length, uint16_t* durations, uint16_t capacity) {
+    uint8_t header[HEADER_BYTES];
+    if (length < HEADER_BYTES || !read(context, 0, header, HEADER_BYTES)) return 0;
+    uint8_t pairCount = header[1];
+    uint8_t bits = header[2];
+    uint32_t quantum = get16(header + 4);
+    uint16_t symbolCount = get16(header + 6);
+    size_t packed = (size_t(symbolCount) * bits + 7) / 8;
+    if (header[0] != FORMAT || pairCount == 0 || pairCount > MAX_PAIRS || bits == 0 || bits > 4
+        || length < HEADER_BYTES + size_t(pairCount) * 4 + packed) {
+        return 0;
+    }
+
+    // Só o dicionário fica em RAM, já em µs
+    uint8_t raw[MAX_PAIRS * 4];
+    if (!read(context, HEADER_BYTES, raw, size_t(pairCount) * 4)) return 0;
+    uint32_t marks[MAX_PAIRS];
+    uint32_t spaces[MAX_PAIRS];
+    for (uint8_t i = 0; i < pairCount; i++) {
+        marks[i] = get16(raw + i * 4) * quantum;
+        spaces[i] = get16(raw + i * 4 + 2) * quantum;
+    }
+
+    // Índices lidos em blocos de 32 bytes
+    IRPulseWriter writer(durations, capacity);
+    uint8_t chunk[32];
+    size_t offset = HEADER_BYTES + size_t(pairCount) * 4;
+    size_t chunkLength = 0;
+    size_t chunkAt = 0;
+    uint32_t accumulator = 0;
+    uint8_t available = 0;
+    const uint8_t mask = uint8_t((1u << bits) - 1);
+    for (uint16_t i = 0; i < symbolCount; i++) {
+        if (available < bits) {
+            if (chunkAt == chunkLength) {
+                chunkLength = packed < sizeof(chunk) ? packed : sizeof(chunk);
+                if (!read(context, offset, chunk, chunkLength)) return 0;
+                offset += chunkLength;
+                packed -= chunkLength;
+                chunkAt = 0;
+            }
+            accumulator |= uint32_t(chunk[chunkAt++]) << available;
+            available += 8;
+        }
+        uint8_t index = accumulator & mask;
+        accumulator >>= bits;
+        available -= bits;
+        if (index >= pairCount) return 0;
+
+        uint32_t mark = marks[index] < UINT16_MAX ? marks[index] : UINT16_MAX;
+        uint32_t space = spaces[index] < UINT16_MAX ? spaces[index] : UINT16_MAX;
+        writer.mark(uint16_t(mark));
+        writer.space(uint16_t(space));
+    }
+    return writer.length();
+}
+
+uint16_t expand(const uint8_t* code, size_t length, uint16_t* durations, uint16_t capacity) {
+    return expand(readMemory, const_cast<uint8_t*>(code), length, durations, capacity);
+}
+
+}  // namespace IRCode
@@ -0,0 +1,86 @@
+#include "IREncoder.h"
+#include "Coolix.h"
+#include "Gree.h"
+#include "IRLibrary.h"
+#include "LG.h"
+#include "Midea.h"
+#include "config.h"
+
+void IRPulseWriter::append(uint16_t us, bool isMark) {
+    if (_overflow || us == 0) return;
+
+    // Dois trechos seguidos do mesmo nível viram um só
+    bool expectMark = (_length % 2) == 0;
+    if (isMark != expectMark) {
+        if (_length == 0) return;   // espaço antes da primeira marca não existe
+        uint32_t merged = uint32_t(_durations[_length - 1]) + us;
+        _durations[_length - 1] = merged > 0xFFFF ? 0xFFFF : uint16_t(merged);
+        return;
+    }
+    if (_length >= _capacity) {
+        _overflow = true;
+        return;
+    }
+    _durations[_length++] = us;
+}
+
+void IRPulseWriter::bitsMSBFirst(uint64_t data, uint8_t bits, const IRTimings& t) {
+    for (int8_t bit = int8_t(bits) - 1; bit >= 0; bit--) {
+        mark(t.bitMark);
+        space((data >> bit) & 1 ? t.oneSpace : t.zeroSpace);
+    }
+}
+
+void IRPulseWriter::bitsLSBFirst(uint64_t data, uint8_t bits, const IRTimings& t) {
+    for (uint8_t bit = 0; bit < bits; bit++) {
+        mark(t.bitMark);
+        space((data >> bit) & 1 ? t.oneSpace : t.zeroSpace);
+    }
+}
+
+void IRPulseWriter::bytesLSBFirst(const uint8_t* bytes, size_t count, const IRTimings& t) {
+    for (size_t i = 0; i < count; i++) {
+        bitsLSBFirst(bytes[i], 8, t);
+    }
+}
+
+static_assert(Coolix::RAW_LENGTH <= IR_MAX_PULSES && Gree::RAW_LENGTH <= IR_MAX_PULSES
+              && Midea::RAW_LENGTH <= IR_MAX_PULSES && LG::RAW_LENGTH <= IR_MAX_PULSES,
+              "quadro maior que IR_MAX_PULSES");
+
+// Codificadores sem estado, um por protocolo
+static const CoolixEncoder COOLIX_ENCODER;
+static const GreeEncoder GREE_ENCODER;
+static const MideaEncoder MIDEA_ENCODER;
+static const LGEncoder LG_ENCODER;
+static const IRLibraryEncoder LEARNED_ENCODER(irLibrary);
+
+// Só o codificador de AC_IR_PROTOCOL é referenciado (todos com
+// AC_IR_ALL_PROTOCOLS); os demais nem chegam ao ligador
+template <IRProtocol P>
+constexpr bool linked() {
+    return AC_IR_ALL_PROTOCOLS || P == irProtocolFromName(AC_IR_PROTOCOL);
+}
+
+const IREncoder* irEncoderFor(IRProtocol protocol) {
+    switch (protocol) {
+        case IRProtocol::COOLIX:
+            if constexpr (linked<IRProtocol::COOLIX>()) return &COOLIX_ENCODER;
+            break;
+        case IRProtocol::GREE:
+            if constexpr (linked<IRProtocol::GREE>()) return &GREE_ENCODER;
+            break;
+        case IRProtocol::MIDEA:
+            if constexpr (linked<IRProtocol::MIDEA>()) return &MIDEA_ENCODER;
+            break;
+        case IRProtocol::LG:
+            if constexpr (linked<IRProtocol::LG>()) return &LG_ENCODER;
+            break;
+        case IRProtocol::LEARNED:
+            if constexpr (linked<IRProtocol::LEARNED>()) return &LEARNED_ENCODER;
+            break;
+        case IRProtocol::NEC:
+            break;
+    }
+    return nullptr;
+}
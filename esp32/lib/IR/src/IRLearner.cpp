@@ -0,0 +1,194 @@
+#include "IRLearner.h"
+
+static const size_t ITEMS_PER_BLOCK = 64;
+
+IRLearner::IRLearner(uint8_t pin, IRLibrary& library, rmt_channel_t channel, uint8_t memBlocks)
+    : _pin(pin),
+      _channel(channel),
+      _memBlocks(memBlocks),
+      _library(library),
+      _ring(nullptr),
+      _installed(false),
+      _state(IRLearnState::IDLE),
+      _reportDue(false),
+      _settings{},
+      _hasKey(false),
+      _deadline(0),
+      _eraseNext(0),
+      _info{} {
+}
+
+IRLearner::~IRLearner() {
+    if (_installed) {
+        rmt_driver_uninstall(_channel);
+    }
+}
+
+bool IRLearner::begin() {
+    rmt_config_t config = RMT_DEFAULT_CONFIG_RX(gpio_num_t(_pin), _channel);
+    config.clk_div = 80;                            // 1 tick = 1 µs
+    config.mem_block_num = _memBlocks;
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = 100;     // ignora glitches < 1,25 µs
+    config.rx_config.idle_threshold = IDLE_THRESHOLD_US;
+
+    // Um begin() repetido reinstala o driver do canal
+    rmt_driver_uninstall(_channel);
+    _installed = rmt_config(&config) == ESP_OK
+        && rmt_driver_install(_channel, 1024, 0) == ESP_OK
+        && rmt_get_ringbuf_handle(_channel, &_ring) == ESP_OK;
+    if (!_installed) {
+        Serial.println("Falha ao iniciar o RMT do receptor IR");
+    }
+    _state = IRLearnState::IDLE;
+    return _installed && _library.ready();
+}
+
+void IRLearner::learn(const ACSettings& settings, uint32_t timeoutMs) {
+    _reportDue = true;
+    if (_state == IRLearnState::ERASING) return;
+    _settings = settings;
+    _hasKey = true;
+    _info = IRCode::Info{};
+    if (!_installed || !_library.ready()) {
+        _state = IRLearnState::UNAVAILABLE;
+        return;
+    }
+    _deadline = millis() + timeoutMs;
+    _state = IRLearnState::WAITING;
+    startCapture();
+}
+
+void IRLearner::erase() {
+    _reportDue = true;
+    _hasKey = false;
+    _info = IRCode::Info{};
+    if (!_library.ready()) {
+        _state = IRLearnState::UNAVAILABLE;
+        return;
+    }
+    stopCapture();
+    // Nada mais é lido da partição a partir daqui
+    _library.clear();
+    _eraseNext = 0;
+    _state = IRLearnState::ERASING;
+}
+
+void IRLearner::poll() {
+    if (_state == IRLearnState::ERASING) {
+        if (!_library.eraseSector(_eraseNext)) {
+            finish(IRLearnState::FLASH);
+            return;
+        }
+        if (++_eraseNext == _library.sectors()) {
+            Serial.println("Biblioteca IR apagada");
+            finish(IRLearnState::ERASED);
+        }
+        return;
+    }
+    if (_state != IRLearnState::WAITING) return;
+
+    size_t size = 0;
+    rmt_item32_t* items = static_cast<rmt_item32_t*>(xRingbufferReceive(_ring, &size, 0));
+    if (items) {
+        bool done = capture(items, size / sizeof(rmt_item32_t));
+        vRingbufferReturnItem(_ring, items);
+        if (done) return;
+        // Ruído: o receptor continua armado
+        startCapture();
+    }
+    if (long(millis() - _deadline) >= 0) {
+        finish(IRLearnState::TIMEOUT);
+    }
+}
+
+// false para um quadro curto demais (ruído, reflexo): segue esperando
+bool IRLearner::capture(const rmt_item32_t* items, size_t count) {
+    // Memória do canal cheia: o fim do quadro se perdeu
+    if (count >= size_t(_memBlocks) * ITEMS_PER_BLOCK) {
+        finish(IRLearnState::TOO_LONG);
+        return true;
+    }
+
+    // Saída ativa em baixo: nível 0 é marca. Duração zero encerra o quadro.
+    IRPulseWriter writer(_durations, IR_MAX_PULSES);
+    auto append = [&writer](uint32_t level, uint32_t duration) {
+        if (level) {
+            writer.space(uint16_t(duration));
+        } else {
+            writer.mark(uint16_t(duration));
+        }
+    };
+    for (size_t i = 0; i < count; i++) {
+        if (!items[i].duration0) break;
+        append(items[i].level0, items[i].duration0);
+        if (!items[i].duration1) break;
+        append(items[i].level1, items[i].duration1);
+    }
+    // length() 0 com muitos itens: não coube em IR_MAX_PULSES
+    if (!writer.length() && count > IR_MAX_PULSES / 2) {
+        finish(IRLearnState::TOO_LONG);
+        return true;
+    }
+
+    IRCode::Result result = IRCode::compress(_durations, writer.length(), _code, sizeof(_code), _info);
+    switch (result) {
+        case IRCode::Result::SHORT:
+            return false;
+        case IRCode::Result::TOO_LONG:
+            finish(IRLearnState::TOO_LONG);
+            return true;
+        case IRCode::Result::IRREGULAR:
+            finish(IRLearnState::IRREGULAR);
+            return true;
+        case IRCode::Result::OK:
+            break;
+    }
+
+    switch (_library.store(IRLibrary::keyOf(_settings), _code, _info.bytes, _info.durations)) {
+        case IRLibrary::StoreResult::OK:
+            Serial.printf("Código IR aprendido: %u durações em %u bytes\n", _info.durations, _info.bytes);
+            finish(IRLearnState::STORED);
+            break;
+        case IRLibrary::StoreResult::FULL:
+            finish(IRLearnState::FULL);
+            break;
+        case IRLibrary::StoreResult::FLASH:
+        case IRLibrary::StoreResult::INVALID:
+            finish(IRLearnState::FLASH);
+            break;
+    }
+    return true;
+}
+
+void IRLearner::startCapture() {
+    // Sobras de uma captura anterior não podem virar esta tecla
+    size_t size = 0;
+    while (void* stale = xRingbufferReceive(_ring, &size, 0)) {
+        vRingbufferReturnItem(_ring, stale);
+    }
+    rmt_rx_start(_channel, true);
+}
+
+void IRLearner::stopCapture() {
+    if (_installed) rmt_rx_stop(_channel);
+}
+
+void IRLearner::finish(IRLearnState state) {
+    stopCapture();
+    _state = state;
+    _reportDue = true;
+}
+
+IRLearnReport IRLearner::report() const {
+    IRLearnReport report{};
+    report.state = _state;
+    report.hasKey = _hasKey;
+    report.settings = _settings;
+    report.durations = _info.durations;
+    report.bytes = _state == IRLearnState::STORED ? _info.bytes : 0;
+    report.tickUs = _info.tickUs;
+    report.codes = _library.codes();
+    report.freeBytes = uint32_t(_library.capacity() - _library.used());
+    return report;
+}
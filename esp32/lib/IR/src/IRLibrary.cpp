@@ -0,0 +1,136 @@
+#include "IRLibrary.h"
+#include <string.h>
+#include "config.h"
+
+// O índice guarda deslocamento / 4 em 16 bits: 256 KB de log no máximo
+static const size_t MAX_LOG_BYTES = size_t(UINT16_MAX) * 4;
+
+IRLibrary irLibrary;
+
+static size_t padded(size_t length) {
+    return (length + 3) & ~size_t(3);
+}
+
+// Código de um registro como IRCode::Reader: deslocamentos relativos ao
+// início do código
+struct CodeWindow {
+    const esp_partition_t* partition;
+    size_t base;
+};
+
+static bool readCode(void* context, size_t offset, void* destination, size_t size) {
+    const CodeWindow* window = static_cast<const CodeWindow*>(context);
+    return esp_partition_read(window->partition, window->base + offset, destination, size) == ESP_OK;
+}
+
+uint16_t IRLibrary::keyOf(const ACSettings& settings) {
+    if (!settings.isOn) return 0;
+    uint8_t temp = settings.targetTemp < MIN_TEMP ? MIN_TEMP : settings.targetTemp > MAX_TEMP ? MAX_TEMP : settings.targetTemp;
+    size_t mode = size_t(settings.mode) < AC_MODE_COUNT ? size_t(settings.mode) : 0;
+    size_t fan = size_t(settings.fanSpeed) < FAN_SPEED_COUNT ? size_t(settings.fanSpeed) : 0;
+    return uint16_t(1 + (mode * (MAX_TEMP - MIN_TEMP + 1) + (temp - MIN_TEMP)) * FAN_SPEED_COUNT + fan);
+}
+
+IRLibrary::IRLibrary()
+    : _partition(nullptr),
+      _index{},
+      _codes(0),
+      _end(0) {
+}
+
+bool IRLibrary::begin(const char* label) {
+    clear();
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!_partition) return false;
+
+    // Percorre o log até o primeiro cabeçalho apagado
+    size_t limit = capacity() < MAX_LOG_BYTES ? capacity() : MAX_LOG_BYTES;
+    size_t offset = 0;
+    while (offset + RECORD_HEADER_BYTES <= limit) {
+        uint8_t header[RECORD_HEADER_BYTES];
+        if (esp_partition_read(_partition, offset, header, sizeof(header)) != ESP_OK) break;
+        uint16_t magic = uint16_t(header[0] | header[1] << 8);
+        uint16_t key = uint16_t(header[2] | header[3] << 8);
+        uint16_t length = uint16_t(header[4] | header[5] << 8);
+        if (length == 0xFFFF) break;
+        size_t next = offset + RECORD_HEADER_BYTES + padded(length);
+        if (next > limit) break;
+        // Sem o mágico o registro foi cortado no meio: fica para trás
+        if (magic == MAGIC && key < KEYS) {
+            if (!_index[key].load(std::memory_order_relaxed)) _codes++;
+            _index[key].store(uint16_t(offset / 4 + 1), std::memory_order_release);
+        }
+        offset = next;
+    }
+    _end = offset;
+    return true;
+}
+
+IRLibrary::StoreResult IRLibrary::store(uint16_t key, const uint8_t* code, size_t length, uint16_t durations) {
+    if (!_partition) return StoreResult::FLASH;
+    if (key >= KEYS || !code || length == 0 || length > IRCode::MAX_BYTES) return StoreResult::INVALID;
+    size_t limit = capacity() < MAX_LOG_BYTES ? capacity() : MAX_LOG_BYTES;
+    size_t recordBytes = RECORD_HEADER_BYTES + padded(length);
+    if (_end + recordBytes > limit) return StoreResult::FULL;
+
+    // Tudo menos o mágico; ele por último confirma o registro
+    uint8_t record[RECORD_HEADER_BYTES + IRCode::MAX_BYTES + 3];
+    memset(record, 0xFF, recordBytes);
+    record[2] = uint8_t(key);
+    record[3] = uint8_t(key >> 8);
+    record[4] = uint8_t(length);
+    record[5] = uint8_t(length >> 8);
+    record[6] = uint8_t(durations);
+    record[7] = uint8_t(durations >> 8);
+    memcpy(record + RECORD_HEADER_BYTES, code, length);
+    const uint8_t magic[2] = {uint8_t(MAGIC), uint8_t(MAGIC >> 8)};
+    size_t offset = _end;
+    // Mesmo falhando, o espaço tocado não é reaproveitado
+    _end += recordBytes;
+    if (esp_partition_write(_partition, offset + 2, record + 2, recordBytes - 2) != ESP_OK
+        || esp_partition_write(_partition, offset, magic, sizeof(magic)) != ESP_OK) {
+        return StoreResult::FLASH;
+    }
+
+    if (!_index[key].load(std::memory_order_relaxed)) _codes++;
+    _index[key].store(uint16_t(offset / 4 + 1), std::memory_order_release);
+    return StoreResult::OK;
+}
+
+uint16_t IRLibrary::expand(uint16_t key, uint16_t* durations, uint16_t capacity) const {
+    if (key >= KEYS || !_partition) return 0;
+    uint16_t entry = _index[key].load(std::memory_order_acquire);
+    if (!entry) return 0;
+    size_t offset = size_t(entry - 1) * 4;
+    uint8_t header[RECORD_HEADER_BYTES];
+    if (esp_partition_read(_partition, offset, header, sizeof(header)) != ESP_OK) return 0;
+    uint16_t magic = uint16_t(header[0] | header[1] << 8);
+    uint16_t stored = uint16_t(header[2] | header[3] << 8);
+    uint16_t length = uint16_t(header[4] | header[5] << 8);
+    // Setor já apagado (0xFF) ou reescrito: não é mais o registro da chave
+    if (magic != MAGIC || stored != key || length > IRCode::MAX_BYTES) return 0;
+    CodeWindow window{_partition, offset + RECORD_HEADER_BYTES};
+    uint16_t count = IRCode::expand(readCode, &window, length, durations, capacity);
+    // Um clear() durante a leitura invalida o que foi lido
+    return _index[key].load(std::memory_order_acquire) == entry ? count : 0;
+}
+
+// Entrada por entrada: expand() vê cada uma inteira, válida ou zerada
+void IRLibrary::clear() {
+    for (std::atomic<uint16_t>& entry : _index) entry.store(0, std::memory_order_release);
+    _codes = 0;
+    _end = 0;
+}
+
+bool IRLibrary::eraseSector(uint16_t sector) {
+    if (!_partition || sector >= sectors()) return false;
+    return esp_partition_erase_range(_partition, size_t(sector) * SPI_FLASH_SEC_SIZE, SPI_FLASH_SEC_SIZE) == ESP_OK;
+}
+
+uint8_t IRLibraryEncoder::carrierKhz() const {
+    return IR_LEARNED_KHZ;
+}
+
+uint16_t IRLibraryEncoder::encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const {
+    return _library.expand(IRLibrary::keyOf(settings), durations, capacity);
+}
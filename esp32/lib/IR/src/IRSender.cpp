@@ -1,25 +1,175 @@
 #include "IRSender.h"
+#include "Metrics.h"
 
-IRSender::IRSender(uint8_t pin) : _pin(pin), _irsend(pin) {
+// Tick do RMT: APB de 80 MHz / 80 = 1 µs, durações direto em µs
+static const uint8_t RMT_CLK_DIV = 80;
+static const uint32_t RMT_APB_HZ = 80000000;
+static const uint16_t RMT_MAX_DURATION = 32767;
+static const uint8_t CARRIER_DUTY_PERCENT = 33;
+
+// Temporizações NEC (as mesmas do IRremote 2.6)
+static constexpr IRTimings NEC_TIMINGS = {9000, 4500, 560, 1690, 560, 0, 38};
+static const uint8_t NEC_BITS = 32;
+
+static rmt_item32_t pulse(uint16_t mark, uint16_t space) {
+    rmt_item32_t item;
+    item.level0 = 1;
+    item.duration0 = mark;
+    item.level1 = 0;
+    item.duration1 = space;
+    return item;
+}
+
+IRSender::IRSender(uint8_t pin, rmt_channel_t channel)
+    : _pin(pin),
+      _channel(channel),
+      _installed(false),
+      _head(0),
+      _queued(0),
+      _queuedMask(0),
+      _rawLength(0),
+      _rawKhz(38),
+      _carrierKhz(38),
+      _busy(false),
+      _sentAny(false),
+      _txStartUs(0),
+      _nextFrameAt(0),
+      _framesSent(0),
+      _framesCoalesced(0) {
+}
+
+IRSender::~IRSender() {
+    if (_installed) {
+        rmt_driver_uninstall(_channel);
+    }
 }
 
 void IRSender::begin() {
-    // IRsend is initialized in constructor
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX(gpio_num_t(_pin), _channel);
+    config.clk_div = RMT_CLK_DIV;
+    config.mem_block_num = 2;       // 128 itens: um quadro Coolix inteiro sem recarga
+    config.tx_config.carrier_en = true;
+    config.tx_config.carrier_freq_hz = uint32_t(_carrierKhz) * 1000;
+    config.tx_config.carrier_duty_percent = CARRIER_DUTY_PERCENT;
+    config.tx_config.carrier_level = RMT_CARRIER_LEVEL_HIGH;
+    config.tx_config.idle_output_en = true;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+
+    // Um begin() repetido reinstala o driver do canal
+    rmt_driver_uninstall(_channel);
+    _installed = rmt_config(&config) == ESP_OK && rmt_driver_install(_channel, 0, 0) == ESP_OK;
+    if (!_installed) {
+        Serial.println("Falha ao iniciar o RMT do IR");
+    }
 }
 
-void IRSender::sendNECCommand(uint16_t address, uint16_t command) {
+void IRSender::sendNECCommand(uint16_t address, uint16_t command, IRSlot slot) {
     // Combinando endereço e comando em um único código NEC de 32 bits
     // Formato NEC: address(16 bits) + command(16 bits)
-    uint32_t code = ((uint32_t)address << 16) | command;
-    
-    // Envia o código usando o protocolo NEC
-    _irsend.sendNEC(code, 32); // 32 bits
-    
-    delay(100); // Pequeno delay entre comandos
+    enqueue(slot, Frame{Encoding::NEC, (uint32_t)address << 16 | command, nullptr, ACSettings{}});
+}
+
+void IRSender::sendState(const IREncoder& encoder, const ACSettings& settings) {
+    enqueue(IRSlot::STATE, Frame{Encoding::STATE, 0, &encoder, settings});
 }
 
 void IRSender::sendRaw(const uint16_t buf[], uint16_t len, uint16_t hz) {
-    // Envia dados raw na frequência especificada
-    _irsend.sendRaw(buf, len, hz);
-    delay(100);
-}
\ No newline at end of file
+    // Só existe um quadro RAW na fila: o buffer pode ser reescrito enquanto
+    // o anterior está no ar porque o RMT lê de _items
+    _rawLength = len < MAX_RAW_LENGTH ? len : MAX_RAW_LENGTH;
+    memcpy(_raw, buf, _rawLength * sizeof(uint16_t));
+    _rawKhz = hz;
+    enqueue(IRSlot::RAW, Frame{Encoding::RAW, 0, nullptr, ACSettings{}});
+}
+
+void IRSender::enqueue(IRSlot slot, const Frame& frame) {
+    uint8_t index = uint8_t(slot);
+    _frames[index] = frame;
+
+    uint8_t bit = uint8_t(1u << index);
+    if (_queuedMask & bit) {
+        _framesCoalesced++;
+    } else {
+        _order[(_head + _queued) % IR_SLOT_COUNT] = index;
+        _queued++;
+        _queuedMask |= bit;
+    }
+    poll();
+}
+
+void IRSender::poll() {
+    if (_busy) {
+        if (rmt_wait_tx_done(_channel, 0) != ESP_OK) return;
+        _busy = false;
+        // Inclui o atraso até este poll(): é o que o comando de fato espera
+        Metrics::record(Metrics::Latency::IR_TRANSMIT, uint32_t(micros() - _txStartUs));
+    }
+    if (!_queued || !_installed) return;
+    // O aparelho precisa de uma pausa entre quadros, mas não antes do primeiro
+    if (_sentAny && long(micros() - _nextFrameAt) < 0) return;
+    startNext();
+}
+
+void IRSender::startNext() {
+    uint8_t index = _order[_head];
+    _head = (_head + 1) % IR_SLOT_COUNT;
+    _queued--;
+    _queuedMask &= uint8_t(~(1u << index));
+
+    const Frame& frame = _frames[index];
+    uint16_t length = 0;
+    switch (frame.encoding) {
+        case Encoding::NEC: {
+            IRPulseWriter writer(_pulses, MAX_RAW_LENGTH);
+            writer.header(NEC_TIMINGS);
+            writer.bitsMSBFirst(frame.code, NEC_BITS, NEC_TIMINGS);
+            writer.footer(NEC_TIMINGS, 0);
+            setCarrier(NEC_TIMINGS.khz);
+            length = loadItems(_pulses, writer.length());
+            break;
+        }
+        case Encoding::STATE:
+            setCarrier(frame.encoder->carrierKhz());
+            length = loadItems(_pulses, frame.encoder->encode(frame.settings, _pulses, MAX_RAW_LENGTH));
+            break;
+        case Encoding::RAW:
+            setCarrier(_rawKhz);
+            length = loadItems(_raw, _rawLength);
+            break;
+    }
+    if (!length) return;
+    uint16_t count = (length + 1) / 2;
+
+    uint32_t durationUs = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        durationUs += _items[i].duration0 + _items[i].duration1;
+    }
+
+    _txStartUs = micros();
+    if (rmt_write_items(_channel, _items, count, false) != ESP_OK) return;
+    _busy = true;
+    _sentAny = true;
+    _nextFrameAt = micros() + durationUs + FRAME_GAP_MS * 1000UL;
+    _framesSent++;
+}
+
+void IRSender::setCarrier(uint16_t khz) {
+    if (khz == _carrierKhz || khz == 0) return;
+    uint32_t period = RMT_APB_HZ / (uint32_t(khz) * 1000);
+    uint16_t high = uint16_t(period * CARRIER_DUTY_PERCENT / 100);
+    rmt_set_tx_carrier(_channel, true, high, uint16_t(period - high), RMT_CARRIER_LEVEL_HIGH);
+    _carrierKhz = khz;
+}
+
+// Pares marca/espaço em itens do RMT; número ímpar termina em espaço zero
+uint16_t IRSender::loadItems(const uint16_t* durations, uint16_t length) {
+    for (uint16_t i = 0; i < length; i += 2) {
+        uint16_t mark = durations[i] < RMT_MAX_DURATION ? durations[i] : RMT_MAX_DURATION;
+        uint16_t space = 0;
+        if (i + 1 < length) {
+            space = durations[i + 1] < RMT_MAX_DURATION ? durations[i + 1] : RMT_MAX_DURATION;
+        }
+        _items[i / 2] = pulse(mark, space);
+    }
+    return length;
+}
@@ -0,0 +1,9 @@
+#include "LG.h"
+
+uint16_t LGEncoder::encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const {
+    IRPulseWriter writer(durations, capacity);
+    writer.header(LG::TIMINGS);
+    writer.bitsMSBFirst(LG::stateCode(settings), LG::BITS, LG::TIMINGS);
+    writer.footer(LG::TIMINGS, 0);
+    return writer.length();
+}
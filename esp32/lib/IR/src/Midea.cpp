@@ -0,0 +1,14 @@
+#include "Midea.h"
+
+uint16_t MideaEncoder::encode(const ACSettings& settings, uint16_t* durations, uint16_t capacity) const {
+    // O quadro e depois o seu complemento, para o receptor validar
+    uint64_t code = Midea::stateCode(settings);
+    IRPulseWriter writer(durations, capacity);
+    writer.header(Midea::TIMINGS);
+    writer.bitsMSBFirst(code, Midea::BITS, Midea::TIMINGS);
+    writer.footer(Midea::TIMINGS, Midea::TIMINGS.gap);
+    writer.header(Midea::TIMINGS);
+    writer.bitsMSBFirst(~code & Midea::MASK, Midea::BITS, Midea::TIMINGS);
+    writer.footer(Midea::TIMINGS, 0);
+    return writer.length();
+}
@@ -0,0 +1,67 @@
+#ifndef HEAP_GUARD_H
+#define HEAP_GUARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+
+// Modo sem heap: depois de arm(), no fim do setup(), um malloc/calloc/
+// realloc/new feito por uma tarefa do firmware (enroll) para o ESP32 com
+// abort(), e o backtrace do painel aponta quem alocou. Todo buffer do
+// núcleo tem tamanho de compilação (MemoryBudget.h); uma alocação depois do
+// boot é um bug, não um caso a tratar.
+//
+// No ESP32 os ganchos são os -Wl,--wrap do env esp32dev_heap_guard; no host
+// é o HostAlloc, com as mesmas regras (malloc/calloc/realloc só com a
+// glibc; no macOS o guarda vê apenas new e String). As tarefas do ESP-IDF (WiFi, lwIP,
+// timers) não são do firmware e alocam à vontade. Dentro das nossas, as
+// chamadas às bibliotecas do fabricante que alocam por conta própria
+// (WiFiClient ao conectar e no primeiro read, Preferences/NVS, WiFi.begin)
+// ficam num escopo Vendor: a alocação é delas, limitada aos eventos de
+// conexão e de gravação, e não cresce com o tempo de operação.
+//
+// Com HEAP_GUARD_ENABLED 0 tudo aqui é vazio e inline.
+namespace HeapGuard {
+
+// Tarefas do firmware que o guarda acompanha
+constexpr size_t MAX_TASKS = 4;
+
+#if HEAP_GUARD_ENABLED
+// Inclui a tarefa; chamar no setup(), antes de arm()
+bool enroll(TaskHandle_t task);
+void arm();
+// Só para testes: desarma e esquece as tarefas
+void disarm();
+bool armed();
+// Chamado pelos ganchos de alocação: aborta se a alocação é proibida
+void check(size_t size);
+
+// Escopo de uma chamada ao fabricante que aloca sozinha
+class Vendor {
+public:
+    Vendor();
+    ~Vendor();
+    Vendor(const Vendor&) = delete;
+    Vendor& operator=(const Vendor&) = delete;
+
+private:
+    uint8_t* _depth;
+};
+#else
+inline bool enroll(TaskHandle_t) { return true; }
+inline void arm() {}
+inline void disarm() {}
+inline bool armed() { return false; }
+inline void check(size_t) {}
+
+class Vendor {
+public:
+    Vendor() {}
+};
+#endif
+
+} // namespace HeapGuard
+
+#endif // HEAP_GUARD_H
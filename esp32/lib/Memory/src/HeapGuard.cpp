@@ -0,0 +1,124 @@
+#include "HeapGuard.h"
+
+#if HEAP_GUARD_ENABLED
+
+#include <atomic>
+#include <stdlib.h>
+
+#ifdef NATIVE_HOST
+#include <stdio.h>
+#include "HostAlloc.h"
+#else
+#include <rom/ets_sys.h>
+#endif
+
+namespace HeapGuard {
+
+namespace {
+
+// Só o setup() inclui tarefas, e elas já podem estar rodando: a entrada é
+// escrita antes de a contagem publicá-la. Cada tarefa só mexe na própria
+// profundidade.
+struct Task {
+    TaskHandle_t handle;
+    uint8_t vendorDepth;
+};
+
+Task g_tasks[MAX_TASKS];
+std::atomic<size_t> g_taskCount{0};
+std::atomic<bool> g_armed{false};
+
+Task* current() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    size_t count = g_taskCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        if (g_tasks[i].handle == self) return &g_tasks[i];
+    }
+    return nullptr;
+}
+
+// Sem Serial: imprimir pode alocar, e o heap é justamente o suspeito
+[[noreturn]] void fault(size_t size) {
+#ifdef NATIVE_HOST
+    fprintf(stderr, "HeapGuard: %u bytes alocados por uma tarefa do firmware depois do setup()\n",
+            unsigned(size));
+#else
+    ets_printf("HeapGuard: %u bytes alocados pela tarefa %s depois do setup()\n",
+               unsigned(size), pcTaskGetTaskName(nullptr));
+#endif
+    abort();
+}
+
+}  // namespace
+
+bool enroll(TaskHandle_t task) {
+    size_t count = g_taskCount.load(std::memory_order_relaxed);
+    if (count == MAX_TASKS) return false;
+    g_tasks[count] = Task{task, 0};
+    g_taskCount.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+void arm() {
+#ifdef NATIVE_HOST
+    HostAlloc::setHook(check);
+#endif
+    g_armed.store(true, std::memory_order_release);
+}
+
+void disarm() {
+    g_armed.store(false, std::memory_order_release);
+#ifdef NATIVE_HOST
+    HostAlloc::setHook(nullptr);
+#endif
+    g_taskCount.store(0, std::memory_order_release);
+}
+
+bool armed() {
+    return g_armed.load(std::memory_order_acquire);
+}
+
+void check(size_t size) {
+    if (!g_armed.load(std::memory_order_acquire)) return;
+    Task* task = current();
+    if (task && task->vendorDepth == 0) fault(size);
+}
+
+Vendor::Vendor() {
+    Task* task = current();
+    _depth = task ? &task->vendorDepth : nullptr;
+    if (_depth) ++*_depth;
+}
+
+Vendor::~Vendor() {
+    if (_depth) --*_depth;
+}
+
+} // namespace HeapGuard
+
+#ifndef NATIVE_HOST
+// Ganchos do linker (-Wl,--wrap=malloc,...): o operator new do libstdc++ e a
+// String do Arduino também passam por malloc/realloc. free não é vigiado.
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    HeapGuard::check(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    HeapGuard::check(count * size);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    if (size) HeapGuard::check(size);
+    return __real_realloc(ptr, size);
+}
+}
+#endif
+
+#endif // HEAP_GUARD_ENABLED
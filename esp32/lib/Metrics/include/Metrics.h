@@ -0,0 +1,113 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Instrumentação dos caminhos quentes do firmware.
+// Cada latência vai para um histograma de baldes fixos (4 por oitava, então
+// o percentil sai com erro de no máximo 25%) e cada evento para um
+// contador; tudo em std::atomic de 32 bits com ordem relaxada, e qualquer
+// tarefa registra sem trava e sem heap. O snapshot de diagnóstico lê e zera
+// a janela das latências; os contadores só crescem desde o boot.
+namespace Metrics {
+
+enum class Latency : uint8_t {
+    NETWORK_LOOP,       // NetworkManager::update()
+    CONTROL_LOOP,       // ControlLoop::step()
+    COMMAND_PARSE,      // parseCommand no callback MQTT
+    COMMAND_EXECUTE,    // ACController::execute()
+    IR_TRANSMIT,        // quadro IR: início no RMT até o fim observado
+    SENSOR_READ,        // leitura do DHT22: pulso de início até o quadro
+    COUNT
+};
+
+enum class Counter : uint8_t {
+    WIFI_CONNECTS,
+    MQTT_CONNECTS,
+    CONNECT_FAILURES,   // tentativas de WiFi ou MQTT que falharam
+    CONNECTION_LOST,    // WiFi ou MQTT caiu depois de conectado
+    COMMANDS,
+    COMMANDS_REJECTED,
+    COMMAND_QUEUE_FULL,
+    PUBLISH_FAILURES,
+    SENSOR_FAILURES,
+    WATCHDOG_RESETS,    // conexão derrubada por não conseguir publicar
+    COUNT
+};
+
+constexpr size_t LATENCY_COUNT = size_t(Latency::COUNT);
+constexpr size_t COUNTER_COUNT = size_t(Counter::COUNT);
+
+// Cabe num pacote MQTT de 1024 bytes junto com o tópico
+constexpr size_t DIAGNOSTICS_JSON_CAPACITY = 960;
+
+// Latências acima disso (~8,4 s) são registradas como esse teto, o que
+// limita cada campo do snapshot a 7 dígitos
+constexpr uint32_t MAX_LATENCY_US = (1u << 23) - 1;
+
+// Baldes: 0-3 µs um a um, depois 4 por oitava até ~2 s; o último acumula o resto
+constexpr size_t BUCKETS = 80;
+
+constexpr size_t bucketIndex(uint32_t us) {
+    if (us < 4) return us;
+    int msb = 31 - __builtin_clz(us);
+    size_t index = size_t(msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+    return index < BUCKETS ? index : BUCKETS - 1;
+}
+
+// Menor valor que cai no balde
+constexpr uint32_t bucketLowerBound(size_t index) {
+    return index < 4 ? uint32_t(index) : uint32_t(4 + index % 4) << (index / 4 - 1);
+}
+
+struct LatencySnapshot {
+    uint32_t count;
+    uint32_t meanUs;
+    uint32_t p50Us;     // limite superior do balde do percentil
+    uint32_t p90Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+};
+
+struct HeapStats {
+    uint32_t free;
+    uint32_t largestBlock;
+    uint32_t minimumFree;   // menor heap livre desde o boot
+};
+
+#if METRICS_ENABLED
+void record(Latency latency, uint32_t us);
+void increment(Counter counter);
+#else
+inline void record(Latency, uint32_t) {}
+inline void increment(Counter) {}
+#endif
+
+uint32_t counter(Counter counter);
+// Lê e zera a janela do histograma
+LatencySnapshot takeSnapshot(Latency latency);
+HeapStats heap();
+void reset();
+
+const char* latencyName(Latency latency);
+const char* counterName(Counter counter);
+
+// Snapshot compacto publicado em .../diagnostico (formato em MQTT.md).
+// Zera as janelas de latência. Retorna o comprimento ou 0 se não coube.
+size_t serializeDiagnosticsJson(const char* lastError, char* buffer, size_t capacity);
+
+// Mede o escopo: Metrics::Timer timer(Metrics::Latency::COMMAND_PARSE);
+class Timer {
+public:
+    explicit Timer(Latency latency) : _latency(latency), _start(micros()) {}
+    ~Timer() { record(_latency, uint32_t(micros() - _start)); }
+
+private:
+    Latency _latency;
+    unsigned long _start;
+};
+
+} // namespace Metrics
+
+#endif // METRICS_H
@@ -0,0 +1,190 @@
+#include "Metrics.h"
+#include <atomic>
+#include "JsonWriter.h"
+
+namespace Metrics {
+
+namespace {
+
+struct Histogram {
+    std::atomic<uint32_t> buckets[BUCKETS];
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> sumUs;
+    std::atomic<uint32_t> maxUs;
+};
+
+Histogram g_histograms[LATENCY_COUNT];
+std::atomic<uint32_t> g_counters[COUNTER_COUNT];
+
+const char* const LATENCY_NAMES[] = {
+    "loopRede",
+    "loopControle",
+    "parseComando",
+    "execComando",
+    "transmissaoIR",
+    "leituraSensor",
+};
+static_assert(sizeof(LATENCY_NAMES) / sizeof(LATENCY_NAMES[0]) == LATENCY_COUNT,
+              "LATENCY_NAMES fora de sincronia com Metrics::Latency");
+
+const char* const COUNTER_NAMES[] = {
+    "conexoesWifi",
+    "conexoesMqtt",
+    "falhasConexao",
+    "quedasConexao",
+    "comandos",
+    "comandosRejeitados",
+    "filaComandosCheia",
+    "falhasPublicacao",
+    "falhasSensor",
+    "watchdog",
+};
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == COUNTER_COUNT,
+              "COUNTER_NAMES fora de sincronia com Metrics::Counter");
+
+uint32_t percentile(const uint32_t (&buckets)[BUCKETS], uint32_t count, uint32_t maxUs, uint32_t permille) {
+    // Posição do percentil arredondada para cima (p99 de 10 amostras = a 10ª)
+    uint32_t rank = uint32_t((uint64_t(count) * permille + 999) / 1000);
+    uint32_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            if (i + 1 == BUCKETS) return maxUs;
+            uint32_t upper = bucketLowerBound(i + 1) - 1;
+            return upper < maxUs ? upper : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+} // namespace
+
+#if METRICS_ENABLED
+void record(Latency latency, uint32_t us) {
+    if (us > MAX_LATENCY_US) us = MAX_LATENCY_US;
+    Histogram& h = g_histograms[size_t(latency)];
+    h.buckets[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.sumUs.fetch_add(us, std::memory_order_relaxed);
+    uint32_t max = h.maxUs.load(std::memory_order_relaxed);
+    while (us > max && !h.maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+void increment(Counter counter) {
+    g_counters[size_t(counter)].fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+uint32_t counter(Counter counter) {
+    return g_counters[size_t(counter)].load(std::memory_order_relaxed);
+}
+
+LatencySnapshot takeSnapshot(Latency latency) {
+    Histogram& h = g_histograms[size_t(latency)];
+    // Cada campo é zerado atomicamente; um registro concorrente pode cair
+    // metade nesta janela e metade na próxima, o que só desloca uma amostra
+    uint32_t buckets[BUCKETS];
+    uint32_t count = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        buckets[i] = h.buckets[i].exchange(0, std::memory_order_relaxed);
+        count += buckets[i];
+    }
+    h.count.exchange(0, std::memory_order_relaxed);
+    uint32_t sum = h.sumUs.exchange(0, std::memory_order_relaxed);
+    uint32_t max = h.maxUs.exchange(0, std::memory_order_relaxed);
+
+    LatencySnapshot snapshot{};
+    snapshot.count = count;
+    if (count) {
+        snapshot.meanUs = sum / count;
+        snapshot.p50Us = percentile(buckets, count, max, 500);
+        snapshot.p90Us = percentile(buckets, count, max, 900);
+        snapshot.p99Us = percentile(buckets, count, max, 990);
+        snapshot.maxUs = max;
+    }
+    return snapshot;
+}
+
+HeapStats heap() {
+    return HeapStats{ESP.getFreeHeap(), ESP.getMaxAllocHeap(), ESP.getMinFreeHeap()};
+}
+
+void reset() {
+    for (Histogram& h : g_histograms) {
+        for (std::atomic<uint32_t>& bucket : h.buckets) bucket.store(0, std::memory_order_relaxed);
+        h.count.store(0, std::memory_order_relaxed);
+        h.sumUs.store(0, std::memory_order_relaxed);
+        h.maxUs.store(0, std::memory_order_relaxed);
+    }
+    for (std::atomic<uint32_t>& c : g_counters) c.store(0, std::memory_order_relaxed);
+}
+
+const char* latencyName(Latency latency) {
+    return size_t(latency) < LATENCY_COUNT ? LATENCY_NAMES[size_t(latency)] : "?";
+}
+
+const char* counterName(Counter counter) {
+    return size_t(counter) < COUNTER_COUNT ? COUNTER_NAMES[size_t(counter)] : "?";
+}
+
+size_t serializeDiagnosticsJson(const char* lastError, char* buffer, size_t capacity) {
+    JsonWriter json(buffer, capacity);
+    json.beginObject();
+    json.key("uptime");
+    json.value(uint32_t(millis() / 1000));
+
+    HeapStats h = heap();
+    json.key("heap");
+    json.beginObject();
+    json.key("livre");
+    json.value(h.free);
+    json.key("maiorBloco");
+    json.value(h.largestBlock);
+    json.key("minimo");
+    json.value(h.minimumFree);
+    json.endObject();
+
+    json.key("contadores");
+    json.beginObject();
+    for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        json.key(COUNTER_NAMES[i]);
+        json.value(g_counters[i].load(std::memory_order_relaxed));
+    }
+    json.endObject();
+
+    // Só as latências com amostras na janela
+    json.key("latenciaUs");
+    json.beginObject();
+    for (size_t i = 0; i < LATENCY_COUNT; i++) {
+        LatencySnapshot s = takeSnapshot(Latency(i));
+        if (!s.count) continue;
+        json.key(LATENCY_NAMES[i]);
+        json.beginObject();
+        json.key("n");
+        json.value(s.count);
+        json.key("media");
+        json.value(s.meanUs);
+        json.key("p50");
+        json.value(s.p50Us);
+        json.key("p90");
+        json.value(s.p90Us);
+        json.key("p99");
+        json.value(s.p99Us);
+        json.key("max");
+        json.value(s.maxUs);
+        json.endObject();
+    }
+    json.endObject();
+
+    json.key("ultimoErro");
+    if (lastError) {
+        json.value(lastError);
+    } else {
+        json.null();
+    }
+    json.endObject();
+    return json.finish();
+}
+
+} // namespace Metrics
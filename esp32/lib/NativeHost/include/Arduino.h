@@ -0,0 +1,130 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Substituto mínimo do core Arduino para o build nativo (env:native).
+// Só cobre o que lib/ e src/ usam; o tempo vem de HostClock.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "WString.h"
+#include "HostClock.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+// Específico do host: duração do último período em nível baixo do pino,
+// encerrado por digitalWrite(HIGH) ou ao soltar a linha com pinMode(INPUT*),
+// que aqui sobe pelo pull-up. O DHT22 simulado confere o pulso de início.
+uint32_t hostPinLastLowUs(uint8_t pin);
+
+// Hora do SNTP (esp32-hal-time). configTime() inicia a sincronização e
+// getLocalTime() falha até ela acontecer; depois o relógio segue o
+// HostClock mesmo sem servidor, como o RTC do ESP32. A espera de
+// getLocalTime() é ignorada: o host responde na hora.
+void configTime(long gmtOffsetSeconds, int daylightOffsetSeconds, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+// Específico do host: o "servidor NTP"
+namespace HostNtp {
+    void reset();
+    // Hora UTC real neste instante do HostClock; avança com ele
+    void setEpoch(uint64_t epochSeconds);
+    // Servidor inalcançável: quem ainda não sincronizou continua sem hora
+    void setReachable(bool reachable);
+    bool synced();
+}
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// Específico do host: os sorteios vêm de 'source' (a reprodução de uma
+// gravação devolve os do dispositivo); nullptr volta ao xorshift
+namespace HostRandom {
+    typedef long (*Source)(long max, void* context);
+    void setSource(Source source, void* context);
+}
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+
+    size_t print(const char* str);
+    size_t print(const String& str) { return print(str.c_str()); }
+    size_t print(char c);
+    size_t print(int num, int base = DEC) { return print(long(num), base); }
+    size_t print(unsigned int num, int base = DEC) { return print((unsigned long)num, base); }
+    size_t print(long num, int base = DEC);
+    size_t print(unsigned long num, int base = DEC);
+    size_t print(double num, int digits = 2);
+
+    size_t println();
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    // Específico do host: ecoa a saída serial em stdout (desligado por padrão
+    // para não distorcer os benchmarks)
+    void setHostEcho(bool enabled) { _echo = enabled; }
+
+private:
+    bool _echo = false;
+};
+
+extern HardwareSerial Serial;
+
+// Heap do ESP32 (Esp.h). No host os valores são fixos, com os de uma placa
+// recém-iniciada por padrão; os testes ajustam com hostSetHeap(). restart()
+// só conta: o teste recria os objetos do firmware para simular o boot.
+class EspClass {
+public:
+    uint32_t getFreeHeap() const { return _free; }
+    uint32_t getMaxAllocHeap() const { return _largest; }
+    uint32_t getMinFreeHeap() const { return _minimum; }
+    void restart() { _restarts++; }
+    uint32_t hostRestarts() const { return _restarts; }
+
+    void hostSetHeap(uint32_t freeBytes, uint32_t largestBlock, uint32_t minimumFree) {
+        _free = freeBytes;
+        _largest = largestBlock;
+        _minimum = minimumFree;
+    }
+
+private:
+    uint32_t _free = 240000;
+    uint32_t _largest = 110000;
+    uint32_t _minimum = 230000;
+    uint32_t _restarts = 0;
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
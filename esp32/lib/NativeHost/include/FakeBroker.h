@@ -0,0 +1,108 @@
+#ifndef FAKE_BROKER_H
+#define FAKE_BROKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class PubSubClient;
+
+#ifndef FAKE_BROKER_TOPIC_SIZE
+#define FAKE_BROKER_TOPIC_SIZE 128
+#endif
+
+#ifndef FAKE_BROKER_PAYLOAD_SIZE
+#define FAKE_BROKER_PAYLOAD_SIZE 1024
+#endif
+
+#ifndef FAKE_BROKER_MAX_CLIENTS
+#define FAKE_BROKER_MAX_CLIENTS 16
+#endif
+
+#ifndef FAKE_BROKER_MAX_SUBSCRIPTIONS
+#define FAKE_BROKER_MAX_SUBSCRIPTIONS 64
+#endif
+
+#ifndef FAKE_BROKER_LOG_SIZE
+#define FAKE_BROKER_LOG_SIZE 64
+#endif
+
+struct FakeMessage {
+    char topic[FAKE_BROKER_TOPIC_SIZE];
+    uint8_t payload[FAKE_BROKER_PAYLOAD_SIZE + 1];
+    uint16_t length;
+    bool retained;
+    uint64_t timestampUs;
+
+    const char* text() const { return reinterpret_cast<const char*>(payload); }
+};
+
+// Broker MQTT em processo usado pelo PubSubClient substituto.
+// Toda a memória é estática para não interferir na contagem de alocações;
+// as publicações ficam num log circular que os testes inspecionam.
+class FakeBroker {
+public:
+    static FakeBroker& instance();
+
+    void reset();
+
+    bool isReachable() const { return _reachable; }
+    void setReachable(bool reachable);
+    // Conexão meio aberta: o cliente segue conectado mas as publicações falham
+    void setStalled(bool stalled) { _stalled = stalled; }
+
+    // Tempo virtual consumido pelo connect TCP do WiFiClient (sucesso / falha)
+    void setConnectLatency(uint32_t okMs, uint32_t failMs) {
+        _connectOkMs = okMs;
+        _connectFailMs = failMs;
+    }
+    uint32_t connectLatencyMs(bool success) const { return success ? _connectOkMs : _connectFailMs; }
+
+    bool attach(PubSubClient* client);
+    void detach(PubSubClient* client);
+    bool subscribe(PubSubClient* client, const char* filter);
+    bool unsubscribe(PubSubClient* client, const char* filter);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained);
+
+    // Publica como se viesse do servidor
+    bool inject(const char* topic, const char* payload);
+    bool inject(const char* topic, const uint8_t* payload, unsigned int length);
+
+    uint32_t publishCount() const { return _publishCount; }
+    // Mensagens entregues a inscritos (o "sent" do broker)
+    uint32_t deliveryCount() const { return _deliveryCount; }
+    const FakeMessage* lastMessage(const char* topicFilter = nullptr) const;
+    const FakeMessage* retained(const char* topic) const;
+
+    // Chamado a cada publicação (de dispositivos ou injetada)
+    typedef void (*Observer)(const FakeMessage& message, void* context);
+    void setObserver(Observer observer, void* context) {
+        _observer = observer;
+        _observerContext = context;
+    }
+
+    static bool topicMatches(const char* filter, const char* topic);
+
+private:
+    struct Subscription {
+        PubSubClient* client;
+        char filter[FAKE_BROKER_TOPIC_SIZE];
+    };
+
+    FakeBroker() { reset(); }
+
+    bool _reachable;
+    bool _stalled;
+    Observer _observer;
+    void* _observerContext;
+    uint32_t _connectOkMs;
+    uint32_t _connectFailMs;
+    PubSubClient* _clients[FAKE_BROKER_MAX_CLIENTS];
+    Subscription _subscriptions[FAKE_BROKER_MAX_SUBSCRIPTIONS];
+    FakeMessage _log[FAKE_BROKER_LOG_SIZE];
+    uint32_t _publishCount;
+    uint32_t _deliveryCount;
+    FakeMessage _retained[FAKE_BROKER_LOG_SIZE];
+    size_t _retainedCount;
+};
+
+#endif // FAKE_BROKER_H
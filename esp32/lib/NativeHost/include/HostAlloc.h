@@ -0,0 +1,30 @@
+#ifndef HOST_ALLOC_H
+#define HOST_ALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Contadores de alocação do build nativo.
+// operator new/delete globais, o buffer de String e, com a glibc,
+// malloc/calloc/realloc passam por aqui, o que permite aos testes afirmar
+// "zero alocações" em um caminho de código. Fora da glibc (macOS) o malloc
+// direto não é visto.
+struct HostAllocStats {
+    uint64_t calls;
+    uint64_t bytes;
+};
+
+namespace HostAlloc {
+    HostAllocStats stats();
+    void reset();
+
+    // realloc/free contabilizados, usados pela String do Arduino substituto
+    void* reallocate(void* ptr, size_t size);
+    void release(void* ptr);
+
+    // Chamado antes de cada alocação contada (HeapGuard); nullptr desliga
+    typedef void (*Hook)(size_t size);
+    void setHook(Hook hook);
+}
+
+#endif // HOST_ALLOC_H
@@ -0,0 +1,63 @@
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <chrono>
+#include <stdint.h>
+#include "HostAlloc.h"
+#include "HostClock.h"
+
+// Resultado de um micro-benchmark do build nativo.
+// nsPerOp é tempo real de CPU do host; blockedUsPerOp é o tempo virtual que a
+// operação mantém o firmware parado (delay(), bit-bang IR, leitura DHT...).
+struct BenchResult {
+    const char* name;
+    uint32_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+    double blockedUsPerOp;
+};
+
+namespace HostBench {
+
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+void report(const BenchResult& result);
+
+template <typename Fn>
+BenchResult run(const char* name, uint32_t iterations, Fn&& fn) {
+    uint32_t warmup = iterations / 10 < 1000 ? iterations / 10 : 1000;
+    for (uint32_t i = 0; i < warmup; i++) {
+        fn();
+    }
+
+    HostAllocStats allocBefore = HostAlloc::stats();
+    uint64_t virtualBefore = HostClock::nowMicros();
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        fn();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    uint64_t virtualAfter = HostClock::nowMicros();
+    HostAllocStats allocAfter = HostAlloc::stats();
+
+    double n = iterations ? double(iterations) : 1.0;
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = std::chrono::duration<double, std::nano>(end - start).count() / n;
+    result.allocsPerOp = double(allocAfter.calls - allocBefore.calls) / n;
+    result.bytesPerOp = double(allocAfter.bytes - allocBefore.bytes) / n;
+    result.blockedUsPerOp = double(virtualAfter - virtualBefore) / n;
+    report(result);
+    return result;
+}
+
+} // namespace HostBench
+
+#endif // HOST_BENCH_H
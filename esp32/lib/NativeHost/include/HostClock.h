@@ -0,0 +1,17 @@
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <stdint.h>
+
+// Relógio virtual do build nativo.
+// millis()/micros() leem este relógio e delay() apenas o avança, de modo que
+// testes e benchmarks rodam sem esperar e o tempo "bloqueado" do firmware
+// pode ser medido separadamente do tempo de CPU.
+namespace HostClock {
+    uint64_t nowMicros();
+    void advanceMicros(uint64_t us);
+    void advanceMillis(uint64_t ms);
+    void reset(uint64_t startMicros = 0);
+}
+
+#endif // HOST_CLOCK_H
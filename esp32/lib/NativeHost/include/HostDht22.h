@@ -0,0 +1,34 @@
+#ifndef HOST_DHT22_H
+#define HOST_DHT22_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/rmt.h"
+
+// DHT22 simulado do outro lado da linha de dados. Quando o RMT substituto
+// começa a receber num pino, o sensor confere o pulso de início do host
+// (nível baixo por >= 1 ms, ver hostPinLastLowUs) e devolve o quadro de
+// resposta com a leitura configurada, nas temporizações do datasheet.
+namespace HostDht22 {
+    enum class Fault : uint8_t {
+        NONE,
+        ABSENT,         // não responde
+        CHECKSUM,       // último byte trocado
+        TRUNCATED       // para no meio dos 40 bits
+    };
+
+    // Leitura padrão de todos os pinos: 24 °C / 55 %UR, sem falhas
+    void reset();
+    // NAN em qualquer grandeza = sensor desconectado
+    void setReading(uint8_t pin, float temperature, float humidity);
+    // Aplica a falha às próximas 'count' leituras do pino
+    void setFault(uint8_t pin, Fault fault, uint16_t count = 0xFFFF);
+    // Pulsos de início recebidos e quantos foram curtos demais para o sensor
+    uint32_t reads(uint8_t pin);
+    uint32_t badStarts(uint8_t pin);
+
+    // Usado pelo RMT substituto: itens da resposta e a duração dela
+    size_t respond(uint8_t pin, rmt_item32_t* items, size_t capacity, uint32_t& durationUs);
+}
+
+#endif // HOST_DHT22_H
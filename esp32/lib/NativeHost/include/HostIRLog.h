@@ -0,0 +1,39 @@
+#ifndef HOST_IR_LOG_H
+#define HOST_IR_LOG_H
+
+#include <stdint.h>
+
+#ifndef HOST_IR_LOG_SIZE
+#define HOST_IR_LOG_SIZE 64
+#endif
+
+enum class HostIRProtocol : uint8_t {
+    NEC,
+    RAW
+};
+
+struct HostIRFrame {
+    uint64_t timestampUs;   // início da transmissão (relógio virtual)
+    uint32_t durationUs;    // tempo no ar
+    uint32_t data;          // código NEC, ou 0 para RAW
+    uint16_t bits;          // bits NEC, ou número de durações RAW
+    uint16_t khz;
+    uint8_t pin;
+    HostIRProtocol protocol;
+};
+
+// Log circular de todos os quadros "transmitidos" pelo RMT substituto.
+// Quadros com a forma de onda NEC são decodificados; os demais ficam RAW.
+namespace HostIRLog {
+    void reset();
+    uint32_t count();
+    const HostIRFrame* at(uint32_t index);  // nullptr se já sobrescrito
+    const HostIRFrame* last();
+    void record(const HostIRFrame& frame);
+    // Durações (marca, espaço...) em µs do último quadro, guardadas pelo
+    // RMT substituto; 0 sem nenhum
+    void recordPulses(const uint16_t* durations, uint16_t count);
+    uint16_t lastPulses(const uint16_t*& durations);
+}
+
+#endif // HOST_IR_LOG_H
@@ -0,0 +1,50 @@
+#ifndef HOST_MQTT_WIRE_H
+#define HOST_MQTT_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pacotes MQTT 3.1.1 (só QoS 0) para o PubSubClient substituto falar com um
+// broker de verdade, como o Mosquitto de mosquitto/, quando o host usa a
+// rede real (WiFi.hostUseRealNetwork). Sem heap: tudo vai para o buffer do
+// chamador, e cada função retorna 0 se ele não couber.
+namespace HostMqttWire {
+    enum PacketType : uint8_t {
+        CONNECT = 1,
+        CONNACK = 2,
+        PUBLISH = 3,
+        SUBSCRIBE = 8,
+        SUBACK = 9,
+        UNSUBSCRIBE = 10,
+        UNSUBACK = 11,
+        PINGREQ = 12,
+        PINGRESP = 13,
+        DISCONNECT = 14
+    };
+
+    // Cabeçalho fixo: tipo + flags e o comprimento restante (1 a 4 bytes)
+    const size_t MAX_HEADER_BYTES = 5;
+
+    size_t encodeLength(uint32_t length, uint8_t* out);
+    // Bytes do comprimento lidos; 0 se ainda faltam bytes, -1 se inválido
+    int decodeLength(const uint8_t* in, size_t available, uint32_t& length);
+
+    size_t connectPacket(uint8_t* out, size_t capacity, const char* clientId,
+                         const char* user, const char* password, uint16_t keepAlive);
+    size_t publishPacket(uint8_t* out, size_t capacity, const char* topic,
+                         const uint8_t* payload, size_t length, bool retained);
+    size_t subscribePacket(uint8_t* out, size_t capacity, uint16_t packetId,
+                           const char* filter);
+    size_t unsubscribePacket(uint8_t* out, size_t capacity, uint16_t packetId,
+                             const char* filter);
+    // PINGREQ e DISCONNECT (sem corpo)
+    size_t emptyPacket(uint8_t* out, PacketType type);
+
+    // Separa um PUBLISH recebido; tópico e payload apontam para 'body'
+    // (o pacote sem o cabeçalho fixo). false se malformado.
+    bool parsePublish(uint8_t flags, const uint8_t* body, size_t length,
+                      const char*& topic, size_t& topicLength,
+                      const uint8_t*& payload, size_t& payloadLength);
+}
+
+#endif // HOST_MQTT_WIRE_H
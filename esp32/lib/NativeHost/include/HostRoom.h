@@ -0,0 +1,17 @@
+#ifndef HOST_ROOM_H
+#define HOST_ROOM_H
+
+// Sala simulada de primeira ordem para fechar a malha do termostato no
+// host: troca calor com o lado de fora pela constante de tempo e, com o
+// compressor ligado, perde uma taxa fixa. Sem aleatoriedade: os mesmos
+// passos dão sempre a mesma curva.
+struct HostRoom {
+    float temperature;          // °C
+    float outdoor;              // °C
+    float tauSeconds;           // constante de tempo das paredes
+    float coolingPerSecond;     // °C/s retirados pelo compressor
+
+    void step(float seconds, bool cooling);
+};
+
+#endif // HOST_ROOM_H
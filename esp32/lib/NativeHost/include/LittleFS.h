@@ -0,0 +1,76 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+// Substituto do LittleFS do core ESP32 para o build nativo.
+// Os arquivos vivem em memória estática e sobrevivem a novas instâncias dos
+// objetos do firmware (um "reboot" no teste); HostFlash::reset() apaga tudo.
+// Só cobre o que lib/ usa: abrir, ler, escrever, posicionar, renomear e
+// remover.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef HOST_FS_MAX_FILES
+#define HOST_FS_MAX_FILES 4
+#endif
+
+#ifndef HOST_FS_FILE_SIZE
+#define HOST_FS_FILE_SIZE (64 * 1024)
+#endif
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+struct HostFileEntry;
+
+class File {
+public:
+    File() : _entry(nullptr), _position(0), _writable(false) {}
+    File(HostFileEntry* entry, size_t position, bool writable)
+        : _entry(entry), _position(position), _writable(writable) {}
+
+    explicit operator bool() const { return _entry != nullptr; }
+    size_t read(uint8_t* buffer, size_t size);
+    size_t write(const uint8_t* buffer, size_t size);
+    bool seek(uint32_t position);
+    size_t position() const { return _position; }
+    size_t size() const;
+    void flush() {}
+    void close() { _entry = nullptr; }
+
+private:
+    HostFileEntry* _entry;
+    size_t _position;
+    bool _writable;
+};
+
+class LittleFSFS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+               uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+    void end() {}
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+};
+
+} // namespace fs
+
+using fs::File;
+
+extern fs::LittleFSFS LittleFS;
+
+// Específico do host: estado e desgaste da "flash"
+namespace HostFlash {
+    void reset();
+    // Falha o próximo begin() (partição ausente/corrompida sem formatar)
+    void setMountFailure(bool fail);
+    uint64_t bytesWritten();
+    uint32_t writeCalls();
+}
+
+#endif // HOST_LITTLEFS_H
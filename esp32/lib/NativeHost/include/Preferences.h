@@ -0,0 +1,67 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+// Substituto da biblioteca Preferences (NVS) do core ESP32 para o build
+// nativo. Como no LittleFS do host, os valores vivem em memória estática e
+// sobrevivem a um "reboot" no teste; HostNvs::reset() apaga tudo.
+// Só cobre blobs e inteiros de 64 bits, que é o que lib/ grava.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef HOST_NVS_MAX_ENTRIES
+#define HOST_NVS_MAX_ENTRIES 16
+#endif
+
+#ifndef HOST_NVS_BLOB_SIZE
+#define HOST_NVS_BLOB_SIZE 1024
+#endif
+
+// Partição nvs do default.csv: 0x5000 bytes
+#ifndef HOST_NVS_PAGES
+#define HOST_NVS_PAGES 5
+#endif
+
+class Preferences {
+public:
+    Preferences() : _open(false), _readOnly(false) { _namespace[0] = '\0'; }
+    ~Preferences() { end(); }
+
+    // Nomes de namespace e chave têm no máximo 15 caracteres, como na NVS
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end() { _open = false; }
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t putULong64(const char* key, uint64_t value);
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0);
+    bool isKey(const char* key);
+    bool remove(const char* key);
+    bool clear();
+
+private:
+    char _namespace[16];
+    bool _open;
+    bool _readOnly;
+};
+
+// Específico do host: estado e desgaste da "NVS"
+//
+// A flash segue o formato da NVS do ESP-IDF: páginas de 4 KB com 126
+// entradas de 32 bytes, gravadas em sequência. Um inteiro ocupa uma
+// entrada; um blob, duas de cabeçalho mais os dados. Regravar uma chave
+// grava entradas novas no fim da página ativa e só marca as antigas como
+// apagadas. Cheia a página, a escrita segue na seguinte, em rodízio; a
+// página depois dela é apagada antes, com as entradas ainda vivas
+// copiadas para a frente (a página reserva da NVS).
+namespace HostNvs {
+    void reset();
+    uint32_t writeCalls();
+    uint64_t bytesWritten();            // dados pedidos por putBytes/putULong64
+    uint64_t flashBytesWritten();       // entradas gravadas na flash, com as cópias
+    uint32_t pageErases();
+    uint32_t maxPageErases();           // da página mais apagada
+}
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,110 @@
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include <functional>
+#include "Arduino.h"
+#include "WiFi.h"
+#include "FakeBroker.h"
+#include "HostMqttWire.h"
+
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+
+#ifndef MQTT_MAX_PACKET_SIZE
+#define MQTT_MAX_PACKET_SIZE 256
+#endif
+
+#ifndef FAKE_CLIENT_INBOX_SIZE
+#define FAKE_CLIENT_INBOX_SIZE 4
+#endif
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+// Mesma interface pública do knolleary/PubSubClient 2.8, ligada ao FakeBroker.
+// connect() consome tempo virtual para reproduzir o bloqueio do handshake
+// TCP/MQTT; mensagens recebidas são entregues dentro de loop(), como no real.
+// Com WiFi.hostUseRealNetwork(true) fala MQTT 3.1.1 (QoS 0) pelo Client com
+// um broker de verdade: connect() espera o CONNACK até o socket timeout e
+// loop() lê os pacotes e mantém o keepalive.
+class PubSubClient {
+public:
+    PubSubClient();
+    explicit PubSubClient(Client& client);
+    ~PubSubClient();
+
+    PubSubClient& setServer(const char* domain, uint16_t port);
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient& setClient(Client& client);
+    PubSubClient& setKeepAlive(uint16_t keepAlive);
+    PubSubClient& setSocketTimeout(uint16_t timeout);
+    bool setBufferSize(uint16_t size);
+    uint16_t getBufferSize() const { return _bufferSize; }
+
+    boolean connect(const char* id);
+    boolean connect(const char* id, const char* user, const char* pass);
+    boolean connect(const char* id, const char* user, const char* pass,
+                    const char* willTopic, uint8_t willQos, boolean willRetain,
+                    const char* willMessage);
+    void disconnect();
+
+    boolean publish(const char* topic, const char* payload);
+    boolean publish(const char* topic, const char* payload, boolean retained);
+    boolean publish(const char* topic, const uint8_t* payload, unsigned int plength);
+    boolean publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained);
+
+    boolean subscribe(const char* topic);
+    boolean subscribe(const char* topic, uint8_t qos);
+    boolean unsubscribe(const char* topic);
+
+    boolean loop();
+    boolean connected();
+    int state() const { return _state; }
+
+    // Usado pelo FakeBroker: enfileira uma mensagem para o próximo loop()
+    bool hostEnqueue(const char* topic, const uint8_t* payload, unsigned int length);
+    // Invoca o callback imediatamente, sem passar pelo broker
+    void hostDeliver(const char* topic, const uint8_t* payload, unsigned int length);
+
+private:
+    // Maior pacote aceito na rede real: cabeçalho, tópico e payload máximos
+    static const size_t WIRE_BUFFER_SIZE =
+        HostMqttWire::MAX_HEADER_BYTES + 2 + FAKE_BROKER_TOPIC_SIZE + FAKE_BROKER_PAYLOAD_SIZE;
+
+    bool connectWire(const char* id, const char* user, const char* pass);
+    bool writeWire(const uint8_t* packet, size_t length);
+    bool serviceWire();
+    bool keepWireAlive();
+    void handleWirePacket(uint8_t header, const uint8_t* body, size_t length);
+    uint16_t nextPacketId();
+
+    Client* _client;
+    MQTT_CALLBACK_SIGNATURE;
+    const char* _domain;
+    uint16_t _port;
+    uint16_t _bufferSize;
+    uint16_t _keepAlive;
+    uint16_t _socketTimeout;
+    int _state;
+    bool _attached;             // sessão aberta (no FakeBroker ou na rede real)
+    bool _wire;                 // a sessão atual usa a rede real
+
+    uint16_t _packetId;
+    unsigned long _lastOutbound;
+    unsigned long _lastInbound;
+    bool _pingOutstanding;
+    size_t _rxLength;
+    size_t _rxSkip;             // resto de um pacote maior que o buffer, descartado
+    uint8_t _rx[WIRE_BUFFER_SIZE];
+    uint8_t _tx[WIRE_BUFFER_SIZE];
+
+    FakeMessage _inbox[FAKE_CLIENT_INBOX_SIZE];
+    uint8_t _inboxHead;
+    uint8_t _inboxCount;
+    char _deliverTopic[FAKE_BROKER_TOPIC_SIZE];
+    uint8_t _deliverPayload[FAKE_BROKER_PAYLOAD_SIZE + 1];
+};
+
+#endif // HOST_PUBSUBCLIENT_H
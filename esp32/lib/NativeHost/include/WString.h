@@ -0,0 +1,107 @@
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class StringSumHelper;
+
+// Subconjunto da String do core Arduino usado pelo firmware.
+// O buffer cresce por realloc, como no core original, e é contabilizado
+// por HostAlloc para que os benchmarks reportem bytes alocados por chamada.
+class String {
+public:
+    String(const char* cstr = "");
+    String(const char* cstr, size_t length);
+    String(const String& other);
+    String(String&& other) noexcept;
+    explicit String(char c);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+    ~String();
+
+    String& operator=(const String& rhs);
+    String& operator=(String&& rhs) noexcept;
+    String& operator=(const char* cstr);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return _len; }
+    const char* c_str() const { return _buffer ? _buffer : ""; }
+
+    bool concat(const String& str);
+    bool concat(const char* cstr);
+    bool concat(const char* cstr, unsigned int length);
+    bool concat(char c);
+    bool concat(int num);
+    bool concat(unsigned int num);
+    bool concat(long num);
+    bool concat(unsigned long num);
+    bool concat(float num);
+    bool concat(double num);
+
+    String& operator+=(const String& rhs) { concat(rhs); return *this; }
+    String& operator+=(const char* cstr) { concat(cstr); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+    String& operator+=(int num) { concat(num); return *this; }
+    String& operator+=(unsigned int num) { concat(num); return *this; }
+    String& operator+=(long num) { concat(num); return *this; }
+    String& operator+=(unsigned long num) { concat(num); return *this; }
+    String& operator+=(float num) { concat(num); return *this; }
+    String& operator+=(double num) { concat(num); return *this; }
+
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, const String& rhs);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, const char* cstr);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, char c);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, int num);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, unsigned int num);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, long num);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, unsigned long num);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, float num);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, double num);
+
+    bool equals(const String& other) const;
+    bool equals(const char* cstr) const;
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+
+    char charAt(unsigned int index) const;
+    char operator[](unsigned int index) const { return charAt(index); }
+    int indexOf(char ch, unsigned int fromIndex = 0) const;
+    int indexOf(const char* str, unsigned int fromIndex = 0) const;
+    String substring(unsigned int beginIndex) const;
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    long toInt() const;
+    float toFloat() const;
+
+private:
+    char* _buffer;
+    unsigned int _capacity;
+    unsigned int _len;
+
+    bool grow(unsigned int size);
+    void invalidate();
+    String& copy(const char* cstr, unsigned int length);
+};
+
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+    StringSumHelper(const char* p) : String(p) {}
+    StringSumHelper(char c) : String(c) {}
+    StringSumHelper(int num) : String(num) {}
+    StringSumHelper(unsigned int num) : String(num) {}
+    StringSumHelper(long num) : String(num) {}
+    StringSumHelper(unsigned long num) : String(num) {}
+    StringSumHelper(float num) : String(num) {}
+    StringSumHelper(double num) : String(num) {}
+};
+
+#endif // HOST_WSTRING_H
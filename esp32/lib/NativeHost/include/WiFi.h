@@ -0,0 +1,102 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+#define WIFI_STA 1
+
+class IPAddress {
+public:
+    IPAddress() : _bytes{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{a, b, c, d} {}
+    uint8_t operator[](int index) const { return _bytes[index]; }
+    String toString() const;
+
+private:
+    uint8_t _bytes[4];
+};
+
+class Client {
+public:
+    virtual ~Client() {}
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    virtual uint8_t connected() = 0;
+    virtual void stop() = 0;
+};
+
+// Com o FakeBroker só o estado da conexão é simulado (o PubSubClient fala
+// direto com o broker em processo); com WiFi.hostUseRealNetwork(true) é um
+// socket TCP de verdade, sem bloqueio, e write/read carregam o MQTT.
+class WiFiClient : public Client {
+public:
+    WiFiClient() = default;
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+    ~WiFiClient() override { stop(); }
+
+    int connect(const char* host, uint16_t port) override;
+    // Como no core ESP32: timeout em milissegundos limita o tempo bloqueado
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override;
+    int read(uint8_t* buffer, size_t size) override;
+    uint8_t connected() override;
+    void stop() override;
+    void setTimeout(uint32_t seconds) { (void)seconds; }
+
+private:
+    int connectSocket(const char* host, uint16_t port, int32_t timeoutMs);
+
+    bool _connected = false;
+    int _socket = -1;
+};
+
+// Rádio simulado: a conexão completa após um atraso configurável no relógio
+// virtual, e os testes podem derrubar o enlace ou tornar a rede indisponível.
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+    wl_status_t status();
+    bool disconnect(bool wifiOff = false);
+    bool reconnect();
+    bool mode(int m) { (void)m; return true; }
+    bool setAutoReconnect(bool enabled) { (void)enabled; return true; }
+    IPAddress localIP() const;
+
+    // Controles do host
+    void hostSetNetworkAvailable(bool available);
+    void hostSetConnectDelay(uint32_t ms) { _connectDelayMs = ms; }
+    void hostDropConnection();
+    void hostReset();
+    uint32_t hostBeginCount() const { return _beginCount; }
+    // Sockets de verdade em vez do FakeBroker (simulador de frota com um
+    // Mosquitto local). O rádio continua simulado.
+    void hostUseRealNetwork(bool enabled) { _realNetwork = enabled; }
+    bool hostRealNetwork() const { return _realNetwork; }
+
+private:
+    bool _realNetwork = false;
+    bool _available = true;
+    bool _connecting = false;
+    bool _connected = false;
+    uint32_t _connectDelayMs = 0;
+    uint64_t _connectStartedUs = 0;
+    uint32_t _beginCount = 0;
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
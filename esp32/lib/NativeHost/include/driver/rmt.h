@@ -0,0 +1,116 @@
+#ifndef HOST_DRIVER_RMT_H
+#define HOST_DRIVER_RMT_H
+
+// Substituto do driver RMT legado do ESP-IDF 4.4 (driver/rmt.h).
+// Transmissão: rmt_write_items não bloqueia; o quadro vai para HostIRLog
+// com o instante do relógio virtual e o canal fica ocupado pelo tempo de ar,
+// que rmt_wait_tx_done com espera zero consulta sem avançar o relógio.
+// Recepção: rmt_rx_start pergunta ao DHT22 simulado (HostDht22) do pino o
+// que ele responderia, e hostRmtPress faz o papel de um controle remoto; o
+// quadro aparece no ring buffer do canal quando o relógio virtual passa do
+// fim da resposta.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "HostIRLog.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+    RMT_CHANNEL_0,
+    RMT_CHANNEL_1,
+    RMT_CHANNEL_2,
+    RMT_CHANNEL_3,
+    RMT_CHANNEL_4,
+    RMT_CHANNEL_5,
+    RMT_CHANNEL_6,
+    RMT_CHANNEL_7,
+    RMT_CHANNEL_MAX
+} rmt_channel_t;
+
+typedef enum { RMT_MODE_TX, RMT_MODE_RX } rmt_mode_t;
+typedef enum { RMT_CARRIER_LEVEL_LOW, RMT_CARRIER_LEVEL_HIGH } rmt_carrier_level_t;
+typedef enum { RMT_IDLE_LEVEL_LOW, RMT_IDLE_LEVEL_HIGH } rmt_idle_level_t;
+
+typedef struct {
+    union {
+        struct {
+            uint32_t duration0 : 15;
+            uint32_t level0 : 1;
+            uint32_t duration1 : 15;
+            uint32_t level1 : 1;
+        };
+        uint32_t val;
+    };
+} rmt_item32_t;
+
+typedef struct {
+    uint32_t carrier_freq_hz;
+    rmt_carrier_level_t carrier_level;
+    rmt_idle_level_t idle_level;
+    uint8_t carrier_duty_percent;
+    bool carrier_en;
+    bool loop_en;
+    bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct {
+    uint16_t idle_threshold;
+    uint8_t filter_ticks_thresh;
+    bool filter_en;
+    bool rm_carrier;
+    uint32_t carrier_freq_hz;
+    uint8_t carrier_duty_percent;
+    rmt_carrier_level_t carrier_level;
+} rmt_rx_config_t;
+
+typedef struct {
+    rmt_mode_t rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    uint32_t flags;
+    union {
+        rmt_tx_config_t tx_config;
+        rmt_rx_config_t rx_config;
+    };
+} rmt_config_t;
+
+#define RMT_DEFAULT_CONFIG_TX(gpio, channel_id) \
+    {RMT_MODE_TX, channel_id, gpio, 80, 1, 0, {{38000, RMT_CARRIER_LEVEL_HIGH, RMT_IDLE_LEVEL_LOW, 33, false, false, true}}}
+
+static inline rmt_config_t RMT_DEFAULT_CONFIG_RX(gpio_num_t gpio, rmt_channel_t channel_id) {
+    rmt_config_t config = {RMT_MODE_RX, channel_id, gpio, 80, 1, 0, {}};
+    config.rx_config = rmt_rx_config_t{12000, 100, true, false, 38000, 25, RMT_CARRIER_LEVEL_HIGH};
+    return config;
+}
+
+esp_err_t rmt_config(const rmt_config_t* config);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags);
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel);
+// high_level/low_level em ciclos do APB (80 MHz), como no ESP-IDF
+esp_err_t rmt_set_tx_carrier(rmt_channel_t channel, bool carrier_en, uint16_t high_level,
+                             uint16_t low_level, rmt_carrier_level_t carrier_level);
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t* rmt_item, int item_num, bool wait_tx_done);
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time);
+esp_err_t rmt_set_gpio(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t gpio_num, bool invert_signal);
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool rx_idx_rst);
+esp_err_t rmt_rx_stop(rmt_channel_t channel);
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t* buf_handle);
+
+// Controles do host
+void hostRmtReset();
+// Escritas recusadas por chegarem com o canal ainda transmitindo
+uint32_t hostRmtOverlaps();
+// Controle remoto apontado para o receptor IR do pino (saída ativa em
+// baixo, como um TSOP38238): o trem de durações entra no ring buffer do
+// canal que recebe nesse pino depois do fim do trem mais idle_threshold.
+// Como no hardware, só cabem os itens dos blocos de memória do canal; o
+// resto se perde. false se nenhum canal está recebendo no pino.
+bool hostRmtPress(uint8_t pin, const uint16_t* durations, uint16_t count);
+
+#endif // HOST_DRIVER_RMT_H
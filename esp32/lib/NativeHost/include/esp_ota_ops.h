@@ -0,0 +1,47 @@
+#ifndef HOST_ESP_OTA_OPS_H
+#define HOST_ESP_OTA_OPS_H
+
+// Substituto de esp_ota_ops.h (ESP-IDF 4.4) para o build nativo.
+// A flash das partições ota_0/ota_1 e irlib é um arquivo (temporário, ou o caminho
+// dado a HostOta::reset) e sobrevive a novas instâncias dos objetos do
+// firmware; HostOta::reboot() faz o papel do bootloader e passa a rodar a
+// partição de boot. A validação da imagem se limita ao byte mágico 0xE9.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+#ifndef HOST_OTA_PARTITION_SIZE
+#define HOST_OTA_PARTITION_SIZE 0x140000    // app0/app1 de partitions.csv
+#endif
+#ifndef HOST_IR_LIBRARY_PARTITION_SIZE
+#define HOST_IR_LIBRARY_PARTITION_SIZE 0x20000     // irlib de partitions.csv
+#endif
+
+#define ESP_IMAGE_HEADER_MAGIC 0xE9
+
+const esp_partition_t* esp_ota_get_running_partition();
+const esp_partition_t* esp_ota_get_boot_partition();
+// A outra partição de aplicação (start_from nullptr = a partir da que roda)
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start_from);
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition);
+esp_err_t esp_ota_mark_app_valid_cancel_rollback();
+
+// Específico do host: estado e desgaste da flash de aplicação
+namespace HostOta {
+    // ota_0 com uma imagem de fábrica rodando, ota_1 e irlib apagadas; path
+    // nullptr usa um arquivo temporário
+    bool reset(const char* path = nullptr);
+    // Reinício: o "bootloader" passa a rodar a partição de boot
+    void reboot();
+    // Falha as próximas gravações/apagamentos (flash com defeito)
+    void setWriteFailure(bool fail);
+    uint64_t bytesWritten();
+    uint32_t sectorsErased();
+    // Gravações que tentaram levar bits de 0 a 1 (faltou apagar o setor)
+    uint32_t dirtyWrites();
+    uint32_t validMarks();
+}
+
+#endif // HOST_ESP_OTA_OPS_H
@@ -0,0 +1,48 @@
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+// Substituto da API de partições do ESP-IDF 4.4 (esp_partition.h) para o
+// build nativo: as duas partições de aplicação (ota_0/ota_1) e a de dados
+// "irlib" de partitions.csv, sobre a flash simulada de HostOta
+// (esp_ota_ops.h). Como na NOR real, apagar leva o setor a 0xFF e gravar
+// só zera bits.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_APP_FACTORY = 0x00,
+    ESP_PARTITION_SUBTYPE_APP_OTA_0 = 0x10,
+    ESP_PARTITION_SUBTYPE_APP_OTA_1 = 0x11,
+    ESP_PARTITION_SUBTYPE_ANY = 0xff
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+// Primeira partição do tipo, subtipo (ou ESP_PARTITION_SUBTYPE_ANY) e
+// rótulo (nullptr: qualquer); nullptr se nenhuma
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label);
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size);
+// Sem apagar antes, os bits em 1 do dado viram o AND com o conteúdo
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size);
+// offset e size múltiplos de SPI_FLASH_SEC_SIZE
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+
+#endif // HOST_ESP_PARTITION_H
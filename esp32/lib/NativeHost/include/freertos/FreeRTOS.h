@@ -0,0 +1,29 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// Subconjunto do FreeRTOS (ESP-IDF) sobre pthreads. As tarefas são threads
+// reais do host, de modo que as filas entre tarefas são exercitadas com
+// concorrência de verdade. Atenção: vTaskDelay dorme em tempo real e não
+// avança o relógio virtual de HostClock, que não é seguro entre threads.
+
+#include <stdint.h>
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE  ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define PRO_CPU_NUM 0
+#define APP_CPU_NUM 1
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+#endif // HOST_FREERTOS_H
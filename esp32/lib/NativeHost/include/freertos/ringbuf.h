@@ -0,0 +1,16 @@
+#ifndef HOST_FREERTOS_RINGBUF_H
+#define HOST_FREERTOS_RINGBUF_H
+
+// Subconjunto do ring buffer do ESP-IDF usado pela recepção do RMT. Só os
+// buffers criados pelo RMT substituto (rmt_get_ringbuf_handle) existem; o
+// host não dorme: ticks_to_wait é ignorado e a chamada nunca bloqueia.
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+typedef void* RingbufHandle_t;
+
+void* xRingbufferReceive(RingbufHandle_t ringbuf, size_t* item_size, TickType_t ticks_to_wait);
+void vRingbufferReturnItem(RingbufHandle_t ringbuf, void* item);
+
+#endif // HOST_FREERTOS_RINGBUF_H
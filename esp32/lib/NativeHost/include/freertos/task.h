@@ -0,0 +1,31 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define tskIDLE_PRIORITY ((UBaseType_t)0U)
+
+// Núcleo e prioridade só são registrados; o escalonador do host decide
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority,
+                                   TaskHandle_t* createdTask, BaseType_t coreId);
+
+// Com NULL encerra a tarefa corrente, como no FreeRTOS
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+// Fora das tarefas criadas (a thread principal do teste) é um handle fixo
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+void taskYIELD();
+
+// Controles do host: espera a tarefa terminar (vTaskDelete(NULL) ou retorno)
+// e libera o handle
+void hostTaskJoin(TaskHandle_t task);
+BaseType_t hostTaskCore(TaskHandle_t task);
+
+#endif // HOST_FREERTOS_TASK_H
@@ -0,0 +1,125 @@
+#include "Arduino.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace {
+    uint64_t g_nowMicros = 0;
+    uint8_t g_pins[64] = {0};
+    uint64_t g_pinLowSince[64] = {0};
+    uint32_t g_pinLastLowUs[64] = {0};
+    uint32_t g_randomState = 1;
+    HostRandom::Source g_randomSource = nullptr;
+    void* g_randomContext = nullptr;
+}
+
+namespace HostClock {
+
+uint64_t nowMicros() { return g_nowMicros; }
+void advanceMicros(uint64_t us) { g_nowMicros += us; }
+void advanceMillis(uint64_t ms) { g_nowMicros += ms * 1000ULL; }
+void reset(uint64_t startMicros) { g_nowMicros = startMicros; }
+
+} // namespace HostClock
+
+unsigned long millis() { return (unsigned long)(g_nowMicros / 1000ULL); }
+unsigned long micros() { return (unsigned long)g_nowMicros; }
+void delay(uint32_t ms) { HostClock::advanceMillis(ms); }
+void delayMicroseconds(uint32_t us) { HostClock::advanceMicros(us); }
+void yield() {}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin >= sizeof(g_pins)) return;
+    uint8_t level = val ? HIGH : LOW;
+    if (level == LOW && g_pins[pin] != LOW) {
+        g_pinLowSince[pin] = g_nowMicros;
+    } else if (level == HIGH && g_pins[pin] == LOW) {
+        g_pinLastLowUs[pin] = uint32_t(g_nowMicros - g_pinLowSince[pin]);
+    }
+    g_pins[pin] = level;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (mode == INPUT || mode == INPUT_PULLUP) digitalWrite(pin, HIGH);
+}
+
+uint32_t hostPinLastLowUs(uint8_t pin) {
+    return pin < sizeof(g_pins) ? g_pinLastLowUs[pin] : 0;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < sizeof(g_pins) ? g_pins[pin] : LOW;
+}
+
+// xorshift32: determinístico entre execuções, como exigem os testes
+long random(long max) {
+    if (max <= 0) return 0;
+    if (g_randomSource) return g_randomSource(max, g_randomContext);
+    g_randomState ^= g_randomState << 13;
+    g_randomState ^= g_randomState >> 17;
+    g_randomState ^= g_randomState << 5;
+    return long(g_randomState % (uint32_t)max);
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    g_randomState = seed ? (uint32_t)seed : 1;
+}
+
+namespace HostRandom {
+
+void setSource(Source source, void* context) {
+    g_randomSource = source;
+    g_randomContext = context;
+}
+
+} // namespace HostRandom
+
+size_t HardwareSerial::print(const char* str) {
+    if (!str) return 0;
+    size_t len = strlen(str);
+    if (_echo) fwrite(str, 1, len, stdout);
+    return len;
+}
+
+size_t HardwareSerial::print(char c) {
+    if (_echo) fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::print(long num, int base) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%ld", num);
+    return print(buf);
+}
+
+size_t HardwareSerial::print(unsigned long num, int base) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%lu", num);
+    return print(buf);
+}
+
+size_t HardwareSerial::print(double num, int digits) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", digits, num);
+    return print(buf);
+}
+
+size_t HardwareSerial::println() {
+    return print("\r\n");
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    print(buf);
+    return len > 0 ? size_t(len) : 0;
+}
@@ -0,0 +1,173 @@
+#include "FakeBroker.h"
+#include "PubSubClient.h"
+#include <string.h>
+
+FakeBroker& FakeBroker::instance() {
+    static FakeBroker broker;
+    return broker;
+}
+
+void FakeBroker::reset() {
+    _reachable = true;
+    _stalled = false;
+    _observer = nullptr;
+    _observerContext = nullptr;
+    _connectOkMs = 0;
+    _connectFailMs = 0;
+    memset(_clients, 0, sizeof(_clients));
+    memset(_subscriptions, 0, sizeof(_subscriptions));
+    _publishCount = 0;
+    _deliveryCount = 0;
+    _retainedCount = 0;
+}
+
+void FakeBroker::setReachable(bool reachable) {
+    _reachable = reachable;
+}
+
+bool FakeBroker::attach(PubSubClient* client) {
+    for (PubSubClient*& slot : _clients) {
+        if (slot == client) return true;
+    }
+    for (PubSubClient*& slot : _clients) {
+        if (!slot) {
+            slot = client;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FakeBroker::detach(PubSubClient* client) {
+    for (PubSubClient*& slot : _clients) {
+        if (slot == client) slot = nullptr;
+    }
+    for (Subscription& sub : _subscriptions) {
+        if (sub.client == client) sub.client = nullptr;
+    }
+}
+
+bool FakeBroker::subscribe(PubSubClient* client, const char* filter) {
+    if (!filter || strlen(filter) >= FAKE_BROKER_TOPIC_SIZE) {
+        return false;
+    }
+    for (Subscription& sub : _subscriptions) {
+        if (sub.client == client && strcmp(sub.filter, filter) == 0) {
+            return true;
+        }
+    }
+    for (Subscription& sub : _subscriptions) {
+        if (!sub.client) {
+            sub.client = client;
+            strcpy(sub.filter, filter);
+            // Mensagens retidas são entregues na inscrição
+            for (size_t i = 0; i < _retainedCount; i++) {
+                if (topicMatches(filter, _retained[i].topic)) {
+                    client->hostEnqueue(_retained[i].topic, _retained[i].payload, _retained[i].length);
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FakeBroker::unsubscribe(PubSubClient* client, const char* filter) {
+    for (Subscription& sub : _subscriptions) {
+        if (sub.client == client && strcmp(sub.filter, filter) == 0) {
+            sub.client = nullptr;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void storeMessage(FakeMessage& slot, const char* topic, const uint8_t* payload,
+                         unsigned int length, bool retained) {
+    strncpy(slot.topic, topic, sizeof(slot.topic) - 1);
+    slot.topic[sizeof(slot.topic) - 1] = '\0';
+    if (length) memcpy(slot.payload, payload, length);
+    slot.payload[length] = 0;
+    slot.length = length;
+    slot.retained = retained;
+    slot.timestampUs = HostClock::nowMicros();
+}
+
+bool FakeBroker::publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+    if (!_reachable || _stalled || !topic || length > FAKE_BROKER_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    FakeMessage& entry = _log[_publishCount % FAKE_BROKER_LOG_SIZE];
+    storeMessage(entry, topic, payload, length, retained);
+    _publishCount++;
+
+    if (retained) {
+        size_t i = 0;
+        while (i < _retainedCount && strcmp(_retained[i].topic, topic) != 0) i++;
+        if (i < FAKE_BROKER_LOG_SIZE) {
+            storeMessage(_retained[i], topic, payload, length, true);
+            if (i == _retainedCount) _retainedCount++;
+        }
+    }
+
+    for (Subscription& sub : _subscriptions) {
+        if (sub.client && topicMatches(sub.filter, topic) && sub.client->hostEnqueue(topic, payload, length)) {
+            _deliveryCount++;
+        }
+    }
+
+    if (_observer) {
+        _observer(entry, _observerContext);
+    }
+    return true;
+}
+
+bool FakeBroker::inject(const char* topic, const char* payload) {
+    return inject(topic, reinterpret_cast<const uint8_t*>(payload), strlen(payload));
+}
+
+bool FakeBroker::inject(const char* topic, const uint8_t* payload, unsigned int length) {
+    return publish(topic, payload, length, false);
+}
+
+const FakeMessage* FakeBroker::lastMessage(const char* topicFilter) const {
+    uint32_t available = _publishCount < FAKE_BROKER_LOG_SIZE ? _publishCount : FAKE_BROKER_LOG_SIZE;
+    for (uint32_t n = 1; n <= available; n++) {
+        const FakeMessage& entry = _log[(_publishCount - n) % FAKE_BROKER_LOG_SIZE];
+        if (!topicFilter || topicMatches(topicFilter, entry.topic)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const FakeMessage* FakeBroker::retained(const char* topic) const {
+    for (size_t i = 0; i < _retainedCount; i++) {
+        if (strcmp(_retained[i].topic, topic) == 0) return &_retained[i];
+    }
+    return nullptr;
+}
+
+bool FakeBroker::topicMatches(const char* filter, const char* topic) {
+    while (*filter) {
+        if (*filter == '#') {
+            return true;
+        }
+        if (*filter == '+') {
+            while (*topic && *topic != '/') topic++;
+            filter++;
+            continue;
+        }
+        // Como no MQTT, "a/#" também casa com o próprio "a"
+        if (*topic == '\0' && strcmp(filter, "/#") == 0) {
+            return true;
+        }
+        if (*filter != *topic) {
+            return false;
+        }
+        filter++;
+        topic++;
+    }
+    return *topic == '\0';
+}
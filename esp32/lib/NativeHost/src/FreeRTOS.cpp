@@ -0,0 +1,99 @@
+#include "freertos/task.h"
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+struct HostTask {
+    pthread_t thread;
+    TaskFunction_t code;
+    void* parameters;
+    BaseType_t coreId;
+    bool joined;
+};
+
+namespace {
+    thread_local HostTask* t_current = nullptr;
+    HostTask g_mainTask{pthread_t(), nullptr, nullptr, PRO_CPU_NUM, true};
+
+    void* trampoline(void* arg) {
+        HostTask* task = static_cast<HostTask*>(arg);
+        t_current = task;
+        task->code(task->parameters);
+        return nullptr;
+    }
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority,
+                                   TaskHandle_t* createdTask, BaseType_t coreId) {
+    (void)name;
+    (void)priority;
+
+    HostTask* task = new HostTask{pthread_t(), code, parameters, coreId, false};
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    // No ESP-IDF a pilha é em bytes; o host precisa de folga para printf
+    size_t stackBytes = stackDepth;
+    if (stackBytes < 256 * 1024) stackBytes = 256 * 1024;
+    pthread_attr_setstacksize(&attr, stackBytes);
+    int rc = pthread_create(&task->thread, &attr, trampoline, task);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        delete task;
+        return pdFAIL;
+    }
+    if (createdTask) {
+        *createdTask = task;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == t_current) {
+        pthread_exit(nullptr);
+    }
+    // Matar outra thread não é seguro no host; as tarefas terminam sozinhas
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    uint64_t ms = uint64_t(ticks) * portTICK_PERIOD_MS;
+    timespec ts;
+    ts.tv_sec = time_t(ms / 1000);
+    ts.tv_nsec = long(ms % 1000) * 1000000L;
+    nanosleep(&ts, nullptr);
+}
+
+TickType_t xTaskGetTickCount() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return TickType_t(uint64_t(ts.tv_sec) * configTICK_RATE_HZ + uint64_t(ts.tv_nsec) / (1000000000ULL / configTICK_RATE_HZ));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return t_current ? t_current : &g_mainTask;
+}
+
+BaseType_t xPortGetCoreID() {
+    return t_current ? t_current->coreId : PRO_CPU_NUM;
+}
+
+void taskYIELD() {
+    sched_yield();
+}
+
+void hostTaskJoin(TaskHandle_t task) {
+    if (!task || task->joined) {
+        return;
+    }
+    pthread_join(task->thread, nullptr);
+    task->joined = true;
+    delete task;
+}
+
+BaseType_t hostTaskCore(TaskHandle_t task) {
+    return task ? task->coreId : tskNO_AFFINITY;
+}
@@ -0,0 +1,106 @@
+#include "HostAlloc.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Com a glibc, malloc/calloc/realloc/free também são substituídos e contam
+// como o new; o alocador de verdade fica nos __libc_*. Fora dela (macOS)
+// só new e String são vistos.
+#ifdef __GLIBC__
+#define HOST_ALLOC_WRAPS_MALLOC 1
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+#define RAW_MALLOC __libc_malloc
+#define RAW_REALLOC __libc_realloc
+#define RAW_FREE __libc_free
+#else
+#define RAW_MALLOC std::malloc
+#define RAW_REALLOC std::realloc
+#define RAW_FREE std::free
+#endif
+
+namespace {
+    std::atomic<uint64_t> g_calls{0};
+    std::atomic<uint64_t> g_bytes{0};
+    std::atomic<HostAlloc::Hook> g_hook{nullptr};
+
+    void record(size_t size) {
+        HostAlloc::Hook hook = g_hook.load(std::memory_order_acquire);
+        if (hook) hook(size);
+        g_calls.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void* countedMalloc(size_t size) {
+        record(size);
+        void* ptr = RAW_MALLOC(size ? size : 1);
+        if (!ptr) {
+            std::abort();
+        }
+        return ptr;
+    }
+}
+
+namespace HostAlloc {
+
+HostAllocStats stats() {
+    return HostAllocStats{
+        g_calls.load(std::memory_order_relaxed),
+        g_bytes.load(std::memory_order_relaxed)
+    };
+}
+
+void reset() {
+    g_calls.store(0, std::memory_order_relaxed);
+    g_bytes.store(0, std::memory_order_relaxed);
+}
+
+void* reallocate(void* ptr, size_t size) {
+    record(size);
+    return RAW_REALLOC(ptr, size);
+}
+
+void release(void* ptr) {
+    RAW_FREE(ptr);
+}
+
+void setHook(Hook hook) {
+    g_hook.store(hook, std::memory_order_release);
+}
+
+} // namespace HostAlloc
+
+void* operator new(size_t size) { return countedMalloc(size); }
+void* operator new[](size_t size) { return countedMalloc(size); }
+void operator delete(void* ptr) noexcept { RAW_FREE(ptr); }
+void operator delete[](void* ptr) noexcept { RAW_FREE(ptr); }
+void operator delete(void* ptr, size_t) noexcept { RAW_FREE(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { RAW_FREE(ptr); }
+
+#if HOST_ALLOC_WRAPS_MALLOC
+// Como os --wrap do ESP32: realloc com tamanho 0 é um free e não conta
+extern "C" {
+void* malloc(size_t size) {
+    record(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    record(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (size) record(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+}
+#endif
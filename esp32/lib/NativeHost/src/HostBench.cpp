@@ -0,0 +1,17 @@
+#include "HostBench.h"
+#include <stdio.h>
+
+namespace HostBench {
+
+void report(const BenchResult& result) {
+    printf("[bench] %-44s %10.1f ns/op %8.2f allocs/op %8.1f B/op %10.1f us bloqueado/op (n=%u)\n",
+           result.name,
+           result.nsPerOp,
+           result.allocsPerOp,
+           result.bytesPerOp,
+           result.blockedUsPerOp,
+           (unsigned)result.iterations);
+    fflush(stdout);
+}
+
+} // namespace HostBench
@@ -0,0 +1,114 @@
+#include "HostDht22.h"
+#include <math.h>
+#include "Arduino.h"
+
+// Temporizações do AM2302/DHT22 (µs)
+static const uint16_t RESPONSE_LOW_US = 80;
+static const uint16_t RESPONSE_HIGH_US = 80;
+static const uint16_t BIT_LOW_US = 50;
+static const uint16_t ZERO_HIGH_US = 27;
+static const uint16_t ONE_HIGH_US = 70;
+static const uint16_t RELEASE_WAIT_US = 30;
+static const uint32_t MIN_START_LOW_US = 1000;
+static const uint8_t MAX_PINS = 64;
+
+namespace {
+    struct Sensor {
+        float temperature;
+        float humidity;
+        HostDht22::Fault fault;
+        uint16_t faultCount;
+        uint32_t reads;
+        uint32_t badStarts;
+    };
+
+    Sensor g_sensors[MAX_PINS];
+    bool g_initialized = false;
+
+    Sensor& sensor(uint8_t pin) {
+        if (!g_initialized) HostDht22::reset();
+        return g_sensors[pin % MAX_PINS];
+    }
+
+    rmt_item32_t item(uint16_t low, uint16_t high) {
+        rmt_item32_t item;
+        item.level0 = 0;
+        item.duration0 = low;
+        item.level1 = 1;
+        item.duration1 = high;
+        return item;
+    }
+}
+
+namespace HostDht22 {
+
+void reset() {
+    for (Sensor& s : g_sensors) {
+        s = Sensor{24.0f, 55.0f, Fault::NONE, 0, 0, 0};
+    }
+    g_initialized = true;
+}
+
+void setReading(uint8_t pin, float temperature, float humidity) {
+    Sensor& s = sensor(pin);
+    s.temperature = temperature;
+    s.humidity = humidity;
+}
+
+void setFault(uint8_t pin, Fault fault, uint16_t count) {
+    Sensor& s = sensor(pin);
+    s.fault = fault;
+    s.faultCount = fault == Fault::NONE ? 0 : count;
+}
+
+uint32_t reads(uint8_t pin) {
+    return sensor(pin).reads;
+}
+
+uint32_t badStarts(uint8_t pin) {
+    return sensor(pin).badStarts;
+}
+
+size_t respond(uint8_t pin, rmt_item32_t* items, size_t capacity, uint32_t& durationUs) {
+    Sensor& s = sensor(pin);
+    durationUs = 0;
+    s.reads++;
+    if (hostPinLastLowUs(pin) < MIN_START_LOW_US) {
+        s.badStarts++;
+        return 0;
+    }
+
+    Fault fault = Fault::NONE;
+    if (s.faultCount) {
+        fault = s.fault;
+        if (s.faultCount != 0xFFFF) s.faultCount--;
+    }
+    if (fault == Fault::ABSENT || isnan(s.temperature) || isnan(s.humidity)) {
+        return 0;
+    }
+
+    uint16_t humidity = uint16_t(lroundf(s.humidity * 10.0f));
+    uint16_t temperature = uint16_t(lroundf(fabsf(s.temperature) * 10.0f)) & 0x7FFF;
+    if (s.temperature < 0.0f) temperature |= 0x8000;
+    uint8_t bytes[5] = {uint8_t(humidity >> 8), uint8_t(humidity), uint8_t(temperature >> 8), uint8_t(temperature), 0};
+    bytes[4] = uint8_t(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+    if (fault == Fault::CHECKSUM) bytes[4] ^= 0x01;
+
+    uint8_t bits = fault == Fault::TRUNCATED ? 20 : 40;
+    size_t count = 0;
+    durationUs = RELEASE_WAIT_US;
+    auto emit = [&](uint16_t low, uint16_t high) {
+        if (count < capacity) items[count++] = item(low, high);
+        durationUs += uint32_t(low) + high;
+    };
+    emit(RESPONSE_LOW_US, RESPONSE_HIGH_US);
+    for (uint8_t bit = 0; bit < bits; bit++) {
+        bool one = bytes[bit / 8] & (0x80 >> (bit % 8));
+        emit(BIT_LOW_US, one ? ONE_HIGH_US : ZERO_HIGH_US);
+    }
+    // Último nível baixo e a linha volta ao pull-up: duração zero encerra
+    emit(BIT_LOW_US, 0);
+    return count;
+}
+
+} // namespace HostDht22
@@ -0,0 +1,45 @@
+#include "HostIRLog.h"
+#include <string.h>
+
+namespace {
+    HostIRFrame g_frames[HOST_IR_LOG_SIZE];
+    uint32_t g_count = 0;
+    uint16_t g_pulses[1024];
+    uint16_t g_pulseCount = 0;
+}
+
+namespace HostIRLog {
+
+void reset() {
+    g_count = 0;
+    g_pulseCount = 0;
+}
+uint32_t count() { return g_count; }
+
+const HostIRFrame* at(uint32_t index) {
+    if (index >= g_count || g_count - index > HOST_IR_LOG_SIZE) {
+        return nullptr;
+    }
+    return &g_frames[index % HOST_IR_LOG_SIZE];
+}
+
+const HostIRFrame* last() {
+    return g_count ? at(g_count - 1) : nullptr;
+}
+
+void record(const HostIRFrame& frame) {
+    g_frames[g_count % HOST_IR_LOG_SIZE] = frame;
+    g_count++;
+}
+
+void recordPulses(const uint16_t* durations, uint16_t count) {
+    g_pulseCount = count < sizeof(g_pulses) / sizeof(g_pulses[0]) ? count : uint16_t(sizeof(g_pulses) / sizeof(g_pulses[0]));
+    memcpy(g_pulses, durations, g_pulseCount * sizeof(uint16_t));
+}
+
+uint16_t lastPulses(const uint16_t*& durations) {
+    durations = g_pulses;
+    return g_pulseCount;
+}
+
+} // namespace HostIRLog
@@ -0,0 +1,148 @@
+#include "HostMqttWire.h"
+#include <string.h>
+
+namespace HostMqttWire {
+
+namespace {
+
+// Monta o pacote a partir do fim do cabeçalho fixo, que só é conhecido
+// depois do corpo
+class PacketWriter {
+public:
+    PacketWriter(uint8_t* out, size_t capacity)
+        : _out(out), _capacity(capacity), _length(MAX_HEADER_BYTES), _overflow(capacity < MAX_HEADER_BYTES) {}
+
+    void byte(uint8_t value) {
+        if (_overflow || _length >= _capacity) {
+            _overflow = true;
+            return;
+        }
+        _out[_length++] = value;
+    }
+    void word(uint16_t value) {
+        byte(uint8_t(value >> 8));
+        byte(uint8_t(value));
+    }
+    void bytes(const uint8_t* data, size_t length) {
+        if (_overflow || length > _capacity - _length) {
+            _overflow = true;
+            return;
+        }
+        if (length) memcpy(_out + _length, data, length);
+        _length += length;
+    }
+    // Cadeia UTF-8 com prefixo de comprimento
+    void string(const char* text) {
+        size_t length = strlen(text);
+        if (length > 0xFFFF) {
+            _overflow = true;
+            return;
+        }
+        word(uint16_t(length));
+        bytes(reinterpret_cast<const uint8_t*>(text), length);
+    }
+
+    // Fecha o pacote e o desloca para o início de 'out'
+    size_t finish(uint8_t typeAndFlags) {
+        if (_overflow) return 0;
+        uint8_t header[MAX_HEADER_BYTES];
+        header[0] = typeAndFlags;
+        size_t headerLength = 1 + encodeLength(uint32_t(_length - MAX_HEADER_BYTES), header + 1);
+        size_t bodyLength = _length - MAX_HEADER_BYTES;
+        memmove(_out + headerLength, _out + MAX_HEADER_BYTES, bodyLength);
+        memcpy(_out, header, headerLength);
+        return headerLength + bodyLength;
+    }
+
+private:
+    uint8_t* _out;
+    size_t _capacity;
+    size_t _length;
+    bool _overflow;
+};
+
+}  // namespace
+
+size_t encodeLength(uint32_t length, uint8_t* out) {
+    size_t n = 0;
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        out[n++] = uint8_t(digit | (length ? 0x80 : 0));
+    } while (length && n < 4);
+    return n;
+}
+
+int decodeLength(const uint8_t* in, size_t available, uint32_t& length) {
+    length = 0;
+    uint32_t multiplier = 1;
+    for (size_t i = 0; i < 4; i++) {
+        if (i >= available) return 0;
+        length += uint32_t(in[i] & 0x7F) * multiplier;
+        if (!(in[i] & 0x80)) return int(i + 1);
+        multiplier *= 128;
+    }
+    return -1;
+}
+
+size_t connectPacket(uint8_t* out, size_t capacity, const char* clientId,
+                     const char* user, const char* password, uint16_t keepAlive) {
+    PacketWriter packet(out, capacity);
+    packet.string("MQTT");
+    packet.byte(4);     // nível do protocolo (3.1.1)
+    uint8_t flags = 0x02;   // sessão limpa
+    if (user) flags |= 0x80;
+    if (user && password) flags |= 0x40;
+    packet.byte(flags);
+    packet.word(keepAlive);
+    packet.string(clientId ? clientId : "");
+    if (user) packet.string(user);
+    if (user && password) packet.string(password);
+    return packet.finish(CONNECT << 4);
+}
+
+size_t publishPacket(uint8_t* out, size_t capacity, const char* topic,
+                     const uint8_t* payload, size_t length, bool retained) {
+    PacketWriter packet(out, capacity);
+    packet.string(topic);
+    packet.bytes(payload, length);
+    return packet.finish(uint8_t(PUBLISH << 4 | (retained ? 1 : 0)));
+}
+
+size_t subscribePacket(uint8_t* out, size_t capacity, uint16_t packetId, const char* filter) {
+    PacketWriter packet(out, capacity);
+    packet.word(packetId);
+    packet.string(filter);
+    packet.byte(0);     // QoS 0
+    return packet.finish(SUBSCRIBE << 4 | 0x02);
+}
+
+size_t unsubscribePacket(uint8_t* out, size_t capacity, uint16_t packetId, const char* filter) {
+    PacketWriter packet(out, capacity);
+    packet.word(packetId);
+    packet.string(filter);
+    return packet.finish(UNSUBSCRIBE << 4 | 0x02);
+}
+
+size_t emptyPacket(uint8_t* out, PacketType type) {
+    out[0] = uint8_t(type << 4);
+    out[1] = 0;
+    return 2;
+}
+
+bool parsePublish(uint8_t flags, const uint8_t* body, size_t length,
+                  const char*& topic, size_t& topicLength,
+                  const uint8_t*& payload, size_t& payloadLength) {
+    if (length < 2) return false;
+    topicLength = size_t(body[0]) << 8 | body[1];
+    size_t offset = 2 + topicLength;
+    // QoS 1 e 2 trazem o identificador do pacote depois do tópico
+    if ((flags >> 1) & 0x03) offset += 2;
+    if (offset > length) return false;
+    topic = reinterpret_cast<const char*>(body + 2);
+    payload = body + offset;
+    payloadLength = length - offset;
+    return true;
+}
+
+}  // namespace HostMqttWire
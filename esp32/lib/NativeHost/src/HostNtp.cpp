@@ -0,0 +1,68 @@
+#include "Arduino.h"
+
+namespace {
+    bool g_configured = false;
+    bool g_reachable = true;
+    bool g_hasEpoch = false;
+    bool g_synced = false;
+    long g_offsetSeconds = 0;
+    uint64_t g_epochAt = 0;         // hora do servidor em g_epochAtMicros
+    uint64_t g_epochAtMicros = 0;
+    uint64_t g_deviceEpochAt = 0;   // hora do dispositivo na última sincronização
+    uint64_t g_deviceEpochAtMicros = 0;
+
+    uint64_t serverEpoch() {
+        return g_epochAt + (HostClock::nowMicros() - g_epochAtMicros) / 1000000ULL;
+    }
+
+    void trySync() {
+        if (g_configured && g_reachable && g_hasEpoch) {
+            g_deviceEpochAt = serverEpoch();
+            g_deviceEpochAtMicros = HostClock::nowMicros();
+            g_synced = true;
+        }
+    }
+}
+
+void configTime(long gmtOffsetSeconds, int daylightOffsetSeconds, const char*, const char*, const char*) {
+    g_offsetSeconds = gmtOffsetSeconds + daylightOffsetSeconds;
+    g_configured = true;
+    trySync();
+}
+
+bool getLocalTime(struct tm* info, uint32_t) {
+    // O SNTP do ESP-IDF ressincroniza sozinho de tempos em tempos; aqui, a
+    // cada consulta com o servidor alcançável
+    trySync();
+    if (!g_synced) return false;
+    time_t now = time_t(g_deviceEpochAt + (HostClock::nowMicros() - g_deviceEpochAtMicros) / 1000000ULL
+                        + g_offsetSeconds);
+    gmtime_r(&now, info);
+    return true;
+}
+
+namespace HostNtp {
+
+void reset() {
+    g_configured = false;
+    g_reachable = true;
+    g_hasEpoch = false;
+    g_synced = false;
+    g_offsetSeconds = 0;
+}
+
+void setEpoch(uint64_t epochSeconds) {
+    g_epochAt = epochSeconds;
+    g_epochAtMicros = HostClock::nowMicros();
+    g_hasEpoch = true;
+}
+
+void setReachable(bool reachable) {
+    g_reachable = reachable;
+}
+
+bool synced() {
+    return g_synced;
+}
+
+} // namespace HostNtp
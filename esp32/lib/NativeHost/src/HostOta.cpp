@@ -0,0 +1,187 @@
+#include "esp_ota_ops.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+    // Endereços de partitions.csv
+    esp_partition_t g_partitions[3] = {
+        {ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x10000, HOST_OTA_PARTITION_SIZE, "app0", false},
+        {ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x150000, HOST_OTA_PARTITION_SIZE, "app1", false},
+        {ESP_PARTITION_TYPE_DATA, esp_partition_subtype_t(0x40), 0x3D0000, HOST_IR_LIBRARY_PARTITION_SIZE, "irlib", false},
+    };
+    const size_t PARTITION_COUNT = sizeof(g_partitions) / sizeof(g_partitions[0]);
+
+    int g_fd = -1;
+    const esp_partition_t* g_running = nullptr;
+    const esp_partition_t* g_boot = nullptr;
+    bool g_writeFailure = false;
+    uint64_t g_bytesWritten = 0;
+    uint32_t g_sectorsErased = 0;
+    uint32_t g_dirtyWrites = 0;
+    uint32_t g_validMarks = 0;
+
+    // Cada partição ocupa uma faixa do arquivo, na ordem da tabela
+    off_t fileOffset(const esp_partition_t* partition, size_t offset) {
+        return off_t(partition - g_partitions) * HOST_OTA_PARTITION_SIZE + off_t(offset);
+    }
+
+    bool known(const esp_partition_t* partition) {
+        return partition >= g_partitions && partition < g_partitions + PARTITION_COUNT;
+    }
+
+    bool isApp(const esp_partition_t* partition) {
+        return partition == &g_partitions[0] || partition == &g_partitions[1];
+    }
+
+    bool inBounds(const esp_partition_t* partition, size_t offset, size_t size) {
+        return known(partition) && offset <= partition->size && size <= partition->size - offset;
+    }
+
+    bool fill(const esp_partition_t* partition, size_t offset, size_t size, uint8_t value) {
+        uint8_t block[SPI_FLASH_SEC_SIZE];
+        memset(block, value, sizeof(block));
+        while (size) {
+            size_t n = size < sizeof(block) ? size : sizeof(block);
+            if (pwrite(g_fd, block, n, fileOffset(partition, offset)) != ssize_t(n)) return false;
+            offset += n;
+            size -= n;
+        }
+        return true;
+    }
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    for (const esp_partition_t& partition : g_partitions) {
+        if (partition.type == type && (subtype == ESP_PARTITION_SUBTYPE_ANY || partition.subtype == subtype)
+            && (!label || strcmp(label, partition.label) == 0)) {
+            return &partition;
+        }
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size) {
+    if (g_fd < 0 || !dst || !inBounds(partition, src_offset, size)) return ESP_ERR_INVALID_ARG;
+    return pread(g_fd, dst, size, fileOffset(partition, src_offset)) == ssize_t(size) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size) {
+    if (g_fd < 0 || !src || !inBounds(partition, dst_offset, size)) return ESP_ERR_INVALID_ARG;
+    if (g_writeFailure) return ESP_FAIL;
+
+    const uint8_t* data = static_cast<const uint8_t*>(src);
+    uint8_t current[256];
+    bool dirty = false;
+    size_t done = 0;
+    while (done < size) {
+        size_t n = size - done < sizeof(current) ? size - done : sizeof(current);
+        off_t at = fileOffset(partition, dst_offset + done);
+        if (pread(g_fd, current, n, at) != ssize_t(n)) return ESP_FAIL;
+        for (size_t i = 0; i < n; i++) {
+            uint8_t programmed = current[i] & data[done + i];
+            dirty |= programmed != data[done + i];
+            current[i] = programmed;
+        }
+        if (pwrite(g_fd, current, n, at) != ssize_t(n)) return ESP_FAIL;
+        done += n;
+    }
+    g_bytesWritten += size;
+    if (dirty) g_dirtyWrites++;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    if (g_fd < 0 || !inBounds(partition, offset, size)) return ESP_ERR_INVALID_ARG;
+    if (offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE) return ESP_ERR_INVALID_SIZE;
+    if (g_writeFailure) return ESP_FAIL;
+    if (!fill(partition, offset, size, 0xFF)) return ESP_FAIL;
+    g_sectorsErased += uint32_t(size / SPI_FLASH_SEC_SIZE);
+    return ESP_OK;
+}
+
+const esp_partition_t* esp_ota_get_running_partition() {
+    return g_running;
+}
+
+const esp_partition_t* esp_ota_get_boot_partition() {
+    return g_boot;
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start_from) {
+    const esp_partition_t* from = start_from ? start_from : g_running;
+    if (!isApp(from)) return nullptr;
+    return from == &g_partitions[0] ? &g_partitions[1] : &g_partitions[0];
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+    if (g_fd < 0 || !isApp(partition)) return ESP_ERR_INVALID_ARG;
+    uint8_t magic = 0;
+    if (esp_partition_read(partition, 0, &magic, 1) != ESP_OK || magic != ESP_IMAGE_HEADER_MAGIC) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    g_boot = partition;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() {
+    g_validMarks++;
+    return ESP_OK;
+}
+
+namespace HostOta {
+
+bool reset(const char* path) {
+    if (g_fd >= 0) close(g_fd);
+    if (path) {
+        g_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    } else {
+        // Some com o processo; nenhum arquivo fica para trás
+        char name[] = "/tmp/host-ota-XXXXXX";
+        g_fd = mkstemp(name);
+        if (g_fd >= 0) unlink(name);
+    }
+    g_running = g_boot = &g_partitions[0];
+    g_writeFailure = false;
+    if (g_fd < 0 || ftruncate(g_fd, 0) != 0) return false;
+
+    // Imagem de fábrica: o byte mágico e o resto apagado
+    uint8_t magic = ESP_IMAGE_HEADER_MAGIC;
+    bool ok = fill(&g_partitions[0], 0, HOST_OTA_PARTITION_SIZE, 0xFF)
+        && fill(&g_partitions[1], 0, HOST_OTA_PARTITION_SIZE, 0xFF)
+        && fill(&g_partitions[2], 0, HOST_IR_LIBRARY_PARTITION_SIZE, 0xFF)
+        && pwrite(g_fd, &magic, 1, fileOffset(&g_partitions[0], 0)) == 1;
+    g_bytesWritten = 0;
+    g_sectorsErased = 0;
+    g_dirtyWrites = 0;
+    g_validMarks = 0;
+    return ok;
+}
+
+void reboot() {
+    g_running = g_boot;
+}
+
+void setWriteFailure(bool fail) {
+    g_writeFailure = fail;
+}
+
+uint64_t bytesWritten() {
+    return g_bytesWritten;
+}
+
+uint32_t sectorsErased() {
+    return g_sectorsErased;
+}
+
+uint32_t dirtyWrites() {
+    return g_dirtyWrites;
+}
+
+uint32_t validMarks() {
+    return g_validMarks;
+}
+
+} // namespace HostOta
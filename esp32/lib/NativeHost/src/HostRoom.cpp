@@ -0,0 +1,9 @@
+#include "HostRoom.h"
+
+void HostRoom::step(float seconds, bool cooling) {
+    // Euler explícito: os passos do laço (dezenas de ms) são muito menores
+    // que a constante de tempo
+    float rate = (outdoor - temperature) / tauSeconds;
+    if (cooling) rate -= coolingPerSecond;
+    temperature += rate * seconds;
+}
@@ -0,0 +1,138 @@
+#include "LittleFS.h"
+#include <string.h>
+
+fs::LittleFSFS LittleFS;
+
+namespace fs {
+
+struct HostFileEntry {
+    char path[64];
+    bool used;
+    size_t size;
+    uint8_t data[HOST_FS_FILE_SIZE];
+};
+
+} // namespace fs
+
+namespace {
+    fs::HostFileEntry g_files[HOST_FS_MAX_FILES];
+    bool g_mountFailure = false;
+    uint64_t g_bytesWritten = 0;
+    uint32_t g_writeCalls = 0;
+
+    fs::HostFileEntry* find(const char* path) {
+        for (fs::HostFileEntry& entry : g_files) {
+            if (entry.used && strcmp(entry.path, path) == 0) return &entry;
+        }
+        return nullptr;
+    }
+
+    fs::HostFileEntry* create(const char* path) {
+        if (strlen(path) >= sizeof(g_files[0].path)) return nullptr;
+        for (fs::HostFileEntry& entry : g_files) {
+            if (!entry.used) {
+                entry.used = true;
+                entry.size = 0;
+                strcpy(entry.path, path);
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+}
+
+namespace fs {
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!_entry || _position >= _entry->size) return 0;
+    size_t n = _entry->size - _position < size ? _entry->size - _position : size;
+    memcpy(buffer, _entry->data + _position, n);
+    _position += n;
+    return n;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!_entry || !_writable) return 0;
+    size_t n = HOST_FS_FILE_SIZE - _position < size ? HOST_FS_FILE_SIZE - _position : size;
+    memcpy(_entry->data + _position, buffer, n);
+    _position += n;
+    if (_position > _entry->size) _entry->size = _position;
+    g_bytesWritten += n;
+    g_writeCalls++;
+    return n;
+}
+
+bool File::seek(uint32_t position) {
+    if (!_entry || position > _entry->size) return false;
+    _position = position;
+    return true;
+}
+
+size_t File::size() const {
+    return _entry ? _entry->size : 0;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char*, uint8_t, const char*) {
+    if (g_mountFailure) {
+        if (!formatOnFail) return false;
+        for (HostFileEntry& entry : g_files) entry.used = false;
+        g_mountFailure = false;
+    }
+    return true;
+}
+
+File LittleFSFS::open(const char* path, const char* mode, bool create) {
+    HostFileEntry* entry = find(path);
+    bool update = mode[1] == '+';
+    switch (mode[0]) {
+        case 'r':
+            if (!entry) return File();
+            return File(entry, 0, update);
+        case 'w':
+            if (!entry) entry = ::create(path);
+            if (!entry) return File();
+            entry->size = 0;
+            return File(entry, 0, true);
+        case 'a':
+            if (!entry) entry = ::create(path);
+            if (!entry) return File();
+            return File(entry, entry->size, true);
+    }
+    (void)create;
+    return File();
+}
+
+bool LittleFSFS::exists(const char* path) {
+    return find(path) != nullptr;
+}
+
+bool LittleFSFS::remove(const char* path) {
+    HostFileEntry* entry = find(path);
+    if (!entry) return false;
+    entry->used = false;
+    return true;
+}
+
+bool LittleFSFS::rename(const char* from, const char* to) {
+    HostFileEntry* entry = find(from);
+    if (!entry || find(to) || strlen(to) >= sizeof(entry->path)) return false;
+    strcpy(entry->path, to);
+    return true;
+}
+
+} // namespace fs
+
+namespace HostFlash {
+
+void reset() {
+    for (fs::HostFileEntry& entry : g_files) entry.used = false;
+    g_mountFailure = false;
+    g_bytesWritten = 0;
+    g_writeCalls = 0;
+}
+
+void setMountFailure(bool fail) { g_mountFailure = fail; }
+uint64_t bytesWritten() { return g_bytesWritten; }
+uint32_t writeCalls() { return g_writeCalls; }
+
+} // namespace HostFlash
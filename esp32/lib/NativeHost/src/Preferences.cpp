@@ -0,0 +1,209 @@
+#include "Preferences.h"
+#include <string.h>
+
+namespace {
+    const uint32_t ENTRY_BYTES = 32;
+    const uint32_t ENTRIES_PER_PAGE = 126;
+
+    struct Entry {
+        bool used;
+        bool integer;
+        char ns[16];
+        char key[16];
+        size_t length;
+        uint8_t data[HOST_NVS_BLOB_SIZE];
+        uint8_t page;           // onde estão as entradas na flash
+        uint8_t span;
+    };
+
+    struct Page {
+        uint32_t used;          // entradas gravadas desde o último apagamento
+        uint32_t live;          // das quais ainda valem
+        uint32_t erases;
+    };
+
+    Entry g_entries[HOST_NVS_MAX_ENTRIES];
+    uint32_t g_writeCalls = 0;
+    uint64_t g_bytesWritten = 0;
+
+    Page g_pages[HOST_NVS_PAGES];
+    uint8_t g_head = 0;
+    uint64_t g_flashEntries = 0;
+
+    bool validName(const char* name) {
+        return name && name[0] && strlen(name) < 16;
+    }
+
+    Entry* find(const char* ns, const char* key) {
+        for (Entry& entry : g_entries) {
+            if (entry.used && strcmp(entry.ns, ns) == 0 && strcmp(entry.key, key) == 0) return &entry;
+        }
+        return nullptr;
+    }
+
+    uint8_t spanOf(const Entry& entry) {
+        if (entry.integer) return 1;
+        return uint8_t(2 + (entry.length + ENTRY_BYTES - 1) / ENTRY_BYTES);
+    }
+
+    void release(const Entry& entry) {
+        g_pages[entry.page].live -= entry.span;
+    }
+
+    void place(Entry& entry, uint8_t span);
+
+    // A página ativa encheu: a escrita passa para a seguinte (apagada) e a
+    // próxima dela é liberada, copiando o que ainda vale
+    void advance() {
+        g_head = uint8_t((g_head + 1) % HOST_NVS_PAGES);
+        uint8_t spare = uint8_t((g_head + 1) % HOST_NVS_PAGES);
+        if (g_pages[spare].used == 0) return;
+        for (Entry& entry : g_entries) {
+            if (entry.used && entry.page == spare) {
+                g_pages[spare].live -= entry.span;
+                place(entry, entry.span);
+            }
+        }
+        g_pages[spare].used = 0;
+        g_pages[spare].live = 0;
+        g_pages[spare].erases++;
+    }
+
+    void place(Entry& entry, uint8_t span) {
+        if (g_pages[g_head].used + span > ENTRIES_PER_PAGE) advance();
+        entry.page = g_head;
+        entry.span = span;
+        g_pages[g_head].used += span;
+        g_pages[g_head].live += span;
+        g_flashEntries += span;
+    }
+
+    Entry* slotFor(const char* ns, const char* key) {
+        Entry* entry = find(ns, key);
+        if (entry) {
+            release(*entry);
+            return entry;
+        }
+        for (Entry& candidate : g_entries) {
+            if (!candidate.used) {
+                candidate.used = true;
+                strcpy(candidate.ns, ns);
+                strcpy(candidate.key, key);
+                return &candidate;
+            }
+        }
+        return nullptr;
+    }
+
+    void store(Entry& entry, bool integer, const void* value, size_t length) {
+        memcpy(entry.data, value, length);
+        entry.length = length;
+        entry.integer = integer;
+        place(entry, spanOf(entry));
+        g_writeCalls++;
+        g_bytesWritten += length;
+    }
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char*) {
+    if (!validName(name)) return false;
+    strcpy(_namespace, name);
+    _readOnly = readOnly;
+    _open = true;
+    return true;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!_open || _readOnly || !validName(key) || !value || length == 0 || length > HOST_NVS_BLOB_SIZE) {
+        return 0;
+    }
+    Entry* entry = slotFor(_namespace, key);
+    if (!entry) return 0;
+    store(*entry, false, value, length);
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    Entry* entry = _open && validName(key) ? find(_namespace, key) : nullptr;
+    return entry && !entry->integer ? entry->length : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    Entry* entry = _open && validName(key) ? find(_namespace, key) : nullptr;
+    if (!entry || entry->integer || !buffer || entry->length > maxLength) return 0;
+    memcpy(buffer, entry->data, entry->length);
+    return entry->length;
+}
+
+size_t Preferences::putULong64(const char* key, uint64_t value) {
+    if (!_open || _readOnly || !validName(key)) return 0;
+    Entry* entry = slotFor(_namespace, key);
+    if (!entry) return 0;
+    store(*entry, true, &value, sizeof(value));
+    return sizeof(value);
+}
+
+// Como na NVS, o tipo faz parte da chave: um blob não é lido como inteiro
+uint64_t Preferences::getULong64(const char* key, uint64_t defaultValue) {
+    Entry* entry = _open && validName(key) ? find(_namespace, key) : nullptr;
+    if (!entry || !entry->integer) return defaultValue;
+    uint64_t value;
+    memcpy(&value, entry->data, sizeof(value));
+    return value;
+}
+
+bool Preferences::isKey(const char* key) {
+    return _open && validName(key) && find(_namespace, key) != nullptr;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_open || _readOnly || !validName(key)) return false;
+    Entry* entry = find(_namespace, key);
+    if (entry) {
+        release(*entry);
+        entry->used = false;
+    }
+    return entry != nullptr;
+}
+
+bool Preferences::clear() {
+    if (!_open || _readOnly) return false;
+    for (Entry& entry : g_entries) {
+        if (entry.used && strcmp(entry.ns, _namespace) == 0) {
+            release(entry);
+            entry.used = false;
+        }
+    }
+    return true;
+}
+
+namespace HostNvs {
+
+void reset() {
+    for (Entry& entry : g_entries) entry.used = false;
+    for (Page& page : g_pages) page = Page{};
+    g_head = 0;
+    g_flashEntries = 0;
+    g_writeCalls = 0;
+    g_bytesWritten = 0;
+}
+
+uint32_t writeCalls() { return g_writeCalls; }
+uint64_t bytesWritten() { return g_bytesWritten; }
+uint64_t flashBytesWritten() { return g_flashEntries * ENTRY_BYTES; }
+
+uint32_t pageErases() {
+    uint32_t total = 0;
+    for (const Page& page : g_pages) total += page.erases;
+    return total;
+}
+
+uint32_t maxPageErases() {
+    uint32_t most = 0;
+    for (const Page& page : g_pages) {
+        if (page.erases > most) most = page.erases;
+    }
+    return most;
+}
+
+} // namespace HostNvs
@@ -0,0 +1,376 @@
+#include "PubSubClient.h"
+#include <chrono>
+#include <thread>
+
+// Cabeçalho fixo + comprimento do tópico, como em PubSubClient::publish
+static const unsigned int MQTT_PUBLISH_OVERHEAD = 5 + 2;
+
+PubSubClient::PubSubClient()
+    : _client(nullptr),
+      callback(nullptr),
+      _domain(nullptr),
+      _port(0),
+      _bufferSize(MQTT_MAX_PACKET_SIZE),
+      _keepAlive(15),
+      _socketTimeout(15),
+      _state(MQTT_DISCONNECTED),
+      _attached(false),
+      _wire(false),
+      _packetId(0),
+      _lastOutbound(0),
+      _lastInbound(0),
+      _pingOutstanding(false),
+      _rxLength(0),
+      _rxSkip(0),
+      _inboxHead(0),
+      _inboxCount(0) {
+}
+
+PubSubClient::PubSubClient(Client& client) : PubSubClient() {
+    _client = &client;
+}
+
+PubSubClient::~PubSubClient() {
+    disconnect();
+}
+
+PubSubClient& PubSubClient::setServer(const char* domain, uint16_t port) {
+    _domain = domain;
+    _port = port;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    this->callback = callback;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setClient(Client& client) {
+    _client = &client;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t keepAlive) {
+    _keepAlive = keepAlive;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setSocketTimeout(uint16_t timeout) {
+    _socketTimeout = timeout;
+    return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0 || size > FAKE_BROKER_PAYLOAD_SIZE + FAKE_BROKER_TOPIC_SIZE) {
+        return false;
+    }
+    _bufferSize = size;
+    return true;
+}
+
+boolean PubSubClient::connect(const char* id) {
+    return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr);
+}
+
+boolean PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    return connect(id, user, pass, nullptr, 0, false, nullptr);
+}
+
+boolean PubSubClient::connect(const char* id, const char* user, const char* pass,
+                              const char* willTopic, uint8_t willQos, boolean willRetain,
+                              const char* willMessage) {
+    (void)willTopic;
+    (void)willQos;
+    (void)willRetain;
+    (void)willMessage;
+
+    if (connected()) {
+        return true;
+    }
+
+    // Como no PubSubClient real, reaproveita um socket já aberto pelo chamador
+    bool socket = _client && (_client->connected() || _client->connect(_domain, _port));
+    _wire = WiFi.hostRealNetwork();
+    if (_wire) {
+        if (!socket || !connectWire(id, user, pass)) {
+            if (_client) _client->stop();
+            return false;
+        }
+    } else if (!socket || !FakeBroker::instance().isReachable() || !FakeBroker::instance().attach(this)) {
+        _state = MQTT_CONNECTION_TIMEOUT;
+        return false;
+    }
+    _attached = true;
+    _state = MQTT_CONNECTED;
+    return true;
+}
+
+// CONNECT e espera bloqueante pelo CONNACK, limitada pelo socket timeout
+bool PubSubClient::connectWire(const char* id, const char* user, const char* pass) {
+    _rxLength = 0;
+    _rxSkip = 0;
+    _pingOutstanding = false;
+    size_t length = HostMqttWire::connectPacket(_tx, sizeof(_tx), id, user, pass, _keepAlive);
+    if (!length || !writeWire(_tx, length)) {
+        _state = MQTT_CONNECT_FAILED;
+        return false;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(_socketTimeout);
+    while (_rxLength < 4) {
+        int n = _client->read(_rx + _rxLength, 4 - _rxLength);
+        if (n < 0) {
+            _state = MQTT_CONNECTION_LOST;
+            return false;
+        }
+        _rxLength += size_t(n);
+        if (n == 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                _state = MQTT_CONNECTION_TIMEOUT;
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    _rxLength = 0;
+    if (_rx[0] != HostMqttWire::CONNACK << 4 || _rx[1] != 2) {
+        _state = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    // Código de retorno do CONNACK (1 a 5), como no PubSubClient real
+    if (_rx[3] != 0) {
+        _state = _rx[3];
+        return false;
+    }
+    _lastInbound = millis();
+    return true;
+}
+
+bool PubSubClient::writeWire(const uint8_t* packet, size_t length) {
+    if (_client->write(packet, length) != length) {
+        return false;
+    }
+    _lastOutbound = millis();
+    return true;
+}
+
+// Lê tudo o que chegou e entrega cada PUBLISH ao callback
+bool PubSubClient::serviceWire() {
+    for (;;) {
+        size_t offset = 0;
+        while (_rxLength - offset >= 2) {
+            size_t available = _rxLength - offset;
+            uint32_t remaining = 0;
+            int lengthBytes = HostMqttWire::decodeLength(_rx + offset + 1, available - 1, remaining);
+            if (lengthBytes < 0) return false;
+            if (lengthBytes == 0) break;
+            size_t total = 1 + size_t(lengthBytes) + remaining;
+            if (total > sizeof(_rx)) {
+                // Maior que o buffer: descartado, como no PubSubClient real
+                _rxSkip = total - available;
+                offset = _rxLength;
+                break;
+            }
+            if (available < total) break;
+            handleWirePacket(_rx[offset], _rx + offset + 1 + lengthBytes, remaining);
+            offset += total;
+        }
+        memmove(_rx, _rx + offset, _rxLength - offset);
+        _rxLength -= offset;
+
+        int n = _client->read(_rx + _rxLength, sizeof(_rx) - _rxLength);
+        if (n < 0) return false;
+        if (n == 0) return true;
+        _lastInbound = millis();
+        _rxLength += size_t(n);
+        if (_rxSkip) {
+            size_t drop = _rxSkip < _rxLength ? _rxSkip : _rxLength;
+            memmove(_rx, _rx + drop, _rxLength - drop);
+            _rxLength -= drop;
+            _rxSkip -= drop;
+        }
+    }
+}
+
+void PubSubClient::handleWirePacket(uint8_t header, const uint8_t* body, size_t length) {
+    uint8_t type = header >> 4;
+    if (type == HostMqttWire::PINGRESP) {
+        _pingOutstanding = false;
+    } else if (type == HostMqttWire::PUBLISH) {
+        const char* topic = nullptr;
+        size_t topicLength = 0;
+        const uint8_t* payload = nullptr;
+        size_t payloadLength = 0;
+        if (!HostMqttWire::parsePublish(header & 0x0F, body, length, topic, topicLength, payload, payloadLength)
+            || topicLength >= sizeof(_deliverTopic)) {
+            return;
+        }
+        char terminated[FAKE_BROKER_TOPIC_SIZE];
+        memcpy(terminated, topic, topicLength);
+        terminated[topicLength] = '\0';
+        hostDeliver(terminated, payload, unsigned(payloadLength));
+    }
+    // CONNACK, SUBACK e UNSUBACK não pedem nada com QoS 0
+}
+
+// PINGREQ depois de um keepalive calado; sem PINGRESP em mais um, caiu
+bool PubSubClient::keepWireAlive() {
+    unsigned long now = millis();
+    unsigned long keepAliveMs = _keepAlive * 1000UL;
+    if (!keepAliveMs) return true;
+    if (now - _lastInbound > keepAliveMs || now - _lastOutbound > keepAliveMs) {
+        if (_pingOutstanding) {
+            _state = MQTT_CONNECTION_TIMEOUT;
+            return false;
+        }
+        uint8_t ping[2];
+        if (!writeWire(ping, HostMqttWire::emptyPacket(ping, HostMqttWire::PINGREQ))) return false;
+        _pingOutstanding = true;
+        _lastInbound = now;
+    }
+    return true;
+}
+
+uint16_t PubSubClient::nextPacketId() {
+    if (++_packetId == 0) _packetId = 1;
+    return _packetId;
+}
+
+void PubSubClient::disconnect() {
+    if (_attached && _wire) {
+        uint8_t packet[2];
+        writeWire(packet, HostMqttWire::emptyPacket(packet, HostMqttWire::DISCONNECT));
+    } else if (_attached) {
+        FakeBroker::instance().detach(this);
+    }
+    _attached = false;
+    if (_client) {
+        _client->stop();
+    }
+    _inboxCount = 0;
+    _state = MQTT_DISCONNECTED;
+}
+
+boolean PubSubClient::connected() {
+    if (!_attached) {
+        return false;
+    }
+    if (_wire) {
+        if (!_client->connected()) {
+            _attached = false;
+            _state = MQTT_CONNECTION_LOST;
+            return false;
+        }
+        return true;
+    }
+    if (WiFi.status() != WL_CONNECTED || !FakeBroker::instance().isReachable()) {
+        disconnect();
+        _state = MQTT_CONNECTION_LOST;
+        return false;
+    }
+    return true;
+}
+
+boolean PubSubClient::publish(const char* topic, const char* payload) {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload), payload ? strlen(payload) : 0, false);
+}
+
+boolean PubSubClient::publish(const char* topic, const char* payload, boolean retained) {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload), payload ? strlen(payload) : 0, retained);
+}
+
+boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength) {
+    return publish(topic, payload, plength, false);
+}
+
+boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
+    if (!connected() || !topic) {
+        return false;
+    }
+    if (MQTT_PUBLISH_OVERHEAD + strlen(topic) + plength > _bufferSize) {
+        return false;
+    }
+    if (_wire) {
+        size_t length = HostMqttWire::publishPacket(_tx, sizeof(_tx), topic, payload, plength, retained);
+        return length && writeWire(_tx, length);
+    }
+    return FakeBroker::instance().publish(topic, payload, plength, retained);
+}
+
+boolean PubSubClient::subscribe(const char* topic) {
+    return subscribe(topic, 0);
+}
+
+boolean PubSubClient::subscribe(const char* topic, uint8_t qos) {
+    (void)qos;
+    if (!connected() || !topic) {
+        return false;
+    }
+    if (_wire) {
+        size_t length = HostMqttWire::subscribePacket(_tx, sizeof(_tx), nextPacketId(), topic);
+        return length && writeWire(_tx, length);
+    }
+    return FakeBroker::instance().subscribe(this, topic);
+}
+
+boolean PubSubClient::unsubscribe(const char* topic) {
+    if (!connected() || !topic) {
+        return false;
+    }
+    if (_wire) {
+        size_t length = HostMqttWire::unsubscribePacket(_tx, sizeof(_tx), nextPacketId(), topic);
+        return length && writeWire(_tx, length);
+    }
+    return FakeBroker::instance().unsubscribe(this, topic);
+}
+
+boolean PubSubClient::loop() {
+    if (!connected()) {
+        return false;
+    }
+    if (_wire) {
+        if (!serviceWire() || !keepWireAlive()) {
+            int state = _state == MQTT_CONNECTION_TIMEOUT ? _state : MQTT_CONNECTION_LOST;
+            _attached = false;
+            _client->stop();
+            _state = state;
+            return false;
+        }
+        return true;
+    }
+    while (_inboxCount > 0) {
+        FakeMessage& message = _inbox[_inboxHead];
+        _inboxHead = (_inboxHead + 1) % FAKE_CLIENT_INBOX_SIZE;
+        _inboxCount--;
+        hostDeliver(message.topic, message.payload, message.length);
+    }
+    return true;
+}
+
+bool PubSubClient::hostEnqueue(const char* topic, const uint8_t* payload, unsigned int length) {
+    if (_inboxCount >= FAKE_CLIENT_INBOX_SIZE || length > FAKE_BROKER_PAYLOAD_SIZE) {
+        return false;
+    }
+    FakeMessage& slot = _inbox[(_inboxHead + _inboxCount) % FAKE_CLIENT_INBOX_SIZE];
+    strncpy(slot.topic, topic, sizeof(slot.topic) - 1);
+    slot.topic[sizeof(slot.topic) - 1] = '\0';
+    memcpy(slot.payload, payload, length);
+    slot.payload[length] = 0;
+    slot.length = length;
+    slot.retained = false;
+    slot.timestampUs = HostClock::nowMicros();
+    _inboxCount++;
+    return true;
+}
+
+void PubSubClient::hostDeliver(const char* topic, const uint8_t* payload, unsigned int length) {
+    if (!callback || length > FAKE_BROKER_PAYLOAD_SIZE) {
+        return;
+    }
+    // O PubSubClient real entrega tópico e payload apontando para o próprio
+    // buffer interno; copiamos para buffers do cliente pelo mesmo motivo.
+    strncpy(_deliverTopic, topic, sizeof(_deliverTopic) - 1);
+    _deliverTopic[sizeof(_deliverTopic) - 1] = '\0';
+    memmove(_deliverPayload, payload, length);
+    callback(_deliverTopic, _deliverPayload, length);
+}
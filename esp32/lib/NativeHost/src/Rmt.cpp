@@ -0,0 +1,284 @@
+#include "driver/rmt.h"
+#include "HostClock.h"
+#include "HostDht22.h"
+
+// Temporizações NEC, com a tolerância de um receptor comum
+static const uint32_t NEC_HDR_MARK = 9000;
+static const uint32_t NEC_HDR_SPACE = 4500;
+static const uint32_t NEC_BIT_MARK = 560;
+static const uint32_t NEC_ONE_SPACE = 1690;
+static const uint32_t NEC_ZERO_SPACE = 560;
+static const uint32_t NEC_BITS = 32;
+
+// Itens por bloco de memória do RMT; a recepção só guarda os blocos do canal
+static const size_t ITEMS_PER_BLOCK = 64;
+static const size_t RX_CAPACITY = 8 * ITEMS_PER_BLOCK;
+
+namespace {
+    struct Channel {
+        bool configured;
+        bool installed;
+        rmt_mode_t mode;
+        uint8_t pin;
+        uint8_t memBlocks;          // blocos de 64 itens: do canal até canal + memBlocks - 1
+        uint8_t clkDiv;
+        uint16_t khz;
+        uint64_t busyUntilUs;
+        uint16_t idleThreshold;
+
+        // Recepção: um quadro por rmt_rx_start, liberado em rxReadyUs
+        bool rxRunning;
+        bool rxPending;
+        uint64_t rxReadyUs;
+        size_t rxCount;
+        rmt_item32_t rxItems[RX_CAPACITY];
+
+        size_t rxCapacity() const {
+            return memBlocks * ITEMS_PER_BLOCK < RX_CAPACITY ? memBlocks * ITEMS_PER_BLOCK : RX_CAPACITY;
+        }
+    };
+
+    Channel g_channels[RMT_CHANNEL_MAX];
+    uint32_t g_overlaps = 0;
+
+    bool near(uint32_t value, uint32_t expected) {
+        uint32_t tolerance = expected / 4;
+        return value + tolerance >= expected && value <= expected + tolerance;
+    }
+
+    // Reconhece cabeçalho + 32 bits + marca final; falha em qualquer desvio
+    bool decodeNEC(const rmt_item32_t* items, int count, uint32_t& data) {
+        if (count != int(NEC_BITS) + 2) return false;
+        if (!items[0].level0 || !near(items[0].duration0, NEC_HDR_MARK) || !near(items[0].duration1, NEC_HDR_SPACE)) {
+            return false;
+        }
+        data = 0;
+        for (uint32_t i = 1; i <= NEC_BITS; i++) {
+            if (!near(items[i].duration0, NEC_BIT_MARK)) return false;
+            if (near(items[i].duration1, NEC_ONE_SPACE)) {
+                data = (data << 1) | 1;
+            } else if (near(items[i].duration1, NEC_ZERO_SPACE)) {
+                data <<= 1;
+            } else {
+                return false;
+            }
+        }
+        return near(items[NEC_BITS + 1].duration0, NEC_BIT_MARK);
+    }
+}
+
+esp_err_t rmt_config(const rmt_config_t* config) {
+    if (!config || config->channel >= RMT_CHANNEL_MAX || config->clk_div == 0
+        || config->mem_block_num == 0 || config->channel + config->mem_block_num > RMT_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    Channel& channel = g_channels[config->channel];
+    channel.configured = true;
+    channel.mode = config->rmt_mode;
+    channel.pin = uint8_t(config->gpio_num);
+    channel.memBlocks = config->mem_block_num;
+    channel.clkDiv = config->clk_div;
+    if (config->rmt_mode == RMT_MODE_TX) {
+        channel.khz = config->tx_config.carrier_en ? uint16_t(config->tx_config.carrier_freq_hz / 1000) : 0;
+    } else {
+        channel.khz = 0;
+        channel.idleThreshold = config->rx_config.idle_threshold;
+    }
+    channel.busyUntilUs = 0;
+    channel.rxRunning = channel.rxPending = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int) {
+    if (channel >= RMT_CHANNEL_MAX || !g_channels[channel].configured) return ESP_ERR_INVALID_STATE;
+    if (g_channels[channel].installed) return ESP_ERR_INVALID_STATE;
+    // O ESP-IDF aceitaria e os dois canais corromperiam os quadros um do
+    // outro; aqui a sobreposição da memória falha na instalação
+    for (int other = 0; other < RMT_CHANNEL_MAX; other++) {
+        const Channel& installed = g_channels[other];
+        if (other != channel && installed.installed && other < channel + g_channels[channel].memBlocks
+            && channel < other + installed.memBlocks) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    // Como no ESP-IDF, recepção sem ring buffer não tem para onde entregar
+    if (g_channels[channel].mode == RMT_MODE_RX && rx_buf_size == 0) return ESP_ERR_INVALID_ARG;
+    g_channels[channel].installed = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel) {
+    // Como no ESP-IDF, desinstalar um canal livre não é erro
+    if (channel >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    g_channels[channel].installed = false;
+    g_channels[channel].rxRunning = g_channels[channel].rxPending = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_set_tx_carrier(rmt_channel_t channel, bool carrier_en, uint16_t high_level,
+                             uint16_t low_level, rmt_carrier_level_t) {
+    if (channel >= RMT_CHANNEL_MAX || uint32_t(high_level) + low_level == 0) return ESP_ERR_INVALID_ARG;
+    uint32_t period = uint32_t(high_level) + low_level;
+    g_channels[channel].khz = carrier_en ? uint16_t((80000UL + period / 2) / period) : 0;
+    return ESP_OK;
+}
+
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t* items, int count, bool wait_tx_done) {
+    if (channel >= RMT_CHANNEL_MAX || !items || count <= 0) return ESP_ERR_INVALID_ARG;
+    Channel& ch = g_channels[channel];
+    if (!ch.installed || ch.mode != RMT_MODE_TX) return ESP_ERR_INVALID_STATE;
+
+    uint64_t now = HostClock::nowMicros();
+    if (now < ch.busyUntilUs) {
+        // O driver real esperaria o quadro anterior; aqui é um erro do chamador
+        g_overlaps++;
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Duração zero encerra a transmissão, como no hardware
+    uint32_t ticks = 0;
+    uint16_t durations = 0;
+    for (int i = 0; i < count; i++) {
+        ticks += items[i].duration0;
+        durations++;
+        if (items[i].duration0 == 0) break;
+        if (items[i].duration1 == 0) break;
+        ticks += items[i].duration1;
+        durations++;
+    }
+    uint32_t durationUs = uint32_t(uint64_t(ticks) * ch.clkDiv / 80);
+
+    // Forma de onda em µs, para comparar com o que o controle remoto enviaria
+    uint16_t pulses[2 * RX_CAPACITY];
+    uint16_t length = 0;
+    for (int i = 0; i < count && length + 2 <= int(sizeof(pulses) / sizeof(pulses[0])); i++) {
+        if (items[i].duration0 == 0) break;
+        pulses[length++] = uint16_t(uint32_t(items[i].duration0) * ch.clkDiv / 80);
+        if (items[i].duration1 == 0) break;
+        pulses[length++] = uint16_t(uint32_t(items[i].duration1) * ch.clkDiv / 80);
+    }
+    HostIRLog::recordPulses(pulses, length);
+
+    HostIRFrame frame;
+    frame.timestampUs = now;
+    frame.durationUs = durationUs;
+    frame.khz = ch.khz;
+    frame.pin = ch.pin;
+    if (ch.clkDiv == 80 && decodeNEC(items, count, frame.data)) {
+        frame.bits = NEC_BITS;
+        frame.protocol = HostIRProtocol::NEC;
+    } else {
+        frame.data = 0;
+        frame.bits = durations;
+        frame.protocol = HostIRProtocol::RAW;
+    }
+    HostIRLog::record(frame);
+
+    ch.busyUntilUs = now + durationUs;
+    if (wait_tx_done) HostClock::advanceMicros(durationUs);
+    return ESP_OK;
+}
+
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time) {
+    if (channel >= RMT_CHANNEL_MAX || !g_channels[channel].installed) return ESP_ERR_INVALID_STATE;
+    uint64_t now = HostClock::nowMicros();
+    uint64_t busyUntil = g_channels[channel].busyUntilUs;
+    if (now >= busyUntil) return ESP_OK;
+    if (wait_time == 0) return ESP_ERR_TIMEOUT;
+    HostClock::advanceMicros(busyUntil - now);
+    return ESP_OK;
+}
+
+esp_err_t rmt_set_gpio(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t gpio_num, bool) {
+    if (channel >= RMT_CHANNEL_MAX || mode != g_channels[channel].mode) return ESP_ERR_INVALID_ARG;
+    g_channels[channel].pin = uint8_t(gpio_num);
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool) {
+    if (channel >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    Channel& ch = g_channels[channel];
+    if (!ch.installed || ch.mode != RMT_MODE_RX) return ESP_ERR_INVALID_STATE;
+
+    // A captura termina após idle_threshold ticks sem transição
+    uint32_t responseUs = 0;
+    ch.rxRunning = true;
+    ch.rxCount = HostDht22::respond(ch.pin, ch.rxItems, ch.rxCapacity(), responseUs);
+    ch.rxPending = ch.rxCount > 0;
+    ch.rxReadyUs = HostClock::nowMicros() + responseUs + uint64_t(ch.idleThreshold) * ch.clkDiv / 80;
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_stop(rmt_channel_t channel) {
+    if (channel >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    g_channels[channel].rxRunning = false;
+    g_channels[channel].rxPending = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t* buf_handle) {
+    if (channel >= RMT_CHANNEL_MAX || !buf_handle) return ESP_ERR_INVALID_ARG;
+    if (!g_channels[channel].installed || g_channels[channel].mode != RMT_MODE_RX) return ESP_ERR_INVALID_STATE;
+    *buf_handle = &g_channels[channel];
+    return ESP_OK;
+}
+
+// Os únicos ring buffers do host são os de recepção do RMT
+void* xRingbufferReceive(RingbufHandle_t ringbuf, size_t* item_size, TickType_t) {
+    Channel* ch = static_cast<Channel*>(ringbuf);
+    if (!ch || !ch->rxRunning || !ch->rxPending || HostClock::nowMicros() < ch->rxReadyUs) {
+        return nullptr;
+    }
+    ch->rxPending = false;
+    if (item_size) *item_size = ch->rxCount * sizeof(rmt_item32_t);
+    return ch->rxItems;
+}
+
+void vRingbufferReturnItem(RingbufHandle_t, void*) {
+}
+
+bool hostRmtPress(uint8_t pin, const uint16_t* durations, uint16_t count) {
+    for (Channel& ch : g_channels) {
+        if (!ch.installed || ch.mode != RMT_MODE_RX || !ch.rxRunning || ch.pin != pin) continue;
+
+        // Saída ativa em baixo: marca = nível 0. O último item termina com
+        // duração zero, o fim por idle_threshold.
+        uint32_t durationUs = 0;
+        size_t items = 0;
+        for (uint16_t i = 0; i < count && items < ch.rxCapacity(); i += 2) {
+            rmt_item32_t& item = ch.rxItems[items++];
+            uint16_t space = i + 1 < count ? durations[i + 1] : 0;
+            item.level0 = 0;
+            item.duration0 = uint32_t(durations[i]) * 80 / ch.clkDiv;
+            item.level1 = 1;
+            item.duration1 = uint32_t(space) * 80 / ch.clkDiv;
+            durationUs += uint32_t(durations[i]) + space;
+        }
+        if (items) ch.rxItems[items - 1].duration1 = 0;
+        ch.rxCount = items;
+        ch.rxPending = items > 0;
+        ch.rxReadyUs = HostClock::nowMicros() + durationUs + uint64_t(ch.idleThreshold) * ch.clkDiv / 80;
+        return ch.rxPending;
+    }
+    return false;
+}
+
+void hostRmtReset() {
+    for (Channel& channel : g_channels) {
+        channel.configured = channel.installed = false;
+        channel.mode = RMT_MODE_TX;
+        channel.pin = 0;
+        channel.memBlocks = 1;
+        channel.clkDiv = 80;
+        channel.khz = 0;
+        channel.busyUntilUs = 0;
+        channel.idleThreshold = 0;
+        channel.rxRunning = channel.rxPending = false;
+        channel.rxCount = 0;
+    }
+    g_overlaps = 0;
+}
+
+uint32_t hostRmtOverlaps() {
+    return g_overlaps;
+}
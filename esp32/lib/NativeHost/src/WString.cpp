@@ -0,0 +1,232 @@
+#include "WString.h"
+#include "HostAlloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+String::String(const char* cstr) : _buffer(nullptr), _capacity(0), _len(0) {
+    if (cstr) {
+        copy(cstr, strlen(cstr));
+    }
+}
+
+String::String(const char* cstr, size_t length) : _buffer(nullptr), _capacity(0), _len(0) {
+    if (cstr) {
+        copy(cstr, length);
+    }
+}
+
+String::String(const String& other) : _buffer(nullptr), _capacity(0), _len(0) {
+    *this = other;
+}
+
+String::String(String&& other) noexcept
+    : _buffer(other._buffer), _capacity(other._capacity), _len(other._len) {
+    other._buffer = nullptr;
+    other._capacity = 0;
+    other._len = 0;
+}
+
+String::String(char c) : _buffer(nullptr), _capacity(0), _len(0) {
+    char buf[2] = {c, 0};
+    copy(buf, 1);
+}
+
+String::String(int value, unsigned char base) : String(long(value), base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) : _buffer(nullptr), _capacity(0), _len(0) {
+    char buf[2 + 8 * sizeof(long)];
+    if (base == 10) {
+        snprintf(buf, sizeof(buf), "%ld", value);
+    } else {
+        snprintf(buf, sizeof(buf), base == 16 ? "%lx" : "%lo", value);
+    }
+    copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base) : _buffer(nullptr), _capacity(0), _len(0) {
+    char buf[1 + 8 * sizeof(unsigned long)];
+    snprintf(buf, sizeof(buf), base == 16 ? "%lx" : (base == 8 ? "%lo" : "%lu"), value);
+    copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned int decimalPlaces) : String(double(value), decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces) : _buffer(nullptr), _capacity(0), _len(0) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    copy(buf, strlen(buf));
+}
+
+String::~String() {
+    HostAlloc::release(_buffer);
+}
+
+String& String::operator=(const String& rhs) {
+    if (this == &rhs) return *this;
+    if (rhs._buffer) {
+        copy(rhs._buffer, rhs._len);
+    } else {
+        invalidate();
+    }
+    return *this;
+}
+
+String& String::operator=(String&& rhs) noexcept {
+    if (this != &rhs) {
+        HostAlloc::release(_buffer);
+        _buffer = rhs._buffer;
+        _capacity = rhs._capacity;
+        _len = rhs._len;
+        rhs._buffer = nullptr;
+        rhs._capacity = 0;
+        rhs._len = 0;
+    }
+    return *this;
+}
+
+String& String::operator=(const char* cstr) {
+    if (cstr) {
+        copy(cstr, strlen(cstr));
+    } else {
+        invalidate();
+    }
+    return *this;
+}
+
+bool String::reserve(unsigned int size) {
+    if (_buffer && _capacity >= size) return true;
+    if (grow(size)) {
+        if (_len == 0) _buffer[0] = 0;
+        return true;
+    }
+    return false;
+}
+
+bool String::grow(unsigned int size) {
+    char* newBuffer = static_cast<char*>(HostAlloc::reallocate(_buffer, size + 1));
+    if (!newBuffer) return false;
+    _buffer = newBuffer;
+    _capacity = size;
+    return true;
+}
+
+void String::invalidate() {
+    HostAlloc::release(_buffer);
+    _buffer = nullptr;
+    _capacity = 0;
+    _len = 0;
+}
+
+String& String::copy(const char* cstr, unsigned int length) {
+    if (!reserve(length)) {
+        invalidate();
+        return *this;
+    }
+    _len = length;
+    memmove(_buffer, cstr, length);
+    _buffer[length] = 0;
+    return *this;
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+    unsigned int newLen = _len + length;
+    if (!cstr) return false;
+    if (length == 0) return true;
+    if (!reserve(newLen)) return false;
+    memmove(_buffer + _len, cstr, length);
+    _len = newLen;
+    _buffer[_len] = 0;
+    return true;
+}
+
+bool String::concat(const String& str) { return concat(str.c_str(), str._len); }
+bool String::concat(const char* cstr) { return cstr ? concat(cstr, strlen(cstr)) : false; }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+bool String::concat(float num) { return concat(String(num)); }
+bool String::concat(double num) { return concat(String(num)); }
+
+StringSumHelper& operator+(const StringSumHelper& lhs, const String& rhs) {
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+    a.concat(rhs);
+    return a;
+}
+
+StringSumHelper& operator+(const StringSumHelper& lhs, const char* cstr) {
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+    a.concat(cstr);
+    return a;
+}
+
+StringSumHelper& operator+(const StringSumHelper& lhs, char c) {
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+    a.concat(c);
+    return a;
+}
+
+#define HOST_STRING_SUM_NUMBER(type)                                         \
+    StringSumHelper& operator+(const StringSumHelper& lhs, type num) {      \
+        StringSumHelper& a = const_cast<StringSumHelper&>(lhs);             \
+        a.concat(num);                                                       \
+        return a;                                                            \
+    }
+
+HOST_STRING_SUM_NUMBER(int)
+HOST_STRING_SUM_NUMBER(unsigned int)
+HOST_STRING_SUM_NUMBER(long)
+HOST_STRING_SUM_NUMBER(unsigned long)
+HOST_STRING_SUM_NUMBER(float)
+HOST_STRING_SUM_NUMBER(double)
+
+#undef HOST_STRING_SUM_NUMBER
+
+bool String::equals(const String& other) const {
+    return _len == other._len && strcmp(c_str(), other.c_str()) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+    return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+char String::charAt(unsigned int index) const {
+    return index < _len ? _buffer[index] : 0;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+    if (fromIndex >= _len) return -1;
+    const char* found = strchr(_buffer + fromIndex, ch);
+    return found ? int(found - _buffer) : -1;
+}
+
+int String::indexOf(const char* str, unsigned int fromIndex) const {
+    if (fromIndex >= _len) return -1;
+    const char* found = strstr(_buffer + fromIndex, str);
+    return found ? int(found - _buffer) : -1;
+}
+
+String String::substring(unsigned int beginIndex) const {
+    return substring(beginIndex, _len);
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) {
+        unsigned int tmp = endIndex;
+        endIndex = beginIndex;
+        beginIndex = tmp;
+    }
+    if (beginIndex >= _len) return String();
+    if (endIndex > _len) endIndex = _len;
+    return String(_buffer + beginIndex, endIndex - beginIndex);
+}
+
+long String::toInt() const {
+    return _buffer ? atol(_buffer) : 0;
+}
+
+float String::toFloat() const {
+    return _buffer ? float(atof(_buffer)) : 0.0f;
+}
@@ -0,0 +1,210 @@
+#include "WiFi.h"
+#include "FakeBroker.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+    return String(buf);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    return connect(host, port, -1);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    if (WiFi.hostRealNetwork()) {
+        stop();
+        if (WiFi.status() != WL_CONNECTED) return 0;
+        _socket = connectSocket(host, port, timeoutMs);
+        _connected = _socket >= 0;
+        return _connected ? 1 : 0;
+    }
+
+    FakeBroker& broker = FakeBroker::instance();
+    _connected = WiFi.status() == WL_CONNECTED && broker.isReachable();
+
+    // O handshake consome tempo virtual; uma falha só bloqueia até o timeout
+    uint32_t latencyMs = broker.connectLatencyMs(_connected);
+    if (timeoutMs >= 0 && latencyMs > uint32_t(timeoutMs)) {
+        latencyMs = uint32_t(timeoutMs);
+        _connected = false;
+    }
+    HostClock::advanceMillis(latencyMs);
+    return _connected ? 1 : 0;
+}
+
+// Connect sem bloqueio limitado pelo timeout (tempo real); o socket segue
+// sem bloqueio para read/available
+int WiFiClient::connectSocket(const char* host, uint16_t port, int32_t timeoutMs) {
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host, service, &hints, &addresses) != 0) return -1;
+
+    int fd = -1;
+    for (addrinfo* a = addresses; a && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int result = ::connect(fd, a->ai_addr, a->ai_addrlen);
+        if (result < 0 && errno == EINPROGRESS) {
+            pollfd p{fd, POLLOUT, 0};
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (poll(&p, 1, timeoutMs < 0 ? -1 : timeoutMs) == 1
+                && getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+                result = 0;
+            }
+        }
+        if (result < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd >= 0) {
+        // Comandos e status são pequenos: sem Nagle, como o lwIP do ESP32
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (_socket < 0) return 0;
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = send(_socket, buffer + sent, size - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += size_t(n);
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Buffer do kernel cheio: espera um pouco, como o write do lwIP
+            pollfd p{_socket, POLLOUT, 0};
+            if (poll(&p, 1, 1000) != 1) break;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            stop();
+            break;
+        }
+    }
+    return sent;
+}
+
+int WiFiClient::available() {
+    if (_socket < 0) return 0;
+    int pending = 0;
+    if (ioctl(_socket, FIONREAD, &pending) < 0) return 0;
+    return pending;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    if (_socket < 0) return -1;
+    ssize_t n = recv(_socket, buffer, size, MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        stop();
+        return -1;
+    }
+    return n < 0 ? 0 : int(n);
+}
+
+uint8_t WiFiClient::connected() {
+    if (_socket >= 0) {
+        // Fechado pelo broker: recv devolve 0 sem consumir nada com MSG_PEEK
+        uint8_t probe;
+        ssize_t n = recv(_socket, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            stop();
+        }
+    }
+    return _connected;
+}
+
+void WiFiClient::stop() {
+    if (_socket >= 0) {
+        close(_socket);
+        _socket = -1;
+    }
+    _connected = false;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+    (void)ssid;
+    (void)passphrase;
+    _beginCount++;
+    _connected = false;
+    _connecting = true;
+    _connectStartedUs = HostClock::nowMicros();
+    return status();
+}
+
+wl_status_t WiFiClass::status() {
+    if (_connected) {
+        return WL_CONNECTED;
+    }
+    if (!_connecting) {
+        return WL_DISCONNECTED;
+    }
+    if (!_available) {
+        return WL_NO_SSID_AVAIL;
+    }
+    if (HostClock::nowMicros() - _connectStartedUs >= uint64_t(_connectDelayMs) * 1000ULL) {
+        _connecting = false;
+        _connected = true;
+        return WL_CONNECTED;
+    }
+    return WL_IDLE_STATUS;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+    (void)wifiOff;
+    _connected = false;
+    _connecting = false;
+    return true;
+}
+
+bool WiFiClass::reconnect() {
+    begin(nullptr, nullptr);
+    return true;
+}
+
+IPAddress WiFiClass::localIP() const {
+    return _connected ? IPAddress(192, 168, 0, 42) : IPAddress();
+}
+
+void WiFiClass::hostSetNetworkAvailable(bool available) {
+    _available = available;
+    if (!available) {
+        hostDropConnection();
+    }
+}
+
+void WiFiClass::hostDropConnection() {
+    _connected = false;
+    _connecting = false;
+}
+
+void WiFiClass::hostReset() {
+    _realNetwork = false;
+    _available = true;
+    _connecting = false;
+    _connected = false;
+    _connectDelayMs = 0;
+    _connectStartedUs = 0;
+    _beginCount = 0;
+}
@@ -0,0 +1,24 @@
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <stdint.h>
+
+// Espera exponencial com jitter para novas tentativas de conexão.
+// O n-ésimo atraso é min(max, min * 2^n), sorteado entre metade e o valor
+// cheio para que centenas de dispositivos não reconectem em sincronia após
+// uma queda do broker. Não há limite de tentativas: o atraso satura em max.
+class Backoff {
+public:
+    Backoff(uint32_t minDelayMs, uint32_t maxDelayMs);
+
+    uint32_t next();
+    void reset();
+    uint16_t attempts() const { return _attempts; }
+
+private:
+    uint32_t _minDelay;
+    uint32_t _maxDelay;
+    uint16_t _attempts;
+};
+
+#endif // BACKOFF_H
@@ -0,0 +1,95 @@
+#ifndef COMMAND_TRACER_H
+#define COMMAND_TRACER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ACState.h"
+#include "CommandCodec.h"
+
+// "resultado" da confirmação: um código fixo por desfecho, nunca texto livre
+enum class CommandOutcome : uint8_t {
+    OK,
+    MALFORMED,
+    MISSING_VERB,
+    UNKNOWN_VERB,
+    INVALID_PARAMETER,
+    UNKNOWN_UNIT,       // .../comando/{n} sem a unidade n
+    QUEUE_FULL          // fila de comandos da tarefa de controle cheia
+};
+
+CommandOutcome commandOutcome(CommandParseResult result);
+const char* commandOutcomeCode(CommandOutcome outcome);
+
+// Rastreio dos comandos com "id" (MQTT.md, Confirmação de Comando): cada
+// etapa é marcada em micros() e a confirmação leva os tempos relativos à
+// chegada da mensagem, para o servidor separar o que foi do dispositivo do
+// que foi da rota da API e do broker.
+//
+//   chegada -> interpretação -> início do IR -> fim do IR
+//                            -> publicação do status
+//
+// Os comandos de uma unidade andam em ordem: o status e o fim do IR de um
+// comando valem também para os anteriores da mesma unidade que ainda não os
+// tinham (um quadro substituído na fila do IR sai no quadro do seguinte).
+// Uma confirmação sai quando as duas pontas chegaram ou depois de
+// TIMEOUT_US, com null no que faltou.
+//
+// Só a tarefa de rede usa; memória fixa, sem heap.
+class CommandTracer {
+public:
+    static const uint8_t SLOTS = 4;
+    static const uint32_t TIMEOUT_US = 10000000;
+    static const uint8_t NO_UNIT = 0xFF;        // unidade inexistente no tópico
+
+    CommandTracer();
+
+    // Número do rastreio para ACCommand::trace (nunca 0). Sem vaga, o mais
+    // antigo é descartado sem confirmação.
+    uint8_t open(const JsonSlice& id, uint8_t unit, uint32_t receivedUs, uint32_t parsedUs);
+    // Comando resolvido na própria tarefa de rede (rejeitado, FORMATO,
+    // AGENDA...): sem IR, respondido em nowUs
+    void settle(uint8_t trace, CommandOutcome outcome, uint32_t nowUs);
+    // O status que responde ao comando foi aceito pelo PubSubClient
+    void published(uint8_t trace, uint32_t nowUs);
+    // O IR do comando terminou (medido por quem transmite)
+    void transmitted(const CommandTiming& ir);
+
+    // Próxima confirmação pronta, em JSON; 0 se nenhuma. O rastreio é
+    // liberado mesmo que a publicação falhe (QoS 0, como o status).
+    size_t nextAck(uint32_t nowUs, char* buffer, size_t capacity);
+
+    uint8_t pending() const;
+    uint32_t dropped() const { return _dropped; }
+
+private:
+    enum : uint8_t {
+        OPEN = 0x01,
+        PUBLISHED = 0x02,
+        IR_DONE = 0x04,
+        IR_SENT = 0x08
+    };
+
+    struct Slot {
+        char id[COMMAND_ID_MAX + 1];
+        CommandOutcome outcome;
+        uint32_t sequence;
+        uint32_t receivedUs;
+        uint32_t parsedUs;
+        uint32_t publishedUs;
+        uint32_t irStartUs;
+        uint32_t irDoneUs;
+        uint8_t trace;
+        uint8_t unit;
+        uint8_t flags;
+    };
+
+    Slot* find(uint8_t trace);
+    size_t serialize(const Slot& slot, char* buffer, size_t capacity) const;
+
+    Slot _slots[SLOTS];
+    uint32_t _sequence;
+    uint8_t _nextTrace;
+    uint32_t _dropped;
+};
+
+#endif // COMMAND_TRACER_H
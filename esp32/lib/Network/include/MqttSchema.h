@@ -0,0 +1,62 @@
+#ifndef MQTT_SCHEMA_H
+#define MQTT_SCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include "CommandCodec.h"
+#include "LegacyCodec.h"
+#include "StatusCodec.h"
+#include "config.h"
+
+// Esquema dos tópicos de comando e de status e das suas mensagens. O
+// NetworkManager só chama MqttSchemaPolicy, escolhido por MQTT_SCHEMA em
+// config.h: funções estáticas e inline, então o esquema que ficou de fora
+// não entra no binário e a escolha não custa nada em execução. Os demais
+// tópicos (erro, telemetria, diagnóstico, OTA) são os de MQTT.md nos dois.
+
+// MQTT.md: ac-control/dispositivos/{id}/comando e .../status, com unidades,
+// delta, status retido e as duas codificações
+struct NativeSchema {
+    static constexpr const char* ROOT = "ac-control/dispositivos/";
+    static constexpr const char* COMMAND = "/comando";
+    static constexpr const char* STATUS = "/status";
+    static constexpr bool UNITS = true;             // .../comando/n, .../status/n
+    static constexpr bool DELTA = true;             // .../status/delta
+    static constexpr bool RETAIN_STATUS = true;
+    static constexpr unsigned long STATUS_INTERVAL = STATUS_HEARTBEAT_INTERVAL;
+
+    static CommandParseResult parseCommand(const uint8_t* payload, size_t length, ACCommand& command,
+                                           JsonSlice& id) {
+        return ::parseCommand(payload, length, command, id);
+    }
+    static size_t serializeStatus(const ACStatus& status, WireFormat format, uint8_t* buffer, size_t capacity) {
+        return ::serializeStatus(status, format, buffer, capacity);
+    }
+};
+
+// Firmware climaControl antigo (LegacyCodec.h): um aparelho, só JSON, status
+// sem retenção a cada 5 s, como o servidor antigo espera
+struct LegacySchema {
+    static constexpr const char* ROOT = "climaControl/";
+    static constexpr const char* COMMAND = "/command";
+    static constexpr const char* STATUS = "/status";
+    static constexpr bool UNITS = false;
+    static constexpr bool DELTA = false;
+    static constexpr bool RETAIN_STATUS = false;
+    static constexpr unsigned long STATUS_INTERVAL = 5000;
+
+    // O servidor antigo não manda "id": nada de confirmação
+    static CommandParseResult parseCommand(const uint8_t* payload, size_t length, ACCommand& command,
+                                           JsonSlice& id) {
+        id = JsonSlice{nullptr, 0};
+        return parseLegacyCommand(payload, length, command);
+    }
+    static size_t serializeStatus(const ACStatus& status, WireFormat, uint8_t* buffer, size_t capacity) {
+        return serializeLegacyStatus(status, reinterpret_cast<char*>(buffer), capacity);
+    }
+};
+
+using MqttSchemaPolicy = std::conditional<MQTT_SCHEMA == MQTT_SCHEMA_LEGACY, LegacySchema, NativeSchema>::type;
+
+#endif // MQTT_SCHEMA_H
@@ -0,0 +1,73 @@
+#ifndef MQTT_TOPICS_H
+#define MQTT_TOPICS_H
+
+#include <stddef.h>
+#include "MqttSchema.h"
+
+// Tópicos de um dispositivo em buffers de tamanho fixo, montados uma vez a
+// partir do id; nenhum tópico é concatenado depois disso. O construtor é
+// constexpr: com DEVICE_ID o conjunto inteiro sai pronto do compilador
+// (main.cpp confere que o id cabe), e o simulador de frota monta o de cada
+// id em execução, sem heap.
+constexpr size_t topicLength(const char* text) {
+    size_t n = 0;
+    while (text[n]) n++;
+    return n;
+}
+
+struct MqttTopics {
+    // Maior id aceito; um id maior é cortado e os tópicos deixam de bater
+    static constexpr size_t DEVICE_ID_MAX_LENGTH = 32;
+    static constexpr const char* DEVICE_ROOT = "ac-control/dispositivos/";
+    // .../ir/aprendizado é o sufixo mais longo, igual a .../status/n/delta
+    static constexpr const char* LONGEST_SUFFIX = "/ir/aprendizado";
+
+    static constexpr size_t SIZE = topicLength(DEVICE_ROOT) + DEVICE_ID_MAX_LENGTH + topicLength(LONGEST_SUFFIX) + 1;
+
+    static constexpr bool fits(const char* deviceId) {
+        return topicLength(deviceId) <= DEVICE_ID_MAX_LENGTH;
+    }
+
+    char status[SIZE] = {};
+    char command[SIZE] = {};
+    char commandFilter[SIZE] = {};  // .../comando/#: a de todas as unidades
+    char delta[SIZE] = {};
+    char error[SIZE] = {};
+    char diagnostics[SIZE] = {};
+    char telemetry[SIZE] = {};
+    char otaChunk[SIZE] = {};
+    char otaState[SIZE] = {};
+    char ack[SIZE] = {};
+    char irLearn[SIZE] = {};
+    char recording[SIZE] = {};
+
+    constexpr explicit MqttTopics(const char* deviceId) {
+        compose(status, MqttSchemaPolicy::ROOT, deviceId, MqttSchemaPolicy::STATUS);
+        compose(command, MqttSchemaPolicy::ROOT, deviceId, MqttSchemaPolicy::COMMAND);
+        compose(commandFilter, MqttSchemaPolicy::ROOT, deviceId, MqttSchemaPolicy::COMMAND,
+                MqttSchemaPolicy::UNITS ? "/#" : "");
+        compose(delta, MqttSchemaPolicy::ROOT, deviceId, MqttSchemaPolicy::STATUS, "/delta");
+        compose(error, DEVICE_ROOT, deviceId, "/erro");
+        compose(diagnostics, DEVICE_ROOT, deviceId, "/diagnostico");
+        compose(telemetry, DEVICE_ROOT, deviceId, "/telemetria");
+        compose(otaChunk, DEVICE_ROOT, deviceId, "/ota/bloco");
+        compose(otaState, DEVICE_ROOT, deviceId, "/ota/estado");
+        compose(ack, DEVICE_ROOT, deviceId, "/confirmacao");
+        compose(irLearn, DEVICE_ROOT, deviceId, "/ir/aprendizado");
+        compose(recording, DEVICE_ROOT, deviceId, "/gravacao");
+    }
+
+private:
+    // Cortado em SIZE - 1: só acontece com um id maior que o máximo
+    static constexpr void compose(char* out, const char* root, const char* id, const char* suffix,
+                                  const char* tail = "") {
+        const char* parts[] = {root, id, suffix, tail};
+        size_t at = 0;
+        for (const char* part : parts) {
+            for (size_t i = 0; part[i] && at < SIZE - 1; i++) out[at++] = part[i];
+        }
+        out[at] = '\0';
+    }
+};
+
+#endif // MQTT_TOPICS_H
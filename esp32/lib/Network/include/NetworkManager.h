@@ -5,41 +5,144 @@
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include "ACController.h"
+#include "ACStateStore.h"
+#include "ACUnits.h"
+#include "Backoff.h"
+#include "CommandTracer.h"
+#include "IRLearner.h"
+#include "Metrics.h"
+#include "MqttSchema.h"
+#include "MqttTopics.h"
+#include "OtaUpdater.h"
+#include "Scheduler.h"
+#include "StatusCodec.h"
+#include "TaskQueues.h"
+#include "TelemetryStore.h"
+#include "config.h"
 
 class NetworkManager {
 public:
-    // Constants
-    static const uint16_t STATUS_UPDATE_INTERVAL = 5000;  // 5 seconds
-    static const uint16_t RECONNECT_DELAY = 5000;         // 5 seconds
-    static const uint8_t MAX_RECONNECT_ATTEMPTS = 5;
-    static const uint16_t PING_INTERVAL = 30000;          // 30 seconds
-    static const uint16_t WATCHDOG_TIMEOUT = 120000;      // 2 minutes
+    // Publicações falhando há este tempo sem nenhum sucesso no meio:
+    // derruba a conexão e reconecta
+    static const uint32_t WATCHDOG_TIMEOUT = 120000;      // 2 minutos
+    // Tópicos por unidade: ac-control/dispositivos/<id>/status/<n>/delta
+    static const size_t UNIT_TOPIC_SIZE = MqttTopics::SIZE;
+
+    // Estados da conexão; cada update() executa no máximo um passo
+    enum class ConnectionState : uint8_t {
+        WIFI_IDLE,          // aguardando o backoff para chamar WiFi.begin
+        WIFI_CONNECTING,    // associação em andamento
+        WIFI_CONNECTED,     // aguardando o backoff para tentar o broker
+        MQTT_CONNECTING,    // TCP aberto, falta o CONNECT/SUBSCRIBE
+        SUBSCRIBED          // operação normal
+    };
+
+    // Estado de rede de um aparelho: o status que a tarefa de controle
+    // mandou e o que falta publicar dele
+    struct Unit {
+        ACController* ac;
+        ACStatus snapshot;
+        uint8_t pendingFields;
+        unsigned long lastStatusUpdate;
+    };
 
     NetworkManager(const char* deviceId, ACController& ac);
     void begin(const char* ssid, const char* password,
               const char* mqttServer, uint16_t mqttPort,
               const char* mqttUser, const char* mqttPassword);
     void update();
-    bool isConnected() const;
+    bool isConnected();
+    ConnectionState getConnectionState() const { return _state; }
+    uint16_t getReconnectAttempts() const { return _mqttBackoff.attempts(); }
+    // Aparelhos atendidos: a unidade n recebe em .../comando/n e publica em
+    // .../status/n; a 0 também pelos tópicos sem número
+    uint8_t unitCount() const { return _unitCount; }
+    // Código do último erro de rede ou de comando ("NONE" se nenhum)
     const char* getLastError() const;
+    // Chamado com cada mensagem recebida (truncada em 255 bytes; em CBOR
+    // são os bytes crus), antes de ela ser interpretada
     void setCallback(void (*callback)(const char* topic, const char* message));
-    
+    // Alterações publicadas só com os campos mudados em .../status/delta
+    void setDeltaPublishing(bool enabled) { _deltaPublishing = enabled; }
+    // Codificação do status e do delta; o servidor troca com o comando
+    // FORMATO. Só em RAM: depois de reiniciar volta a STATUS_CBOR_ENABLED.
+    void setWireFormat(WireFormat format) { _wireFormat = format; }
+    WireFormat getWireFormat() const { return _wireFormat; }
+    // Modo multitarefa: comandos vão para a fila da tarefa de controle e o
+    // status vem dela; o ACController deixa de ser tocado por update().
+    // Chamar antes de criar as tarefas.
+    void attachQueues(CommandQueue& commands, StatusQueue& status);
+    // Amostra o status a cada TELEMETRY_SAMPLE_INTERVAL, conectado ou não,
+    // e envia o acumulado em .../telemetria enquanto conectado
+    void attachTelemetry(TelemetryStore& store) { _telemetry = &store; }
+    // Executa a agenda semanal, conectado ou não; o comando AGENDA troca a
+    // tabela. Sem agenda anexada, AGENDA é tratado como desconhecido.
+    void attachScheduler(Scheduler& scheduler) { _scheduler = &scheduler; }
+    // Recebe firmware pelo comando OTA e por .../ota/bloco e relata em
+    // .../ota/estado. Conectar ao broker confirma uma imagem em teste.
+    void attachOta(OtaUpdater& ota) { _ota = &ota; }
+    // Grava teclas do controle remoto com o comando APRENDER_IR e relata
+    // em .../ir/aprendizado. Sem aprendiz, APRENDER_IR só confirma o status.
+    void attachIRLearner(IRLearner& learner) { _irLearner = &learner; }
+    // Grava o estado de cada unidade na NVS quando ele muda (ver
+    // ACStateStore), conectado ou não
+    void attachStateStore(ACStateStore& store) { _stateStore = &store; }
+    // O gravador de entradas (inputRecorder) não é anexado: com
+    // INPUT_RECORDER_ENABLED e begin() no setup, update() grava o que a
+    // rede trouxe e o comando GRAVACAO envia em .../gravacao
+
+protected:
+    // 'units' com 'count' posições, guardadas pela classe derivada
+    NetworkManager(const char* deviceId, ACController* controllers, Unit* units, uint8_t count);
+
 private:
     enum class ErrorCode {
         NONE,
         WIFI_CONNECTION_FAILED,
         MQTT_CONNECTION_FAILED,
         PUBLISH_FAILED,
-        SUBSCRIBE_FAILED
+        SUBSCRIBE_FAILED,
+        INVALID_COMMAND,
+        STORAGE_FAILED
     };
 
-    void connectWiFi();
+    void startWiFi();
+    void pollWiFi();
+    void openMQTTSocket();
     void connectMQTT();
-    void publishStatus();
-    void publishError(const char* error);
-    void handlePing();
+    void scheduleWiFiRetry();
+    void scheduleMQTTRetry();
+    void setState(ConnectionState state);
+    void serviceMQTT();
+    bool publishStatus();
+    bool publishUnitStatus(uint8_t unit);
+    void publishChanges();
+    void sampleTelemetry();
+    void uploadTelemetry();
+    void runSchedule();
+    void persistState();
+    void installSchedule(const uint8_t* payload, size_t length);
+    void offerFirmware(const uint8_t* payload, size_t length);
+    void publishOtaReport();
+    void learnIR(const ACCommand& command);
+    void publishIRLearnReport();
+    void publishRecordingChunk();
+    void rejectCommand(CommandParseResult result);
+    void rejectUnit();
+    int commandUnit(const char* topic) const;
+    void dispatch(const ACCommand& command);
+    void drainStatusQueue();
+    ACStatus currentStatus(uint8_t unit) const;
+    uint8_t pendingFields(uint8_t unit) const;
+    void acknowledge(uint8_t unit, uint8_t fields);
+    const char* unitTopic(uint8_t unit, const char* topic);
+    bool publish(const char* topic, const uint8_t* payload, size_t length, bool retained);
+    void publishError(const char* error, const char* detail = nullptr);
+    void settle(uint8_t trace, CommandOutcome outcome);
+    void reportTraces();
+    void publishDiagnostics();
     void resetWatchdog();
-    static void mqttCallback(char* topic, byte* payload, unsigned int length);
+    void mqttCallback(char* topic, byte* payload, unsigned int length);
     
     const char* _deviceId;
     const char* _ssid;
@@ -51,23 +154,62 @@ private:
     
     WiFiClient _wifiClient;
     PubSubClient _mqttClient;
-    ACController& _ac;
+    Unit* _units;
+    uint8_t _unitCount;
+    Unit _single;               // com um aparelho só, sem classe derivada
     
-    unsigned long _lastStatusUpdate;
-    unsigned long _lastPing;
-    unsigned long _lastWatchdogReset;
-    unsigned long _lastReconnectAttempt;
-    uint8_t _reconnectAttempts;
+    unsigned long _lastHeartbeat;
+    bool _deltaPublishing;
+    WireFormat _wireFormat;
+    unsigned long _lastDiagnostics;
+    unsigned long _lastWatchdogReset;   // último publish bem-sucedido
+    bool _publishFailing;
+
+    ConnectionState _state;
+    unsigned long _stateSince;
+    unsigned long _nextAttemptAt;
+    Backoff _wifiBackoff;
+    Backoff _mqttBackoff;
     
-    String _statusTopic;
-    String _commandTopic;
-    String _errorTopic;
-    String _pingTopic;
+    MqttTopics _topics;                     // montados uma vez a partir do id
+    char _unitTopic[UNIT_TOPIC_SIZE];       // .../status/n montado na hora
+    char _statusBuffer[STATUS_JSON_CAPACITY];
+    char _diagnosticsBuffer[Metrics::DIAGNOSTICS_JSON_CAPACITY];
+
+    CommandQueue* _commandQueue;
+    StatusQueue* _statusQueue;
+    CommandTracer _tracer;
+
+    TelemetryStore* _telemetry;
+    unsigned long _lastTelemetrySample;
+    unsigned long _lastTelemetryUpload;
+    TelemetryRecord _telemetryBatch[TELEMETRY_BATCH_RECORDS];
+    uint8_t _telemetryBuffer[telemetryBatchCapacity(TELEMETRY_BATCH_RECORDS)];
+
+    Scheduler* _scheduler;
+    ACStateStore* _stateStore;
+    OtaUpdater* _ota;
+    IRLearner* _irLearner;
     
     ErrorCode _lastError;
     void (*_userCallback)(const char* topic, const char* message);
-    
-    static NetworkManager* _instance;
+};
+
+// NetworkManager de N aparelhos (ACUnits), com o estado de rede de cada um
+// num array de tamanho fixo, sem heap
+template <size_t N>
+class NetworkUnits {
+protected:
+    NetworkManager::Unit _unitStorage[N];
+};
+
+template <size_t N>
+class MultiUnitNetworkManager : private NetworkUnits<N>, public NetworkManager {
+public:
+    MultiUnitNetworkManager(const char* deviceId, ACUnits<N>& units)
+        : NetworkManager(deviceId, units.data(), this->_unitStorage, uint8_t(N)) {
+        static_assert(MqttSchemaPolicy::UNITS || N == 1, "o esquema MQTT escolhido atende um aparelho só");
+    }
 };
 
 #endif // NETWORK_MANAGER_H
\ No newline at end of file
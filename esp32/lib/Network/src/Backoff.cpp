@@ -0,0 +1,29 @@
+#include "Backoff.h"
+#include <Arduino.h>
+#include "InputRecorder.h"
+
+Backoff::Backoff(uint32_t minDelayMs, uint32_t maxDelayMs)
+    : _minDelay(minDelayMs),
+      _maxDelay(maxDelayMs < minDelayMs ? minDelayMs : maxDelayMs),
+      _attempts(0) {
+}
+
+uint32_t Backoff::next() {
+    uint32_t delayMs = _minDelay;
+    for (uint16_t i = 0; i < _attempts && delayMs < _maxDelay; i++) {
+        delayMs = delayMs > _maxDelay / 2 ? _maxDelay : delayMs * 2;
+    }
+    if (_attempts < UINT16_MAX) {
+        _attempts++;
+    }
+
+    uint32_t half = delayMs / 2;
+    uint32_t jitter = uint32_t(random(long(delayMs - half) + 1));
+    // O sorteio é entrada: a reprodução precisa das mesmas esperas
+    inputRecorder.random(jitter);
+    return half + jitter;
+}
+
+void Backoff::reset() {
+    _attempts = 0;
+}
@@ -0,0 +1,167 @@
+#include "CommandTracer.h"
+#include "JsonWriter.h"
+#include <string.h>
+
+CommandOutcome commandOutcome(CommandParseResult result) {
+    switch (result) {
+        case CommandParseResult::OK:                return CommandOutcome::OK;
+        case CommandParseResult::MALFORMED:         return CommandOutcome::MALFORMED;
+        case CommandParseResult::MISSING_VERB:      return CommandOutcome::MISSING_VERB;
+        case CommandParseResult::UNKNOWN_VERB:      return CommandOutcome::UNKNOWN_VERB;
+        case CommandParseResult::INVALID_PARAMETER: return CommandOutcome::INVALID_PARAMETER;
+    }
+    return CommandOutcome::MALFORMED;
+}
+
+const char* commandOutcomeCode(CommandOutcome outcome) {
+    switch (outcome) {
+        case CommandOutcome::OK:                return "OK";
+        case CommandOutcome::MALFORMED:         return "MALFORMED";
+        case CommandOutcome::MISSING_VERB:      return "MISSING_VERB";
+        case CommandOutcome::UNKNOWN_VERB:      return "UNKNOWN_VERB";
+        case CommandOutcome::INVALID_PARAMETER: return "INVALID_PARAMETER";
+        case CommandOutcome::UNKNOWN_UNIT:      return "UNKNOWN_UNIT";
+        case CommandOutcome::QUEUE_FULL:        return "QUEUE_FULL";
+    }
+    return "?";
+}
+
+CommandTracer::CommandTracer()
+    : _slots{},
+      _sequence(0),
+      _nextTrace(1),
+      _dropped(0) {
+}
+
+uint8_t CommandTracer::open(const JsonSlice& id, uint8_t unit, uint32_t receivedUs, uint32_t parsedUs) {
+    Slot* slot = nullptr;
+    for (Slot& candidate : _slots) {
+        if (!(candidate.flags & OPEN)) {
+            slot = &candidate;
+            break;
+        }
+        if (!slot || candidate.sequence - slot->sequence > UINT32_MAX / 2) slot = &candidate;
+    }
+    if (slot->flags & OPEN) _dropped++;
+
+    size_t length = id.length < COMMAND_ID_MAX ? id.length : COMMAND_ID_MAX;
+    memcpy(slot->id, id.data, length);
+    slot->id[length] = '\0';
+    slot->outcome = CommandOutcome::OK;
+    slot->sequence = _sequence++;
+    slot->receivedUs = receivedUs;
+    slot->parsedUs = parsedUs;
+    slot->trace = _nextTrace;
+    slot->unit = unit;
+    slot->flags = OPEN;
+    _nextTrace = _nextTrace == UINT8_MAX ? 1 : uint8_t(_nextTrace + 1);
+    return slot->trace;
+}
+
+CommandTracer::Slot* CommandTracer::find(uint8_t trace) {
+    if (!trace) return nullptr;
+    for (Slot& slot : _slots) {
+        if ((slot.flags & OPEN) && slot.trace == trace) return &slot;
+    }
+    return nullptr;
+}
+
+void CommandTracer::settle(uint8_t trace, CommandOutcome outcome, uint32_t nowUs) {
+    Slot* slot = find(trace);
+    if (!slot) return;
+    slot->outcome = outcome;
+    slot->publishedUs = nowUs;
+    slot->flags |= PUBLISHED | IR_DONE;
+}
+
+void CommandTracer::published(uint8_t trace, uint32_t nowUs) {
+    Slot* last = find(trace);
+    if (!last) return;
+    for (Slot& slot : _slots) {
+        if ((slot.flags & (OPEN | PUBLISHED)) == OPEN && slot.unit == last->unit
+            && last->sequence - slot.sequence <= UINT32_MAX / 2) {
+            slot.publishedUs = nowUs;
+            slot.flags |= PUBLISHED;
+        }
+    }
+}
+
+void CommandTracer::transmitted(const CommandTiming& ir) {
+    Slot* last = find(ir.trace);
+    if (!last) return;
+    for (Slot& slot : _slots) {
+        if ((slot.flags & (OPEN | IR_DONE)) == OPEN && slot.unit == last->unit
+            && last->sequence - slot.sequence <= UINT32_MAX / 2) {
+            slot.irStartUs = ir.irStartUs;
+            slot.irDoneUs = ir.irDoneUs;
+            slot.flags |= IR_DONE | (ir.transmitted ? IR_SENT : 0);
+        }
+    }
+}
+
+size_t CommandTracer::nextAck(uint32_t nowUs, char* buffer, size_t capacity) {
+    Slot* ready = nullptr;
+    for (Slot& slot : _slots) {
+        if (!(slot.flags & OPEN)) continue;
+        bool complete = (slot.flags & (PUBLISHED | IR_DONE)) == (PUBLISHED | IR_DONE);
+        if (!complete && nowUs - slot.receivedUs < TIMEOUT_US) continue;
+        if (!ready || slot.sequence - ready->sequence > UINT32_MAX / 2) ready = &slot;
+    }
+    if (!ready) return 0;
+    size_t length = serialize(*ready, buffer, capacity);
+    ready->flags = 0;
+    return length;
+}
+
+uint8_t CommandTracer::pending() const {
+    uint8_t count = 0;
+    for (const Slot& slot : _slots) {
+        if (slot.flags & OPEN) count++;
+    }
+    return count;
+}
+
+size_t CommandTracer::serialize(const Slot& slot, char* buffer, size_t capacity) const {
+    JsonWriter json(buffer, capacity);
+    json.beginObject();
+    json.key("id");
+    json.value(slot.id);
+    json.key("unidade");
+    if (slot.unit == NO_UNIT) {
+        json.null();
+    } else {
+        json.value(uint32_t(slot.unit));
+    }
+    json.key("resultado");
+    json.value(commandOutcomeCode(slot.outcome));
+    json.key("recebidoUs");
+    json.value(slot.receivedUs);
+
+    // Microssegundos desde a chegada; null na etapa que não houve
+    json.key("etapas");
+    json.beginObject();
+    json.key("interpretacao");
+    json.value(uint32_t(slot.parsedUs - slot.receivedUs));
+    bool sent = slot.flags & IR_SENT;
+    json.key("inicioIR");
+    if (sent) {
+        json.value(uint32_t(slot.irStartUs - slot.receivedUs));
+    } else {
+        json.null();
+    }
+    json.key("fimIR");
+    if (sent) {
+        json.value(uint32_t(slot.irDoneUs - slot.receivedUs));
+    } else {
+        json.null();
+    }
+    json.key("publicacao");
+    if (slot.flags & PUBLISHED) {
+        json.value(uint32_t(slot.publishedUs - slot.receivedUs));
+    } else {
+        json.null();
+    }
+    json.endObject();
+    json.endObject();
+    return json.finish();
+}
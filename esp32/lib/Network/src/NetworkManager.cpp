@@ -1,18 +1,65 @@
 #include "NetworkManager.h"
-#include <ArduinoJson.h>
-
-NetworkManager* NetworkManager::_instance = nullptr;
+#include "CommandCodec.h"
+#include "OtaCodec.h"
+#include "ScheduleCodec.h"
+#include "HeapGuard.h"
+#include "InputRecorder.h"
+#include "JsonWriter.h"
+#include <stdio.h>
+#include <stdlib.h>
 
 NetworkManager::NetworkManager(const char* deviceId, ACController& ac)
+    : NetworkManager(deviceId, &ac, &_single, 1) {
+}
+
+NetworkManager::NetworkManager(const char* deviceId, ACController* controllers, Unit* units, uint8_t count)
     : _deviceId(deviceId),
-      _ac(ac),
       _mqttClient(_wifiClient),
-      _lastStatusUpdate(0),
-      _reconnectAttempts(0),
-      _lastReconnectAttempt(0) {
-    _instance = this;
-    _statusTopic = String("ac-control/dispositivos/") + _deviceId + "/status";
-    _commandTopic = String("ac-control/dispositivos/") + _deviceId + "/comando";
+      _units(units),
+      _unitCount(count),
+      _lastHeartbeat(0),
+      _deltaPublishing(STATUS_DELTA_ENABLED),
+      _wireFormat(STATUS_CBOR_ENABLED ? WireFormat::CBOR : WireFormat::JSON),
+      _lastDiagnostics(0),
+      _lastWatchdogReset(0),
+      _publishFailing(false),
+      _state(ConnectionState::WIFI_IDLE),
+      _stateSince(0),
+      _nextAttemptAt(0),
+      _wifiBackoff(RECONNECT_BACKOFF_MIN, RECONNECT_BACKOFF_MAX),
+      _mqttBackoff(RECONNECT_BACKOFF_MIN, RECONNECT_BACKOFF_MAX),
+      _topics(deviceId),
+      _commandQueue(nullptr),
+      _statusQueue(nullptr),
+      _telemetry(nullptr),
+      _lastTelemetrySample(0),
+      _lastTelemetryUpload(0),
+      _scheduler(nullptr),
+      _stateStore(nullptr),
+      _ota(nullptr),
+      _irLearner(nullptr),
+      _lastError(ErrorCode::NONE),
+      _userCallback(nullptr) {
+    if (!MqttTopics::fits(deviceId)) {
+        Serial.println("ID do dispositivo maior que o máximo; tópicos cortados");
+    }
+    _unitTopic[0] = '\0';
+
+    for (uint8_t i = 0; i < _unitCount; i++) {
+        _units[i].ac = &controllers[i];
+        _units[i].snapshot = controllers[i].getStatus();
+        _units[i].pendingFields = 0;
+        _units[i].lastStatusUpdate = 0;
+    }
+}
+
+void NetworkManager::attachQueues(CommandQueue& commands, StatusQueue& status) {
+    _commandQueue = &commands;
+    _statusQueue = &status;
+    for (uint8_t i = 0; i < _unitCount; i++) {
+        _units[i].snapshot = _units[i].ac->getStatus();
+        _units[i].pendingFields = _units[i].ac->dirtyFields();
+    }
 }
 
 void NetworkManager::begin(const char* ssid, const char* password,
@@ -25,145 +72,692 @@ void NetworkManager::begin(const char* ssid, const char* password,
     _mqttUser = mqttUser;
     _mqttPassword = mqttPassword;
 
-    connectWiFi();
-    
+    // As novas tentativas são da máquina de estados, não do driver
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
+
     _mqttClient.setServer(_mqttServer, _mqttPort);
-    _mqttClient.setCallback([](char* topic, byte* payload, unsigned int length) {
-        if (_instance) {
-            _instance->mqttCallback(topic, payload, length);
-        }
+    _mqttClient.setSocketTimeout((MQTT_CONNECT_TIMEOUT + 999) / 1000);
+    // Cada instância recebe só as próprias mensagens (várias num processo no
+    // simulador de frota)
+    _mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
+        mqttCallback(topic, payload, length);
     });
+
+    _wifiBackoff.reset();
+    _mqttBackoff.reset();
+    _nextAttemptAt = millis();
+    _lastTelemetrySample = millis();
+    setState(ConnectionState::WIFI_IDLE);
 }
 
+// Cada chamada executa no máximo um passo da conexão, de modo que o loop()
+// nunca fica preso mais que MQTT_CONNECT_TIMEOUT esperando a rede.
 void NetworkManager::update() {
-    if (WiFi.status() != WL_CONNECTED) {
-        connectWiFi();
+    Metrics::Timer timer(Metrics::Latency::NETWORK_LOOP);
+
+    // O status da tarefa de controle, a telemetria, a agenda, o estado
+    // gravado, o prazo de uma imagem em teste, o receptor IR e o gravador
+    // de entradas não dependem da rede
+    drainStatusQueue();
+    reportTraces();
+    sampleTelemetry();
+    runSchedule();
+    persistState();
+    if (_ota) _ota->poll();
+    if (_irLearner) _irLearner->poll();
+    inputRecorder.poll();
+
+    if (_state >= ConnectionState::WIFI_CONNECTED && WiFi.status() != WL_CONNECTED) {
+        Serial.println("WiFi perdido");
+        inputRecorder.link(RECORDING_LINK_WIFI, false);
+        Metrics::increment(Metrics::Counter::CONNECTION_LOST);
+        _mqttClient.disconnect();
+        scheduleWiFiRetry();
+        return;
     }
 
-    if (!_mqttClient.connected()) {
-        unsigned long now = millis();
-        if (now - _lastReconnectAttempt > RECONNECT_DELAY) {
-            _lastReconnectAttempt = now;
-            if (_reconnectAttempts < MAX_RECONNECT_ATTEMPTS) {
-                connectMQTT();
-            }
-        }
-    } else {
-        _mqttClient.loop();
-        _reconnectAttempts = 0; // Reset counter on successful connection
+    bool due = long(millis() - _nextAttemptAt) >= 0;
 
-        unsigned long now = millis();
-        if (now - _lastStatusUpdate >= STATUS_UPDATE_INTERVAL) {
-            publishStatus();
-            _lastStatusUpdate = now;
-        }
+    switch (_state) {
+        case ConnectionState::WIFI_IDLE:
+            if (due) startWiFi();
+            break;
+        case ConnectionState::WIFI_CONNECTING:
+            pollWiFi();
+            break;
+        case ConnectionState::WIFI_CONNECTED:
+            if (due) openMQTTSocket();
+            break;
+        case ConnectionState::MQTT_CONNECTING:
+            connectMQTT();
+            break;
+        case ConnectionState::SUBSCRIBED:
+            serviceMQTT();
+            break;
     }
 }
 
-void NetworkManager::connectWiFi() {
-    if (WiFi.status() == WL_CONNECTED) return;
-
-    Serial.print("Conectando ao WiFi");
+void NetworkManager::startWiFi() {
+    Serial.println("Conectando ao WiFi...");
+    HeapGuard::Vendor vendor;
     WiFi.begin(_ssid, _password);
-    
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
-    }
-    
+    setState(ConnectionState::WIFI_CONNECTING);
+}
+
+void NetworkManager::pollWiFi() {
     if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("\nWiFi conectado");
-        Serial.println("IP: " + WiFi.localIP().toString());
+        Serial.println("WiFi conectado");
+        IPAddress ip = WiFi.localIP();
+        Serial.printf("IP: %u.%u.%u.%u\n", ip[0], ip[1], ip[2], ip[3]);
+        Metrics::increment(Metrics::Counter::WIFI_CONNECTS);
+        inputRecorder.link(RECORDING_LINK_WIFI, true);
+        _wifiBackoff.reset();
+        _nextAttemptAt = millis();
+        setState(ConnectionState::WIFI_CONNECTED);
+    } else if (millis() - _stateSince >= WIFI_CONNECT_TIMEOUT) {
+        Serial.println("Falha ao conectar ao WiFi");
+        _lastError = ErrorCode::WIFI_CONNECTION_FAILED;
+        Metrics::increment(Metrics::Counter::CONNECT_FAILURES);
+        {
+            HeapGuard::Vendor vendor;
+            WiFi.disconnect();
+        }
+        scheduleWiFiRetry();
+    }
+}
+
+void NetworkManager::openMQTTSocket() {
+    Serial.println("Conectando ao MQTT...");
+    bool opened;
+    unsigned long started = millis();
+    {
+        // O WiFiClient cria o socket e o buffer de recepção no heap
+        HeapGuard::Vendor vendor;
+        opened = _wifiClient.connect(_mqttServer, _mqttPort, MQTT_CONNECT_TIMEOUT);
+    }
+    // O resultado e o tempo bloqueado vêm da rede: a reprodução os repete
+    inputRecorder.socket(opened, uint32_t(millis() - started));
+    if (opened) {
+        setState(ConnectionState::MQTT_CONNECTING);
     } else {
-        Serial.println("\nFalha ao conectar ao WiFi");
+        Serial.println("Falha na conexão MQTT");
+        _lastError = ErrorCode::MQTT_CONNECTION_FAILED;
+        Metrics::increment(Metrics::Counter::CONNECT_FAILURES);
+        scheduleMQTTRetry();
     }
 }
 
 void NetworkManager::connectMQTT() {
-    Serial.println("Conectando ao MQTT...");
-    
-    if (_mqttClient.connect(_deviceId, _mqttUser, _mqttPassword)) {
+    // O socket já está aberto; o PubSubClient só envia CONNECT e espera o
+    // CONNACK, cuja leitura aloca o buffer de recepção do WiFiClient. Depois
+    // disso o loop() e os publish() não alocam.
+    bool connected;
+    {
+        HeapGuard::Vendor vendor;
+        connected = _mqttClient.connect(_deviceId, _mqttUser, _mqttPassword);
+    }
+    inputRecorder.link(RECORDING_LINK_BROKER, connected);
+    if (connected) {
         Serial.println("Conectado ao broker MQTT");
-        _mqttClient.subscribe(_commandTopic.c_str());
-        publishStatus();
-        _reconnectAttempts = 0;
+        Metrics::increment(Metrics::Counter::MQTT_CONNECTS);
+        // Uma assinatura para todas as unidades: .../comando/# inclui .../comando
+        bool subscribed = _mqttClient.subscribe(_topics.commandFilter);
+        if (_ota) {
+            subscribed = _mqttClient.subscribe(_topics.otaChunk) && subscribed;
+        }
+        if (!subscribed) {
+            _lastError = ErrorCode::SUBSCRIBE_FAILED;
+        }
+        _mqttBackoff.reset();
+        setState(ConnectionState::SUBSCRIBED);
+        resetWatchdog();
+        _lastDiagnostics = millis();
+        bool published = publishStatus();
+        if (!subscribed) {
+            publishError("Falha ao assinar o tópico de comandos");
+        }
+        if (_ota) {
+            // Firmware novo que conecta, assina e publica fica; o relatório
+            // de cada conexão diz ao servidor a versão e de onde retomar
+            if (subscribed && published) _ota->confirmBoot();
+            _ota->requestReport();
+        }
     } else {
         Serial.println("Falha na conexão MQTT");
-        _reconnectAttempts++;
-        if (_reconnectAttempts >= MAX_RECONNECT_ATTEMPTS) {
-            Serial.println("Máximo de tentativas atingido. Aguardando próximo ciclo.");
-        }
+        _lastError = ErrorCode::MQTT_CONNECTION_FAILED;
+        Metrics::increment(Metrics::Counter::CONNECT_FAILURES);
+        _wifiClient.stop();
+        scheduleMQTTRetry();
     }
 }
 
-void NetworkManager::publishStatus() {
-    String status = _ac.getStatusJson();
-    _mqttClient.publish(_statusTopic.c_str(), status.c_str(), true);
+void NetworkManager::serviceMQTT() {
+    if (!_mqttClient.loop()) {
+        Serial.println("Conexão MQTT perdida");
+        inputRecorder.link(RECORDING_LINK_BROKER, false);
+        Metrics::increment(Metrics::Counter::CONNECTION_LOST);
+        scheduleMQTTRetry();
+        return;
+    }
+    // O PubSubClient entrega uma mensagem por loop(): durante uma
+    // transferência, uma janela de blocos por passo
+    for (uint8_t i = 1; _ota && _ota->receiving() && i < OTA_WINDOW_CHUNKS; i++) {
+        if (!_mqttClient.loop()) break;
+    }
+    if (_ota && _ota->reportDue()) {
+        publishOtaReport();
+    }
+    if (_irLearner && _irLearner->reportDue()) {
+        publishIRLearnReport();
+    }
+    if (inputRecorder.uploadDue()) {
+        publishRecordingChunk();
+    }
+
+    // Socket aberto mas nada sai: melhor reconectar do que ficar mudo
+    if (_publishFailing && millis() - _lastWatchdogReset >= WATCHDOG_TIMEOUT) {
+        Serial.println("Sem publicar há 2 min; reconectando");
+        Metrics::increment(Metrics::Counter::WATCHDOG_RESETS);
+        _mqttClient.disconnect();
+        _wifiClient.stop();
+        scheduleMQTTRetry();
+        return;
+    }
+
+    // Publica só quando algo mudou; o heartbeat prova que o dispositivo vive
+    unsigned long now = millis();
+    if (now - _lastHeartbeat >= MqttSchemaPolicy::STATUS_INTERVAL) {
+        publishStatus();
+    } else {
+        publishChanges();
+    }
+    if (now - _lastDiagnostics >= DIAGNOSTICS_INTERVAL) {
+        publishDiagnostics();
+    }
+    uploadTelemetry();
 }
 
-void NetworkManager::mqttCallback(char* topic, byte* payload, unsigned int length) {
-    char message[length + 1];
-    memcpy(message, payload, length);
-    message[length] = '\0';
+// Junta as atualizações da tarefa de controle; uma resposta a comando é
+// publicada na hora, como no modo de tarefa única
+void NetworkManager::drainStatusQueue() {
+    if (!_statusQueue) return;
+
+    uint8_t afterCommand = 0;
+    uint8_t traces[AC_MAX_UNITS] = {};
+    StatusUpdate update;
+    while (_statusQueue->pop(update)) {
+        if (update.unit >= _unitCount) continue;
+        Unit& unit = _units[update.unit];
+        unit.snapshot = update.status;
+        unit.pendingFields |= update.fields;
+        if (update.afterCommand) afterCommand |= uint8_t(1 << update.unit);
+        if (update.trace) traces[update.unit] = update.trace;
+        if (update.ir.trace) _tracer.transmitted(update.ir);
+    }
+    if (_state != ConnectionState::SUBSCRIBED) return;
+    for (uint8_t i = 0; afterCommand; i++, afterCommand >>= 1) {
+        if ((afterCommand & 1) && publishUnitStatus(i)) _tracer.published(traces[i], uint32_t(micros()));
+    }
+}
+
+ACStatus NetworkManager::currentStatus(uint8_t unit) const {
+    ACStatus status = _statusQueue ? _units[unit].snapshot : _units[unit].ac->getStatus();
+    if (_scheduler) {
+        status.scheduleVersion = _scheduler->table().version;
+        status.scheduleEnabled = _scheduler->table().enabled;
+        status.clockSynced = _scheduler->clockSynced();
+    }
+    status.wireFormat = _wireFormat;
+    return status;
+}
 
-    StaticJsonDocument<200> doc;
-    DeserializationError error = deserializeJson(doc, message);
+uint8_t NetworkManager::pendingFields(uint8_t unit) const {
+    return _statusQueue ? _units[unit].pendingFields : _units[unit].ac->dirtyFields();
+}
 
-    if (error) {
-        Serial.println("Erro ao parsear comando JSON");
-        return;
+void NetworkManager::acknowledge(uint8_t unit, uint8_t fields) {
+    if (_statusQueue) {
+        _units[unit].pendingFields &= ~fields;
+    } else {
+        _units[unit].ac->markPublished(fields);
     }
+}
+
+void NetworkManager::scheduleWiFiRetry() {
+    _nextAttemptAt = millis() + _wifiBackoff.next();
+    setState(ConnectionState::WIFI_IDLE);
+}
+
+void NetworkManager::scheduleMQTTRetry() {
+    _nextAttemptAt = millis() + _mqttBackoff.next();
+    setState(ConnectionState::WIFI_CONNECTED);
+}
 
-    const char* comando = doc["comando"];
-    if (!comando) return;
+void NetworkManager::setState(ConnectionState state) {
+    _state = state;
+    _stateSince = millis();
+}
 
-    if (strcmp(comando, "LIGAR") == 0) {
-        _ac.turnOn();
+// Todas as unidades; true só se todas saíram
+bool NetworkManager::publishStatus() {
+    bool published = true;
+    for (uint8_t i = 0; i < _unitCount; i++) {
+        published = publishUnitStatus(i) && published;
     }
-    else if (strcmp(comando, "DESLIGAR") == 0) {
-        _ac.turnOff();
+    if (published) _lastHeartbeat = millis();
+    return published;
+}
+
+bool NetworkManager::publishUnitStatus(uint8_t unit) {
+    size_t length = MqttSchemaPolicy::serializeStatus(currentStatus(unit), _wireFormat,
+                                                      reinterpret_cast<uint8_t*>(_statusBuffer), sizeof(_statusBuffer));
+    if (length == 0) {
+        return false;
     }
-    else if (strcmp(comando, "TEMPERATURA") == 0) {
-        uint8_t temp = doc["parametros"]["temperatura"];
-        _ac.setTemperature(temp);
+    if (!publish(unitTopic(unit, _topics.status), reinterpret_cast<const uint8_t*>(_statusBuffer), length,
+                 MqttSchemaPolicy::RETAIN_STATUS)) {
+        return false;
     }
-    else if (strcmp(comando, "MODO_OPERACAO") == 0) {
-        const char* modo = doc["parametros"]["modo"];
-        if (strcmp(modo, "REFRIGERAR") == 0) {
-            _ac.setMode(ACMode::COOL);
-        }
-        else if (strcmp(modo, "VENTILAR") == 0) {
-            _ac.setMode(ACMode::FAN);
+    acknowledge(unit, STATUS_FIELD_ALL);
+    _units[unit].lastStatusUpdate = millis();
+    return true;
+}
+
+// Cada unidade no seu ritmo: um aparelho mudando não adia o outro
+void NetworkManager::publishChanges() {
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < _unitCount; i++) {
+        uint8_t fields = pendingFields(i);
+        if (!fields || now - _units[i].lastStatusUpdate < STATUS_UPDATE_INTERVAL) {
+            continue;
         }
-        else if (strcmp(modo, "DESUMIDIFICAR") == 0) {
-            _ac.setMode(ACMode::DRY);
+        if (!MqttSchemaPolicy::DELTA || !_deltaPublishing) {
+            publishUnitStatus(i);
+            continue;
         }
-        else {
-            _ac.setMode(ACMode::AUTO);
+        size_t length = serializeStatusDelta(currentStatus(i), fields, _wireFormat,
+                                             reinterpret_cast<uint8_t*>(_statusBuffer), sizeof(_statusBuffer));
+        if (length && publish(unitTopic(i, _topics.delta), reinterpret_cast<const uint8_t*>(_statusBuffer), length, false)) {
+            acknowledge(i, fields);
+            _units[i].lastStatusUpdate = now;
         }
     }
-    else if (strcmp(comando, "VELOCIDADE") == 0) {
-        const char* velocidade = doc["parametros"]["velocidade"];
-        if (strcmp(velocidade, "BAIXA") == 0) {
-            _ac.setFanSpeed(FanSpeed::LOW);
-        }
-        else if (strcmp(velocidade, "MEDIA") == 0) {
-            _ac.setFanSpeed(FanSpeed::MEDIUM);
+}
+
+// .../status e .../status/delta são da unidade 0; a n publica em
+// .../status/n e .../status/n/delta
+const char* NetworkManager::unitTopic(uint8_t unit, const char* topic) {
+    if (unit == 0) return topic;
+    size_t base = strlen(_topics.status);
+    int length = snprintf(_unitTopic, sizeof(_unitTopic), "%s/%u%s", _topics.status, unsigned(unit),
+                          strlen(topic) > base ? topic + base : "");
+    // Só um id maior que MqttTopics::DEVICE_ID_MAX_LENGTH chega a cortar
+    return length > 0 ? _unitTopic : topic;
+}
+
+bool NetworkManager::publish(const char* topic, const uint8_t* payload, size_t length, bool retained) {
+    if (!_mqttClient.publish(topic, payload, length, retained)) {
+        _lastError = ErrorCode::PUBLISH_FAILED;
+        Metrics::increment(Metrics::Counter::PUBLISH_FAILURES);
+        _publishFailing = true;
+        inputRecorder.link(RECORDING_LINK_STALLED, true);
+        return false;
+    }
+    inputRecorder.link(RECORDING_LINK_STALLED, false);
+    resetWatchdog();
+    return true;
+}
+
+void NetworkManager::resetWatchdog() {
+    _lastWatchdogReset = millis();
+    _publishFailing = false;
+}
+
+// Comando que não chega ao IR: a resposta (status ou erro) acabou de sair
+void NetworkManager::settle(uint8_t trace, CommandOutcome outcome) {
+    if (trace) _tracer.settle(trace, outcome, uint32_t(micros()));
+}
+
+// Fim do IR dos comandos rastreados e as confirmações prontas; no modo
+// multitarefa o IR chega por drainStatusQueue()
+void NetworkManager::reportTraces() {
+    if (!_statusQueue) {
+        for (uint8_t i = 0; i < _unitCount; i++) {
+            const CommandTiming* ir = _units[i].ac->finishedTrace();
+            if (ir) {
+                _tracer.transmitted(*ir);
+                _units[i].ac->markTraceReported();
+            }
         }
-        else if (strcmp(velocidade, "ALTA") == 0) {
-            _ac.setFanSpeed(FanSpeed::HIGH);
+    }
+    if (_state != ConnectionState::SUBSCRIBED || !_tracer.pending()) return;
+    size_t length;
+    while ((length = _tracer.nextAck(uint32_t(micros()), _statusBuffer, sizeof(_statusBuffer)))) {
+        publish(_topics.ack, reinterpret_cast<const uint8_t*>(_statusBuffer), length, false);
+    }
+}
+
+// Reaproveita o buffer de status: as publicações são sequenciais. Numa
+// rejeição, "mensagem" é o código e "detalhe" o texto para gente
+void NetworkManager::publishError(const char* error, const char* detail) {
+    JsonWriter json(_statusBuffer, sizeof(_statusBuffer));
+    json.beginObject();
+    json.key("erro");
+    json.value(getLastError());
+    json.key("mensagem");
+    json.value(error);
+    if (detail) {
+        json.key("detalhe");
+        json.value(detail);
+    }
+    json.key("uptime");
+    json.value(uint32_t(millis() / 1000));
+    json.endObject();
+    size_t length = json.finish();
+    if (length) {
+        publish(_topics.error, reinterpret_cast<const uint8_t*>(_statusBuffer), length, false);
+    }
+}
+
+// Retido: um servidor que volta encontra o ponto de retomada
+void NetworkManager::publishOtaReport() {
+    size_t length = serializeOtaReportJson(_ota->report(), _statusBuffer, sizeof(_statusBuffer));
+    if (length && publish(_topics.otaState, reinterpret_cast<const uint8_t*>(_statusBuffer), length, true)) {
+        _ota->reportSent();
+    }
+}
+
+// Não retido: é a resposta a um APRENDER_IR, não um estado a recuperar
+void NetworkManager::publishIRLearnReport() {
+    size_t length = serializeIRLearnReportJson(_irLearner->report(), _statusBuffer, sizeof(_statusBuffer));
+    if (length && publish(_topics.irLearn, reinterpret_cast<const uint8_t*>(_statusBuffer), length, false)) {
+        _irLearner->reportSent();
+    }
+}
+
+// Um bloco por passo: o envio não segura a tarefa de rede nem enche a fila
+// de saída do socket. Um bloco que não saiu é repetido no próximo passo.
+void NetworkManager::publishRecordingChunk() {
+    size_t length;
+    const uint8_t* chunk = inputRecorder.uploadChunk(length);
+    if (!chunk) {
+        publishError("Falha ao ler a gravação");
+        return;
+    }
+    if (publish(_topics.recording, chunk, length, false)) {
+        inputRecorder.chunkSent();
+    }
+}
+
+void NetworkManager::publishDiagnostics() {
+    _lastDiagnostics = millis();
+    size_t length = Metrics::serializeDiagnosticsJson(
+        _lastError == ErrorCode::NONE ? nullptr : getLastError(),
+        _diagnosticsBuffer, sizeof(_diagnosticsBuffer));
+    if (length) {
+        publish(_topics.diagnostics, reinterpret_cast<const uint8_t*>(_diagnosticsBuffer), length, false);
+    }
+}
+
+const char* NetworkManager::getLastError() const {
+    switch (_lastError) {
+        case ErrorCode::NONE: return "NONE";
+        case ErrorCode::WIFI_CONNECTION_FAILED: return "WIFI_CONNECTION_FAILED";
+        case ErrorCode::MQTT_CONNECTION_FAILED: return "MQTT_CONNECTION_FAILED";
+        case ErrorCode::PUBLISH_FAILED: return "PUBLISH_FAILED";
+        case ErrorCode::SUBSCRIBE_FAILED: return "SUBSCRIBE_FAILED";
+        case ErrorCode::INVALID_COMMAND: return "INVALID_COMMAND";
+        case ErrorCode::STORAGE_FAILED: return "STORAGE_FAILED";
+    }
+    return "NONE";
+}
+
+void NetworkManager::setCallback(void (*callback)(const char* topic, const char* message)) {
+    _userCallback = callback;
+}
+
+void NetworkManager::sampleTelemetry() {
+    if (!_telemetry || millis() - _lastTelemetrySample < TELEMETRY_SAMPLE_INTERVAL) {
+        return;
+    }
+    _lastTelemetrySample += TELEMETRY_SAMPLE_INTERVAL;
+    // O sensor é o da sala; o estado gravado é o da unidade 0
+    _telemetry->record(currentStatus(0));
+}
+
+// Um lote por TELEMETRY_UPLOAD_INTERVAL: o acúmulo de uma queda longa sai em
+// ritmo fixo em vez de uma rajada. O lote só deixa o store depois que o
+// PubSubClient aceita a publicação; se falhar, é repetido no próximo ciclo.
+void NetworkManager::uploadTelemetry() {
+    if (!_telemetry || millis() - _lastTelemetryUpload < TELEMETRY_UPLOAD_INTERVAL) {
+        return;
+    }
+    size_t count = _telemetry->peek(_telemetryBatch, TELEMETRY_BATCH_RECORDS);
+    if (count == 0) {
+        return;
+    }
+    size_t encoded = 0;
+    size_t length = encodeTelemetryBatch(_telemetryBatch, count, _telemetry->now(),
+                                         _telemetryBuffer, sizeof(_telemetryBuffer), encoded);
+    _lastTelemetryUpload = millis();
+    if (length && publish(_topics.telemetry, _telemetryBuffer, length, false)) {
+        _telemetry->consume(encoded);
+    }
+}
+
+void NetworkManager::mqttCallback(char* topic, byte* payload, unsigned int length) {
+    // Blocos de firmware não são comandos: direto para a flash
+    if (_ota && strcmp(topic, _topics.otaChunk) == 0) {
+        _ota->receive(payload, length);
+        return;
+    }
+    // Chegada do comando: a referência das etapas da confirmação
+    uint32_t receivedUs = uint32_t(micros());
+
+    Metrics::increment(Metrics::Counter::COMMANDS);
+    int unit = commandUnit(topic);
+    if (_userCallback) {
+        // O payload do PubSubClient não termina em '\0'
+        char text[256];
+        size_t n = length < sizeof(text) - 1 ? length : sizeof(text) - 1;
+        memcpy(text, payload, n);
+        text[n] = '\0';
+        _userCallback(topic, text);
+    }
+
+    // Interpretado direto no buffer do PubSubClient, sem cópia nem heap;
+    // JSON ou CBOR, pelo primeiro byte
+    ACCommand command;
+    CommandParseResult result;
+    JsonSlice id;
+    {
+        Metrics::Timer timer(Metrics::Latency::COMMAND_PARSE);
+        result = MqttSchemaPolicy::parseCommand(payload, length, command, id);
+    }
+    // Entrada para a reprodução; o pedido da própria gravação fica de fora
+    bool upload = result == CommandParseResult::OK && command.type == ACCommandType::UPLOAD_RECORDING;
+    size_t base = strlen(_topics.command);
+    if (!upload && strncmp(topic, _topics.command, base) == 0) {
+        inputRecorder.message(topic + base, payload, length);
+    }
+    // Com "id", cada etapa é marcada e a confirmação sai em .../confirmacao
+    uint8_t trace = 0;
+    if (id.length) {
+        trace = _tracer.open(id, unit < 0 ? CommandTracer::NO_UNIT : uint8_t(unit), receivedUs, uint32_t(micros()));
+    }
+
+    if (unit < 0) {
+        rejectUnit();
+        settle(trace, CommandOutcome::UNKNOWN_UNIT);
+        return;
+    }
+    if (result == CommandParseResult::UNKNOWN_VERB) {
+        // Comando desconhecido: apenas confirma o estado atual
+        publishUnitStatus(uint8_t(unit));
+        settle(trace, commandOutcome(result));
+        return;
+    }
+    if (result != CommandParseResult::OK) {
+        rejectCommand(result);
+        settle(trace, commandOutcome(result));
+        return;
+    }
+    if (command.type == ACCommandType::SET_SCHEDULE) {
+        installSchedule(payload, length);
+        settle(trace, CommandOutcome::OK);
+        return;
+    }
+    if (command.type == ACCommandType::OTA_OFFER) {
+        offerFirmware(payload, length);
+        settle(trace, CommandOutcome::OK);
+        return;
+    }
+    if (command.type == ACCommandType::LEARN_IR) {
+        learnIR(command);
+        settle(trace, CommandOutcome::OK);
+        return;
+    }
+    if (upload) {
+        // Sem gravador, só confirma o status; os blocos saem em .../gravacao
+        if (!inputRecorder.requestUpload(command.value != 0)) publishStatus();
+        settle(trace, CommandOutcome::OK);
+        return;
+    }
+    if (command.type == ACCommandType::SET_FORMAT) {
+        // O status na nova codificação confirma a troca
+        _wireFormat = WireFormat(command.value);
+        publishStatus();
+        settle(trace, CommandOutcome::OK);
+        return;
+    }
+
+    // AGENDA, OTA, APRENDER_IR, GRAVACAO e FORMATO acima valem para o
+    // dispositivo inteiro
+    command.unit = uint8_t(unit);
+    command.trace = trace;
+    dispatch(command);
+}
+
+// Unidade do tópico de comando: .../comando é a 0, .../comando/n a n;
+// -1 para outro sufixo ou unidade que não existe
+int NetworkManager::commandUnit(const char* topic) const {
+    size_t base = strlen(_topics.command);
+    if (strncmp(topic, _topics.command, base) != 0) return -1;
+    if (topic[base] == '\0') return 0;
+    if (!MqttSchemaPolicy::UNITS || topic[base] != '/' || topic[base + 1] < '0' || topic[base + 1] > '9') return -1;
+    char* end = nullptr;
+    unsigned long unit = strtoul(topic + base + 1, &end, 10);
+    return *end == '\0' && unit < _unitCount ? int(unit) : -1;
+}
+
+void NetworkManager::rejectUnit() {
+    Serial.println("Comando para unidade inexistente");
+    Metrics::increment(Metrics::Counter::COMMANDS_REJECTED);
+    _lastError = ErrorCode::INVALID_COMMAND;
+    publishError("UNKNOWN_UNIT");
+}
+
+void NetworkManager::rejectCommand(CommandParseResult result) {
+    Serial.print("Comando rejeitado: ");
+    Serial.println(commandParseResultName(result));
+    Metrics::increment(Metrics::Counter::COMMANDS_REJECTED);
+    _lastError = ErrorCode::INVALID_COMMAND;
+    publishError(commandParseResultCode(result), commandParseResultName(result));
+}
+
+// A tabela compilada fica na pilha só durante a troca; o Scheduler guarda
+// a sua cópia
+void NetworkManager::installSchedule(const uint8_t* payload, size_t length) {
+    if (!_scheduler) {
+        publishStatus();
+        return;
+    }
+    ScheduleTable table;
+    CommandParseResult result = parseSchedule(payload, length, table);
+    if (result != CommandParseResult::OK) {
+        rejectCommand(result);
+        return;
+    }
+    if (!_scheduler->install(table)) {
+        Serial.println("Falha ao gravar a agenda na NVS");
+        _lastError = ErrorCode::STORAGE_FAILED;
+        publishError("Agenda não gravada; vale até reiniciar");
+    }
+    // O status confirma a versão instalada
+    publishStatus();
+}
+
+// A resposta sai em .../ota/estado logo depois do loop() do MQTT
+void NetworkManager::offerFirmware(const uint8_t* payload, size_t length) {
+    if (!_ota) {
+        publishStatus();
+        return;
+    }
+    OtaOffer offer;
+    CommandParseResult result = parseOtaOffer(payload, length, offer);
+    if (result != CommandParseResult::OK) {
+        rejectCommand(result);
+        return;
+    }
+    _ota->offer(offer);
+}
+
+// A biblioteca é uma só para todas as unidades; a resposta sai em
+// .../ir/aprendizado logo depois do loop() do MQTT
+void NetworkManager::learnIR(const ACCommand& command) {
+    if (!_irLearner) {
+        publishStatus();
+        return;
+    }
+    if (command.value) {
+        _irLearner->erase();
+    } else {
+        _irLearner->learn(command.settings);
+    }
+}
+
+void NetworkManager::runSchedule() {
+    ACCommand command;
+    if (_scheduler && _scheduler->poll(command)) {
+        Serial.println("Transição da agenda");
+        // A agenda é da sala: todos os aparelhos seguem a mesma transição
+        for (uint8_t i = 0; i < _unitCount; i++) {
+            command.unit = i;
+            dispatch(command);
         }
-        else {
-            _ac.setFanSpeed(FanSpeed::AUTO);
+    }
+}
+
+void NetworkManager::persistState() {
+    if (!_stateStore) return;
+    for (uint8_t i = 0; i < _unitCount; i++) {
+        ACStatus status = currentStatus(i);
+        _stateStore->note(i, ACSettings{status.isOn, status.targetTemp, status.mode, status.fanSpeed});
+    }
+    _stateStore->poll();
+}
+
+void NetworkManager::dispatch(const ACCommand& command) {
+    if (_commandQueue) {
+        // O status volta pela fila de status depois que o IR for enviado
+        if (!_commandQueue->push(command)) {
+            Serial.println("Fila de comandos cheia; comando descartado");
+            Metrics::increment(Metrics::Counter::COMMAND_QUEUE_FULL);
+            settle(command.trace, CommandOutcome::QUEUE_FULL);
         }
+        return;
     }
 
-    // Publica o novo status após executar o comando
-    publishStatus();
+    _units[command.unit].ac->execute(command);
+
+    // Publica o novo status após executar o comando; sem broker (agenda) o
+    // status sai ao reconectar
+    if (_state == ConnectionState::SUBSCRIBED && publishUnitStatus(command.unit)) {
+        _tracer.published(command.trace, uint32_t(micros()));
+    }
 }
 
-bool NetworkManager::isConnected() const {
-    return WiFi.status() == WL_CONNECTED && _mqttClient.connected();
+bool NetworkManager::isConnected() {
+    return _state == ConnectionState::SUBSCRIBED && _mqttClient.connected();
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <Arduino.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+#include "OtaCodec.h"
+#include "config.h"
+
+// Atualização de firmware pelo MQTT, sem a imagem em RAM: cada bloco vai
+// direto para a partição OTA inativa (A/B) e entra no SHA-256 corrente.
+// Só com o hash conferido a partição vira a de boot.
+//
+// Retomada: os blocos chegam em ordem; um fora de ordem é ignorado e o
+// relatório diz ao servidor de onde reenviar. O progresso vai para a NVS a
+// cada OTA_PROGRESS_INTERVAL bytes, e depois de um reboot begin() refaz o
+// hash do que já está na flash e continua dali. A mesma oferta repetida
+// retoma em vez de recomeçar.
+//
+// Reversão: a imagem nova roda "em teste" até confirmBoot() (o
+// NetworkManager chama ao conectar ao broker). Sem isso em
+// OTA_CONFIRM_TIMEOUT, ou depois de OTA_BOOT_ATTEMPTS boots, o boot volta
+// para a partição anterior. Independe do rollback do bootloader.
+//
+// Uso de uma tarefa só (a de rede); restartDue() pede o ESP.restart().
+class OtaUpdater {
+public:
+    OtaUpdater();
+
+    // Retoma a transferência gravada e conta o boot de uma imagem em teste
+    void begin();
+
+    // Comando OTA: começa, retoma (mesma imagem) ou cancela. Recusada
+    // enquanto uma imagem nova não foi confirmada, para não apagar a
+    // partição para a qual ela voltaria.
+    void offer(const OtaOffer& offer);
+    // Payload de .../ota/bloco
+    void receive(const uint8_t* payload, size_t length);
+    // Prazo de confirmação da imagem em teste
+    void poll();
+    // A imagem em teste conectou ao broker: passa a valer
+    void confirmBoot();
+
+    OtaState state() const { return _state; }
+    bool receiving() const { return _state == OtaState::RECEIVING; }
+    uint32_t nextChunk() const { return _nextChunk; }
+    OtaReport report() const;
+    // Relatório pendente para .../ota/estado
+    bool reportDue() const { return _reportDue; }
+    // Ao (re)conectar: os blocos em trânsito se perderam, então o relatório
+    // pede o reenvio a partir do próximo
+    void requestReport() {
+        _reportDue = true;
+        _resync = true;
+    }
+    void reportSent() {
+        _reportDue = false;
+        _resync = false;
+    }
+    // Boot trocado (imagem nova ou reversão): hora do ESP.restart()
+    bool restartDue() const;
+
+private:
+    void startTransfer(const OtaOffer& offer, const esp_partition_t* target);
+    bool resumeTransfer();
+    bool writeChunk(const OtaChunk& chunk);
+    void finishTransfer();
+    void fail(OtaError error);
+    void rollBack();
+    void scheduleRestart();
+    bool saveSession();
+    void clearSession();
+    bool saveTrial();
+    void clearTrial();
+
+    OtaState _state;
+    OtaError _error;
+    bool _reportDue;
+    bool _gapReported;          // um relatório por lacuna, não um por bloco
+    bool _resync;               // o próximo relatório pede reenvio
+
+    const esp_partition_t* _target;
+    uint32_t _size;
+    uint32_t _session;
+    uint32_t _nextChunk;
+    uint8_t _sha256[OTA_SHA256_BYTES];
+    char _version[OTA_VERSION_SIZE];
+    mbedtls_sha256_context _hash;
+
+    // Imagem em teste: partições e boots contados
+    uint32_t _trialTarget;
+    uint32_t _trialPrevious;
+    uint8_t _trialBoots;
+    unsigned long _testingSince;
+
+    bool _restartPending;
+    unsigned long _restartAt;
+};
+
+#endif // OTA_UPDATER_H
@@ -0,0 +1,386 @@
+#include "OtaUpdater.h"
+#include <Preferences.h>
+#include <string.h>
+#include "HeapGuard.h"
+
+namespace {
+
+const char* const NVS_SESSION = "sessao";
+const char* const NVS_TRIAL = "teste";
+
+// Formas gravadas na NVS (little-endian, sem padding):
+//   sessão: formato (1) | partição (u32) | tamanho (u32) | próximo bloco (u32)
+//           | versão (24) | sha256 (32)
+//   teste:  formato (1) | partição nova (u32) | anterior (u32) | boots (1)
+//           | versão (24)
+constexpr uint8_t BLOB_FORMAT = 1;
+constexpr size_t SESSION_BLOB_BYTES = 13 + OTA_VERSION_SIZE + OTA_SHA256_BYTES;
+constexpr size_t TRIAL_BLOB_BYTES = 10 + OTA_VERSION_SIZE;
+
+// Relatório a cada meia janela: o servidor nunca fica parado esperando
+constexpr uint32_t ACK_EVERY = OTA_WINDOW_CHUNKS > 1 ? OTA_WINDOW_CHUNKS / 2 : 1;
+
+static_assert(SPI_FLASH_SEC_SIZE % OTA_CHUNK_SIZE == 0, "um setor precisa fechar em blocos inteiros");
+static_assert(OTA_PROGRESS_INTERVAL % SPI_FLASH_SEC_SIZE == 0,
+              "a retomada começa num setor ainda por apagar");
+
+void put32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = uint8_t(value >> (8 * i));
+}
+
+uint32_t get32(const uint8_t* in) {
+    return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+}
+
+// A NVS aloca ao abrir o namespace: cada acesso num escopo Vendor
+bool readBlob(const char* key, uint8_t* blob, size_t size) {
+    HeapGuard::Vendor vendor;
+    Preferences nvs;
+    if (!nvs.begin(OTA_NVS_NAMESPACE, true)) return false;
+    size_t length = nvs.getBytes(key, blob, size);
+    nvs.end();
+    return length == size && blob[0] == BLOB_FORMAT;
+}
+
+bool writeBlob(const char* key, const uint8_t* blob, size_t size) {
+    HeapGuard::Vendor vendor;
+    Preferences nvs;
+    if (!nvs.begin(OTA_NVS_NAMESPACE, false)) return false;
+    bool stored = nvs.putBytes(key, blob, size) == size;
+    nvs.end();
+    return stored;
+}
+
+void removeBlob(const char* key) {
+    HeapGuard::Vendor vendor;
+    Preferences nvs;
+    if (!nvs.begin(OTA_NVS_NAMESPACE, false)) return;
+    if (nvs.isKey(key)) nvs.remove(key);
+    nvs.end();
+}
+
+}  // namespace
+
+OtaUpdater::OtaUpdater()
+    : _state(OtaState::IDLE),
+      _error(OtaError::NONE),
+      _reportDue(false),
+      _gapReported(false),
+      _resync(false),
+      _target(nullptr),
+      _size(0),
+      _session(0),
+      _nextChunk(0),
+      _sha256{},
+      _version{},
+      _trialTarget(0),
+      _trialPrevious(0),
+      _trialBoots(0),
+      _testingSince(0),
+      _restartPending(false),
+      _restartAt(0) {
+    mbedtls_sha256_init(&_hash);
+}
+
+void OtaUpdater::begin() {
+    _state = OtaState::IDLE;
+    _error = OtaError::NONE;
+    _restartPending = false;
+    _version[0] = '\0';
+
+    uint8_t trial[TRIAL_BLOB_BYTES];
+    if (readBlob(NVS_TRIAL, trial, sizeof(trial))) {
+        _trialTarget = get32(trial + 1);
+        _trialPrevious = get32(trial + 5);
+        _trialBoots = trial[9];
+        memcpy(_version, trial + 10, OTA_VERSION_SIZE);
+        _version[OTA_VERSION_SIZE - 1] = '\0';
+        _reportDue = true;
+
+        const esp_partition_t* running = esp_ota_get_running_partition();
+        if (!running || running->address != _trialTarget) {
+            // De volta à anterior, por rollBack() ou pelo bootloader
+            Serial.println("OTA: firmware novo revertido");
+            _state = OtaState::ROLLED_BACK;
+            clearTrial();
+            return;
+        }
+        if (++_trialBoots > OTA_BOOT_ATTEMPTS) {
+            Serial.println("OTA: firmware novo não confirmou nos boots permitidos");
+            rollBack();
+            return;
+        }
+        saveTrial();
+        _state = OtaState::TESTING;
+        _testingSince = millis();
+        return;
+    }
+
+    if (resumeTransfer()) {
+        Serial.println("OTA: retomando transferência");
+    }
+}
+
+void OtaUpdater::offer(const OtaOffer& offer) {
+    _reportDue = true;
+    if (offer.cancel) {
+        if (receiving()) {
+            Serial.println("OTA: transferência cancelada");
+            clearSession();
+            _state = OtaState::IDLE;
+            _version[0] = '\0';
+        }
+        return;
+    }
+    if (_state == OtaState::TESTING || _state == OtaState::REBOOTING) {
+        return;
+    }
+    if (receiving() && offer.size == _size && memcmp(offer.sha256, _sha256, OTA_SHA256_BYTES) == 0) {
+        // A mesma imagem: o relatório diz de onde continuar
+        _gapReported = false;
+        _resync = true;
+        return;
+    }
+
+    if (receiving()) clearSession();
+    _size = offer.size;
+    memcpy(_sha256, offer.sha256, OTA_SHA256_BYTES);
+    memcpy(_version, offer.version, OTA_VERSION_SIZE);
+    _nextChunk = 0;
+
+    const esp_partition_t* target = esp_ota_get_next_update_partition(nullptr);
+    if (!target) {
+        fail(OtaError::FLASH);
+    } else if (offer.size > target->size) {
+        fail(OtaError::SIZE);
+    } else {
+        startTransfer(offer, target);
+    }
+}
+
+void OtaUpdater::startTransfer(const OtaOffer& offer, const esp_partition_t* target) {
+    Serial.print("OTA: recebendo ");
+    Serial.println(offer.version);
+    _target = target;
+    _session = otaSessionTag(offer.sha256);
+    _state = OtaState::RECEIVING;
+    _error = OtaError::NONE;
+    _gapReported = false;
+    mbedtls_sha256_starts_ret(&_hash, 0);
+    // Sem a NVS a transferência segue; só não sobrevive a um reboot
+    saveSession();
+}
+
+// O hash do que já está na partição é refeito lendo a flash: o contexto do
+// SHA-256 não precisa ir para a NVS
+bool OtaUpdater::resumeTransfer() {
+    uint8_t blob[SESSION_BLOB_BYTES];
+    if (!readBlob(NVS_SESSION, blob, sizeof(blob))) return false;
+
+    const esp_partition_t* target = esp_ota_get_next_update_partition(nullptr);
+    uint32_t size = get32(blob + 5);
+    uint32_t next = get32(blob + 9);
+    if (!target || target->address != get32(blob + 1) || size > target->size
+        || uint64_t(next) * OTA_CHUNK_SIZE >= size) {
+        clearSession();
+        return false;
+    }
+
+    mbedtls_sha256_starts_ret(&_hash, 0);
+    uint8_t buffer[OTA_CHUNK_SIZE];
+    for (uint32_t offset = 0; offset < next * OTA_CHUNK_SIZE; offset += OTA_CHUNK_SIZE) {
+        if (esp_partition_read(target, offset, buffer, OTA_CHUNK_SIZE) != ESP_OK) {
+            clearSession();
+            return false;
+        }
+        mbedtls_sha256_update_ret(&_hash, buffer, OTA_CHUNK_SIZE);
+    }
+
+    _target = target;
+    _size = size;
+    _nextChunk = next;
+    memcpy(_version, blob + 13, OTA_VERSION_SIZE);
+    _version[OTA_VERSION_SIZE - 1] = '\0';
+    memcpy(_sha256, blob + 13 + OTA_VERSION_SIZE, OTA_SHA256_BYTES);
+    _session = otaSessionTag(_sha256);
+    _state = OtaState::RECEIVING;
+    _gapReported = false;
+    _reportDue = true;
+    return true;
+}
+
+void OtaUpdater::receive(const uint8_t* payload, size_t length) {
+    OtaChunk chunk;
+    if (!receiving() || !parseOtaChunk(payload, length, chunk) || chunk.session != _session) {
+        return;
+    }
+    // Repetido (reenvio que se cruzou com o relatório): já está na flash
+    if (chunk.index < _nextChunk) return;
+
+    uint32_t offset = _nextChunk * OTA_CHUNK_SIZE;
+    uint32_t expected = _size - offset < OTA_CHUNK_SIZE ? _size - offset : OTA_CHUNK_SIZE;
+    if (chunk.index > _nextChunk || chunk.length != expected) {
+        // Faltou um bloco: o servidor volta a partir de _nextChunk
+        if (!_gapReported) {
+            _gapReported = true;
+            _reportDue = true;
+        }
+        return;
+    }
+
+    if (!writeChunk(chunk)) {
+        fail(OtaError::FLASH);
+        return;
+    }
+    _nextChunk++;
+    _gapReported = false;
+
+    if (offset + expected == _size) {
+        finishTransfer();
+        return;
+    }
+    if (_nextChunk * OTA_CHUNK_SIZE % OTA_PROGRESS_INTERVAL == 0) {
+        saveSession();
+    }
+    if (_nextChunk % ACK_EVERY == 0) {
+        _reportDue = true;
+    }
+}
+
+// Cada setor é apagado quando o primeiro bloco dele chega
+bool OtaUpdater::writeChunk(const OtaChunk& chunk) {
+    uint32_t offset = chunk.index * OTA_CHUNK_SIZE;
+    if (offset % SPI_FLASH_SEC_SIZE == 0
+        && esp_partition_erase_range(_target, offset, SPI_FLASH_SEC_SIZE) != ESP_OK) {
+        return false;
+    }
+    if (esp_partition_write(_target, offset, chunk.data, chunk.length) != ESP_OK) {
+        return false;
+    }
+    mbedtls_sha256_update_ret(&_hash, chunk.data, chunk.length);
+    return true;
+}
+
+void OtaUpdater::finishTransfer() {
+    uint8_t digest[OTA_SHA256_BYTES];
+    mbedtls_sha256_finish_ret(&_hash, digest);
+    clearSession();
+    if (memcmp(digest, _sha256, OTA_SHA256_BYTES) != 0) {
+        fail(OtaError::SHA256);
+        return;
+    }
+
+    // O registro do teste vem antes da troca: sem ele não haveria reversão
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    _trialTarget = _target->address;
+    _trialPrevious = running ? running->address : 0;
+    _trialBoots = 0;
+    if (!saveTrial()) {
+        fail(OtaError::FLASH);
+        return;
+    }
+    if (esp_ota_set_boot_partition(_target) != ESP_OK) {
+        clearTrial();
+        fail(OtaError::IMAGE);
+        return;
+    }
+
+    Serial.println("OTA: imagem verificada; reiniciando");
+    _state = OtaState::REBOOTING;
+    _reportDue = true;
+    scheduleRestart();
+}
+
+void OtaUpdater::fail(OtaError error) {
+    Serial.print("OTA: falha ");
+    Serial.println(otaErrorName(error));
+    clearSession();
+    _state = OtaState::FAILED;
+    _error = error;
+    _reportDue = true;
+}
+
+void OtaUpdater::poll() {
+    if (_state == OtaState::TESTING && millis() - _testingSince >= OTA_CONFIRM_TIMEOUT) {
+        Serial.println("OTA: firmware novo não conectou a tempo");
+        rollBack();
+    }
+}
+
+void OtaUpdater::confirmBoot() {
+    if (_state != OtaState::TESTING) return;
+    Serial.println("OTA: firmware novo confirmado");
+    esp_ota_mark_app_valid_cancel_rollback();
+    clearTrial();
+    _state = OtaState::CONFIRMED;
+    _reportDue = true;
+}
+
+// O registro do teste fica: no boot seguinte a imagem anterior o encontra
+// e relata REVERTIDO
+void OtaUpdater::rollBack() {
+    _reportDue = true;
+    const esp_partition_t* previous = esp_ota_get_next_update_partition(nullptr);
+    if (!previous || previous->address != _trialPrevious || esp_ota_set_boot_partition(previous) != ESP_OK) {
+        // Sem imagem válida para onde voltar: a atual é a única que há
+        Serial.println("OTA: sem imagem anterior; mantendo a atual");
+        clearTrial();
+        _state = OtaState::FAILED;
+        _error = OtaError::IMAGE;
+        return;
+    }
+    saveTrial();
+    _state = OtaState::ROLLED_BACK;
+    scheduleRestart();
+}
+
+void OtaUpdater::scheduleRestart() {
+    _restartPending = true;
+    _restartAt = millis() + OTA_RESTART_DELAY;
+}
+
+bool OtaUpdater::restartDue() const {
+    return _restartPending && long(millis() - _restartAt) >= 0;
+}
+
+OtaReport OtaUpdater::report() const {
+    OtaReport report;
+    report.state = _state;
+    report.error = _error;
+    report.nextChunk = _nextChunk;
+    report.size = _size;
+    report.window = OTA_WINDOW_CHUNKS;
+    report.gap = receiving() && (_gapReported || _resync);
+    memcpy(report.version, _version, OTA_VERSION_SIZE);
+    report.firmware = FIRMWARE_VERSION;
+    return report;
+}
+
+bool OtaUpdater::saveSession() {
+    uint8_t blob[SESSION_BLOB_BYTES];
+    blob[0] = BLOB_FORMAT;
+    put32(blob + 1, _target->address);
+    put32(blob + 5, _size);
+    put32(blob + 9, _nextChunk);
+    memcpy(blob + 13, _version, OTA_VERSION_SIZE);
+    memcpy(blob + 13 + OTA_VERSION_SIZE, _sha256, OTA_SHA256_BYTES);
+    return writeBlob(NVS_SESSION, blob, sizeof(blob));
+}
+
+void OtaUpdater::clearSession() {
+    removeBlob(NVS_SESSION);
+}
+
+bool OtaUpdater::saveTrial() {
+    uint8_t blob[TRIAL_BLOB_BYTES];
+    blob[0] = BLOB_FORMAT;
+    put32(blob + 1, _trialTarget);
+    put32(blob + 5, _trialPrevious);
+    blob[9] = _trialBoots;
+    memcpy(blob + 10, _version, OTA_VERSION_SIZE);
+    return writeBlob(NVS_TRIAL, blob, sizeof(blob));
+}
+
+void OtaUpdater::clearTrial() {
+    removeBlob(NVS_TRIAL);
+}
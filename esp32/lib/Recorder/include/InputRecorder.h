@@ -0,0 +1,144 @@
+#ifndef INPUT_RECORDER_H
+#define INPUT_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "Dht22.h"
+#include "InputRecording.h"
+
+#if INPUT_RECORDER_ENABLED
+#include <atomic>
+#include <LittleFS.h>
+#include "SpscQueue.h"
+#endif
+
+// Gravador das entradas do firmware, para reproduzir no host um problema de
+// campo (env replay, lib/Replay). Com INPUT_RECORDER_ENABLED, tudo o que o
+// firmware não decide sozinho vai para um arquivo no LittleFS com o millis()
+// em que chegou (formato em InputRecording.h): as mensagens de comando, as
+// leituras do DHT22, o que a tarefa de rede observou do WiFi e do broker
+// (e quanto cada connect bloqueou), a hora do NTP e os sorteios do backoff.
+//
+// Só a tarefa de rede escreve: as leituras chegam da tarefa de sensores por
+// uma fila SPSC e entram no próximo poll(). Os eventos se juntam num buffer
+// em RAM que vai para a flash quando passa da metade ou a cada
+// RECORDER_FLUSH_INTERVAL. Com o arquivo em 'capacity', a gravação para. O
+// begin() guarda a gravação do boot anterior (a que interessa depois de um
+// travamento) em outro arquivo; o comando GRAVACAO envia uma das duas em
+// .../gravacao, um bloco por passo da tarefa de rede.
+//
+// Com INPUT_RECORDER_ENABLED 0 tudo aqui é vazio e inline.
+class InputRecorder {
+public:
+    static const size_t BUFFER_BYTES = 2048;
+    static const size_t SENSOR_QUEUE = 8;
+    // Cada bloco de .../gravacao: posição e tamanho total (u32 LE) e os bytes
+    static const size_t CHUNK_HEADER_BYTES = 8;
+    static const size_t CHUNK_BYTES = CHUNK_HEADER_BYTES + RECORDER_CHUNK_BYTES;
+
+#if INPUT_RECORDER_ENABLED
+    InputRecorder();
+
+    // Começa a gravação deste boot (LittleFS já montado); false sem arquivo
+    bool begin(const char* path, const char* previousPath, size_t capacity, const RecordingBoot& boot);
+    // Só para testes: grava o buffer, fecha os arquivos e para
+    void end();
+    bool recording() const { return _active.load(std::memory_order_acquire); }
+    // Bytes da gravação, na flash e no buffer
+    size_t size() const { return _written + _buffered; }
+
+    // Tarefa de rede, a cada passo: leituras da fila e gravação periódica
+    void poll();
+    void flush();
+
+    // Entradas vistas pela tarefa de rede
+    void message(const char* suffix, const uint8_t* payload, size_t length);
+    void link(uint8_t flag, bool on);
+    void socket(bool opened, uint32_t blockedMs);
+    void random(uint32_t value);
+    void clock(uint32_t utcMinute, uint8_t second);
+    // Da tarefa de sensores
+    void sensor(Dht22Result result, const Dht22::Reading& reading, uint32_t readMs);
+
+    // GRAVACAO: envia a gravação deste boot ou a do anterior. false sem
+    // gravador; um pedido no meio de outro envio recomeça.
+    bool requestUpload(bool previous);
+    bool uploadDue() const { return _upload.active; }
+    // O próximo bloco, repetido até chunkSent(); nullptr se a leitura falhou
+    const uint8_t* uploadChunk(size_t& length);
+    void chunkSent();
+
+private:
+    struct SensorEvent {
+        uint32_t at;
+        uint32_t readMs;
+        Dht22Result result;
+        int16_t temperature;
+        int16_t humidity;
+    };
+
+    struct Upload {
+        bool active;
+        bool previous;
+        uint32_t offset;
+        uint32_t total;
+        uint32_t pending;       // bytes do bloco em trânsito
+    };
+
+    uint8_t* openEvent(RecordedEvent type, uint32_t at, size_t payloadMax);
+    void closeEvent(uint8_t* end);
+    void writeVarintEvent(RecordedEvent type, uint32_t value);
+    void writeSensor(const SensorEvent& event);
+    void stop();
+
+    File _file;
+    File _previousFile;
+    const char* _previousPath;
+    size_t _capacity;
+    size_t _written;
+    size_t _buffered;
+    uint32_t _lastAt;
+    unsigned long _lastFlush;
+    std::atomic<bool> _active;
+    bool _begun;
+
+    uint8_t _link;
+    bool _clockSet;
+    uint32_t _clockMinute;
+    uint32_t _clockSeconds;
+    SensorEvent _lastSensor;
+    bool _hasSensor;
+    SpscQueue<SensorEvent, SENSOR_QUEUE> _sensors;
+    std::atomic<uint32_t> _lost;
+
+    Upload _upload;
+    uint8_t _chunk[CHUNK_BYTES];
+    uint8_t _buffer[BUFFER_BYTES];
+#else
+    bool begin(const char*, const char*, size_t, const RecordingBoot&) { return false; }
+    void end() {}
+    bool recording() const { return false; }
+    size_t size() const { return 0; }
+    void poll() {}
+    void flush() {}
+    void message(const char*, const uint8_t*, size_t) {}
+    void link(uint8_t, bool) {}
+    void socket(bool, uint32_t) {}
+    void random(uint32_t) {}
+    void clock(uint32_t, uint8_t) {}
+    void sensor(Dht22Result, const Dht22::Reading&, uint32_t) {}
+    bool requestUpload(bool) { return false; }
+    bool uploadDue() const { return false; }
+    const uint8_t* uploadChunk(size_t& length) {
+        length = 0;
+        return nullptr;
+    }
+    void chunkSent() {}
+#endif
+};
+
+// O gravador do dispositivo: as entradas chegam de vários módulos
+extern InputRecorder inputRecorder;
+
+#endif // INPUT_RECORDER_H
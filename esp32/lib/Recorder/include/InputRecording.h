@@ -0,0 +1,142 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ACState.h"
+#include "Dht22.h"
+#include "ScheduleCodec.h"
+
+// Formato do arquivo do gravador de entradas (InputRecorder), lido pela
+// reprodução no host (lib/Replay) e pelos testes.
+//
+// Cabeçalho: mágico "GRV1" (u32) e versão do formato (u32), little-endian.
+// Depois, os eventos em ordem de tempo. Cada um começa com um byte: o tipo
+// nos 4 bits altos e, nos baixos, os ms desde o evento anterior (15 = o
+// intervalo segue em varint). O tempo é o millis() do dispositivo (o do
+// BOOT conta desde zero); um evento que chega fora de ordem (a tarefa de
+// sensores corre em paralelo) fica com o instante do anterior. Inteiros em
+// varint LEB128; com sinal, em zigzag.
+constexpr uint32_t RECORDING_MAGIC = 0x31565247;   // "GRV1"
+constexpr uint32_t RECORDING_VERSION = 1;
+constexpr size_t RECORDING_HEADER_BYTES = 8;
+constexpr size_t RECORDING_MAX_UNITS = 8;
+constexpr size_t RECORDING_TEXT_MAX = 32;
+
+enum class RecordedEvent : uint8_t {
+    // versão do firmware, id, protocolo IR, esquema MQTT, período da tarefa
+    // de rede, estado restaurado de cada unidade e a agenda gravada, num
+    // bloco de varint + bytes (encodeRecordingBoot)
+    BOOT = 1,
+    // sufixo do tópico depois de .../comando (u8 + bytes) e o payload
+    // (varint + bytes); blocos de OTA e o próprio GRAVACAO ficam de fora
+    MESSAGE,
+    // Dht22Result (u8), duração da leitura em ms (varint), temperatura e
+    // umidade em décimos (i16; INT16_MIN = NAN)
+    SENSOR,
+    // a mesma leitura da anterior; sem payload
+    SENSOR_REPEAT,
+    // estado observado da rede (u8, RECORDING_LINK_*) quando muda
+    LINK,
+    // connect TCP ao broker: abriu (u8) e ms bloqueados (varint); o
+    // instante é o do início da chamada
+    SOCKET,
+    // sorteio do jitter do Backoff (varint)
+    RANDOM,
+    // hora do NTP quando o minuto muda: segundos desde 1970, em zigzag a
+    // partir da hora anterior
+    CLOCK,
+    // leituras do sensor perdidas com a fila cheia (varint)
+    LOST
+};
+
+constexpr uint8_t RECORDING_LINK_WIFI = 1;
+constexpr uint8_t RECORDING_LINK_BROKER = 2;
+constexpr uint8_t RECORDING_LINK_STALLED = 4;   // publicações falhando
+
+// Evento lido; os campos valem conforme o tipo. 'data' aponta para dentro
+// da gravação (payload de MESSAGE, BOOT cru para readRecordedBoot).
+struct RecordedInput {
+    RecordedEvent type;
+    uint32_t at;
+    const uint8_t* data;
+    size_t length;
+    const char* suffix;             // MESSAGE, sem '\0'
+    uint8_t suffixLength;
+    Dht22Result result;             // SENSOR e SENSOR_REPEAT
+    Dht22::Reading reading;
+    uint32_t readMs;
+    uint8_t link;                   // LINK
+    bool opened;                    // SOCKET
+    uint32_t value;                 // SOCKET (ms), RANDOM, CLOCK (segundos), LOST
+};
+
+// Leitor sem heap, evento a evento
+class RecordingReader {
+public:
+    RecordingReader(const uint8_t* data, size_t length);
+
+    // Cabeçalho de uma gravação desta versão
+    bool valid() const { return _valid; }
+    // false no fim da gravação ou num evento truncado (truncated())
+    bool next(RecordedInput& input);
+    bool truncated() const { return _truncated; }
+    size_t offset() const { return _offset; }
+
+private:
+    bool readByte(uint8_t& value);
+    bool readVarint(uint32_t& value);
+    bool readBytes(size_t length, const uint8_t*& bytes);
+    bool readSensor(RecordedInput& input);
+
+    const uint8_t* _data;
+    size_t _length;
+    size_t _offset;
+    bool _valid;
+    bool _truncated;
+    uint32_t _at;
+    uint32_t _clock;
+    RecordedInput _sensor;          // para SENSOR_REPEAT
+};
+
+// Estado do boot, do lado de quem grava
+struct RecordingBoot {
+    const char* firmwareVersion;
+    const char* deviceId;
+    const char* irProtocol;
+    uint8_t schema;                 // MQTT_SCHEMA
+    uint32_t loopPeriodMs;          // passo da tarefa de rede
+    uint8_t unitCount;
+    uint8_t restored;               // bit n: a unidade n voltou do ACStateStore
+    const ACSettings* settings;     // unitCount posições
+    const ScheduleTable* schedule;  // nullptr = sem agenda
+};
+
+// O mesmo BOOT, do lado de quem lê
+struct RecordedBoot {
+    char firmwareVersion[RECORDING_TEXT_MAX + 1];
+    char deviceId[RECORDING_TEXT_MAX + 1];
+    char irProtocol[RECORDING_TEXT_MAX + 1];
+    uint8_t schema;
+    uint32_t loopPeriodMs;
+    uint8_t unitCount;
+    uint8_t restored;
+    ACSettings settings[RECORDING_MAX_UNITS];
+    ScheduleTable schedule;
+};
+
+// Payload do BOOT em 'out'; 0 se não cabe
+size_t encodeRecordingBoot(const RecordingBoot& boot, uint8_t* out, size_t capacity);
+bool readRecordedBoot(const RecordedInput& input, RecordedBoot& boot);
+
+// Varint LEB128 em 'out' (até RECORDING_VARINT_MAX bytes); devolve o tamanho
+constexpr size_t RECORDING_VARINT_MAX = 5;
+size_t putRecordingVarint(uint8_t* out, uint32_t value);
+uint32_t recordingZigzag(int32_t value);
+
+// Valores do DHT22 em décimos; a volta faz a conta do quadro (décimos vezes
+// 0.1f), então a reprodução vê exatamente o float que o dispositivo viu
+int16_t recordingTenths(float value);
+float recordingValue(int16_t tenths);
+
+#endif // INPUT_RECORDING_H
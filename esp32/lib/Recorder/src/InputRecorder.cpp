@@ -0,0 +1,301 @@
+#include "InputRecorder.h"
+
+InputRecorder inputRecorder;
+
+#if INPUT_RECORDER_ENABLED
+
+#include <Arduino.h>
+#include <string.h>
+#include "HeapGuard.h"
+
+#ifdef MQTT_MAX_PACKET_SIZE
+// A maior mensagem de comando cabe inteira no buffer
+static_assert(InputRecorder::BUFFER_BYTES >= MQTT_MAX_PACKET_SIZE + 512, "buffer do gravador menor que uma mensagem MQTT");
+#endif
+
+namespace {
+
+void putU32(uint8_t* out, uint32_t value) {
+    out[0] = uint8_t(value);
+    out[1] = uint8_t(value >> 8);
+    out[2] = uint8_t(value >> 16);
+    out[3] = uint8_t(value >> 24);
+}
+
+void putI16(uint8_t* out, int16_t value) {
+    out[0] = uint8_t(uint16_t(value));
+    out[1] = uint8_t(uint16_t(value) >> 8);
+}
+
+}  // namespace
+
+InputRecorder::InputRecorder()
+    : _previousPath(nullptr),
+      _capacity(0),
+      _written(0),
+      _buffered(0),
+      _lastAt(0),
+      _lastFlush(0),
+      _active(false),
+      _begun(false),
+      _link(0),
+      _clockSet(false),
+      _clockMinute(0),
+      _clockSeconds(0),
+      _lastSensor{},
+      _hasSensor(false),
+      _lost(0),
+      _upload{} {
+}
+
+bool InputRecorder::begin(const char* path, const char* previousPath, size_t capacity, const RecordingBoot& boot) {
+    end();
+    _previousPath = previousPath;
+    _capacity = capacity;
+    _written = _buffered = 0;
+    _link = 0;
+    _clockSet = false;
+    _clockSeconds = 0;
+    _hasSensor = false;
+    _lost.store(0, std::memory_order_relaxed);
+    SensorEvent stale;
+    while (_sensors.pop(stale)) {}
+
+    // A gravação do boot anterior vira a "anterior"; a de dois boots atrás some
+    if (LittleFS.exists(path)) {
+        LittleFS.remove(previousPath);
+        LittleFS.rename(path, previousPath);
+    }
+    _file = LittleFS.open(path, "w+");
+    if (!_file) {
+        Serial.println("Falha ao criar o arquivo da gravação");
+        return false;
+    }
+    uint8_t header[RECORDING_HEADER_BYTES];
+    putU32(header, RECORDING_MAGIC);
+    putU32(header + 4, RECORDING_VERSION);
+    if (_file.write(header, sizeof(header)) != sizeof(header)) {
+        _file.close();
+        return false;
+    }
+    _written = sizeof(header);
+    _begun = true;
+    // O intervalo do BOOT é o millis() do boot: os instantes da gravação
+    // ficam os do dispositivo
+    _lastAt = 0;
+    _lastFlush = millis();
+    _active.store(true, std::memory_order_release);
+
+    uint8_t payload[512];
+    size_t length = encodeRecordingBoot(boot, payload, sizeof(payload));
+    uint8_t* out = length ? openEvent(RecordedEvent::BOOT, millis(), RECORDING_VARINT_MAX + length) : nullptr;
+    if (!out) {
+        stop();
+        return false;
+    }
+    out += putRecordingVarint(out, uint32_t(length));
+    memcpy(out, payload, length);
+    closeEvent(out + length);
+    // O BOOT vai para a flash já: um travamento logo depois ainda diz quem era
+    flush();
+    return recording();
+}
+
+void InputRecorder::end() {
+    if (_begun) flush();
+    _active.store(false, std::memory_order_release);
+    _begun = false;
+    _upload = Upload{};
+    _file.close();
+    _previousFile.close();
+}
+
+void InputRecorder::stop() {
+    _active.store(false, std::memory_order_release);
+    _buffered = 0;
+}
+
+// Cabeçalho do evento (tipo e intervalo) no buffer; devolve onde vai o
+// payload, ou nullptr se a gravação acabou
+uint8_t* InputRecorder::openEvent(RecordedEvent type, uint32_t at, size_t payloadMax) {
+    if (!recording()) return nullptr;
+    size_t needed = 1 + RECORDING_VARINT_MAX + payloadMax;
+    if (_written + _buffered + needed > _capacity) {
+        // Arquivo cheio: o que já está no buffer cabe e fica
+        flush();
+        stop();
+        Serial.println("Gravação cheia; parou");
+        return nullptr;
+    }
+    if (BUFFER_BYTES - _buffered < needed) flush();
+    if (!recording()) return nullptr;
+
+    // Fora de ordem (leitura vinda da outra tarefa): instante do anterior
+    uint32_t delta = int32_t(at - _lastAt) > 0 ? at - _lastAt : 0;
+    _lastAt += delta;
+    uint8_t* out = _buffer + _buffered;
+    *out++ = uint8_t(uint8_t(type) << 4 | (delta < 15 ? delta : 15));
+    if (delta >= 15) out += putRecordingVarint(out, delta);
+    return out;
+}
+
+void InputRecorder::closeEvent(uint8_t* end) {
+    _buffered = size_t(end - _buffer);
+    if (_buffered >= BUFFER_BYTES / 2) flush();
+}
+
+void InputRecorder::flush() {
+    _lastFlush = millis();
+    if (!_buffered || !_file) return;
+    if (_file.write(_buffer, _buffered) != _buffered) {
+        Serial.println("Falha ao gravar a gravação na flash; parou");
+        stop();
+        return;
+    }
+    _file.flush();
+    _written += _buffered;
+    _buffered = 0;
+}
+
+void InputRecorder::poll() {
+    if (!recording()) return;
+    SensorEvent event;
+    while (_sensors.pop(event)) {
+        writeSensor(event);
+    }
+    uint32_t lost = _lost.exchange(0, std::memory_order_relaxed);
+    if (lost) writeVarintEvent(RecordedEvent::LOST, lost);
+    if (_buffered && millis() - _lastFlush >= RECORDER_FLUSH_INTERVAL) flush();
+}
+
+void InputRecorder::writeVarintEvent(RecordedEvent type, uint32_t value) {
+    uint8_t* out = openEvent(type, millis(), RECORDING_VARINT_MAX);
+    if (out) closeEvent(out + putRecordingVarint(out, value));
+}
+
+void InputRecorder::writeSensor(const SensorEvent& event) {
+    bool repeat = _hasSensor && event.result == _lastSensor.result && event.readMs == _lastSensor.readMs
+                  && event.temperature == _lastSensor.temperature && event.humidity == _lastSensor.humidity;
+    uint8_t* out = openEvent(repeat ? RecordedEvent::SENSOR_REPEAT : RecordedEvent::SENSOR, event.at,
+                             1 + RECORDING_VARINT_MAX + 4);
+    if (!out) return;
+    if (!repeat) {
+        *out++ = uint8_t(event.result);
+        out += putRecordingVarint(out, event.readMs);
+        putI16(out, event.temperature);
+        putI16(out + 2, event.humidity);
+        out += 4;
+    }
+    closeEvent(out);
+    _lastSensor = event;
+    _hasSensor = true;
+}
+
+void InputRecorder::message(const char* suffix, const uint8_t* payload, size_t length) {
+    size_t suffixLength = strlen(suffix);
+    if (suffixLength > 255) suffixLength = 255;
+    uint8_t* out = openEvent(RecordedEvent::MESSAGE, millis(), 1 + suffixLength + RECORDING_VARINT_MAX + length);
+    if (!out) return;
+    *out++ = uint8_t(suffixLength);
+    memcpy(out, suffix, suffixLength);
+    out += suffixLength;
+    out += putRecordingVarint(out, uint32_t(length));
+    memcpy(out, payload, length);
+    closeEvent(out + length);
+}
+
+void InputRecorder::link(uint8_t flag, bool on) {
+    uint8_t state = on ? uint8_t(_link | flag) : uint8_t(_link & ~flag);
+    if (state == _link || !recording()) return;
+    _link = state;
+    uint8_t* out = openEvent(RecordedEvent::LINK, millis(), 1);
+    if (!out) return;
+    *out++ = state;
+    closeEvent(out);
+}
+
+// O estado do broker segue o connect; a reprodução o tira do próprio SOCKET
+void InputRecorder::socket(bool opened, uint32_t blockedMs) {
+    if (!recording()) return;
+    _link = opened ? uint8_t(_link | RECORDING_LINK_BROKER) : uint8_t(_link & ~RECORDING_LINK_BROKER);
+    uint8_t* out = openEvent(RecordedEvent::SOCKET, uint32_t(millis()) - blockedMs, 1 + RECORDING_VARINT_MAX);
+    if (!out) return;
+    *out++ = opened ? 1 : 0;
+    closeEvent(out + putRecordingVarint(out, blockedMs));
+}
+
+void InputRecorder::random(uint32_t value) {
+    if (recording()) writeVarintEvent(RecordedEvent::RANDOM, value);
+}
+
+// Uma vez por minuto: no meio dele a reprodução conta a hora pelo millis()
+void InputRecorder::clock(uint32_t utcMinute, uint8_t second) {
+    if (!recording() || (_clockSet && utcMinute == _clockMinute)) return;
+    uint32_t seconds = utcMinute * 60 + second;
+    uint8_t* out = openEvent(RecordedEvent::CLOCK, millis(), RECORDING_VARINT_MAX);
+    if (!out) return;
+    closeEvent(out + putRecordingVarint(out, recordingZigzag(int32_t(seconds - _clockSeconds))));
+    _clockSet = true;
+    _clockMinute = utcMinute;
+    _clockSeconds = seconds;
+}
+
+void InputRecorder::sensor(Dht22Result result, const Dht22::Reading& reading, uint32_t readMs) {
+    if (!recording()) return;
+    SensorEvent event{uint32_t(millis()), readMs, result,
+                      recordingTenths(reading.temperature), recordingTenths(reading.humidity)};
+    if (!_sensors.push(event)) _lost.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool InputRecorder::requestUpload(bool previous) {
+    if (!_begun) return false;
+    _previousFile.close();
+    _upload = Upload{true, previous, 0, 0, 0};
+    if (previous) {
+        // Abrir aloca o FILE do VFS; uma vez por pedido
+        HeapGuard::Vendor vendor;
+        if (LittleFS.exists(_previousPath)) _previousFile = LittleFS.open(_previousPath, FILE_READ);
+        _upload.total = _previousFile ? uint32_t(_previousFile.size()) : 0;
+    } else {
+        // O envio leva o que está gravado agora; o que chegar depois fica
+        // para o próximo pedido
+        flush();
+        _upload.total = uint32_t(_written);
+    }
+    return true;
+}
+
+const uint8_t* InputRecorder::uploadChunk(size_t& length) {
+    length = 0;
+    if (!_upload.active) return nullptr;
+    uint32_t remaining = _upload.total - _upload.offset;
+    uint32_t n = remaining < RECORDER_CHUNK_BYTES ? remaining : RECORDER_CHUNK_BYTES;
+    putU32(_chunk, _upload.offset);
+    putU32(_chunk + 4, _upload.total);
+    if (n) {
+        File& file = _upload.previous ? _previousFile : _file;
+        bool read = file.seek(_upload.offset) && file.read(_chunk + CHUNK_HEADER_BYTES, n) == n;
+        // A gravação em curso continua do fim
+        if (!_upload.previous) file.seek(uint32_t(_written));
+        if (!read) {
+            Serial.println("Falha ao ler a gravação; envio cancelado");
+            _upload.active = false;
+            _previousFile.close();
+            return nullptr;
+        }
+    }
+    _upload.pending = n;
+    length = CHUNK_HEADER_BYTES + n;
+    return _chunk;
+}
+
+void InputRecorder::chunkSent() {
+    _upload.offset += _upload.pending;
+    _upload.pending = 0;
+    if (_upload.offset >= _upload.total) {
+        _upload.active = false;
+        _previousFile.close();
+    }
+}
+
+#endif // INPUT_RECORDER_ENABLED
@@ -0,0 +1,273 @@
+#include "InputRecording.h"
+#include <math.h>
+#include <string.h>
+
+namespace {
+
+uint32_t getU32(const uint8_t* in) {
+    return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+}
+
+int32_t unzigzag(uint32_t value) {
+    return int32_t(value >> 1) ^ -int32_t(value & 1);
+}
+
+// Escrita com limite: 'failed' fica true se algo não coube
+struct BootWriter {
+    uint8_t* out;
+    size_t capacity;
+    size_t length;
+    bool failed;
+
+    void byte(uint8_t value) {
+        if (length < capacity) {
+            out[length++] = value;
+        } else {
+            failed = true;
+        }
+    }
+
+    void bytes(const void* data, size_t count) {
+        if (capacity - length < count) {
+            failed = true;
+            return;
+        }
+        memcpy(out + length, data, count);
+        length += count;
+    }
+
+    void varint(uint32_t value) {
+        uint8_t encoded[RECORDING_VARINT_MAX];
+        bytes(encoded, putRecordingVarint(encoded, value));
+    }
+
+    void text(const char* value) {
+        size_t n = value ? strlen(value) : 0;
+        if (n > RECORDING_TEXT_MAX) n = RECORDING_TEXT_MAX;
+        byte(uint8_t(n));
+        bytes(value, n);
+    }
+};
+
+struct BootReader {
+    const uint8_t* in;
+    size_t length;
+    size_t offset;
+
+    bool byte(uint8_t& value) {
+        if (offset >= length) return false;
+        value = in[offset++];
+        return true;
+    }
+
+    bool varint(uint32_t& value) {
+        value = 0;
+        for (uint8_t shift = 0; shift < 35; shift += 7) {
+            uint8_t b;
+            if (!byte(b)) return false;
+            value |= uint32_t(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool text(char* out) {
+        uint8_t n;
+        if (!byte(n) || n > RECORDING_TEXT_MAX || length - offset < n) return false;
+        memcpy(out, in + offset, n);
+        out[n] = '\0';
+        offset += n;
+        return true;
+    }
+};
+
+}  // namespace
+
+size_t putRecordingVarint(uint8_t* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = uint8_t(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = uint8_t(value);
+    return n;
+}
+
+uint32_t recordingZigzag(int32_t value) {
+    return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+}
+
+int16_t recordingTenths(float value) {
+    if (isnan(value)) return INT16_MIN;
+    float tenths = roundf(value * 10.0f);
+    if (tenths > INT16_MAX) return INT16_MAX;
+    if (tenths <= INT16_MIN) return INT16_MIN + 1;
+    return int16_t(tenths);
+}
+
+float recordingValue(int16_t tenths) {
+    if (tenths == INT16_MIN) return NAN;
+    // Como Dht22::decodeFrame: o módulo vezes 0.1f (ou -0.1f)
+    return tenths < 0 ? uint16_t(-tenths) * -0.1f : uint16_t(tenths) * 0.1f;
+}
+
+size_t encodeRecordingBoot(const RecordingBoot& boot, uint8_t* out, size_t capacity) {
+    if (boot.unitCount > RECORDING_MAX_UNITS) return 0;
+    BootWriter writer{out, capacity, 0, false};
+    writer.varint(boot.loopPeriodMs);
+    writer.byte(boot.schema);
+    writer.text(boot.firmwareVersion);
+    writer.text(boot.deviceId);
+    writer.text(boot.irProtocol);
+    writer.byte(boot.unitCount);
+    writer.byte(boot.restored);
+    for (uint8_t i = 0; i < boot.unitCount; i++) {
+        const ACSettings& settings = boot.settings[i];
+        writer.byte(settings.isOn);
+        writer.byte(settings.targetTemp);
+        writer.byte(uint8_t(settings.mode));
+        writer.byte(uint8_t(settings.fanSpeed));
+    }
+    if (boot.schedule) {
+        uint8_t blob[SCHEDULE_BLOB_CAPACITY];
+        size_t length = packScheduleTable(*boot.schedule, blob);
+        writer.varint(uint32_t(length));
+        writer.bytes(blob, length);
+    } else {
+        writer.varint(0);
+    }
+    return writer.failed ? 0 : writer.length;
+}
+
+bool readRecordedBoot(const RecordedInput& input, RecordedBoot& boot) {
+    if (input.type != RecordedEvent::BOOT) return false;
+    boot = RecordedBoot{};
+    BootReader reader{input.data, input.length, 0};
+    if (!reader.varint(boot.loopPeriodMs) || !reader.byte(boot.schema)
+        || !reader.text(boot.firmwareVersion) || !reader.text(boot.deviceId)
+        || !reader.text(boot.irProtocol) || !reader.byte(boot.unitCount)
+        || !reader.byte(boot.restored) || boot.unitCount == 0 || boot.unitCount > RECORDING_MAX_UNITS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < boot.unitCount; i++) {
+        uint8_t isOn, temp, mode, fan;
+        if (!reader.byte(isOn) || !reader.byte(temp) || !reader.byte(mode) || !reader.byte(fan)) return false;
+        boot.settings[i] = ACSettings{isOn != 0, temp, ACMode(mode), FanSpeed(fan)};
+    }
+    uint32_t blobLength;
+    if (!reader.varint(blobLength) || blobLength > input.length - reader.offset) return false;
+    return blobLength == 0 || unpackScheduleTable(input.data + reader.offset, blobLength, boot.schedule);
+}
+
+RecordingReader::RecordingReader(const uint8_t* data, size_t length)
+    : _data(data),
+      _length(length),
+      _offset(RECORDING_HEADER_BYTES),
+      _valid(length >= RECORDING_HEADER_BYTES && getU32(data) == RECORDING_MAGIC
+             && getU32(data + 4) == RECORDING_VERSION),
+      _truncated(false),
+      _at(0),
+      _clock(0),
+      _sensor{} {
+}
+
+bool RecordingReader::readByte(uint8_t& value) {
+    if (_offset >= _length) return false;
+    value = _data[_offset++];
+    return true;
+}
+
+bool RecordingReader::readVarint(uint32_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint8_t b;
+        if (!readByte(b)) return false;
+        value |= uint32_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+bool RecordingReader::readBytes(size_t length, const uint8_t*& bytes) {
+    if (_length - _offset < length) return false;
+    bytes = _data + _offset;
+    _offset += length;
+    return true;
+}
+
+bool RecordingReader::readSensor(RecordedInput& input) {
+    uint8_t result;
+    const uint8_t* values;
+    if (!readByte(result) || !readVarint(input.readMs) || !readBytes(4, values)) return false;
+    input.result = Dht22Result(result);
+    input.reading.temperature = recordingValue(int16_t(values[0] | values[1] << 8));
+    input.reading.humidity = recordingValue(int16_t(values[2] | values[3] << 8));
+    return true;
+}
+
+bool RecordingReader::next(RecordedInput& input) {
+    if (!_valid || _truncated || _offset >= _length) return false;
+    size_t start = _offset;
+    input = RecordedInput{};
+
+    uint8_t head = 0;
+    readByte(head);
+    uint32_t delta = head & 0x0F;
+    bool ok = delta < 15 || readVarint(delta);
+    input.type = RecordedEvent(head >> 4);
+
+    uint8_t flag = 0;
+    uint32_t length = 0;
+    switch (input.type) {
+        case RecordedEvent::BOOT:
+            ok = ok && readVarint(length) && readBytes(length, input.data);
+            input.length = length;
+            break;
+        case RecordedEvent::MESSAGE: {
+            const uint8_t* suffix = nullptr;
+            ok = ok && readByte(input.suffixLength) && readBytes(input.suffixLength, suffix)
+                && readVarint(length) && readBytes(length, input.data);
+            input.suffix = reinterpret_cast<const char*>(suffix);
+            input.length = length;
+            break;
+        }
+        case RecordedEvent::SENSOR:
+            ok = ok && readSensor(input);
+            if (ok) _sensor = input;
+            break;
+        case RecordedEvent::SENSOR_REPEAT:
+            ok = ok && _sensor.type == RecordedEvent::SENSOR;
+            input.result = _sensor.result;
+            input.reading = _sensor.reading;
+            input.readMs = _sensor.readMs;
+            break;
+        case RecordedEvent::LINK:
+            ok = ok && readByte(input.link);
+            break;
+        case RecordedEvent::SOCKET:
+            ok = ok && readByte(flag) && readVarint(input.value);
+            input.opened = flag != 0;
+            break;
+        case RecordedEvent::RANDOM:
+        case RecordedEvent::LOST:
+            ok = ok && readVarint(input.value);
+            break;
+        case RecordedEvent::CLOCK:
+            ok = ok && readVarint(length);
+            if (ok) _clock += uint32_t(unzigzag(length));
+            input.value = _clock;
+            break;
+        default:
+            ok = false;
+            break;
+    }
+    if (!ok) {
+        // Um corte de energia no meio da gravação deixa o último evento pela metade
+        _offset = start;
+        _truncated = true;
+        return false;
+    }
+    _at += delta;
+    input.at = _at;
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef INPUT_REPLAYER_H
+#define INPUT_REPLAYER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "InputRecording.h"
+#include "MqttTopics.h"
+#include "ReplayReport.h"
+
+struct FakeMessage;
+
+struct ReplayConfig {
+    uint32_t controlPeriodMs = 5;       // passo da tarefa de controle (main.cpp)
+    uint32_t tailMs = 5000;             // roda mais isto depois do último evento
+};
+
+// Reprodução de uma gravação do InputRecorder contra este firmware: as
+// tarefas de main.cpp (rede, controle, agenda, telemetria e estado gravado;
+// sem OTA nem receptor IR) no mesmo laço, em tempo virtual, com os
+// substitutos de lib/NativeHost fazendo o papel do mundo gravado. A
+// tarefa de rede anda no passo do BOOT, a de controle a cada
+// controlPeriodMs, e cada evento entra no instante gravado:
+//
+//   MESSAGE  injetada no FakeBroker em .../comando + sufixo
+//   SENSOR   SensorSampler::replay, no lugar do DHT22
+//   LINK     WiFi disponível, broker alcançável ou travado
+//   SOCKET   resultado e tempo bloqueado do próximo connect TCP
+//   RANDOM   devolvido pelo próximo random() (HostRandom)
+//   CLOCK    hora do servidor NTP (HostNtp)
+//
+// O relatório (ReplayReport) traz cada publicação, a latência virtual de
+// cada comando e a CPU do host por passo. Duas versões do firmware com a
+// mesma gravação dão relatórios comparáveis linha a linha.
+//
+// Só para o host: usa o heap e é dona dos substitutos globais (relógio,
+// WiFi, NTP, FakeBroker, random, flash e NVS) enquanto roda, então só uma
+// reprodução por vez.
+class InputReplayer {
+public:
+    explicit InputReplayer(const ReplayConfig& config = ReplayConfig());
+    ~InputReplayer();
+
+    // Reproduz a gravação inteira. false se não é uma gravação desta versão
+    // do formato, não começa pelo BOOT ou foi feita com outro esquema MQTT
+    // ou outro número de aparelhos que este build (error() diz qual).
+    bool run(const uint8_t* data, size_t length);
+
+    const ReplayReport& report() const { return _report; }
+    const std::string& error() const { return _error; }
+
+private:
+    struct Firmware;
+    struct PendingCommand {
+        size_t index;               // em _report.commands
+        uint32_t injectedAt;
+    };
+
+    bool start(const RecordedBoot& boot);
+    void apply(const RecordedInput& input);
+    void account(uint64_t ns);
+    void finish();
+    uint32_t sinceBoot() const;
+
+    static long nextRandom(long max, void* context);
+    static void observe(const FakeMessage& message, void* context);
+    void onPublish(const FakeMessage& message);
+
+    ReplayConfig _config;
+    ReplayReport _report;
+    std::string _error;
+    std::string _deviceId;
+    std::unique_ptr<MqttTopics> _topics;
+    std::unique_ptr<Firmware> _firmware;
+
+    uint32_t _bootAt;
+    uint8_t _link;
+    bool _injecting;
+    std::deque<uint32_t> _randoms;
+    std::vector<PendingCommand> _pending;
+    std::vector<uint64_t> _stepNs;
+};
+
+#endif // INPUT_REPLAYER_H
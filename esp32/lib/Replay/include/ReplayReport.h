@@ -0,0 +1,84 @@
+#ifndef REPLAY_REPORT_H
+#define REPLAY_REPORT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Relatório de uma reprodução (InputReplayer), em texto de uma linha por
+// item para caber num diff e ser guardado junto do firmware que o gerou:
+//
+//   gravacao <id> <firmware gravado> <protocolo IR>
+//   firmware <versão que reproduziu>
+//   eventos <n> duracao <ms> truncada <0|1> perdidas <n>
+//   saida <ms> <tópico> <payload>          (uma por publicação)
+//   comando <ms> <sufixo> <latência ms|-> <cpu ns>
+//   passos <n> <p50> <p90> <p99> <máx> <total>   (ns por passo da rede)
+//
+// Os instantes são ms desde o início da gravação e as latências, tempo
+// virtual: iguais em toda reprodução do mesmo firmware. Os ns são CPU do
+// host, que varia de uma execução para outra. Payload em JSON vai como
+// está; binário (CBOR, telemetria) em hexadecimal com o prefixo "hex:".
+struct ReplayOutput {
+    uint32_t at;
+    std::string topic;
+    std::string payload;
+};
+
+struct ReplayCommand {
+    static const uint32_t NO_ANSWER = UINT32_MAX;
+
+    uint32_t at;
+    std::string suffix;             // depois de .../comando; "-" na raiz
+    uint32_t latencyMs;             // até a primeira saída que não é
+                                    // telemetria nem diagnóstico
+    uint64_t cpuNs;                 // passos do firmware nesse intervalo
+};
+
+struct ReplayReport {
+    std::string deviceId;
+    std::string recordedFirmware;
+    std::string irProtocol;
+    std::string firmware;
+    uint32_t events = 0;
+    uint32_t durationMs = 0;
+    bool truncated = false;
+    uint32_t lost = 0;
+
+    std::vector<ReplayOutput> outputs;
+    std::vector<ReplayCommand> commands;
+
+    uint32_t steps = 0;
+    uint64_t stepP50Ns = 0;
+    uint64_t stepP90Ns = 0;
+    uint64_t stepP99Ns = 0;
+    uint64_t stepMaxNs = 0;
+    uint64_t stepTotalNs = 0;
+};
+
+void writeReplayReport(FILE* out, const ReplayReport& report);
+// false numa linha que não é do formato; 'error' diz qual
+bool readReplayReport(FILE* in, ReplayReport& report, std::string& error);
+
+struct ReplayTolerance {
+    float cpu = 0.25f;              // CPU por comando e p99 dos passos
+    uint64_t cpuFloorNs = 20000;    // diferenças menores não contam
+    uint32_t resyncWindow = 16;     // saídas puladas até reencontrar a sequência
+};
+
+// Diferenças de 'current' para 'base'; cada uma vai para 'out' numa linha
+struct ReplayDiff {
+    uint32_t missing = 0;           // saídas da base que sumiram
+    uint32_t extra = 0;             // saídas novas
+    uint32_t shifted = 0;           // mesma saída em outro instante
+    uint32_t slower = 0;            // comandos com latência virtual maior
+    uint32_t cpu = 0;               // comandos ou passos acima da tolerância de CPU
+
+    bool any() const { return missing || extra || shifted || slower || cpu; }
+};
+
+ReplayDiff compareReplayReports(const ReplayReport& base, const ReplayReport& current,
+                                const ReplayTolerance& tolerance, FILE* out);
+
+#endif // REPLAY_REPORT_H
@@ -0,0 +1,323 @@
+#include "InputReplayer.h"
+#include <Arduino.h>
+#include <FakeBroker.h>
+#include <HostDht22.h>
+#include <HostIRLog.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include "ACStateStore.h"
+#include "ACUnits.h"
+#include "ControlLoop.h"
+#include "IREncoder.h"
+#include "InputRecorder.h"
+#include "Metrics.h"
+#include "NetworkManager.h"
+#include "Scheduler.h"
+#include "SensorSampler.h"
+#include "TaskQueues.h"
+#include "TelemetryStore.h"
+#include "config.h"
+
+namespace {
+
+const uint8_t UNIT_IR_PINS[] = AC_UNIT_IR_PINS;
+
+uint64_t cpuNanos() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, uint32_t per1000) {
+    if (sorted.empty()) return 0;
+    size_t index = (sorted.size() * per1000 + 999) / 1000;
+    return sorted[index ? index - 1 : 0];
+}
+
+// JSON como está (uma linha, sem controle); o resto em hexadecimal
+std::string payloadText(const uint8_t* payload, size_t length) {
+    bool text = length && (payload[0] == '{' || payload[0] == '[');
+    for (size_t i = 0; text && i < length; i++) {
+        if (payload[i] < 0x20 || payload[i] == 0x7F) text = false;
+    }
+    if (text) return std::string(reinterpret_cast<const char*>(payload), length);
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string hex = "hex:";
+    for (size_t i = 0; i < length; i++) {
+        hex += DIGITS[payload[i] >> 4];
+        hex += DIGITS[payload[i] & 0x0F];
+    }
+    return hex;
+}
+
+}  // namespace
+
+// O firmware de main.cpp sem OTA e sem receptor IR; as três tarefas viram
+// passos do laço de run()
+struct InputReplayer::Firmware {
+    CommandQueue commandQueue;
+    SensorQueue sensorQueue;
+    StatusQueue statusQueue;
+    ACUnits<AC_UNIT_COUNT> units;
+    MultiUnitNetworkManager<AC_UNIT_COUNT> network;
+    ControlLoop control;
+    SensorSampler sensors;
+    TelemetryLog telemetryLog;
+    TelemetryStore telemetry;
+    Scheduler schedule;
+    ACStateStore stateStore;
+
+    explicit Firmware(const char* deviceId)
+        : units(UNIT_IR_PINS, PIN_DHT),
+          network(deviceId, units),
+          control(units, commandQueue, sensorQueue, statusQueue),
+          sensors(PIN_DHT, sensorQueue) {
+    }
+};
+
+InputReplayer::InputReplayer(const ReplayConfig& config)
+    : _config(config),
+      _bootAt(0),
+      _link(0),
+      _injecting(false) {
+}
+
+InputReplayer::~InputReplayer() {
+    FakeBroker::instance().setObserver(nullptr, nullptr);
+    HostRandom::setSource(nullptr, nullptr);
+}
+
+bool InputReplayer::run(const uint8_t* data, size_t length) {
+    _report = ReplayReport{};
+    _report.firmware = FIRMWARE_VERSION;
+    _error.clear();
+    _randoms.clear();
+    _pending.clear();
+    _stepNs.clear();
+
+    RecordingReader reader(data, length);
+    if (!reader.valid()) {
+        _error = "não é uma gravação (GRV1) desta versão";
+        return false;
+    }
+    RecordedInput input;
+    RecordedBoot boot;
+    if (!reader.next(input) || !readRecordedBoot(input, boot)) {
+        _error = "gravação sem BOOT";
+        return false;
+    }
+    _bootAt = input.at;
+    _report.events = 1;
+    if (!start(boot)) return false;
+
+    const uint32_t period = boot.loopPeriodMs ? boot.loopPeriodMs : TASK_PERIOD_NETWORK;
+    bool more = reader.next(input);
+    uint32_t lastAt = _bootAt;
+    uint32_t nextNetwork = millis();
+    uint32_t nextControl = millis();
+    for (;;) {
+        uint32_t now = millis();
+        while (more && int32_t(input.at - now) <= 0) {
+            apply(input);
+            lastAt = input.at;
+            _report.events++;
+            more = reader.next(input);
+        }
+        uint32_t end = (int32_t(now - lastAt) > 0 ? lastAt : now) + _config.tailMs;
+        if (!more && int32_t(now - end) >= 0) break;
+
+        if (int32_t(now - nextControl) >= 0) {
+            uint64_t started = cpuNanos();
+            _firmware->control.step();
+            account(cpuNanos() - started);
+            nextControl += _config.controlPeriodMs;
+            if (int32_t(now - nextControl) >= 0) nextControl = now + _config.controlPeriodMs;
+        }
+        if (int32_t(now - nextNetwork) >= 0) {
+            uint64_t started = cpuNanos();
+            _firmware->network.update();
+            uint64_t ns = cpuNanos() - started;
+            _stepNs.push_back(ns);
+            account(ns);
+            // Um connect que bloqueou empurra o próximo passo, como no ESP32
+            nextNetwork = uint32_t(millis()) + period;
+        }
+
+        uint32_t target = more ? input.at : end;
+        if (int32_t(nextControl - target) < 0) target = nextControl;
+        if (int32_t(nextNetwork - target) < 0) target = nextNetwork;
+        uint64_t targetUs = uint64_t(target) * 1000;
+        if (targetUs > HostClock::nowMicros()) HostClock::advanceMicros(targetUs - HostClock::nowMicros());
+    }
+    _report.truncated = reader.truncated();
+    _report.durationMs = sinceBoot();
+    finish();
+    return true;
+}
+
+// O boot de main.cpp, com o estado e a agenda do BOOT
+bool InputReplayer::start(const RecordedBoot& boot) {
+    if (boot.unitCount != AC_UNIT_COUNT) {
+        _error = "gravação de " + std::to_string(boot.unitCount) + " aparelhos; este build tem "
+                 + std::to_string(AC_UNIT_COUNT) + " (AC_UNIT_COUNT)";
+        return false;
+    }
+    if (boot.schema != MQTT_SCHEMA) {
+        _error = "gravação de outro esquema MQTT (MQTT_SCHEMA)";
+        return false;
+    }
+    if (!MqttTopics::fits(boot.deviceId)) {
+        _error = "id do dispositivo maior que o máximo";
+        return false;
+    }
+    _deviceId = boot.deviceId;
+    _report.deviceId = boot.deviceId;
+    _report.recordedFirmware = boot.firmwareVersion;
+    _report.irProtocol = boot.irProtocol;
+
+    // A reprodução não grava a si mesma
+    inputRecorder.end();
+    _firmware.reset();
+
+    HostClock::reset(uint64_t(_bootAt) * 1000);
+    HostIRLog::reset();
+    HostDht22::reset();
+    HostNvs::reset();
+    HostFlash::reset();
+    HostNtp::reset();
+    HostNtp::setReachable(false);
+    hostRmtReset();
+    Metrics::reset();
+    FakeBroker::instance().reset();
+    FakeBroker::instance().setReachable(false);
+    FakeBroker::instance().setObserver(observe, this);
+    WiFi.hostReset();
+    WiFi.hostSetNetworkAvailable(false);
+    HostRandom::setSource(nextRandom, this);
+    _link = 0;
+
+    _topics.reset(new MqttTopics(_deviceId.c_str()));
+    _firmware.reset(new Firmware(_deviceId.c_str()));
+    Firmware& f = *_firmware;
+    f.units.begin();
+    f.sensors.begin();
+    f.stateStore.begin();
+    IRProtocol protocol = irProtocolFromName(boot.irProtocol);
+    for (uint8_t i = 0; i < f.units.size(); i++) {
+        f.units[i].setProtocol(protocol);
+        if (boot.restored & (1 << i)) f.units[i].restore(boot.settings[i]);
+    }
+    bool logReady = LittleFS.begin(true) && f.telemetryLog.begin(TELEMETRY_LOG_PATH, TELEMETRY_LOG_RECORDS);
+    f.telemetry.begin(logReady ? &f.telemetryLog : nullptr);
+    f.schedule.begin();
+    if (boot.schedule.count || boot.schedule.version) f.schedule.install(boot.schedule);
+
+    f.network.attachQueues(f.commandQueue, f.statusQueue);
+    f.network.attachTelemetry(f.telemetry);
+    f.network.attachScheduler(f.schedule);
+    f.network.attachStateStore(f.stateStore);
+    f.network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    configTime(0, 0, NTP_SERVER);
+    return true;
+}
+
+void InputReplayer::apply(const RecordedInput& input) {
+    FakeBroker& broker = FakeBroker::instance();
+    switch (input.type) {
+        case RecordedEvent::MESSAGE: {
+            std::string suffix(input.suffix, input.suffixLength);
+            std::string topic = _topics->command + suffix;
+            _report.commands.push_back(ReplayCommand{sinceBoot(), suffix.empty() ? "-" : suffix, ReplayCommand::NO_ANSWER, 0});
+            _pending.push_back(PendingCommand{_report.commands.size() - 1, uint32_t(millis())});
+            // Chegou ao dispositivo, então passa mesmo com as publicações travadas
+            _injecting = true;
+            broker.setStalled(false);
+            broker.inject(topic.c_str(), input.data, unsigned(input.length));
+            broker.setStalled(_link & RECORDING_LINK_STALLED);
+            _injecting = false;
+            break;
+        }
+        case RecordedEvent::SENSOR:
+        case RecordedEvent::SENSOR_REPEAT:
+            _firmware->sensors.replay(input.result, input.reading, input.readMs);
+            break;
+        case RecordedEvent::LINK: {
+            bool wifi = input.link & RECORDING_LINK_WIFI;
+            if (wifi != bool(_link & RECORDING_LINK_WIFI)) WiFi.hostSetNetworkAvailable(wifi);
+            broker.setReachable(input.link & RECORDING_LINK_BROKER);
+            broker.setStalled(input.link & RECORDING_LINK_STALLED);
+            _link = input.link;
+            break;
+        }
+        case RecordedEvent::SOCKET:
+            broker.setReachable(input.opened);
+            broker.setConnectLatency(input.value, input.value);
+            _link = input.opened ? uint8_t(_link | RECORDING_LINK_BROKER) : uint8_t(_link & ~RECORDING_LINK_BROKER);
+            break;
+        case RecordedEvent::RANDOM:
+            _randoms.push_back(input.value);
+            break;
+        case RecordedEvent::CLOCK:
+            HostNtp::setEpoch(input.value);
+            HostNtp::setReachable(true);
+            break;
+        case RecordedEvent::LOST:
+            _report.lost += input.value;
+            break;
+        case RecordedEvent::BOOT:
+            break;
+    }
+}
+
+// CPU de um passo para os comandos ainda sem resposta
+void InputReplayer::account(uint64_t ns) {
+    for (const PendingCommand& pending : _pending) {
+        _report.commands[pending.index].cpuNs += ns;
+    }
+}
+
+void InputReplayer::finish() {
+    std::vector<uint64_t> sorted(_stepNs);
+    std::sort(sorted.begin(), sorted.end());
+    _report.steps = uint32_t(sorted.size());
+    _report.stepP50Ns = percentile(sorted, 500);
+    _report.stepP90Ns = percentile(sorted, 900);
+    _report.stepP99Ns = percentile(sorted, 990);
+    _report.stepMaxNs = sorted.empty() ? 0 : sorted.back();
+    for (uint64_t ns : sorted) _report.stepTotalNs += ns;
+    _pending.clear();
+    FakeBroker::instance().setObserver(nullptr, nullptr);
+    HostRandom::setSource(nullptr, nullptr);
+}
+
+uint32_t InputReplayer::sinceBoot() const {
+    return uint32_t(millis()) - _bootAt;
+}
+
+// Os sorteios do dispositivo, na ordem; se a reprodução pedir mais do que
+// houve, o meio do intervalo
+long InputReplayer::nextRandom(long max, void* context) {
+    InputReplayer* self = static_cast<InputReplayer*>(context);
+    if (self->_randoms.empty()) return max / 2;
+    uint32_t value = self->_randoms.front();
+    self->_randoms.pop_front();
+    return long(value) < max ? long(value) : max - 1;
+}
+
+void InputReplayer::observe(const FakeMessage& message, void* context) {
+    static_cast<InputReplayer*>(context)->onPublish(message);
+}
+
+void InputReplayer::onPublish(const FakeMessage& message) {
+    if (_injecting) return;
+    _report.outputs.push_back(ReplayOutput{sinceBoot(), message.topic, payloadText(message.payload, message.length)});
+    // Telemetria e diagnóstico saem no próprio ritmo: não respondem a nada
+    if (strcmp(message.topic, _topics->telemetry) == 0 || strcmp(message.topic, _topics->diagnostics) == 0) return;
+    for (const PendingCommand& pending : _pending) {
+        _report.commands[pending.index].latencyMs = uint32_t(millis()) - pending.injectedAt;
+    }
+    _pending.clear();
+}
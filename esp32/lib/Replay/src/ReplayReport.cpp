@@ -0,0 +1,231 @@
+#include "ReplayReport.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+// Próximo campo separado por espaço; o resto da linha fica em 'line'
+bool nextField(const char*& line, std::string& field) {
+    while (*line == ' ') line++;
+    const char* end = line;
+    while (*end && *end != ' ') end++;
+    if (end == line) return false;
+    field.assign(line, size_t(end - line));
+    line = end;
+    return true;
+}
+
+bool nextNumber(const char*& line, uint64_t& value) {
+    std::string field;
+    if (!nextField(line, field)) return false;
+    char* end = nullptr;
+    value = strtoull(field.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+bool nextNumber(const char*& line, uint32_t& value) {
+    uint64_t wide;
+    if (!nextNumber(line, wide) || wide > UINT32_MAX) return false;
+    value = uint32_t(wide);
+    return true;
+}
+
+// Latência: número ou "-" sem resposta
+bool nextLatency(const char*& line, uint32_t& value) {
+    const char* start = line;
+    std::string field;
+    if (!nextField(line, field)) return false;
+    if (field == "-") {
+        value = ReplayCommand::NO_ANSWER;
+        return true;
+    }
+    line = start;
+    return nextNumber(line, value);
+}
+
+std::string rest(const char* line) {
+    if (*line == ' ') line++;
+    return line;
+}
+
+bool sameOutput(const ReplayOutput& a, const ReplayOutput& b) {
+    return a.topic == b.topic && a.payload == b.payload;
+}
+
+void printOutput(FILE* out, char mark, const ReplayOutput& output) {
+    if (out) fprintf(out, "%c %u %s %s\n", mark, output.at, output.topic.c_str(), output.payload.c_str());
+}
+
+bool aboveTolerance(uint64_t base, uint64_t current, const ReplayTolerance& tolerance) {
+    return current > base && current - base >= tolerance.cpuFloorNs
+        && double(current) > double(base) * (1.0 + tolerance.cpu);
+}
+
+void compareOutputs(const ReplayReport& base, const ReplayReport& current, const ReplayTolerance& tolerance,
+                    FILE* out, ReplayDiff& diff) {
+    const std::vector<ReplayOutput>& a = base.outputs;
+    const std::vector<ReplayOutput>& b = current.outputs;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() || j < b.size()) {
+        if (i < a.size() && j < b.size() && sameOutput(a[i], b[j])) {
+            if (a[i].at != b[j].at) {
+                diff.shifted++;
+                if (out) fprintf(out, "~ %u -> %u %s\n", a[i].at, b[j].at, a[i].topic.c_str());
+            }
+            i++;
+            j++;
+            continue;
+        }
+        // Trocada quando as seguintes voltam a bater; senão, a menor volta
+        // que reencontra a sequência: saídas a mais de um lado ou faltando
+        // do outro
+        size_t extra = 0;
+        size_t missing = 0;
+        if (i + 1 < a.size() && j + 1 < b.size() && sameOutput(a[i + 1], b[j + 1])) {
+            extra = 1;
+            missing = 1;
+        }
+        for (size_t k = 1; k <= tolerance.resyncWindow && !extra && !missing; k++) {
+            if (i < a.size() && j + k < b.size() && sameOutput(a[i], b[j + k])) extra = k;
+            else if (j < b.size() && i + k < a.size() && sameOutput(a[i + k], b[j])) missing = k;
+        }
+        if (!extra && !missing) {
+            // Trocada: sai uma e entra outra
+            extra = j < b.size() ? 1 : 0;
+            missing = i < a.size() ? 1 : 0;
+        }
+        for (; missing; missing--, i++) {
+            diff.missing++;
+            printOutput(out, '-', a[i]);
+        }
+        for (; extra; extra--, j++) {
+            diff.extra++;
+            printOutput(out, '+', b[j]);
+        }
+    }
+}
+
+void compareCommands(const ReplayReport& base, const ReplayReport& current, const ReplayTolerance& tolerance,
+                     FILE* out, ReplayDiff& diff) {
+    size_t count = base.commands.size() < current.commands.size() ? base.commands.size() : current.commands.size();
+    for (size_t k = 0; k < count; k++) {
+        const ReplayCommand& a = base.commands[k];
+        const ReplayCommand& b = current.commands[k];
+        if (a.at != b.at || a.suffix != b.suffix) break;
+        if (b.latencyMs > a.latencyMs) {
+            diff.slower++;
+            if (out) {
+                fprintf(out, "latencia %u %s: ", a.at, a.suffix.c_str());
+                if (a.latencyMs == ReplayCommand::NO_ANSWER) fprintf(out, "- -> ");
+                else fprintf(out, "%u -> ", a.latencyMs);
+                if (b.latencyMs == ReplayCommand::NO_ANSWER) fprintf(out, "sem resposta\n");
+                else fprintf(out, "%u ms\n", b.latencyMs);
+            }
+        }
+        if (aboveTolerance(a.cpuNs, b.cpuNs, tolerance)) {
+            diff.cpu++;
+            if (out) {
+                fprintf(out, "cpu %u %s: %" PRIu64 " -> %" PRIu64 " ns\n", a.at, a.suffix.c_str(), a.cpuNs, b.cpuNs);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void writeReplayReport(FILE* out, const ReplayReport& report) {
+    fprintf(out, "gravacao %s %s %s\n", report.deviceId.c_str(), report.recordedFirmware.c_str(),
+            report.irProtocol.c_str());
+    fprintf(out, "firmware %s\n", report.firmware.c_str());
+    fprintf(out, "eventos %u duracao %u truncada %d perdidas %u\n", report.events, report.durationMs,
+            report.truncated ? 1 : 0, report.lost);
+    for (const ReplayOutput& output : report.outputs) {
+        fprintf(out, "saida %u %s %s\n", output.at, output.topic.c_str(), output.payload.c_str());
+    }
+    for (const ReplayCommand& command : report.commands) {
+        fprintf(out, "comando %u %s ", command.at, command.suffix.c_str());
+        if (command.latencyMs == ReplayCommand::NO_ANSWER) {
+            fprintf(out, "-");
+        } else {
+            fprintf(out, "%u", command.latencyMs);
+        }
+        fprintf(out, " %" PRIu64 "\n", command.cpuNs);
+    }
+    fprintf(out, "passos %u %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 "\n", report.steps,
+            report.stepP50Ns, report.stepP90Ns, report.stepP99Ns, report.stepMaxNs, report.stepTotalNs);
+}
+
+bool readReplayReport(FILE* in, ReplayReport& report, std::string& error) {
+    report = ReplayReport{};
+    std::string text;
+    char buffer[4096];
+    unsigned lineNumber = 0;
+    while (fgets(buffer, sizeof(buffer), in)) {
+        // Linha maior que o buffer: junta os pedaços
+        text += buffer;
+        if (text.back() != '\n' && !feof(in)) continue;
+        if (text.back() == '\n') text.pop_back();
+        lineNumber++;
+        const char* line = text.c_str();
+        std::string kind;
+        bool ok = true;
+        if (!nextField(line, kind)) {
+            text.clear();
+            continue;
+        }
+        uint32_t truncated = 0;
+        if (kind == "gravacao") {
+            ok = nextField(line, report.deviceId) && nextField(line, report.recordedFirmware)
+                && nextField(line, report.irProtocol);
+        } else if (kind == "firmware") {
+            report.firmware = rest(line);
+        } else if (kind == "eventos") {
+            std::string label;
+            ok = nextNumber(line, report.events) && nextField(line, label) && nextNumber(line, report.durationMs)
+                && nextField(line, label) && nextNumber(line, truncated) && nextField(line, label)
+                && nextNumber(line, report.lost);
+            report.truncated = truncated != 0;
+        } else if (kind == "saida") {
+            ReplayOutput output;
+            ok = nextNumber(line, output.at) && nextField(line, output.topic);
+            output.payload = rest(line);
+            report.outputs.push_back(output);
+        } else if (kind == "comando") {
+            ReplayCommand command;
+            ok = nextNumber(line, command.at) && nextField(line, command.suffix)
+                && nextLatency(line, command.latencyMs) && nextNumber(line, command.cpuNs);
+            report.commands.push_back(command);
+        } else if (kind == "passos") {
+            ok = nextNumber(line, report.steps) && nextNumber(line, report.stepP50Ns)
+                && nextNumber(line, report.stepP90Ns) && nextNumber(line, report.stepP99Ns)
+                && nextNumber(line, report.stepMaxNs) && nextNumber(line, report.stepTotalNs);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            error = "linha " + std::to_string(lineNumber) + " inválida: " + text;
+            return false;
+        }
+        text.clear();
+    }
+    return true;
+}
+
+ReplayDiff compareReplayReports(const ReplayReport& base, const ReplayReport& current,
+                                const ReplayTolerance& tolerance, FILE* out) {
+    ReplayDiff diff;
+    if (out && (base.deviceId != current.deviceId || base.events != current.events
+                || base.durationMs != current.durationMs)) {
+        fprintf(out, "aviso: relatórios de gravações diferentes (%s, %u eventos; %s, %u eventos)\n",
+                base.deviceId.c_str(), base.events, current.deviceId.c_str(), current.events);
+    }
+    compareOutputs(base, current, tolerance, out, diff);
+    compareCommands(base, current, tolerance, out, diff);
+    if (aboveTolerance(base.stepP99Ns, current.stepP99Ns, tolerance)) {
+        diff.cpu++;
+        if (out) fprintf(out, "cpu passos p99: %" PRIu64 " -> %" PRIu64 " ns\n", base.stepP99Ns, current.stepP99Ns);
+    }
+    return diff;
+}
@@ -0,0 +1,59 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "ScheduleCodec.h"
+#include "config.h"
+
+// Agenda semanal executada no próprio dispositivo: a tabela chega uma vez
+// pelo comando AGENDA, fica gravada na NVS e as transições disparam pela
+// hora do NTP, com ou sem broker.
+//
+// Precedência: a última ordem vence. Um comando manual vale até a próxima
+// transição da agenda, que então se impõe; a agenda nunca reaplica uma
+// transição que já passou. As exceções são os momentos em que não se sabe o
+// que veio antes (boot, primeira hora do NTP, agenda nova ou religada): aí
+// a transição em vigor é aplicada uma vez para alcançar o horário.
+//
+// A próxima transição fica armada em minutos locais absolutos, então cada
+// poll() é uma comparação; só ao disparar (ou quando o relógio salta) há
+// uma busca binária na tabela. Sem heap. Uso de uma tarefa só (a de rede).
+class Scheduler {
+public:
+    Scheduler();
+
+    // Carrega a agenda gravada na NVS, se houver
+    void begin();
+    // Troca a agenda e grava na NVS. Uma tabela idêntica à atual não faz
+    // nada (nem regrava a flash, nem reaplica o horário). false se a
+    // gravação falhou: a agenda nova vale mesmo assim até o reboot.
+    bool install(const ScheduleTable& table);
+
+    // Consulta o relógio no máximo a cada SCHEDULE_POLL_INTERVAL; com uma
+    // transição vencida preenche 'command' (SET_STATE) e retorna true
+    bool poll(ACCommand& command);
+    // O mesmo com a hora UTC em minutos desde 1970 (poll() e testes)
+    bool pollAt(uint32_t utcMinute, ACCommand& command);
+
+    const ScheduleTable& table() const { return _table; }
+    bool active() const { return _table.enabled && _table.count; }
+    bool clockSynced() const { return _clockSynced; }
+    // Minuto local absoluto da próxima transição; 0 antes do primeiro poll
+    uint32_t nextTransition() const { return _armed ? _nextAt : 0; }
+
+    // Hora UTC em minutos desde 1970 a partir de getLocalTime() com fuso 0
+    static uint32_t utcMinutes(const struct tm& time);
+
+private:
+    size_t upperBound(uint16_t minuteOfWeek) const;
+
+    ScheduleTable _table;
+    bool _armed;
+    bool _clockSynced;
+    uint32_t _nextAt;           // minuto local absoluto da próxima transição
+    uint32_t _lastLocal;        // minuto local do último poll
+    unsigned long _lastPoll;
+    bool _polled;
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,140 @@
+#include "Scheduler.h"
+#include <Preferences.h>
+#include <string.h>
+#include "HeapGuard.h"
+#include "InputRecorder.h"
+
+namespace {
+
+const char* const NVS_KEY = "tabela";
+
+// 1970-01-01 foi uma quinta-feira
+uint16_t minuteOfWeek(uint32_t localMinute) {
+    uint32_t day = localMinute / MINUTES_PER_DAY;
+    return uint16_t((day + 4) % 7 * MINUTES_PER_DAY + localMinute % MINUTES_PER_DAY);
+}
+
+bool sameTable(const ScheduleTable& a, const ScheduleTable& b) {
+    return a.version == b.version && a.utcOffset == b.utcOffset && a.enabled == b.enabled
+        && a.count == b.count
+        && memcmp(a.transitions, b.transitions, a.count * sizeof(ScheduleTransition)) == 0;
+}
+
+}  // namespace
+
+Scheduler::Scheduler()
+    : _table{},
+      _armed(false),
+      _clockSynced(false),
+      _nextAt(0),
+      _lastLocal(0),
+      _lastPoll(0),
+      _polled(false) {
+}
+
+void Scheduler::begin() {
+    _table = ScheduleTable{};
+    _armed = false;
+
+    Preferences nvs;
+    if (!nvs.begin(SCHEDULE_NVS_NAMESPACE, true)) return;
+    uint8_t blob[SCHEDULE_BLOB_CAPACITY];
+    size_t length = nvs.getBytes(NVS_KEY, blob, sizeof(blob));
+    nvs.end();
+    if (length && !unpackScheduleTable(blob, length, _table)) {
+        Serial.println("Agenda gravada inválida; ignorada");
+        _table = ScheduleTable{};
+    }
+}
+
+bool Scheduler::install(const ScheduleTable& table) {
+    if (sameTable(table, _table)) return true;
+
+    _table = table;
+    _armed = false;
+
+    uint8_t blob[SCHEDULE_BLOB_CAPACITY];
+    size_t length = packScheduleTable(_table, blob);
+    // Gravação rara, pedida pelo servidor; a NVS aloca por conta própria
+    HeapGuard::Vendor vendor;
+    Preferences nvs;
+    if (!nvs.begin(SCHEDULE_NVS_NAMESPACE, false)) return false;
+    bool stored = nvs.putBytes(NVS_KEY, blob, length) == length;
+    nvs.end();
+    return stored;
+}
+
+bool Scheduler::poll(ACCommand& command) {
+    if (!active()) return false;
+    unsigned long now = millis();
+    if (_polled && now - _lastPoll < SCHEDULE_POLL_INTERVAL) return false;
+    _polled = true;
+    _lastPoll = now;
+
+    // Sem espera: sem hora ainda, tenta de novo no próximo intervalo
+    struct tm time;
+    _clockSynced = getLocalTime(&time, 0);
+    if (!_clockSynced) return false;
+    uint32_t minute = utcMinutes(time);
+    inputRecorder.clock(minute, uint8_t(time.tm_sec));
+    return pollAt(minute, command);
+}
+
+bool Scheduler::pollAt(uint32_t utcMinute, ACCommand& command) {
+    if (!active()) return false;
+    uint32_t local = uint32_t(int64_t(utcMinute) + _table.utcOffset);
+
+    // Caminho comum: nada venceu e o relógio só andou para a frente
+    if (_armed && local >= _lastLocal && local < _nextAt) {
+        _lastLocal = local;
+        return false;
+    }
+
+    // Disparo, alcance do horário ou relógio que voltou (aí só rearma: a
+    // transição de novo à frente dispara quando chegar)
+    bool fire = !_armed || local >= _nextAt;
+    uint16_t minute = minuteOfWeek(local);
+    size_t after = upperBound(minute);
+    uint32_t weekStart = local - minute;
+    if (after < _table.count) {
+        _nextAt = weekStart + _table.transitions[after].minute;
+    } else {
+        _nextAt = weekStart + MINUTES_PER_WEEK + _table.transitions[0].minute;
+    }
+    _armed = true;
+    _lastLocal = local;
+    if (!fire) return false;
+
+    // Várias vencidas de uma vez (relógio saltou): só a última vale
+    const ScheduleTransition& current = _table.transitions[after ? after - 1 : _table.count - 1];
+    command = current.command();
+    return true;
+}
+
+// Primeira transição depois do minuto
+size_t Scheduler::upperBound(uint16_t minuteOfWeek) const {
+    size_t low = 0;
+    size_t high = _table.count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (_table.transitions[mid].minute <= minuteOfWeek) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+uint32_t Scheduler::utcMinutes(const struct tm& time) {
+    // Dias desde 1970 pelo calendário civil (algoritmo de H. Hinnant)
+    int32_t year = time.tm_year + 1900;
+    int32_t month = time.tm_mon + 1;
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    int32_t yearOfEra = year - era * 400;
+    int32_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + time.tm_mday - 1;
+    int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int32_t days = era * 146097 + dayOfEra - 719468;
+    return uint32_t(days) * MINUTES_PER_DAY + uint32_t(time.tm_hour * 60 + time.tm_min);
+}
@@ -0,0 +1,88 @@
+#ifndef DHT22_H
+#define DHT22_H
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+
+// Resultado de uma leitura do DHT22
+enum class Dht22Result : uint8_t {
+    IDLE,           // nenhuma leitura em andamento
+    PENDING,        // em andamento: chame poll() de novo
+    OK,
+    NO_RESPONSE,    // sensor não respondeu ao pulso de início
+    BAD_FRAME,      // pulsos fora do formato (bits faltando, ruído)
+    CHECKSUM,
+    OUT_OF_RANGE    // frame íntegro com valor fora da faixa do sensor
+};
+
+// Formato do quadro do DHT22/AM2302: após o pulso de início do host, o
+// sensor responde 80 µs baixo + 80 µs alto e envia 40 bits, cada um com
+// 50 µs baixo seguido de 26-28 µs (0) ou 70 µs (1) alto: umidade x10 (16
+// bits), temperatura x10 (16 bits, bit 15 = sinal) e a soma dos 4 bytes.
+namespace Dht22 {
+    constexpr uint8_t FRAME_BYTES = 5;
+    constexpr uint8_t FRAME_BITS = FRAME_BYTES * 8;
+    constexpr uint32_t START_LOW_US = 1100;         // datasheet: no mínimo 1 ms
+    constexpr uint32_t RESPONSE_TIMEOUT_US = 10000; // quadro completo leva ~5 ms
+    constexpr uint16_t ONE_THRESHOLD_US = 48;       // entre 28 (0) e 70 (1)
+    constexpr uint16_t MAX_BIT_HIGH_US = 100;
+    constexpr uint32_t MIN_INTERVAL_MS = 2000;      // no máximo 0,5 Hz
+
+    constexpr float MIN_TEMPERATURE = -40.0f;
+    constexpr float MAX_TEMPERATURE = 80.0f;
+    constexpr float MAX_HUMIDITY = 100.0f;
+
+    struct Reading {
+        float temperature;      // NAN se fora da faixa
+        float humidity;         // NAN se fora da faixa
+    };
+
+    constexpr uint8_t checksum(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) {
+        return uint8_t(b0 + b1 + b2 + b3);
+    }
+
+    // Bytes -> leitura. OUT_OF_RANGE quando ao menos uma grandeza é
+    // implausível; a outra continua em reading.
+    Dht22Result decodeFrame(const uint8_t (&bytes)[FRAME_BYTES], Reading& reading);
+
+    // Itens capturados pelo RMT (1 tick = 1 µs) -> bytes. Usa os últimos 40
+    // níveis altos, de modo que a resposta de 80 µs pode ou não ter entrado.
+    Dht22Result decodeItems(const rmt_item32_t* items, size_t count, uint8_t (&bytes)[FRAME_BYTES]);
+}
+
+// Leitor do DHT22 sem espera ocupada e sem desabilitar interrupções.
+// O pulso de início é só um prazo entre duas chamadas de poll(); os bits de
+// resposta são medidos pelo receptor do RMT, que entrega o quadro inteiro
+// num ring buffer. Uma leitura leva ~6 ms em que poll() deve ser chamado a
+// cada ~1 ms (ver busy()); fora disso a tarefa pode dormir.
+class Dht22Reader {
+public:
+    Dht22Reader(uint8_t pin, rmt_channel_t channel = RMT_CHANNEL_4);
+    ~Dht22Reader();
+
+    bool begin();
+    // Inicia uma leitura; false se já há uma em andamento ou sem begin()
+    bool start();
+    // Avança a leitura; devolve PENDING até terminar e então o resultado,
+    // uma única vez (depois IDLE)
+    Dht22Result poll(Dht22::Reading& reading);
+    bool busy() const { return _phase != Phase::IDLE; }
+
+private:
+    enum class Phase : uint8_t {
+        IDLE,
+        START_LOW,      // linha em nível baixo pelo host
+        CAPTURE         // linha solta, RMT recebendo
+    };
+
+    uint8_t _pin;
+    rmt_channel_t _channel;
+    RingbufHandle_t _ring;
+    bool _installed;
+    Phase _phase;
+    uint32_t _phaseStartUs;
+
+    void finish();
+};
+
+#endif // DHT22_H
@@ -0,0 +1,41 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+
+// Janela circular de tamanho fixo que guarda os N itens mais recentes: ao
+// encher, push() sobrescreve o mais antigo. Armazenamento interno, sem heap;
+// não é segura entre tarefas (use SpscQueue para isso).
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(N > 0, "RingBuffer: N deve ser maior que zero");
+
+public:
+    RingBuffer() : _items(), _next(0), _count(0) {}
+
+    void push(const T& item) {
+        _items[_next] = item;
+        _next = _next + 1 == N ? 0 : _next + 1;
+        if (_count < N) _count++;
+    }
+
+    // 0 = mais antigo, size() - 1 = mais recente
+    const T& operator[](size_t index) const {
+        size_t slot = _next + N - _count + index;
+        return _items[slot >= N ? slot - N : slot];
+    }
+    const T& newest() const { return (*this)[_count - 1]; }
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    bool full() const { return _count == N; }
+    static constexpr size_t capacity() { return N; }
+    void clear() { _next = _count = 0; }
+
+private:
+    T _items[N];
+    size_t _next;
+    size_t _count;
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,72 @@
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+#include "ACState.h"
+#include "RingBuffer.h"
+
+// Filtro de uma grandeza (temperatura ou umidade).
+// 1. Mediana das últimas MEDIAN_WINDOW leituras válidas: um pico isolado
+//    (bit trocado que passou no checksum, interferência) nunca chega à saída.
+// 2. Média exponencial sobre a mediana para tirar o ruído do último dígito.
+//    Um degrau maior que snapBand é real (porta aberta, AC ligou) e passa
+//    direto, sem a cauda da média, para não atrasar o controle.
+// A saída é arredondada em resolution (0,1 no DHT22).
+class SensorFilter {
+public:
+    static const uint8_t MEDIAN_WINDOW = 5;
+
+    SensorFilter(float alpha, float snapBand, float resolution = 0.1f);
+
+    // Retorna o valor filtrado já com a nova leitura (que precisa ser válida)
+    float push(float value);
+    float value() const { return _output; }
+    bool ready() const { return !_window.empty(); }
+    void reset();
+
+    float median() const;
+
+private:
+    RingBuffer<float, MEDIAN_WINDOW> _window;
+    float _alpha;
+    float _snapBand;
+    float _resolution;
+    float _ema;
+    float _output;
+};
+
+// Mínimo/máximo/média das leituras entre duas chamadas de close()
+class SensorWindow {
+public:
+    SensorWindow() { reset(); }
+
+    void add(float value);
+    // Estatísticas da janela que termina agora; começa outra vazia
+    SensorStats close();
+    uint16_t samples() const { return _samples; }
+    void reset();
+
+private:
+    float _min;
+    float _max;
+    float _sum;
+    uint16_t _samples;
+};
+
+// Saúde a partir do histórico das últimas 8 tentativas de leitura
+class SensorHealthTracker {
+public:
+    explicit SensorHealthTracker(uint8_t failAfter)
+        : _failAfter(failAfter ? failAfter : 1), _history(0), _attempts(0) {}
+
+    void record(bool valid);
+    SensorHealth health() const;
+    void reset() { _history = 0; _attempts = 0; }
+
+private:
+    uint8_t _failAfter;
+    uint8_t _history;       // bit 0 = tentativa mais recente; 1 = falhou
+    uint8_t _attempts;      // satura em 8
+};
+
+#endif // SENSOR_FILTER_H
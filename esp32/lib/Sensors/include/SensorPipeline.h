@@ -0,0 +1,62 @@
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include <Arduino.h>
+#include "ACState.h"
+#include "Dht22.h"
+#include "SensorFilter.h"
+
+// Amostragem de um DHT22 de ponta a ponta: dispara uma leitura a cada
+// SAMPLE_INTERVAL, valida (checksum, faixa), filtra cada grandeza, acumula
+// mínimo/máximo/média por janela de relatório e acompanha a saúde.
+// Nada aqui espera: step() só avança a máquina de estados do leitor.
+class SensorPipeline {
+public:
+    static const uint32_t SAMPLE_INTERVAL = Dht22::MIN_INTERVAL_MS;
+
+    SensorPipeline(uint8_t dhtPin, rmt_channel_t channel = RMT_CHANNEL_4);
+    bool begin();
+
+    // true quando uma tentativa de leitura terminou (com ou sem sucesso) e
+    // sample() tem o resultado
+    bool step();
+    const SensorSample& sample() const { return _sample; }
+    // Uma leitura que terminou agora e durou 'readMs', sem o DHT22: a
+    // reprodução de uma gravação (lib/Replay) no lugar de step()
+    void replay(Dht22Result result, const Dht22::Reading& reading, uint32_t readMs);
+
+    // Leitura em andamento: step() deve voltar em ~1 ms
+    bool busy() const { return _reader.busy(); }
+    Dht22Result lastResult() const { return _lastResult; }
+    // Valores crus e duração da última leitura, para o gravador de entradas
+    const Dht22::Reading& lastReading() const { return _reading; }
+    uint32_t lastReadMs() const { return _readMs; }
+    void setWindowInterval(uint32_t ms) { _windowMs = ms; }
+
+private:
+    struct Channel {
+        SensorFilter filter;
+        SensorWindow window;
+        SensorHealthTracker health;
+
+        // Devolve o valor filtrado, ou NAN se a leitura é inválida
+        float record(float value);
+    };
+
+    void accept(Dht22Result result, const Dht22::Reading& reading, uint32_t readMs, uint32_t now);
+
+    Dht22Reader _reader;
+    Channel _temperature;
+    Channel _humidity;
+    SensorSample _sample;
+    Dht22Result _lastResult;
+    Dht22::Reading _reading;
+    uint32_t _readMs;
+    uint32_t _windowMs;
+    uint32_t _windowStart;
+    uint32_t _lastStart;
+    unsigned long _startUs;
+    bool _started;
+};
+
+#endif // SENSOR_PIPELINE_H
@@ -0,0 +1,152 @@
+#include "Dht22.h"
+
+namespace Dht22 {
+
+Dht22Result decodeFrame(const uint8_t (&bytes)[FRAME_BYTES], Reading& reading) {
+    if (checksum(bytes[0], bytes[1], bytes[2], bytes[3]) != bytes[4]) {
+        return Dht22Result::CHECKSUM;
+    }
+
+    uint16_t humidity = uint16_t(bytes[0] << 8 | bytes[1]);
+    uint16_t temperature = uint16_t((bytes[2] & 0x7F) << 8 | bytes[3]);
+    reading.humidity = humidity * 0.1f;
+    reading.temperature = (bytes[2] & 0x80) ? temperature * -0.1f : temperature * 0.1f;
+
+    bool valid = true;
+    if (reading.humidity > MAX_HUMIDITY) {
+        reading.humidity = NAN;
+        valid = false;
+    }
+    if (reading.temperature < MIN_TEMPERATURE || reading.temperature > MAX_TEMPERATURE) {
+        reading.temperature = NAN;
+        valid = false;
+    }
+    return valid ? Dht22Result::OK : Dht22Result::OUT_OF_RANGE;
+}
+
+Dht22Result decodeItems(const rmt_item32_t* items, size_t count, uint8_t (&bytes)[FRAME_BYTES]) {
+    // Duração zero marca o fim da captura (linha ociosa em alto)
+    size_t highs = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (items[i].level0 && items[i].duration0) highs++;
+        if (items[i].level1 && items[i].duration1) highs++;
+    }
+    if (highs < FRAME_BITS) {
+        return Dht22Result::BAD_FRAME;
+    }
+
+    size_t skip = highs - FRAME_BITS;
+    uint8_t bit = 0;
+    for (size_t i = 0; i < count && bit < FRAME_BITS; i++) {
+        for (uint8_t half = 0; half < 2 && bit < FRAME_BITS; half++) {
+            uint32_t level = half ? items[i].level1 : items[i].level0;
+            uint32_t duration = half ? items[i].duration1 : items[i].duration0;
+            if (!level || !duration) continue;
+            if (skip) {
+                skip--;
+                continue;
+            }
+            if (duration > MAX_BIT_HIGH_US) return Dht22Result::BAD_FRAME;
+            uint8_t& byte = bytes[bit / 8];
+            byte = uint8_t(byte << 1 | (duration > ONE_THRESHOLD_US ? 1 : 0));
+            bit++;
+        }
+    }
+    return Dht22Result::OK;
+}
+
+} // namespace Dht22
+
+Dht22Reader::Dht22Reader(uint8_t pin, rmt_channel_t channel)
+    : _pin(pin),
+      _channel(channel),
+      _ring(nullptr),
+      _installed(false),
+      _phase(Phase::IDLE),
+      _phaseStartUs(0) {
+}
+
+Dht22Reader::~Dht22Reader() {
+    if (_installed) {
+        rmt_driver_uninstall(_channel);
+    }
+}
+
+bool Dht22Reader::begin() {
+    rmt_config_t config = RMT_DEFAULT_CONFIG_RX(gpio_num_t(_pin), _channel);
+    config.clk_div = 80;                            // 1 tick = 1 µs
+    config.mem_block_num = 1;                       // 64 itens; o quadro usa 42
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = 100;     // ignora glitches < 1,25 µs
+    config.rx_config.idle_threshold = 200;          // 200 µs em alto: fim do quadro
+
+    // Um begin() repetido reinstala o driver do canal
+    rmt_driver_uninstall(_channel);
+    _installed = rmt_config(&config) == ESP_OK
+        && rmt_driver_install(_channel, 512, 0) == ESP_OK
+        && rmt_get_ringbuf_handle(_channel, &_ring) == ESP_OK;
+    _phase = Phase::IDLE;
+    pinMode(_pin, INPUT_PULLUP);
+    if (!_installed) {
+        Serial.println("Falha ao iniciar o RMT do DHT22");
+    }
+    return _installed;
+}
+
+bool Dht22Reader::start() {
+    if (!_installed || busy()) return false;
+    pinMode(_pin, OUTPUT);
+    digitalWrite(_pin, LOW);
+    _phase = Phase::START_LOW;
+    _phaseStartUs = micros();
+    return true;
+}
+
+Dht22Result Dht22Reader::poll(Dht22::Reading& reading) {
+    switch (_phase) {
+        case Phase::IDLE:
+            return Dht22Result::IDLE;
+
+        case Phase::START_LOW: {
+            if (micros() - _phaseStartUs < Dht22::START_LOW_US) {
+                return Dht22Result::PENDING;
+            }
+            // Sobras de uma captura anterior não podem virar esta leitura
+            size_t size = 0;
+            while (void* stale = xRingbufferReceive(_ring, &size, 0)) {
+                vRingbufferReturnItem(_ring, stale);
+            }
+            // Solta a linha (pull-up) e devolve o pino ao receptor do RMT
+            pinMode(_pin, INPUT_PULLUP);
+            rmt_set_gpio(_channel, RMT_MODE_RX, gpio_num_t(_pin), false);
+            rmt_rx_start(_channel, true);
+            _phase = Phase::CAPTURE;
+            _phaseStartUs = micros();
+            return Dht22Result::PENDING;
+        }
+
+        case Phase::CAPTURE: {
+            size_t size = 0;
+            rmt_item32_t* items = static_cast<rmt_item32_t*>(xRingbufferReceive(_ring, &size, 0));
+            if (!items) {
+                if (micros() - _phaseStartUs < Dht22::RESPONSE_TIMEOUT_US) {
+                    return Dht22Result::PENDING;
+                }
+                finish();
+                return Dht22Result::NO_RESPONSE;
+            }
+
+            uint8_t bytes[Dht22::FRAME_BYTES] = {0};
+            Dht22Result result = Dht22::decodeItems(items, size / sizeof(rmt_item32_t), bytes);
+            vRingbufferReturnItem(_ring, items);
+            finish();
+            return result == Dht22Result::OK ? Dht22::decodeFrame(bytes, reading) : result;
+        }
+    }
+    return Dht22Result::IDLE;
+}
+
+void Dht22Reader::finish() {
+    rmt_rx_stop(_channel);
+    _phase = Phase::IDLE;
+}
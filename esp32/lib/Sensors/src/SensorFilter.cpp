@@ -0,0 +1,89 @@
+#include "SensorFilter.h"
+#include <math.h>
+
+SensorFilter::SensorFilter(float alpha, float snapBand, float resolution)
+    : _alpha(alpha),
+      _snapBand(snapBand),
+      _resolution(resolution),
+      _ema(0.0f),
+      _output(NAN) {
+}
+
+void SensorFilter::reset() {
+    _window.clear();
+    _ema = 0.0f;
+    _output = NAN;
+}
+
+// Ordenação por inserção numa cópia: com 5 itens é mais barata que
+// qualquer seleção com partição
+float SensorFilter::median() const {
+    float sorted[MEDIAN_WINDOW];
+    size_t count = _window.size();
+    for (size_t i = 0; i < count; i++) {
+        float value = _window[i];
+        size_t j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    if (count & 1) return sorted[count / 2];
+    return (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5f;
+}
+
+float SensorFilter::push(float value) {
+    bool first = _window.empty();
+    _window.push(value);
+    float middle = median();
+
+    if (first || fabsf(middle - _ema) >= _snapBand) {
+        _ema = middle;
+    } else {
+        _ema += _alpha * (middle - _ema);
+    }
+    _output = _resolution > 0.0f ? roundf(_ema / _resolution) * _resolution : _ema;
+    return _output;
+}
+
+void SensorWindow::reset() {
+    _min = INFINITY;
+    _max = -INFINITY;
+    _sum = 0.0f;
+    _samples = 0;
+}
+
+void SensorWindow::add(float value) {
+    if (value < _min) _min = value;
+    if (value > _max) _max = value;
+    _sum += value;
+    if (_samples < UINT16_MAX) _samples++;
+}
+
+SensorStats SensorWindow::close() {
+    SensorStats stats{NAN, NAN, NAN, _samples};
+    if (_samples) {
+        stats.min = _min;
+        stats.max = _max;
+        stats.mean = _sum / _samples;
+    }
+    reset();
+    return stats;
+}
+
+void SensorHealthTracker::record(bool valid) {
+    _history = uint8_t(_history << 1 | (valid ? 0 : 1));
+    if (_attempts < 8) _attempts++;
+}
+
+SensorHealth SensorHealthTracker::health() const {
+    if (_attempts == 0) return SensorHealth::UNKNOWN;
+    uint8_t all = _attempts >= 8 ? 0xFF : uint8_t((1u << _attempts) - 1);
+    // Ainda sem nenhuma leitura boa, mas sem falhas suficientes para desistir
+    if (_history == all && _attempts < _failAfter) return SensorHealth::UNKNOWN;
+
+    uint8_t recent = _failAfter >= 8 ? 0xFF : uint8_t((1u << _failAfter) - 1);
+    if ((_history & recent) == recent) return SensorHealth::FAILED;
+    return _history ? SensorHealth::DEGRADED : SensorHealth::OK;
+}
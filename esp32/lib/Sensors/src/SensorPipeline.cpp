@@ -0,0 +1,85 @@
+#include "SensorPipeline.h"
+#include "config.h"
+#include "Metrics.h"
+
+SensorPipeline::SensorPipeline(uint8_t dhtPin, rmt_channel_t channel)
+    : _reader(dhtPin, channel),
+      _temperature{SensorFilter(SENSOR_EMA_ALPHA, SENSOR_TEMP_SNAP), SensorWindow(), SensorHealthTracker(SENSOR_FAIL_AFTER)},
+      _humidity{SensorFilter(SENSOR_EMA_ALPHA, SENSOR_HUMIDITY_SNAP), SensorWindow(), SensorHealthTracker(SENSOR_FAIL_AFTER)},
+      _sample{NAN, NAN, SensorHealth::UNKNOWN, SensorHealth::UNKNOWN},
+      _lastResult(Dht22Result::IDLE),
+      _reading{NAN, NAN},
+      _readMs(0),
+      _windowMs(SENSOR_WINDOW_INTERVAL),
+      _windowStart(0),
+      _lastStart(0),
+      _startUs(0),
+      _started(false) {
+}
+
+bool SensorPipeline::begin() {
+    return _reader.begin();
+}
+
+float SensorPipeline::Channel::record(float value) {
+    bool valid = !isnan(value);
+    health.record(valid);
+    if (!valid) return NAN;
+    float filtered = filter.push(value);
+    window.add(filtered);
+    return filtered;
+}
+
+bool SensorPipeline::step() {
+    uint32_t now = millis();
+    if (!_reader.busy()) {
+        if (_started && now - _lastStart < SAMPLE_INTERVAL) return false;
+        if (!_reader.start()) return false;
+        if (!_started) _windowStart = now;
+        _lastStart = now;
+        _startUs = micros();
+        _started = true;
+        return false;
+    }
+
+    Dht22::Reading reading{NAN, NAN};
+    Dht22Result result = _reader.poll(reading);
+    if (result == Dht22Result::PENDING) return false;
+    uint32_t readUs = uint32_t(micros() - _startUs);
+    Metrics::record(Metrics::Latency::SENSOR_READ, readUs);
+    accept(result, reading, readUs / 1000, now);
+    return true;
+}
+
+void SensorPipeline::replay(Dht22Result result, const Dht22::Reading& reading, uint32_t readMs) {
+    uint32_t now = millis();
+    if (!_started) _windowStart = now - readMs;
+    _lastStart = now - readMs;
+    _started = true;
+    Metrics::record(Metrics::Latency::SENSOR_READ, readMs * 1000);
+    accept(result, reading, readMs, now);
+}
+
+// Uma leitura terminada, do DHT22 ou da gravação
+void SensorPipeline::accept(Dht22Result result, const Dht22::Reading& reading, uint32_t readMs, uint32_t now) {
+    _lastResult = result;
+    _reading = reading;
+    _readMs = readMs;
+    if (result != Dht22Result::OK) {
+        Metrics::increment(Metrics::Counter::SENSOR_FAILURES);
+    }
+
+    // Fora da faixa invalida só a grandeza afetada; os demais erros, as duas
+    bool framed = result == Dht22Result::OK || result == Dht22Result::OUT_OF_RANGE;
+    _sample.temperature = _temperature.record(framed ? reading.temperature : NAN);
+    _sample.humidity = _humidity.record(framed ? reading.humidity : NAN);
+    _sample.temperatureHealth = _temperature.health.health();
+    _sample.humidityHealth = _humidity.health.health();
+
+    _sample.windowClosed = now - _windowStart >= _windowMs;
+    if (_sample.windowClosed) {
+        _sample.temperatureStats = _temperature.window.close();
+        _sample.humidityStats = _humidity.window.close();
+        _windowStart = now;
+    }
+}
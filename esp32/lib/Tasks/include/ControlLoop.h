@@ -0,0 +1,36 @@
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+#include "ACController.h"
+#include "ACUnits.h"
+#include "TaskQueues.h"
+
+// Corpo da tarefa de controle/IR: única dona dos ACController. Consome
+// comandos e leituras, alimenta os transmissores IR e devolve o status à
+// tarefa de rede.
+class ControlLoop {
+public:
+    ControlLoop(ACController& ac, CommandQueue& commands, SensorQueue& samples, StatusQueue& status);
+    // Vários aparelhos: cada comando vai para o da sua unidade e cada
+    // leitura do sensor da sala, para todos
+    template <size_t N>
+    ControlLoop(ACUnits<N>& units, CommandQueue& commands, SensorQueue& samples, StatusQueue& status)
+        : ControlLoop(units.data(), N, commands, samples, status) {
+    }
+    ControlLoop(ACController* units, uint8_t count, CommandQueue& commands, SensorQueue& samples,
+                StatusQueue& status);
+
+    // Processa o que estiver nas filas; retorna quantas mensagens consumiu
+    uint16_t step();
+
+private:
+    ACController* _units;
+    uint8_t _count;
+    CommandQueue& _commands;
+    SensorQueue& _samples;
+    StatusQueue& _status;
+    uint8_t _commandPending;    // um bit por unidade
+    uint8_t _commandTrace[AC_MAX_UNITS];
+};
+
+#endif // CONTROL_LOOP_H
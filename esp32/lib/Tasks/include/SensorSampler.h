@@ -0,0 +1,31 @@
+#ifndef SENSOR_SAMPLER_H
+#define SENSOR_SAMPLER_H
+
+#include <Arduino.h>
+#include "SensorPipeline.h"
+#include "TaskQueues.h"
+
+// Corpo da tarefa de sensores: amostra o DHT22 no próprio ritmo, fora da
+// tarefa de controle, e envia cada leitura já filtrada (ou a falha, para a
+// saúde do sensor chegar ao status).
+class SensorSampler {
+public:
+    static const uint32_t SAMPLE_INTERVAL = SensorPipeline::SAMPLE_INTERVAL;
+
+    SensorSampler(uint8_t dhtPin, SensorQueue& samples);
+    void begin();
+
+    // Avança a leitura em andamento; true se enfileirou uma amostra
+    bool step();
+    // Leitura de uma gravação no lugar do DHT22 (SensorPipeline::replay)
+    bool replay(Dht22Result result, const Dht22::Reading& reading, uint32_t readMs);
+    // Leitura em andamento: chamar step() de novo em ~1 ms
+    bool busy() const { return _pipeline.busy(); }
+    const SensorPipeline& pipeline() const { return _pipeline; }
+
+private:
+    SensorPipeline _pipeline;
+    SensorQueue& _samples;
+};
+
+#endif // SENSOR_SAMPLER_H
@@ -0,0 +1,62 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#ifdef NATIVE_HOST
+#define SPSC_CACHE_LINE 64
+#else
+#define SPSC_CACHE_LINE 4   // SRAM interna do ESP32 não passa por cache
+#endif
+
+// Fila circular sem trava para exatamente um produtor e um consumidor
+// (cada um em sua tarefa/núcleo). O armazenamento é interno, sem heap.
+// head só é escrito pelo consumidor e tail só pelo produtor; a ordem
+// acquire/release garante que o consumidor veja o item já copiado.
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue: N deve ser potência de 2");
+
+public:
+    SpscQueue() : _head(0), _tail(0) {}
+
+    // Produtor: false quando cheia (o item não é copiado)
+    bool push(const T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        _items[tail & (N - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: false quando vazia
+    bool pop(T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = _items[head & (N - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Aproximados quando chamados pela outra ponta
+    size_t size() const {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    // No host, índices em linhas de cache separadas para o produtor e o
+    // consumidor não disputarem a mesma linha
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> _head;
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> _tail;
+    T _items[N];
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,26 @@
+#ifndef TASK_QUEUES_H
+#define TASK_QUEUES_H
+
+#include "ACState.h"
+#include "SpscQueue.h"
+
+// Mensagens trocadas entre as tarefas do firmware:
+//   rede (núcleo 0)  --ACCommand-->    controle/IR (núcleo 1)
+//   sensores (núc. 1) --SensorSample--> controle/IR
+//   controle/IR      --StatusUpdate--> rede
+// Só a tarefa de controle toca o ACController. SensorSample está em ACState.h.
+
+struct StatusUpdate {
+    ACStatus status;
+    uint8_t fields;         // StatusField alterados desde o último envio
+    bool afterCommand;      // resposta a comandos: publicar imediatamente
+    uint8_t unit = 0;       // aparelho de origem (ACUnits)
+    uint8_t trace = 0;      // último comando rastreado a que o status responde
+    CommandTiming ir{};     // IR de um comando rastreado que terminou (trace 0: nenhum)
+};
+
+typedef SpscQueue<ACCommand, 16> CommandQueue;
+typedef SpscQueue<SensorSample, 4> SensorQueue;
+typedef SpscQueue<StatusUpdate, 8> StatusQueue;
+
+#endif // TASK_QUEUES_H
@@ -0,0 +1,68 @@
+#include "ControlLoop.h"
+#include "Metrics.h"
+
+ControlLoop::ControlLoop(ACController& ac, CommandQueue& commands, SensorQueue& samples, StatusQueue& status)
+    : ControlLoop(&ac, 1, commands, samples, status) {
+}
+
+ControlLoop::ControlLoop(ACController* units, uint8_t count, CommandQueue& commands, SensorQueue& samples,
+                         StatusQueue& status)
+    : _units(units),
+      _count(count),
+      _commands(commands),
+      _samples(samples),
+      _status(status),
+      _commandPending(0),
+      _commandTrace{} {
+}
+
+uint16_t ControlLoop::step() {
+    Metrics::Timer timer(Metrics::Latency::CONTROL_LOOP);
+    uint16_t handled = 0;
+
+    ACCommand command;
+    while (_commands.pop(command)) {
+        // A tarefa de rede só enfileira unidades que existem
+        if (command.unit < _count) {
+            _units[command.unit].execute(command);
+            _commandPending |= uint8_t(1 << command.unit);
+            if (command.trace) _commandTrace[command.unit] = command.trace;
+        }
+        handled++;
+    }
+    // Comandos em sequência dentro de um quadro se fundem na fila do IR;
+    // cada aparelho transmite no seu canal, sem esperar pelos outros
+    for (uint8_t i = 0; i < _count; i++) {
+        _units[i].updateIR();
+    }
+
+    SensorSample sample;
+    while (_samples.pop(sample)) {
+        for (uint8_t i = 0; i < _count; i++) {
+            _units[i].applySample(sample);
+        }
+        handled++;
+    }
+
+    for (uint8_t i = 0; i < _count; i++) {
+        ACController& ac = _units[i];
+        ac.regulate();
+
+        // Com a fila de status cheia os campos continuam sujos para a próxima
+        // vez, e o fim do IR de um comando rastreado também
+        uint8_t fields = ac.dirtyFields();
+        bool afterCommand = _commandPending & (1 << i);
+        const CommandTiming* ir = ac.finishedTrace();
+        if (fields || afterCommand || ir) {
+            StatusUpdate update{ac.getStatus(), fields, afterCommand, i, _commandTrace[i],
+                                ir ? *ir : CommandTiming{}};
+            if (_status.push(update)) {
+                ac.markPublished(fields);
+                _commandPending &= uint8_t(~(1 << i));
+                _commandTrace[i] = 0;
+                if (ir) ac.markTraceReported();
+            }
+        }
+    }
+    return handled;
+}
@@ -0,0 +1,24 @@
+#include "SensorSampler.h"
+#include "InputRecorder.h"
+
+SensorSampler::SensorSampler(uint8_t dhtPin, SensorQueue& samples)
+    : _pipeline(dhtPin),
+      _samples(samples) {
+}
+
+void SensorSampler::begin() {
+    _pipeline.begin();
+}
+
+bool SensorSampler::step() {
+    if (!_pipeline.step()) {
+        return false;
+    }
+    inputRecorder.sensor(_pipeline.lastResult(), _pipeline.lastReading(), _pipeline.lastReadMs());
+    return _samples.push(_pipeline.sample());
+}
+
+bool SensorSampler::replay(Dht22Result result, const Dht22::Reading& reading, uint32_t readMs) {
+    _pipeline.replay(result, reading, readMs);
+    return _samples.push(_pipeline.sample());
+}
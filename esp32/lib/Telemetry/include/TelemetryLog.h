@@ -0,0 +1,48 @@
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "TelemetryCodec.h"
+
+// Log circular de registros de telemetria num arquivo do LittleFS.
+// Layout: cabeçalho de 16 bytes (magic, início, quantidade, relógio) seguido
+// de 'capacity' registros de TELEMETRY_RECORD_BYTES. Registros novos são
+// gravados antes do cabeçalho, então uma queda de energia no meio perde no
+// máximo o bloco em curso. Cheio, sobrescreve o mais antigo.
+class TelemetryLog {
+public:
+    static const uint32_t MAGIC = 0x314D4C54;   // "TLM1"
+    static const size_t HEADER_BYTES = 16;
+
+    TelemetryLog();
+
+    // Abre o log existente ou cria um vazio (LittleFS já montado)
+    bool begin(const char* path, uint32_t capacity);
+    bool ready() const { return bool(_file); }
+
+    bool append(const TelemetryRecord* records, size_t count);
+    // Lê a partir do 'offset'-ésimo registro mais antigo
+    size_t read(size_t offset, TelemetryRecord* out, size_t count);
+    bool consume(size_t count);
+
+    size_t size() const { return _count; }
+    uint32_t capacity() const { return _capacity; }
+    // Registros perdidos por falta de espaço desde o boot
+    uint32_t overwritten() const { return _overwritten; }
+    // Tempo do registro mais novo já gravado (sobrevive ao reboot)
+    uint32_t lastTime() const { return _lastTime; }
+
+private:
+    bool writeHeader();
+    bool writeSlots(uint32_t slot, const TelemetryRecord* records, size_t count);
+
+    File _file;
+    uint32_t _capacity;
+    uint32_t _head;
+    uint32_t _count;
+    uint32_t _lastTime;
+    uint32_t _overwritten;
+};
+
+#endif // TELEMETRY_LOG_H
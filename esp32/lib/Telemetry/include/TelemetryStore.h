@@ -0,0 +1,48 @@
+#ifndef TELEMETRY_STORE_H
+#define TELEMETRY_STORE_H
+
+#include <Arduino.h>
+#include "TelemetryCodec.h"
+#include "TelemetryLog.h"
+#include "config.h"
+
+// Fila de amostras de telemetria à espera de envio: as mais novas em RAM e,
+// quando a RAM enche, as mais antigas descem em blocos de
+// TELEMETRY_SPILL_BLOCK para o log em flash. A ordem é sempre log -> RAM,
+// então peek()/consume() entregam do mais antigo ao mais novo.
+// Sem log (ou com a flash falhando), a RAM sobrescreve a mais antiga.
+// Uso de uma tarefa só (a de rede); não é thread-safe.
+class TelemetryStore {
+public:
+    TelemetryStore();
+    void begin(TelemetryLog* log = nullptr);
+
+    // Segundos de operação acumulados entre boots: continua do último
+    // registro gravado no log, sem contar o tempo desligado
+    uint32_t now();
+
+    void append(const TelemetryRecord& record);
+    void record(const ACStatus& status) { append(telemetryRecordFromStatus(status, now())); }
+
+    // Copia até 'max' registros, do mais antigo, sem removê-los
+    size_t peek(TelemetryRecord* out, size_t max);
+    void consume(size_t count);
+
+    size_t size() const;
+    size_t ramSize() const { return _count; }
+    // Amostras perdidas (RAM ou log cheios) desde o boot
+    uint32_t dropped() const;
+
+private:
+    bool spill();
+
+    TelemetryRecord _ram[TELEMETRY_RAM_RECORDS];
+    size_t _head;
+    size_t _count;
+    TelemetryLog* _log;
+    uint32_t _seconds;
+    unsigned long _lastTick;
+    uint32_t _dropped;
+};
+
+#endif // TELEMETRY_STORE_H
@@ -0,0 +1,147 @@
+#include "TelemetryLog.h"
+
+namespace {
+
+// Registros por leitura/escrita de arquivo (buffer na pilha)
+const size_t IO_CHUNK = 16;
+
+void putU32(uint8_t* out, uint32_t value) {
+    out[0] = uint8_t(value);
+    out[1] = uint8_t(value >> 8);
+    out[2] = uint8_t(value >> 16);
+    out[3] = uint8_t(value >> 24);
+}
+
+uint32_t getU32(const uint8_t* in) {
+    return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+}
+
+} // namespace
+
+TelemetryLog::TelemetryLog()
+    : _capacity(0),
+      _head(0),
+      _count(0),
+      _lastTime(0),
+      _overwritten(0) {
+}
+
+bool TelemetryLog::begin(const char* path, uint32_t capacity) {
+    _capacity = capacity;
+    _head = _count = _lastTime = _overwritten = 0;
+    size_t expected = HEADER_BYTES + size_t(capacity) * TELEMETRY_RECORD_BYTES;
+
+    _file = LittleFS.open(path, "r+");
+    if (_file && _file.size() == expected) {
+        uint8_t header[HEADER_BYTES];
+        if (_file.read(header, sizeof(header)) == sizeof(header) && getU32(header) == MAGIC) {
+            uint32_t head = getU32(header + 4);
+            uint32_t count = getU32(header + 8);
+            if (head < capacity && count <= capacity) {
+                _head = head;
+                _count = count;
+                _lastTime = getU32(header + 12);
+                return true;
+            }
+        }
+    }
+
+    // Ausente, de outra capacidade ou corrompido: recria o arquivo inteiro
+    // de uma vez para não fragmentar a partição
+    _file.close();
+    _file = LittleFS.open(path, "w+");
+    if (!_file) {
+        Serial.println("Falha ao criar o log de telemetria");
+        return false;
+    }
+    uint8_t zeros[IO_CHUNK * TELEMETRY_RECORD_BYTES] = {0};
+    for (size_t written = 0; written < expected; ) {
+        size_t n = expected - written < sizeof(zeros) ? expected - written : sizeof(zeros);
+        if (_file.write(zeros, n) != n) {
+            _file.close();
+            return false;
+        }
+        written += n;
+    }
+    return writeHeader();
+}
+
+bool TelemetryLog::writeHeader() {
+    uint8_t header[HEADER_BYTES];
+    putU32(header, MAGIC);
+    putU32(header + 4, _head);
+    putU32(header + 8, _count);
+    putU32(header + 12, _lastTime);
+    return _file.seek(0) && _file.write(header, sizeof(header)) == sizeof(header);
+}
+
+bool TelemetryLog::writeSlots(uint32_t slot, const TelemetryRecord* records, size_t count) {
+    uint8_t buffer[IO_CHUNK * TELEMETRY_RECORD_BYTES];
+    while (count) {
+        // Um trecho contíguo: até o fim do arquivo ou do buffer
+        size_t n = count < IO_CHUNK ? count : IO_CHUNK;
+        if (n > _capacity - slot) n = _capacity - slot;
+        for (size_t i = 0; i < n; i++) {
+            packTelemetryRecord(records[i], buffer + i * TELEMETRY_RECORD_BYTES);
+        }
+        size_t bytes = n * TELEMETRY_RECORD_BYTES;
+        if (!_file.seek(HEADER_BYTES + slot * TELEMETRY_RECORD_BYTES)
+            || _file.write(buffer, bytes) != bytes) {
+            return false;
+        }
+        records += n;
+        count -= n;
+        slot = slot + n == _capacity ? 0 : uint32_t(slot + n);
+    }
+    return true;
+}
+
+bool TelemetryLog::append(const TelemetryRecord* records, size_t count) {
+    if (!_file || count == 0) return false;
+    if (count > _capacity) {
+        _overwritten += uint32_t(count - _capacity);
+        records += count - _capacity;
+        count = _capacity;
+    }
+    uint32_t tail = (_head + _count) % _capacity;
+    if (!writeSlots(tail, records, count)) return false;
+
+    uint32_t overflow = _count + count > _capacity ? uint32_t(_count + count - _capacity) : 0;
+    _head = (_head + overflow) % _capacity;
+    _count += uint32_t(count) - overflow;
+    _overwritten += overflow;
+    _lastTime = records[count - 1].time;
+    return writeHeader();
+}
+
+size_t TelemetryLog::read(size_t offset, TelemetryRecord* out, size_t count) {
+    if (!_file || offset >= _count) return 0;
+    if (count > _count - offset) count = _count - offset;
+
+    uint8_t buffer[IO_CHUNK * TELEMETRY_RECORD_BYTES];
+    uint32_t slot = uint32_t((_head + offset) % _capacity);
+    size_t done = 0;
+    while (done < count) {
+        size_t n = count - done < IO_CHUNK ? count - done : IO_CHUNK;
+        if (n > _capacity - slot) n = _capacity - slot;
+        size_t bytes = n * TELEMETRY_RECORD_BYTES;
+        if (!_file.seek(HEADER_BYTES + slot * TELEMETRY_RECORD_BYTES)
+            || _file.read(buffer, bytes) != bytes) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[done + i] = unpackTelemetryRecord(buffer + i * TELEMETRY_RECORD_BYTES);
+        }
+        done += n;
+        slot = slot + n == _capacity ? 0 : uint32_t(slot + n);
+    }
+    return done;
+}
+
+bool TelemetryLog::consume(size_t count) {
+    if (!_file) return false;
+    if (count > _count) count = _count;
+    _head = uint32_t((_head + count) % _capacity);
+    _count -= uint32_t(count);
+    return writeHeader();
+}
@@ -0,0 +1,85 @@
+#include "TelemetryStore.h"
+
+static_assert(TELEMETRY_SPILL_BLOCK > 0 && TELEMETRY_SPILL_BLOCK <= TELEMETRY_RAM_RECORDS,
+              "TELEMETRY_SPILL_BLOCK deve caber na RAM de telemetria");
+
+TelemetryStore::TelemetryStore()
+    : _head(0),
+      _count(0),
+      _log(nullptr),
+      _seconds(0),
+      _lastTick(0),
+      _dropped(0) {
+}
+
+void TelemetryStore::begin(TelemetryLog* log) {
+    _log = log && log->ready() ? log : nullptr;
+    _head = _count = 0;
+    _dropped = 0;
+    _seconds = _log && _log->size() ? _log->lastTime() + 1 : 0;
+    _lastTick = millis();
+}
+
+uint32_t TelemetryStore::now() {
+    // Acumula segundos inteiros: imune à volta do millis() a cada 49 dias
+    unsigned long elapsed = millis() - _lastTick;
+    _seconds += uint32_t(elapsed / 1000);
+    _lastTick += elapsed - elapsed % 1000;
+    return _seconds;
+}
+
+void TelemetryStore::append(const TelemetryRecord& record) {
+    if (_count == TELEMETRY_RAM_RECORDS && !spill()) {
+        // Sem flash: perde a mais antiga para guardar a mais nova
+        _head = (_head + 1) % TELEMETRY_RAM_RECORDS;
+        _count--;
+        _dropped++;
+    }
+    _ram[(_head + _count) % TELEMETRY_RAM_RECORDS] = record;
+    _count++;
+}
+
+bool TelemetryStore::spill() {
+    if (!_log) return false;
+
+    // O bloco pode dar a volta no buffer circular: no máximo duas gravações
+    size_t first = TELEMETRY_RAM_RECORDS - _head;
+    if (first > TELEMETRY_SPILL_BLOCK) first = TELEMETRY_SPILL_BLOCK;
+    if (!_log->append(_ram + _head, first)) return false;
+    _head = (_head + first) % TELEMETRY_RAM_RECORDS;
+    _count -= first;
+    if (first < TELEMETRY_SPILL_BLOCK && _log->append(_ram + _head, TELEMETRY_SPILL_BLOCK - first)) {
+        _head += TELEMETRY_SPILL_BLOCK - first;
+        _count -= TELEMETRY_SPILL_BLOCK - first;
+    }
+    return true;
+}
+
+size_t TelemetryStore::peek(TelemetryRecord* out, size_t max) {
+    size_t n = _log ? _log->read(0, out, max) : 0;
+    // Sem ler o log inteiro, a RAM não entra: manteria a ordem errada
+    if (_log && n < _log->size()) return n;
+    for (size_t i = 0; i < _count && n < max; i++) {
+        out[n++] = _ram[(_head + i) % TELEMETRY_RAM_RECORDS];
+    }
+    return n;
+}
+
+void TelemetryStore::consume(size_t count) {
+    if (_log && _log->size()) {
+        size_t fromLog = count < _log->size() ? count : _log->size();
+        _log->consume(fromLog);
+        count -= fromLog;
+    }
+    if (count > _count) count = _count;
+    _head = (_head + count) % TELEMETRY_RAM_RECORDS;
+    _count -= count;
+}
+
+size_t TelemetryStore::size() const {
+    return (_log ? _log->size() : 0) + _count;
+}
+
+uint32_t TelemetryStore::dropped() const {
+    return _dropped + (_log ? _log->overwritten() : 0);
+}
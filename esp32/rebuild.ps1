@@ -22,10 +22,7 @@ pio run -t clean
 Write-Host "Instalando bibliotecas..." -ForegroundColor Yellow
 pio lib install `
     "knolleary/PubSubClient" `
-    "bblanchon/ArduinoJson" `
-    "adafruit/DHT sensor library" `
-    "adafruit/Adafruit Unified Sensor" `
-    "z3t0/IRremote"
+    "bblanchon/ArduinoJson"
 
 # Compila
 Write-Host "Compilando..." -ForegroundColor Yellow
@@ -65,10 +65,7 @@ if ($LASTEXITCODE -ne 0) {
 Write-Step "Instalando bibliotecas..."
 $libraries = @(
     "knolleary/PubSubClient",
-    "bblanchon/ArduinoJson",
-    "adafruit/DHT sensor library",
-    "adafruit/Adafruit Unified Sensor",
-    "z3t0/IRremote"
+    "bblanchon/ArduinoJson"
 )
 
 foreach ($lib in $libraries) {
@@ -72,10 +72,7 @@ pio platform install espressif32
 Write-Step "Instalando bibliotecas..."
 $libs = @(
     "knolleary/PubSubClient",
-    "bblanchon/ArduinoJson",
-    "adafruit/DHT sensor library",
-    "adafruit/Adafruit Unified Sensor",
-    "z3t0/IRremote"
+    "bblanchon/ArduinoJson"
 )
 
 foreach ($lib in $libs) {
@@ -56,10 +56,7 @@ pio platform install espressif32
 Write-Host "Instalando bibliotecas..." -ForegroundColor Yellow
 pio lib install `
     "knolleary/PubSubClient" `
-    "bblanchon/ArduinoJson" `
-    "adafruit/DHT sensor library" `
-    "adafruit/Adafruit Unified Sensor" `
-    "z3t0/IRremote"
+    "bblanchon/ArduinoJson"
 
 # Atualiza ambiente
 Write-Host "Atualizando ambiente..." -ForegroundColor Yellow
@@ -0,0 +1,114 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "ACStateStore.h"
+#include "ACUnits.h"
+#include "ControlLoop.h"
+#include "IRLearner.h"
+#include "IRLibrary.h"
+#include "InputRecorder.h"
+#include "NetworkManager.h"
+#include "OtaUpdater.h"
+#include "Scheduler.h"
+#include "SensorSampler.h"
+#include "TaskQueues.h"
+#include "TelemetryStore.h"
+
+// RAM estática do firmware por subsistema: os objetos globais de main.cpp
+// e as pilhas das tarefas, tudo com tamanho de compilação. Cada subsistema
+// tem um orçamento conferido pelo compilador; um buffer que cresce além
+// dele não compila. O setup() imprime a tabela e test_heap_free também.
+//
+// No host os ponteiros têm 8 bytes, então os números de lá são um teto
+// para os do ESP32, e os orçamentos valem para os dois.
+namespace MemoryBudget {
+
+struct Subsystem {
+    const char* name;
+    size_t bytes;
+    size_t budget;
+};
+
+// O PubSubClient da placa aloca o buffer de MQTT_MAX_PACKET_SIZE no
+// construtor, antes do setup(); o do host já o tem dentro do objeto
+#ifdef NATIVE_HOST
+constexpr size_t MQTT_BUFFER = 0;
+#else
+constexpr size_t MQTT_BUFFER = MQTT_MAX_PACKET_SIZE;
+#endif
+
+constexpr size_t CONTROL = sizeof(ACUnits<AC_UNIT_COUNT>) + sizeof(ControlLoop)
+    + sizeof(CommandQueue) + sizeof(StatusQueue);
+constexpr size_t SENSORS = sizeof(SensorSampler) + sizeof(SensorQueue);
+constexpr size_t NETWORK = sizeof(MultiUnitNetworkManager<AC_UNIT_COUNT>) + MQTT_BUFFER;
+constexpr size_t TELEMETRY = sizeof(TelemetryLog) + sizeof(TelemetryStore);
+constexpr size_t SCHEDULE = sizeof(Scheduler);
+constexpr size_t OTA = sizeof(OtaUpdater);
+constexpr size_t IR_LEARNING = sizeof(IRLearner) + sizeof(IRLibrary);
+constexpr size_t STATE_STORE = sizeof(ACStateStore);
+// Com INPUT_RECORDER_ENABLED 0 o gravador é uma classe vazia
+constexpr size_t RECORDER = sizeof(InputRecorder);
+constexpr size_t STACKS = TASK_STACK_NETWORK + TASK_STACK_CONTROL + TASK_STACK_SENSORS;
+
+// Orçamentos em bytes; o do controle cresce com os aparelhos
+constexpr size_t CONTROL_BUDGET = AC_UNIT_COUNT * 2304 + 1536;
+constexpr size_t SENSORS_BUDGET = 768;
+constexpr size_t NETWORK_BUDGET = 14336;
+constexpr size_t TELEMETRY_BUDGET = 1024;
+constexpr size_t SCHEDULE_BUDGET = 384;
+constexpr size_t OTA_BUDGET = 512;
+constexpr size_t IR_LEARNING_BUDGET = 1536;
+constexpr size_t STATE_STORE_BUDGET = 128;
+constexpr size_t RECORDER_BUDGET = 3072;
+constexpr size_t STACKS_BUDGET = 16384;
+
+static_assert(CONTROL <= CONTROL_BUDGET, "controle acima do orçamento de RAM");
+static_assert(SENSORS <= SENSORS_BUDGET, "sensores acima do orçamento de RAM");
+static_assert(NETWORK <= NETWORK_BUDGET, "rede acima do orçamento de RAM");
+static_assert(TELEMETRY <= TELEMETRY_BUDGET, "telemetria acima do orçamento de RAM");
+static_assert(SCHEDULE <= SCHEDULE_BUDGET, "agenda acima do orçamento de RAM");
+static_assert(OTA <= OTA_BUDGET, "OTA acima do orçamento de RAM");
+static_assert(IR_LEARNING <= IR_LEARNING_BUDGET, "aprendizado IR acima do orçamento de RAM");
+static_assert(STATE_STORE <= STATE_STORE_BUDGET, "estado gravado acima do orçamento de RAM");
+static_assert(RECORDER <= RECORDER_BUDGET, "gravador de entradas acima do orçamento de RAM");
+static_assert(STACKS <= STACKS_BUDGET, "pilhas das tarefas acima do orçamento de RAM");
+
+constexpr Subsystem SUBSYSTEMS[] = {
+    {"controle", CONTROL, CONTROL_BUDGET},
+    {"sensores", SENSORS, SENSORS_BUDGET},
+    {"rede", NETWORK, NETWORK_BUDGET},
+    {"telemetria", TELEMETRY, TELEMETRY_BUDGET},
+    {"agenda", SCHEDULE, SCHEDULE_BUDGET},
+    {"ota", OTA, OTA_BUDGET},
+    {"ir aprendido", IR_LEARNING, IR_LEARNING_BUDGET},
+    {"estado", STATE_STORE, STATE_STORE_BUDGET},
+    {"gravacao", RECORDER, RECORDER_BUDGET},
+    {"pilhas", STACKS, STACKS_BUDGET},
+};
+constexpr size_t SUBSYSTEM_COUNT = sizeof(SUBSYSTEMS) / sizeof(SUBSYSTEMS[0]);
+
+constexpr size_t total() {
+    size_t sum = 0;
+    for (const Subsystem& subsystem : SUBSYSTEMS) sum += subsystem.bytes;
+    return sum;
+}
+
+constexpr size_t totalBudget() {
+    size_t sum = 0;
+    for (const Subsystem& subsystem : SUBSYSTEMS) sum += subsystem.budget;
+    return sum;
+}
+
+inline void print() {
+    Serial.println("RAM estática (bytes / orçamento):");
+    for (const Subsystem& subsystem : SUBSYSTEMS) {
+        Serial.printf("  %-13s %6u / %6u\n", subsystem.name, unsigned(subsystem.bytes), unsigned(subsystem.budget));
+    }
+    Serial.printf("  %-13s %6u / %6u\n", "total", unsigned(total()), unsigned(totalBudget()));
+}
+
+} // namespace MemoryBudget
+
+#endif // MEMORY_BUDGET_H
@@ -20,11 +20,145 @@
 #define PIN_IR_LED 4              // LED IR + transistor
 #define PIN_DHT 15                // Sensor DHT22
 #define PIN_STATUS 2              // LED de status (built-in)
+#define PIN_IR_RECEIVER 27        // Receptor IR 38 kHz (TSOP), para APRENDER_IR
+
+// Aparelhos controlados por este ESP32 (1 a 3, ver ACUnits.h), com um LED
+// IR cada, na ordem das unidades; o DHT22 da sala é um só. Com mais de um,
+// a unidade n recebe em .../comando/n e publica em .../status/n (MQTT.md).
+#define AC_UNIT_COUNT 1
+#define AC_UNIT_IR_PINS {PIN_IR_LED, 16, 17}
 
 // Intervalos (ms)
 #define STATUS_UPDATE_INTERVAL 5000    // 5 segundos entre atualizações
-#define MQTT_RECONNECT_DELAY 5000      // 5 segundos entre tentativas
-#define MAX_RECONNECT_ATTEMPTS 5       // Máximo de tentativas
+
+// Conexão (máquina de estados não bloqueante em NetworkManager)
+#define WIFI_CONNECT_TIMEOUT 10000     // Desiste de uma associação WiFi após 10 s
+#define MQTT_CONNECT_TIMEOUT 2000      // Limite de um connect TCP/MQTT ao broker
+#define RECONNECT_BACKOFF_MIN 1000     // Primeira espera entre tentativas
+#define RECONNECT_BACKOFF_MAX 60000    // Espera máxima (sem limite de tentativas)
+
+// Tarefas FreeRTOS (pilha em bytes): rede no núcleo 0, controle/IR e
+// sensores no núcleo 1
+#define TASK_STACK_NETWORK 8192
+#define TASK_STACK_CONTROL 4096
+#define TASK_STACK_SENSORS 3072
+#define TASK_PERIOD_NETWORK 10         // ms entre passos da tarefa de rede
+
+// Publicação de status por alteração
+// O status completo (retido) sai quando algum campo muda, no máximo a cada
+// STATUS_UPDATE_INTERVAL, e obrigatoriamente a cada STATUS_HEARTBEAT_INTERVAL.
+#define STATUS_HEARTBEAT_INTERVAL 120000  // 2 minutos (servidor considera offline após 5)
+#define STATUS_TEMP_DEADBAND 0.2f         // °C de variação para republicar
+#define STATUS_HUMIDITY_DEADBAND 1.0f     // %UR de variação para republicar
+#define STATUS_DELTA_ENABLED false        // true: alterações vão só com os campos mudados em .../status/delta
+#define STATUS_CBOR_ENABLED false         // true: status em CBOR desde o boot; o comando FORMATO troca
+
+// Sensores (DHT22 lido pelo RMT, sem bloquear): mediana de 5 leituras
+// seguida de média exponencial; degraus maiores que a banda passam direto
+#define SENSOR_EMA_ALPHA 0.3f             // peso da leitura nova
+#define SENSOR_TEMP_SNAP 0.5f             // °C
+#define SENSOR_HUMIDITY_SNAP 2.0f         // %UR
+#define SENSOR_FAIL_AFTER 3               // leituras inválidas seguidas = FALHA
+#define SENSOR_WINDOW_INTERVAL STATUS_HEARTBEAT_INTERVAL  // janela de mín/máx/média
+
+// Telemetria: uma amostra (temperatura, umidade, ligado, setpoint) por
+// intervalo, gravada mesmo sem broker. A RAM transborda para um log circular
+// no LittleFS; após reconectar, o acúmulo sobe em lotes delta em
+// .../telemetria, um lote a cada TELEMETRY_UPLOAD_INTERVAL.
+#define TELEMETRY_SAMPLE_INTERVAL 60000   // 1 minuto
+#define TELEMETRY_RAM_RECORDS 64          // amostras em RAM (9 bytes cada no log)
+#define TELEMETRY_SPILL_BLOCK 32          // amostras por gravação na flash
+#define TELEMETRY_LOG_RECORDS 4096        // ~68 h a 1/min, 36 KB de flash
+#define TELEMETRY_LOG_PATH "/telemetria.bin"
+#define TELEMETRY_BATCH_RECORDS 48        // amostras por mensagem
+#define TELEMETRY_UPLOAD_INTERVAL 250     // ms entre lotes (não inunda o broker)
+
+// Diagnóstico (lib/Metrics): histogramas de latência e contadores sem trava,
+// publicados em .../diagnostico. false remove o registro dos caminhos quentes.
+#define METRICS_ENABLED true
+#define DIAGNOSTICS_INTERVAL 60000        // 1 minuto entre snapshots
+
+// Modo sem heap (lib/Memory): com HEAP_GUARD_ENABLED, malloc/new de uma
+// tarefa do firmware depois do setup() para o ESP32 com abort() e o
+// backtrace de quem alocou. Ligado pelo env esp32dev_heap_guard.
+#ifndef HEAP_GUARD_ENABLED
+#define HEAP_GUARD_ENABLED 0
+#endif
+
+// Gravador de entradas (lib/Recorder): comandos, leituras do DHT22, estado
+// do WiFi/broker e hora do NTP num arquivo do LittleFS, para reproduzir no
+// host com o env replay. Ligado pelo env esp32dev_recorder; o comando
+// GRAVACAO envia a gravação em .../gravacao.
+#ifndef INPUT_RECORDER_ENABLED
+#define INPUT_RECORDER_ENABLED 0
+#endif
+#define RECORDER_PATH "/gravacao.bin"
+#define RECORDER_PREVIOUS_PATH "/gravacao-anterior.bin"  // a do boot anterior
+#define RECORDER_FILE_BYTES 393216        // 384 KB por boot (dias de operação)
+#define RECORDER_FLUSH_INTERVAL 30000     // ms no máximo com eventos só na RAM
+#define RECORDER_CHUNK_BYTES 512          // bytes por mensagem do envio
+
+// Termostato local: com o aparelho ligado em REFRIGERAR, alterna o quadro IR
+// entre REFRIGERAR e VENTILAR pela temperatura do DHT22, sem depender do
+// servidor. Valores iniciais; o servidor ajusta pelo comando TERMOSTATO.
+#define THERMOSTAT_ENABLED false
+#define THERMOSTAT_HYSTERESIS 10          // largura da banda em décimos de °C
+#define THERMOSTAT_MIN_ON 180             // s mínimos com o compressor ligado
+#define THERMOSTAT_MIN_OFF 180            // s mínimos com o compressor parado
+#define THERMOSTAT_TEMP_MIN 16            // faixa do setpoint (Configuracao)
+#define THERMOSTAT_TEMP_MAX 30
+
+// Agenda semanal local (comando AGENDA): gravada na NVS e disparada pela
+// hora do NTP, mesmo sem broker. O fuso vem na própria agenda.
+#define NTP_SERVER "pool.ntp.org"
+#define SCHEDULE_NVS_NAMESPACE "agenda"
+#define SCHEDULE_POLL_INTERVAL 1000       // ms entre consultas ao relógio
+
+// Último estado de cada aparelho (ligado, temperatura, modo e velocidade)
+// na NVS, restaurado no boot sem transmitir IR. Mudanças seguidas viram uma
+// gravação só: STATE_SAVE_QUIET depois da última, ou no máximo
+// STATE_SAVE_MAX_DELAY depois da primeira.
+#define STATE_NVS_NAMESPACE "estado"
+#define STATE_SAVE_QUIET 5000             // ms sem mudanças antes de gravar
+#define STATE_SAVE_MAX_DELAY 60000        // ms no máximo com mudança pendente
+
+// Atualização de firmware pelo MQTT (comando OTA): os blocos vão direto
+// para a partição OTA inativa e a imagem só vale depois de conferir o
+// SHA-256. A imagem nova precisa conectar ao broker em OTA_CONFIRM_TIMEOUT
+// e em até OTA_BOOT_ATTEMPTS boots; senão volta a anterior.
+#define FIRMWARE_VERSION "1.0.0"
+#define OTA_NVS_NAMESPACE "ota"
+#define OTA_WINDOW_CHUNKS 4               // blocos de 512 bytes em trânsito
+#define OTA_PROGRESS_INTERVAL 32768       // bytes entre gravações do progresso na NVS
+#define OTA_BOOT_ATTEMPTS 3
+#define OTA_CONFIRM_TIMEOUT 300000        // 5 minutos
+#define OTA_RESTART_DELAY 2000            // ms para o relatório sair antes do reinício
+
+// Protocolo IR do aparelho: "NEC" (um código por tecla, abaixo) ou um dos
+// protocolos de estado completo num quadro: "COOLIX" (Midea 24 bits,
+// Springer...), "GREE", "MIDEA" (48 bits) ou "LG". Nome desconhecido = NEC.
+// "APRENDIDO" transmite os quadros gravados do controle original com o
+// comando APRENDER_IR (IRLibrary, partição "irlib" de partitions.csv).
+// Só o codificador deste protocolo entra no binário; o build nativo define
+// AC_IR_ALL_PROTOCOLS para os testes trocarem de protocolo em execução.
+#ifndef AC_IR_PROTOCOL
+#define AC_IR_PROTOCOL "NEC"
+#endif
+#ifndef AC_IR_ALL_PROTOCOLS
+#define AC_IR_ALL_PROTOCOLS 0
+#endif
+#define IR_LEARN_TIMEOUT 20000            // ms esperando a tecla do controle
+#define IR_LEARNED_KHZ 38                 // portadora dos quadros aprendidos
+
+// Esquema MQTT dos comandos e do status (MqttSchema.h): o de MQTT.md ou o
+// do firmware climaControl antigo (climaControl/{id}/command com
+// {"acao","valor"}), para regravar esses dispositivos sem mudar o servidor.
+// Com o legado, use AC_IR_PROTOCOL "COOLIX" e AC_UNIT_COUNT 1, como eles.
+#define MQTT_SCHEMA_NATIVE 0
+#define MQTT_SCHEMA_LEGACY 1
+#ifndef MQTT_SCHEMA
+#define MQTT_SCHEMA MQTT_SCHEMA_NATIVE
+#endif
 
 // Códigos IR - Substitua pelos códigos do seu ar condicionado
 // Use um receptor IR para capturar os códigos corretos
@@ -49,8 +183,21 @@ namespace IRCodes {
 }
 
 // Tópicos MQTT
+#if MQTT_SCHEMA == MQTT_SCHEMA_LEGACY
+#define MQTT_STATUS_TOPIC "climaControl/" DEVICE_ID "/status"
+#define MQTT_COMMAND_TOPIC "climaControl/" DEVICE_ID "/command"
+#else
 #define MQTT_STATUS_TOPIC "ac-control/dispositivos/" DEVICE_ID "/status"
 #define MQTT_COMMAND_TOPIC "ac-control/dispositivos/" DEVICE_ID "/comando"
+#endif
+#define MQTT_STATUS_DELTA_TOPIC "ac-control/dispositivos/" DEVICE_ID "/status/delta"
+#define MQTT_TELEMETRY_TOPIC "ac-control/dispositivos/" DEVICE_ID "/telemetria"
+#define MQTT_DIAGNOSTICS_TOPIC "ac-control/dispositivos/" DEVICE_ID "/diagnostico"
+#define MQTT_ERROR_TOPIC "ac-control/dispositivos/" DEVICE_ID "/erro"
+#define MQTT_OTA_CHUNK_TOPIC "ac-control/dispositivos/" DEVICE_ID "/ota/bloco"
+#define MQTT_OTA_STATE_TOPIC "ac-control/dispositivos/" DEVICE_ID "/ota/estado"
+#define MQTT_IR_LEARN_TOPIC "ac-control/dispositivos/" DEVICE_ID "/ir/aprendizado"
+#define MQTT_RECORDING_TOPIC "ac-control/dispositivos/" DEVICE_ID "/gravacao"
 
 // Debug
 #define DEBUG_ENABLED true         // Habilita logs serial
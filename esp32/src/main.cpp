@@ -1,11 +1,105 @@
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <LittleFS.h>
 #include "config.h"
 #include "ACController.h"
+#include "ACStateStore.h"
+#include "ACUnits.h"
+#include "ControlLoop.h"
+#include "HeapGuard.h"
+#include "IRLearner.h"
+#include "IRLibrary.h"
+#include "InputRecorder.h"
+#include "MemoryBudget.h"
 #include "NetworkManager.h"
+#include "OtaUpdater.h"
+#include "Scheduler.h"
+#include "SensorSampler.h"
+#include "TaskQueues.h"
+#include "TelemetryStore.h"
 
-// Instanciar objetos
-ACController ac(PIN_IR_LED, PIN_DHT);
-NetworkManager network(DEVICE_ID, ac);
+// Filas entre as tarefas (um produtor e um consumidor cada)
+CommandQueue commandQueue;
+SensorQueue sensorQueue;
+StatusQueue statusQueue;
+
+// Instanciar objetos: um ACController por aparelho, memória fixa
+static const uint8_t UNIT_IR_PINS[] = AC_UNIT_IR_PINS;
+static_assert(sizeof(UNIT_IR_PINS) >= AC_UNIT_COUNT, "um pino IR por aparelho");
+ACUnits<AC_UNIT_COUNT> units(UNIT_IR_PINS, PIN_DHT);
+// Tópicos em buffers fixos (MqttTopics), montados a partir de DEVICE_ID
+static_assert(MqttTopics::fits(DEVICE_ID), "DEVICE_ID maior que MqttTopics::DEVICE_ID_MAX_LENGTH");
+MultiUnitNetworkManager<AC_UNIT_COUNT> network(DEVICE_ID, units);
+ControlLoop control(units, commandQueue, sensorQueue, statusQueue);
+SensorSampler sensors(PIN_DHT, sensorQueue);
+
+// Telemetria: RAM + log circular no LittleFS (só a tarefa de rede usa)
+TelemetryLog telemetryLog;
+TelemetryStore telemetry;
+
+// Agenda semanal (NVS + NTP); também só a tarefa de rede usa
+Scheduler schedule;
+
+// Firmware pelo MQTT (partições OTA + NVS); também só a tarefa de rede usa
+OtaUpdater ota;
+
+// Teclas do controle original gravadas com APRENDER_IR (partição "irlib"):
+// a tarefa de rede grava, a de controle transmite com o protocolo APRENDIDO.
+// O receptor fica com o canal 5 do RMT e os blocos livres depois dele (o
+// canal 6 é do terceiro aparelho).
+IRLearner irLearner(PIN_IR_RECEIVER, irLibrary, RMT_CHANNEL_5, AC_UNIT_COUNT < 3 ? 3 : 1);
+
+// Estado dos aparelhos na NVS, para voltar dele depois de uma queda de
+// energia; também só a tarefa de rede usa depois do setup()
+ACStateStore stateStore;
+
+// Com o rollback do bootloader habilitado, o core marcaria a imagem como
+// válida já no boot; quem confirma é o OtaUpdater, depois de conectar
+extern "C" bool verifyRollbackLater() {
+  return true;
+}
+
+// Rede no núcleo 0, junto da pilha WiFi; IR e sensores no núcleo 1.
+// O controle tem a maior prioridade para que o IR não espere pelo DHT.
+static void networkTask(void*) {
+  unsigned long lastBlink = 0;
+  for (;;) {
+    // Atualizar conexões de rede
+    network.update();
+
+    // Imagem nova instalada ou revertida: o relatório já saiu
+    if (ota.restartDue()) {
+      stateStore.flush();
+      ESP.restart();
+    }
+
+    // LED de status - pisca rápido quando desconectado, lento quando conectado
+    unsigned long blinkPeriod = network.isConnected() ? 1000 : 100;
+    if (millis() - lastBlink >= blinkPeriod) {
+      digitalWrite(PIN_STATUS, !digitalRead(PIN_STATUS));
+      lastBlink = millis();
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(TASK_PERIOD_NETWORK));
+  }
+}
+
+static void controlTask(void*) {
+  for (;;) {
+    // Comandos e leituras das filas; só esta tarefa toca o ACController
+    control.step();
+    vTaskDelay(pdMS_TO_TICKS(5));
+  }
+}
+
+static void sensorTask(void*) {
+  for (;;) {
+    sensors.step();
+    // Durante uma leitura do DHT22 (~6 ms) o passo é de 1 ms
+    vTaskDelay(pdMS_TO_TICKS(sensors.busy() ? 1 : 100));
+  }
+}
 
 void setup() {
   // Iniciar comunicação serial
@@ -18,42 +112,88 @@ void setup() {
   pinMode(PIN_STATUS, OUTPUT);
   digitalWrite(PIN_STATUS, LOW);
 
-  // Inicializar controle do ar condicionado
-  ac.begin();
+  // Códigos aprendidos antes do primeiro quadro do protocolo APRENDIDO
+  if (!irLibrary.begin() && DEBUG_ENABLED) {
+    Serial.println("Partição irlib ausente; aprendizado IR indisponível");
+  }
+
+  // Inicializar controle dos aparelhos
+  units.begin();
+  sensors.begin();
+
+  // Estado de antes do reinício, sem IR: o aparelho já está nele
+  stateStore.begin();
+  for (uint8_t i = 0; i < units.size(); i++) {
+    ACSettings saved;
+    if (stateStore.stored(i, saved)) {
+      units[i].restore(saved);
+    }
+  }
+
+  // Sem flash a telemetria segue só em RAM
+  bool fsReady = LittleFS.begin(true);
+  bool logReady = fsReady && telemetryLog.begin(TELEMETRY_LOG_PATH, TELEMETRY_LOG_RECORDS);
+  if (!logReady && DEBUG_ENABLED) {
+    Serial.println("Log de telemetria indisponível; usando só RAM");
+  }
+  telemetry.begin(logReady ? &telemetryLog : nullptr);
+  schedule.begin();
+  ota.begin();
+  irLearner.begin();
+
+  // Com INPUT_RECORDER_ENABLED, o ponto de partida da reprodução: firmware,
+  // estado restaurado e agenda; daqui em diante só entra o que vem de fora
+  if (INPUT_RECORDER_ENABLED && fsReady) {
+    ACSettings settings[AC_UNIT_COUNT];
+    uint8_t restored = 0;
+    for (uint8_t i = 0; i < units.size(); i++) {
+      ACStatus status = units[i].getStatus();
+      settings[i] = ACSettings{status.isOn, status.targetTemp, status.mode, status.fanSpeed};
+      ACSettings saved;
+      if (stateStore.stored(i, saved)) restored |= uint8_t(1 << i);
+    }
+    RecordingBoot boot{FIRMWARE_VERSION, DEVICE_ID, AC_IR_PROTOCOL, MQTT_SCHEMA, TASK_PERIOD_NETWORK,
+                       uint8_t(units.size()), restored, settings, &schedule.table()};
+    if (!inputRecorder.begin(RECORDER_PATH, RECORDER_PREVIOUS_PATH, RECORDER_FILE_BYTES, boot) && DEBUG_ENABLED) {
+      Serial.println("Gravação de entradas indisponível");
+    }
+  }
 
   // Conectar à rede e MQTT
+  network.attachQueues(commandQueue, statusQueue);
+  network.attachTelemetry(telemetry);
+  network.attachScheduler(schedule);
+  network.attachOta(ota);
+  network.attachIRLearner(irLearner);
+  network.attachStateStore(stateStore);
   network.begin(
-    WIFI_SSID, 
+    WIFI_SSID,
     WIFI_PASSWORD,
-    MQTT_SERVER, 
+    MQTT_SERVER,
     MQTT_PORT,
-    MQTT_USER, 
+    MQTT_USER,
     MQTT_PASSWORD
   );
-}
 
-void loop() {
-  // Atualizar conexões de rede
-  network.update();
+  // Hora em UTC; a agenda aplica o próprio fuso. O SNTP segue tentando em
+  // segundo plano e o relógio continua certo se a rede cair depois.
+  configTime(0, 0, NTP_SERVER);
 
-  // Atualizar leituras do ar condicionado
-  ac.update();
+  TaskHandle_t tasks[3];
+  xTaskCreatePinnedToCore(networkTask, "network", TASK_STACK_NETWORK, nullptr, 2, &tasks[0], PRO_CPU_NUM);
+  xTaskCreatePinnedToCore(controlTask, "control", TASK_STACK_CONTROL, nullptr, 3, &tasks[1], APP_CPU_NUM);
+  xTaskCreatePinnedToCore(sensorTask, "sensors", TASK_STACK_SENSORS, nullptr, 1, &tasks[2], APP_CPU_NUM);
 
-  // LED de status - pisca rápido quando desconectado
-  static unsigned long lastBlink = 0;
-  if (!network.isConnected()) {
-    if (millis() - lastBlink >= 100) {
-      digitalWrite(PIN_STATUS, !digitalRead(PIN_STATUS));
-      lastBlink = millis();
-    }
-  } else {
-    // LED de status - pisca lento quando conectado
-    if (millis() - lastBlink >= 1000) {
-      digitalWrite(PIN_STATUS, !digitalRead(PIN_STATUS));
-      lastBlink = millis();
-    }
+  // Daqui em diante nenhuma tarefa do firmware usa o heap; com
+  // HEAP_GUARD_ENABLED uma alocação delas para a placa
+  MemoryBudget::print();
+  for (TaskHandle_t task : tasks) {
+    HeapGuard::enroll(task);
   }
+  HeapGuard::arm();
+}
 
-  // Pequeno delay para evitar sobrecarga
-  delay(10);
+void loop() {
+  // Todo o trabalho acontece nas tarefas acima
+  vTaskDelete(NULL);
 }
\ No newline at end of file
@@ -0,0 +1,1043 @@
+#include <unity.h>
+#include <chrono>
+#include <Arduino.h>
+#include <FakeBroker.h>
+#include <HostBench.h>
+#include <HostIRLog.h>
+#include <HostDht22.h>
+#include <HostRoom.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include "config.h"
+#include "ACController.h"
+#include "ACStateStore.h"
+#include "CborWriter.h"
+#include "CommandCodec.h"
+#include "CommandTracer.h"
+#include "FleetGateway.h"
+#include "GatewayLoad.h"
+#include "IRCode.h"
+#include "IREncoder.h"
+#include "IRLibrary.h"
+#include "IRSender.h"
+#include "Metrics.h"
+#include "NetworkManager.h"
+#include "OtaServer.h"
+#include "OtaUpdater.h"
+#include "ScheduleCodec.h"
+#include "Scheduler.h"
+#include "SensorPipeline.h"
+#include "StatusCodec.h"
+#include "TelemetryCodec.h"
+#include "TaskQueues.h"
+#include "Thermostat.h"
+
+// Micro-benchmarks dos caminhos quentes do firmware.
+// Cada linha "[bench]" reporta ns/op (CPU do host), alocações e bytes por
+// chamada, e o tempo em que a chamada mantém o loop() do ESP32 bloqueado.
+
+static const uint32_t ITERATIONS = 20000;
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+void bench_serialize_status() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.turnOn();
+    ac.setMode(ACMode::COOL);
+    ac.update();
+
+    char buffer[STATUS_JSON_CAPACITY];
+    BenchResult r = HostBench::run("ACController::serializeStatus", ITERATIONS, [&] {
+        size_t length = ac.serializeStatus(buffer, sizeof(buffer));
+        HostBench::doNotOptimize(length);
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+}
+
+void bench_send_nec() {
+    IRSender sender(PIN_IR_LED);
+    sender.begin();
+
+    // Só enfileira: o quadro vai ao ar pelo RMT enquanto o loop segue
+    uint32_t i = 0;
+    BenchResult r = HostBench::run("IRSender::sendNECCommand", ITERATIONS, [&] {
+        sender.sendNECCommand(IRCodes::TEMP_BASE >> 16, (IRCodes::TEMP_BASE & 0xFFFF) + (i++ % 15), IRSlot::TEMPERATURE);
+    });
+    TEST_ASSERT_EQUAL(0, r.blockedUsPerOp);
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+}
+
+void bench_encode_state() {
+    uint16_t pulses[IR_MAX_PULSES];
+    for (size_t p = 0; p < IR_PROTOCOL_COUNT; p++) {
+        const IREncoder* encoder = irEncoderFor(IRProtocol(p));
+        // O APRENDIDO lê a flash: medido em bench_ir_library
+        if (!encoder || IRProtocol(p) == IRProtocol::LEARNED) continue;
+        char name[48];
+        snprintf(name, sizeof(name), "IREncoder::encode (%s)", irProtocolName(IRProtocol(p)));
+
+        uint32_t i = 0;
+        BenchResult r = HostBench::run(name, ITERATIONS, [&] {
+            ACSettings settings{true, uint8_t(16 + i % 15), ACMode(i % AC_MODE_COUNT), FanSpeed(i % FAN_SPEED_COUNT)};
+            i++;
+            HostBench::doNotOptimize(encoder->encode(settings, pulses, IR_MAX_PULSES));
+        });
+        TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+    }
+}
+
+void bench_mqtt_callback() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+
+    static const char* const commands[] = {
+        "{\"comando\":\"LIGAR\"}",
+        "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22}}",
+        "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"REFRIGERAR\"}}",
+        "{\"comando\":\"VELOCIDADE\",\"parametros\":{\"velocidade\":\"ALTA\"}}",
+        "{\"comando\":\"DESLIGAR\"}",
+    };
+    const size_t count = sizeof(commands) / sizeof(commands[0]);
+
+    // Entregue pelo FakeBroker dentro de update() -> PubSubClient::loop()
+    uint32_t i = 0;
+    BenchResult r = HostBench::run("NetworkManager::mqttCallback (via loop)", ITERATIONS, [&] {
+        FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, commands[i++ % count]);
+        network.update();
+    });
+    TEST_ASSERT_GREATER_THAN(0, r.nsPerOp);
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().retained(MQTT_STATUS_TOPIC));
+}
+
+// Um comando por iteração no laço único, do callback ao fim do IR, com e
+// sem "id"; a diferença é o custo do rastreio e da confirmação. O
+// "bloqueado" é o tempo virtual dado ao quadro IR, não tempo de CPU.
+static BenchResult benchCommandRound(const char* name, bool traced) {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+
+    static const char* const commands[2][2] = {
+        {"{\"comando\":\"LIGAR\"}", "{\"comando\":\"DESLIGAR\"}"},
+        {"{\"comando\":\"LIGAR\",\"id\":\"6f1c2a9e-3b7d-4c2e-9a51-0d8e7f3b2c41\"}",
+         "{\"comando\":\"DESLIGAR\",\"id\":\"6f1c2a9e-3b7d-4c2e-9a51-0d8e7f3b2c42\"}"},
+    };
+    uint32_t i = 0;
+    BenchResult r = HostBench::run(name, ITERATIONS, [&] {
+        FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, commands[traced][i++ % 2]);
+        network.update();
+        HostClock::advanceMillis(200);
+        ac.update();
+        network.update();
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+    TEST_ASSERT_EQUAL(traced, FakeBroker::instance().lastMessage("ac-control/dispositivos/" DEVICE_ID "/confirmacao")
+                                  != nullptr);
+    return r;
+}
+
+void bench_command_trace() {
+    CommandTracer tracer;
+    char buffer[256];
+    const JsonSlice id{"6f1c2a9e-3b7d-4c2e-9a51-0d8e7f3b2c41", 36};
+    uint32_t now = 0;
+    BenchResult t = HostBench::run("CommandTracer (abre, marca, confirma)", ITERATIONS, [&] {
+        uint8_t trace = tracer.open(id, 0, now, now + 40);
+        tracer.published(trace, now + 900);
+        CommandTiming ir;
+        ir.trace = trace;
+        ir.transmitted = true;
+        ir.irStartUs = now + 120;
+        ir.irDoneUs = now + 68000;
+        tracer.transmitted(ir);
+        HostBench::doNotOptimize(tracer.nextAck(now + 70000, buffer, sizeof(buffer)));
+        now += 100000;
+    });
+    TEST_ASSERT_EQUAL(0, t.allocsPerOp);
+    TEST_ASSERT_EQUAL(0, tracer.pending());
+    // Microssegundos no ESP32 (~10x o host) cabem folgados
+    TEST_ASSERT_LESS_THAN(5000.0, t.nsPerOp);
+
+    BenchResult plain = benchCommandRound("Comando no laço único (sem id)", false);
+    BenchResult traced = benchCommandRound("Comando no laço único (com id)", true);
+    char line[160];
+    snprintf(line, sizeof(line), "        rastreio por comando: %.0f ns (callback até a confirmação publicada)",
+             traced.nsPerOp - plain.nsPerOp);
+    TEST_MESSAGE(line);
+}
+
+void bench_parse_command() {
+    static const char* const commands[] = {
+        "{\"comando\":\"LIGAR\"}",
+        "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22}}",
+        "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"REFRIGERAR\"}}",
+        "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":22,"
+        "\"modo\":\"REFRIGERAR\",\"velocidade\":\"ALTA\"}}",
+    };
+    const size_t count = sizeof(commands) / sizeof(commands[0]);
+    size_t lengths[count];
+    for (size_t c = 0; c < count; c++) lengths[c] = strlen(commands[c]);
+
+    uint32_t i = 0;
+    ACCommand command;
+    BenchResult r = HostBench::run("parseCommandJson", ITERATIONS, [&] {
+        size_t c = i++ % count;
+        CommandParseResult result = parseCommandJson(reinterpret_cast<const uint8_t*>(commands[c]), lengths[c], command);
+        HostBench::doNotOptimize(result);
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+}
+
+// Os mesmos comandos de bench_parse_command em CBOR, como o servidor envia
+static size_t cborCommand(size_t index, uint8_t* out, size_t capacity) {
+    CborWriter cbor(out, capacity);
+    cbor.beginObject();
+    cbor.key(WireKey::COMANDO);
+    cbor.value(index == 0 ? "LIGAR" : index == 1 ? "TEMPERATURA" : index == 2 ? "MODO_OPERACAO" : "SET_STATE");
+    if (index) {
+        cbor.key(WireKey::PARAMETROS);
+        cbor.beginObject();
+        if (index == 3) {
+            cbor.key(WireKey::LIGADO);
+            cbor.value(true);
+        }
+        if (index != 2) {
+            cbor.key(WireKey::TEMPERATURA);
+            cbor.value(uint32_t(22));
+        }
+        if (index >= 2) {
+            cbor.key(WireKey::MODO);
+            cbor.value("REFRIGERAR");
+        }
+        if (index == 3) {
+            cbor.key(WireKey::VELOCIDADE);
+            cbor.value("ALTA");
+        }
+        cbor.endObject();
+    }
+    cbor.endObject();
+    return cbor.finish();
+}
+
+// JSON contra CBOR: bytes no fio e ns/op para codificar o status (completo
+// e delta) e interpretar os comandos
+void bench_wire_format() {
+    ACStatus status{};
+    status.isOn = true;
+    status.currentTemp = 23.6f;
+    status.currentHumidity = 55.5f;
+    status.targetTemp = 22;
+    status.mode = ACMode::COOL;
+    status.fanSpeed = FanSpeed::FAST;
+    status.temperatureHealth = SensorHealth::OK;
+    status.humidityHealth = SensorHealth::OK;
+    status.temperatureStats = SensorStats{23.1f, 24.0f, 23.5f, 12};
+    status.humidityStats = SensorStats{54.0f, 57.0f, 55.5f, 12};
+    status.scheduleVersion = 3;
+    status.scheduleEnabled = true;
+    status.clockSynced = true;
+    const uint8_t deltaFields = STATUS_FIELD_CURRENT_TEMP | STATUS_FIELD_HUMIDITY;
+
+    uint8_t buffer[STATUS_JSON_CAPACITY];
+    size_t length[2][2] = {};      // [JSON/CBOR][completo/delta]
+    double ns[2][3] = {};          // [JSON/CBOR][completo/delta/comando]
+    for (size_t f = 0; f < WIRE_FORMAT_COUNT; f++) {
+        WireFormat format = WireFormat(f);
+        status.wireFormat = format;
+        char name[64];
+        snprintf(name, sizeof(name), "serializeStatus (%s)", wireFormatName(format));
+        BenchResult full = HostBench::run(name, ITERATIONS, [&] {
+            length[f][0] = serializeStatus(status, format, buffer, sizeof(buffer));
+            HostBench::doNotOptimize(buffer);
+        });
+        snprintf(name, sizeof(name), "serializeStatusDelta (%s)", wireFormatName(format));
+        BenchResult delta = HostBench::run(name, ITERATIONS, [&] {
+            length[f][1] = serializeStatusDelta(status, deltaFields, format, buffer, sizeof(buffer));
+            HostBench::doNotOptimize(buffer);
+        });
+        TEST_ASSERT_EQUAL(0, full.allocsPerOp);
+        TEST_ASSERT_EQUAL(0, delta.allocsPerOp);
+        ns[f][0] = full.nsPerOp;
+        ns[f][1] = delta.nsPerOp;
+    }
+
+    static const char* const commands[] = {
+        "{\"comando\":\"LIGAR\"}",
+        "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22}}",
+        "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"REFRIGERAR\"}}",
+        "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":22,"
+        "\"modo\":\"REFRIGERAR\",\"velocidade\":\"ALTA\"}}",
+    };
+    const size_t count = sizeof(commands) / sizeof(commands[0]);
+    uint8_t cbor[count][64];
+    size_t lengths[2][count];
+    size_t commandBytes[2] = {0, 0};
+    for (size_t c = 0; c < count; c++) {
+        lengths[0][c] = strlen(commands[c]);
+        lengths[1][c] = cborCommand(c, cbor[c], sizeof(cbor[c]));
+        commandBytes[0] += lengths[0][c];
+        commandBytes[1] += lengths[1][c];
+        ACCommand fromJson, fromCbor;
+        TEST_ASSERT_TRUE(CommandParseResult::OK == parseCommandJson(
+            reinterpret_cast<const uint8_t*>(commands[c]), lengths[0][c], fromJson));
+        TEST_ASSERT_TRUE(CommandParseResult::OK == parseCommandCbor(cbor[c], lengths[1][c], fromCbor));
+        TEST_ASSERT_EQUAL(int(fromJson.type), int(fromCbor.type));
+    }
+    for (size_t f = 0; f < WIRE_FORMAT_COUNT; f++) {
+        uint32_t i = 0;
+        ACCommand command;
+        char name[64];
+        snprintf(name, sizeof(name), "parseCommand (%s)", wireFormatName(WireFormat(f)));
+        BenchResult r = HostBench::run(name, ITERATIONS, [&] {
+            size_t c = i++ % count;
+            const uint8_t* payload = f ? cbor[c] : reinterpret_cast<const uint8_t*>(commands[c]);
+            HostBench::doNotOptimize(parseCommand(payload, lengths[f][c], command));
+        });
+        TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+        ns[f][2] = r.nsPerOp;
+    }
+
+    char line[200];
+    snprintf(line, sizeof(line),
+             "        bytes JSON/CBOR: status %u/%u, delta %u/%u, comandos %.1f/%.1f; "
+             "ns CBOR/JSON: status %.2fx, delta %.2fx, comandos %.2fx",
+             (unsigned)length[0][0], (unsigned)length[1][0], (unsigned)length[0][1], (unsigned)length[1][1],
+             double(commandBytes[0]) / count, double(commandBytes[1]) / count,
+             ns[1][0] / ns[0][0], ns[1][1] / ns[0][1], ns[1][2] / ns[0][2]);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN(length[0][0] / 2, length[1][0]);
+    TEST_ASSERT_LESS_THAN(commandBytes[0] / 2, commandBytes[1]);
+}
+
+// Troca de cena "liga, 22 °C, refrigerar, ventilador alto" e volta para
+// "liga, 25 °C, ventilar, baixa": quatro comandos avulsos contra um SET_STATE.
+// blocked = tempo virtual do primeiro byte do comando até o status publicado;
+// "no ar" = do primeiro byte até o fim do último quadro IR da cena.
+static const char* const SCENE_PER_FIELD[2][4] = {
+    {"{\"comando\":\"LIGAR\"}",
+     "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22}}",
+     "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"REFRIGERAR\"}}",
+     "{\"comando\":\"VELOCIDADE\",\"parametros\":{\"velocidade\":\"ALTA\"}}"},
+    {"{\"comando\":\"LIGAR\"}",
+     "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":25}}",
+     "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"VENTILAR\"}}",
+     "{\"comando\":\"VELOCIDADE\",\"parametros\":{\"velocidade\":\"BAIXA\"}}"},
+};
+
+static const char* const SCENE_SET_STATE[2][1] = {
+    {"{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":22,"
+     "\"modo\":\"REFRIGERAR\",\"velocidade\":\"ALTA\"}}"},
+    {"{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":25,"
+     "\"modo\":\"VENTILAR\",\"velocidade\":\"BAIXA\"}}"},
+};
+
+static const uint32_t SCENES = 400;
+
+struct SceneResult {
+    BenchResult bench;
+    double airUsPerOp;
+};
+
+template <size_t N>
+static SceneResult benchScenes(const char* name, IRProtocol protocol, const char* const (&scenes)[2][N]) {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.setProtocol(protocol);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+
+    uint32_t framesBefore = HostIRLog::count();
+    uint32_t publishesBefore = FakeBroker::instance().publishCount();
+    HostAllocStats allocBefore = HostAlloc::stats();
+    uint64_t blockedUs = 0;
+    uint64_t airUs = 0;
+    std::chrono::steady_clock::duration cpu{};
+
+    for (uint32_t i = 0; i < SCENES; i++) {
+        // Cenas chegam com folga entre si; a pausa não entra na latência
+        HostClock::advanceMillis(5000);
+        uint64_t t0 = HostClock::nowMicros();
+        uint32_t sceneFrames = HostIRLog::count();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t m = 0; m < N; m++) {
+            FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, scenes[i % 2][m]);
+        }
+        network.update();
+        cpu += std::chrono::steady_clock::now() - start;
+        blockedUs += HostClock::nowMicros() - t0;
+
+        // Loop de 1 ms até o último quadro sair
+        while (!ac.irIdle()) {
+            HostClock::advanceMillis(1);
+            ac.updateIR();
+        }
+        if (HostIRLog::count() > sceneFrames) {
+            airUs += HostIRLog::last()->timestampUs + HostIRLog::last()->durationUs - t0;
+        }
+    }
+
+    HostAllocStats allocAfter = HostAlloc::stats();
+    BenchResult result;
+    result.name = name;
+    result.iterations = SCENES;
+    result.nsPerOp = std::chrono::duration<double, std::nano>(cpu).count() / SCENES;
+    result.allocsPerOp = double(allocAfter.calls - allocBefore.calls) / SCENES;
+    result.bytesPerOp = double(allocAfter.bytes - allocBefore.bytes) / SCENES;
+    result.blockedUsPerOp = double(blockedUs) / SCENES;
+    HostBench::report(result);
+
+    char line[128];
+    snprintf(line, sizeof(line), "        %.2f quadros IR/cena, %.1f ms no ar/cena, %.2f publicações/cena, %u mensagens/cena",
+             double(HostIRLog::count() - framesBefore) / SCENES, double(airUs) / SCENES / 1000.0,
+             // inject() também passa pelo broker: desconta as mensagens de comando
+             double(FakeBroker::instance().publishCount() - publishesBefore) / SCENES - N, (unsigned)N);
+    TEST_MESSAGE(line);
+    return SceneResult{result, double(airUs) / SCENES};
+}
+
+void bench_scene_change() {
+    SceneResult perField = benchScenes("cena: 4 comandos avulsos (NEC)", IRProtocol::NEC, SCENE_PER_FIELD);
+    SceneResult necState = benchScenes("cena: SET_STATE (NEC)", IRProtocol::NEC, SCENE_SET_STATE);
+    SceneResult coolixState = benchScenes("cena: SET_STATE (Coolix)", IRProtocol::COOLIX, SCENE_SET_STATE);
+
+    // Com o IR no RMT o loop não espera pelos quadros
+    TEST_ASSERT_EQUAL(0, perField.bench.blockedUsPerOp);
+    TEST_ASSERT_EQUAL(0, coolixState.bench.blockedUsPerOp);
+    TEST_ASSERT_LESS_THAN(perField.bench.nsPerOp, necState.bench.nsPerOp);
+    TEST_ASSERT_LESS_OR_EQUAL(perField.airUsPerOp, necState.airUsPerOp);
+    TEST_ASSERT_LESS_THAN(perField.airUsPerOp / 2, coolixState.airUsPerOp);
+}
+
+void bench_command_queue() {
+    CommandQueue queue;
+    ACCommand command{ACCommandType::SET_TEMPERATURE, 22};
+    ACCommand out;
+    BenchResult r = HostBench::run("CommandQueue push+pop", ITERATIONS, [&] {
+        queue.push(command);
+        queue.pop(out);
+        HostBench::doNotOptimize(out);
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+}
+
+void bench_sensor_filter() {
+    SensorFilter filter(SENSOR_EMA_ALPHA, SENSOR_TEMP_SNAP);
+    uint32_t i = 0;
+    BenchResult r = HostBench::run("SensorFilter::push", ITERATIONS, [&] {
+        HostBench::doNotOptimize(filter.push(24.0f + float(i++ % 7) * 0.1f));
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+}
+
+void bench_dht22_decode() {
+    // Quadro como o RMT entrega: resposta 80/80, 40 bits e o fim em alto
+    const uint8_t frame[Dht22::FRAME_BYTES] = {0x02, 0x8C, 0x01, 0x5F, 0xEE};
+    rmt_item32_t items[Dht22::FRAME_BITS + 2] = {};
+    items[0] = rmt_item32_t{{{80, 0, 80, 1}}};
+    for (size_t bit = 0; bit < Dht22::FRAME_BITS; bit++) {
+        bool one = frame[bit / 8] & (0x80 >> (bit % 8));
+        items[bit + 1] = rmt_item32_t{{{50, 0, uint32_t(one ? 70 : 27), 1}}};
+    }
+    items[Dht22::FRAME_BITS + 1] = rmt_item32_t{{{50, 0, 0, 1}}};
+
+    BenchResult r = HostBench::run("Dht22 decodeItems+decodeFrame", ITERATIONS, [&] {
+        uint8_t bytes[Dht22::FRAME_BYTES] = {0};
+        Dht22::Reading reading{0, 0};
+        Dht22::decodeItems(items, Dht22::FRAME_BITS + 2, bytes);
+        HostBench::doNotOptimize(Dht22::decodeFrame(bytes, reading));
+        HostBench::doNotOptimize(reading);
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+}
+
+void bench_sensor_step() {
+    // A biblioteca DHT anterior segurava o loop ~5 ms por leitura; aqui o
+    // passo só consulta o RMT e nunca consome tempo do firmware
+    HostDht22::reset();
+    SensorPipeline pipeline(PIN_DHT);
+    TEST_ASSERT_TRUE(pipeline.begin());
+    BenchResult r = HostBench::run("SensorPipeline::step (leitura em curso)", ITERATIONS, [&] {
+        HostBench::doNotOptimize(pipeline.step());
+    });
+    TEST_ASSERT_EQUAL(0, r.blockedUsPerOp);
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+}
+
+// Uma hora de amostras por minuto: ruído de ±0,1 °C / ±0,5 %UR e o AC
+// ligando uma vez
+static void fillTelemetryHour(TelemetryRecord* records, size_t count) {
+    uint32_t lcg = 7;
+    for (size_t i = 0; i < count; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        records[i].time = uint32_t(i * 60);
+        records[i].temperature = int16_t(240 + int(lcg >> 28) % 3 - 1 - int(i / 10));
+        records[i].humidity = uint16_t(550 + int(lcg >> 24 & 0xF) % 11 - 5);
+        records[i].state = i < count / 2 ? 22 : 0x80 | 22;
+    }
+}
+
+void bench_telemetry_codec() {
+    TelemetryRecord records[TELEMETRY_BATCH_RECORDS];
+    fillTelemetryHour(records, TELEMETRY_BATCH_RECORDS);
+    uint8_t buffer[telemetryBatchCapacity(TELEMETRY_BATCH_RECORDS)];
+    size_t encoded = 0;
+    size_t length = 0;
+
+    BenchResult r = HostBench::run("encodeTelemetryBatch (48 amostras)", ITERATIONS, [&] {
+        length = encodeTelemetryBatch(records, TELEMETRY_BATCH_RECORDS, 3600, buffer, sizeof(buffer), encoded);
+        HostBench::doNotOptimize(buffer);
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+    TEST_ASSERT_EQUAL(TELEMETRY_BATCH_RECORDS, encoded);
+
+    TelemetryRecord decoded[TELEMETRY_BATCH_RECORDS];
+    uint32_t now = 0;
+    BenchResult d = HostBench::run("decodeTelemetryBatch (48 amostras)", ITERATIONS, [&] {
+        HostBench::doNotOptimize(decodeTelemetryBatch(buffer, length, decoded, TELEMETRY_BATCH_RECORDS, now));
+    });
+    TEST_ASSERT_EQUAL(0, d.allocsPerOp);
+
+    double bytesPerSample = double(length) / TELEMETRY_BATCH_RECORDS;
+    char line[160];
+    snprintf(line, sizeof(line), "        %.2f bytes/amostra no lote (registro bruto: %u), %.1f ns/amostra codificando, %.1f decodificando",
+             bytesPerSample, (unsigned)TELEMETRY_RECORD_BYTES,
+             r.nsPerOp / TELEMETRY_BATCH_RECORDS, d.nsPerOp / TELEMETRY_BATCH_RECORDS);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_LESS_THAN(TELEMETRY_RECORD_BYTES / 2, bytesPerSample);
+}
+
+void bench_metrics() {
+    // Custo que cada caminho instrumentado paga por amostra
+    Metrics::reset();
+    uint32_t i = 0;
+    BenchResult r = HostBench::run("Metrics::record", ITERATIONS, [&] {
+        Metrics::record(Metrics::Latency::CONTROL_LOOP, i++ & 0xFFF);
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+    TEST_ASSERT_LESS_THAN(200, r.nsPerOp);
+
+    BenchResult t = HostBench::run("Metrics::Timer", ITERATIONS, [&] {
+        Metrics::Timer timer(Metrics::Latency::NETWORK_LOOP);
+    });
+    TEST_ASSERT_EQUAL(0, t.allocsPerOp);
+    TEST_ASSERT_LESS_THAN(200, t.nsPerOp);
+
+    BenchResult c = HostBench::run("Metrics::increment", ITERATIONS, [&] {
+        Metrics::increment(Metrics::Counter::COMMANDS);
+    });
+    TEST_ASSERT_EQUAL(0, c.allocsPerOp);
+
+    char buffer[Metrics::DIAGNOSTICS_JSON_CAPACITY];
+    BenchResult d = HostBench::run("Metrics::serializeDiagnosticsJson", ITERATIONS / 10, [&] {
+        Metrics::record(Metrics::Latency::COMMAND_PARSE, 12);
+        HostBench::doNotOptimize(Metrics::serializeDiagnosticsJson(nullptr, buffer, sizeof(buffer)));
+    });
+    TEST_ASSERT_EQUAL(0, d.allocsPerOp);
+}
+
+void bench_thermostat() {
+    Thermostat thermostat;
+    TEST_ASSERT_TRUE(thermostat.setPolicy(ThermostatPolicy{true, 10, 180, 180, 16, 30}, 0x3F));
+    uint32_t i = 0;
+    BenchResult r = HostBench::run("Thermostat::update", ITERATIONS, [&] {
+        HostBench::doNotOptimize(thermostat.update(23.0f + float(i % 40) * 0.05f, true, 24, i * 500));
+        i++;
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+
+    // Sala de 30 °C até 24 °C e 12 h regulando, por largura de banda: quanto
+    // mais estreita, mais partidas do compressor e quadros IR
+    static const uint8_t BANDS[] = {5, 10, 20};
+    for (uint8_t band : BANDS) {
+        HostClock::reset();
+        HostIRLog::reset();
+        HostDht22::reset();
+        ACController ac(PIN_IR_LED, PIN_DHT);
+        ac.begin();
+        TEST_ASSERT_TRUE(ac.setThermostat(ThermostatPolicy{true, band, 180, 180, 16, 30}, 0x3F));
+        ac.setTemperature(24);
+        ac.setMode(ACMode::COOL);
+        ac.turnOn();
+
+        HostRoom room{30.0f, 32.0f, 7200.0f, 0.004f};
+        const uint32_t stepMs = 50;
+        const uint64_t durationMs = 12ULL * 3600 * 1000;
+        uint64_t settledMs = 0;
+        float worst = 0.0f;
+        for (uint64_t t = 0; t < durationMs; t += stepMs) {
+            HostDht22::setReading(PIN_DHT, room.temperature, 50.0f);
+            ac.update();
+            bool cooling = ac.isOn() && ac.getEffectiveMode() == ACMode::COOL;
+            room.step(stepMs / 1000.0f, cooling);
+            float error = fabsf(room.temperature - 24.0f);
+            if (!settledMs && error <= band / 20.0f + 0.5f) settledMs = t;
+            if (settledMs && error > worst) worst = error;
+            HostClock::advanceMillis(stepMs);
+        }
+
+        char line[160];
+        snprintf(line, sizeof(line),
+                 "        banda %.1f C: assenta em %.1f min, erro máx %.2f C, %u partidas e %u quadros IR em 12 h",
+                 band / 10.0, settledMs / 60000.0, double(worst), (unsigned)ac.thermostat().starts(),
+                 (unsigned)ac.irSender().framesSent());
+        TEST_MESSAGE(line);
+        // Tempos mínimos de 180 s: no máximo 10 partidas por hora
+        TEST_ASSERT_LESS_OR_EQUAL(12 * 10, ac.thermostat().starts());
+    }
+}
+
+void bench_schedule() {
+    // Pior caso da tabela: 64 transições, uma a cada 157 minutos
+    char json[2048];
+    size_t n = snprintf(json, sizeof(json), "{\"comando\":\"AGENDA\",\"parametros\":{\"versao\":1,\"transicoes\":[");
+    for (int i = 0; i < 64; i++) {
+        int minute = i * 157 % MINUTES_PER_DAY;
+        n += snprintf(json + n, sizeof(json) - n, "%s[\"%d\",\"%02d:%02d\",%s,%d]", i ? "," : "",
+                      i * 157 / MINUTES_PER_DAY, minute / 60, minute % 60, i % 2 ? "false" : "true", 18 + i % 8);
+    }
+    snprintf(json + n, sizeof(json) - n, "]}}");
+
+    ScheduleTable table;
+    BenchResult p = HostBench::run("parseScheduleJson (64 transições)", ITERATIONS / 10, [&] {
+        HostBench::doNotOptimize(parseScheduleJson(reinterpret_cast<const uint8_t*>(json), strlen(json), table));
+    });
+    TEST_ASSERT_EQUAL(0, p.allocsPerOp);
+    TEST_ASSERT_EQUAL(64, table.count);
+
+    Scheduler scheduler;
+    scheduler.install(table);
+    ACCommand command;
+    const uint32_t base = 29871360;     // domingo, 18/10/2026 00:00 UTC
+    scheduler.pollAt(base, command);
+
+    // Caminho de todo poll(): nada vence, uma comparação
+    uint32_t idle = 0;
+    BenchResult q = HostBench::run("Scheduler::pollAt (sem transição)", ITERATIONS, [&] {
+        HostBench::doNotOptimize(scheduler.pollAt(base + (idle++ & 63) / 64, command));
+    });
+    TEST_ASSERT_EQUAL(0, q.allocsPerOp);
+
+    // Cada chamada dispara: busca binária da próxima transição (a do
+    // minuto 0 já foi aplicada ao alcançar o horário acima)
+    uint32_t missed = 0;
+    uint32_t step = 1;
+    BenchResult r = HostBench::run("Scheduler::pollAt (dispara)", ITERATIONS, [&] {
+        uint32_t week = step / 64;
+        uint32_t minute = base + week * MINUTES_PER_WEEK + table.transitions[step % 64].minute;
+        if (!scheduler.pollAt(minute, command)) missed++;
+        step++;
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+    TEST_ASSERT_EQUAL(0, missed);
+}
+
+// Um dia de uso de um aparelho contra a NVS do host: gravando a cada
+// mudança (um blob de 4 bytes, o caminho ingênuo) ou pelo ACStateStore
+struct StateDay {
+    uint32_t changes;
+    uint32_t writes;
+    uint64_t flashBytes;
+    uint32_t maxPageErases;
+};
+
+static StateDay runStateDay(bool debounced, uint32_t burstEveryS, uint32_t burstLength) {
+    HostClock::reset();
+    HostNvs::reset();
+    ACStateStore store;
+    store.begin();
+    ACSettings settings{true, 24, ACMode::COOL, FanSpeed::AUTO};
+    StateDay day = {};
+
+    const uint32_t stepMs = 100;
+    const uint64_t dayMs = 24ULL * 3600 * 1000;
+    for (uint64_t t = 0; t < dayMs; t += stepMs) {
+        // Rajadas de uma mudança por segundo, cada uma para um estado
+        // pseudoaleatório (raramente o já gravado)
+        uint32_t second = uint32_t(t / 1000);
+        if (t % 1000 == 0 && second % burstEveryS < burstLength) {
+            uint32_t h = (second + 1) * 2654435761u;
+            settings.targetTemp = uint8_t(16 + (h >> 8) % 15);
+            settings.mode = ACMode((h >> 16) % AC_MODE_COUNT);
+            settings.fanSpeed = FanSpeed((h >> 24) % FAN_SPEED_COUNT);
+            day.changes++;
+            if (!debounced) {
+                Preferences nvs;
+                nvs.begin(STATE_NVS_NAMESPACE, false);
+                nvs.putBytes("unidade0", &settings, sizeof(settings));
+                nvs.end();
+            }
+        }
+        if (debounced) {
+            store.note(0, settings);
+            store.poll();
+        }
+        HostClock::advanceMillis(stepMs);
+    }
+    day.writes = HostNvs::writeCalls();
+    day.flashBytes = HostNvs::flashBytesWritten();
+    day.maxPageErases = HostNvs::maxPageErases();
+    return day;
+}
+
+static void reportStateDay(const char* name, const StateDay& day) {
+    // Dado útil: os 4 bytes de ACSettings de cada mudança
+    double amplification = double(day.flashBytes) / (4.0 * day.changes);
+    // Em rodízio cada página é apagada uma vez a cada volta pela partição
+    // (126 entradas de 32 bytes por página); a flash aguenta 100k ciclos
+    double erasesPerPage = day.flashBytes / (32.0 * 126 * HOST_NVS_PAGES);
+    double years = erasesPerPage > 0 ? 100000.0 / erasesPerPage / 365.0 : 0.0;
+    char line[240];
+    snprintf(line, sizeof(line),
+             "        %s: %5u mudanças/dia -> %5u gravações, %7.1f KB na flash (%.2fx os dados), "
+             "%.2f apagamentos/página/dia (máx. medido %u), %.1f anos",
+             name, unsigned(day.changes), unsigned(day.writes), day.flashBytes / 1024.0, amplification,
+             erasesPerPage, unsigned(day.maxPageErases), years);
+    TEST_MESSAGE(line);
+}
+
+void bench_state_store() {
+    // Boot: ler o registro e restaurar o aparelho, antes da primeira conexão
+    HostNvs::reset();
+    {
+        Preferences nvs;
+        nvs.begin(STATE_NVS_NAMESPACE, false);
+        nvs.putULong64("unidade0", ACStateStore::pack(ACSettings{true, 19, ACMode::COOL, FanSpeed::FAST}));
+        nvs.end();
+    }
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ACStateStore store;
+    BenchResult r = HostBench::run("ACStateStore::begin + ACController::restore", ITERATIONS, [&] {
+        store.begin();
+        ACSettings saved;
+        if (store.stored(0, saved)) ac.restore(saved);
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+    TEST_ASSERT_EQUAL(19, ac.getTargetTemperature());
+
+    // Caminho de todo passo da tarefa de rede: nada mudou
+    ACSettings settings = ac.getSettings();
+    store.note(0, settings);
+    BenchResult n = HostBench::run("ACStateStore::note + poll (sem mudança)", ITERATIONS, [&] {
+        store.note(0, settings);
+        HostBench::doNotOptimize(store.poll());
+    });
+    TEST_ASSERT_EQUAL(0, n.allocsPerOp);
+
+    // Rajada de 5 mudanças a cada 10 min, e o pior caso: uma por segundo
+    StateDay naive = runStateDay(false, 600, 5);
+    StateDay store5 = runStateDay(true, 600, 5);
+    StateDay naiveWorst = runStateDay(false, 1, 1);
+    StateDay storeWorst = runStateDay(true, 1, 1);
+    reportStateDay("rajadas, a cada mudança ", naive);
+    reportStateDay("rajadas, ACStateStore   ", store5);
+    reportStateDay("1/s, a cada mudança     ", naiveWorst);
+    reportStateDay("1/s, ACStateStore       ", storeWorst);
+    // Cada rajada vira uma gravação; sem pausa, uma por STATE_SAVE_MAX_DELAY
+    TEST_ASSERT_LESS_OR_EQUAL(24 * 6, store5.writes);
+    TEST_ASSERT_LESS_OR_EQUAL(24 * 3600 * 1000 / STATE_SAVE_MAX_DELAY + 1, storeWorst.writes);
+}
+
+// Imagem de 1 MB, o tamanho típico do firmware com WiFi e MQTT
+static const size_t OTA_IMAGE_SIZE = 1024 * 1024;
+static uint8_t g_otaImage[OTA_IMAGE_SIZE];
+
+static void benchOtaTransfer(uint32_t lossEvery) {
+    HostClock::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+    HostNvs::reset();
+    HostOta::reset();
+
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    OtaUpdater ota;
+    ac.begin();
+    ota.begin();
+    network.attachOta(ota);
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int i = 0; i < 20; i++) {
+        network.update();
+        HostClock::advanceMillis(10);
+    }
+
+    OtaServer server(DEVICE_ID, g_otaImage, OTA_IMAGE_SIZE, "1.1.0");
+    server.setLossEvery(lossEvery);
+    uint64_t virtualStart = HostClock::nowMicros();
+    auto wallStart = std::chrono::steady_clock::now();
+    server.offer();
+    // Passo de 10 ms da tarefa de rede
+    while (!server.finished() && HostClock::nowMicros() - virtualStart < 600000000ULL) {
+        server.step();
+        network.update();
+        HostClock::advanceMillis(10);
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    double virtualS = (HostClock::nowMicros() - virtualStart) / 1e6;
+    TEST_ASSERT_EQUAL_STRING("REINICIANDO", server.deviceState());
+    TEST_ASSERT_EQUAL_UINT32(0, HostOta::dirtyWrites());
+
+    // No fio: PUBLISH QoS 0 = 2 bytes fixos + 2 + tópico, mais o cabeçalho do bloco
+    double wire = double(server.bytesSent()) + server.chunksSent() * (4.0 + strlen(MQTT_OTA_CHUNK_TOPIC));
+    char loss[24] = "sem perda";
+    if (lossEvery) snprintf(loss, sizeof(loss), "perda 1/%u", unsigned(lossEvery));
+    char line[220];
+    snprintf(line, sizeof(line),
+             "        1 MB, %s: %.1f KB/s a passos de 10 ms, %u blocos (%u perdidos, %u reenviados), "
+             "%u relatórios, %.1f%% de overhead no fio, %.0f ms de CPU",
+             loss, OTA_IMAGE_SIZE / 1024.0 / virtualS, unsigned(server.chunksSent()),
+             unsigned(server.chunksLost()), unsigned(server.chunksResent()), unsigned(server.reports()),
+             100.0 * (wire / OTA_IMAGE_SIZE - 1.0), wallMs);
+    TEST_MESSAGE(line);
+}
+
+void bench_ota_transfer() {
+    for (size_t i = 0; i < OTA_IMAGE_SIZE; i++) g_otaImage[i] = uint8_t(i * 2654435761u >> 24);
+    g_otaImage[0] = ESP_IMAGE_HEADER_MAGIC;
+
+    // Caminho de cada bloco no dispositivo: flash (um apagamento a cada 8) e SHA-256
+    HostOta::reset();
+    HostNvs::reset();
+    OtaUpdater ota;
+    ota.begin();
+    OtaServer offerOnly(DEVICE_ID, g_otaImage, OTA_IMAGE_SIZE, "1.1.0");
+    OtaOffer offer = {};
+    offer.size = OTA_IMAGE_SIZE;
+    memcpy(offer.sha256, offerOnly.sha256(), OTA_SHA256_BYTES);
+    strcpy(offer.version, "1.1.0");
+    ota.offer(offer);
+
+    uint8_t packet[OTA_CHUNK_HEADER_BYTES + OTA_CHUNK_SIZE];
+    uint32_t index = 0;
+    BenchResult r = HostBench::run("OtaUpdater::receive (512 B)", 1800, [&] {
+        packOtaChunkHeader(otaSessionTag(offer.sha256), index, packet);
+        memcpy(packet + OTA_CHUNK_HEADER_BYTES, g_otaImage + index * OTA_CHUNK_SIZE, OTA_CHUNK_SIZE);
+        ota.receive(packet, sizeof(packet));
+        index++;
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+    TEST_ASSERT_EQUAL_UINT32(index, ota.nextChunk());
+
+    // Transferência inteira pelo FakeBroker, sem perda e com perda
+    benchOtaTransfer(0);
+    benchOtaTransfer(50);
+}
+
+// Controle "capturado" por um TSOP: o quadro do codificador com as marcas
+// esticadas, os espaços encurtados e ±40 µs de ruído
+static uint16_t captureRemote(const IREncoder& encoder, const ACSettings& settings, uint16_t* durations, uint32_t seed) {
+    uint16_t length = encoder.encode(settings, durations, IR_MAX_PULSES);
+    uint32_t x = seed;
+    for (uint16_t i = 0; i < length; i++) {
+        x = x * 1664525u + 1013904223u;
+        int32_t noise = int32_t(x >> 24) % 81 - 40;
+        durations[i] = uint16_t(int32_t(durations[i]) + (i % 2 == 0 ? 60 : -60) + noise);
+    }
+    return length;
+}
+
+static ACSettings libraryState(uint16_t i) {
+    return ACSettings{i != 0, uint8_t(16 + i % 15), ACMode(i / 15 % AC_MODE_COUNT), FanSpeed(i / 60 % FAN_SPEED_COUNT)};
+}
+
+// Tempo de CPU de sendState até o rmt_write_items, com o transmissor livre
+// a cada quadro (o relógio virtual anda fora da medição)
+static double sendStateNs(const IREncoder& encoder, uint32_t frames) {
+    IRSender sender(PIN_IR_LED);
+    sender.begin();
+    double totalNs = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        HostClock::advanceMillis(1000);
+        sender.poll();
+        ACSettings settings = libraryState(uint16_t(1 + i % (IRLibrary::KEYS - 1)));
+        auto start = std::chrono::steady_clock::now();
+        sender.sendState(encoder, settings);
+        totalNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    TEST_ASSERT_EQUAL_UINT32(frames, sender.framesSent());
+    return totalNs / frames;
+}
+
+void bench_ir_library() {
+    static const IRProtocol REMOTES[] = {IRProtocol::COOLIX, IRProtocol::GREE, IRProtocol::MIDEA, IRProtocol::LG};
+    uint16_t durations[IR_MAX_PULSES];
+    uint8_t code[IRCode::MAX_BYTES];
+    IRCode::Info info;
+
+    // Uma biblioteca inteira (todas as chaves) por controle capturado
+    for (IRProtocol protocol : REMOTES) {
+        const IREncoder& encoder = *irEncoderFor(protocol);
+        uint32_t rawBytes = 0;
+        uint32_t codeBytes = 0;
+        uint32_t pairs = 0;
+        for (uint16_t key = 0; key < IRLibrary::KEYS; key++) {
+            uint16_t length = captureRemote(encoder, libraryState(key), durations, key + 1);
+            TEST_ASSERT_EQUAL(int(IRCode::Result::OK), int(IRCode::compress(durations, length, code, sizeof(code), info)));
+            rawBytes += length * 2;
+            codeBytes += info.bytes;
+            pairs += info.pairs;
+        }
+        // Registro na flash: cabeçalho e código completado até 4 bytes
+        uint32_t flashBytes = codeBytes + IRLibrary::KEYS * (IRLibrary::RECORD_HEADER_BYTES + 3);
+        char line[200];
+        snprintf(line, sizeof(line),
+                 "        %-6s %u chaves: %6.1f KB crus -> %5.1f KB (%.1fx), %.1f pares/código, "
+                 "%5.1f KB na flash (%.0f%% de irlib)",
+                 irProtocolName(protocol), unsigned(IRLibrary::KEYS), rawBytes / 1024.0, codeBytes / 1024.0,
+                 double(rawBytes) / codeBytes, double(pairs) / IRLibrary::KEYS, flashBytes / 1024.0,
+                 100.0 * flashBytes / HOST_IR_LIBRARY_PARTITION_SIZE);
+        TEST_MESSAGE(line);
+        TEST_ASSERT_LESS_THAN(rawBytes, codeBytes * 3);
+    }
+
+    // Biblioteca de um controle Coolix na partição, como no dispositivo
+    HostOta::reset();
+    TEST_ASSERT_TRUE(irLibrary.begin());
+    const IREncoder& coolix = *irEncoderFor(IRProtocol::COOLIX);
+    for (uint16_t key = 0; key < IRLibrary::KEYS; key++) {
+        uint16_t length = captureRemote(coolix, libraryState(key), durations, key + 1);
+        IRCode::compress(durations, length, code, sizeof(code), info);
+        TEST_ASSERT_EQUAL(int(IRLibrary::StoreResult::OK), int(irLibrary.store(key, code, info.bytes, info.durations)));
+    }
+
+    // Da flash ao buffer de transmissão; no host cada leitura da partição é um pread
+    uint32_t i = 0;
+    BenchResult r = HostBench::run("IRLibrary::expand (Coolix, 199 durações)", ITERATIONS, [&] {
+        HostBench::doNotOptimize(irLibrary.expand(uint16_t(1 + i++ % (IRLibrary::KEYS - 1)), durations, IR_MAX_PULSES));
+    });
+    TEST_ASSERT_EQUAL(0, r.allocsPerOp);
+    TEST_ASSERT_EQUAL(0, r.blockedUsPerOp);
+
+    uint64_t allocsBefore = HostAlloc::stats().calls;
+    double learnedNs = sendStateNs(*irEncoderFor(IRProtocol::LEARNED), 2000);
+    double directNs = sendStateNs(coolix, 2000);
+    TEST_ASSERT_TRUE(allocsBefore == HostAlloc::stats().calls);
+    char line[160];
+    snprintf(line, sizeof(line),
+             "        sendState -> rmt_write_items: %.0f ns aprendido (flash) vs %.0f ns Coolix sintetizado",
+             learnedNs, directNs);
+    TEST_MESSAGE(line);
+}
+
+static bool discardSummary(const char*, const uint8_t*, size_t, bool, void*) {
+    return true;
+}
+
+static void benchGatewayLoad(uint32_t devices) {
+    GatewayLoadConfig config;
+    config.devices = devices;
+    config.durationMs = 2000;
+    GatewayLoad load(config);
+    TEST_ASSERT_TRUE(load.begin());
+    load.runBurst();
+    load.runSteady();
+    GatewayLoadReport r = load.report();
+    TEST_ASSERT_EQUAL_UINT32(devices, r.burstMessages);
+    TEST_ASSERT_EQUAL_UINT32(r.sent, r.gateway.messages);
+    // Cada mudança sai no máximo no intervalo seguinte
+    TEST_ASSERT_LESS_OR_EQUAL(config.publishIntervalMs * 1000 * 3 / 2, r.gateway.lagP99Us);
+
+    char line[200];
+    snprintf(line, sizeof(line),
+             "        %5u dispositivos: rajada %.0f msg/s, regime %.0f msg/s, defasagem p50 %.0f ms "
+             "p99 %.0f ms, %u resumos/janela de %.0f s",
+             unsigned(devices), r.burstRate(), r.steadyRate(), r.gateway.lagP50Us / 1000.0,
+             r.gateway.lagP99Us / 1000.0, unsigned(r.summaries), r.windowMs / 1000.0);
+    TEST_MESSAGE(line);
+}
+
+void bench_gateway() {
+    // Caminho de cada status no gateway: tópico, parseStatus, tabela, resumos
+    const uint32_t devices = 10000;
+    GatewayConfig config;
+    config.expectedDevices = devices;
+    FleetGateway gateway(config);
+    std::vector<std::string> topics;
+    ACStatus status{true, 24.0f, 55.0f, 23, ACMode::COOL, FanSpeed::AUTO};
+    uint8_t payload[STATUS_JSON_CAPACITY];
+    for (uint32_t i = 0; i < devices; i++) {
+        char id[MqttTopics::SIZE];
+        char block[16];
+        char room[16];
+        snprintf(id, sizeof(id), "ac-control/dispositivos/ESP_%05u", unsigned(i));
+        snprintf(block, sizeof(block), "B%u", unsigned(i / 200));
+        snprintf(room, sizeof(room), "S%u", unsigned(i / 10 % 20));
+        gateway.assign(id + strlen("ac-control/dispositivos/"), block, room);
+        topics.push_back(std::string(id) + "/status/delta");
+        size_t length = serializeStatus(status, WireFormat::JSON, payload, sizeof(payload));
+        gateway.ingest((std::string(id) + "/status").c_str(), payload, length, 0);
+    }
+    // Ids repetidos mediriam uma tabela menor que a anunciada
+    TEST_ASSERT_EQUAL(devices, gateway.devices());
+    gateway.publishDue(0, 0, discardSummary, nullptr);
+
+    uint8_t deltas[2][STATUS_JSON_CAPACITY];
+    size_t lengths[2];
+    for (int i = 0; i < 2; i++) {
+        status.currentTemp = 24.0f + i;
+        lengths[i] = serializeStatusDelta(status, STATUS_FIELD_CURRENT_TEMP, WireFormat::JSON, deltas[i],
+                                          sizeof(deltas[i]));
+    }
+    uint32_t n = 0;
+    BenchResult r = HostBench::run("FleetGateway::ingest (delta, 10k dispositivos)", ITERATIONS, [&] {
+        uint32_t device = n * 7919 % devices;
+        int which = int(n / devices) % 2 ^ 1;
+        gateway.ingest(topics[device].c_str(), deltas[which], lengths[which], n);
+        n++;
+    });
+    TEST_ASSERT_EQUAL_UINT32(devices + n, gateway.stats().messages);
+    // Só o vetor das mudanças pendentes cresce, de vez em quando
+    TEST_ASSERT_TRUE(r.allocsPerOp < 0.01);
+    gateway.publishDue(1000000, 0, discardSummary, nullptr);
+
+    // Frota sintética em tempo real pelo FakeBroker
+    benchGatewayLoad(1000);
+    benchGatewayLoad(10000);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(bench_serialize_status);
+    RUN_TEST(bench_send_nec);
+    RUN_TEST(bench_encode_state);
+    RUN_TEST(bench_mqtt_callback);
+    RUN_TEST(bench_command_trace);
+    RUN_TEST(bench_parse_command);
+    RUN_TEST(bench_wire_format);
+    RUN_TEST(bench_scene_change);
+    RUN_TEST(bench_command_queue);
+    RUN_TEST(bench_sensor_filter);
+    RUN_TEST(bench_dht22_decode);
+    RUN_TEST(bench_sensor_step);
+    RUN_TEST(bench_telemetry_codec);
+    RUN_TEST(bench_metrics);
+    RUN_TEST(bench_thermostat);
+    RUN_TEST(bench_schedule);
+    RUN_TEST(bench_state_store);
+    RUN_TEST(bench_ota_transfer);
+    RUN_TEST(bench_ir_library);
+    RUN_TEST(bench_gateway);
+    return UNITY_END();
+}
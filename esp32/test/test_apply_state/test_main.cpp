@@ -0,0 +1,168 @@
+#include <unity.h>
+#include <FakeBroker.h>
+#include <HostIRLog.h>
+#include "config.h"
+#include "ACController.h"
+#include "Coolix.h"
+#include "ControlLoop.h"
+#include "NetworkManager.h"
+
+static const uint8_t ALL_SETTINGS = STATUS_FIELD_POWER | STATUS_FIELD_TARGET_TEMP | STATUS_FIELD_MODE | STATUS_FIELD_FAN_SPEED;
+
+static const char* const SCENE_JSON =
+    "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":22,"
+    "\"modo\":\"REFRIGERAR\",\"velocidade\":\"ALTA\"}}";
+
+static uint32_t g_statusPublishes = 0;
+
+static void countPublish(const FakeMessage& message, void*) {
+    if (strcmp(message.topic, MQTT_STATUS_TOPIC) == 0) g_statusPublishes++;
+}
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    FakeBroker::instance().reset();
+    FakeBroker::instance().setObserver(countPublish, nullptr);
+    WiFi.hostReset();
+    g_statusPublishes = 0;
+}
+
+void tearDown() {}
+
+static void connect(NetworkManager& network, ACController& ac) {
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+    g_statusPublishes = 0;
+}
+
+// Passo de 1 ms da tarefa de controle até a fila de IR esvaziar
+static void drainIR(ACController& ac) {
+    for (int ms = 0; ms < 5000 && !ac.irIdle(); ms++) {
+        HostClock::advanceMillis(1);
+        ac.updateIR();
+    }
+    TEST_ASSERT_TRUE(ac.irIdle());
+}
+
+void test_coolix_codes_match_reference() {
+    // Desligar é um código fixo do IRCoolixAC (IRremoteESP8266)
+    TEST_ASSERT_EQUAL_HEX32(0xB27BE0, Coolix::stateCode(ACSettings{false, 22, ACMode::COOL, FanSpeed::AUTO}));
+    // AUTO e DRY forçam o ventilador em AUTO0, como IRCoolixAC::setMode
+    TEST_ASSERT_EQUAL_HEX32(0xB21FC8, Coolix::stateCode(ACSettings{true, 25, ACMode::AUTO, FanSpeed::FAST}));
+    TEST_ASSERT_EQUAL_HEX32(0xB23F70, Coolix::stateCode(ACSettings{true, 22, ACMode::COOL, FanSpeed::FAST}));
+    // Ventilar: modo DRY com o código de temperatura reservado
+    TEST_ASSERT_EQUAL_HEX32(0xB29FE4, Coolix::stateCode(ACSettings{true, 22, ACMode::FAN, FanSpeed::SLOW}));
+    // Fora da faixa do protocolo satura em 17..30
+    TEST_ASSERT_EQUAL_HEX32(Coolix::stateCode(ACSettings{true, 17, ACMode::COOL, FanSpeed::AUTO}),
+                            Coolix::stateCode(ACSettings{true, 16, ACMode::COOL, FanSpeed::AUTO}));
+}
+
+void test_coolix_scene_is_one_frame() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.setProtocol(IRProtocol::COOLIX);
+    ac.begin();
+
+    uint8_t changed = ac.applyState(ACSettings{true, 22, ACMode::COOL, FanSpeed::FAST}, ALL_SETTINGS);
+    TEST_ASSERT_EQUAL(ALL_SETTINGS, changed);
+    TEST_ASSERT_EQUAL(1, HostIRLog::count());
+    TEST_ASSERT_EQUAL(int(HostIRProtocol::RAW), int(HostIRLog::last()->protocol));
+    TEST_ASSERT_EQUAL(Coolix::RAW_LENGTH, HostIRLog::last()->bits);
+}
+
+void test_nec_sends_only_changed_fields() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.applyState(ACSettings{true, 22, ACMode::COOL, FanSpeed::FAST}, ALL_SETTINGS);
+    drainIR(ac);
+    TEST_ASSERT_EQUAL(4, HostIRLog::count());
+
+    // Só a temperatura difere: um quadro
+    uint8_t changed = ac.applyState(ACSettings{true, 24, ACMode::COOL, FanSpeed::FAST}, ALL_SETTINGS);
+    TEST_ASSERT_EQUAL(STATUS_FIELD_TARGET_TEMP, changed);
+    drainIR(ac);
+    TEST_ASSERT_EQUAL(5, HostIRLog::count());
+    TEST_ASSERT_EQUAL(IRCodes::TEMP_BASE + 8, HostIRLog::last()->data);
+
+    // Nada mudou: nenhum quadro
+    TEST_ASSERT_EQUAL(0, ac.applyState(ac.getSettings(), ALL_SETTINGS));
+    TEST_ASSERT_EQUAL(5, HostIRLog::count());
+}
+
+void test_off_state_is_stored_without_ir() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.applyState(ACSettings{false, 18, ACMode::FAN, FanSpeed::SLOW}, ALL_SETTINGS);
+    TEST_ASSERT_EQUAL(0, HostIRLog::count());
+    TEST_ASSERT_EQUAL(18, ac.getTargetTemperature());
+    TEST_ASSERT_EQUAL(int(ACMode::FAN), int(ac.getMode()));
+}
+
+void test_partial_state_keeps_other_fields() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.applyState(ACSettings{true, 22, ACMode::COOL, FanSpeed::FAST}, ALL_SETTINGS);
+
+    ac.applyState(ACSettings{false, 27, ACMode::AUTO, FanSpeed::AUTO}, STATUS_FIELD_TARGET_TEMP);
+    TEST_ASSERT_TRUE(ac.isOn());
+    TEST_ASSERT_EQUAL(27, ac.getTargetTemperature());
+    TEST_ASSERT_EQUAL(int(ACMode::COOL), int(ac.getMode()));
+    TEST_ASSERT_EQUAL(int(FanSpeed::FAST), int(ac.getFanSpeed()));
+}
+
+void test_set_state_command_publishes_once() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.setProtocol(IRProtocol::COOLIX);
+    connect(network, ac);
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, SCENE_JSON);
+    network.update();
+
+    TEST_ASSERT_EQUAL(1, HostIRLog::count());
+    TEST_ASSERT_EQUAL(1, g_statusPublishes);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"online\":true,\"ligado\":true,\"temperaturaAtual\":0,\"umidade\":0,\"temperaturaDesejada\":22,"
+        "\"modoOperacao\":\"REFRIGERAR\",\"velocidadeVentilador\":\"ALTA\",\"sensorStatus\":{\"temperatura\":\"DESCONHECIDO\",\"umidade\":\"DESCONHECIDO\"},\"termostato\":{\"ativo\":false,\"demanda\":false},\"formato\":\"JSON\"}",
+        FakeBroker::instance().retained(MQTT_STATUS_TOPIC)->text());
+}
+
+void test_set_state_through_task_queues() {
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ControlLoop control(ac, commands, samples, status);
+    ac.setProtocol(IRProtocol::COOLIX);
+    network.attachQueues(commands, status);
+    connect(network, ac);
+    control.step();
+    network.update();
+    g_statusPublishes = 0;
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, SCENE_JSON);
+    network.update();
+    control.step();
+    network.update();
+
+    TEST_ASSERT_EQUAL(1, HostIRLog::count());
+    TEST_ASSERT_EQUAL(1, g_statusPublishes);
+    TEST_ASSERT_EQUAL(22, ac.getTargetTemperature());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_coolix_codes_match_reference);
+    RUN_TEST(test_coolix_scene_is_one_frame);
+    RUN_TEST(test_nec_sends_only_changed_fields);
+    RUN_TEST(test_off_state_is_stored_without_ir);
+    RUN_TEST(test_partial_state_keeps_other_fields);
+    RUN_TEST(test_set_state_command_publishes_once);
+    RUN_TEST(test_set_state_through_task_queues);
+    return UNITY_END();
+}
@@ -0,0 +1,473 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <HostAlloc.h>
+#include <FakeBroker.h>
+#include "config.h"
+#include "ACController.h"
+#include "CborReader.h"
+#include "CborWriter.h"
+#include "CommandCodec.h"
+#include "JsonReader.h"
+#include "NetworkManager.h"
+#include "ScheduleCodec.h"
+#include "StatusCodec.h"
+
+void setUp() {
+    HostClock::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+// Converte um JSON do protocolo para CBOR como um servidor faria: chaves do
+// dicionário como inteiros, mapas e arrays de tamanho indefinido (o
+// CborWriter só escreve os definidos, então os dois caminhos do leitor são
+// exercitados). Números só inteiros, como nos comandos.
+class JsonToCbor {
+public:
+    JsonToCbor(uint8_t* out, size_t capacity) : _out(out), _capacity(capacity), _length(0) {}
+
+    size_t convert(const char* json) {
+        JsonReader reader(reinterpret_cast<const uint8_t*>(json), strlen(json));
+        TEST_ASSERT_TRUE(value(reader));
+        return _length;
+    }
+
+private:
+    uint8_t* _out;
+    size_t _capacity;
+    size_t _length;
+
+    void byte(uint8_t b) {
+        TEST_ASSERT_LESS_THAN(_capacity, _length);
+        _out[_length++] = b;
+    }
+    void head(uint8_t major, uint32_t argument) {
+        if (argument < 24) {
+            byte(uint8_t(major << 5 | argument));
+        } else if (argument <= 0xFF) {
+            byte(uint8_t(major << 5 | 24));
+            byte(uint8_t(argument));
+        } else {
+            byte(uint8_t(major << 5 | 26));
+            for (int shift = 24; shift >= 0; shift -= 8) byte(uint8_t(argument >> shift));
+        }
+    }
+    void text(const JsonSlice& s) {
+        head(3, uint32_t(s.length));
+        for (size_t i = 0; i < s.length; i++) byte(uint8_t(s.data[i]));
+    }
+    void key(const JsonSlice& name) {
+        for (size_t i = 0; i < WIRE_KEY_COUNT; i++) {
+            if (name.length == WIRE_KEYS[i].length && memcmp(name.data, WIRE_KEYS[i].data, name.length) == 0) {
+                head(0, uint32_t(i));
+                return;
+            }
+        }
+        text(name);
+    }
+    bool value(JsonReader& reader) {
+        JsonSlice s;
+        switch (reader.peek()) {
+            case JsonType::OBJECT:
+                reader.beginObject();
+                byte(0xBF);
+                while (reader.nextMember(s)) {
+                    key(s);
+                    if (!value(reader)) return false;
+                }
+                byte(0xFF);
+                return !reader.failed();
+            case JsonType::ARRAY:
+                reader.beginArray();
+                byte(0x9F);
+                while (reader.nextElement()) {
+                    if (!value(reader)) return false;
+                }
+                byte(0xFF);
+                return !reader.failed();
+            case JsonType::STRING:
+                if (!reader.readString(s)) return false;
+                text(s);
+                return true;
+            case JsonType::NUMBER: {
+                int32_t n = 0;
+                if (!reader.readInteger(n)) return false;
+                if (n < 0) {
+                    head(1, uint32_t(-1 - n));
+                } else {
+                    head(0, uint32_t(n));
+                }
+                return true;
+            }
+            case JsonType::BOOL: {
+                bool b = false;
+                if (!reader.readBool(b)) return false;
+                byte(b ? 0xF5 : 0xF4);
+                return true;
+            }
+            case JsonType::NUL:
+                byte(0xF6);
+                return reader.skipValue();
+            default:
+                return false;
+        }
+    }
+};
+
+static size_t toCbor(const char* json, uint8_t* out, size_t capacity) {
+    JsonToCbor converter(out, capacity);
+    return converter.convert(json);
+}
+
+void test_writer_uses_shortest_items() {
+    uint8_t buffer[64];
+    CborWriter cbor(buffer, sizeof(buffer));
+    cbor.beginObject();
+    cbor.key(WireKey::TEMPERATURA_DESEJADA);
+    cbor.value(uint32_t(23));
+    cbor.key(WireKey::TEMPERATURA_ATUAL);
+    cbor.value(24.0);                       // meia precisão exata
+    cbor.key(WireKey::UMIDADE);
+    cbor.value(double(55.3f));              // só em float
+    cbor.key("fuso");                       // nome do dicionário por extenso
+    cbor.value(int32_t(-180));
+    cbor.key("x");                          // fora do dicionário: texto
+    cbor.value(double(NAN));
+    cbor.key(WireKey::LIGADO);
+    cbor.value(true);
+    cbor.endObject();
+
+    const uint8_t expected[] = {
+        0xA6,
+        0x06, 0x17,
+        0x04, 0xF9, 0x4E, 0x00,
+        0x05, 0xFA, 0x42, 0x5D, 0x33, 0x33,
+        0x18, 0x1F, 0x38, 0xB3,
+        0x61, 'x', 0xF6,
+        0x03, 0xF5
+    };
+    TEST_ASSERT_EQUAL(sizeof(expected), cbor.finish());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, sizeof(expected));
+
+    // Mais membros do que cabem no byte inicial, mapa sem fechar e buffer
+    // curto: nada de payload pela metade
+    CborWriter crowded(buffer, sizeof(buffer));
+    crowded.beginObject();
+    for (uint32_t i = 0; i <= CborWriter::MAX_MEMBERS; i++) {
+        crowded.key(WireKey::MIN);
+        crowded.value(i);
+    }
+    crowded.endObject();
+    TEST_ASSERT_TRUE(crowded.overflowed());
+    TEST_ASSERT_EQUAL(0, crowded.finish());
+
+    CborWriter open(buffer, sizeof(buffer));
+    open.beginObject();
+    TEST_ASSERT_EQUAL(0, open.finish());
+
+    CborWriter small(buffer, 4);
+    small.beginObject();
+    small.key(WireKey::MODO_OPERACAO);
+    small.value("REFRIGERAR");
+    small.endObject();
+    TEST_ASSERT_EQUAL(0, small.finish());
+}
+
+void test_reader_accepts_both_container_forms() {
+    // {"comando": "TEMPERATURA", "parametros": {"temperatura": 22.7}} com o
+    // mapa de fora indefinido e chave por extenso, um membro desconhecido
+    // (bytes com tag) e um inteiro fora do dicionário
+    const uint8_t payload[] = {
+        0xBF,
+        0x00, 0x6B, 'T', 'E', 'M', 'P', 'E', 'R', 'A', 'T', 'U', 'R', 'A',
+        0x18, 0xC8, 0xC2, 0x42, 0x01, 0x02,
+        0x6A, 'p', 'a', 'r', 'a', 'm', 'e', 't', 'r', 'o', 's',
+        0xA2, 0x0A, 0xFA, 0x41, 0xB5, 0x99, 0x9A, 0x0C, 0x9F, 0x01, 0xA0, 0xFF,
+        0xFF
+    };
+    ACCommand command{ACCommandType::TURN_OFF, 0};
+    TEST_ASSERT_TRUE(CommandParseResult::OK == parseCommand(payload, sizeof(payload), command));
+    TEST_ASSERT_EQUAL(int(ACCommandType::SET_TEMPERATURE), int(command.type));
+    TEST_ASSERT_EQUAL(22, command.value);
+
+    CborReader reader(payload, sizeof(payload));
+    TEST_ASSERT_TRUE(reader.beginObject());
+    JsonSlice key;
+    TEST_ASSERT_TRUE(reader.nextMember(key));
+    TEST_ASSERT_TRUE(key.equals("comando"));
+    TEST_ASSERT_TRUE(reader.skipValue());
+    TEST_ASSERT_TRUE(reader.nextMember(key));
+    TEST_ASSERT_EQUAL(0, key.length);
+    TEST_ASSERT_TRUE(JsonType::NONE == reader.peek());
+    TEST_ASSERT_TRUE(reader.skipValue());
+    TEST_ASSERT_TRUE(reader.nextMember(key));
+    TEST_ASSERT_TRUE(key.equals("parametros"));
+    TEST_ASSERT_TRUE(reader.skipValue());
+    TEST_ASSERT_FALSE(reader.nextMember(key));
+    TEST_ASSERT_FALSE(reader.failed());
+}
+
+static void assertCborRejected(const uint8_t* payload, size_t length, CommandParseResult expected) {
+    ACCommand command;
+    TEST_ASSERT_EQUAL_STRING(commandParseResultName(expected),
+                             commandParseResultName(parseCommandCbor(payload, length, command)));
+}
+
+void test_malformed_cbor_is_rejected() {
+    const uint8_t valid[] = {0xA1, 0x00, 0x65, 'L', 'I', 'G', 'A', 'R'};
+    // Cada prefixo: o buffer exato faz uma leitura além do fim aparecer no
+    // AddressSanitizer
+    for (size_t length = 0; length < sizeof(valid); length++) {
+        uint8_t* exact = new uint8_t[length ? length : 1];
+        memcpy(exact, valid, length);
+        assertCborRejected(exact, length, CommandParseResult::MALFORMED);
+        delete[] exact;
+    }
+    assertCborRejected(valid, sizeof(valid), CommandParseResult::OK);
+
+    const uint8_t notMap[] = {0x81, 0x00};
+    const uint8_t hugeCount[] = {0xBA, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+    const uint8_t hugeText[] = {0xA1, 0x00, 0x7A, 0x7F, 0xFF, 0xFF, 0xFF, 'L'};
+    const uint8_t chunkedVerb[] = {0xA1, 0x00, 0x7F, 0x63, 'L', 'I', 'G', 0x62, 'A', 'R', 0xFF};
+    const uint8_t strayBreak[] = {0xA2, 0x00, 0x65, 'L', 'I', 'G', 'A', 'R', 0x18, 0xFF, 0xFF, 0x00};
+    const uint8_t reservedInfo[] = {0xA1, 0x1C, 0x00};
+    const uint8_t floatKey[] = {0xA1, 0xF9, 0x00, 0x00, 0x00};
+    const uint8_t deep[] = {0xA2, 0x00, 0x65, 'L', 'I', 'G', 'A', 'R',
+                            0x18, 0x20, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x00};
+    const uint8_t tags[] = {0xA2, 0x00, 0x65, 'L', 'I', 'G', 'A', 'R',
+                            0x18, 0x20, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x00};
+    const uint8_t nanTemperature[] = {0xA2, 0x00, 0x6B, 'T', 'E', 'M', 'P', 'E', 'R', 'A', 'T', 'U', 'R', 'A',
+                                      0x01, 0xA1, 0x0A, 0xF9, 0x7E, 0x00};
+    assertCborRejected(notMap, sizeof(notMap), CommandParseResult::MALFORMED);
+    assertCborRejected(hugeCount, sizeof(hugeCount), CommandParseResult::MALFORMED);
+    assertCborRejected(hugeText, sizeof(hugeText), CommandParseResult::MALFORMED);
+    // O verbo precisa ser contíguo para virar um trecho sem cópia
+    assertCborRejected(chunkedVerb, sizeof(chunkedVerb), CommandParseResult::MALFORMED);
+    assertCborRejected(strayBreak, sizeof(strayBreak), CommandParseResult::MALFORMED);
+    assertCborRejected(reservedInfo, sizeof(reservedInfo), CommandParseResult::MALFORMED);
+    assertCborRejected(floatKey, sizeof(floatKey), CommandParseResult::MALFORMED);
+    assertCborRejected(deep, sizeof(deep), CommandParseResult::MALFORMED);
+    assertCborRejected(tags, sizeof(tags), CommandParseResult::MALFORMED);
+    assertCborRejected(nanTemperature, sizeof(nanTemperature), CommandParseResult::MALFORMED);
+
+    const uint8_t noVerb[] = {0xA1, 0x00, 0x07};
+    const uint8_t unknownVerb[] = {0xA1, 0x00, 0x64, 'P', 'I', 'N', 'G'};
+    assertCborRejected(noVerb, sizeof(noVerb), CommandParseResult::MISSING_VERB);
+    assertCborRejected(unknownVerb, sizeof(unknownVerb), CommandParseResult::UNKNOWN_VERB);
+}
+
+static void assertSameCommand(const ACCommand& expected, const ACCommand& actual) {
+    TEST_ASSERT_EQUAL(int(expected.type), int(actual.type));
+    TEST_ASSERT_EQUAL(expected.value, actual.value);
+    TEST_ASSERT_EQUAL(expected.fields, actual.fields);
+    TEST_ASSERT_EQUAL_MEMORY(&expected.settings, &actual.settings, sizeof(ACSettings));
+    TEST_ASSERT_EQUAL_MEMORY(&expected.policy, &actual.policy, sizeof(ThermostatPolicy));
+}
+
+static const char* const COMMANDS[] = {
+    "{\"comando\":\"LIGAR\"}",
+    "{\"comando\":\"DESLIGAR\"}",
+    "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22}}",
+    "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"DESUMIDIFICAR\"}}",
+    "{\"comando\":\"VELOCIDADE\",\"parametros\":{\"velocidade\":\"MEDIA\"}}",
+    "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":24,\"modo\":\"REFRIGERAR\",\"velocidade\":\"ALTA\"}}",
+    "{\"comando\":\"TERMOSTATO\",\"parametros\":{\"ativo\":true,\"histerese\":8,\"minLigado\":180,"
+    "\"minDesligado\":240,\"temperaturaMin\":18,\"temperaturaMax\":27}}",
+    "{\"comando\":\"FORMATO\",\"parametros\":{\"formato\":\"CBOR\"}}",
+    "{\"comando\":\"FORMATO\",\"parametros\":{\"formato\":\"JSON\"}}",
+    "{\"origem\":\"painel\",\"parametros\":{\"extra\":[1,{\"a\":null}],\"temperatura\":-3},\"comando\":\"TEMPERATURA\"}",
+    "{\"comando\":\"FORMATO\",\"parametros\":{\"formato\":\"XML\"}}",
+    "{\"comando\":\"PING\"}",
+};
+
+void test_commands_match_json_path() {
+    uint8_t cbor[256];
+    for (const char* json : COMMANDS) {
+        size_t length = toCbor(json, cbor, sizeof(cbor));
+        TEST_ASSERT_TRUE(payloadWireFormat(cbor, length) == WireFormat::CBOR);
+        TEST_ASSERT_LESS_THAN(strlen(json), length);
+
+        ACCommand fromJson{}, fromCbor{};
+        CommandParseResult jsonResult = parseCommand(reinterpret_cast<const uint8_t*>(json), strlen(json), fromJson);
+        CommandParseResult cborResult = parseCommand(cbor, length, fromCbor);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(commandParseResultName(jsonResult), commandParseResultName(cborResult), json);
+        if (jsonResult == CommandParseResult::OK) assertSameCommand(fromJson, fromCbor);
+    }
+
+    ACCommand command;
+    TEST_ASSERT_TRUE(CommandParseResult::OK == parseCommandJson(
+        reinterpret_cast<const uint8_t*>(COMMANDS[7]), strlen(COMMANDS[7]), command));
+    TEST_ASSERT_EQUAL(int(ACCommandType::SET_FORMAT), int(command.type));
+    TEST_ASSERT_EQUAL(int(WireFormat::CBOR), command.value);
+
+    // A agenda compila na mesma tabela
+    const char* schedule =
+        "{\"comando\":\"AGENDA\",\"parametros\":{\"versao\":7,\"fuso\":-180,\"ativa\":true,\"transicoes\":["
+        "[\"12345\",\"07:30\",true,23,\"REFRIGERAR\",\"MEDIA\"],"
+        "[\"12345\",\"18:00\",false],[\"06\",\"09:00\",null,25]]}}";
+    size_t length = toCbor(schedule, cbor, sizeof(cbor));
+    ScheduleTable fromJson, fromCbor;
+    TEST_ASSERT_TRUE(CommandParseResult::OK == parseSchedule(
+        reinterpret_cast<const uint8_t*>(schedule), strlen(schedule), fromJson));
+    TEST_ASSERT_TRUE(CommandParseResult::OK == parseSchedule(cbor, length, fromCbor));
+    uint8_t jsonBlob[SCHEDULE_BLOB_CAPACITY], cborBlob[SCHEDULE_BLOB_CAPACITY];
+    size_t blobLength = packScheduleTable(fromJson, jsonBlob);
+    TEST_ASSERT_EQUAL(blobLength, packScheduleTable(fromCbor, cborBlob));
+    TEST_ASSERT_EQUAL_MEMORY(jsonBlob, cborBlob, blobLength);
+    TEST_ASSERT_EQUAL(12, fromCbor.count);
+}
+
+// Percorre os dois status lado a lado: mesmos nomes, na mesma ordem, com
+// os mesmos valores (números comparados pela parte inteira)
+static void assertSameDocument(JsonReader& json, CborReader& cbor) {
+    JsonType type = json.peek();
+    TEST_ASSERT_EQUAL(int(type), int(cbor.peek()));
+    if (type == JsonType::OBJECT) {
+        TEST_ASSERT_TRUE(json.beginObject());
+        TEST_ASSERT_TRUE(cbor.beginObject());
+        JsonSlice jsonKey, cborKey;
+        while (json.nextMember(jsonKey)) {
+            TEST_ASSERT_TRUE(cbor.nextMember(cborKey));
+            TEST_ASSERT_EQUAL(jsonKey.length, cborKey.length);
+            TEST_ASSERT_EQUAL_MEMORY(jsonKey.data, cborKey.data, jsonKey.length);
+            assertSameDocument(json, cbor);
+        }
+        TEST_ASSERT_FALSE(cbor.nextMember(cborKey));
+    } else if (type == JsonType::STRING) {
+        JsonSlice a, b;
+        TEST_ASSERT_TRUE(json.readString(a));
+        TEST_ASSERT_TRUE(cbor.readString(b));
+        TEST_ASSERT_EQUAL(a.length, b.length);
+        TEST_ASSERT_EQUAL_MEMORY(a.data, b.data, a.length);
+    } else if (type == JsonType::NUMBER) {
+        int32_t a, b;
+        TEST_ASSERT_TRUE(json.readInteger(a));
+        TEST_ASSERT_TRUE(cbor.readInteger(b));
+        TEST_ASSERT_EQUAL(a, b);
+    } else if (type == JsonType::BOOL) {
+        bool a, b;
+        TEST_ASSERT_TRUE(json.readBool(a));
+        TEST_ASSERT_TRUE(cbor.readBool(b));
+        TEST_ASSERT_EQUAL(a, b);
+    } else {
+        TEST_ASSERT_TRUE(json.skipValue());
+        TEST_ASSERT_TRUE(cbor.skipValue());
+    }
+    TEST_ASSERT_FALSE(json.failed());
+    TEST_ASSERT_FALSE(cbor.failed());
+}
+
+void test_status_carries_same_document() {
+    ACStatus status{};
+    status.isOn = true;
+    status.currentTemp = 23.6f;
+    status.currentHumidity = 55.5f;
+    status.targetTemp = 22;
+    status.mode = ACMode::COOL;
+    status.fanSpeed = FanSpeed::MEDIUM;
+    status.temperatureHealth = SensorHealth::OK;
+    status.humidityHealth = SensorHealth::DEGRADED;
+    status.temperatureStats = SensorStats{22.9f, 24.1f, 23.44f, 12};
+    status.humidityStats = SensorStats{50.0f, 60.0f, 55.0f, 12};
+    status.thermostatEnabled = true;
+    status.scheduleVersion = 300;
+    status.scheduleEnabled = true;
+    status.clockSynced = true;
+    status.wireFormat = WireFormat::CBOR;
+
+    char json[STATUS_JSON_CAPACITY];
+    uint8_t cbor[STATUS_JSON_CAPACITY];
+    size_t jsonLength = serializeStatusJson(status, json, sizeof(json));
+    size_t cborLength = serializeStatusCbor(status, cbor, sizeof(cbor));
+    TEST_ASSERT_GREATER_THAN(0, cborLength);
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"formato\":\"CBOR\""));
+    // Chaves de um byte e reais binários: menos da metade do JSON
+    TEST_ASSERT_LESS_THAN(jsonLength / 2, cborLength);
+
+    JsonReader jsonReader(reinterpret_cast<const uint8_t*>(json), jsonLength);
+    CborReader cborReader(cbor, cborLength);
+    assertSameDocument(jsonReader, cborReader);
+
+    // O delta do exemplo em StatusCodec.h
+    const uint8_t delta[] = {0xA1, 0x04, 0xFA, 0x41, 0xBC, 0xCC, 0xCD};
+    TEST_ASSERT_EQUAL(sizeof(delta), serializeStatusDeltaCbor(status, STATUS_FIELD_CURRENT_TEMP, cbor, sizeof(cbor)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(delta, cbor, sizeof(delta));
+
+    // Sem alocação, como o caminho JSON
+    HostAlloc::reset();
+    for (int i = 0; i < 1000; i++) {
+        serializeStatusCbor(status, cbor, sizeof(cbor));
+        ACCommand command;
+        parseCommand(delta, sizeof(delta), command);
+    }
+    TEST_ASSERT_EQUAL(0, HostAlloc::stats().calls);
+}
+
+void test_format_command_switches_status_encoding() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+    FakeBroker& broker = FakeBroker::instance();
+    TEST_ASSERT_NOT_NULL(strstr(broker.retained(MQTT_STATUS_TOPIC)->text(), "\"formato\":\"JSON\""));
+
+    // Pedido em CBOR; o status retido passa a ser CBOR e anuncia a troca
+    uint8_t payload[128];
+    size_t length = toCbor("{\"comando\":\"FORMATO\",\"parametros\":{\"formato\":\"CBOR\"}}", payload, sizeof(payload));
+    broker.inject(MQTT_COMMAND_TOPIC, payload, length);
+    network.update();
+    TEST_ASSERT_TRUE(network.getWireFormat() == WireFormat::CBOR);
+    const FakeMessage* status = broker.retained(MQTT_STATUS_TOPIC);
+    TEST_ASSERT_TRUE(payloadWireFormat(status->payload, status->length) == WireFormat::CBOR);
+
+    // Um comando em JSON continua aceito, e a resposta sai em CBOR
+    broker.inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":19}}");
+    network.update();
+    status = broker.retained(MQTT_STATUS_TOPIC);
+    CborReader reader(status->payload, status->length);
+    TEST_ASSERT_TRUE(reader.beginObject());
+    bool sawTarget = false, sawFormat = false;
+    JsonSlice key;
+    while (reader.nextMember(key)) {
+        JsonSlice text;
+        int32_t number;
+        if (key.equals("temperaturaDesejada")) {
+            sawTarget = reader.readInteger(number) && number == 19;
+        } else if (key.equals("formato")) {
+            sawFormat = reader.readString(text) && text.equals("CBOR");
+        } else {
+            reader.skipValue();
+        }
+    }
+    TEST_ASSERT_FALSE(reader.failed());
+    TEST_ASSERT_TRUE(sawTarget);
+    TEST_ASSERT_TRUE(sawFormat);
+
+    // Nome desconhecido é rejeitado sem mexer na codificação
+    broker.inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"FORMATO\",\"parametros\":{\"formato\":\"XML\"}}");
+    network.update();
+    TEST_ASSERT_TRUE(network.getWireFormat() == WireFormat::CBOR);
+    TEST_ASSERT_NOT_NULL(strstr(broker.lastMessage(MQTT_ERROR_TOPIC)->text(), "INVALID_PARAMETER"));
+
+    broker.inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"FORMATO\",\"parametros\":{\"formato\":\"JSON\"}}");
+    network.update();
+    TEST_ASSERT_NOT_NULL(strstr(broker.retained(MQTT_STATUS_TOPIC)->text(), "\"temperaturaDesejada\":19"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_writer_uses_shortest_items);
+    RUN_TEST(test_reader_accepts_both_container_forms);
+    RUN_TEST(test_malformed_cbor_is_rejected);
+    RUN_TEST(test_commands_match_json_path);
+    RUN_TEST(test_status_carries_same_document);
+    RUN_TEST(test_format_command_switches_status_encoding);
+    return UNITY_END();
+}
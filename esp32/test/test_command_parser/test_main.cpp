@@ -0,0 +1,235 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <HostAlloc.h>
+#include <FakeBroker.h>
+#include <HostIRLog.h>
+#include "config.h"
+#include "ACController.h"
+#include "CommandCodec.h"
+#include "JsonReader.h"
+#include "NetworkManager.h"
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+static CommandParseResult parse(const char* json, ACCommand& command) {
+    return parseCommandJson(reinterpret_cast<const uint8_t*>(json), strlen(json), command);
+}
+
+static void assertParses(const char* json, ACCommandType type, uint8_t value) {
+    ACCommand command{ACCommandType::TURN_OFF, 0xEE};
+    TEST_ASSERT_EQUAL_STRING(commandParseResultName(CommandParseResult::OK),
+                             commandParseResultName(parse(json, command)));
+    TEST_ASSERT_EQUAL(int(type), int(command.type));
+    TEST_ASSERT_EQUAL(value, command.value);
+}
+
+static void assertRejected(const char* json, CommandParseResult expected) {
+    ACCommand command;
+    TEST_ASSERT_EQUAL_STRING(commandParseResultName(expected), commandParseResultName(parse(json, command)));
+}
+
+void test_all_verbs() {
+    assertParses("{\"comando\":\"LIGAR\"}", ACCommandType::TURN_ON, 0);
+    assertParses("{\"comando\":\"DESLIGAR\"}", ACCommandType::TURN_OFF, 0);
+    assertParses("{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22}}",
+                 ACCommandType::SET_TEMPERATURE, 22);
+    assertParses("{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"DESUMIDIFICAR\"}}",
+                 ACCommandType::SET_MODE, uint8_t(ACMode::DRY));
+    assertParses("{\"comando\":\"VELOCIDADE\",\"parametros\":{\"velocidade\":\"MEDIA\"}}",
+                 ACCommandType::SET_FAN_SPEED, uint8_t(FanSpeed::MEDIUM));
+
+    ACCommand command;
+    TEST_ASSERT_TRUE(CommandParseResult::OK == parse(
+        "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":false,\"velocidade\":\"BAIXA\"}}", command));
+    TEST_ASSERT_EQUAL(int(ACCommandType::SET_STATE), int(command.type));
+    TEST_ASSERT_EQUAL(STATUS_FIELD_POWER | STATUS_FIELD_FAN_SPEED, command.fields);
+    TEST_ASSERT_FALSE(command.settings.isOn);
+    TEST_ASSERT_EQUAL(int(FanSpeed::SLOW), int(command.settings.fanSpeed));
+}
+
+void test_key_order_whitespace_and_extra_keys() {
+    assertParses(" \r\n{ \"parametros\" : { \"extra\" : [1, {\"a\": null}, \"}\"], \"temperatura\" : 2.45e1 } ,\n"
+                 "  \"origem\":\"painel\", \"comando\" : \"TEMPERATURA\" }  ",
+                 ACCommandType::SET_TEMPERATURE, 24);
+    // Nomes desconhecidos continuam virando AUTOMATICO
+    assertParses("{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"TURBO\"}}",
+                 ACCommandType::SET_MODE, uint8_t(ACMode::AUTO));
+    // Escapes em valores ignorados não atrapalham
+    assertParses("{\"nota\":\"a\\\"b\\\\\\u00e9\",\"comando\":\"LIGAR\"}", ACCommandType::TURN_ON, 0);
+}
+
+void test_missing_parameters_are_rejected() {
+    // Antes: strcmp(NULL, ...) derrubava o ESP32
+    assertRejected("{\"comando\":\"MODO_OPERACAO\"}", CommandParseResult::INVALID_PARAMETER);
+    assertRejected("{\"comando\":\"VELOCIDADE\",\"parametros\":{}}", CommandParseResult::INVALID_PARAMETER);
+    assertRejected("{\"comando\":\"VELOCIDADE\",\"parametros\":{\"velocidade\":3}}", CommandParseResult::INVALID_PARAMETER);
+    // Antes: temperatura ausente virava 0 °C
+    assertRejected("{\"comando\":\"TEMPERATURA\"}", CommandParseResult::INVALID_PARAMETER);
+    assertRejected("{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":-1}}", CommandParseResult::INVALID_PARAMETER);
+    assertRejected("{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":15}}", CommandParseResult::INVALID_PARAMETER);
+    assertRejected("{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":31}}", CommandParseResult::INVALID_PARAMETER);
+    assertParses("{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":30}}", ACCommandType::SET_TEMPERATURE, 30);
+    assertRejected("{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":1e12}}", CommandParseResult::INVALID_PARAMETER);
+    assertRejected("{\"comando\":\"SET_STATE\",\"parametros\":{\"temperatura\":300}}", CommandParseResult::INVALID_PARAMETER);
+}
+
+void test_malformed_and_unknown() {
+    assertRejected("", CommandParseResult::MALFORMED);
+    assertRejected("[]", CommandParseResult::MALFORMED);
+    assertRejected("{\"comando\":\"LIGAR\"", CommandParseResult::MALFORMED);
+    assertRejected("{\"comando\":\"LIG", CommandParseResult::MALFORMED);
+    assertRejected("{\"comando\" \"LIGAR\"}", CommandParseResult::MALFORMED);
+    assertRejected("{\"comando\":\"LIGAR\",}", CommandParseResult::MALFORMED);
+    assertRejected("{\"a\":1 \"comando\":\"LIGAR\"}", CommandParseResult::MALFORMED);
+    assertRejected("{\"a\":tru,\"comando\":\"LIGAR\"}", CommandParseResult::MALFORMED);
+    assertRejected("{\"a\":\"x\ny\",\"comando\":\"LIGAR\"}", CommandParseResult::MALFORMED);
+    assertRejected("{\"a\":[[[[[[[[[[1]]]]]]]]]],\"comando\":\"LIGAR\"}", CommandParseResult::MALFORMED);
+    assertRejected("{}", CommandParseResult::MISSING_VERB);
+    assertRejected("{\"comando\":7}", CommandParseResult::MISSING_VERB);
+    assertRejected("{\"comando\":\"LIGA\"}", CommandParseResult::UNKNOWN_VERB);
+    assertRejected("{\"comando\":\"LIGARX\"}", CommandParseResult::UNKNOWN_VERB);
+    assertRejected("{\"comando\":\"\"}", CommandParseResult::UNKNOWN_VERB);
+}
+
+void test_payload_without_terminator() {
+    // O buffer do PubSubClient não termina em '\0': nada além de length é lido
+    const char json[] = "{\"comando\":\"LIGAR\"}XXXX";
+    ACCommand command;
+    TEST_ASSERT_TRUE(CommandParseResult::OK ==
+                     parseCommandJson(reinterpret_cast<const uint8_t*>(json), strlen("{\"comando\":\"LIGAR\"}"), command));
+    TEST_ASSERT_TRUE(CommandParseResult::MALFORMED ==
+                     parseCommandJson(reinterpret_cast<const uint8_t*>(json), 10, command));
+    TEST_ASSERT_TRUE(CommandParseResult::MALFORMED == parseCommandJson(nullptr, 0, command));
+}
+
+void test_parse_does_not_allocate() {
+    const char* json = "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":22,"
+                       "\"modo\":\"REFRIGERAR\",\"velocidade\":\"ALTA\"}}";
+    ACCommand command;
+    HostAlloc::reset();
+    for (int i = 0; i < 1000; i++) parse(json, command);
+    TEST_ASSERT_EQUAL(0, HostAlloc::stats().calls);
+}
+
+// Mutações determinísticas dos comandos válidos: troca, remoção, inserção de
+// bytes e truncamento. Cada entrada vai num buffer do tamanho exato para que
+// uma leitura além do fim apareça no AddressSanitizer.
+static const char* const FUZZ_SEEDS[] = {
+    "{\"comando\":\"LIGAR\"}",
+    "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22}}",
+    "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"REFRIGERAR\"}}",
+    "{\"comando\":\"VELOCIDADE\",\"parametros\":{\"velocidade\":\"ALTA\"}}",
+    "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":-2.5e-1,\"x\":[{},\"\\u0041\",null]}}",
+};
+
+static const char FUZZ_ALPHABET[] = "{}[]\":,\\-+.eE0123456789tfnulrsa \n\x01\xff";
+static const uint32_t FUZZ_CASES = 200000;
+
+static uint32_t g_lcg = 1;
+static uint32_t nextRandom() {
+    g_lcg = g_lcg * 1664525u + 1013904223u;
+    return g_lcg >> 8;
+}
+
+void test_fuzz_mutations_never_crash() {
+    uint8_t scratch[160];
+    uint32_t results[5] = {0, 0, 0, 0, 0};
+
+    for (uint32_t n = 0; n < FUZZ_CASES; n++) {
+        const char* seed = FUZZ_SEEDS[n % (sizeof(FUZZ_SEEDS) / sizeof(FUZZ_SEEDS[0]))];
+        size_t length = strlen(seed);
+        memcpy(scratch, seed, length);
+
+        uint32_t mutations = 1 + nextRandom() % 4;
+        for (uint32_t m = 0; m < mutations && length > 0; m++) {
+            size_t at = nextRandom() % length;
+            char byte = FUZZ_ALPHABET[nextRandom() % (sizeof(FUZZ_ALPHABET) - 1)];
+            switch (nextRandom() % 4) {
+                case 0: scratch[at] = uint8_t(byte); break;
+                case 1: memmove(scratch + at, scratch + at + 1, length - at - 1); length--; break;
+                case 2:
+                    if (length < sizeof(scratch)) {
+                        memmove(scratch + at + 1, scratch + at, length - at);
+                        scratch[at] = uint8_t(byte);
+                        length++;
+                    }
+                    break;
+                default: length = at; break;
+            }
+        }
+
+        uint8_t* exact = new uint8_t[length ? length : 1];
+        memcpy(exact, scratch, length);
+        ACCommand command;
+        CommandParseResult result = parseCommandJson(exact, length, command);
+        delete[] exact;
+
+        TEST_ASSERT_LESS_OR_EQUAL(int(CommandParseResult::INVALID_PARAMETER), int(result));
+        results[int(result)]++;
+        if (result == CommandParseResult::OK) {
+            TEST_ASSERT_LESS_OR_EQUAL(int(ACCommandType::SET_STATE), int(command.type));
+            if (command.type == ACCommandType::SET_MODE) TEST_ASSERT_LESS_OR_EQUAL(int(ACMode::FAN), command.value);
+            if (command.type == ACCommandType::SET_FAN_SPEED) TEST_ASSERT_LESS_OR_EQUAL(int(FanSpeed::FAST), command.value);
+        }
+    }
+
+    char report[160];
+    snprintf(report, sizeof(report),
+             "[fuzz] %u entradas: ok=%u malformado=%u sem_comando=%u desconhecido=%u parametro=%u",
+             (unsigned)FUZZ_CASES, (unsigned)results[0], (unsigned)results[1], (unsigned)results[2],
+             (unsigned)results[3], (unsigned)results[4]);
+    TEST_MESSAGE(report);
+    TEST_ASSERT_GREATER_THAN(0, results[0]);
+    TEST_ASSERT_GREATER_THAN(0, results[1]);
+}
+
+void test_rejected_command_leaves_ac_untouched() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+    uint32_t publishes = FakeBroker::instance().publishCount();
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"MODO_OPERACAO\"}");
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"");
+    network.update();
+    TEST_ASSERT_EQUAL(0, HostIRLog::count());
+    // Os injetados e um aviso em .../erro para cada rejeição
+    TEST_ASSERT_EQUAL(publishes + 4, FakeBroker::instance().publishCount());
+    const FakeMessage* error = FakeBroker::instance().lastMessage(MQTT_ERROR_TOPIC);
+    TEST_ASSERT_NOT_NULL(error);
+    TEST_ASSERT_NOT_NULL(strstr(error->text(), "\"erro\":\"INVALID_COMMAND\""));
+    TEST_ASSERT_EQUAL_STRING("INVALID_COMMAND", network.getLastError());
+
+    // Desconhecido: confirma o estado atual
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"PING\"}");
+    network.update();
+    TEST_ASSERT_EQUAL(publishes + 6, FakeBroker::instance().publishCount());
+    TEST_ASSERT_EQUAL(0, HostIRLog::count());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_all_verbs);
+    RUN_TEST(test_key_order_whitespace_and_extra_keys);
+    RUN_TEST(test_missing_parameters_are_rejected);
+    RUN_TEST(test_malformed_and_unknown);
+    RUN_TEST(test_payload_without_terminator);
+    RUN_TEST(test_parse_does_not_allocate);
+    RUN_TEST(test_fuzz_mutations_never_crash);
+    RUN_TEST(test_rejected_command_leaves_ac_untouched);
+    return UNITY_END();
+}
@@ -0,0 +1,335 @@
+#include <unity.h>
+#include <string.h>
+#include <FakeBroker.h>
+#include <HostIRLog.h>
+#include "config.h"
+#include "ACController.h"
+#include "CborWriter.h"
+#include "CommandCodec.h"
+#include "CommandTracer.h"
+#include "ControlLoop.h"
+#include "JsonReader.h"
+#include "NetworkManager.h"
+#include "TaskQueues.h"
+
+static const char ACK_TOPIC[] = "ac-control/dispositivos/" DEVICE_ID "/confirmacao";
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+// Confirmação lida de volta; -1 nas etapas em null
+struct Ack {
+    char id[COMMAND_ID_MAX + 1];
+    char result[32];
+    int32_t unit;
+    int32_t parse;
+    int32_t irStart;
+    int32_t irDone;
+    int32_t publish;
+};
+
+static int32_t stage(JsonReader& reader) {
+    int32_t value = -1;
+    if (reader.peek() == JsonType::NUMBER) {
+        reader.readInteger(value);
+    } else {
+        reader.skipValue();
+    }
+    return value;
+}
+
+static void copy(const JsonSlice& slice, char* out, size_t capacity) {
+    size_t n = slice.length < capacity - 1 ? slice.length : capacity - 1;
+    memcpy(out, slice.data, n);
+    out[n] = '\0';
+}
+
+static Ack readAck(const uint8_t* payload, size_t length) {
+    Ack ack{};
+    JsonReader reader(payload, length);
+    TEST_ASSERT_TRUE(reader.beginObject());
+    JsonSlice key;
+    JsonSlice text;
+    while (reader.nextMember(key)) {
+        if (key.equals("id") && reader.readString(text)) {
+            copy(text, ack.id, sizeof(ack.id));
+        } else if (key.equals("resultado") && reader.readString(text)) {
+            copy(text, ack.result, sizeof(ack.result));
+        } else if (key.equals("unidade")) {
+            ack.unit = stage(reader);
+        } else if (key.equals("etapas")) {
+            TEST_ASSERT_TRUE(reader.beginObject());
+            while (reader.nextMember(key)) {
+                int32_t value = stage(reader);
+                if (key.equals("interpretacao")) ack.parse = value;
+                if (key.equals("inicioIR")) ack.irStart = value;
+                if (key.equals("fimIR")) ack.irDone = value;
+                if (key.equals("publicacao")) ack.publish = value;
+            }
+        } else {
+            reader.skipValue();
+        }
+    }
+    TEST_ASSERT_FALSE(reader.failed());
+    return ack;
+}
+
+static Ack lastAck() {
+    const FakeMessage* message = FakeBroker::instance().lastMessage(ACK_TOPIC);
+    TEST_ASSERT_NOT_NULL_MESSAGE(message, "nenhuma confirmação publicada");
+    return readAck(message->payload, message->length);
+}
+
+static CommandParseResult parse(const char* json, ACCommand& command, JsonSlice& id) {
+    return parseCommand(reinterpret_cast<const uint8_t*>(json), strlen(json), command, id);
+}
+
+void test_parse_reads_optional_id() {
+    ACCommand command;
+    JsonSlice id;
+    TEST_ASSERT_EQUAL(CommandParseResult::OK, parse("{\"comando\":\"LIGAR\",\"id\":\"a1b2\"}", command, id));
+    TEST_ASSERT_TRUE(id.equals("a1b2"));
+
+    TEST_ASSERT_EQUAL(CommandParseResult::OK, parse("{\"comando\":\"LIGAR\"}", command, id));
+    TEST_ASSERT_EQUAL(0, id.length);
+
+    // Rejeitado, o id continua valendo para a confirmação
+    TEST_ASSERT_EQUAL(CommandParseResult::INVALID_PARAMETER,
+                      parse("{\"id\":\"x\",\"comando\":\"TEMPERATURA\"}", command, id));
+    TEST_ASSERT_TRUE(id.equals("x"));
+
+    // Maior que COMMAND_ID_MAX: recusado, sem id
+    TEST_ASSERT_EQUAL(CommandParseResult::INVALID_PARAMETER,
+                      parse("{\"comando\":\"LIGAR\",\"id\":\"0123456789012345678901234567890123456789X\"}",
+                            command, id));
+    TEST_ASSERT_EQUAL(0, id.length);
+
+    // Em CBOR a chave vai por extenso
+    uint8_t buffer[64];
+    CborWriter cbor(buffer, sizeof(buffer));
+    cbor.beginObject();
+    cbor.key(WireKey::COMANDO);
+    cbor.value("DESLIGAR");
+    cbor.key("id");
+    cbor.value("c9");
+    cbor.endObject();
+    size_t length = cbor.finish();
+    TEST_ASSERT_EQUAL(CommandParseResult::OK, parseCommand(buffer, length, command, id));
+    TEST_ASSERT_EQUAL(ACCommandType::TURN_OFF, command.type);
+    TEST_ASSERT_TRUE(id.equals("c9"));
+}
+
+static JsonSlice slice(const char* text) {
+    return JsonSlice{text, strlen(text)};
+}
+
+void test_tracer_waits_for_status_and_ir() {
+    CommandTracer tracer;
+    char buffer[256];
+    uint8_t trace = tracer.open(slice("abc"), 0, 1000, 1040);
+    TEST_ASSERT_TRUE(trace != 0);
+
+    tracer.published(trace, 1500);
+    TEST_ASSERT_EQUAL(0, tracer.nextAck(2000, buffer, sizeof(buffer)));
+
+    CommandTiming ir;
+    ir.trace = trace;
+    ir.transmitted = true;
+    ir.irStartUs = 1100;
+    ir.irDoneUs = 150000;
+    tracer.transmitted(ir);
+    size_t length = tracer.nextAck(160000, buffer, sizeof(buffer));
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_EQUAL(0, tracer.pending());
+
+    Ack ack = readAck(reinterpret_cast<const uint8_t*>(buffer), length);
+    TEST_ASSERT_EQUAL_STRING("abc", ack.id);
+    TEST_ASSERT_EQUAL_STRING("OK", ack.result);
+    TEST_ASSERT_EQUAL(0, ack.unit);
+    TEST_ASSERT_EQUAL(40, ack.parse);
+    TEST_ASSERT_EQUAL(100, ack.irStart);
+    TEST_ASSERT_EQUAL(149000, ack.irDone);
+    TEST_ASSERT_EQUAL(500, ack.publish);
+}
+
+void test_tracer_covers_earlier_commands_and_expires() {
+    CommandTracer tracer;
+    char buffer[256];
+    tracer.open(slice("1"), 0, 0, 10);
+    tracer.open(slice("2"), 1, 0, 10);
+    uint8_t second = tracer.open(slice("3"), 0, 0, 10);
+
+    // Status e IR do segundo comando da unidade 0 valem para o primeiro
+    tracer.published(second, 300);
+    CommandTiming ir;
+    ir.trace = second;
+    tracer.transmitted(ir);
+    size_t length = tracer.nextAck(400, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("1", readAck(reinterpret_cast<const uint8_t*>(buffer), length).id);
+    length = tracer.nextAck(400, buffer, sizeof(buffer));
+    Ack ack = readAck(reinterpret_cast<const uint8_t*>(buffer), length);
+    TEST_ASSERT_EQUAL_STRING("3", ack.id);
+    TEST_ASSERT_EQUAL(-1, ack.irStart);     // sem quadro
+    TEST_ASSERT_EQUAL(300, ack.publish);
+
+    // A outra unidade não foi tocada e só sai no prazo, com o que tiver
+    TEST_ASSERT_EQUAL(0, tracer.nextAck(CommandTracer::TIMEOUT_US - 1, buffer, sizeof(buffer)));
+    length = tracer.nextAck(CommandTracer::TIMEOUT_US, buffer, sizeof(buffer));
+    ack = readAck(reinterpret_cast<const uint8_t*>(buffer), length);
+    TEST_ASSERT_EQUAL_STRING("2", ack.id);
+    TEST_ASSERT_EQUAL(1, ack.unit);
+    TEST_ASSERT_EQUAL(-1, ack.publish);
+    TEST_ASSERT_EQUAL(0, tracer.pending());
+
+    // Sem vaga o mais antigo sai sem confirmação
+    for (uint8_t i = 0; i <= CommandTracer::SLOTS; i++) {
+        tracer.open(slice("n"), 0, 0, 0);
+    }
+    TEST_ASSERT_EQUAL(CommandTracer::SLOTS, tracer.pending());
+    TEST_ASSERT_EQUAL(1, tracer.dropped());
+}
+
+static void connect(NetworkManager& network) {
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+}
+
+// Laço único: o IR anda em ac.update() e a confirmação sai no update() da
+// rede que vê a fila do IR vazia
+void test_single_loop_ack_has_every_stage() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    connect(network);
+
+    HostClock::advanceMillis(1000);
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\",\"id\":\"op-17\"}");
+    network.update();
+    TEST_ASSERT_TRUE(ac.isOn());
+    TEST_ASSERT_NULL(FakeBroker::instance().lastMessage(ACK_TOPIC));
+
+    for (int ms = 0; ms < 1000 && !FakeBroker::instance().lastMessage(ACK_TOPIC); ms++) {
+        HostClock::advanceMillis(1);
+        ac.update();
+        network.update();
+    }
+    Ack ack = lastAck();
+    TEST_ASSERT_EQUAL_STRING("op-17", ack.id);
+    TEST_ASSERT_EQUAL_STRING("OK", ack.result);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, ack.parse);
+    TEST_ASSERT_GREATER_OR_EQUAL(ack.parse, ack.irStart);
+    // O quadro NEC leva ~68 ms no ar
+    TEST_ASSERT_GREATER_THAN(ack.irStart + 60000, ack.irDone);
+    TEST_ASSERT_GREATER_OR_EQUAL(ack.parse, ack.publish);
+    TEST_ASSERT_LESS_THAN(ack.irDone, ack.publish);
+}
+
+void test_queued_command_ack_crosses_tasks() {
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ControlLoop control(ac, commands, samples, status);
+    ac.begin();
+    network.attachQueues(commands, status);
+    connect(network);
+    control.step();
+    network.update();
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC,
+                                  "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":21},"
+                                  "\"id\":\"q\"}");
+    network.update();
+    HostClock::advanceMillis(5);
+    control.step();
+    network.update();
+    TEST_ASSERT_NULL(FakeBroker::instance().lastMessage(ACK_TOPIC));
+
+    for (int ms = 0; ms < 1000 && !FakeBroker::instance().lastMessage(ACK_TOPIC); ms++) {
+        HostClock::advanceMillis(1);
+        control.step();
+        network.update();
+    }
+    Ack ack = lastAck();
+    TEST_ASSERT_EQUAL_STRING("q", ack.id);
+    // O comando esperou o passo da tarefa de controle
+    TEST_ASSERT_EQUAL(5000, ack.irStart);
+    TEST_ASSERT_EQUAL(5000, ack.publish);
+    TEST_ASSERT_GREATER_THAN(ack.irStart, ack.irDone);
+    TEST_ASSERT_TRUE(ac.isOn());
+    TEST_ASSERT_EQUAL(21, ac.getTargetTemperature());
+}
+
+void test_rejected_and_untraced_commands() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    connect(network);
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}");
+    network.update();
+    network.update();
+    TEST_ASSERT_NULL(FakeBroker::instance().lastMessage(ACK_TOPIC));
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"TEMPERATURA\",\"id\":\"r\"}");
+    network.update();
+    network.update();
+    Ack ack = lastAck();
+    TEST_ASSERT_EQUAL_STRING("r", ack.id);
+    TEST_ASSERT_EQUAL_STRING("INVALID_PARAMETER", ack.result);
+    // Em .../erro, o mesmo código na "mensagem" e o texto no "detalhe"
+    const char* error = FakeBroker::instance().lastMessage(MQTT_ERROR_TOPIC)->text();
+    TEST_ASSERT_NOT_NULL(strstr(error, "\"mensagem\":\"INVALID_PARAMETER\""));
+    TEST_ASSERT_NOT_NULL(strstr(error, "\"detalhe\":\"parâmetro inválido\""));
+    TEST_ASSERT_EQUAL(-1, ack.irStart);
+    TEST_ASSERT_EQUAL(-1, ack.irDone);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, ack.publish);
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC "/7", "{\"comando\":\"LIGAR\",\"id\":\"u\"}");
+    network.update();
+    network.update();
+    ack = lastAck();
+    TEST_ASSERT_EQUAL_STRING("u", ack.id);
+    TEST_ASSERT_EQUAL_STRING("UNKNOWN_UNIT", ack.result);
+    TEST_ASSERT_EQUAL(-1, ack.unit);
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"PISCAR\",\"id\":\"v\"}");
+    network.update();
+    network.update();
+    TEST_ASSERT_EQUAL_STRING("UNKNOWN_VERB", lastAck().result);
+}
+
+// Cada desfecho tem um código ASCII fixo; os da interpretação batem com .../erro
+void test_outcome_codes_are_stable() {
+    TEST_ASSERT_EQUAL_STRING("OK", commandOutcomeCode(CommandOutcome::OK));
+    TEST_ASSERT_EQUAL_STRING("UNKNOWN_UNIT", commandOutcomeCode(CommandOutcome::UNKNOWN_UNIT));
+    TEST_ASSERT_EQUAL_STRING("QUEUE_FULL", commandOutcomeCode(CommandOutcome::QUEUE_FULL));
+    const CommandParseResult results[] = {CommandParseResult::OK, CommandParseResult::MALFORMED,
+                                          CommandParseResult::MISSING_VERB, CommandParseResult::UNKNOWN_VERB,
+                                          CommandParseResult::INVALID_PARAMETER};
+    for (CommandParseResult result : results) {
+        TEST_ASSERT_EQUAL_STRING(commandParseResultCode(result), commandOutcomeCode(commandOutcome(result)));
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_reads_optional_id);
+    RUN_TEST(test_tracer_waits_for_status_and_ir);
+    RUN_TEST(test_tracer_covers_earlier_commands_and_expires);
+    RUN_TEST(test_single_loop_ack_has_every_stage);
+    RUN_TEST(test_queued_command_ack_crosses_tasks);
+    RUN_TEST(test_rejected_and_untraced_commands);
+    RUN_TEST(test_outcome_codes_are_stable);
+    return UNITY_END();
+}
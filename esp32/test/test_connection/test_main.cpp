@@ -0,0 +1,201 @@
+#include <unity.h>
+#include <stdio.h>
+#include <FakeBroker.h>
+#include "config.h"
+#include "ACController.h"
+#include "Backoff.h"
+#include "NetworkManager.h"
+
+typedef NetworkManager::ConnectionState State;
+
+// Passo do loop() simulado, como o delay(10) de main.cpp
+static const uint32_t LOOP_STEP_MS = 10;
+
+// Maior tempo virtual gasto dentro de um único update()
+static uint64_t g_worstUpdateUs = 0;
+
+static void step(NetworkManager& network) {
+    uint64_t start = HostClock::nowMicros();
+    network.update();
+    uint64_t spent = HostClock::nowMicros() - start;
+    if (spent > g_worstUpdateUs) g_worstUpdateUs = spent;
+    HostClock::advanceMillis(LOOP_STEP_MS);
+}
+
+static void runFor(NetworkManager& network, uint32_t ms) {
+    uint64_t end = HostClock::nowMicros() + uint64_t(ms) * 1000ULL;
+    while (HostClock::nowMicros() < end) {
+        step(network);
+    }
+}
+
+static bool runUntilConnected(NetworkManager& network, uint32_t maxMs) {
+    uint64_t end = HostClock::nowMicros() + uint64_t(maxMs) * 1000ULL;
+    while (!network.isConnected() && HostClock::nowMicros() < end) {
+        step(network);
+    }
+    return network.isConnected();
+}
+
+static void start(NetworkManager& network, ACController& ac) {
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+}
+
+void setUp() {
+    HostClock::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+    g_worstUpdateUs = 0;
+}
+
+void tearDown() {}
+
+void test_backoff_grows_with_jitter_and_saturates() {
+    Backoff backoff(1000, 60000);
+    uint32_t ceiling = 1000;
+    for (int attempt = 0; attempt < 20; attempt++) {
+        uint32_t delayMs = backoff.next();
+        TEST_ASSERT_GREATER_OR_EQUAL(ceiling / 2, delayMs);
+        TEST_ASSERT_LESS_OR_EQUAL(ceiling, delayMs);
+        ceiling = ceiling * 2 > 60000 ? 60000 : ceiling * 2;
+    }
+    TEST_ASSERT_EQUAL(20, backoff.attempts());
+
+    backoff.reset();
+    TEST_ASSERT_EQUAL(0, backoff.attempts());
+    TEST_ASSERT_LESS_OR_EQUAL(1000, backoff.next());
+}
+
+void test_backoff_jitter_spreads_devices() {
+    // Dez dispositivos na mesma tentativa não devem escolher o mesmo atraso
+    uint32_t first = 0;
+    bool spread = false;
+    for (int device = 0; device < 10; device++) {
+        Backoff backoff(RECONNECT_BACKOFF_MIN, RECONNECT_BACKOFF_MAX);
+        for (int attempt = 0; attempt < 3; attempt++) backoff.next();
+        uint32_t delayMs = backoff.next();
+        if (device == 0) first = delayMs;
+        else if (delayMs != first) spread = true;
+    }
+    TEST_ASSERT_TRUE(spread);
+}
+
+void test_connects_one_step_per_update() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    start(network, ac);
+    TEST_ASSERT_EQUAL(int(State::WIFI_IDLE), int(network.getConnectionState()));
+
+    network.update();
+    TEST_ASSERT_EQUAL(int(State::WIFI_CONNECTING), int(network.getConnectionState()));
+    network.update();
+    TEST_ASSERT_EQUAL(int(State::WIFI_CONNECTED), int(network.getConnectionState()));
+    network.update();
+    TEST_ASSERT_EQUAL(int(State::MQTT_CONNECTING), int(network.getConnectionState()));
+    TEST_ASSERT_FALSE(network.isConnected());
+    network.update();
+    TEST_ASSERT_EQUAL(int(State::SUBSCRIBED), int(network.getConnectionState()));
+    TEST_ASSERT_TRUE(network.isConnected());
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().retained(MQTT_STATUS_TOPIC));
+}
+
+void test_wifi_association_does_not_block_loop() {
+    WiFi.hostSetConnectDelay(4000);
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    start(network, ac);
+
+    TEST_ASSERT_TRUE(runUntilConnected(network, 10000));
+    // Antes: connectWiFi() prendia o loop em delay(500) por até 10 s
+    TEST_ASSERT_LESS_THAN(1000, g_worstUpdateUs);
+    TEST_ASSERT_EQUAL(1, WiFi.hostBeginCount());
+}
+
+void test_wifi_unavailable_retries_with_backoff() {
+    WiFi.hostSetNetworkAvailable(false);
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    start(network, ac);
+
+    runFor(network, 10UL * 60UL * 1000UL);
+    uint32_t begins = WiFi.hostBeginCount();
+    // Cada tentativa espera WIFI_CONNECT_TIMEOUT e depois um backoff crescente
+    TEST_ASSERT_GREATER_THAN(3, begins);
+    TEST_ASSERT_LESS_THAN(10UL * 60UL * 1000UL / WIFI_CONNECT_TIMEOUT, begins);
+    TEST_ASSERT_LESS_THAN(1000, g_worstUpdateUs);
+
+    WiFi.hostSetNetworkAvailable(true);
+    TEST_ASSERT_TRUE(runUntilConnected(network, RECONNECT_BACKOFF_MAX + WIFI_CONNECT_TIMEOUT));
+}
+
+void test_never_gives_up_on_broker() {
+    FakeBroker::instance().setReachable(false);
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    start(network, ac);
+
+    // Antes: MAX_RECONNECT_ATTEMPTS=5 e o dispositivo ficava offline para sempre
+    runFor(network, 30UL * 60UL * 1000UL);
+    TEST_ASSERT_FALSE(network.isConnected());
+    TEST_ASSERT_GREATER_THAN(5, network.getReconnectAttempts());
+
+    FakeBroker::instance().setReachable(true);
+    TEST_ASSERT_TRUE(runUntilConnected(network, RECONNECT_BACKOFF_MAX + LOOP_STEP_MS));
+    TEST_ASSERT_EQUAL(0, network.getReconnectAttempts());
+}
+
+void test_recovers_after_wifi_drop() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    start(network, ac);
+    TEST_ASSERT_TRUE(runUntilConnected(network, 1000));
+    uint32_t publishes = FakeBroker::instance().publishCount();
+
+    WiFi.hostDropConnection();
+    network.update();
+    TEST_ASSERT_EQUAL(int(State::WIFI_IDLE), int(network.getConnectionState()));
+    TEST_ASSERT_FALSE(network.isConnected());
+
+    TEST_ASSERT_TRUE(runUntilConnected(network, RECONNECT_BACKOFF_MAX));
+    TEST_ASSERT_EQUAL(2, WiFi.hostBeginCount());
+    // Status completo republicado ao reassinar
+    TEST_ASSERT_EQUAL(publishes + 1, FakeBroker::instance().publishCount());
+}
+
+void test_worst_case_update_latency_is_bounded() {
+    // Broker que aceita em 300 ms e, quando fora do ar, só falha após 30 s
+    FakeBroker::instance().setConnectLatency(300, 30000);
+    WiFi.hostSetConnectDelay(3000);
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    start(network, ac);
+
+    TEST_ASSERT_TRUE(runUntilConnected(network, 10000));
+    FakeBroker::instance().setReachable(false);
+    runFor(network, 5UL * 60UL * 1000UL);
+    WiFi.hostDropConnection();
+    runFor(network, 60UL * 1000UL);
+    FakeBroker::instance().setReachable(true);
+    TEST_ASSERT_TRUE(runUntilConnected(network, RECONNECT_BACKOFF_MAX + 10000));
+
+    char report[192];
+    snprintf(report, sizeof(report),
+             "[latency] pior update(): %.1f ms (limite MQTT_CONNECT_TIMEOUT=%u ms; antes: 10 s de WiFi + 30 s de TCP)",
+             g_worstUpdateUs / 1000.0, (unsigned)MQTT_CONNECT_TIMEOUT);
+    TEST_MESSAGE(report);
+    TEST_ASSERT_LESS_OR_EQUAL(uint64_t(MQTT_CONNECT_TIMEOUT) * 1000ULL, g_worstUpdateUs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_backoff_grows_with_jitter_and_saturates);
+    RUN_TEST(test_backoff_jitter_spreads_devices);
+    RUN_TEST(test_connects_one_step_per_update);
+    RUN_TEST(test_wifi_association_does_not_block_loop);
+    RUN_TEST(test_wifi_unavailable_retries_with_backoff);
+    RUN_TEST(test_never_gives_up_on_broker);
+    RUN_TEST(test_recovers_after_wifi_drop);
+    RUN_TEST(test_worst_case_update_latency_is_bounded);
+    return UNITY_END();
+}
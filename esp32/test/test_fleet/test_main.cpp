@@ -0,0 +1,161 @@
+#include <unity.h>
+#include <string.h>
+#include <FakeBroker.h>
+#include <HostMqttWire.h>
+#include "config.h"
+#include "FleetSim.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+static FleetConfig smallFleet(uint16_t devices, float commandsPerSecond) {
+    FleetConfig config;
+    config.devices = devices;
+    config.commandsPerSecond = commandsPerSecond;
+    config.connectTimeoutMs = 10000;
+    return config;
+}
+
+void test_remaining_length_round_trip() {
+    const uint32_t lengths[] = {0, 127, 128, 16383, 16384, 2097151, 2097152, 268435455};
+    const size_t sizes[] = {1, 1, 2, 2, 3, 3, 4, 4};
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        uint8_t encoded[4];
+        size_t n = HostMqttWire::encodeLength(lengths[i], encoded);
+        TEST_ASSERT_EQUAL(sizes[i], n);
+        uint32_t decoded = 0;
+        TEST_ASSERT_EQUAL(int(n), HostMqttWire::decodeLength(encoded, n, decoded));
+        TEST_ASSERT_EQUAL_UINT32(lengths[i], decoded);
+        // Faltando o último byte ainda não há comprimento
+        if (n > 1) TEST_ASSERT_EQUAL(0, HostMqttWire::decodeLength(encoded, n - 1, decoded));
+    }
+    const uint8_t invalid[] = {0xFF, 0xFF, 0xFF, 0xFF};
+    uint32_t decoded = 0;
+    TEST_ASSERT_EQUAL(-1, HostMqttWire::decodeLength(invalid, sizeof(invalid), decoded));
+}
+
+void test_packets_match_mqtt_311() {
+    uint8_t packet[64];
+    const uint8_t connect[] = {
+        0x10, 0x1A, 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0xC2, 0x00, 0x0F,
+        0x00, 0x02, 'i', 'd', 0x00, 0x04, 'u', 's', 'e', 'r', 0x00, 0x04, 's', 'e', 'n', 'h'
+    };
+    size_t length = HostMqttWire::connectPacket(packet, sizeof(packet), "id", "user", "senh", 15);
+    TEST_ASSERT_EQUAL(sizeof(connect), length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(connect, packet, length);
+
+    const uint8_t subscribe[] = {0x82, 0x08, 0x00, 0x07, 0x00, 0x03, 'a', '/', '#', 0x00};
+    length = HostMqttWire::subscribePacket(packet, sizeof(packet), 7, "a/#");
+    TEST_ASSERT_EQUAL(sizeof(subscribe), length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(subscribe, packet, length);
+
+    // PUBLISH retido ida e volta
+    const uint8_t payload[] = "{\"comando\":\"STATUS\"}";
+    length = HostMqttWire::publishPacket(packet, sizeof(packet), "a/b", payload, sizeof(payload) - 1, true);
+    TEST_ASSERT_EQUAL(2 + 2 + 3 + sizeof(payload) - 1, length);
+    TEST_ASSERT_EQUAL_HEX8(0x31, packet[0]);
+    const char* topic = nullptr;
+    size_t topicLength = 0;
+    const uint8_t* body = nullptr;
+    size_t bodyLength = 0;
+    TEST_ASSERT_TRUE(HostMqttWire::parsePublish(packet[0] & 0x0F, packet + 2, packet[1],
+                                                topic, topicLength, body, bodyLength));
+    TEST_ASSERT_EQUAL(3, topicLength);
+    TEST_ASSERT_EQUAL_MEMORY("a/b", topic, 3);
+    TEST_ASSERT_EQUAL(sizeof(payload) - 1, bodyLength);
+    TEST_ASSERT_EQUAL_MEMORY(payload, body, bodyLength);
+
+    // Sem espaço: nada é escrito pela metade
+    TEST_ASSERT_EQUAL(0, HostMqttWire::publishPacket(packet, 16, "a/b", payload, sizeof(payload) - 1, false));
+    TEST_ASSERT_FALSE(HostMqttWire::parsePublish(0, packet, 1, topic, topicLength, body, bodyLength));
+}
+
+void test_each_device_answers_its_own_commands() {
+    // Várias instâncias de NetworkManager num processo: cada comando tem de
+    // chegar ao dispositivo do tópico e voltar no status dele
+    FleetSim fleet(smallFleet(8, 4.0f));
+    TEST_ASSERT_TRUE(fleet.begin());
+    for (size_t i = 0; i < fleet.size(); i++) {
+        TEST_ASSERT_TRUE(fleet.deviceConnected(i));
+    }
+    TEST_ASSERT_EQUAL_STRING("SIM_00003", fleet.deviceId(3));
+
+    uint8_t initialTemp = fleet.deviceTargetTemp(0);
+    fleet.runFor(60000);
+    FleetReport report = fleet.report();
+
+    TEST_ASSERT_EQUAL(8, report.connected);
+    TEST_ASSERT_EQUAL_UINT32(60000, report.windowMs);
+    TEST_ASSERT_UINT32_WITHIN(1, 240, report.commandsSent);
+    TEST_ASSERT_EQUAL_UINT32(0, report.commandsDeferred);
+    TEST_ASSERT_LESS_OR_EQUAL(1, report.commandsUnanswered);
+    TEST_ASSERT_EQUAL_UINT32(report.commandsSent - report.commandsUnanswered, report.commandsAnswered);
+    TEST_ASSERT_EQUAL_UINT32(report.commandsSent, report.traffic.commands);
+
+    // Recebe no passo seguinte, publica no outro (tarefas de rede e controle)
+    TEST_ASSERT_LESS_OR_EQUAL(20000, report.latencyMaxUs);
+    TEST_ASSERT_LESS_OR_EQUAL(report.latencyP99Us, report.latencyP50Us);
+
+    size_t changed = 0;
+    for (size_t i = 0; i < fleet.size(); i++) {
+        changed += fleet.deviceTargetTemp(i) != initialTemp;
+    }
+    TEST_ASSERT_EQUAL(fleet.size(), changed);
+}
+
+void test_cbor_fleet_answers_with_fewer_bytes() {
+    // Mesma carga nas duas codificações: as mesmas respostas, menos bytes
+    uint64_t bytes[WIRE_FORMAT_COUNT];
+    for (size_t f = 0; f < WIRE_FORMAT_COUNT; f++) {
+        FleetConfig config = smallFleet(8, 4.0f);
+        config.wireFormat = WireFormat(f);
+        FleetSim fleet(config);
+        TEST_ASSERT_TRUE(fleet.begin());
+        fleet.runFor(60000);
+        FleetReport report = fleet.report();
+        TEST_ASSERT_LESS_OR_EQUAL(1, report.commandsUnanswered);
+        TEST_ASSERT_EQUAL_UINT32(report.commandsSent - report.commandsUnanswered, report.commandsAnswered);
+        TEST_ASSERT_EQUAL_UINT32(0, report.traffic.errors);
+        bytes[f] = report.traffic.bytes;
+    }
+    TEST_ASSERT_LESS_THAN(bytes[size_t(WireFormat::JSON)], bytes[size_t(WireFormat::CBOR)]);
+}
+
+void test_traffic_follows_firmware_cadence() {
+    FleetSim fleet(smallFleet(10, 0.0f));
+    TEST_ASSERT_TRUE(fleet.begin());
+    fleet.runFor(600000);
+    FleetReport report = fleet.report();
+
+    // Dez minutos sem comandos: diagnóstico a cada minuto, um lote de
+    // telemetria por amostra e ao menos o heartbeat do status
+    TEST_ASSERT_EQUAL_UINT32(0, report.commandsSent);
+    TEST_ASSERT_UINT32_WITHIN(10, 10 * 600000 / DIAGNOSTICS_INTERVAL, report.traffic.diagnostics);
+    TEST_ASSERT_UINT32_WITHIN(10, 10 * 600000 / TELEMETRY_SAMPLE_INTERVAL, report.traffic.telemetry);
+    TEST_ASSERT_GREATER_OR_EQUAL(10 * 600000 / STATUS_HEARTBEAT_INTERVAL, report.traffic.status);
+    TEST_ASSERT_EQUAL_UINT32(0, report.traffic.errors);
+
+    // O broker recebeu exatamente o que o servidor viu, e sem inscrições
+    // além das dos dispositivos nada foi entregue
+    TEST_ASSERT_TRUE(report.brokerCountsAvailable);
+    TEST_ASSERT_EQUAL_UINT32(report.traffic.fromDevices(), report.brokerReceived);
+    TEST_ASSERT_EQUAL_UINT32(0, report.brokerSent);
+    TEST_ASSERT_TRUE(report.publishRate() > 0);
+}
+
+void test_rejects_fleet_larger_than_broker() {
+    FleetSim fleet(smallFleet(FAKE_BROKER_MAX_CLIENTS + 1, 1.0f));
+    TEST_ASSERT_FALSE(fleet.begin());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_remaining_length_round_trip);
+    RUN_TEST(test_packets_match_mqtt_311);
+    RUN_TEST(test_each_device_answers_its_own_commands);
+    RUN_TEST(test_cbor_fleet_answers_with_fewer_bytes);
+    RUN_TEST(test_traffic_follows_firmware_cadence);
+    RUN_TEST(test_rejects_fleet_larger_than_broker);
+    return UNITY_END();
+}
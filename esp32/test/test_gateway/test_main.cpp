@@ -0,0 +1,298 @@
+#include <unity.h>
+#include <map>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+#include "config.h"
+#include "FleetGateway.h"
+#include "GatewayLoad.h"
+#include "StatusCodec.h"
+
+static const uint64_t SECOND_US = 1000000;
+static const uint32_t EPOCH = 1700000000;
+
+// Resumos publicados, pelo tópico
+struct Published {
+    std::map<std::string, std::string> last;
+    uint32_t count = 0;
+    bool fail = false;
+
+    bool has(const char* topic) const { return last.count(topic) != 0; }
+    const char* text(const char* topic) const {
+        auto found = last.find(topic);
+        return found != last.end() ? found->second.c_str() : "";
+    }
+    void clear() {
+        last.clear();
+        count = 0;
+    }
+};
+
+static bool capture(const char* topic, const uint8_t* payload, size_t length, bool retained, void* context) {
+    Published* published = static_cast<Published*>(context);
+    if (published->fail) return false;
+    TEST_ASSERT_TRUE(retained);
+    published->last[topic] = std::string(reinterpret_cast<const char*>(payload), length);
+    published->count++;
+    return true;
+}
+
+static void sendStatus(FleetGateway& gateway, const char* topic, const ACStatus& status, uint64_t atUs,
+                       WireFormat format = WireFormat::JSON) {
+    uint8_t payload[STATUS_JSON_CAPACITY];
+    size_t length = serializeStatus(status, format, payload, sizeof(payload));
+    gateway.ingest(topic, payload, length, atUs);
+}
+
+static void sendDelta(FleetGateway& gateway, const char* topic, const ACStatus& status, uint8_t fields,
+                      uint64_t atUs) {
+    uint8_t payload[STATUS_JSON_CAPACITY];
+    size_t length = serializeStatusDelta(status, fields, WireFormat::JSON, payload, sizeof(payload));
+    gateway.ingest(topic, payload, length, atUs);
+}
+
+static ACStatus roomStatus(bool on, float temperature) {
+    ACStatus status{on, temperature, 50.0f, 23, ACMode::COOL, FanSpeed::AUTO};
+    status.temperatureHealth = SensorHealth::OK;
+    status.humidityHealth = SensorHealth::OK;
+    return status;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_rollups_by_room_block_and_system() {
+    FleetGateway gateway;
+    TEST_ASSERT_TRUE(gateway.assign("ESP_A", "B1", "101"));
+    TEST_ASSERT_TRUE(gateway.assign("ESP_B", "B1", "101"));
+    TEST_ASSERT_TRUE(gateway.assign("ESP_C", "B1", "102"));
+    TEST_ASSERT_TRUE(gateway.assign("ESP_D", "B2", "201"));
+
+    sendStatus(gateway, "ac-control/dispositivos/ESP_A/status", roomStatus(true, 24.0f), 0);
+    sendStatus(gateway, "ac-control/dispositivos/ESP_B/status", roomStatus(false, 25.0f), 0, WireFormat::CBOR);
+    sendStatus(gateway, "ac-control/dispositivos/ESP_C/status", roomStatus(true, 22.5f), 0);
+    // Sem sala: conta só no sistema
+    sendStatus(gateway, "ac-control/dispositivos/ESP_X/status", roomStatus(true, 26.0f), 0);
+
+    Published published;
+    TEST_ASSERT_EQUAL(6, gateway.publishDue(0, EPOCH, capture, &published));
+    TEST_ASSERT_EQUAL_STRING("{\"dispositivosOnline\":2,\"dispositivosTotal\":2,\"aparelhosLigados\":1,"
+                             "\"aparelhosTotal\":2,\"temperaturaMedia\":24.5,\"ultimaAtualizacao\":1700000000}",
+                             published.text("ac-control/sistema/salas/B1/101"));
+    TEST_ASSERT_EQUAL_STRING("{\"dispositivosOnline\":3,\"dispositivosTotal\":3,\"aparelhosLigados\":2,"
+                             "\"aparelhosTotal\":3,\"temperaturaMedia\":23.8,\"ultimaAtualizacao\":1700000000}",
+                             published.text("ac-control/sistema/blocos/B1"));
+    // ESP_D ainda não publicou: total sem online nem média
+    TEST_ASSERT_EQUAL_STRING("{\"dispositivosOnline\":0,\"dispositivosTotal\":1,\"aparelhosLigados\":0,"
+                             "\"aparelhosTotal\":0,\"temperaturaMedia\":null,\"ultimaAtualizacao\":1700000000}",
+                             published.text("ac-control/sistema/salas/B2/201"));
+    TEST_ASSERT_EQUAL_STRING("{\"dispositivosOnline\":4,\"dispositivosTotal\":5,\"aparelhosLigados\":3,"
+                             "\"aparelhosTotal\":4,\"temperaturaMedia\":24.4,\"ultimaAtualizacao\":1700000000,"
+                             "\"systemStatus\":\"DEGRADADO\"}",
+                             published.text("ac-control/sistema/status"));
+    TEST_ASSERT_EQUAL(5, gateway.devices());
+    TEST_ASSERT_EQUAL(4, gateway.online());
+}
+
+void test_changes_are_coalesced_per_interval() {
+    GatewayConfig config;
+    config.publishIntervalMs = 1000;
+    FleetGateway gateway(config);
+    gateway.assign("ESP_A", "B1", "101");
+    gateway.assign("ESP_B", "B1", "102");
+    const char* topicA = "ac-control/dispositivos/ESP_A/status";
+    const char* deltaA = "ac-control/dispositivos/ESP_A/status/delta";
+    ACStatus a = roomStatus(false, 24.0f);
+    sendStatus(gateway, topicA, a, 0);
+    sendStatus(gateway, "ac-control/dispositivos/ESP_B/status", roomStatus(false, 24.0f), 0);
+    Published published;
+    gateway.publishDue(0, EPOCH, capture, &published);
+
+    // Antes do intervalo nada sai
+    a.currentTemp = 25.0f;
+    sendDelta(gateway, deltaA, a, STATUS_FIELD_CURRENT_TEMP, 100000);
+    published.clear();
+    TEST_ASSERT_EQUAL(0, gateway.publishDue(SECOND_US / 2, EPOCH, capture, &published));
+
+    // Três mudanças na mesma sala: uma publicação dela, do bloco e do sistema
+    a.isOn = true;
+    sendDelta(gateway, deltaA, a, STATUS_FIELD_POWER, 600000);
+    a.currentTemp = 25.5f;
+    sendDelta(gateway, deltaA, a, STATUS_FIELD_CURRENT_TEMP, 700000);
+    TEST_ASSERT_EQUAL(3, gateway.publishDue(SECOND_US, EPOCH + 1, capture, &published));
+    TEST_ASSERT_TRUE(published.has("ac-control/sistema/salas/B1/101"));
+    TEST_ASSERT_FALSE(published.has("ac-control/sistema/salas/B1/102"));
+    TEST_ASSERT_NOT_NULL(strstr(published.text("ac-control/sistema/salas/B1/101"),
+                                "\"aparelhosLigados\":1,\"aparelhosTotal\":1,\"temperaturaMedia\":25.5"));
+
+    // Repetir o mesmo estado (o heartbeat do status) não muda resumo algum
+    published.clear();
+    sendStatus(gateway, topicA, a, 1500000);
+    TEST_ASSERT_EQUAL(1, gateway.publishDue(2 * SECOND_US, EPOCH + 2, capture, &published));
+    TEST_ASSERT_TRUE(published.has("ac-control/sistema/status"));
+
+    GatewayStats stats = gateway.stats();
+    TEST_ASSERT_EQUAL_UINT32(6, stats.messages);
+    TEST_ASSERT_EQUAL_UINT32(5, stats.changes);
+    // Da mudança ao resumo: 0, 0, 900, 400 e 300 ms
+    TEST_ASSERT_EQUAL_UINT32(5, stats.lagSamples);
+    TEST_ASSERT_EQUAL_UINT32(900000, stats.lagMaxUs);
+    TEST_ASSERT_GREATER_OR_EQUAL(300000, stats.lagP50Us);
+    TEST_ASSERT_LESS_OR_EQUAL(375000, stats.lagP50Us);
+}
+
+void test_silent_devices_go_offline() {
+    GatewayConfig config;
+    config.offlineMs = 300000;
+    FleetGateway gateway(config);
+    gateway.assign("ESP_A", "B1", "101");
+    gateway.assign("ESP_B", "B1", "101");
+    sendStatus(gateway, "ac-control/dispositivos/ESP_A/status", roomStatus(true, 24.0f), 0);
+    sendStatus(gateway, "ac-control/dispositivos/ESP_B/status", roomStatus(true, 26.0f), 0);
+    Published published;
+    gateway.publishDue(0, EPOCH, capture, &published);
+    TEST_ASSERT_NOT_NULL(strstr(published.text("ac-control/sistema/status"), "\"systemStatus\":\"OK\""));
+
+    // O heartbeat de A chega; B fica mudo
+    for (uint64_t t = 120; t <= 300; t += 120) {
+        sendStatus(gateway, "ac-control/dispositivos/ESP_A/status", roomStatus(true, 24.0f), t * SECOND_US);
+    }
+    gateway.publishDue(300 * SECOND_US - 1, EPOCH, capture, &published);
+    TEST_ASSERT_EQUAL(2, gateway.online());
+    gateway.publishDue(301 * SECOND_US, EPOCH, capture, &published);
+    TEST_ASSERT_EQUAL(1, gateway.online());
+    TEST_ASSERT_EQUAL_STRING("{\"dispositivosOnline\":1,\"dispositivosTotal\":2,\"aparelhosLigados\":1,"
+                             "\"aparelhosTotal\":1,\"temperaturaMedia\":24,\"ultimaAtualizacao\":1700000000}",
+                             published.text("ac-control/sistema/salas/B1/101"));
+    TEST_ASSERT_NOT_NULL(strstr(published.text("ac-control/sistema/status"), "\"systemStatus\":\"DEGRADADO\""));
+
+    // Qualquer mensagem traz de volta, com o último estado
+    ACStatus b = roomStatus(true, 26.0f);
+    sendDelta(gateway, "ac-control/dispositivos/ESP_B/status/delta", b, STATUS_FIELD_HUMIDITY, 400 * SECOND_US);
+    TEST_ASSERT_EQUAL(2, gateway.online());
+    gateway.publishDue(400 * SECOND_US, EPOCH, capture, &published);
+    TEST_ASSERT_NOT_NULL(strstr(published.text("ac-control/sistema/salas/B1/101"),
+                                "\"aparelhosLigados\":2,\"aparelhosTotal\":2,\"temperaturaMedia\":25"));
+}
+
+void test_units_and_sensor_failures() {
+    FleetGateway gateway;
+    gateway.assign("ESP_M", "B1", "101");
+    ACStatus status = roomStatus(true, 24.0f);
+    sendStatus(gateway, "ac-control/dispositivos/ESP_M/status", status, 0);
+    status.isOn = false;
+    sendStatus(gateway, "ac-control/dispositivos/ESP_M/status/1", status, 0);
+    status.isOn = true;
+    sendStatus(gateway, "ac-control/dispositivos/ESP_M/status/2", status, 0);
+    Published published;
+    gateway.publishDue(0, EPOCH, capture, &published);
+    TEST_ASSERT_NOT_NULL(strstr(published.text("ac-control/sistema/salas/B1/101"),
+                                "\"dispositivosOnline\":1,\"dispositivosTotal\":1,\"aparelhosLigados\":2,"
+                                "\"aparelhosTotal\":3,\"temperaturaMedia\":24"));
+
+    // Leitura nula: o dispositivo sai da média, os aparelhos continuam
+    status.currentTemp = NAN;
+    sendDelta(gateway, "ac-control/dispositivos/ESP_M/status/2/delta", status, STATUS_FIELD_CURRENT_TEMP, 1);
+    gateway.publishDue(SECOND_US, EPOCH, capture, &published);
+    TEST_ASSERT_NOT_NULL(strstr(published.text("ac-control/sistema/salas/B1/101"),
+                                "\"aparelhosTotal\":3,\"temperaturaMedia\":null"));
+}
+
+void test_invalid_messages_change_nothing() {
+    FleetGateway gateway;
+    const char* bad = "{\"ligado\":1}";
+    gateway.ingest("ac-control/dispositivos/ESP_Z/status", reinterpret_cast<const uint8_t*>(bad), strlen(bad), 0);
+    TEST_ASSERT_EQUAL(0, gateway.devices());
+
+    const char* good = "{\"ligado\":true}";
+    const char* const ignored[] = {
+        "ac-control/dispositivos/ESP_Z/telemetria",
+        "ac-control/dispositivos/ESP_Z/status/7",
+        "ac-control/dispositivos/ESP_Z/status/1/outro",
+        "ac-control/dispositivos//status",
+        "ac-control/sistema/status",
+    };
+    for (const char* topic : ignored) {
+        gateway.ingest(topic, reinterpret_cast<const uint8_t*>(good), strlen(good), 0);
+    }
+    TEST_ASSERT_EQUAL(0, gateway.devices());
+    GatewayStats stats = gateway.stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(5, stats.ignored);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.messages);
+
+    TEST_ASSERT_FALSE(gateway.assign("ESP_Z", "B/1", "101"));
+    TEST_ASSERT_FALSE(gateway.assign("ESP_Z", "B1", "#"));
+    TEST_ASSERT_FALSE(gateway.assign("", "B1", "101"));
+    TEST_ASSERT_EQUAL(0, gateway.devices());
+
+    // Falha ao publicar: o resumo continua pendente
+    gateway.assign("ESP_Z", "B1", "101");
+    Published published;
+    published.fail = true;
+    gateway.publishDue(0, EPOCH, capture, &published);
+    TEST_ASSERT_EQUAL_UINT32(3, gateway.stats().publishFailures);
+    published.fail = false;
+    TEST_ASSERT_EQUAL(3, gateway.publishDue(SECOND_US, EPOCH, capture, &published));
+}
+
+void test_assignments_file() {
+    char path[] = "/tmp/gateway_mapaXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    FILE* file = fdopen(fd, "w");
+    fputs("# idEsp32;bloco;sala\n"
+          "ESP_A;Bloco A;Sala 101\n"
+          " ESP_B ; Bloco A ; Sala 102 \r\n"
+          "\n"
+          "ESP_C;Bloco/B;Sala 1\n"
+          "ESP_D;sem sala\n", file);
+    fclose(file);
+
+    FleetGateway gateway;
+    TEST_ASSERT_EQUAL(2, gateway.loadAssignments(path));
+    TEST_ASSERT_EQUAL(2, gateway.devices());
+    Published published;
+    gateway.publishDue(0, EPOCH, capture, &published);
+    TEST_ASSERT_TRUE(published.has("ac-control/sistema/salas/Bloco A/Sala 102"));
+    TEST_ASSERT_NOT_NULL(strstr(published.text("ac-control/sistema/blocos/Bloco A"), "\"dispositivosTotal\":2"));
+    remove(path);
+    TEST_ASSERT_EQUAL(-1, gateway.loadAssignments(path));
+}
+
+void test_load_aggregates_every_message() {
+    GatewayLoadConfig config;
+    config.devices = 400;
+    config.statusPerSecond = 1.0f;
+    config.durationMs = 1000;
+    config.publishIntervalMs = 200;
+    GatewayLoad load(config);
+    TEST_ASSERT_TRUE(load.begin());
+    load.runBurst();
+    load.runSteady();
+
+    GatewayLoadReport report = load.report();
+    TEST_ASSERT_EQUAL_UINT32(400, report.burstMessages);
+    TEST_ASSERT_TRUE(report.sent >= 300);
+    TEST_ASSERT_EQUAL_UINT32(report.sent, report.gateway.messages);
+    TEST_ASSERT_EQUAL_UINT32(0, report.gateway.rejected);
+    // Todo delta muda a temperatura da sala: uma amostra de defasagem cada,
+    // nunca mais que um intervalo (com folga para o agendador do host)
+    TEST_ASSERT_EQUAL_UINT32(report.gateway.changes, report.gateway.lagSamples);
+    TEST_ASSERT_EQUAL_UINT32(report.sent, report.gateway.changes);
+    TEST_ASSERT_LESS_OR_EQUAL(config.publishIntervalMs * 1000 * 2, report.gateway.lagP99Us);
+    TEST_ASSERT_TRUE(report.summaries > 0);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_rollups_by_room_block_and_system);
+    RUN_TEST(test_changes_are_coalesced_per_interval);
+    RUN_TEST(test_silent_devices_go_offline);
+    RUN_TEST(test_units_and_sensor_failures);
+    RUN_TEST(test_invalid_messages_change_nothing);
+    RUN_TEST(test_assignments_file);
+    RUN_TEST(test_load_aggregates_every_message);
+    return UNITY_END();
+}
@@ -0,0 +1,369 @@
+#include <unity.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <new>
+#include <FakeBroker.h>
+#include <HostAlloc.h>
+#include <HostDht22.h>
+#include <HostIRLog.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <driver/rmt.h>
+#include <esp_ota_ops.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "HeapGuard.h"
+#include "IREncoder.h"
+#include "MemoryBudget.h"
+#include "Metrics.h"
+#include "MqttTopics.h"
+
+// Os tópicos saem prontos do compilador e batem com os de config.h
+static constexpr bool sameText(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static constexpr MqttTopics DEVICE_TOPICS(DEVICE_ID);
+static_assert(sameText(DEVICE_TOPICS.status, MQTT_STATUS_TOPIC), "tópico de status");
+static_assert(sameText(DEVICE_TOPICS.command, MQTT_COMMAND_TOPIC), "tópico de comando");
+static_assert(sameText(DEVICE_TOPICS.delta, MQTT_STATUS_DELTA_TOPIC), "tópico de delta");
+static_assert(sameText(DEVICE_TOPICS.telemetry, MQTT_TELEMETRY_TOPIC), "tópico de telemetria");
+static_assert(sameText(DEVICE_TOPICS.irLearn, MQTT_IR_LEARN_TOPIC), "tópico de aprendizado IR");
+
+// Domingo, 18/10/2026 00:00 em Brasília (03:00 UTC)
+static const uint64_t SUNDAY_EPOCH = 1792292400ULL;
+static const uint32_t ITERATIONS = 1000000;
+static const uint32_t LOOP_STEP_MS = 1;
+static const uint8_t IR_PINS[] = {PIN_IR_LED, 16};
+static const size_t UNITS = sizeof(IR_PINS);
+
+// Tráfego do servidor: comandos válidos, rastreados, para a unidade 1, em
+// CBOR e inválidos, em rodízio. rejected marca os que vão para .../erro
+// (PISCAR só republica o status)
+struct Injection {
+    const char* topic;
+    const char* payload;
+    bool rejected;
+};
+
+static const Injection COMMANDS[] = {
+    {MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}", false},
+    {MQTT_COMMAND_TOPIC, "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22},\"id\":\"cmd-42\"}", false},
+    {MQTT_COMMAND_TOPIC "/1", "{\"comando\":\"LIGAR\"}", false},
+    {MQTT_COMMAND_TOPIC "/1", "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"VENTILAR\"}}", false},
+    {MQTT_COMMAND_TOPIC, "{\"comando\":\"VELOCIDADE\",\"parametros\":{\"velocidade\":\"ALTA\"}}", false},
+    {MQTT_COMMAND_TOPIC, "{\"comando\":\"FORMATO\",\"parametros\":{\"formato\":\"CBOR\"}}", false},
+    {MQTT_COMMAND_TOPIC, "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":25}}", false},
+    {MQTT_COMMAND_TOPIC, "{\"comando\":\"FORMATO\",\"parametros\":{\"formato\":\"JSON\"}}", false},
+    {MQTT_COMMAND_TOPIC, "{\"comando\":\"PISCAR\"}", false},
+    {MQTT_COMMAND_TOPIC, "{\"comando\":", true},
+    {MQTT_COMMAND_TOPIC "/7", "{\"comando\":\"LIGAR\"}", true},
+    {MQTT_COMMAND_TOPIC "/1", "{\"comando\":\"DESLIGAR\",\"id\":\"cmd-43\"}", false},
+    {MQTT_COMMAND_TOPIC, "{\"comando\":\"DESLIGAR\"}", false},
+};
+static const size_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+static const char* const SCHEDULE =
+    "{\"comando\":\"AGENDA\",\"parametros\":{\"versao\":3,\"fuso\":-180,\"transicoes\":["
+    "[\"0123456\",\"00:05\",true,24,\"REFRIGERAR\"],"
+    "[\"0123456\",\"00:12\",false]"
+    "]}}";
+
+static const char* const LEARN_COOL_23 =
+    "{\"comando\":\"APRENDER_IR\",\"parametros\":{\"ligado\":true,\"modo\":\"REFRIGERAR\","
+    "\"temperatura\":23,\"velocidade\":\"MEDIA\"}}";
+
+// O firmware de main.cpp com dois aparelhos, num laço só: cada iteração é
+// um passo de cada tarefa
+struct Firmware {
+    CommandQueue commandQueue;
+    SensorQueue sensorQueue;
+    StatusQueue statusQueue;
+    ACUnits<UNITS> units;
+    MultiUnitNetworkManager<UNITS> network;
+    ControlLoop control;
+    SensorSampler sensors;
+    TelemetryLog telemetryLog;
+    TelemetryStore telemetry;
+    Scheduler schedule;
+    OtaUpdater ota;
+    IRLearner irLearner;
+    ACStateStore stateStore;
+
+    Firmware()
+        : units(IR_PINS, PIN_DHT),
+          network(DEVICE_ID, units),
+          control(units, commandQueue, sensorQueue, statusQueue),
+          sensors(PIN_DHT, sensorQueue),
+          irLearner(PIN_IR_RECEIVER, irLibrary, RMT_CHANNEL_5, 3) {
+    }
+
+    void setup() {
+        irLibrary.begin();
+        units.begin();
+        sensors.begin();
+        stateStore.begin();
+        bool logReady = LittleFS.begin(true) && telemetryLog.begin(TELEMETRY_LOG_PATH, TELEMETRY_LOG_RECORDS);
+        TEST_ASSERT_TRUE(logReady);
+        telemetry.begin(&telemetryLog);
+        schedule.begin();
+        ota.begin();
+        irLearner.begin();
+
+        network.attachQueues(commandQueue, statusQueue);
+        network.attachTelemetry(telemetry);
+        network.attachScheduler(schedule);
+        network.attachOta(ota);
+        network.attachIRLearner(irLearner);
+        network.attachStateStore(stateStore);
+        network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    }
+
+    void step() {
+        network.update();
+        control.step();
+        sensors.step();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+};
+
+// O log do FakeBroker só guarda as últimas mensagens
+static struct {
+    uint32_t telemetry;
+    uint32_t acks;
+    uint32_t diagnostics;
+    uint32_t cborStatus;
+} g_published;
+
+static void countPublished(const FakeMessage& message, void*) {
+    // Status em CBOR começa por um mapa (0xa0..0xbf), em JSON por '{'
+    bool status = strncmp(message.topic, MQTT_STATUS_TOPIC, strlen(MQTT_STATUS_TOPIC)) == 0;
+    if (status && message.length && (message.payload[0] & 0xe0) == 0xa0) g_published.cborStatus++;
+    if (strcmp(message.topic, MQTT_TELEMETRY_TOPIC) == 0) g_published.telemetry++;
+    if (strcmp(message.topic, DEVICE_TOPICS.ack) == 0) g_published.acks++;
+    if (strcmp(message.topic, MQTT_DIAGNOSTICS_TOPIC) == 0) g_published.diagnostics++;
+}
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    HostDht22::reset();
+    HostNvs::reset();
+    HostFlash::reset();
+    HostNtp::reset();
+    HostOta::reset();
+    hostRmtReset();
+    Metrics::reset();
+    FakeBroker::instance().reset();
+    FakeBroker::instance().setObserver(countPublished, nullptr);
+    memset(&g_published, 0, sizeof(g_published));
+    WiFi.hostReset();
+}
+
+void tearDown() {
+    HeapGuard::disarm();
+}
+
+// Alocação proibida: o processo morre com SIGABRT, como o ESP32 no abort()
+static int runChild(void (*body)()) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        body();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return status;
+}
+
+static void allocateAfterArm() {
+    HeapGuard::enroll(xTaskGetCurrentTaskHandle());
+    HeapGuard::arm();
+    void* leaked = ::operator new(16);
+    ::operator delete(leaked);
+}
+
+// malloc direto (snprintf de biblioteca C, strdup): no host só a glibc
+// deixa o HostAlloc substituir o malloc; fora dela este caso não é visto
+static void mallocAfterArm() {
+    HeapGuard::enroll(xTaskGetCurrentTaskHandle());
+    HeapGuard::arm();
+    // volatile: o compilador pode apagar um par malloc/free sem uso
+    void* volatile leaked = malloc(16);
+    free(leaked);
+}
+
+static void allocateAsVendor() {
+    HeapGuard::enroll(xTaskGetCurrentTaskHandle());
+    HeapGuard::arm();
+    HeapGuard::Vendor vendor;
+    void* buffer = ::operator new(64);
+    ::operator delete(buffer);
+    String text("fora do guarda");
+    text += " e ainda fora";
+}
+
+// Tarefa que não é do firmware (WiFi, lwIP no ESP32): aloca à vontade
+static void foreignTask(void*) {
+    while (!HeapGuard::armed()) vTaskDelay(1);
+    void* buffer = ::operator new(32);
+    ::operator delete(buffer);
+}
+
+static void allocateInForeignTask() {
+    TaskHandle_t task = nullptr;
+    xTaskCreatePinnedToCore(foreignTask, "alheia", 4096, nullptr, 1, &task, APP_CPU_NUM);
+    HeapGuard::enroll(xTaskGetCurrentTaskHandle());
+    HeapGuard::arm();
+    hostTaskJoin(task);
+}
+
+void test_guard_faults_on_allocation_after_setup() {
+    int status = runChild(allocateAfterArm);
+    TEST_ASSERT_TRUE(WIFSIGNALED(status));
+    TEST_ASSERT_EQUAL(SIGABRT, WTERMSIG(status));
+
+#ifdef __GLIBC__
+    status = runChild(mallocAfterArm);
+    TEST_ASSERT_TRUE(WIFSIGNALED(status));
+    TEST_ASSERT_EQUAL(SIGABRT, WTERMSIG(status));
+#endif
+}
+
+void test_guard_allows_vendor_scopes_and_foreign_tasks() {
+    int status = runChild(allocateAsVendor);
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL(0, WEXITSTATUS(status));
+
+    status = runChild(allocateInForeignTask);
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL(0, WEXITSTATUS(status));
+}
+
+void test_unit_topics_fit_the_fixed_buffers() {
+    MqttTopics topics("ID_DE_32_CARACTERES_EXATAMENTE__");
+    TEST_ASSERT_TRUE(MqttTopics::fits("ID_DE_32_CARACTERES_EXATAMENTE__"));
+    TEST_ASSERT_EQUAL_STRING("ac-control/dispositivos/ID_DE_32_CARACTERES_EXATAMENTE__/ir/aprendizado",
+                             topics.irLearn);
+    TEST_ASSERT_EQUAL(MqttTopics::SIZE - 1, strlen(topics.irLearn));
+    // .../status/n/delta, o maior tópico por unidade, cabe no mesmo tamanho
+    TEST_ASSERT_EQUAL(strlen(topics.delta) + 2, strlen(topics.irLearn));
+
+    // Id grande demais: cortado, nunca além do buffer
+    TEST_ASSERT_FALSE(MqttTopics::fits("ID_DE_33_CARACTERES_EXATAMENTE___"));
+    MqttTopics longer("ID_DE_33_CARACTERES_EXATAMENTE___");
+    TEST_ASSERT_EQUAL(MqttTopics::SIZE - 1, strlen(longer.irLearn));
+}
+
+void test_static_ram_budget() {
+    printf("\nRAM estática (bytes / orçamento):\n");
+    for (const MemoryBudget::Subsystem& subsystem : MemoryBudget::SUBSYSTEMS) {
+        printf("  %-13s %6zu / %6zu\n", subsystem.name, subsystem.bytes, subsystem.budget);
+        TEST_ASSERT_GREATER_THAN(0, subsystem.bytes);
+        TEST_ASSERT_LESS_OR_EQUAL(subsystem.budget, subsystem.bytes);
+    }
+    printf("  %-13s %6zu / %6zu\n", "total", MemoryBudget::total(), MemoryBudget::totalBudget());
+    TEST_ASSERT_LESS_OR_EQUAL(MemoryBudget::totalBudget(), MemoryBudget::total());
+}
+
+// Um milhão de passos (~17 min virtuais) com comandos, leituras do DHT22,
+// quedas de WiFi e do broker, uma agenda e uma tecla aprendida: nenhuma
+// alocação depois do setup(), e o guarda armado o tempo todo
+void test_million_iterations_without_heap() {
+    static Firmware firmware;
+    HostNtp::setEpoch(SUNDAY_EPOCH);
+    HostDht22::setReading(PIN_DHT, 27.0f, 60.0f);
+    firmware.setup();
+
+    uint16_t durations[IR_MAX_PULSES];
+    uint16_t keyLength = irEncoderFor(IRProtocol::COOLIX)->encode(ACSettings{true, 23, ACMode::COOL, FanSpeed::MEDIUM},
+                                                                  durations, IR_MAX_PULSES);
+
+    HostAlloc::reset();
+    HeapGuard::enroll(xTaskGetCurrentTaskHandle());
+    HeapGuard::arm();
+
+    uint32_t injected = 0;
+    uint32_t delivered = 0;
+    uint32_t rejected = 0;
+    uint32_t drops = 0;
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        // Durante as quedas o broker não entrega: esses comandos se perdem
+        if (i % 997 == 500) {
+            const Injection& command = COMMANDS[injected++ % COMMAND_COUNT];
+            uint32_t before = FakeBroker::instance().deliveryCount();
+            FakeBroker::instance().inject(command.topic, command.payload);
+            if (FakeBroker::instance().deliveryCount() > before) {
+                delivered++;
+                if (command.rejected) rejected++;
+            }
+        }
+        if (i % 5003 == 0) {
+            HostDht22::setReading(PIN_DHT, 22.0f + float(i % 7) * 0.8f, 45.0f + float(i % 11));
+        }
+        if (i == 20000) {
+            FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, SCHEDULE);
+        }
+        if (i == 40000) {
+            FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, LEARN_COOL_23);
+        }
+        if (i == 41000) {
+            TEST_ASSERT_TRUE(hostRmtPress(PIN_IR_RECEIVER, durations, keyLength));
+        }
+        // Quedas alternadas: o WiFi inteiro ou só o broker por 30 s
+        if (i % 150000 == 100000) {
+            if (drops++ % 2 == 0) {
+                WiFi.hostDropConnection();
+            } else {
+                FakeBroker::instance().setReachable(false);
+            }
+        }
+        if (i % 150000 == 130000) {
+            FakeBroker::instance().setReachable(true);
+        }
+        firmware.step();
+    }
+
+    HostAllocStats stats = HostAlloc::stats();
+    TEST_ASSERT_TRUE(HeapGuard::armed());
+    TEST_ASSERT_EQUAL_UINT64(0, stats.calls);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.bytes);
+
+    // O laço passou por tudo que devia
+    TEST_ASSERT_TRUE(firmware.network.isConnected());
+    TEST_ASSERT_GREATER_THAN(injected * 3 / 4, delivered);
+    TEST_ASSERT_EQUAL(delivered + 2, Metrics::counter(Metrics::Counter::COMMANDS));
+    // Só os inválidos de propósito voltam com erro; os outros mudaram o estado
+    TEST_ASSERT_GREATER_THAN(0, rejected);
+    TEST_ASSERT_EQUAL(rejected, Metrics::counter(Metrics::Counter::COMMANDS_REJECTED));
+    TEST_ASSERT_GREATER_THAN(0, g_published.cborStatus);
+    TEST_ASSERT_GREATER_THAN(drops, Metrics::counter(Metrics::Counter::MQTT_CONNECTS));
+    TEST_ASSERT_GREATER_THAN(0, HostIRLog::count());
+    TEST_ASSERT_EQUAL(1, irLibrary.codes());
+    TEST_ASSERT_EQUAL(3, firmware.schedule.table().version);
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().retained(MQTT_STATUS_TOPIC "/1"));
+    TEST_ASSERT_GREATER_THAN(0, g_published.telemetry);
+    TEST_ASSERT_GREATER_THAN(0, g_published.acks);
+    TEST_ASSERT_GREATER_THAN(0, g_published.diagnostics);
+    TEST_ASSERT_GREATER_THAN(0, HostNvs::writeCalls());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_guard_faults_on_allocation_after_setup);
+    RUN_TEST(test_guard_allows_vendor_scopes_and_foreign_tasks);
+    RUN_TEST(test_unit_topics_fit_the_fixed_buffers);
+    RUN_TEST(test_static_ram_budget);
+    RUN_TEST(test_million_iterations_without_heap);
+    return UNITY_END();
+}
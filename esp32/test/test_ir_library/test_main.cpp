@@ -0,0 +1,442 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <FakeBroker.h>
+#include <HostIRLog.h>
+#include <driver/rmt.h>
+#include <esp_ota_ops.h>
+#include "config.h"
+#include "ACController.h"
+#include "CommandCodec.h"
+#include "IRCode.h"
+#include "IREncoder.h"
+#include "IRLearner.h"
+#include "IRLibrary.h"
+#include "NetworkManager.h"
+
+static const uint32_t LOOP_STEP_MS = 10;
+static const IRProtocol CAPTURED[] = {IRProtocol::COOLIX, IRProtocol::GREE, IRProtocol::MIDEA, IRProtocol::LG};
+static const ACSettings COOL_23{true, 23, ACMode::COOL, FanSpeed::MEDIUM};
+
+// Quadro de um controle "capturado" por um TSOP: marcas esticadas, espaços
+// encurtados e ruído de ±40 µs, como no IRrecvDumpV2
+static uint16_t capture(IRProtocol protocol, const ACSettings& settings, uint16_t* durations, uint32_t seed) {
+    uint16_t length = irEncoderFor(protocol)->encode(settings, durations, IR_MAX_PULSES);
+    uint32_t x = seed;
+    for (uint16_t i = 0; i < length; i++) {
+        x = x * 1664525u + 1013904223u;
+        int32_t noise = int32_t(x >> 24) % 81 - 40;
+        int32_t skew = i % 2 == 0 ? 60 : -60;
+        durations[i] = uint16_t(int32_t(durations[i]) + skew + noise);
+    }
+    return length;
+}
+
+// Cada duração dentro de 15 % do quadro limpo do codificador
+static void assertMatchesClean(IRProtocol protocol, const ACSettings& settings, const uint16_t* durations, uint16_t length) {
+    uint16_t clean[IR_MAX_PULSES];
+    uint16_t expected = irEncoderFor(protocol)->encode(settings, clean, IR_MAX_PULSES);
+    TEST_ASSERT_EQUAL_MESSAGE(expected, length, irProtocolName(protocol));
+    for (uint16_t i = 0; i < length; i++) {
+        uint32_t error = durations[i] > clean[i] ? durations[i] - clean[i] : clean[i] - durations[i];
+        if (error * 100 > uint32_t(clean[i]) * 15) {
+            char message[96];
+            snprintf(message, sizeof(message), "%s: duração %u = %u, limpo %u",
+                     irProtocolName(protocol), unsigned(i), durations[i], clean[i]);
+            TEST_FAIL_MESSAGE(message);
+        }
+    }
+}
+
+static const esp_partition_t* libraryPartition() {
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "irlib");
+}
+
+// Um boot do firmware com o receptor e o protocolo APRENDIDO
+struct Device {
+    ACController ac;
+    NetworkManager network;
+    IRLearner learner;
+
+    explicit Device(uint8_t memBlocks = 3)
+        : ac(PIN_IR_LED, PIN_DHT),
+          network(DEVICE_ID, ac),
+          learner(PIN_IR_RECEIVER, irLibrary, RMT_CHANNEL_5, memBlocks) {
+        irLibrary.begin();
+        ac.setProtocol(IRProtocol::LEARNED);
+        ac.begin();
+        learner.begin();
+        network.attachIRLearner(learner);
+        network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    }
+
+    void runFor(uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += LOOP_STEP_MS) {
+            network.update();
+            HostClock::advanceMillis(LOOP_STEP_MS);
+        }
+    }
+
+    void command(const char* json) {
+        FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, json);
+        runFor(100);
+    }
+};
+
+static const char* learnReport() {
+    const FakeMessage* report = FakeBroker::instance().lastMessage(MQTT_IR_LEARN_TOPIC);
+    return report ? report->text() : "";
+}
+
+static const char* LEARN_COOL_23 =
+    "{\"comando\":\"APRENDER_IR\",\"parametros\":{\"ligado\":true,\"modo\":\"REFRIGERAR\","
+    "\"temperatura\":23,\"velocidade\":\"MEDIA\"}}";
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+    HostOta::reset();
+    irLibrary.begin();
+}
+
+void tearDown() {}
+
+void test_round_trip_within_receiver_tolerance() {
+    static const ACSettings STATES[] = {
+        COOL_23,
+        {false, 22, ACMode::COOL, FanSpeed::AUTO},
+        {true, 16, ACMode::FAN, FanSpeed::FAST},
+        {true, 30, ACMode::DRY, FanSpeed::SLOW},
+    };
+    uint16_t captured[IR_MAX_PULSES];
+    uint16_t expanded[IR_MAX_PULSES];
+    uint8_t code[IRCode::MAX_BYTES];
+    for (IRProtocol protocol : CAPTURED) {
+        for (size_t s = 0; s < sizeof(STATES) / sizeof(STATES[0]); s++) {
+            uint16_t length = capture(protocol, STATES[s], captured, uint32_t(s + 1));
+            IRCode::Info info;
+            TEST_ASSERT_EQUAL(int(IRCode::Result::OK), int(IRCode::compress(captured, length, code, sizeof(code), info)));
+            TEST_ASSERT_EQUAL(length, info.durations);
+            // Os pares de um quadro de AC cabem em 3 bits: no máximo um
+            // terço dos bytes crus, mesmo no LG, curto e com o dicionário
+            TEST_ASSERT_LESS_OR_EQUAL(3, info.bits);
+            TEST_ASSERT_LESS_THAN(length * 2, info.bytes * 3);
+            uint16_t expandedLength = IRCode::expand(code, info.bytes, expanded, IR_MAX_PULSES);
+            assertMatchesClean(protocol, STATES[s], expanded, expandedLength);
+        }
+    }
+}
+
+void test_coolix_layout() {
+    uint16_t captured[IR_MAX_PULSES];
+    uint8_t code[IRCode::MAX_BYTES];
+    uint16_t length = capture(IRProtocol::COOLIX, COOL_23, captured, 7);
+    IRCode::Info info;
+    TEST_ASSERT_EQUAL(int(IRCode::Result::OK), int(IRCode::compress(captured, length, code, sizeof(code), info)));
+    // Cabeçalho, bit 0, bit 1, intervalo entre as cópias e a marca final
+    TEST_ASSERT_EQUAL(5, info.pairs);
+    TEST_ASSERT_EQUAL(66, info.bytes);
+    TEST_ASSERT_EQUAL(IRCode::FORMAT, code[0]);
+    TEST_ASSERT_EQUAL(100, code[6] | code[7] << 8);
+    // O tick é o menor grupo: o espaço do bit 0, encurtado pelo receptor
+    TEST_ASSERT_UINT32_WITHIN(20, 492, info.tickUs);
+}
+
+void test_noise_and_oversized_codes() {
+    uint16_t durations[IR_MAX_PULSES];
+    uint8_t code[IRCode::MAX_BYTES];
+    IRCode::Info info;
+    const uint16_t glitch[] = {300, 200, 310};
+    TEST_ASSERT_EQUAL(int(IRCode::Result::SHORT), int(IRCode::compress(glitch, 3, code, sizeof(code), info)));
+
+    // Durações todas diferentes não formam um dicionário
+    for (uint16_t i = 0; i < 120; i++) durations[i] = uint16_t(400 + i * i * 3);
+    TEST_ASSERT_EQUAL(int(IRCode::Result::IRREGULAR), int(IRCode::compress(durations, 120, code, sizeof(code), info)));
+
+    uint16_t length = capture(IRProtocol::MIDEA, COOL_23, durations, 3);
+    TEST_ASSERT_EQUAL(int(IRCode::Result::TOO_LONG), int(IRCode::compress(durations, length, code, 20, info)));
+    TEST_ASSERT_EQUAL(int(IRCode::Result::OK), int(IRCode::compress(durations, length, code, sizeof(code), info)));
+    // Quadro maior que o buffer de transmissão, ou código corrompido: nada
+    TEST_ASSERT_EQUAL(0, IRCode::expand(code, info.bytes, durations, 50));
+    code[1] = 0;
+    TEST_ASSERT_EQUAL(0, IRCode::expand(code, info.bytes, durations, IR_MAX_PULSES));
+}
+
+void test_keys_cover_every_state_once() {
+    static bool seen[IRLibrary::KEYS];
+    memset(seen, 0, sizeof(seen));
+    for (uint8_t temp = IRLibrary::MIN_TEMP; temp <= IRLibrary::MAX_TEMP; temp++) {
+        for (uint8_t mode = 0; mode < AC_MODE_COUNT; mode++) {
+            for (uint8_t fan = 0; fan < FAN_SPEED_COUNT; fan++) {
+                uint16_t key = IRLibrary::keyOf(ACSettings{true, temp, ACMode(mode), FanSpeed(fan)});
+                TEST_ASSERT_LESS_THAN(IRLibrary::KEYS, key);
+                TEST_ASSERT_FALSE_MESSAGE(seen[key], "chave repetida");
+                seen[key] = true;
+            }
+        }
+    }
+    // Desligado é uma tecla só, seja qual for o resto do estado
+    TEST_ASSERT_FALSE(seen[0]);
+    TEST_ASSERT_EQUAL(0, IRLibrary::keyOf(ACSettings{false, 18, ACMode::FAN, FanSpeed::FAST}));
+    TEST_ASSERT_EQUAL(IRLibrary::keyOf(ACSettings{true, 16, ACMode::COOL, FanSpeed::AUTO}),
+                      IRLibrary::keyOf(ACSettings{true, 5, ACMode::COOL, FanSpeed::AUTO}));
+}
+
+void test_store_survives_reboot() {
+    uint16_t captured[IR_MAX_PULSES];
+    uint16_t expanded[IR_MAX_PULSES];
+    uint8_t code[IRCode::MAX_BYTES];
+    IRCode::Info info;
+    TEST_ASSERT_TRUE(irLibrary.ready());
+    TEST_ASSERT_EQUAL(HOST_IR_LIBRARY_PARTITION_SIZE, irLibrary.capacity());
+
+    uint16_t key = IRLibrary::keyOf(COOL_23);
+    uint16_t length = capture(IRProtocol::GREE, COOL_23, captured, 1);
+    IRCode::compress(captured, length, code, sizeof(code), info);
+    TEST_ASSERT_EQUAL(int(IRLibrary::StoreResult::OK), int(irLibrary.store(key, code, info.bytes, info.durations)));
+    // Aprender de novo troca o código da chave
+    length = capture(IRProtocol::LG, COOL_23, captured, 2);
+    IRCode::compress(captured, length, code, sizeof(code), info);
+    TEST_ASSERT_EQUAL(int(IRLibrary::StoreResult::OK), int(irLibrary.store(key, code, info.bytes, info.durations)));
+    TEST_ASSERT_EQUAL(1, irLibrary.codes());
+    TEST_ASSERT_EQUAL(int(IRLibrary::StoreResult::INVALID), int(irLibrary.store(IRLibrary::KEYS, code, info.bytes, 0)));
+
+    IRLibrary rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL(1, rebooted.codes());
+    TEST_ASSERT_EQUAL(irLibrary.used(), rebooted.used());
+    TEST_ASSERT_FALSE(rebooted.contains(0));
+    assertMatchesClean(IRProtocol::LG, COOL_23, expanded, rebooted.expand(key, expanded, IR_MAX_PULSES));
+
+    IRLibrary missing;
+    TEST_ASSERT_FALSE(missing.begin("nada"));
+    TEST_ASSERT_EQUAL(0, missing.expand(key, expanded, IR_MAX_PULSES));
+}
+
+void test_torn_record_is_ignored() {
+    uint16_t captured[IR_MAX_PULSES];
+    uint8_t code[IRCode::MAX_BYTES];
+    IRCode::Info info;
+    uint16_t length = capture(IRProtocol::COOLIX, COOL_23, captured, 1);
+    IRCode::compress(captured, length, code, sizeof(code), info);
+    TEST_ASSERT_EQUAL(int(IRLibrary::StoreResult::OK), int(irLibrary.store(1, code, info.bytes, info.durations)));
+
+    // Energia cortada antes do mágico: cabeçalho e código na flash, sem ele
+    size_t torn = irLibrary.used();
+    uint8_t header[IRLibrary::RECORD_HEADER_BYTES - 2] = {2, 0, uint8_t(info.bytes), 0, uint8_t(length), 0};
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(libraryPartition(), torn + 2, header, sizeof(header)));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(libraryPartition(), torn + IRLibrary::RECORD_HEADER_BYTES, code, 10));
+
+    IRLibrary rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_TRUE(rebooted.contains(1));
+    TEST_ASSERT_FALSE(rebooted.contains(2));
+    TEST_ASSERT_EQUAL(1, rebooted.codes());
+    // O espaço do registro cortado não é regravado por cima
+    TEST_ASSERT_GREATER_THAN(torn, rebooted.used());
+    TEST_ASSERT_EQUAL(int(IRLibrary::StoreResult::OK), int(rebooted.store(2, code, info.bytes, info.durations)));
+    IRLibrary again;
+    again.begin();
+    TEST_ASSERT_TRUE(again.contains(2));
+    TEST_ASSERT_EQUAL(2, again.codes());
+}
+
+void test_full_library_then_erase() {
+    uint16_t captured[IR_MAX_PULSES];
+    uint8_t code[IRCode::MAX_BYTES];
+    IRCode::Info info;
+    uint16_t length = capture(IRProtocol::MIDEA, COOL_23, captured, 1);
+    IRCode::compress(captured, length, code, sizeof(code), info);
+
+    // Todas as chaves cabem várias vezes: regravar muito enche o log
+    uint32_t stored = 0;
+    while (irLibrary.store(uint16_t(stored % IRLibrary::KEYS), code, info.bytes, info.durations) == IRLibrary::StoreResult::OK) {
+        stored++;
+    }
+    TEST_ASSERT_GREATER_THAN(2 * IRLibrary::KEYS, stored);
+    TEST_ASSERT_EQUAL(IRLibrary::KEYS, irLibrary.codes());
+    TEST_ASSERT_EQUAL(int(IRLibrary::StoreResult::FULL), int(irLibrary.store(0, code, info.bytes, info.durations)));
+
+    irLibrary.clear();
+    TEST_ASSERT_FALSE(irLibrary.contains(0));
+    for (uint16_t i = 0; i < irLibrary.sectors(); i++) {
+        TEST_ASSERT_TRUE(irLibrary.eraseSector(i));
+    }
+    TEST_ASSERT_FALSE(irLibrary.eraseSector(irLibrary.sectors()));
+    IRLibrary rebooted;
+    rebooted.begin();
+    TEST_ASSERT_EQUAL(0, rebooted.codes());
+    TEST_ASSERT_EQUAL(0, rebooted.used());
+}
+
+// A tarefa de controle pode ter lido a entrada antes do clear() e chegar à
+// flash com o setor já apagado: o cabeçalho não confere e nada vai ao ar
+void test_stale_entry_after_erase_plays_nothing() {
+    uint16_t captured[IR_MAX_PULSES];
+    uint16_t expanded[IR_MAX_PULSES];
+    uint8_t code[IRCode::MAX_BYTES];
+    IRCode::Info info;
+    uint16_t key = IRLibrary::keyOf(COOL_23);
+    uint16_t length = capture(IRProtocol::GREE, COOL_23, captured, 1);
+    IRCode::compress(captured, length, code, sizeof(code), info);
+    TEST_ASSERT_EQUAL(int(IRLibrary::StoreResult::OK), int(irLibrary.store(key, code, info.bytes, info.durations)));
+    TEST_ASSERT_EQUAL(length, irLibrary.expand(key, expanded, IR_MAX_PULSES));
+
+    TEST_ASSERT_TRUE(irLibrary.eraseSector(0));
+    TEST_ASSERT_TRUE(irLibrary.contains(key));
+    TEST_ASSERT_EQUAL(0, irLibrary.expand(key, expanded, IR_MAX_PULSES));
+
+    // Regravado por cima com outra chave: também não é o registro dela
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(libraryPartition(), 0, "\x49\x4c\x01\x00", 4));
+    TEST_ASSERT_EQUAL(0, irLibrary.expand(key, expanded, IR_MAX_PULSES));
+    irLibrary.clear();
+    TEST_ASSERT_FALSE(irLibrary.contains(key));
+}
+
+void test_learn_command_parses() {
+    ACCommand command;
+    TEST_ASSERT_EQUAL(int(CommandParseResult::OK),
+                      int(parseCommandJson(reinterpret_cast<const uint8_t*>(LEARN_COOL_23), strlen(LEARN_COOL_23), command)));
+    TEST_ASSERT_EQUAL(int(ACCommandType::LEARN_IR), int(command.type));
+    TEST_ASSERT_EQUAL(0, command.value);
+    TEST_ASSERT_EQUAL(IRLibrary::keyOf(COOL_23), IRLibrary::keyOf(command.settings));
+
+    const char off[] = "{\"comando\":\"APRENDER_IR\",\"parametros\":{\"ligado\":false}}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::OK),
+                      int(parseCommandJson(reinterpret_cast<const uint8_t*>(off), strlen(off), command)));
+    TEST_ASSERT_FALSE(command.settings.isOn);
+    const char erase[] = "{\"comando\":\"APRENDER_IR\",\"parametros\":{\"apagar\":true}}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::OK),
+                      int(parseCommandJson(reinterpret_cast<const uint8_t*>(erase), strlen(erase), command)));
+    TEST_ASSERT_EQUAL(1, command.value);
+
+    // Ligado precisa do estado inteiro: é a chave da tecla
+    const char partial[] = "{\"comando\":\"APRENDER_IR\",\"parametros\":{\"ligado\":true,\"temperatura\":23}}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::INVALID_PARAMETER),
+                      int(parseCommandJson(reinterpret_cast<const uint8_t*>(partial), strlen(partial), command)));
+    const char hot[] = "{\"comando\":\"APRENDER_IR\",\"parametros\":{\"ligado\":true,\"modo\":\"VENTILAR\","
+                       "\"temperatura\":31,\"velocidade\":\"ALTA\"}}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::INVALID_PARAMETER),
+                      int(parseCommandJson(reinterpret_cast<const uint8_t*>(hot), strlen(hot), command)));
+    const char empty[] = "{\"comando\":\"APRENDER_IR\"}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::INVALID_PARAMETER),
+                      int(parseCommandJson(reinterpret_cast<const uint8_t*>(empty), strlen(empty), command)));
+}
+
+void test_learned_key_is_played_back() {
+    Device device;
+    device.runFor(1000);
+    TEST_ASSERT_TRUE(device.network.isConnected());
+
+    device.command(LEARN_COOL_23);
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"estado\":\"AGUARDANDO\""));
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"temperatura\":23"));
+
+    uint16_t captured[IR_MAX_PULSES];
+    uint16_t length = capture(IRProtocol::COOLIX, COOL_23, captured, 5);
+    TEST_ASSERT_TRUE(hostRmtPress(PIN_IR_RECEIVER, captured, length));
+    device.runFor(500);
+    TEST_ASSERT_EQUAL(int(IRLearnState::STORED), int(device.learner.state()));
+    TEST_ASSERT_NOT_NULL_MESSAGE(strstr(learnReport(), "\"estado\":\"GRAVADO\""), learnReport());
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"duracoes\":199"));
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"codigos\":1"));
+    TEST_ASSERT_TRUE(irLibrary.contains(IRLibrary::keyOf(COOL_23)));
+
+    // O estado aprendido vai ao ar como o controle original
+    device.ac.applyState(COOL_23, STATUS_FIELD_POWER | STATUS_FIELD_TARGET_TEMP | STATUS_FIELD_MODE | STATUS_FIELD_FAN_SPEED);
+    TEST_ASSERT_EQUAL(1, HostIRLog::count());
+    TEST_ASSERT_EQUAL(IR_LEARNED_KHZ, HostIRLog::last()->khz);
+    const uint16_t* sent = nullptr;
+    uint16_t sentLength = HostIRLog::lastPulses(sent);
+    assertMatchesClean(IRProtocol::COOLIX, COOL_23, sent, sentLength);
+
+    // Tecla não aprendida: nada sai
+    HostClock::advanceMillis(1000);
+    device.ac.setTemperature(24);
+    TEST_ASSERT_EQUAL(1, HostIRLog::count());
+}
+
+void test_noise_keeps_waiting_until_timeout() {
+    Device device;
+    device.runFor(1000);
+    device.command(LEARN_COOL_23);
+
+    // Reflexo curto: o receptor continua armado
+    const uint16_t glitch[] = {400, 300, 450};
+    TEST_ASSERT_TRUE(hostRmtPress(PIN_IR_RECEIVER, glitch, 3));
+    device.runFor(500);
+    TEST_ASSERT_EQUAL(int(IRLearnState::WAITING), int(device.learner.state()));
+    TEST_ASSERT_TRUE(device.learner.busy());
+
+    device.runFor(IR_LEARN_TIMEOUT);
+    TEST_ASSERT_EQUAL(int(IRLearnState::TIMEOUT), int(device.learner.state()));
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"estado\":\"TEMPO_ESGOTADO\""));
+    TEST_ASSERT_EQUAL(0, irLibrary.codes());
+    // Receptor desarmado: a tecla de agora não é de ninguém
+    uint16_t captured[IR_MAX_PULSES];
+    TEST_ASSERT_FALSE(hostRmtPress(PIN_IR_RECEIVER, captured, capture(IRProtocol::LG, COOL_23, captured, 1)));
+}
+
+void test_frame_longer_than_receiver_memory() {
+    // Um bloco (64 itens) não guarda os 100 itens de um Coolix
+    Device device(1);
+    device.runFor(1000);
+    device.command(LEARN_COOL_23);
+    uint16_t captured[IR_MAX_PULSES];
+    TEST_ASSERT_TRUE(hostRmtPress(PIN_IR_RECEIVER, captured, capture(IRProtocol::COOLIX, COOL_23, captured, 1)));
+    device.runFor(500);
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"estado\":\"LONGO_DEMAIS\""));
+    TEST_ASSERT_EQUAL(0, irLibrary.codes());
+
+    // O LG (30 itens) cabe
+    device.command(LEARN_COOL_23);
+    TEST_ASSERT_TRUE(hostRmtPress(PIN_IR_RECEIVER, captured, capture(IRProtocol::LG, COOL_23, captured, 1)));
+    device.runFor(500);
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"estado\":\"GRAVADO\""));
+}
+
+void test_erase_over_mqtt_one_sector_per_step() {
+    Device device;
+    device.runFor(1000);
+    device.command(LEARN_COOL_23);
+    uint16_t captured[IR_MAX_PULSES];
+    hostRmtPress(PIN_IR_RECEIVER, captured, capture(IRProtocol::GREE, COOL_23, captured, 1));
+    device.runFor(500);
+    TEST_ASSERT_EQUAL(1, irLibrary.codes());
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"APRENDER_IR\",\"parametros\":{\"apagar\":true}}");
+    device.network.update();
+    // Esquecida na hora, apagada aos poucos
+    TEST_ASSERT_EQUAL(0, irLibrary.codes());
+    TEST_ASSERT_EQUAL(int(IRLearnState::ERASING), int(device.learner.state()));
+    uint32_t erasedBefore = HostOta::sectorsErased();
+    device.network.update();
+    TEST_ASSERT_EQUAL(erasedBefore + 1, HostOta::sectorsErased());
+
+    device.runFor(1000);
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"estado\":\"APAGADA\""));
+    TEST_ASSERT_NOT_NULL(strstr(learnReport(), "\"codigos\":0"));
+    IRLibrary rebooted;
+    rebooted.begin();
+    TEST_ASSERT_EQUAL(0, rebooted.codes());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_within_receiver_tolerance);
+    RUN_TEST(test_coolix_layout);
+    RUN_TEST(test_noise_and_oversized_codes);
+    RUN_TEST(test_keys_cover_every_state_once);
+    RUN_TEST(test_store_survives_reboot);
+    RUN_TEST(test_torn_record_is_ignored);
+    RUN_TEST(test_full_library_then_erase);
+    RUN_TEST(test_stale_entry_after_erase_plays_nothing);
+    RUN_TEST(test_learn_command_parses);
+    RUN_TEST(test_learned_key_is_played_back);
+    RUN_TEST(test_noise_keeps_waiting_until_timeout);
+    RUN_TEST(test_frame_longer_than_receiver_memory);
+    RUN_TEST(test_erase_over_mqtt_one_sector_per_step);
+    return UNITY_END();
+}
@@ -0,0 +1,236 @@
+#include <unity.h>
+#include <stdio.h>
+#include <HostIRLog.h>
+#include <driver/rmt.h>
+#include "config.h"
+#include "ACController.h"
+#include "Coolix.h"
+#include "ControlLoop.h"
+#include "IRSender.h"
+
+// Quadro NEC: cabeçalho + 32 bits + marca final, em µs
+static uint32_t necDuration(uint32_t code) {
+    uint32_t duration = 9000 + 4500 + 560;
+    for (int bit = 0; bit < 32; bit++) {
+        duration += 560 + ((code >> bit) & 1 ? 1690 : 560);
+    }
+    return duration;
+}
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    hostRmtReset();
+}
+
+void tearDown() {}
+
+// Tarefa de controle acordando a cada 'stepMs' até a fila esvaziar
+static void runUntilIdle(IRSender& sender, uint32_t stepMs = 1) {
+    for (int i = 0; i < 10000 && !sender.idle(); i++) {
+        HostClock::advanceMillis(stepMs);
+        sender.poll();
+    }
+    TEST_ASSERT_TRUE(sender.idle());
+}
+
+void test_send_returns_without_blocking() {
+    IRSender sender(PIN_IR_LED);
+    sender.begin();
+
+    uint64_t t0 = HostClock::nowMicros();
+    sender.sendNECCommand(0x1000, 0x0006, IRSlot::TEMPERATURE);
+    sender.sendNECCommand(0xABCD, 0xEF01, IRSlot::MODE);
+    TEST_ASSERT_EQUAL(t0, HostClock::nowMicros());
+
+    // O primeiro quadro vai para o RMT na hora; o segundo espera na fila
+    TEST_ASSERT_EQUAL(1, HostIRLog::count());
+    TEST_ASSERT_EQUAL(t0, HostIRLog::last()->timestampUs);
+    TEST_ASSERT_EQUAL(1, sender.queued());
+    TEST_ASSERT_FALSE(sender.idle());
+}
+
+void test_nec_waveform_decodes() {
+    IRSender sender(PIN_IR_LED);
+    sender.begin();
+    sender.sendNECCommand(0x1234, 0x5678, IRSlot::POWER);
+
+    const HostIRFrame* frame = HostIRLog::last();
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL(int(HostIRProtocol::NEC), int(frame->protocol));
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, frame->data);
+    TEST_ASSERT_EQUAL(32, frame->bits);
+    TEST_ASSERT_EQUAL(38, frame->khz);
+    TEST_ASSERT_EQUAL(PIN_IR_LED, frame->pin);
+    TEST_ASSERT_EQUAL(necDuration(0x12345678), frame->durationUs);
+}
+
+void test_same_slot_coalesces_to_last() {
+    IRSender sender(PIN_IR_LED);
+    sender.begin();
+    sender.sendNECCommand(0x1234, 0x5678, IRSlot::POWER);
+
+    // Três temperaturas enquanto o LIGAR está no ar: só a última sai
+    sender.sendNECCommand(0x1000, 0x0004, IRSlot::TEMPERATURE);
+    sender.sendNECCommand(0x1000, 0x0005, IRSlot::TEMPERATURE);
+    sender.sendNECCommand(0x1000, 0x0008, IRSlot::TEMPERATURE);
+    TEST_ASSERT_EQUAL(1, sender.queued());
+    TEST_ASSERT_EQUAL(2, sender.framesCoalesced());
+
+    runUntilIdle(sender);
+    TEST_ASSERT_EQUAL(2, HostIRLog::count());
+    TEST_ASSERT_EQUAL_HEX32(0x10000008, HostIRLog::last()->data);
+    TEST_ASSERT_EQUAL(2, sender.framesSent());
+}
+
+void test_coalesced_frame_keeps_its_turn() {
+    IRSender sender(PIN_IR_LED);
+    sender.begin();
+    sender.sendNECCommand(0x1234, 0x5678, IRSlot::POWER);
+    sender.sendNECCommand(0x1000, 0x0004, IRSlot::TEMPERATURE);
+    sender.sendNECCommand(0xABCD, 0xEF01, IRSlot::MODE);
+    sender.sendNECCommand(0x1000, 0x0009, IRSlot::TEMPERATURE);
+
+    runUntilIdle(sender);
+    TEST_ASSERT_EQUAL(3, HostIRLog::count());
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, HostIRLog::at(0)->data);
+    TEST_ASSERT_EQUAL_HEX32(0x10000009, HostIRLog::at(1)->data);
+    TEST_ASSERT_EQUAL_HEX32(0xABCDEF01, HostIRLog::at(2)->data);
+}
+
+void test_gap_is_scheduled_after_frame_end() {
+    IRSender sender(PIN_IR_LED);
+    sender.begin();
+    sender.sendNECCommand(0x1000, 0x0001, IRSlot::POWER);
+    sender.sendNECCommand(0x1000, 0x0002, IRSlot::TEMPERATURE);
+    sender.sendNECCommand(0x1000, 0x0003, IRSlot::MODE);
+    runUntilIdle(sender);
+
+    TEST_ASSERT_EQUAL(3, HostIRLog::count());
+    for (uint32_t i = 1; i < 3; i++) {
+        const HostIRFrame* previous = HostIRLog::at(i - 1);
+        uint64_t earliest = previous->timestampUs + previous->durationUs + IRSender::FRAME_GAP_MS * 1000UL;
+        uint64_t start = HostIRLog::at(i)->timestampUs;
+        // Nunca antes do intervalo; no máximo um passo (1 ms) depois
+        TEST_ASSERT_TRUE(start >= earliest);
+        TEST_ASSERT_TRUE(start < earliest + 1000);
+    }
+    TEST_ASSERT_EQUAL(0, hostRmtOverlaps());
+}
+
+void test_coolix_and_raw_frames() {
+    IRSender sender(PIN_IR_LED);
+    sender.begin();
+    sender.sendState(*irEncoderFor(IRProtocol::COOLIX), ACSettings{false, 22, ACMode::COOL, FanSpeed::AUTO});
+    TEST_ASSERT_EQUAL(int(HostIRProtocol::RAW), int(HostIRLog::last()->protocol));
+    TEST_ASSERT_EQUAL(Coolix::RAW_LENGTH, HostIRLog::last()->bits);
+
+    // Portadora diferente e número ímpar de durações
+    static const uint16_t raw[] = {3400, 1700, 420, 1300, 420, 420, 420};
+    sender.sendRaw(raw, 7, 40);
+    runUntilIdle(sender);
+    TEST_ASSERT_EQUAL(2, HostIRLog::count());
+    TEST_ASSERT_EQUAL(7, HostIRLog::last()->bits);
+    TEST_ASSERT_EQUAL(40, HostIRLog::last()->khz);
+    TEST_ASSERT_EQUAL(3400 + 1700 + 420 + 1300 + 420 + 420 + 420, HostIRLog::last()->durationUs);
+}
+
+void test_controller_coalesces_commands_per_window() {
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ControlLoop control(ac, commands, samples, status);
+    ac.begin();
+
+    commands.push(ACCommand{ACCommandType::TURN_ON, 0});
+    control.step();
+    for (uint8_t temp = 18; temp <= 20; temp++) {
+        commands.push(ACCommand{ACCommandType::SET_TEMPERATURE, temp});
+        HostClock::advanceMillis(5);
+        control.step();
+    }
+    for (int ms = 0; ms < 1000 && !ac.irIdle(); ms += 5) {
+        HostClock::advanceMillis(5);
+        control.step();
+    }
+
+    TEST_ASSERT_EQUAL(2, HostIRLog::count());
+    TEST_ASSERT_EQUAL_HEX32(IRCodes::POWER_ON, HostIRLog::at(0)->data);
+    TEST_ASSERT_EQUAL_HEX32(IRCodes::TEMP_BASE + 4, HostIRLog::last()->data);
+    TEST_ASSERT_EQUAL(20, ac.getTargetTemperature());
+}
+
+// Rajada de comandos de operador (um a cada 20..300 ms) durante 10 min de
+// tempo virtual, tarefa de controle a cada 5 ms como no firmware
+void test_burst_throughput() {
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ControlLoop control(ac, commands, samples, status);
+    ac.begin();
+    commands.push(ACCommand{ACCommandType::TURN_ON, 0});
+
+    uint32_t lcg = 7;
+    uint32_t issued = 0;
+    uint32_t nextCommandAt = 0;
+    uint64_t maxStepUs = 0;
+    const uint32_t durationMs = 10UL * 60UL * 1000UL;
+    for (uint32_t t = 0; t < durationMs; t += 5) {
+        if (t >= nextCommandAt) {
+            lcg = lcg * 1664525u + 1013904223u;
+            uint8_t kind = (lcg >> 20) % 3;
+            uint8_t value = uint8_t(lcg >> 8);
+            ACCommand command{ACCommandType::SET_TEMPERATURE, uint8_t(16 + value % 15)};
+            if (kind == 1) command = ACCommand{ACCommandType::SET_MODE, uint8_t(1 + value % 3)};
+            if (kind == 2) command = ACCommand{ACCommandType::SET_FAN_SPEED, uint8_t(value % 4)};
+            if (commands.push(command)) issued++;
+            nextCommandAt = t + 20 + (lcg >> 12) % 280;
+        }
+        uint64_t before = HostClock::nowMicros();
+        control.step();
+        maxStepUs = HostClock::nowMicros() - before > maxStepUs ? HostClock::nowMicros() - before : maxStepUs;
+        HostClock::advanceMillis(5);
+    }
+    for (int ms = 0; ms < 1000 && !ac.irIdle(); ms += 5) {
+        HostClock::advanceMillis(5);
+        control.step();
+    }
+
+    uint32_t frames = ac.irSender().framesSent();
+    char report[160];
+    snprintf(report, sizeof(report),
+             "[ir] %u comandos em 10 min -> %u quadros (%u fundidos), %.1f quadros/s, passo máx %u us",
+             (unsigned)issued, (unsigned)frames, (unsigned)ac.irSender().framesCoalesced(),
+             frames / (durationMs / 1000.0), (unsigned)maxStepUs);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_EQUAL(0, maxStepUs);
+    TEST_ASSERT_EQUAL(0, hostRmtOverlaps());
+    TEST_ASSERT_LESS_THAN(issued, frames);
+    // A última temperatura transmitida é a do estado final
+    const HostIRFrame* lastTemp = nullptr;
+    for (uint32_t i = HostIRLog::count(); i-- > 0 && HostIRLog::at(i);) {
+        uint32_t data = HostIRLog::at(i)->data;
+        if (data >= IRCodes::TEMP_BASE && data < IRCodes::TEMP_BASE + 15) {
+            lastTemp = HostIRLog::at(i);
+            break;
+        }
+    }
+    TEST_ASSERT_NOT_NULL(lastTemp);
+    TEST_ASSERT_EQUAL_HEX32(IRCodes::TEMP_BASE + (ac.getTargetTemperature() - 16), lastTemp->data);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_send_returns_without_blocking);
+    RUN_TEST(test_nec_waveform_decodes);
+    RUN_TEST(test_same_slot_coalesces_to_last);
+    RUN_TEST(test_coalesced_frame_keeps_its_turn);
+    RUN_TEST(test_gap_is_scheduled_after_frame_end);
+    RUN_TEST(test_coolix_and_raw_frames);
+    RUN_TEST(test_controller_coalesces_commands_per_window);
+    RUN_TEST(test_burst_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,237 @@
+#include <unity.h>
+#include <thread>
+#include <FakeBroker.h>
+#include "config.h"
+#include "ACController.h"
+#include "Metrics.h"
+#include "NetworkManager.h"
+
+static const uint32_t LOOP_STEP_MS = 10;
+
+void setUp() {
+    HostClock::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+    Metrics::reset();
+}
+
+void tearDown() {}
+
+static bool connect(NetworkManager& network, ACController& ac) {
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    return network.isConnected();
+}
+
+static void runFor(NetworkManager& network, uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += LOOP_STEP_MS) {
+        network.update();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+}
+
+void test_bucket_boundaries() {
+    // Cada balde começa onde o anterior termina, sem buracos
+    for (size_t i = 0; i + 1 < Metrics::BUCKETS; i++) {
+        uint32_t lower = Metrics::bucketLowerBound(i);
+        uint32_t next = Metrics::bucketLowerBound(i + 1);
+        TEST_ASSERT_TRUE(next > lower);
+        TEST_ASSERT_EQUAL(i, Metrics::bucketIndex(lower));
+        TEST_ASSERT_EQUAL(i, Metrics::bucketIndex(next - 1));
+    }
+    TEST_ASSERT_EQUAL(0, Metrics::bucketIndex(0));
+    TEST_ASSERT_EQUAL(Metrics::BUCKETS - 1, Metrics::bucketIndex(UINT32_MAX));
+    // O último balde cobre pelo menos 1 s
+    TEST_ASSERT_TRUE(Metrics::bucketLowerBound(Metrics::BUCKETS - 1) >= 1000000);
+}
+
+void test_percentiles_within_bucket_error() {
+    for (uint32_t us = 1; us <= 1000; us++) {
+        Metrics::record(Metrics::Latency::CONTROL_LOOP, us);
+    }
+    Metrics::LatencySnapshot s = Metrics::takeSnapshot(Metrics::Latency::CONTROL_LOOP);
+    TEST_ASSERT_EQUAL(1000, s.count);
+    TEST_ASSERT_EQUAL(500, s.meanUs);
+    TEST_ASSERT_EQUAL(1000, s.maxUs);
+    // Limite superior do balde: nunca abaixo do valor real, no máximo 25% acima
+    TEST_ASSERT_TRUE(s.p50Us >= 500 && s.p50Us <= 625);
+    TEST_ASSERT_TRUE(s.p90Us >= 900 && s.p90Us <= 1000);
+    TEST_ASSERT_TRUE(s.p99Us >= 990 && s.p99Us <= 1000);
+}
+
+void test_snapshot_resets_window_but_not_counters() {
+    Metrics::record(Metrics::Latency::COMMAND_PARSE, 40);
+    Metrics::increment(Metrics::Counter::COMMANDS);
+    Metrics::increment(Metrics::Counter::COMMANDS);
+
+    TEST_ASSERT_EQUAL(1, Metrics::takeSnapshot(Metrics::Latency::COMMAND_PARSE).count);
+    Metrics::LatencySnapshot empty = Metrics::takeSnapshot(Metrics::Latency::COMMAND_PARSE);
+    TEST_ASSERT_EQUAL(0, empty.count);
+    TEST_ASSERT_EQUAL(0, empty.p99Us);
+    TEST_ASSERT_EQUAL(2, Metrics::counter(Metrics::Counter::COMMANDS));
+
+    Metrics::reset();
+    TEST_ASSERT_EQUAL(0, Metrics::counter(Metrics::Counter::COMMANDS));
+}
+
+void test_concurrent_recording_loses_nothing() {
+    // Tarefa de rede e de controle registram ao mesmo tempo, sem trava
+    const uint32_t PER_THREAD = 100000;
+    std::thread threads[4];
+    for (uint32_t t = 0; t < 4; t++) {
+        threads[t] = std::thread([t] {
+            for (uint32_t i = 0; i < PER_THREAD; i++) {
+                Metrics::record(Metrics::Latency::IR_TRANSMIT, (i & 0xFF) + t * 1000);
+                Metrics::increment(Metrics::Counter::PUBLISH_FAILURES);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    Metrics::LatencySnapshot s = Metrics::takeSnapshot(Metrics::Latency::IR_TRANSMIT);
+    TEST_ASSERT_EQUAL(4 * PER_THREAD, s.count);
+    TEST_ASSERT_EQUAL(3255, s.maxUs);
+    TEST_ASSERT_EQUAL(4 * PER_THREAD, Metrics::counter(Metrics::Counter::PUBLISH_FAILURES));
+}
+
+void test_diagnostics_published_periodically() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    TEST_ASSERT_TRUE(connect(network, ac));
+    ESP.hostSetHeap(180000, 90000, 150000);
+
+    uint32_t publishes = FakeBroker::instance().publishCount();
+    runFor(network, DIAGNOSTICS_INTERVAL - 1000);
+    TEST_ASSERT_NULL(FakeBroker::instance().lastMessage(MQTT_DIAGNOSTICS_TOPIC));
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}");
+    runFor(network, 2000);
+    const FakeMessage* message = FakeBroker::instance().lastMessage(MQTT_DIAGNOSTICS_TOPIC);
+    TEST_ASSERT_NOT_NULL(message);
+    TEST_ASSERT_FALSE(message->retained);
+    TEST_ASSERT_TRUE(FakeBroker::instance().publishCount() > publishes);
+
+    const char* json = message->text();
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"heap\":{\"livre\":180000,\"maiorBloco\":90000,\"minimo\":150000}"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"conexoesWifi\":1,\"conexoesMqtt\":1"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"comandos\":1"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"loopRede\":{\"n\":"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"parseComando\":{\"n\":1,"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"execComando\":{\"n\":1,"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"ultimoErro\":null"));
+}
+
+void test_full_snapshot_fits_mqtt_packet() {
+    // Pior caso: todas as latências no teto e contadores de 6 dígitos
+    for (size_t i = 0; i < Metrics::LATENCY_COUNT; i++) {
+        Metrics::record(Metrics::Latency(i), UINT32_MAX / 2);
+        Metrics::record(Metrics::Latency(i), UINT32_MAX / 2);
+    }
+    for (size_t i = 0; i < Metrics::COUNTER_COUNT; i++) {
+        for (int n = 0; n < 100000; n++) Metrics::increment(Metrics::Counter(i));
+    }
+    HostClock::advanceMillis(uint64_t(400) * 24 * 3600 * 1000);   // uptime de 8 dígitos
+    char buffer[Metrics::DIAGNOSTICS_JSON_CAPACITY];
+    size_t length = Metrics::serializeDiagnosticsJson("MQTT_CONNECTION_FAILED", buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_TRUE(length + strlen(MQTT_DIAGNOSTICS_TOPIC) + 7 <= 1024);
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "\"max\":8388607"));
+}
+
+void test_rejected_command_reports_error() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    TEST_ASSERT_TRUE(connect(network, ac));
+    TEST_ASSERT_EQUAL_STRING("NONE", network.getLastError());
+
+    // Presente e numérica, só fora da faixa de 16 a 30
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":99}}");
+    network.update();
+
+    const FakeMessage* error = FakeBroker::instance().lastMessage(MQTT_ERROR_TOPIC);
+    TEST_ASSERT_NOT_NULL(error);
+    TEST_ASSERT_NOT_NULL(strstr(error->text(), "\"erro\":\"INVALID_COMMAND\""));
+    TEST_ASSERT_NOT_NULL(strstr(error->text(), "\"mensagem\":\"INVALID_PARAMETER\""));
+    TEST_ASSERT_EQUAL_STRING("INVALID_COMMAND", network.getLastError());
+    TEST_ASSERT_EQUAL(1, Metrics::counter(Metrics::Counter::COMMANDS_REJECTED));
+}
+
+static char g_callbackTopic[64];
+static char g_callbackMessage[300];
+static uint32_t g_callbacks;
+
+static void onMessage(const char* topic, const char* message) {
+    strncpy(g_callbackTopic, topic, sizeof(g_callbackTopic) - 1);
+    strncpy(g_callbackMessage, message, sizeof(g_callbackMessage) - 1);
+    g_callbacks++;
+}
+
+void test_user_callback_sees_terminated_payload() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    network.setCallback(onMessage);
+    TEST_ASSERT_TRUE(connect(network, ac));
+    g_callbacks = 0;
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"DESLIGAR\"}");
+    network.update();
+    TEST_ASSERT_EQUAL(1, g_callbacks);
+    TEST_ASSERT_EQUAL_STRING(MQTT_COMMAND_TOPIC, g_callbackTopic);
+    TEST_ASSERT_EQUAL_STRING("{\"comando\":\"DESLIGAR\"}", g_callbackMessage);
+
+    // Mensagem longa: truncada em 255 bytes
+    char longPayload[400];
+    memset(longPayload, 'x', sizeof(longPayload) - 1);
+    longPayload[sizeof(longPayload) - 1] = '\0';
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, longPayload);
+    network.update();
+    TEST_ASSERT_EQUAL(2, g_callbacks);
+    TEST_ASSERT_EQUAL(255, strlen(g_callbackMessage));
+}
+
+void test_watchdog_reconnects_stalled_connection() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    TEST_ASSERT_TRUE(connect(network, ac));
+
+    // Conexão aparentemente viva, mas nada do que é publicado sai
+    FakeBroker::instance().setStalled(true);
+    runFor(network, NetworkManager::WATCHDOG_TIMEOUT + DIAGNOSTICS_INTERVAL);
+    TEST_ASSERT_EQUAL(1, Metrics::counter(Metrics::Counter::WATCHDOG_RESETS));
+    TEST_ASSERT_TRUE(Metrics::counter(Metrics::Counter::PUBLISH_FAILURES) > 0);
+
+    FakeBroker::instance().setStalled(false);
+    runFor(network, 60000);
+    TEST_ASSERT_TRUE(network.isConnected());
+    TEST_ASSERT_EQUAL(2, Metrics::counter(Metrics::Counter::MQTT_CONNECTS));
+    TEST_ASSERT_EQUAL(1, Metrics::counter(Metrics::Counter::WATCHDOG_RESETS));
+}
+
+void test_idle_connection_does_not_trip_watchdog() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    TEST_ASSERT_TRUE(connect(network, ac));
+
+    runFor(network, 3 * NetworkManager::WATCHDOG_TIMEOUT);
+    TEST_ASSERT_TRUE(network.isConnected());
+    TEST_ASSERT_EQUAL(0, Metrics::counter(Metrics::Counter::WATCHDOG_RESETS));
+    TEST_ASSERT_EQUAL(1, Metrics::counter(Metrics::Counter::MQTT_CONNECTS));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_boundaries);
+    RUN_TEST(test_percentiles_within_bucket_error);
+    RUN_TEST(test_snapshot_resets_window_but_not_counters);
+    RUN_TEST(test_concurrent_recording_loses_nothing);
+    RUN_TEST(test_diagnostics_published_periodically);
+    RUN_TEST(test_full_snapshot_fits_mqtt_packet);
+    RUN_TEST(test_rejected_command_reports_error);
+    RUN_TEST(test_user_callback_sees_terminated_payload);
+    RUN_TEST(test_watchdog_reconnects_stalled_connection);
+    RUN_TEST(test_idle_connection_does_not_trip_watchdog);
+    return UNITY_END();
+}
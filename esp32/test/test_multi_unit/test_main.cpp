@@ -0,0 +1,205 @@
+#include <unity.h>
+#include <string.h>
+#include <FakeBroker.h>
+#include <HostDht22.h>
+#include <HostIRLog.h>
+#include "config.h"
+#include "ACUnits.h"
+#include "ControlLoop.h"
+#include "NetworkManager.h"
+#include "TaskQueues.h"
+
+static const uint32_t LOOP_STEP_MS = 10;
+static const uint8_t IR_PINS[] = {PIN_IR_LED, 16, 17};
+
+#define UNIT_COMMAND_TOPIC(n) MQTT_COMMAND_TOPIC "/" #n
+#define UNIT_STATUS_TOPIC(n) MQTT_STATUS_TOPIC "/" #n
+
+template <size_t N>
+static void connect(MultiUnitNetworkManager<N>& network, ACUnits<N>& units) {
+    units.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+}
+
+// Laço único: a rede executa os comandos e cada aparelho põe o IR no ar
+template <size_t N>
+static void runFor(NetworkManager& network, ACUnits<N>& units, uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += LOOP_STEP_MS) {
+        network.update();
+        for (size_t i = 0; i < N; i++) units[i].updateIR();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+}
+
+static uint32_t framesOnPin(uint8_t pin) {
+    uint32_t frames = 0;
+    for (uint32_t i = 0; i < HostIRLog::count(); i++) {
+        const HostIRFrame* frame = HostIRLog::at(i);
+        if (frame && frame->pin == pin) frames++;
+    }
+    return frames;
+}
+
+static bool retainedContains(const char* topic, const char* text) {
+    const FakeMessage* message = FakeBroker::instance().retained(topic);
+    return message && strstr(message->text(), text) != nullptr;
+}
+
+void setUp() {
+    HostClock::reset();
+    HostDht22::reset();
+    HostIRLog::reset();
+    hostRmtReset();
+    WiFi.hostReset();
+    FakeBroker::instance().reset();
+}
+
+void tearDown() {}
+
+void test_units_transmit_on_their_own_channel() {
+    ACUnits<3> units(IR_PINS, PIN_DHT);
+    units.begin();
+    // Cada transmissor ocupa dois blocos do RMT: o canal 1 já é do primeiro
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX(gpio_num_t(5), RMT_CHANNEL_1);
+    TEST_ASSERT_EQUAL(ESP_OK, rmt_config(&config));
+    TEST_ASSERT_TRUE(rmt_driver_install(RMT_CHANNEL_1, 0, 0) != ESP_OK);
+
+    // Os três ao mesmo tempo: nenhum espera o quadro do outro
+    for (size_t i = 0; i < units.size(); i++) units[i].turnOn();
+    for (size_t i = 0; i < units.size(); i++) units[i].updateIR();
+    TEST_ASSERT_EQUAL_UINT32(3, HostIRLog::count());
+    for (uint8_t pin : IR_PINS) TEST_ASSERT_EQUAL_UINT32(1, framesOnPin(pin));
+    TEST_ASSERT_EQUAL_UINT32(0, hostRmtOverlaps());
+}
+
+void test_commands_route_by_unit_topic() {
+    ACUnits<3> units(IR_PINS, PIN_DHT);
+    MultiUnitNetworkManager<3> network(DEVICE_ID, units);
+    connect(network, units);
+    TEST_ASSERT_EQUAL(3, network.unitCount());
+    // Ao conectar, um status retido por unidade
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().retained(MQTT_STATUS_TOPIC));
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().retained(UNIT_STATUS_TOPIC(1)));
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().retained(UNIT_STATUS_TOPIC(2)));
+    HostIRLog::reset();
+
+    FakeBroker::instance().inject(UNIT_COMMAND_TOPIC(1), "{\"comando\":\"LIGAR\"}");
+    FakeBroker::instance().inject(UNIT_COMMAND_TOPIC(2),
+                                  "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":19}}");
+    runFor(network, units, 500);
+
+    TEST_ASSERT_FALSE(units[0].isOn());
+    TEST_ASSERT_TRUE(units[1].isOn());
+    TEST_ASSERT_FALSE(units[2].isOn());
+    TEST_ASSERT_EQUAL(23, units[1].getTargetTemperature());
+    TEST_ASSERT_EQUAL(19, units[2].getTargetTemperature());
+    TEST_ASSERT_EQUAL_UINT32(0, framesOnPin(IR_PINS[0]));
+    TEST_ASSERT_EQUAL_UINT32(1, framesOnPin(IR_PINS[1]));
+    // Desligado, a temperatura só muda no estado: vai no próximo LIGAR
+    TEST_ASSERT_EQUAL_UINT32(0, framesOnPin(IR_PINS[2]));
+    TEST_ASSERT_TRUE(retainedContains(UNIT_STATUS_TOPIC(1), "\"ligado\":true"));
+    TEST_ASSERT_TRUE(retainedContains(UNIT_STATUS_TOPIC(2), "\"temperaturaDesejada\":19"));
+    TEST_ASSERT_TRUE(retainedContains(MQTT_STATUS_TOPIC, "\"ligado\":false"));
+
+    // .../comando sem número é a unidade 0, como com um aparelho só
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}");
+    FakeBroker::instance().inject(UNIT_COMMAND_TOPIC(0), "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"REFRIGERAR\"}}");
+    runFor(network, units, 500);
+    TEST_ASSERT_TRUE(units[0].isOn());
+    TEST_ASSERT_EQUAL(int(ACMode::COOL), int(units[0].getMode()));
+    TEST_ASSERT_EQUAL(int(ACMode::AUTO), int(units[1].getMode()));
+    TEST_ASSERT_TRUE(retainedContains(MQTT_STATUS_TOPIC, "\"ligado\":true"));
+}
+
+void test_unknown_unit_is_rejected() {
+    ACUnits<2> units(IR_PINS, PIN_DHT);
+    MultiUnitNetworkManager<2> network(DEVICE_ID, units);
+    connect(network, units);
+    HostIRLog::reset();
+
+    const char* const topics[] = {UNIT_COMMAND_TOPIC(2), UNIT_COMMAND_TOPIC(1x), MQTT_COMMAND_TOPIC "/1/extra"};
+    for (const char* topic : topics) {
+        uint32_t before = FakeBroker::instance().publishCount();
+        FakeBroker::instance().inject(topic, "{\"comando\":\"LIGAR\"}");
+        runFor(network, units, 50);
+        const FakeMessage* error = FakeBroker::instance().lastMessage(MQTT_ERROR_TOPIC);
+        TEST_ASSERT_NOT_NULL(error);
+        TEST_ASSERT_NOT_NULL(strstr(error->text(), "UNKNOWN_UNIT"));
+        TEST_ASSERT_GREATER_THAN(before, FakeBroker::instance().publishCount());
+    }
+    TEST_ASSERT_FALSE(units[0].isOn());
+    TEST_ASSERT_FALSE(units[1].isOn());
+    TEST_ASSERT_EQUAL_UINT32(0, HostIRLog::count());
+}
+
+void test_task_mode_keeps_unit_state_apart() {
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACUnits<3> units(IR_PINS, PIN_DHT);
+    MultiUnitNetworkManager<3> network(DEVICE_ID, units);
+    ControlLoop control(units, commands, samples, status);
+    network.attachQueues(commands, status);
+    network.setDeltaPublishing(true);
+    connect(network, units);
+
+    FakeBroker::instance().inject(UNIT_COMMAND_TOPIC(2),
+                                  "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":18,"
+                                  "\"modo\":\"REFRIGERAR\",\"velocidade\":\"ALTA\"}}");
+    for (int i = 0; i < 20; i++) {
+        network.update();
+        control.step();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+    TEST_ASSERT_TRUE(units[2].isOn());
+    TEST_ASSERT_FALSE(units[0].isOn());
+    TEST_ASSERT_FALSE(units[1].isOn());
+    TEST_ASSERT_TRUE(retainedContains(UNIT_STATUS_TOPIC(2), "\"temperaturaDesejada\":18"));
+    TEST_ASSERT_TRUE(retainedContains(UNIT_STATUS_TOPIC(1), "\"ligado\":false"));
+    TEST_ASSERT_TRUE(retainedContains(MQTT_STATUS_TOPIC, "\"ligado\":false"));
+
+    // A leitura do sensor da sala chega a todos; cada um publica o seu delta
+    SensorSample sample{27.5f, 60.0f};
+    samples.push(sample);
+    control.step();
+    uint32_t published = FakeBroker::instance().publishCount();
+    HostClock::advanceMillis(STATUS_UPDATE_INTERVAL);
+    network.update();
+    for (size_t i = 0; i < units.size(); i++) {
+        TEST_ASSERT_EQUAL_FLOAT(27.5f, units[i].getCurrentTemperature());
+    }
+    TEST_ASSERT_EQUAL_UINT32(published + 3, FakeBroker::instance().publishCount());
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().lastMessage(MQTT_STATUS_DELTA_TOPIC));
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().lastMessage(UNIT_STATUS_TOPIC(1) "/delta"));
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().lastMessage(UNIT_STATUS_TOPIC(2) "/delta"));
+}
+
+void test_single_unit_topics_are_unchanged() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_EQUAL(1, network.unitCount());
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}");
+    network.update();
+    TEST_ASSERT_TRUE(ac.isOn());
+    TEST_ASSERT_TRUE(retainedContains(MQTT_STATUS_TOPIC, "\"ligado\":true"));
+    TEST_ASSERT_NULL(FakeBroker::instance().retained(UNIT_STATUS_TOPIC(1)));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_units_transmit_on_their_own_channel);
+    RUN_TEST(test_commands_route_by_unit_topic);
+    RUN_TEST(test_unknown_unit_is_rejected);
+    RUN_TEST(test_task_mode_keeps_unit_state_apart);
+    RUN_TEST(test_single_unit_topics_are_unchanged);
+    return UNITY_END();
+}
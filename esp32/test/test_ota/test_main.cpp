@@ -0,0 +1,355 @@
+#include <unity.h>
+#include <string.h>
+#include <FakeBroker.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include "config.h"
+#include "ACController.h"
+#include "NetworkManager.h"
+#include "OtaServer.h"
+#include "OtaUpdater.h"
+
+static const uint32_t LOOP_STEP_MS = 10;
+
+// 100 KB e um bloco final incompleto: 26 setores de 4 KB apagados
+static const size_t IMAGE_SIZE = 100 * 1024 + 300;
+static uint8_t g_image[IMAGE_SIZE];
+
+static void makeImage(uint32_t seed) {
+    uint32_t x = seed;
+    for (size_t i = 0; i < IMAGE_SIZE; i++) {
+        x = x * 1664525u + 1013904223u;
+        g_image[i] = uint8_t(x >> 24);
+    }
+    g_image[0] = ESP_IMAGE_HEADER_MAGIC;
+}
+
+// Um boot do firmware: o que main.cpp monta, sem as filas
+struct Device {
+    ACController ac;
+    NetworkManager network;
+    OtaUpdater ota;
+
+    Device() : ac(PIN_IR_LED, PIN_DHT), network(DEVICE_ID, ac) {
+        ac.begin();
+        ota.begin();
+        network.attachOta(ota);
+        network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    }
+
+    // true quando o firmware pediria o ESP.restart()
+    bool step() {
+        network.update();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+        return ota.restartDue();
+    }
+};
+
+// Até o dispositivo pedir o reinício ou 'maxMs'
+static bool runUntilRestart(Device& device, OtaServer* server, uint32_t maxMs) {
+    for (uint32_t t = 0; t < maxMs; t += LOOP_STEP_MS) {
+        if (server) server->step();
+        if (device.step()) return true;
+    }
+    return false;
+}
+
+static void runFor(Device& device, OtaServer* server, uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t += LOOP_STEP_MS) {
+        if (server) server->step();
+        device.step();
+    }
+}
+
+static const char* reportedState() {
+    const FakeMessage* report = FakeBroker::instance().retained(MQTT_OTA_STATE_TOPIC);
+    return report ? report->text() : "";
+}
+
+static bool runningImageMatches() {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    static uint8_t flash[IMAGE_SIZE];
+    return esp_partition_read(running, 0, flash, IMAGE_SIZE) == ESP_OK
+        && memcmp(flash, g_image, IMAGE_SIZE) == 0;
+}
+
+void setUp() {
+    HostClock::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+    HostNvs::reset();
+    HostOta::reset();
+    makeImage(1);
+}
+
+void tearDown() {}
+
+void test_offer_parses_json_and_rejects_bad_sha() {
+    const char json[] = "{\"comando\":\"OTA\",\"parametros\":{\"versao\":\"1.1.0\",\"tamanho\":4096,"
+                        "\"sha256\":\"00112233445566778899aabbccddeeff00112233445566778899AABBCCDDEEFF\"}}";
+    OtaOffer offer;
+    TEST_ASSERT_EQUAL(int(CommandParseResult::OK),
+                      int(parseOtaOffer(reinterpret_cast<const uint8_t*>(json), strlen(json), offer)));
+    TEST_ASSERT_FALSE(offer.cancel);
+    TEST_ASSERT_EQUAL_UINT32(4096, offer.size);
+    TEST_ASSERT_EQUAL_STRING("1.1.0", offer.version);
+    TEST_ASSERT_EQUAL_HEX8(0x11, offer.sha256[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, offer.sha256[31]);
+    TEST_ASSERT_EQUAL_HEX32(0x00112233, otaSessionTag(offer.sha256));
+
+    const char shortSha[] = "{\"comando\":\"OTA\",\"parametros\":{\"versao\":\"1.1.0\",\"tamanho\":4096,\"sha256\":\"0011\"}}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::INVALID_PARAMETER),
+                      int(parseOtaOffer(reinterpret_cast<const uint8_t*>(shortSha), strlen(shortSha), offer)));
+    const char quoted[] = "{\"comando\":\"OTA\",\"parametros\":{\"versao\":\"1\\\"1\",\"tamanho\":1,"
+                          "\"sha256\":\"00112233445566778899aabbccddeeff00112233445566778899aabbccddeeff\"}}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::INVALID_PARAMETER),
+                      int(parseOtaOffer(reinterpret_cast<const uint8_t*>(quoted), strlen(quoted), offer)));
+    const char cancel[] = "{\"comando\":\"OTA\",\"parametros\":{\"cancelar\":true}}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::OK),
+                      int(parseOtaOffer(reinterpret_cast<const uint8_t*>(cancel), strlen(cancel), offer)));
+    TEST_ASSERT_TRUE(offer.cancel);
+}
+
+void test_chunk_header_round_trip() {
+    uint8_t packet[OTA_CHUNK_HEADER_BYTES + 3] = {0};
+    packOtaChunkHeader(0xA1B2C3D4, 258, packet);
+    const uint8_t header[] = {0xA1, 0xB2, 0xC3, 0xD4, 0x00, 0x00, 0x01, 0x02};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(header, packet, sizeof(header));
+
+    OtaChunk chunk;
+    TEST_ASSERT_TRUE(parseOtaChunk(packet, sizeof(packet), chunk));
+    TEST_ASSERT_EQUAL_HEX32(0xA1B2C3D4, chunk.session);
+    TEST_ASSERT_EQUAL_UINT32(258, chunk.index);
+    TEST_ASSERT_EQUAL(3, chunk.length);
+    // Só cabeçalho, ou dados demais
+    TEST_ASSERT_FALSE(parseOtaChunk(packet, OTA_CHUNK_HEADER_BYTES, chunk));
+    TEST_ASSERT_FALSE(parseOtaChunk(packet, OTA_CHUNK_HEADER_BYTES + OTA_CHUNK_SIZE + 1, chunk));
+}
+
+void test_transfer_verifies_and_switches_boot() {
+    Device device;
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    runFor(device, nullptr, 200);
+    TEST_ASSERT_TRUE(device.network.isConnected());
+
+    server.offer();
+    TEST_ASSERT_TRUE(runUntilRestart(device, &server, 60000));
+    TEST_ASSERT_EQUAL_STRING("REINICIANDO", server.deviceState());
+    TEST_ASSERT_EQUAL_UINT32(server.totalChunks(), server.chunksSent());
+    TEST_ASSERT_EQUAL_UINT32(0, server.chunksResent());
+    TEST_ASSERT_EQUAL_UINT32(26, HostOta::sectorsErased());
+    TEST_ASSERT_EQUAL_UINT32(0, HostOta::dirtyWrites());
+    TEST_ASSERT_NOT_NULL(strstr(reportedState(), "\"estado\":\"REINICIANDO\""));
+    // A imagem não passou pela RAM: a comparação é com a partição
+    const esp_partition_t* boot = esp_ota_get_boot_partition();
+    TEST_ASSERT_TRUE(esp_ota_get_running_partition()->address != boot->address);
+
+    HostOta::reboot();
+    TEST_ASSERT_TRUE(runningImageMatches());
+}
+
+void test_lost_chunks_are_resent_from_gap() {
+    Device device;
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    server.setLossEvery(17);
+    runFor(device, nullptr, 200);
+
+    server.offer();
+    TEST_ASSERT_TRUE(runUntilRestart(device, &server, 120000));
+    TEST_ASSERT_EQUAL_STRING("REINICIANDO", server.deviceState());
+    TEST_ASSERT_GREATER_THAN(0, server.chunksLost());
+    // Go-back-N: volta no máximo uma janela por perda
+    TEST_ASSERT_GREATER_THAN(0, server.chunksResent());
+    TEST_ASSERT_LESS_OR_EQUAL(server.chunksLost() * OTA_WINDOW_CHUNKS, server.chunksResent());
+    // Um relatório por lacuna: sem lacuna, um a cada meia janela
+    TEST_ASSERT_LESS_THAN(server.totalChunks(), server.reports());
+    TEST_ASSERT_EQUAL_UINT32(0, HostOta::dirtyWrites());
+
+    HostOta::reboot();
+    TEST_ASSERT_TRUE(runningImageMatches());
+}
+
+void test_resumes_after_broker_outage() {
+    Device device;
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    runFor(device, nullptr, 200);
+    server.offer();
+    runFor(device, &server, 200);
+    uint32_t before = device.ota.nextChunk();
+    TEST_ASSERT_GREATER_THAN(0, before);
+    TEST_ASSERT_LESS_THAN(server.totalChunks(), before);
+
+    // Os blocos enviados durante a queda se perdem; ao reconectar o
+    // relatório pede o reenvio a partir de onde o dispositivo parou
+    FakeBroker::instance().setReachable(false);
+    runFor(device, &server, 3000);
+    FakeBroker::instance().setReachable(true);
+    TEST_ASSERT_TRUE(runUntilRestart(device, &server, 120000));
+    TEST_ASSERT_EQUAL_STRING("REINICIANDO", server.deviceState());
+    TEST_ASSERT_EQUAL_UINT32(1, server.offers());
+
+    HostOta::reboot();
+    TEST_ASSERT_TRUE(runningImageMatches());
+}
+
+void test_resumes_after_device_reboot() {
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    uint32_t saved = 0;
+    {
+        Device device;
+        runFor(device, nullptr, 200);
+        server.offer();
+        // Passa de dois intervalos de progresso gravados na NVS
+        while (device.ota.nextChunk() * OTA_CHUNK_SIZE < 2 * OTA_PROGRESS_INTERVAL + 3000) {
+            server.step();
+            device.step();
+        }
+        saved = 2 * OTA_PROGRESS_INTERVAL / OTA_CHUNK_SIZE;
+    }
+    HostOta::reboot();
+    HostClock::advanceMillis(1000);
+
+    Device device;
+    // begin() refez o hash do que já estava gravado
+    TEST_ASSERT_TRUE(device.ota.receiving());
+    TEST_ASSERT_EQUAL_UINT32(saved, device.ota.nextChunk());
+    uint32_t erasedBefore = HostOta::sectorsErased();
+
+    TEST_ASSERT_TRUE(runUntilRestart(device, &server, 120000));
+    TEST_ASSERT_EQUAL_STRING("REINICIANDO", server.deviceState());
+    // Só os setores que faltavam foram apagados de novo
+    TEST_ASSERT_EQUAL_UINT32(26 - saved * OTA_CHUNK_SIZE / SPI_FLASH_SEC_SIZE,
+                             HostOta::sectorsErased() - erasedBefore);
+    TEST_ASSERT_EQUAL_UINT32(0, HostOta::dirtyWrites());
+
+    HostOta::reboot();
+    TEST_ASSERT_TRUE(runningImageMatches());
+}
+
+void test_wrong_sha_fails_without_switching_boot() {
+    Device device;
+    // O servidor anuncia o hash desta imagem mas envia outra
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    g_image[IMAGE_SIZE / 2] ^= 0x01;
+    runFor(device, nullptr, 200);
+    server.offer();
+    for (uint32_t t = 0; t < 60000 && !server.finished(); t += LOOP_STEP_MS) {
+        server.step();
+        device.step();
+    }
+    TEST_ASSERT_EQUAL_STRING("FALHA", server.deviceState());
+    TEST_ASSERT_EQUAL_STRING("SHA256", server.deviceError());
+    TEST_ASSERT_FALSE(device.ota.restartDue());
+    TEST_ASSERT_EQUAL(esp_ota_get_running_partition()->address, esp_ota_get_boot_partition()->address);
+}
+
+void test_oversize_offer_and_flash_failure_are_reported() {
+    Device device;
+    runFor(device, nullptr, 200);
+
+    OtaOffer offer = {};
+    offer.size = HOST_OTA_PARTITION_SIZE + 1;
+    strcpy(offer.version, "9.9.9");
+    device.ota.offer(offer);
+    runFor(device, nullptr, 20);
+    TEST_ASSERT_NOT_NULL(strstr(reportedState(), "\"erro\":\"TAMANHO\""));
+
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    HostOta::setWriteFailure(true);
+    server.offer();
+    for (uint32_t t = 0; t < 10000 && !server.finished(); t += LOOP_STEP_MS) {
+        server.step();
+        device.step();
+    }
+    HostOta::setWriteFailure(false);
+    TEST_ASSERT_EQUAL_STRING("FALHA", server.deviceState());
+    TEST_ASSERT_EQUAL_STRING("FLASH", server.deviceError());
+}
+
+// Transfere, reinicia na imagem nova e volta ao firmware com ela em teste
+static void installAndReboot(OtaServer& server) {
+    {
+        Device device;
+        runFor(device, nullptr, 200);
+        server.offer();
+        TEST_ASSERT_TRUE(runUntilRestart(device, &server, 60000));
+    }
+    HostOta::reboot();
+}
+
+void test_new_image_is_confirmed_on_connect() {
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    installAndReboot(server);
+
+    Device device;
+    TEST_ASSERT_EQUAL(int(OtaState::TESTING), int(device.ota.state()));
+    // Em teste não aceita outra oferta: apagaria a imagem de volta
+    server.offer();
+    runFor(device, nullptr, 200);
+    TEST_ASSERT_EQUAL(int(OtaState::CONFIRMED), int(device.ota.state()));
+    TEST_ASSERT_EQUAL_UINT32(1, HostOta::validMarks());
+    TEST_ASSERT_NOT_NULL(strstr(reportedState(), "\"estado\":\"CONFIRMADO\""));
+    TEST_ASSERT_TRUE(runningImageMatches());
+
+    // Confirmada, não há mais registro de teste no próximo boot
+    HostOta::reboot();
+    Device again;
+    TEST_ASSERT_EQUAL(int(OtaState::IDLE), int(again.ota.state()));
+}
+
+void test_rolls_back_when_never_confirmed() {
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    installAndReboot(server);
+    uint32_t updated = esp_ota_get_running_partition()->address;
+
+    // A imagem nova trava antes de conectar, boot após boot
+    FakeBroker::instance().setReachable(false);
+    bool restarted = false;
+    for (int boot = 0; boot <= OTA_BOOT_ATTEMPTS && !restarted; boot++) {
+        Device device;
+        TEST_ASSERT_EQUAL(int(boot < OTA_BOOT_ATTEMPTS ? OtaState::TESTING : OtaState::ROLLED_BACK),
+                          int(device.ota.state()));
+        restarted = runUntilRestart(device, nullptr, OTA_RESTART_DELAY + 100);
+        if (!restarted) HostOta::reboot();
+    }
+    TEST_ASSERT_TRUE(restarted);
+    HostOta::reboot();
+    TEST_ASSERT_TRUE(updated != esp_ota_get_running_partition()->address);
+
+    // De volta à imagem anterior, que relata a reversão ao conectar
+    FakeBroker::instance().setReachable(true);
+    Device device;
+    TEST_ASSERT_EQUAL(int(OtaState::ROLLED_BACK), int(device.ota.state()));
+    runFor(device, nullptr, 200);
+    TEST_ASSERT_NOT_NULL(strstr(reportedState(), "\"estado\":\"REVERTIDO\""));
+    TEST_ASSERT_EQUAL_UINT32(0, HostOta::validMarks());
+}
+
+void test_rolls_back_after_confirm_timeout() {
+    OtaServer server(DEVICE_ID, g_image, IMAGE_SIZE, "1.1.0");
+    installAndReboot(server);
+    uint32_t updated = esp_ota_get_running_partition()->address;
+
+    FakeBroker::instance().setReachable(false);
+    Device device;
+    TEST_ASSERT_FALSE(runUntilRestart(device, nullptr, OTA_CONFIRM_TIMEOUT - 1000));
+    TEST_ASSERT_TRUE(runUntilRestart(device, nullptr, 1000 + OTA_RESTART_DELAY + 100));
+    TEST_ASSERT_EQUAL(int(OtaState::ROLLED_BACK), int(device.ota.state()));
+    TEST_ASSERT_TRUE(updated != esp_ota_get_boot_partition()->address);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_offer_parses_json_and_rejects_bad_sha);
+    RUN_TEST(test_chunk_header_round_trip);
+    RUN_TEST(test_transfer_verifies_and_switches_boot);
+    RUN_TEST(test_lost_chunks_are_resent_from_gap);
+    RUN_TEST(test_resumes_after_broker_outage);
+    RUN_TEST(test_resumes_after_device_reboot);
+    RUN_TEST(test_wrong_sha_fails_without_switching_boot);
+    RUN_TEST(test_oversize_offer_and_flash_failure_are_reported);
+    RUN_TEST(test_new_image_is_confirmed_on_connect);
+    RUN_TEST(test_rolls_back_when_never_confirmed);
+    RUN_TEST(test_rolls_back_after_confirm_timeout);
+    return UNITY_END();
+}
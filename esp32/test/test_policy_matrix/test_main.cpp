@@ -0,0 +1,217 @@
+#include <unity.h>
+#include <string.h>
+#include <FakeBroker.h>
+#include <HostDht22.h>
+#include <HostIRLog.h>
+#include "config.h"
+#include "ACController.h"
+#include "IREncoder.h"
+#include "LegacyCodec.h"
+#include "MqttSchema.h"
+#include "NetworkManager.h"
+
+// Roda em cada combinação de esquema MQTT e protocolo IR (env:native e os
+// env:matriz_* do platformio.ini): os mesmos casos, com as mensagens e o
+// codificador que cada build deixou no binário.
+
+static const uint32_t LOOP_STEP_MS = 10;
+
+#if MQTT_SCHEMA == MQTT_SCHEMA_LEGACY
+static const char* const CMD_TURN_ON = "{\"acao\":\"ligar\"}";
+static const char* const CMD_TURN_OFF = "{\"acao\":\"desligar\"}";
+static const char* const CMD_SET_19 = "{\"acao\":\"set_temperatura\",\"valor\":19}";
+static const char* const STATUS_TEMP_19 = "\"temperatura\":19";
+#else
+static const char* const CMD_TURN_ON = "{\"comando\":\"LIGAR\"}";
+static const char* const CMD_TURN_OFF = "{\"comando\":\"DESLIGAR\"}";
+static const char* const CMD_SET_19 = "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":19}}";
+static const char* const STATUS_TEMP_19 = "\"temperaturaDesejada\":19";
+#endif
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    HostDht22::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+static void connect(NetworkManager& network) {
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+}
+
+static void runFor(NetworkManager& network, ACController& ac, uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += LOOP_STEP_MS) {
+        network.update();
+        ac.updateIR();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+}
+
+static const FakeMessage* lastStatus() {
+    return FakeBroker::instance().lastMessage(MQTT_STATUS_TOPIC);
+}
+
+static bool lastStatusContains(const char* text) {
+    const FakeMessage* status = lastStatus();
+    return status && strstr(status->text(), text) != nullptr;
+}
+
+void test_legacy_commands() {
+    ACCommand command;
+    const char* on = "{\"acao\":\"ligar\"}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::OK),
+                      int(parseLegacyCommand(reinterpret_cast<const uint8_t*>(on), strlen(on), command)));
+    TEST_ASSERT_EQUAL(int(ACCommandType::SET_STATE), int(command.type));
+    TEST_ASSERT_TRUE(command.settings.isOn);
+    TEST_ASSERT_EQUAL(int(ACMode::COOL), int(command.settings.mode));
+    TEST_ASSERT_EQUAL_UINT8(STATUS_FIELD_POWER | STATUS_FIELD_MODE | STATUS_FIELD_FAN_SPEED, command.fields);
+
+    const char* off = "{\"valor\":0,\"acao\":\"desligar\"}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::OK),
+                      int(parseLegacyCommand(reinterpret_cast<const uint8_t*>(off), strlen(off), command)));
+    TEST_ASSERT_EQUAL(int(ACCommandType::TURN_OFF), int(command.type));
+
+    const char* temp = "{\"acao\":\"set_temperatura\",\"valor\":21}";
+    TEST_ASSERT_EQUAL(int(CommandParseResult::OK),
+                      int(parseLegacyCommand(reinterpret_cast<const uint8_t*>(temp), strlen(temp), command)));
+    TEST_ASSERT_EQUAL(int(ACCommandType::SET_STATE), int(command.type));
+    TEST_ASSERT_EQUAL_UINT8(21, command.settings.targetTemp);
+    TEST_ASSERT_EQUAL_UINT8(STATUS_FIELD_POWER | STATUS_FIELD_TARGET_TEMP, command.fields);
+
+    struct Case {
+        const char* payload;
+        CommandParseResult result;
+    };
+    const Case rejected[] = {
+        {"{\"acao\":\"set_temperatura\"}", CommandParseResult::INVALID_PARAMETER},
+        {"{\"acao\":\"set_temperatura\",\"valor\":\"22\"}", CommandParseResult::INVALID_PARAMETER},
+        {"{\"acao\":\"set_temperatura\",\"valor\":300}", CommandParseResult::INVALID_PARAMETER},
+        {"{\"valor\":22}", CommandParseResult::MISSING_VERB},
+        {"{\"acao\":\"turbo\"}", CommandParseResult::UNKNOWN_VERB},
+        {"{\"acao\":\"ligar\"", CommandParseResult::MALFORMED},
+        {"ligar", CommandParseResult::MALFORMED},
+    };
+    for (const Case& c : rejected) {
+        TEST_ASSERT_EQUAL_MESSAGE(int(c.result),
+                                  int(parseLegacyCommand(reinterpret_cast<const uint8_t*>(c.payload),
+                                                         strlen(c.payload), command)),
+                                  c.payload);
+    }
+}
+
+void test_legacy_status() {
+    ACStatus status{};
+    status.isOn = true;
+    status.targetTemp = 22;
+    status.currentTemp = 27.5f;
+    char buffer[64];
+    size_t length = serializeLegacyStatus(status, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("{\"ligado\":true,\"temperatura\":22}", buffer);
+    TEST_ASSERT_EQUAL(strlen(buffer), length);
+    TEST_ASSERT_EQUAL(0, serializeLegacyStatus(status, buffer, 16));
+}
+
+void test_schema_round_trip() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    connect(network);
+
+    // Status ao conectar: retido só no esquema de MQTT.md
+    const FakeMessage* status = lastStatus();
+    TEST_ASSERT_NOT_NULL(status);
+    TEST_ASSERT_EQUAL(MqttSchemaPolicy::RETAIN_STATUS, FakeBroker::instance().retained(MQTT_STATUS_TOPIC) != nullptr);
+    TEST_ASSERT_TRUE(lastStatusContains("\"ligado\":false"));
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, CMD_TURN_ON);
+    runFor(network, ac, 500);
+    TEST_ASSERT_TRUE(ac.isOn());
+    TEST_ASSERT_TRUE(lastStatusContains("\"ligado\":true"));
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, CMD_SET_19);
+    runFor(network, ac, 500);
+    TEST_ASSERT_EQUAL(19, ac.getTargetTemperature());
+    TEST_ASSERT_TRUE(lastStatusContains(STATUS_TEMP_19));
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, CMD_TURN_OFF);
+    runFor(network, ac, 500);
+    TEST_ASSERT_FALSE(ac.isOn());
+    TEST_ASSERT_TRUE(lastStatusContains("\"ligado\":false"));
+
+    // Mensagem do outro esquema: rejeitada, o aparelho não muda
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"acao\":");
+    runFor(network, ac, 100);
+    const FakeMessage* error = FakeBroker::instance().lastMessage(MQTT_ERROR_TOPIC);
+    TEST_ASSERT_NOT_NULL(error);
+    TEST_ASSERT_NOT_NULL(strstr(error->text(), "\"mensagem\":\"MALFORMED\""));
+    TEST_ASSERT_FALSE(ac.isOn());
+}
+
+void test_status_heartbeat_follows_schema() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    connect(network);
+
+    // Sem mudanças, o status só sai no intervalo do esquema
+    uint64_t connectedAt = lastStatus()->timestampUs;
+    runFor(network, ac, MqttSchemaPolicy::STATUS_INTERVAL - 100);
+    TEST_ASSERT_EQUAL_UINT64(connectedAt, lastStatus()->timestampUs);
+    runFor(network, ac, 200);
+    uint64_t heartbeatAt = lastStatus()->timestampUs;
+    TEST_ASSERT_GREATER_OR_EQUAL(connectedAt + uint64_t(MqttSchemaPolicy::STATUS_INTERVAL) * 1000, heartbeatAt);
+    TEST_ASSERT_TRUE(lastStatusContains("\"ligado\":false"));
+}
+
+void test_units_follow_schema() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    connect(network);
+
+    // .../comando/1 só existe no esquema com unidades; no legado o tópico
+    // nem é assinado e a mensagem não chega
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC "/1", CMD_TURN_ON);
+    runFor(network, ac, 100);
+    TEST_ASSERT_FALSE(ac.isOn());
+    const FakeMessage* error = FakeBroker::instance().lastMessage(MQTT_ERROR_TOPIC);
+    TEST_ASSERT_EQUAL(MqttSchemaPolicy::UNITS, error != nullptr && strstr(error->text(), "UNKNOWN_UNIT") != nullptr);
+    TEST_ASSERT_NULL(FakeBroker::instance().lastMessage(MQTT_STATUS_DELTA_TOPIC));
+}
+
+void test_only_configured_encoder_is_linked() {
+    const IRProtocol configured = irProtocolFromName(AC_IR_PROTOCOL);
+    for (size_t p = 0; p < IR_PROTOCOL_COUNT; p++) {
+        IRProtocol protocol = IRProtocol(p);
+        bool linked = protocol != IRProtocol::NEC && (AC_IR_ALL_PROTOCOLS || protocol == configured);
+        TEST_ASSERT_EQUAL_MESSAGE(linked, irEncoderFor(protocol) != nullptr, irProtocolName(protocol));
+    }
+
+    // O protocolo configurado vai ao ar: um quadro NEC ou um RAW completo
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.turnOn();
+    ac.updateIR();
+    TEST_ASSERT_EQUAL_UINT32(1, HostIRLog::count());
+    const HostIRFrame* frame = HostIRLog::at(0);
+    TEST_ASSERT_EQUAL(int(configured == IRProtocol::NEC ? HostIRProtocol::NEC : HostIRProtocol::RAW),
+                      int(frame->protocol));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_legacy_commands);
+    RUN_TEST(test_legacy_status);
+    RUN_TEST(test_schema_round_trip);
+    RUN_TEST(test_status_heartbeat_follows_schema);
+    RUN_TEST(test_units_follow_schema);
+    RUN_TEST(test_only_configured_encoder_is_linked);
+    return UNITY_END();
+}
@@ -0,0 +1,443 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <FakeBroker.h>
+#include <HostDht22.h>
+#include <HostIRLog.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <driver/rmt.h>
+#include "config.h"
+#include "ACStateStore.h"
+#include "ACUnits.h"
+#include "ControlLoop.h"
+#include "InputRecorder.h"
+#include "InputRecording.h"
+#include "InputReplayer.h"
+#include "Metrics.h"
+#include "MqttTopics.h"
+#include "NetworkManager.h"
+#include "ReplayReport.h"
+#include "Scheduler.h"
+#include "SensorSampler.h"
+#include "TaskQueues.h"
+#include "TelemetryStore.h"
+
+// Domingo, 18/10/2026 00:00 em Brasília (03:00 UTC)
+static const uint64_t SUNDAY_EPOCH = 1792292400ULL;
+static const uint8_t IR_PINS[] = AC_UNIT_IR_PINS;
+static const uint32_t RUN_MS = 120000;
+static const size_t CAPACITY = 32 * 1024;
+
+// O firmware de main.cpp com o gravador ligado, no mesmo passo e na mesma
+// ordem que o InputReplayer usa: a leitura do sensor entra antes do passo de
+// controle, que vem antes do de rede (TASK_PERIOD_NETWORK)
+struct Firmware {
+    CommandQueue commandQueue;
+    SensorQueue sensorQueue;
+    StatusQueue statusQueue;
+    ACUnits<AC_UNIT_COUNT> units;
+    MultiUnitNetworkManager<AC_UNIT_COUNT> network;
+    ControlLoop control;
+    SensorSampler sensors;
+    TelemetryLog telemetryLog;
+    TelemetryStore telemetry;
+    Scheduler schedule;
+    ACStateStore stateStore;
+
+    Firmware()
+        : units(IR_PINS, PIN_DHT),
+          network(DEVICE_ID, units),
+          control(units, commandQueue, sensorQueue, statusQueue),
+          sensors(PIN_DHT, sensorQueue) {
+    }
+
+    void setup() {
+        units.begin();
+        sensors.begin();
+        stateStore.begin();
+        TEST_ASSERT_TRUE(LittleFS.begin(true));
+        TEST_ASSERT_TRUE(telemetryLog.begin(TELEMETRY_LOG_PATH, TELEMETRY_LOG_RECORDS));
+        telemetry.begin(&telemetryLog);
+        schedule.begin();
+
+        ACSettings settings[AC_UNIT_COUNT];
+        for (uint8_t i = 0; i < units.size(); i++) {
+            ACStatus status = units[i].getStatus();
+            settings[i] = ACSettings{status.isOn, status.targetTemp, status.mode, status.fanSpeed};
+        }
+        RecordingBoot boot{FIRMWARE_VERSION, DEVICE_ID, AC_IR_PROTOCOL, MQTT_SCHEMA, TASK_PERIOD_NETWORK,
+                           uint8_t(units.size()), 0, settings, &schedule.table()};
+        TEST_ASSERT_TRUE(inputRecorder.begin(RECORDER_PATH, RECORDER_PREVIOUS_PATH, CAPACITY, boot));
+
+        network.attachQueues(commandQueue, statusQueue);
+        network.attachTelemetry(telemetry);
+        network.attachScheduler(schedule);
+        network.attachStateStore(stateStore);
+        network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+        configTime(0, 0, NTP_SERVER);
+    }
+
+    void step(uint32_t ms) {
+        sensors.step();
+        if (ms % 5 == 0) control.step();
+        if (ms % TASK_PERIOD_NETWORK == 0) network.update();
+        HostClock::advanceMillis(1);
+    }
+};
+
+struct Injection {
+    uint32_t at;
+    const char* topic;
+    const char* payload;
+};
+
+// A temperatura e o modo vêm depois da agenda das 00:01 (60 s), para o
+// aparelho terminar com eles
+static const Injection COMMANDS[] = {
+    {5000, MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}"},
+    {20000, MQTT_COMMAND_TOPIC,
+     "{\"comando\":\"AGENDA\",\"parametros\":{\"versao\":3,\"fuso\":-180,\"transicoes\":["
+     "[\"0123456\",\"00:01\",true,24,\"REFRIGERAR\"]]}}"},
+    {70000, MQTT_COMMAND_TOPIC, "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":22},\"id\":\"cmd-42\"}"},
+    {80000, MQTT_COMMAND_TOPIC, "{\"comando\":\"MODO_OPERACAO\",\"parametros\":{\"modo\":\"VENTILAR\"}}"},
+    {90000, MQTT_COMMAND_TOPIC, "{\"comando\":"},
+    {100000, MQTT_COMMAND_TOPIC, "{\"comando\":\"DESLIGAR\"}"},
+};
+static const size_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+static std::vector<ReplayOutput> g_live;
+
+static void collect(const FakeMessage& message, void*) {
+    if (strcmp(message.topic, MQTT_TELEMETRY_TOPIC) == 0 || strcmp(message.topic, MQTT_DIAGNOSTICS_TOPIC) == 0) {
+        return;
+    }
+    if (strncmp(message.topic, MQTT_COMMAND_TOPIC, strlen(MQTT_COMMAND_TOPIC)) == 0) return;
+    g_live.push_back(ReplayOutput{uint32_t(millis()), message.topic,
+                                  std::string(reinterpret_cast<const char*>(message.payload), message.length)});
+}
+
+static std::vector<uint8_t> readFile(const char* path) {
+    File file = LittleFS.open(path, "r");
+    std::vector<uint8_t> bytes(file ? file.size() : 0);
+    if (file) file.read(bytes.data(), bytes.size());
+    return bytes;
+}
+
+// Dois minutos do dispositivo com comandos, uma agenda que dispara às 00:01,
+// leituras do DHT22 e uma queda do broker (sem comandos durante a volta,
+// cujo instante depende do sorteio do backoff); devolve os bytes da gravação
+static std::vector<uint8_t> recordRun() {
+    static Firmware* firmware = nullptr;
+    delete firmware;
+    firmware = new Firmware();
+    HostNtp::setEpoch(SUNDAY_EPOCH);
+    HostDht22::setReading(PIN_DHT, 27.0f, 60.0f);
+    FakeBroker::instance().setObserver(collect, nullptr);
+    firmware->setup();
+
+    size_t next = 0;
+    for (uint32_t ms = 0; ms < RUN_MS; ms++) {
+        if (next < COMMAND_COUNT && COMMANDS[next].at == ms) {
+            FakeBroker::instance().inject(COMMANDS[next].topic, COMMANDS[next].payload);
+            next++;
+        }
+        if (ms == 30000) HostDht22::setReading(PIN_DHT, 24.5f, 52.0f);
+        if (ms == 40000) FakeBroker::instance().setReachable(false);
+        if (ms == 50000) FakeBroker::instance().setReachable(true);
+        firmware->step(ms);
+    }
+    inputRecorder.flush();
+    FakeBroker::instance().setObserver(nullptr, nullptr);
+    std::vector<uint8_t> recording = readFile(RECORDER_PATH);
+    inputRecorder.end();
+    return recording;
+}
+
+static std::vector<ReplayOutput> answers(const ReplayReport& report) {
+    std::vector<ReplayOutput> outputs;
+    for (const ReplayOutput& output : report.outputs) {
+        if (output.topic == MQTT_TELEMETRY_TOPIC || output.topic == MQTT_DIAGNOSTICS_TOPIC) continue;
+        outputs.push_back(output);
+    }
+    return outputs;
+}
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    HostDht22::reset();
+    HostNvs::reset();
+    HostFlash::reset();
+    HostNtp::reset();
+    hostRmtReset();
+    Metrics::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+    g_live.clear();
+}
+
+void tearDown() {}
+
+void test_recording_reads_back_every_event() {
+    std::vector<uint8_t> recording = recordRun();
+    TEST_ASSERT_GREATER_THAN(RECORDING_HEADER_BYTES, recording.size());
+    TEST_ASSERT_LESS_THAN(CAPACITY, recording.size());
+
+    RecordingReader reader(recording.data(), recording.size());
+    TEST_ASSERT_TRUE(reader.valid());
+    RecordedInput input;
+    RecordedBoot boot;
+    TEST_ASSERT_TRUE(reader.next(input));
+    TEST_ASSERT_TRUE(readRecordedBoot(input, boot));
+    TEST_ASSERT_EQUAL_STRING(DEVICE_ID, boot.deviceId);
+    TEST_ASSERT_EQUAL_STRING(FIRMWARE_VERSION, boot.firmwareVersion);
+    TEST_ASSERT_EQUAL(AC_UNIT_COUNT, boot.unitCount);
+    TEST_ASSERT_EQUAL(TASK_PERIOD_NETWORK, boot.loopPeriodMs);
+
+    uint32_t counts[uint8_t(RecordedEvent::LOST) + 1] = {};
+    uint32_t lastAt = input.at;
+    while (reader.next(input)) {
+        TEST_ASSERT_TRUE(input.at >= lastAt);
+        lastAt = input.at;
+        counts[uint8_t(input.type)]++;
+        if (input.type == RecordedEvent::CLOCK) {
+            TEST_ASSERT_UINT32_WITHIN(RUN_MS / 1000 + 60, uint32_t(SUNDAY_EPOCH), input.value);
+        }
+    }
+    TEST_ASSERT_FALSE(reader.truncated());
+    TEST_ASSERT_EQUAL(recording.size(), reader.offset());
+    TEST_ASSERT_EQUAL(COMMAND_COUNT, counts[uint8_t(RecordedEvent::MESSAGE)]);
+    TEST_ASSERT_GREATER_THAN(0, counts[uint8_t(RecordedEvent::SENSOR)]);
+    // A mesma leitura repetida sai no formato curto
+    TEST_ASSERT_GREATER_THAN(counts[uint8_t(RecordedEvent::SENSOR)], counts[uint8_t(RecordedEvent::SENSOR_REPEAT)]);
+    // WiFi no ar e a queda do broker; a volta do broker é o SOCKET aberto
+    TEST_ASSERT_GREATER_THAN(1, counts[uint8_t(RecordedEvent::LINK)]);
+    TEST_ASSERT_GREATER_THAN(1, counts[uint8_t(RecordedEvent::SOCKET)]);
+    TEST_ASSERT_GREATER_THAN(0, counts[uint8_t(RecordedEvent::RANDOM)]);
+    TEST_ASSERT_GREATER_THAN(0, counts[uint8_t(RecordedEvent::CLOCK)]);
+}
+
+// Uma gravação cortada no meio de um evento para nele, sem ler além
+void test_truncated_recording_stops_at_the_last_whole_event() {
+    std::vector<uint8_t> recording = recordRun();
+    RecordingReader whole(recording.data(), recording.size());
+    RecordedInput input;
+    uint32_t events = 0;
+    while (whole.next(input)) events++;
+
+    RecordingReader cut(recording.data(), recording.size() - 1);
+    uint32_t read = 0;
+    while (cut.next(input)) read++;
+    TEST_ASSERT_TRUE(cut.truncated());
+    TEST_ASSERT_EQUAL(events - 1, read);
+
+    InputReplayer replayer;
+    TEST_ASSERT_TRUE(replayer.run(recording.data(), recording.size() - 1));
+    TEST_ASSERT_TRUE(replayer.report().truncated);
+
+    const uint8_t garbage[] = {'G', 'R', 'V', '2', 1, 0, 0, 0};
+    TEST_ASSERT_FALSE(replayer.run(garbage, sizeof(garbage)));
+    TEST_ASSERT_TRUE(replayer.error().size() > 0);
+}
+
+// A reprodução dá as mesmas respostas, na mesma ordem e no mesmo instante,
+// que o dispositivo deu quando gravou
+void test_replay_reproduces_the_recorded_run() {
+    std::vector<uint8_t> recording = recordRun();
+    std::vector<ReplayOutput> live = g_live;
+    TEST_ASSERT_GREATER_THAN(COMMAND_COUNT, live.size());
+
+    InputReplayer replayer;
+    TEST_ASSERT_TRUE_MESSAGE(replayer.run(recording.data(), recording.size()), replayer.error().c_str());
+    const ReplayReport& report = replayer.report();
+    TEST_ASSERT_EQUAL_STRING(DEVICE_ID, report.deviceId.c_str());
+    TEST_ASSERT_EQUAL_STRING(FIRMWARE_VERSION, report.firmware.c_str());
+    TEST_ASSERT_EQUAL(0, report.lost);
+
+    std::vector<ReplayOutput> replayed = answers(report);
+    TEST_ASSERT_EQUAL(live.size(), replayed.size());
+    for (size_t i = 0; i < live.size(); i++) {
+        TEST_ASSERT_EQUAL_STRING(live[i].topic.c_str(), replayed[i].topic.c_str());
+        TEST_ASSERT_EQUAL_STRING(live[i].payload.c_str(), replayed[i].payload.c_str());
+        TEST_ASSERT_EQUAL(live[i].at, replayed[i].at);
+    }
+
+    // Os comandos que mudam o estado valeram na reprodução: cmd-42 aplicado
+    // e o último status com 22 graus em VENTILAR
+    MqttTopics topics(DEVICE_ID);
+    const ReplayOutput* ack = nullptr;
+    const ReplayOutput* status = nullptr;
+    for (const ReplayOutput& output : replayed) {
+        if (output.topic == topics.ack && output.payload.find("\"id\":\"cmd-42\"") != std::string::npos) ack = &output;
+        if (output.topic == MQTT_STATUS_TOPIC) status = &output;
+    }
+    TEST_ASSERT_NOT_NULL(ack);
+    TEST_ASSERT_TRUE(ack->payload.find("\"resultado\":\"OK\"") != std::string::npos);
+    TEST_ASSERT_NOT_NULL(status);
+    TEST_ASSERT_TRUE(status->payload.find("\"temperaturaDesejada\":22") != std::string::npos);
+    TEST_ASSERT_TRUE(status->payload.find("\"modoOperacao\":\"VENTILAR\"") != std::string::npos);
+
+    TEST_ASSERT_EQUAL(COMMAND_COUNT, report.commands.size());
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        const ReplayCommand& command = report.commands[i];
+        TEST_ASSERT_EQUAL_STRING("-", command.suffix.c_str());
+        // Nenhum comando caiu na queda do broker (40 s a 50 s): todos respondem
+        TEST_ASSERT_LESS_OR_EQUAL(2 * TASK_PERIOD_NETWORK, command.latencyMs);
+        TEST_ASSERT_GREATER_THAN(0, command.cpuNs);
+    }
+    TEST_ASSERT_GREATER_THAN(RUN_MS / TASK_PERIOD_NETWORK / 2, report.steps);
+    TEST_ASSERT_LESS_OR_EQUAL(report.stepMaxNs, report.stepP99Ns);
+}
+
+// Duas reproduções iguais: nada de diferença fora da CPU
+void test_replay_is_deterministic() {
+    std::vector<uint8_t> recording = recordRun();
+    InputReplayer first;
+    InputReplayer second;
+    TEST_ASSERT_TRUE(first.run(recording.data(), recording.size()));
+    TEST_ASSERT_TRUE(second.run(recording.data(), recording.size()));
+
+    ReplayTolerance tolerance;
+    tolerance.cpuFloorNs = UINT64_MAX;
+    ReplayDiff diff = compareReplayReports(first.report(), second.report(), tolerance, nullptr);
+    TEST_ASSERT_FALSE(diff.any());
+    TEST_ASSERT_EQUAL(first.report().outputs.size(), second.report().outputs.size());
+    TEST_ASSERT_EQUAL(first.report().durationMs, second.report().durationMs);
+}
+
+static ReplayReport throughText(const ReplayReport& report) {
+    FILE* file = tmpfile();
+    writeReplayReport(file, report);
+    rewind(file);
+    ReplayReport read;
+    std::string error;
+    TEST_ASSERT_TRUE_MESSAGE(readReplayReport(file, read, error), error.c_str());
+    fclose(file);
+    return read;
+}
+
+void test_report_round_trips_through_text() {
+    std::vector<uint8_t> recording = recordRun();
+    InputReplayer replayer;
+    TEST_ASSERT_TRUE(replayer.run(recording.data(), recording.size()));
+    const ReplayReport& report = replayer.report();
+    ReplayReport read = throughText(report);
+
+    TEST_ASSERT_EQUAL_STRING(report.recordedFirmware.c_str(), read.recordedFirmware.c_str());
+    TEST_ASSERT_EQUAL_STRING(report.irProtocol.c_str(), read.irProtocol.c_str());
+    TEST_ASSERT_EQUAL(report.events, read.events);
+    TEST_ASSERT_EQUAL(report.durationMs, read.durationMs);
+    TEST_ASSERT_EQUAL(report.outputs.size(), read.outputs.size());
+    TEST_ASSERT_EQUAL(report.commands.size(), read.commands.size());
+    TEST_ASSERT_EQUAL_UINT64(report.stepP99Ns, read.stepP99Ns);
+    ReplayTolerance tolerance;
+    TEST_ASSERT_FALSE(compareReplayReports(report, read, tolerance, nullptr).any());
+}
+
+// Uma versão que responde diferente, mais tarde ou gastando mais CPU
+void test_compare_flags_regressions() {
+    ReplayReport base;
+    base.outputs = {{100, "a", "{\"x\":1}"}, {200, "b", "{\"y\":2}"}, {300, "c", "{\"z\":3}"}};
+    base.commands = {{90, "-", 10, 100000}, {290, "-", 10, 100000}};
+    base.stepP99Ns = 50000;
+
+    ReplayTolerance tolerance;
+    TEST_ASSERT_FALSE(compareReplayReports(base, base, tolerance, nullptr).any());
+
+    ReplayReport current = base;
+    current.outputs[1].payload = "{\"y\":3}";
+    ReplayDiff diff = compareReplayReports(base, current, tolerance, nullptr);
+    TEST_ASSERT_EQUAL(1, diff.missing);
+    TEST_ASSERT_EQUAL(1, diff.extra);
+
+    current = base;
+    current.outputs.insert(current.outputs.begin() + 1, ReplayOutput{150, "d", "{}"});
+    current.outputs[3].at = 310;
+    current.commands[1].latencyMs = 20;
+    diff = compareReplayReports(base, current, tolerance, nullptr);
+    TEST_ASSERT_EQUAL(0, diff.missing);
+    TEST_ASSERT_EQUAL(1, diff.extra);
+    TEST_ASSERT_EQUAL(1, diff.shifted);
+    TEST_ASSERT_EQUAL(1, diff.slower);
+    TEST_ASSERT_EQUAL(0, diff.cpu);
+
+    current = base;
+    current.commands[0].cpuNs = 110000;     // dentro da tolerância
+    current.commands[1].cpuNs = 200000;
+    current.stepP99Ns = 60000;              // abaixo do piso
+    diff = compareReplayReports(base, current, tolerance, nullptr);
+    TEST_ASSERT_EQUAL(1, diff.cpu);
+    current.stepP99Ns = 90000;
+    diff = compareReplayReports(base, current, tolerance, nullptr);
+    TEST_ASSERT_EQUAL(2, diff.cpu);
+
+    current = base;
+    current.commands[0].latencyMs = ReplayCommand::NO_ANSWER;
+    diff = compareReplayReports(base, current, tolerance, nullptr);
+    TEST_ASSERT_EQUAL(1, diff.slower);
+}
+
+// O envio em blocos remonta o arquivo inteiro, com o cabeçalho de offset e total
+void test_upload_chunks_reassemble_the_file() {
+    std::vector<uint8_t> recording = recordRun();
+    static Firmware* firmware = nullptr;
+    delete firmware;
+    firmware = new Firmware();
+    firmware->setup();
+    TEST_ASSERT_TRUE(inputRecorder.requestUpload(true));
+
+    std::vector<uint8_t> assembled;
+    size_t length = 0;
+    while (inputRecorder.uploadDue()) {
+        const uint8_t* chunk = inputRecorder.uploadChunk(length);
+        TEST_ASSERT_NOT_NULL(chunk);
+        TEST_ASSERT_LESS_OR_EQUAL(InputRecorder::CHUNK_BYTES, length);
+        uint32_t offset = uint32_t(chunk[0]) | uint32_t(chunk[1]) << 8 | uint32_t(chunk[2]) << 16
+                          | uint32_t(chunk[3]) << 24;
+        uint32_t total = uint32_t(chunk[4]) | uint32_t(chunk[5]) << 8 | uint32_t(chunk[6]) << 16
+                         | uint32_t(chunk[7]) << 24;
+        TEST_ASSERT_EQUAL(assembled.size(), offset);
+        TEST_ASSERT_EQUAL(recording.size(), total);
+        assembled.insert(assembled.end(), chunk + InputRecorder::CHUNK_HEADER_BYTES, chunk + length);
+        inputRecorder.chunkSent();
+    }
+    TEST_ASSERT_EQUAL(recording.size(), assembled.size());
+    TEST_ASSERT_EQUAL_MEMORY(recording.data(), assembled.data(), recording.size());
+    inputRecorder.end();
+}
+
+// O comando GRAVACAO manda a gravação pelo tópico .../gravacao
+void test_upload_command_publishes_chunks() {
+    recordRun();
+    static Firmware* firmware = nullptr;
+    delete firmware;
+    firmware = new Firmware();
+    firmware->setup();
+    for (uint32_t ms = 0; ms < 2000; ms++) firmware->step(ms);
+
+    uint32_t before = FakeBroker::instance().publishCount();
+    TEST_ASSERT_TRUE(FakeBroker::instance().inject(MQTT_COMMAND_TOPIC,
+                                                   "{\"comando\":\"GRAVACAO\",\"parametros\":{\"anterior\":true}}"));
+    for (uint32_t ms = 0; ms < 2000; ms++) firmware->step(ms);
+    TEST_ASSERT_GREATER_THAN(before + 1, FakeBroker::instance().publishCount());
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().lastMessage(MQTT_RECORDING_TOPIC));
+    TEST_ASSERT_FALSE(inputRecorder.uploadDue());
+    inputRecorder.end();
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_recording_reads_back_every_event);
+    RUN_TEST(test_truncated_recording_stops_at_the_last_whole_event);
+    RUN_TEST(test_replay_reproduces_the_recorded_run);
+    RUN_TEST(test_replay_is_deterministic);
+    RUN_TEST(test_report_round_trips_through_text);
+    RUN_TEST(test_compare_flags_regressions);
+    RUN_TEST(test_upload_chunks_reassemble_the_file);
+    RUN_TEST(test_upload_command_publishes_chunks);
+    return UNITY_END();
+}
@@ -0,0 +1,447 @@
+#include <unity.h>
+#include <stdio.h>
+#include <FakeBroker.h>
+#include <HostAlloc.h>
+#include <HostDht22.h>
+#include <HostIRLog.h>
+#include <Preferences.h>
+#include "config.h"
+#include "ACController.h"
+#include "CommandCodec.h"
+#include "NetworkManager.h"
+#include "ScheduleCodec.h"
+#include "Scheduler.h"
+
+// Domingo, 18/10/2026 00:00 em Brasília (03:00 UTC)
+static const uint64_t SUNDAY_EPOCH = 1792292400ULL;
+static const uint32_t SUNDAY_UTC_MINUTE = uint32_t(SUNDAY_EPOCH / 60);
+static const int16_t BRASILIA = -180;
+
+static const uint32_t LOOP_STEP_MS = 200;
+
+// Aula de segunda a sexta com intervalo de almoço; sábado de manhã só ventila
+static const char* const CLASSROOM_SCHEDULE =
+    "{\"comando\":\"AGENDA\",\"parametros\":{\"versao\":7,\"fuso\":-180,\"transicoes\":["
+    "[\"12345\",\"07:00\",true,23,\"REFRIGERAR\"],"
+    "[\"12345\",\"12:00\",false],"
+    "[\"12345\",\"13:30\",true,24],"
+    "[\"12345\",\"18:00\",false],"
+    "[\"6\",\"08:00\",true,25,\"VENTILAR\",\"BAIXA\"],"
+    "[\"6\",\"10:00\",false]"
+    "]}}";
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    HostDht22::reset();
+    HostNtp::reset();
+    HostNvs::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+static CommandParseResult parse(const char* json, ScheduleTable& table) {
+    return parseScheduleJson(reinterpret_cast<const uint8_t*>(json), strlen(json), table);
+}
+
+static uint16_t at(uint8_t day, uint8_t hour, uint8_t minute) {
+    return uint16_t(day * MINUTES_PER_DAY + hour * 60 + minute);
+}
+
+void test_parse_compiles_sorted_week() {
+    ScheduleTable table;
+    TEST_ASSERT_EQUAL(CommandParseResult::OK, parse(CLASSROOM_SCHEDULE, table));
+    TEST_ASSERT_EQUAL_UINT32(7, table.version);
+    TEST_ASSERT_EQUAL(BRASILIA, table.utcOffset);
+    TEST_ASSERT_TRUE(table.enabled);
+    TEST_ASSERT_EQUAL(22, table.count);
+    for (size_t i = 1; i < table.count; i++) {
+        TEST_ASSERT_TRUE(table.transitions[i - 1].minute < table.transitions[i].minute);
+    }
+    TEST_ASSERT_EQUAL(at(1, 7, 0), table.transitions[0].minute);
+    TEST_ASSERT_EQUAL(at(6, 10, 0), table.transitions[21].minute);
+
+    ACCommand on = table.transitions[0].command();
+    TEST_ASSERT_EQUAL(ACCommandType::SET_STATE, on.type);
+    TEST_ASSERT_EQUAL(STATUS_FIELD_POWER | STATUS_FIELD_TARGET_TEMP | STATUS_FIELD_MODE, on.fields);
+    TEST_ASSERT_TRUE(on.settings.isOn);
+    TEST_ASSERT_EQUAL(23, on.settings.targetTemp);
+    TEST_ASSERT_EQUAL(ACMode::COOL, on.settings.mode);
+
+    ACCommand off = table.transitions[1].command();
+    TEST_ASSERT_EQUAL(STATUS_FIELD_POWER, off.fields);
+    TEST_ASSERT_FALSE(off.settings.isOn);
+
+    ACCommand saturday = table.transitions[20].command();
+    TEST_ASSERT_EQUAL(ACMode::FAN, saturday.settings.mode);
+    TEST_ASSERT_EQUAL(FanSpeed::SLOW, saturday.settings.fanSpeed);
+    TEST_ASSERT_TRUE(saturday.fields & STATUS_FIELD_FAN_SPEED);
+
+    // No mesmo minuto o item posterior substitui o anterior
+    TEST_ASSERT_EQUAL(CommandParseResult::OK,
+                      parse("{\"parametros\":{\"versao\":1,\"transicoes\":[[\"0123456\",\"08:00\",true],"
+                            "[\"3\",\"08:00\",null,20]]}}", table));
+    TEST_ASSERT_EQUAL(7, table.count);
+    TEST_ASSERT_EQUAL(0, table.utcOffset);
+    ACCommand replaced = table.transitions[3].command();
+    TEST_ASSERT_EQUAL(STATUS_FIELD_TARGET_TEMP, replaced.fields);
+
+    // O verbo passa pelo parser de comandos sem carregar a tabela
+    ACCommand command;
+    TEST_ASSERT_EQUAL(CommandParseResult::OK,
+                      parseCommandJson(reinterpret_cast<const uint8_t*>(CLASSROOM_SCHEDULE),
+                                       strlen(CLASSROOM_SCHEDULE), command));
+    TEST_ASSERT_EQUAL(ACCommandType::SET_SCHEDULE, command.type);
+}
+
+void test_parse_rejects_invalid_schedules() {
+    ScheduleTable table;
+    const char* invalid[] = {
+        "{\"parametros\":{\"transicoes\":[]}}",                                        // sem versão
+        "{\"parametros\":{\"versao\":1}}",                                             // sem transições
+        "{\"parametros\":{\"versao\":0,\"transicoes\":[]}}",
+        "{\"parametros\":{\"versao\":1,\"fuso\":900,\"transicoes\":[]}}",
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[\"7\",\"08:00\",true]]}}",     // dia 7
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[\"\",\"08:00\",true]]}}",
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[\"1\",\"24:00\",true]]}}",
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[\"1\",\"8:00\",true]]}}",
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[\"1\",\"08:00\",true,31]]}}",
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[\"1\",\"08:00\",true,24,\"GELAR\"]]}}",
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[\"1\",\"08:00\"]]}}",            // não muda nada
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[\"1\",\"08:00\",true,24,null,null,1]]}}",
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[[1,\"08:00\",true]]}}",
+        "{\"parametros\":{\"versao\":1,\"transicoes\":[\"1\"]}}",
+    };
+    for (const char* json : invalid) {
+        TEST_ASSERT_EQUAL_MESSAGE(CommandParseResult::INVALID_PARAMETER, parse(json, table), json);
+    }
+    TEST_ASSERT_EQUAL(CommandParseResult::MALFORMED,
+                      parse("{\"parametros\":{\"versao\":1,\"transicoes\":[[\"1\",\"08:00\",true,]]}}", table));
+    TEST_ASSERT_EQUAL(CommandParseResult::MALFORMED,
+                      parse("{\"parametros\":{\"versao\":1,\"transicoes\":[[\"1\" \"08:00\"]]}}", table));
+
+    // Mais de SCHEDULE_MAX_TRANSITIONS depois de expandir os dias
+    char json[1024];
+    size_t n = snprintf(json, sizeof(json), "{\"parametros\":{\"versao\":1,\"transicoes\":[");
+    for (int hour = 0; hour < 10; hour++) {
+        n += snprintf(json + n, sizeof(json) - n, "%s[\"0123456\",\"%02d:00\",true]", hour ? "," : "", hour);
+    }
+    snprintf(json + n, sizeof(json) - n, "]}}");
+    TEST_ASSERT_EQUAL(CommandParseResult::INVALID_PARAMETER, parse(json, table));
+}
+
+void test_blob_round_trip_and_validation() {
+    ScheduleTable table;
+    TEST_ASSERT_EQUAL(CommandParseResult::OK, parse(CLASSROOM_SCHEDULE, table));
+    uint8_t blob[SCHEDULE_BLOB_CAPACITY];
+    size_t length = packScheduleTable(table, blob);
+    TEST_ASSERT_EQUAL(SCHEDULE_BLOB_HEADER_BYTES + 4 * 22, length);
+
+    ScheduleTable copy;
+    TEST_ASSERT_TRUE(unpackScheduleTable(blob, length, copy));
+    TEST_ASSERT_EQUAL_UINT32(table.version, copy.version);
+    TEST_ASSERT_EQUAL(table.utcOffset, copy.utcOffset);
+    TEST_ASSERT_EQUAL(table.count, copy.count);
+    TEST_ASSERT_EQUAL_MEMORY(table.transitions, copy.transitions, table.count * sizeof(ScheduleTransition));
+
+    TEST_ASSERT_FALSE(unpackScheduleTable(blob, length - 1, copy));
+    blob[SCHEDULE_BLOB_HEADER_BYTES + 4] = 0;       // 2ª transição antes da 1ª
+    blob[SCHEDULE_BLOB_HEADER_BYTES + 5] = 0;
+    TEST_ASSERT_FALSE(unpackScheduleTable(blob, length, copy));
+    blob[0] = SCHEDULE_BLOB_FORMAT + 1;
+    TEST_ASSERT_FALSE(unpackScheduleTable(blob, length, copy));
+}
+
+void test_utc_minutes_follows_calendar() {
+    struct tm time {};
+    time.tm_year = 2026 - 1900;
+    time.tm_mon = 9;
+    time.tm_mday = 18;
+    time.tm_hour = 3;
+    TEST_ASSERT_EQUAL_UINT32(SUNDAY_UTC_MINUTE, Scheduler::utcMinutes(time));
+
+    time.tm_year = 2024 - 1900;     // 29/02/2024 12:34
+    time.tm_mon = 1;
+    time.tm_mday = 29;
+    time.tm_hour = 12;
+    time.tm_min = 34;
+    TEST_ASSERT_EQUAL_UINT32(28486834, Scheduler::utcMinutes(time));
+
+    time.tm_year = 2000 - 1900;     // 01/03/2000 00:00 (ano bissexto secular)
+    time.tm_mon = 2;
+    time.tm_mday = 1;
+    time.tm_hour = 0;
+    time.tm_min = 0;
+    TEST_ASSERT_EQUAL_UINT32(15864480, Scheduler::utcMinutes(time));
+}
+
+void test_fires_each_transition_once_and_catches_up() {
+    ScheduleTable table;
+    TEST_ASSERT_EQUAL(CommandParseResult::OK, parse(CLASSROOM_SCHEDULE, table));
+    Scheduler scheduler;
+    scheduler.begin();
+    scheduler.install(table);
+
+    // Domingo 10:00: alcança a última transição, a de sábado 10:00 (volta da semana)
+    ACCommand command;
+    uint32_t sunday = SUNDAY_UTC_MINUTE;
+    TEST_ASSERT_TRUE(scheduler.pollAt(sunday + 600, command));
+    TEST_ASSERT_EQUAL(STATUS_FIELD_POWER, command.fields);
+    TEST_ASSERT_FALSE(command.settings.isOn);
+    TEST_ASSERT_EQUAL_UINT32(SUNDAY_UTC_MINUTE + BRASILIA + at(1, 7, 0), scheduler.nextTransition());
+
+    // Uma semana minuto a minuto: cada transição dispara uma vez, no seu minuto
+    uint32_t fired = 0;
+    uint32_t misplaced = 0;
+    for (uint32_t minute = 601; minute < 601 + MINUTES_PER_WEEK; minute++) {
+        if (scheduler.pollAt(sunday + minute, command)) {
+            fired++;
+            bool found = false;
+            for (size_t i = 0; i < table.count; i++) {
+                found |= table.transitions[i].minute == minute % MINUTES_PER_WEEK;
+            }
+            if (!found) misplaced++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(22, fired);
+    TEST_ASSERT_EQUAL_UINT32(0, misplaced);
+
+    // Relógio salta de segunda 06:00 para 15:00: só a última vencida (13:30)
+    uint32_t monday = sunday + MINUTES_PER_WEEK * 2 + MINUTES_PER_DAY;
+    scheduler.pollAt(monday + 360, command);
+    TEST_ASSERT_TRUE(scheduler.pollAt(monday + 900, command));
+    TEST_ASSERT_TRUE(command.settings.isOn);
+    TEST_ASSERT_EQUAL(24, command.settings.targetTemp);
+
+    // Relógio volta para 11:00: não reaplica nada, mas 12:00 dispara de novo
+    TEST_ASSERT_FALSE(scheduler.pollAt(monday + 660, command));
+    TEST_ASSERT_FALSE(scheduler.pollAt(monday + 719, command));
+    TEST_ASSERT_TRUE(scheduler.pollAt(monday + 720, command));
+    TEST_ASSERT_FALSE(command.settings.isOn);
+
+    // Agenda desativada não dispara
+    table.enabled = false;
+    scheduler.install(table);
+    TEST_ASSERT_FALSE(scheduler.pollAt(monday + 1080, command));
+}
+
+void test_table_persists_in_nvs() {
+    ScheduleTable table;
+    TEST_ASSERT_EQUAL(CommandParseResult::OK, parse(CLASSROOM_SCHEDULE, table));
+    {
+        Scheduler scheduler;
+        scheduler.begin();
+        TEST_ASSERT_EQUAL_UINT32(0, scheduler.table().version);
+        TEST_ASSERT_TRUE(scheduler.install(table));
+        // A mesma agenda de novo não regrava a flash
+        TEST_ASSERT_TRUE(scheduler.install(table));
+        TEST_ASSERT_EQUAL_UINT32(1, HostNvs::writeCalls());
+        TEST_ASSERT_EQUAL_UINT64(SCHEDULE_BLOB_HEADER_BYTES + 4 * 22, HostNvs::bytesWritten());
+    }
+
+    // "Reboot": a agenda volta da NVS
+    Scheduler rebooted;
+    rebooted.begin();
+    TEST_ASSERT_EQUAL_UINT32(7, rebooted.table().version);
+    TEST_ASSERT_EQUAL(22, rebooted.table().count);
+    TEST_ASSERT_EQUAL_MEMORY(table.transitions, rebooted.table().transitions, 22 * sizeof(ScheduleTransition));
+
+    // Blob estragado é ignorado
+    Preferences nvs;
+    nvs.begin(SCHEDULE_NVS_NAMESPACE);
+    uint8_t garbage[12] = {SCHEDULE_BLOB_FORMAT, 9};
+    nvs.putBytes("tabela", garbage, sizeof(garbage));
+    nvs.end();
+    rebooted.begin();
+    TEST_ASSERT_EQUAL_UINT32(0, rebooted.table().version);
+    TEST_ASSERT_FALSE(rebooted.active());
+}
+
+// O aparelho visto pelo IR (códigos NEC do config.h)
+struct Unit {
+    bool on;
+    uint32_t seen;
+
+    void receive() {
+        while (seen < HostIRLog::count()) {
+            const HostIRFrame* frame = HostIRLog::at(seen++);
+            if (!frame || frame->protocol != HostIRProtocol::NEC) continue;
+            if (frame->data == IRCodes::POWER_ON) on = true;
+            if (frame->data == IRCodes::POWER_OFF) on = false;
+        }
+    }
+};
+
+// Dispositivo completo sobre o relógio virtual: rede, agenda, controlador e
+// o aparelho do outro lado do IR
+struct Device {
+    ACController ac;
+    NetworkManager network;
+    Scheduler scheduler;
+    Unit unit;
+    uint64_t weekStartMs;
+    uint32_t switches;
+    uint32_t worstDelayMs;      // da virada do minuto até o aparelho mudar
+
+    Device() : ac(PIN_IR_LED, PIN_DHT), network(DEVICE_ID, ac), unit{false, 0},
+               weekStartMs(0), switches(0), worstDelayMs(0) {}
+
+    void start() {
+        HostNtp::setEpoch(SUNDAY_EPOCH);
+        weekStartMs = HostClock::nowMicros() / 1000;
+        ac.begin();
+        scheduler.begin();
+        network.attachScheduler(scheduler);
+        network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+        configTime(0, 0, NTP_SERVER);
+        for (int step = 0; step < 8 && !network.isConnected(); step++) {
+            network.update();
+        }
+    }
+
+    // Avança até o minuto da semana (hora local), no passo do loop
+    void runUntil(uint16_t minuteOfWeek, uint32_t extraMs = 0) {
+        uint64_t target = weekStartMs + uint64_t(minuteOfWeek) * 60000 + extraMs;
+        while (HostClock::nowMicros() / 1000 < target) {
+            HostClock::advanceMillis(LOOP_STEP_MS);
+            HostDht22::setReading(PIN_DHT, 25.0f, 50.0f);
+            network.update();
+            ac.update();
+            bool was = unit.on;
+            unit.receive();
+            if (unit.on != was) {
+                switches++;
+                uint32_t delay = uint32_t((HostClock::nowMicros() / 1000 - weekStartMs) % 60000);
+                if (delay > worstDelayMs) worstDelayMs = delay;
+            }
+        }
+    }
+};
+
+void test_week_fast_forward_with_outage_and_manual_override() {
+    Device device;
+    device.start();
+    TEST_ASSERT_TRUE(device.network.isConnected());
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, CLASSROOM_SCHEDULE);
+    device.runUntil(0, 2000);
+    const FakeMessage* status = FakeBroker::instance().retained(MQTT_STATUS_TOPIC);
+    TEST_ASSERT_NOT_NULL(status);
+    TEST_ASSERT_NOT_NULL(strstr(status->text(), "\"agenda\":{\"versao\":7,\"ativa\":true"));
+
+    // Segunda: aula das 07:00 às 12:00 e das 13:30 às 18:00
+    device.runUntil(at(1, 6, 59));
+    TEST_ASSERT_FALSE(device.unit.on);
+    device.runUntil(at(1, 7, 0), 5000);
+    TEST_ASSERT_TRUE(device.unit.on);
+    TEST_ASSERT_EQUAL(23, device.ac.getTargetTemperature());
+    TEST_ASSERT_EQUAL(ACMode::COOL, device.ac.getMode());
+    device.runUntil(at(1, 12, 0), 5000);
+    TEST_ASSERT_FALSE(device.unit.on);
+    device.runUntil(at(1, 13, 30), 5000);
+    TEST_ASSERT_TRUE(device.unit.on);
+    TEST_ASSERT_EQUAL(24, device.ac.getTargetTemperature());
+
+    // Terça: ligado à mão no almoço e setpoint trocado à tarde. Cada ordem
+    // manual vale até a próxima transição, que não reaplica as anteriores.
+    device.runUntil(at(2, 12, 30));
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}");
+    device.runUntil(at(2, 12, 31));
+    TEST_ASSERT_TRUE(device.unit.on);
+    device.runUntil(at(2, 13, 29));
+    TEST_ASSERT_TRUE(device.unit.on);
+    device.runUntil(at(2, 14, 0));
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC,
+                                  "{\"comando\":\"TEMPERATURA\",\"parametros\":{\"temperatura\":20}}");
+    device.runUntil(at(2, 17, 59));
+    TEST_ASSERT_TRUE(device.unit.on);
+    TEST_ASSERT_EQUAL(20, device.ac.getTargetTemperature());
+    device.runUntil(at(2, 18, 0), 5000);
+    TEST_ASSERT_FALSE(device.unit.on);
+
+    // Quarta: broker e NTP fora das 06:00 às 14:00; a agenda segue no relógio local
+    device.runUntil(at(3, 6, 0));
+    FakeBroker::instance().setReachable(false);
+    HostNtp::setReachable(false);
+    device.runUntil(at(3, 7, 0), 5000);
+    TEST_ASSERT_FALSE(device.network.isConnected());
+    TEST_ASSERT_TRUE(device.unit.on);
+    TEST_ASSERT_EQUAL(23, device.ac.getTargetTemperature());
+    device.runUntil(at(3, 12, 0), 5000);
+    TEST_ASSERT_FALSE(device.unit.on);
+    device.runUntil(at(3, 13, 30), 5000);
+    TEST_ASSERT_TRUE(device.unit.on);
+    device.runUntil(at(3, 14, 0));
+    FakeBroker::instance().setReachable(true);
+    HostNtp::setReachable(true);
+
+    // Resto da semana e sábado de manhã em VENTILAR
+    device.runUntil(at(6, 8, 0), 5000);
+    TEST_ASSERT_TRUE(device.unit.on);
+    TEST_ASSERT_EQUAL(ACMode::FAN, device.ac.getMode());
+    TEST_ASSERT_EQUAL(FanSpeed::SLOW, device.ac.getFanSpeed());
+
+    // Alocações na tarefa de rede com a agenda rodando: nenhuma
+    HostAllocStats before = HostAlloc::stats();
+    device.runUntil(MINUTES_PER_WEEK - 1);
+    HostAllocStats after = HostAlloc::stats();
+    TEST_ASSERT_FALSE(device.unit.on);
+    TEST_ASSERT_EQUAL_UINT64(before.calls, after.calls);
+
+    char report[160];
+    snprintf(report, sizeof(report),
+             "[agenda] semana simulada: %u mudanças de liga/desliga, pior atraso %u ms após o minuto",
+             (unsigned)device.switches, (unsigned)device.worstDelayMs);
+    TEST_MESSAGE(report);
+    // 22 transições, menos a das 13:30 de terça (já ligado à mão), mais o LIGAR manual
+    TEST_ASSERT_EQUAL_UINT32(22, device.switches);
+    TEST_ASSERT_TRUE(device.worstDelayMs <= SCHEDULE_POLL_INTERVAL + 5 * LOOP_STEP_MS);
+}
+
+void test_waits_for_clock_then_catches_up() {
+    ScheduleTable table;
+    TEST_ASSERT_EQUAL(CommandParseResult::OK, parse(CLASSROOM_SCHEDULE, table));
+    {
+        Scheduler stored;
+        stored.begin();
+        stored.install(table);
+    }
+
+    // Boot na segunda 09:00 sem NTP: a agenda da NVS espera a hora
+    HostNtp::setReachable(false);
+    HostClock::advanceMillis(uint64_t(at(1, 9, 0)) * 60000);
+    Device device;
+    device.start();
+    device.weekStartMs = 0;
+    device.runUntil(at(1, 9, 10));
+    TEST_ASSERT_FALSE(device.unit.on);
+    TEST_ASSERT_FALSE(device.scheduler.clockSynced());
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"STATUS\"}");
+    device.runUntil(at(1, 9, 10), 1000);
+    const FakeMessage* status = FakeBroker::instance().retained(MQTT_STATUS_TOPIC);
+    TEST_ASSERT_NOT_NULL(status);
+    TEST_ASSERT_NOT_NULL(strstr(status->text(), "\"agenda\":{\"versao\":7,\"ativa\":true,\"relogio\":false}"));
+
+    // Com a hora, aplica a transição em vigor (07:00) uma vez
+    HostNtp::setReachable(true);
+    HostNtp::setEpoch(SUNDAY_EPOCH + uint64_t(at(1, 9, 10)) * 60 + 1);
+    device.runUntil(at(1, 9, 11));
+    TEST_ASSERT_TRUE(device.unit.on);
+    TEST_ASSERT_TRUE(device.scheduler.clockSynced());
+    TEST_ASSERT_EQUAL(23, device.ac.getTargetTemperature());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_compiles_sorted_week);
+    RUN_TEST(test_parse_rejects_invalid_schedules);
+    RUN_TEST(test_blob_round_trip_and_validation);
+    RUN_TEST(test_utc_minutes_follows_calendar);
+    RUN_TEST(test_fires_each_transition_once_and_catches_up);
+    RUN_TEST(test_table_persists_in_nvs);
+    RUN_TEST(test_week_fast_forward_with_outage_and_manual_override);
+    RUN_TEST(test_waits_for_clock_then_catches_up);
+    return UNITY_END();
+}
@@ -0,0 +1,316 @@
+#include <unity.h>
+#include <HostDht22.h>
+#include "config.h"
+#include "ACController.h"
+#include "Dht22.h"
+#include "RingBuffer.h"
+#include "SensorFilter.h"
+#include "SensorPipeline.h"
+#include "StatusCodec.h"
+
+void setUp() {
+    HostClock::reset();
+    HostDht22::reset();
+}
+
+void tearDown() {}
+
+// Passos de 1 ms (ritmo da tarefa de sensores durante uma leitura) até a
+// tentativa terminar; devolve quantos passos levou
+static int runRead(SensorPipeline& pipeline) {
+    for (int ms = 0; ms < 50; ms++) {
+        uint64_t before = HostClock::nowMicros();
+        bool done = pipeline.step();
+        // Nenhum passo consome tempo: quem espera é o RMT
+        TEST_ASSERT_EQUAL(before, HostClock::nowMicros());
+        if (done) return ms;
+        HostClock::advanceMillis(1);
+    }
+    TEST_FAIL_MESSAGE("leitura não terminou em 50 ms");
+    return -1;
+}
+
+// Uma leitura por intervalo do DHT22
+static void runReads(SensorPipeline& pipeline, int count) {
+    for (int i = 0; i < count; i++) {
+        HostClock::advanceMillis(SensorPipeline::SAMPLE_INTERVAL);
+        runRead(pipeline);
+    }
+}
+
+void test_ring_buffer_keeps_newest() {
+    RingBuffer<int, 4> ring;
+    TEST_ASSERT_TRUE(ring.empty());
+    for (int i = 1; i <= 6; i++) ring.push(i);
+    TEST_ASSERT_TRUE(ring.full());
+    TEST_ASSERT_EQUAL(4, ring.size());
+    for (size_t i = 0; i < ring.size(); i++) {
+        TEST_ASSERT_EQUAL(int(i) + 3, ring[i]);
+    }
+    TEST_ASSERT_EQUAL(6, ring.newest());
+    ring.clear();
+    ring.push(9);
+    TEST_ASSERT_EQUAL(1, ring.size());
+    TEST_ASSERT_EQUAL(9, ring[0]);
+}
+
+void test_median_rejects_isolated_spike() {
+    SensorFilter filter(0.3f, 0.5f);
+    static const float readings[] = {24.0f, 24.0f, 24.0f, 35.0f, 24.0f, 24.0f, 8.0f, 24.0f};
+    for (float reading : readings) {
+        TEST_ASSERT_EQUAL_FLOAT(24.0f, filter.push(reading));
+    }
+}
+
+void test_noise_is_smoothed_and_steps_pass() {
+    SensorFilter filter(0.3f, 0.5f);
+    // Ruído do último dígito: a saída fica entre os extremos e varia menos
+    float lo = 100.0f;
+    float hi = -100.0f;
+    for (int i = 0; i < 40; i++) {
+        float out = filter.push(i % 3 ? 24.0f : 24.3f);
+        if (i >= 10) {
+            if (out < lo) lo = out;
+            if (out > hi) hi = out;
+        }
+    }
+    TEST_ASSERT_TRUE(lo >= 23.95f && hi <= 24.15f);
+
+    // Degrau real de 2 °C: passa inteiro assim que a mediana vira
+    float out = 0.0f;
+    for (int i = 0; i < 3; i++) out = filter.push(26.0f);
+    TEST_ASSERT_EQUAL_FLOAT(26.0f, out);
+}
+
+void test_window_min_max_mean() {
+    SensorWindow window;
+    window.add(23.0f);
+    window.add(25.0f);
+    window.add(24.5f);
+    SensorStats stats = window.close();
+    TEST_ASSERT_EQUAL(3, stats.samples);
+    TEST_ASSERT_EQUAL_FLOAT(23.0f, stats.min);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, stats.max);
+    TEST_ASSERT_EQUAL_FLOAT(24.166667f, stats.mean);
+
+    stats = window.close();
+    TEST_ASSERT_EQUAL(0, stats.samples);
+    TEST_ASSERT_TRUE(isnan(stats.mean));
+}
+
+void test_health_follows_recent_attempts() {
+    SensorHealthTracker tracker(3);
+    TEST_ASSERT_EQUAL(int(SensorHealth::UNKNOWN), int(tracker.health()));
+    tracker.record(false);
+    tracker.record(false);
+    TEST_ASSERT_EQUAL(int(SensorHealth::UNKNOWN), int(tracker.health()));
+    tracker.record(false);
+    TEST_ASSERT_EQUAL(int(SensorHealth::FAILED), int(tracker.health()));
+
+    tracker.record(true);
+    TEST_ASSERT_EQUAL(int(SensorHealth::DEGRADED), int(tracker.health()));
+    for (int i = 0; i < 6; i++) tracker.record(true);
+    TEST_ASSERT_EQUAL(int(SensorHealth::DEGRADED), int(tracker.health()));
+    // Oitava leitura boa: a falha saiu do histórico
+    tracker.record(true);
+    TEST_ASSERT_EQUAL(int(SensorHealth::OK), int(tracker.health()));
+
+    tracker.record(false);
+    TEST_ASSERT_EQUAL(int(SensorHealth::DEGRADED), int(tracker.health()));
+}
+
+void test_decode_frame_reference_values() {
+    Dht22::Reading reading{0, 0};
+    // Exemplo do datasheet do AM2302: 65,2 %UR e 35,1 °C
+    const uint8_t datasheet[] = {0x02, 0x8C, 0x01, 0x5F, 0xEE};
+    TEST_ASSERT_EQUAL(int(Dht22Result::OK), int(Dht22::decodeFrame(datasheet, reading)));
+    TEST_ASSERT_EQUAL_FLOAT(65.2f, reading.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(35.1f, reading.temperature);
+
+    // Bit 15 da temperatura é o sinal: -10,1 °C
+    const uint8_t negative[] = {0x02, 0x8C, 0x80, 0x65, Dht22::checksum(0x02, 0x8C, 0x80, 0x65)};
+    TEST_ASSERT_EQUAL(int(Dht22Result::OK), int(Dht22::decodeFrame(negative, reading)));
+    TEST_ASSERT_EQUAL_FLOAT(-10.1f, reading.temperature);
+
+    const uint8_t corrupted[] = {0x02, 0x8C, 0x01, 0x5F, 0xEF};
+    TEST_ASSERT_EQUAL(int(Dht22Result::CHECKSUM), int(Dht22::decodeFrame(corrupted, reading)));
+
+    // 120 °C é impossível para o DHT22; a umidade continua aproveitável
+    const uint8_t hot[] = {0x01, 0xF4, 0x04, 0xB0, Dht22::checksum(0x01, 0xF4, 0x04, 0xB0)};
+    TEST_ASSERT_EQUAL(int(Dht22Result::OUT_OF_RANGE), int(Dht22::decodeFrame(hot, reading)));
+    TEST_ASSERT_TRUE(isnan(reading.temperature));
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, reading.humidity);
+}
+
+void test_reader_captures_frame_without_blocking() {
+    Dht22Reader reader(PIN_DHT);
+    TEST_ASSERT_TRUE(reader.begin());
+    HostDht22::setReading(PIN_DHT, -3.4f, 87.6f);
+
+    TEST_ASSERT_TRUE(reader.start());
+    TEST_ASSERT_FALSE(reader.start());
+    Dht22::Reading reading{0, 0};
+    Dht22Result result = Dht22Result::PENDING;
+    uint32_t polls = 0;
+    while (result == Dht22Result::PENDING && polls < 100) {
+        uint64_t before = HostClock::nowMicros();
+        result = reader.poll(reading);
+        TEST_ASSERT_EQUAL(before, HostClock::nowMicros());
+        HostClock::advanceMicros(500);
+        polls++;
+    }
+    TEST_ASSERT_EQUAL(int(Dht22Result::OK), int(result));
+    TEST_ASSERT_EQUAL_FLOAT(-3.4f, reading.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(87.6f, reading.humidity);
+    TEST_ASSERT_EQUAL(0, HostDht22::badStarts(PIN_DHT));
+    TEST_ASSERT_FALSE(reader.busy());
+    TEST_ASSERT_EQUAL(int(Dht22Result::IDLE), int(reader.poll(reading)));
+    // Pulso de início + resposta: ~6 ms em passos de 0,5 ms
+    TEST_ASSERT_LESS_OR_EQUAL(16, polls);
+}
+
+void test_reader_reports_each_fault() {
+    Dht22Reader reader(PIN_DHT);
+    TEST_ASSERT_TRUE(reader.begin());
+    struct Case {
+        HostDht22::Fault fault;
+        Dht22Result expected;
+    };
+    static const Case cases[] = {
+        {HostDht22::Fault::ABSENT, Dht22Result::NO_RESPONSE},
+        {HostDht22::Fault::CHECKSUM, Dht22Result::CHECKSUM},
+        {HostDht22::Fault::TRUNCATED, Dht22Result::BAD_FRAME},
+        {HostDht22::Fault::NONE, Dht22Result::OK},
+    };
+    for (const Case& c : cases) {
+        HostDht22::setFault(PIN_DHT, c.fault, 1);
+        TEST_ASSERT_TRUE(reader.start());
+        Dht22::Reading reading{0, 0};
+        Dht22Result result = Dht22Result::PENDING;
+        for (int ms = 0; ms < 50 && result == Dht22Result::PENDING; ms++) {
+            HostClock::advanceMillis(1);
+            result = reader.poll(reading);
+        }
+        TEST_ASSERT_EQUAL(int(c.expected), int(result));
+        HostClock::advanceMillis(Dht22::MIN_INTERVAL_MS);
+    }
+}
+
+void test_pipeline_health_and_recovery() {
+    SensorPipeline pipeline(PIN_DHT);
+    TEST_ASSERT_TRUE(pipeline.begin());
+    HostDht22::setReading(PIN_DHT, 22.0f, 40.0f);
+    runRead(pipeline);
+    TEST_ASSERT_EQUAL(int(SensorHealth::OK), int(pipeline.sample().temperatureHealth));
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, pipeline.sample().temperature);
+
+    // Cabo solto: três tentativas seguidas e o sensor vira FALHA
+    HostDht22::setFault(PIN_DHT, HostDht22::Fault::ABSENT);
+    runReads(pipeline, 2);
+    TEST_ASSERT_EQUAL(int(SensorHealth::DEGRADED), int(pipeline.sample().humidityHealth));
+    TEST_ASSERT_TRUE(isnan(pipeline.sample().temperature));
+    runReads(pipeline, 1);
+    TEST_ASSERT_EQUAL(int(Dht22Result::NO_RESPONSE), int(pipeline.lastResult()));
+    TEST_ASSERT_EQUAL(int(SensorHealth::FAILED), int(pipeline.sample().temperatureHealth));
+    TEST_ASSERT_EQUAL(int(SensorHealth::FAILED), int(pipeline.sample().humidityHealth));
+
+    HostDht22::setFault(PIN_DHT, HostDht22::Fault::NONE);
+    runReads(pipeline, 1);
+    TEST_ASSERT_EQUAL(int(SensorHealth::DEGRADED), int(pipeline.sample().temperatureHealth));
+    runReads(pipeline, 8);
+    TEST_ASSERT_EQUAL(int(SensorHealth::OK), int(pipeline.sample().temperatureHealth));
+
+    // Temperatura fora da faixa afeta só ela
+    HostDht22::setReading(PIN_DHT, 95.0f, 40.0f);
+    runReads(pipeline, 1);
+    TEST_ASSERT_EQUAL(int(SensorHealth::DEGRADED), int(pipeline.sample().temperatureHealth));
+    TEST_ASSERT_EQUAL(int(SensorHealth::OK), int(pipeline.sample().humidityHealth));
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, pipeline.sample().humidity);
+}
+
+void test_pipeline_closes_reporting_window() {
+    SensorPipeline pipeline(PIN_DHT);
+    pipeline.setWindowInterval(60000);
+    TEST_ASSERT_TRUE(pipeline.begin());
+
+    // 30 leituras (60 s) variando de 23,0 a 25,9 °C em degraus de 0,1
+    uint32_t closed = 0;
+    SensorStats stats{};
+    for (int i = 0; i < 31; i++) {
+        HostDht22::setReading(PIN_DHT, 23.0f + (i % 30) * 0.1f, 50.0f);
+        runRead(pipeline);
+        if (pipeline.sample().windowClosed) {
+            closed++;
+            stats = pipeline.sample().temperatureStats;
+        }
+        HostClock::advanceMillis(SensorPipeline::SAMPLE_INTERVAL);
+    }
+    TEST_ASSERT_EQUAL(1, closed);
+    TEST_ASSERT_GREATER_OR_EQUAL(29, stats.samples);
+    TEST_ASSERT_EQUAL_FLOAT(23.0f, stats.min);
+    // A janela acumula o valor filtrado: numa rampa, mediana + EMA atrasam
+    // ~0,4 °C, então o máximo fica abaixo do bruto
+    TEST_ASSERT_TRUE(stats.max <= 25.9f && stats.max >= 25.4f);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 24.45f, stats.mean);
+}
+
+void test_controller_publishes_sensor_health() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.markPublished(STATUS_FIELD_ALL);
+
+    SensorSample sample{24.0f, 50.0f};
+    ac.applySample(sample);
+    TEST_ASSERT_TRUE(ac.dirtyFields() & STATUS_FIELD_SENSOR);
+    ac.markPublished(STATUS_FIELD_ALL);
+    ac.applySample(sample);
+    TEST_ASSERT_FALSE(ac.dirtyFields() & STATUS_FIELD_SENSOR);
+
+    // Falha: o último valor continua publicado, com a saúde ao lado
+    SensorSample failed{NAN, NAN, SensorHealth::FAILED, SensorHealth::FAILED};
+    failed.windowClosed = true;
+    failed.temperatureStats = SensorStats{23.5f, 24.25f, 24.04f, 12};
+    ac.applySample(failed);
+    TEST_ASSERT_EQUAL(STATUS_FIELD_SENSOR, ac.dirtyFields());
+    TEST_ASSERT_EQUAL_FLOAT(24.0f, ac.getCurrentTemperature());
+
+    char buffer[STATUS_JSON_CAPACITY];
+    TEST_ASSERT_GREATER_THAN(0, ac.serializeStatus(buffer, sizeof(buffer)));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "\"sensorStatus\":{\"temperatura\":\"FALHA\",\"umidade\":\"FALHA\"}"));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "\"janela\":{\"temperatura\":{\"min\":23.5,\"max\":24.3,\"media\":24,\"amostras\":12}}"));
+
+    serializeStatusDeltaJson(ac.getStatus(), ac.dirtyFields(), buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("{\"sensorStatus\":{\"temperatura\":\"FALHA\",\"umidade\":\"FALHA\"}}", buffer);
+}
+
+void test_controller_samples_in_single_loop_mode() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    HostDht22::setReading(PIN_DHT, 27.5f, 48.0f);
+    // loop() a cada 10 ms
+    for (int i = 0; i < 5; i++) {
+        ac.update();
+        HostClock::advanceMillis(10);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(27.5f, ac.getCurrentTemperature());
+    TEST_ASSERT_EQUAL_FLOAT(48.0f, ac.getCurrentHumidity());
+    TEST_ASSERT_EQUAL(int(SensorHealth::OK), int(ac.getHumidityHealth()));
+    TEST_ASSERT_EQUAL(1, HostDht22::reads(PIN_DHT));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_buffer_keeps_newest);
+    RUN_TEST(test_median_rejects_isolated_spike);
+    RUN_TEST(test_noise_is_smoothed_and_steps_pass);
+    RUN_TEST(test_window_min_max_mean);
+    RUN_TEST(test_health_follows_recent_attempts);
+    RUN_TEST(test_decode_frame_reference_values);
+    RUN_TEST(test_reader_captures_frame_without_blocking);
+    RUN_TEST(test_reader_reports_each_fault);
+    RUN_TEST(test_pipeline_health_and_recovery);
+    RUN_TEST(test_pipeline_closes_reporting_window);
+    RUN_TEST(test_controller_publishes_sensor_health);
+    RUN_TEST(test_controller_samples_in_single_loop_mode);
+    return UNITY_END();
+}
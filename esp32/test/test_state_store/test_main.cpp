@@ -0,0 +1,233 @@
+#include <unity.h>
+#include <string.h>
+#include <FakeBroker.h>
+#include <HostDht22.h>
+#include <HostIRLog.h>
+#include <Preferences.h>
+#include "config.h"
+#include "ACController.h"
+#include "ACStateStore.h"
+#include "ACUnits.h"
+#include "NetworkManager.h"
+
+static const uint32_t LOOP_STEP_MS = 10;
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    HostDht22::reset();
+    HostNvs::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+static bool sameSettings(const ACSettings& a, const ACSettings& b) {
+    return a.isOn == b.isOn && a.targetTemp == b.targetTemp && a.mode == b.mode && a.fanSpeed == b.fanSpeed;
+}
+
+static void connect(NetworkManager& network) {
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+}
+
+static void runFor(NetworkManager& network, ACController& ac, uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += LOOP_STEP_MS) {
+        network.update();
+        ac.updateIR();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+}
+
+void test_record_round_trip_and_validation() {
+    const ACSettings cases[] = {
+        {false, 16, ACMode::AUTO, FanSpeed::AUTO},
+        {true, 30, ACMode::FAN, FanSpeed::FAST},
+        {true, 22, ACMode::DRY, FanSpeed::SLOW},
+    };
+    for (const ACSettings& settings : cases) {
+        ACSettings decoded{};
+        TEST_ASSERT_TRUE(ACStateStore::unpack(ACStateStore::pack(settings), decoded));
+        TEST_ASSERT_TRUE(sameSettings(settings, decoded));
+    }
+
+    uint64_t good = ACStateStore::pack(ACSettings{true, 24, ACMode::COOL, FanSpeed::MEDIUM});
+    ACSettings decoded{};
+    TEST_ASSERT_FALSE(ACStateStore::unpack(0, decoded));                          // versão
+    TEST_ASSERT_FALSE(ACStateStore::unpack(good ^ (uint64_t(24 ^ 40) << 16), decoded));  // 40 °C
+    TEST_ASSERT_FALSE(ACStateStore::unpack(good | uint64_t(7) << 24, decoded));   // modo
+    TEST_ASSERT_FALSE(ACStateStore::unpack(good | uint64_t(1) << 56, decoded));   // lixo no fim
+}
+
+void test_changes_are_coalesced() {
+    ACStateStore store;
+    store.begin();
+    ACSettings settings{true, 24, ACMode::COOL, FanSpeed::AUTO};
+    ACSettings out;
+    TEST_ASSERT_FALSE(store.stored(0, out));
+
+    // O usuário sobe o setpoint grau a grau: uma gravação, depois da pausa
+    for (uint8_t temp = 20; temp <= 26; temp++) {
+        settings.targetTemp = temp;
+        store.note(0, settings);
+        TEST_ASSERT_FALSE(store.poll());
+        HostClock::advanceMillis(1000);
+    }
+    HostClock::advanceMillis(STATE_SAVE_QUIET - 1000 - 1);
+    TEST_ASSERT_FALSE(store.poll());
+    HostClock::advanceMillis(1);
+    TEST_ASSERT_TRUE(store.poll());
+    TEST_ASSERT_EQUAL_UINT32(1, store.writes());
+    TEST_ASSERT_EQUAL_UINT32(1, HostNvs::writeCalls());
+    // Um inteiro de 64 bits: uma entrada de 32 bytes na flash
+    TEST_ASSERT_EQUAL_UINT64(32, HostNvs::flashBytesWritten());
+
+    // Mudar e voltar antes do prazo não grava nada
+    settings.targetTemp = 18;
+    store.note(0, settings);
+    HostClock::advanceMillis(1000);
+    settings.targetTemp = 26;
+    store.note(0, settings);
+    TEST_ASSERT_FALSE(store.pending());
+    HostClock::advanceMillis(STATE_SAVE_MAX_DELAY);
+    TEST_ASSERT_FALSE(store.poll());
+    TEST_ASSERT_EQUAL_UINT32(1, HostNvs::writeCalls());
+
+    // Mudanças sem pausa: no máximo STATE_SAVE_MAX_DELAY de atraso
+    for (uint32_t t = 0; t < STATE_SAVE_MAX_DELAY; t += 1000) {
+        settings.fanSpeed = FanSpeed(1 + t / 1000 % 3);
+        store.note(0, settings);
+        TEST_ASSERT_FALSE(store.poll());
+        HostClock::advanceMillis(1000);
+    }
+    settings.fanSpeed = FanSpeed::FAST;
+    store.note(0, settings);
+    TEST_ASSERT_TRUE(store.poll());
+    TEST_ASSERT_EQUAL_UINT32(2, store.writes());
+
+    // Antes de reiniciar: grava já
+    settings.isOn = false;
+    store.note(0, settings);
+    TEST_ASSERT_TRUE(store.pending());
+    TEST_ASSERT_TRUE(store.flush());
+    TEST_ASSERT_FALSE(store.pending());
+
+    ACStateStore reloaded;
+    reloaded.begin();
+    TEST_ASSERT_TRUE(reloaded.stored(0, out));
+    TEST_ASSERT_TRUE(sameSettings(settings, out));
+    TEST_ASSERT_FALSE(reloaded.stored(1, out));
+}
+
+void test_boot_restores_state_and_status_without_ir() {
+    {
+        ACController ac(PIN_IR_LED, PIN_DHT);
+        NetworkManager network(DEVICE_ID, ac);
+        ACStateStore store;
+        ac.begin();
+        store.begin();
+        network.attachStateStore(store);
+        connect(network);
+        FakeBroker::instance().inject(MQTT_COMMAND_TOPIC,
+                                      "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":19,"
+                                      "\"modo\":\"REFRIGERAR\",\"velocidade\":\"ALTA\"}}");
+        runFor(network, ac, STATE_SAVE_QUIET + 100);
+        TEST_ASSERT_EQUAL_UINT32(1, store.writes());
+    }
+
+    // Queda de energia: RAM e conexões perdidas, a NVS fica
+    HostIRLog::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ACStateStore store;
+    ac.begin();
+    store.begin();
+    ACSettings saved;
+    TEST_ASSERT_TRUE(store.stored(0, saved));
+    ac.restore(saved);
+    TEST_ASSERT_TRUE(ac.isOn());
+    TEST_ASSERT_EQUAL(19, ac.getTargetTemperature());
+    TEST_ASSERT_EQUAL(int(ACMode::COOL), int(ac.getMode()));
+    TEST_ASSERT_EQUAL(int(FanSpeed::FAST), int(ac.getFanSpeed()));
+
+    // O status retido sai corrigido no mesmo passo em que a inscrição é feita
+    network.attachStateStore(store);
+    connect(network);
+    const FakeMessage* status = FakeBroker::instance().retained(MQTT_STATUS_TOPIC);
+    TEST_ASSERT_NOT_NULL(status);
+    TEST_ASSERT_NOT_NULL(strstr(status->text(), "\"ligado\":true"));
+    TEST_ASSERT_NOT_NULL(strstr(status->text(), "\"temperaturaDesejada\":19"));
+    TEST_ASSERT_NOT_NULL(strstr(status->text(), "\"modoOperacao\":\"REFRIGERAR\""));
+
+    // O aparelho já está nesse estado: nada vai ao ar, nada é regravado
+    runFor(network, ac, STATE_SAVE_MAX_DELAY);
+    TEST_ASSERT_EQUAL_UINT32(0, HostIRLog::count());
+    TEST_ASSERT_EQUAL_UINT32(0, store.writes());
+}
+
+void test_units_are_stored_apart() {
+    static const uint8_t pins[] = {PIN_IR_LED, 16};
+    ACUnits<2> units(pins, PIN_DHT);
+    MultiUnitNetworkManager<2> network(DEVICE_ID, units);
+    ACStateStore store;
+    units.begin();
+    store.begin();
+    network.attachStateStore(store);
+    connect(network);
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC "/1", "{\"comando\":\"LIGAR\"}");
+    for (uint32_t t = 0; t < STATE_SAVE_QUIET + 100; t += LOOP_STEP_MS) {
+        network.update();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+
+    ACStateStore reloaded;
+    reloaded.begin();
+    ACSettings first, second;
+    TEST_ASSERT_TRUE(reloaded.stored(0, first));
+    TEST_ASSERT_TRUE(reloaded.stored(1, second));
+    TEST_ASSERT_FALSE(first.isOn);
+    TEST_ASSERT_TRUE(second.isOn);
+}
+
+void test_nvs_rotates_pages_under_rewrites() {
+    // Um registro regravado 10 mil vezes: as páginas são apagadas em
+    // rodízio, nenhuma mais que as outras
+    ACStateStore store;
+    store.begin();
+    ACSettings settings{true, 16, ACMode::COOL, FanSpeed::AUTO};
+    const uint32_t saves = 10000;
+    for (uint32_t i = 0; i < saves; i++) {
+        settings.targetTemp = uint8_t(16 + i % 15);
+        store.note(0, settings);
+        TEST_ASSERT_TRUE(store.flush());
+    }
+    TEST_ASSERT_EQUAL_UINT32(saves, store.writes());
+    TEST_ASSERT_EQUAL_UINT64(uint64_t(saves) * 32, HostNvs::flashBytesWritten());
+    uint32_t perPage = saves / (126 * HOST_NVS_PAGES);
+    TEST_ASSERT_GREATER_OR_EQUAL(perPage * HOST_NVS_PAGES - HOST_NVS_PAGES, HostNvs::pageErases());
+    TEST_ASSERT_LESS_OR_EQUAL(perPage + 1, HostNvs::maxPageErases());
+
+    ACStateStore reloaded;
+    reloaded.begin();
+    ACSettings out;
+    TEST_ASSERT_TRUE(reloaded.stored(0, out));
+    TEST_ASSERT_TRUE(sameSettings(settings, out));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_record_round_trip_and_validation);
+    RUN_TEST(test_changes_are_coalesced);
+    RUN_TEST(test_boot_restores_state_and_status_without_ir);
+    RUN_TEST(test_units_are_stored_apart);
+    RUN_TEST(test_nvs_rotates_pages_under_rewrites);
+    return UNITY_END();
+}
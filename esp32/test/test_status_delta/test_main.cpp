@@ -0,0 +1,195 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <HostDht22.h>
+#include <FakeBroker.h>
+#include "config.h"
+#include "ACController.h"
+#include "NetworkManager.h"
+#include "StatusCodec.h"
+
+// Passo do loop() simulado; o firmware real roda a cada ~10 ms
+static const uint32_t LOOP_STEP_MS = 50;
+
+struct PublishCounter {
+    uint32_t full;
+    uint32_t delta;
+};
+
+static PublishCounter g_counter;
+
+static void countPublish(const FakeMessage& message, void*) {
+    if (strcmp(message.topic, MQTT_STATUS_TOPIC) == 0) g_counter.full++;
+    if (strcmp(message.topic, MQTT_STATUS_DELTA_TOPIC) == 0) g_counter.delta++;
+}
+
+static void connect(NetworkManager& network, ACController& ac) {
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+    g_counter = PublishCounter{0, 0};
+}
+
+static void runFor(NetworkManager& network, ACController& ac, uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += LOOP_STEP_MS) {
+        network.update();
+        ac.update();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+}
+
+void setUp() {
+    HostClock::reset();
+    HostDht22::reset();
+    WiFi.hostReset();
+    FakeBroker::instance().reset();
+    FakeBroker::instance().setObserver(countPublish, nullptr);
+    g_counter = PublishCounter{0, 0};
+}
+
+void tearDown() {}
+
+void test_delta_payload_has_only_changed_keys() {
+    ACStatus status{true, 23.6f, 50.0f, 22, ACMode::COOL, FanSpeed::FAST};
+    char buffer[STATUS_JSON_CAPACITY];
+    serializeStatusDeltaJson(status, STATUS_FIELD_CURRENT_TEMP, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("{\"temperaturaAtual\":23.60000038}", buffer);
+    serializeStatusDeltaJson(status, STATUS_FIELD_POWER | STATUS_FIELD_FAN_SPEED, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("{\"ligado\":true,\"velocidadeVentilador\":\"ALTA\"}", buffer);
+}
+
+void test_readings_inside_deadband_do_not_publish() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    HostDht22::setReading(PIN_DHT, 24.0f, 55.0f);
+    connect(network, ac);
+    runFor(network, ac, 10000);
+    g_counter = PublishCounter{0, 0};
+
+    HostDht22::setReading(PIN_DHT, 24.1f, 55.5f);
+    runFor(network, ac, 60000);
+    TEST_ASSERT_EQUAL(0, g_counter.full);
+}
+
+void test_change_beyond_deadband_publishes_once() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    HostDht22::setReading(PIN_DHT, 24.0f, 55.0f);
+    connect(network, ac);
+    runFor(network, ac, 10000);
+    g_counter = PublishCounter{0, 0};
+
+    HostDht22::setReading(PIN_DHT, 24.5f, 55.0f);
+    runFor(network, ac, 60000);
+    TEST_ASSERT_EQUAL(1, g_counter.full);
+    TEST_ASSERT_FALSE(ac.dirtyFields() & STATUS_FIELD_CURRENT_TEMP);
+}
+
+void test_heartbeat_publishes_when_idle() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    connect(network, ac);
+    runFor(network, ac, 10000);
+    g_counter = PublishCounter{0, 0};
+
+    runFor(network, ac, 3 * STATUS_HEARTBEAT_INTERVAL);
+    TEST_ASSERT_EQUAL(3, g_counter.full);
+}
+
+void test_command_publishes_immediately() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    connect(network, ac);
+    runFor(network, ac, 10000);
+    g_counter = PublishCounter{0, 0};
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}");
+    network.update();
+    TEST_ASSERT_EQUAL(1, g_counter.full);
+    TEST_ASSERT_EQUAL(0, ac.dirtyFields());
+}
+
+void test_delta_mode_publishes_changed_keys_only() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    network.setDeltaPublishing(true);
+    HostDht22::setReading(PIN_DHT, 24.0f, 55.0f);
+    connect(network, ac);
+    runFor(network, ac, 10000);
+    g_counter = PublishCounter{0, 0};
+
+    HostDht22::setReading(PIN_DHT, 24.0f, 58.0f);
+    runFor(network, ac, 10000);
+    TEST_ASSERT_EQUAL(0, g_counter.full);
+    TEST_ASSERT_EQUAL(1, g_counter.delta);
+    const FakeMessage* delta = FakeBroker::instance().lastMessage(MQTT_STATUS_DELTA_TOPIC);
+    TEST_ASSERT_NOT_NULL(delta);
+    TEST_ASSERT_EQUAL_STRING("{\"umidade\":58}", delta->text());
+    TEST_ASSERT_FALSE(delta->retained);
+}
+
+// Traço sintético de 8 h de uma sala: deriva lenta (ciclo térmico do dia e
+// do próprio AC) somada ao ruído de ±0,1 °C / ±0,5 %UR do DHT22, quantizado
+// na resolução de 0,1 do sensor.
+static float quantize(float value) {
+    return roundf(value * 10.0f) / 10.0f;
+}
+
+static uint32_t g_lcg = 12345;
+static float noise(float amplitude) {
+    g_lcg = g_lcg * 1664525u + 1013904223u;
+    return amplitude * ((float)(g_lcg >> 8) / (float)(1u << 24) * 2.0f - 1.0f);
+}
+
+void test_replay_sensor_trace_publish_count() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    connect(network, ac);
+
+    const uint32_t durationMs = 8UL * 3600UL * 1000UL;
+    uint32_t commands = 0;
+    for (uint32_t t = 0; t < durationMs; t += LOOP_STEP_MS) {
+        float hours = t / 3600000.0f;
+        float temp = 24.0f + 1.5f * sinf(hours * 0.8f) + 0.4f * sinf(hours * 6.0f) + noise(0.1f);
+        float humidity = 55.0f + 4.0f * sinf(hours * 0.5f) + noise(0.5f);
+        HostDht22::setReading(PIN_DHT, quantize(temp), quantize(humidity));
+
+        // Um comando do operador a cada 2 h
+        if (t % (2UL * 3600UL * 1000UL) == 0) {
+            FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, (commands++ % 2) ? "{\"comando\":\"DESLIGAR\"}" : "{\"comando\":\"LIGAR\"}");
+        }
+
+        network.update();
+        ac.update();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+
+    // Antes: publicação incondicional a cada STATUS_UPDATE_INTERVAL + uma por comando
+    uint32_t before = durationMs / STATUS_UPDATE_INTERVAL + commands;
+    uint32_t after = g_counter.full + g_counter.delta;
+
+    char report[160];
+    snprintf(report, sizeof(report),
+             "[trace] 8 h: publicações antes=%u depois=%u (%.1fx menos; heartbeat=%u s, banda=%.1f C/%.1f %%UR)",
+             (unsigned)before, (unsigned)after, after ? double(before) / after : 0.0,
+             (unsigned)(STATUS_HEARTBEAT_INTERVAL / 1000), double(STATUS_TEMP_DEADBAND), double(STATUS_HUMIDITY_DEADBAND));
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_GREATER_OR_EQUAL(durationMs / STATUS_HEARTBEAT_INTERVAL, after);
+    TEST_ASSERT_LESS_THAN(before / 4, after);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_delta_payload_has_only_changed_keys);
+    RUN_TEST(test_readings_inside_deadband_do_not_publish);
+    RUN_TEST(test_change_beyond_deadband_publishes_once);
+    RUN_TEST(test_heartbeat_publishes_when_idle);
+    RUN_TEST(test_command_publishes_immediately);
+    RUN_TEST(test_delta_mode_publishes_changed_keys_only);
+    RUN_TEST(test_replay_sensor_trace_publish_count);
+    return UNITY_END();
+}
@@ -0,0 +1,236 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <FakeBroker.h>
+#include <HostAlloc.h>
+#include "config.h"
+#include "ACController.h"
+#include "NetworkManager.h"
+#include "StatusCodec.h"
+
+// Referência: serialização anterior, com StaticJsonDocument + String
+static String legacyStatusJson(const ACStatus& status) {
+    StaticJsonDocument<768> doc;
+
+    doc["online"] = true;
+    doc["ligado"] = status.isOn;
+    doc["temperaturaAtual"] = status.currentTemp;
+    doc["umidade"] = status.currentHumidity;
+    doc["temperaturaDesejada"] = status.targetTemp;
+
+    const char* modeStr;
+    switch (status.mode) {
+        case ACMode::COOL: modeStr = "REFRIGERAR"; break;
+        case ACMode::DRY:  modeStr = "DESUMIDIFICAR"; break;
+        case ACMode::FAN:  modeStr = "VENTILAR"; break;
+        case ACMode::AUTO:
+        default:           modeStr = "AUTOMATICO"; break;
+    }
+    doc["modoOperacao"] = modeStr;
+
+    const char* fanStr;
+    switch (status.fanSpeed) {
+        case FanSpeed::SLOW:   fanStr = "BAIXA"; break;
+        case FanSpeed::MEDIUM: fanStr = "MEDIA"; break;
+        case FanSpeed::FAST:   fanStr = "ALTA"; break;
+        case FanSpeed::AUTO:
+        default:               fanStr = "AUTOMATICO"; break;
+    }
+    doc["velocidadeVentilador"] = fanStr;
+
+    doc["sensorStatus"]["temperatura"] = sensorHealthName(status.temperatureHealth);
+    doc["sensorStatus"]["umidade"] = sensorHealthName(status.humidityHealth);
+    doc["termostato"]["ativo"] = status.thermostatEnabled;
+    doc["termostato"]["demanda"] = status.thermostatDemand;
+    if (status.temperatureStats.samples || status.humidityStats.samples) {
+        const SensorStats* stats[] = {&status.temperatureStats, &status.humidityStats};
+        const char* names[] = {"temperatura", "umidade"};
+        for (int i = 0; i < 2; i++) {
+            if (!stats[i]->samples) continue;
+            doc["janela"][names[i]]["min"] = roundf(stats[i]->min * 10.0f) / 10.0;
+            doc["janela"][names[i]]["max"] = roundf(stats[i]->max * 10.0f) / 10.0;
+            doc["janela"][names[i]]["media"] = roundf(stats[i]->mean * 10.0f) / 10.0;
+            doc["janela"][names[i]]["amostras"] = stats[i]->samples;
+        }
+    }
+    doc["formato"] = "JSON";
+
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+void setUp() {
+    HostClock::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+void test_matches_legacy_output_byte_for_byte() {
+    static const float temps[] = {0.0f, 23.4f, 24.5f, -3.75f, 18.123f, 29.96f, 100.0f, 1e-6f, 12345678.0f};
+    static const float humidities[] = {0.0f, 55.5f, 99.9f, 41.2f};
+    static const uint8_t targets[] = {16, 23, 30};
+
+    char buffer[STATUS_JSON_CAPACITY];
+    uint32_t checked = 0;
+
+    for (int on = 0; on < 2; on++) {
+        for (size_t m = 0; m < AC_MODE_COUNT; m++) {
+            for (size_t f = 0; f < FAN_SPEED_COUNT; f++) {
+                for (float t : temps) {
+                    for (float h : humidities) {
+                        for (uint8_t target : targets) {
+                            ACStatus status{on != 0, t, h, target, ACMode(m), FanSpeed(f)};
+                            size_t length = serializeStatusJson(status, buffer, sizeof(buffer));
+                            String expected = legacyStatusJson(status);
+                            TEST_ASSERT_EQUAL(expected.length(), length);
+                            TEST_ASSERT_EQUAL_STRING(expected.c_str(), buffer);
+                            checked++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, checked);
+}
+
+void test_nan_is_serialized_as_null() {
+    char buffer[STATUS_JSON_CAPACITY];
+    ACStatus status{true, NAN, NAN, 23, ACMode::COOL, FanSpeed::AUTO};
+    serializeStatusJson(status, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING(legacyStatusJson(status).c_str(), buffer);
+}
+
+void test_controller_serialize_matches_legacy_json() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.turnOn();
+    ac.setTemperature(21);
+    ac.setMode(ACMode::DRY);
+    ac.setFanSpeed(FanSpeed::MEDIUM);
+    ac.update();
+
+    char buffer[STATUS_JSON_CAPACITY];
+    size_t length = ac.serializeStatus(buffer, sizeof(buffer));
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_EQUAL_STRING(legacyStatusJson(ac.getStatus()).c_str(), buffer);
+}
+
+void test_small_buffer_returns_zero() {
+    char buffer[32];
+    ACStatus status{true, 23.5f, 50.0f, 23, ACMode::COOL, FanSpeed::AUTO};
+    TEST_ASSERT_EQUAL(0, serializeStatusJson(status, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_STRING("", buffer);
+}
+
+static bool sameStatus(const ACStatus& a, const ACStatus& b) {
+    return a.isOn == b.isOn && a.targetTemp == b.targetTemp && a.mode == b.mode && a.fanSpeed == b.fanSpeed
+        && a.temperatureHealth == b.temperatureHealth && a.humidityHealth == b.humidityHealth
+        && a.thermostatEnabled == b.thermostatEnabled && a.thermostatDemand == b.thermostatDemand
+        && fabsf(a.currentTemp - b.currentTemp) < 0.001f && fabsf(a.currentHumidity - b.currentHumidity) < 0.001f;
+}
+
+void test_parse_reads_back_status_and_delta() {
+    ACStatus status{true, 24.5f, 61.2f, 19, ACMode::DRY, FanSpeed::MEDIUM};
+    status.temperatureHealth = SensorHealth::DEGRADED;
+    status.humidityHealth = SensorHealth::OK;
+    status.thermostatEnabled = true;
+    status.thermostatDemand = true;
+    status.temperatureStats = SensorStats{24.1f, 24.9f, 24.5f, 40};
+    status.scheduleVersion = 7;
+
+    uint8_t buffer[STATUS_JSON_CAPACITY];
+    for (WireFormat format : {WireFormat::JSON, WireFormat::CBOR}) {
+        size_t length = serializeStatus(status, format, buffer, sizeof(buffer));
+        ACStatus parsed{};
+        uint8_t fields = 0;
+        TEST_ASSERT_TRUE(parseStatus(buffer, length, parsed, fields));
+        TEST_ASSERT_EQUAL_HEX8(STATUS_FIELD_ALL, fields);
+        TEST_ASSERT_TRUE(sameStatus(status, parsed));
+
+        // Delta por cima do último status: só o que veio muda
+        ACStatus changed = status;
+        changed.currentTemp = NAN;
+        changed.isOn = false;
+        length = serializeStatusDelta(changed, STATUS_FIELD_CURRENT_TEMP | STATUS_FIELD_POWER, format,
+                                      buffer, sizeof(buffer));
+        TEST_ASSERT_TRUE(parseStatus(buffer, length, parsed, fields));
+        TEST_ASSERT_EQUAL_HEX8(STATUS_FIELD_CURRENT_TEMP | STATUS_FIELD_POWER, fields);
+        TEST_ASSERT_FALSE(parsed.isOn);
+        TEST_ASSERT_TRUE(isnan(parsed.currentTemp));
+        TEST_ASSERT_EQUAL(19, parsed.targetTemp);
+        TEST_ASSERT_EQUAL(int(ACMode::DRY), int(parsed.mode));
+    }
+
+    // Inválido: nada muda
+    const char* const invalid[] = {
+        "{\"ligado\":1}",
+        "{\"temperaturaDesejada\":300}",
+        "{\"modoOperacao\":\"TURBO\"}",
+        "{\"sensorStatus\":{\"temperatura\":true}}",
+        "{\"ligado\":true",
+    };
+    for (const char* payload : invalid) {
+        ACStatus parsed = status;
+        uint8_t fields = 0x55;
+        TEST_ASSERT_FALSE_MESSAGE(parseStatus(reinterpret_cast<const uint8_t*>(payload), strlen(payload), parsed, fields),
+                                  payload);
+        TEST_ASSERT_TRUE(sameStatus(status, parsed));
+        TEST_ASSERT_EQUAL_HEX8(0x55, fields);
+    }
+}
+
+void test_serialize_status_does_not_allocate() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.update();
+
+    char buffer[STATUS_JSON_CAPACITY];
+    HostAllocStats before = HostAlloc::stats();
+    for (int i = 0; i < 1000; i++) {
+        ac.serializeStatus(buffer, sizeof(buffer));
+    }
+    HostAllocStats after = HostAlloc::stats();
+    TEST_ASSERT_EQUAL(0, after.calls - before.calls);
+}
+
+void test_periodic_publish_does_not_allocate() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+
+    uint32_t publishesBefore = FakeBroker::instance().publishCount();
+    HostClock::advanceMillis(STATUS_HEARTBEAT_INTERVAL);
+
+    HostAllocStats before = HostAlloc::stats();
+    network.update();
+    HostAllocStats after = HostAlloc::stats();
+
+    // Status e snapshot de diagnóstico vencem no mesmo ciclo
+    TEST_ASSERT_EQUAL(publishesBefore + 2, FakeBroker::instance().publishCount());
+    TEST_ASSERT_NOT_NULL(FakeBroker::instance().lastMessage(MQTT_DIAGNOSTICS_TOPIC));
+    TEST_ASSERT_EQUAL(0, after.calls - before.calls);
+
+    const FakeMessage* status = FakeBroker::instance().retained(MQTT_STATUS_TOPIC);
+    TEST_ASSERT_NOT_NULL(status);
+    TEST_ASSERT_EQUAL_STRING(legacyStatusJson(ac.getStatus()).c_str(), status->text());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_legacy_output_byte_for_byte);
+    RUN_TEST(test_nan_is_serialized_as_null);
+    RUN_TEST(test_controller_serialize_matches_legacy_json);
+    RUN_TEST(test_small_buffer_returns_zero);
+    RUN_TEST(test_parse_reads_back_status_and_delta);
+    RUN_TEST(test_serialize_status_does_not_allocate);
+    RUN_TEST(test_periodic_publish_does_not_allocate);
+    return UNITY_END();
+}
@@ -0,0 +1,306 @@
+#include <unity.h>
+#include <stdio.h>
+#include <time.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <HostDht22.h>
+#include <FakeBroker.h>
+#include <HostIRLog.h>
+#include "config.h"
+#include "ACController.h"
+#include "ControlLoop.h"
+#include "NetworkManager.h"
+#include "SensorSampler.h"
+#include "SpscQueue.h"
+#include "TaskQueues.h"
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    HostDht22::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+static uint64_t realNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+}
+
+void test_queue_is_fifo_and_bounded() {
+    SpscQueue<uint32_t, 4> queue;
+    uint32_t value = 0;
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_FALSE(queue.pop(value));
+
+    for (uint32_t i = 0; i < 4; i++) TEST_ASSERT_TRUE(queue.push(i));
+    TEST_ASSERT_FALSE(queue.push(99));
+    TEST_ASSERT_EQUAL(4, queue.size());
+
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(queue.pop(value));
+        TEST_ASSERT_EQUAL(i, value);
+    }
+    TEST_ASSERT_FALSE(queue.pop(value));
+}
+
+void test_queue_wraps_around() {
+    SpscQueue<uint32_t, 8> queue;
+    uint32_t next = 0;
+    uint32_t expected = 0;
+    uint32_t value;
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < 5; i++) TEST_ASSERT_TRUE(queue.push(next++));
+        for (int i = 0; i < 5; i++) {
+            TEST_ASSERT_TRUE(queue.pop(value));
+            TEST_ASSERT_EQUAL(expected++, value);
+        }
+    }
+}
+
+// Mensagem com o tamanho de um StatusUpdate, para pegar cópias rasgadas
+struct StressMessage {
+    uint32_t sequence;
+    uint32_t payload[3];
+    uint32_t check;
+};
+
+static const uint32_t STRESS_MESSAGES = 2000000;
+
+struct StressContext {
+    SpscQueue<StressMessage, 16> queue;
+    std::atomic<uint32_t> received;
+    std::atomic<uint32_t> errors;
+};
+
+static void stressProducer(void* arg) {
+    StressContext* ctx = static_cast<StressContext*>(arg);
+    for (uint32_t i = 0; i < STRESS_MESSAGES; i++) {
+        StressMessage message{i, {i * 3u, i ^ 0x5A5A5A5Au, ~i}, 0};
+        message.check = message.sequence ^ message.payload[0] ^ message.payload[1] ^ message.payload[2];
+        while (!ctx->queue.push(message)) {
+            taskYIELD();
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void stressConsumer(void* arg) {
+    StressContext* ctx = static_cast<StressContext*>(arg);
+    uint32_t expected = 0;
+    StressMessage message;
+    while (expected < STRESS_MESSAGES) {
+        if (!ctx->queue.pop(message)) {
+            taskYIELD();
+            continue;
+        }
+        uint32_t check = message.sequence ^ message.payload[0] ^ message.payload[1] ^ message.payload[2];
+        if (message.sequence != expected || check != message.check) {
+            ctx->errors.fetch_add(1);
+        }
+        expected++;
+    }
+    ctx->received.store(expected);
+    vTaskDelete(NULL);
+}
+
+void test_cross_core_stress_keeps_order() {
+    static StressContext ctx;
+    ctx.received = 0;
+    ctx.errors = 0;
+
+    TaskHandle_t producer = nullptr;
+    TaskHandle_t consumer = nullptr;
+    uint64_t start = realNanos();
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(stressConsumer, "consumer", 4096, &ctx, 2, &consumer, APP_CPU_NUM));
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(stressProducer, "producer", 4096, &ctx, 2, &producer, PRO_CPU_NUM));
+    hostTaskJoin(producer);
+    hostTaskJoin(consumer);
+    double seconds = (realNanos() - start) / 1e9;
+
+    TEST_ASSERT_EQUAL(STRESS_MESSAGES, ctx.received.load());
+    TEST_ASSERT_EQUAL(0, ctx.errors.load());
+
+    char report[128];
+    snprintf(report, sizeof(report), "[queue] %u mensagens de %u B entre threads: %.1f M msg/s, %.0f ns/msg",
+             (unsigned)STRESS_MESSAGES, (unsigned)sizeof(StressMessage),
+             STRESS_MESSAGES / seconds / 1e6, seconds * 1e9 / STRESS_MESSAGES);
+    TEST_MESSAGE(report);
+}
+
+// Tarefa de controle real numa thread: a thread principal faz o papel da
+// tarefa de rede e só fala com ela pelas filas
+struct ControlContext {
+    ControlLoop* loop;
+    std::atomic<bool> stop;
+};
+
+static void controlTask(void* arg) {
+    ControlContext* ctx = static_cast<ControlContext*>(arg);
+    while (!ctx->stop.load()) {
+        if (ctx->loop->step() == 0) {
+            taskYIELD();
+        }
+    }
+    ctx->loop->step();
+    vTaskDelete(NULL);
+}
+
+void test_control_task_owns_controller() {
+    static CommandQueue commands;
+    static SensorQueue samples;
+    static StatusQueue status;
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ControlLoop loop(ac, commands, samples, status);
+    ControlContext ctx{&loop, {false}};
+
+    TaskHandle_t task = nullptr;
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(controlTask, "control", 4096, &ctx, 3, &task, APP_CPU_NUM));
+
+    static const uint32_t COMMANDS = 20000;
+    uint32_t updates = 0;
+    StatusUpdate update{};
+    ACCommand on{ACCommandType::TURN_ON, 0};
+    while (!commands.push(on)) taskYIELD();
+    for (uint32_t i = 0; i < COMMANDS; i++) {
+        ACCommand command{ACCommandType::SET_TEMPERATURE, uint8_t(16 + i % 15)};
+        while (!commands.push(command)) {
+            while (status.pop(update)) updates++;
+            taskYIELD();
+        }
+    }
+    ctx.stop = true;
+    hostTaskJoin(task);
+    while (status.pop(update)) updates++;
+
+    // O relógio virtual ficou parado com o LIGAR no ar: todas as temperaturas
+    // se fundiram num único quadro, que sai quando o tempo anda
+    TEST_ASSERT_EQUAL(1, HostIRLog::count());
+    for (int ms = 0; ms < 1000 && !ac.irIdle(); ms++) {
+        HostClock::advanceMillis(1);
+        ac.updateIR();
+    }
+    TEST_ASSERT_EQUAL(2, HostIRLog::count());
+    TEST_ASSERT_EQUAL(IRCodes::POWER_ON, HostIRLog::at(0)->data);
+    TEST_ASSERT_EQUAL(IRCodes::TEMP_BASE + (COMMANDS - 1) % 15, HostIRLog::last()->data);
+    TEST_ASSERT_GREATER_THAN(0, updates);
+    TEST_ASSERT_TRUE(update.status.isOn);
+    TEST_ASSERT_EQUAL(16 + (COMMANDS - 1) % 15, update.status.targetTemp);
+}
+
+static void connect(NetworkManager& network) {
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+}
+
+void test_command_round_trip_through_queues() {
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ControlLoop control(ac, commands, samples, status);
+    ac.begin();
+    network.attachQueues(commands, status);
+    connect(network);
+    control.step();
+    network.update();
+
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC, "{\"comando\":\"LIGAR\"}");
+    network.update();
+    // A tarefa de rede só enfileira; quem transmite é a de controle
+    TEST_ASSERT_FALSE(ac.isOn());
+    TEST_ASSERT_EQUAL(0, HostIRLog::count());
+    TEST_ASSERT_EQUAL(1, commands.size());
+
+    uint32_t publishes = FakeBroker::instance().publishCount();
+    TEST_ASSERT_EQUAL(1, control.step());
+    TEST_ASSERT_TRUE(ac.isOn());
+    TEST_ASSERT_EQUAL(1, HostIRLog::count());
+
+    network.update();
+    TEST_ASSERT_EQUAL(publishes + 1, FakeBroker::instance().publishCount());
+    const FakeMessage* message = FakeBroker::instance().retained(MQTT_STATUS_TOPIC);
+    TEST_ASSERT_NOT_NULL(message);
+    TEST_ASSERT_NOT_NULL(strstr(message->text(), "\"ligado\":true"));
+}
+
+void test_sensor_samples_reach_status() {
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ControlLoop control(ac, commands, samples, status);
+    SensorSampler sampler(PIN_DHT, samples);
+    ac.begin();
+    sampler.begin();
+    network.attachQueues(commands, status);
+    connect(network);
+
+    HostDht22::setReading(PIN_DHT, 26.5f, 61.0f);
+    // A leitura anda em passos de 1 ms da tarefa de sensores (~6 ms)
+    int steps = 0;
+    while (!sampler.step() && steps++ < 20) {
+        TEST_ASSERT_TRUE(sampler.busy());
+        HostClock::advanceMillis(1);
+    }
+    TEST_ASSERT_LESS_THAN(20, steps);
+    TEST_ASSERT_FALSE(sampler.busy());
+    TEST_ASSERT_FALSE(sampler.step());      // antes do intervalo do DHT22
+    control.step();
+    TEST_ASSERT_EQUAL_FLOAT(26.5f, ac.getCurrentTemperature());
+
+    HostClock::advanceMillis(STATUS_UPDATE_INTERVAL);
+    network.update();
+    const FakeMessage* message = FakeBroker::instance().retained(MQTT_STATUS_TOPIC);
+    TEST_ASSERT_NOT_NULL(message);
+    TEST_ASSERT_NOT_NULL(strstr(message->text(), "\"temperaturaAtual\":26.5"));
+    TEST_ASSERT_NOT_NULL(strstr(message->text(), "\"umidade\":61"));
+}
+
+void test_full_status_queue_keeps_fields_dirty() {
+    CommandQueue commands;
+    SensorQueue samples;
+    StatusQueue status;
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ControlLoop control(ac, commands, samples, status);
+    ac.begin();
+
+    for (size_t i = 0; i < StatusQueue::capacity(); i++) {
+        commands.push(ACCommand{ACCommandType::SET_TEMPERATURE, uint8_t(17 + i)});
+        control.step();
+    }
+    TEST_ASSERT_EQUAL(StatusQueue::capacity(), status.size());
+
+    commands.push(ACCommand{ACCommandType::SET_MODE, uint8_t(ACMode::COOL)});
+    control.step();
+    TEST_ASSERT_TRUE(ac.dirtyFields() & STATUS_FIELD_MODE);
+
+    StatusUpdate update;
+    while (status.pop(update)) {}
+    control.step();
+    TEST_ASSERT_TRUE(status.pop(update));
+    TEST_ASSERT_TRUE(update.fields & STATUS_FIELD_MODE);
+    TEST_ASSERT_EQUAL(0, ac.dirtyFields());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_is_fifo_and_bounded);
+    RUN_TEST(test_queue_wraps_around);
+    RUN_TEST(test_cross_core_stress_keeps_order);
+    RUN_TEST(test_control_task_owns_controller);
+    RUN_TEST(test_command_round_trip_through_queues);
+    RUN_TEST(test_sensor_samples_reach_status);
+    RUN_TEST(test_full_status_queue_keeps_fields_dirty);
+    return UNITY_END();
+}
@@ -0,0 +1,312 @@
+#include <unity.h>
+#include <FakeBroker.h>
+#include <HostDht22.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "ACController.h"
+#include "NetworkManager.h"
+#include "TelemetryCodec.h"
+#include "TelemetryLog.h"
+#include "TelemetryStore.h"
+
+static const uint32_t LOOP_STEP_MS = 50;
+
+// Tudo o que chegou em .../telemetria, decodificado
+struct Received {
+    TelemetryRecord records[8192];
+    uint32_t count;
+    uint32_t batches;
+    uint32_t bytes;
+    uint32_t malformed;
+    uint64_t lastBatchUs;
+    uint64_t minGapUs;
+};
+
+static Received g_received;
+
+static void collect(const FakeMessage& message, void*) {
+    if (strcmp(message.topic, MQTT_TELEMETRY_TOPIC) != 0) return;
+    TEST_ASSERT_FALSE(message.retained);
+    uint32_t now = 0;
+    size_t n = decodeTelemetryBatch(message.payload, message.length, g_received.records + g_received.count,
+                                    8192 - g_received.count, now);
+    if (n == 0) {
+        g_received.malformed++;
+        return;
+    }
+    if (g_received.batches) {
+        uint64_t gap = message.timestampUs - g_received.lastBatchUs;
+        if (gap < g_received.minGapUs) g_received.minGapUs = gap;
+    }
+    g_received.lastBatchUs = message.timestampUs;
+    g_received.count += uint32_t(n);
+    g_received.batches++;
+    g_received.bytes += message.length;
+}
+
+void setUp() {
+    HostClock::reset();
+    HostDht22::reset();
+    HostFlash::reset();
+    WiFi.hostReset();
+    FakeBroker::instance().reset();
+    FakeBroker::instance().setObserver(collect, nullptr);
+    memset(&g_received, 0, sizeof(g_received));
+    g_received.minGapUs = UINT64_MAX;
+}
+
+void tearDown() {}
+
+static TelemetryRecord makeRecord(uint32_t time, int16_t temperature, uint16_t humidity, uint8_t state) {
+    TelemetryRecord record;
+    record.time = time;
+    record.temperature = temperature;
+    record.humidity = humidity;
+    record.state = state;
+    return record;
+}
+
+static void assertSameRecord(const TelemetryRecord& expected, const TelemetryRecord& actual) {
+    TEST_ASSERT_EQUAL_UINT32(expected.time, actual.time);
+    TEST_ASSERT_EQUAL_INT16(expected.temperature, actual.temperature);
+    TEST_ASSERT_EQUAL_UINT16(expected.humidity, actual.humidity);
+    TEST_ASSERT_EQUAL_UINT8(expected.state, actual.state);
+}
+
+void test_record_from_status_and_packing() {
+    ACStatus status{true, -4.25f, 61.04f, 23, ACMode::COOL, FanSpeed::AUTO};
+    TelemetryRecord record = telemetryRecordFromStatus(status, 123456789);
+    TEST_ASSERT_EQUAL_INT16(-43, record.temperature);
+    TEST_ASSERT_EQUAL_UINT16(610, record.humidity);
+    TEST_ASSERT_TRUE(record.isOn());
+    TEST_ASSERT_EQUAL(23, record.targetTemp());
+
+    uint8_t packed[TELEMETRY_RECORD_BYTES];
+    packTelemetryRecord(record, packed);
+    assertSameRecord(record, unpackTelemetryRecord(packed));
+
+    status.currentTemp = NAN;
+    status.currentHumidity = NAN;
+    status.isOn = false;
+    record = telemetryRecordFromStatus(status, 0);
+    TEST_ASSERT_EQUAL_INT16(TELEMETRY_NO_TEMPERATURE, record.temperature);
+    TEST_ASSERT_EQUAL_UINT16(TELEMETRY_NO_HUMIDITY, record.humidity);
+    TEST_ASSERT_FALSE(record.isOn());
+}
+
+void test_batch_round_trip_with_gaps_and_state_changes() {
+    TelemetryRecord records[6] = {
+        makeRecord(1000, 235, 550, 0x80 | 22),
+        makeRecord(1060, 236, 548, 0x80 | 22),
+        makeRecord(1120, TELEMETRY_NO_TEMPERATURE, TELEMETRY_NO_HUMIDITY, 0x80 | 22),
+        makeRecord(1180, 241, 560, 0x80 | 24),
+        makeRecord(90000, -120, 0, 0x00 | 24),
+        makeRecord(90060, 32767, 1000, 0x7F),
+    };
+    uint8_t buffer[telemetryBatchCapacity(6)];
+    size_t encoded = 0;
+    size_t length = encodeTelemetryBatch(records, 6, 90100, buffer, sizeof(buffer), encoded);
+    TEST_ASSERT_EQUAL(6, encoded);
+
+    TelemetryRecord decoded[6];
+    uint32_t now = 0;
+    TEST_ASSERT_EQUAL(6, decodeTelemetryBatch(buffer, length, decoded, 6, now));
+    TEST_ASSERT_EQUAL_UINT32(90100, now);
+    for (size_t i = 0; i < 6; i++) assertSameRecord(records[i], decoded[i]);
+
+    // Truncado ou com lixo no fim: rejeitado inteiro
+    TEST_ASSERT_EQUAL(0, decodeTelemetryBatch(buffer, length - 1, decoded, 6, now));
+    TEST_ASSERT_EQUAL(0, decodeTelemetryBatch(buffer, length, decoded, 5, now));
+}
+
+void test_batch_stops_at_buffer_capacity() {
+    TelemetryRecord records[100];
+    for (uint32_t i = 0; i < 100; i++) {
+        records[i] = makeRecord(i * 60, int16_t(200 + i * 37 % 300), uint16_t(500 + i * 91 % 400), uint8_t(i));
+    }
+    uint8_t buffer[128];
+    size_t encoded = 0;
+    size_t length = encodeTelemetryBatch(records, 100, 6000, buffer, sizeof(buffer), encoded);
+    TEST_ASSERT_TRUE(length <= sizeof(buffer));
+    TEST_ASSERT_TRUE(encoded > 1 && encoded < 100);
+
+    TelemetryRecord decoded[100];
+    uint32_t now = 0;
+    TEST_ASSERT_EQUAL(encoded, decodeTelemetryBatch(buffer, length, decoded, 100, now));
+    assertSameRecord(records[encoded - 1], decoded[encoded - 1]);
+}
+
+void test_log_survives_reboot_and_wraps() {
+    TEST_ASSERT_TRUE(LittleFS.begin(true));
+    {
+        TelemetryLog log;
+        TEST_ASSERT_TRUE(log.begin(TELEMETRY_LOG_PATH, 10));
+        TelemetryRecord records[7];
+        for (uint32_t i = 0; i < 7; i++) records[i] = makeRecord(i, int16_t(i), 0, 0);
+        TEST_ASSERT_TRUE(log.append(records, 7));
+        TEST_ASSERT_TRUE(log.consume(2));
+    }
+
+    // "Reboot": nova instância lê o cabeçalho gravado
+    TelemetryLog log;
+    TEST_ASSERT_TRUE(log.begin(TELEMETRY_LOG_PATH, 10));
+    TEST_ASSERT_EQUAL(5, log.size());
+    TEST_ASSERT_EQUAL_UINT32(6, log.lastTime());
+
+    // 8 novos num log de 10 com 5: dá a volta e perde os 3 mais antigos
+    TelemetryRecord more[8];
+    for (uint32_t i = 0; i < 8; i++) more[i] = makeRecord(7 + i, 0, 0, 0);
+    TEST_ASSERT_TRUE(log.append(more, 8));
+    TEST_ASSERT_EQUAL(10, log.size());
+    TEST_ASSERT_EQUAL(3, log.overwritten());
+
+    TelemetryRecord out[10];
+    TEST_ASSERT_EQUAL(10, log.read(0, out, 10));
+    for (uint32_t i = 0; i < 10; i++) TEST_ASSERT_EQUAL_UINT32(5 + i, out[i].time);
+    TEST_ASSERT_EQUAL(4, log.read(6, out, 10));
+    TEST_ASSERT_EQUAL_UINT32(11, out[0].time);
+
+    // Outra capacidade: o arquivo é recriado vazio
+    TelemetryLog resized;
+    TEST_ASSERT_TRUE(resized.begin(TELEMETRY_LOG_PATH, 20));
+    TEST_ASSERT_EQUAL(0, resized.size());
+}
+
+void test_store_spills_to_flash_in_order() {
+    TEST_ASSERT_TRUE(LittleFS.begin(true));
+    TelemetryLog log;
+    TEST_ASSERT_TRUE(log.begin(TELEMETRY_LOG_PATH, TELEMETRY_LOG_RECORDS));
+    TelemetryStore store;
+    store.begin(&log);
+
+    const uint32_t total = TELEMETRY_RAM_RECORDS * 3 + 5;
+    uint64_t bytesBefore = HostFlash::bytesWritten();
+    for (uint32_t i = 0; i < total; i++) store.append(makeRecord(i, int16_t(i), 0, 0));
+    TEST_ASSERT_EQUAL(total, store.size());
+    TEST_ASSERT_TRUE(store.ramSize() <= TELEMETRY_RAM_RECORDS);
+    TEST_ASSERT_EQUAL(0, store.dropped());
+    // Só blocos inteiros descem, cada um seguido de um cabeçalho
+    uint32_t spills = uint32_t(log.size() / TELEMETRY_SPILL_BLOCK);
+    TEST_ASSERT_EQUAL(spills * TELEMETRY_SPILL_BLOCK, log.size());
+    TEST_ASSERT_EQUAL(spills * (TELEMETRY_SPILL_BLOCK * TELEMETRY_RECORD_BYTES + TelemetryLog::HEADER_BYTES),
+                      HostFlash::bytesWritten() - bytesBefore);
+
+    TelemetryRecord out[40];
+    uint32_t next = 0;
+    while (size_t n = store.peek(out, 40)) {
+        for (size_t i = 0; i < n; i++) TEST_ASSERT_EQUAL_UINT32(next++, out[i].time);
+        store.consume(n);
+    }
+    TEST_ASSERT_EQUAL(total, next);
+    TEST_ASSERT_EQUAL(0, store.size());
+}
+
+void test_store_without_flash_keeps_newest() {
+    TelemetryStore store;
+    store.begin();
+    for (uint32_t i = 0; i < TELEMETRY_RAM_RECORDS + 10; i++) store.append(makeRecord(i, 0, 0, 0));
+    TEST_ASSERT_EQUAL(TELEMETRY_RAM_RECORDS, store.size());
+    TEST_ASSERT_EQUAL(10, store.dropped());
+    TelemetryRecord first;
+    TEST_ASSERT_EQUAL(1, store.peek(&first, 1));
+    TEST_ASSERT_EQUAL_UINT32(10, first.time);
+}
+
+void test_clock_continues_after_reboot() {
+    TEST_ASSERT_TRUE(LittleFS.begin(true));
+    {
+        TelemetryLog log;
+        TEST_ASSERT_TRUE(log.begin(TELEMETRY_LOG_PATH, TELEMETRY_LOG_RECORDS));
+        TelemetryStore store;
+        store.begin(&log);
+        HostClock::advanceMillis(3600000);
+        TEST_ASSERT_EQUAL_UINT32(3600, store.now());
+        // Uma além da RAM força o primeiro bloco para a flash
+        for (uint32_t i = 0; i <= TELEMETRY_RAM_RECORDS; i++) store.append(makeRecord(store.now(), 0, 0, 0));
+        TEST_ASSERT_EQUAL(TELEMETRY_SPILL_BLOCK, log.size());
+    }
+    HostClock::reset();
+    TelemetryLog log;
+    TEST_ASSERT_TRUE(log.begin(TELEMETRY_LOG_PATH, TELEMETRY_LOG_RECORDS));
+    TelemetryStore store;
+    store.begin(&log);
+    TEST_ASSERT_EQUAL_UINT32(3601, store.now());
+}
+
+static void runFor(NetworkManager& network, ACController& ac, uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += LOOP_STEP_MS) {
+        network.update();
+        ac.update();
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+}
+
+void test_outage_backlog_arrives_in_order() {
+    TEST_ASSERT_TRUE(LittleFS.begin(true));
+    TelemetryLog log;
+    TEST_ASSERT_TRUE(log.begin(TELEMETRY_LOG_PATH, TELEMETRY_LOG_RECORDS));
+    TelemetryStore store;
+    store.begin(&log);
+
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    network.attachTelemetry(store);
+    HostDht22::setReading(PIN_DHT, 24.0f, 55.0f);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    runFor(network, ac, 5UL * 60000);
+    uint32_t live = g_received.count;
+    TEST_ASSERT_EQUAL(4, live);
+
+    // Broker fora por 6 h: as amostras descem para a flash
+    FakeBroker::instance().setReachable(false);
+    for (int hour = 0; hour < 6; hour++) {
+        HostDht22::setReading(PIN_DHT, 24.0f + hour, 55.0f - hour);
+        runFor(network, ac, 3600000);
+    }
+    TEST_ASSERT_EQUAL(live, g_received.count);
+    TEST_ASSERT_TRUE(log.size() > 0);
+    size_t backlog = store.size();
+    TEST_ASSERT_EQUAL(360, backlog);
+
+    FakeBroker::instance().setReachable(true);
+    runFor(network, ac, 5UL * 60000);
+
+    TEST_ASSERT_EQUAL(0, g_received.malformed);
+    TEST_ASSERT_EQUAL(0, store.size());
+    TEST_ASSERT_EQUAL(0, store.dropped());
+    // Nenhum buraco: uma amostra por minuto desde o primeiro
+    TEST_ASSERT_EQUAL(live + backlog + 5, g_received.count);
+    TEST_ASSERT_EQUAL_UINT32(60, g_received.records[0].time);
+    for (uint32_t i = 1; i < g_received.count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(g_received.records[i - 1].time + 60, g_received.records[i].time);
+    }
+    // Amostra da 3ª hora da queda
+    const TelemetryRecord& mid = g_received.records[live + 2 * 60 + 30];
+    TEST_ASSERT_EQUAL_INT16(260, mid.temperature);
+    TEST_ASSERT_EQUAL_UINT16(530, mid.humidity);
+
+    // Controle de fluxo: lotes cheios, espaçados de TELEMETRY_UPLOAD_INTERVAL
+    TEST_ASSERT_TRUE(g_received.minGapUs >= TELEMETRY_UPLOAD_INTERVAL * 1000ULL);
+    TEST_ASSERT_LESS_OR_EQUAL(live + (backlog + TELEMETRY_BATCH_RECORDS - 1) / TELEMETRY_BATCH_RECORDS + 5,
+                              g_received.batches);
+
+    char report[160];
+    snprintf(report, sizeof(report), "[telemetria] %u amostras em %u lotes, %.2f bytes/amostra (bruto %u)",
+             (unsigned)g_received.count, (unsigned)g_received.batches,
+             double(g_received.bytes) / g_received.count, (unsigned)TELEMETRY_RECORD_BYTES);
+    TEST_MESSAGE(report);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_record_from_status_and_packing);
+    RUN_TEST(test_batch_round_trip_with_gaps_and_state_changes);
+    RUN_TEST(test_batch_stops_at_buffer_capacity);
+    RUN_TEST(test_log_survives_reboot_and_wraps);
+    RUN_TEST(test_store_spills_to_flash_in_order);
+    RUN_TEST(test_store_without_flash_keeps_newest);
+    RUN_TEST(test_clock_continues_after_reboot);
+    RUN_TEST(test_outage_backlog_arrives_in_order);
+    return UNITY_END();
+}
@@ -0,0 +1,338 @@
+#include <unity.h>
+#include <stdio.h>
+#include <FakeBroker.h>
+#include <HostDht22.h>
+#include <HostIRLog.h>
+#include <HostRoom.h>
+#include "config.h"
+#include "ACController.h"
+#include "CommandCodec.h"
+#include "NetworkManager.h"
+#include "Thermostat.h"
+
+static const uint32_t LOOP_STEP_MS = 50;
+
+static const ThermostatPolicy POLICY{true, 10, 180, 180, 16, 30};
+static const uint8_t ALL_FIELDS = 0x3F;
+
+void setUp() {
+    HostClock::reset();
+    HostIRLog::reset();
+    HostDht22::reset();
+    FakeBroker::instance().reset();
+    WiFi.hostReset();
+}
+
+void tearDown() {}
+
+// O aparelho visto pelo IR: liga/desliga e modo a partir dos códigos NEC
+struct Unit {
+    bool on;
+    uint32_t mode;
+    uint32_t seen;
+    uint32_t frames;
+
+    bool cooling() const { return on && mode == IRCodes::MODE_COOL; }
+
+    void receive() {
+        while (seen < HostIRLog::count()) {
+            const HostIRFrame* frame = HostIRLog::at(seen++);
+            if (!frame || frame->protocol != HostIRProtocol::NEC) continue;
+            frames++;
+            if (frame->data == IRCodes::POWER_ON) on = true;
+            if (frame->data == IRCodes::POWER_OFF) on = false;
+            if (frame->data == IRCodes::MODE_COOL || frame->data == IRCodes::MODE_FAN
+                || frame->data == IRCodes::MODE_AUTO) {
+                mode = frame->data;
+            }
+        }
+    }
+};
+
+// Malha fechada: sala -> DHT22 -> ACController -> IR -> aparelho -> sala
+struct Simulation {
+    HostRoom room;
+    Unit unit;
+    uint64_t compressorOnMs;
+    uint64_t shortestOnMs;      // menor ciclo completo do compressor
+    uint64_t shortestOffMs;
+    uint64_t lastSwitchMs;
+    bool lastCooling;
+    uint32_t starts;
+    bool switched;
+};
+
+static void simulate(Simulation& sim, ACController& ac, NetworkManager* network, uint64_t durationMs,
+                     void (*sample)(Simulation&, uint64_t) = nullptr) {
+    for (uint64_t t = 0; t < durationMs; t += LOOP_STEP_MS) {
+        HostDht22::setReading(PIN_DHT, sim.room.temperature, 50.0f);
+        if (network) network->update();
+        ac.update();
+        sim.unit.receive();
+
+        bool cooling = sim.unit.cooling();
+        uint64_t now = HostClock::nowMicros() / 1000;
+        if (cooling != sim.lastCooling) {
+            uint64_t spent = now - sim.lastSwitchMs;
+            // O primeiro trecho não é um ciclo completo
+            if (sim.switched) {
+                uint64_t& shortest = sim.lastCooling ? sim.shortestOnMs : sim.shortestOffMs;
+                if (spent < shortest) shortest = spent;
+            }
+            if (cooling) sim.starts++;
+            sim.switched = true;
+            sim.lastCooling = cooling;
+            sim.lastSwitchMs = now;
+        }
+        if (cooling) sim.compressorOnMs += LOOP_STEP_MS;
+        sim.room.step(LOOP_STEP_MS / 1000.0f, cooling);
+        if (sample) sample(sim, t);
+        HostClock::advanceMillis(LOOP_STEP_MS);
+    }
+}
+
+static Simulation makeSimulation(float start) {
+    Simulation sim{};
+    // 32 °C lá fora, paredes com 2 h de constante, compressor retira 14,4 °C/h
+    sim.room = HostRoom{start, 32.0f, 7200.0f, 0.004f};
+    sim.shortestOnMs = UINT64_MAX;
+    sim.shortestOffMs = UINT64_MAX;
+    return sim;
+}
+
+void test_hysteresis_band() {
+    Thermostat thermostat;
+    TEST_ASSERT_TRUE(thermostat.setPolicy(ThermostatPolicy{true, 10, 0, 0, 16, 30}, ALL_FIELDS));
+
+    // Banda de 1,0 °C em torno de 24: chama em 24,5 e libera em 23,5
+    TEST_ASSERT_FALSE(thermostat.update(24.4f, true, 24, 0));
+    TEST_ASSERT_FALSE(thermostat.demand());
+    TEST_ASSERT_TRUE(thermostat.update(24.5f, true, 24, 1000));
+    TEST_ASSERT_TRUE(thermostat.demand());
+    TEST_ASSERT_FALSE(thermostat.update(23.6f, true, 24, 2000));
+    TEST_ASSERT_TRUE(thermostat.demand());
+    TEST_ASSERT_TRUE(thermostat.update(23.5f, true, 24, 3000));
+    TEST_ASSERT_FALSE(thermostat.demand());
+    TEST_ASSERT_FALSE(thermostat.update(24.0f, true, 24, 4000));
+    TEST_ASSERT_EQUAL(1, thermostat.starts());
+}
+
+void test_minimum_on_and_off_times() {
+    Thermostat thermostat;
+    TEST_ASSERT_TRUE(thermostat.setPolicy(POLICY, ALL_FIELDS));
+
+    // A primeira decisão não espera
+    TEST_ASSERT_TRUE(thermostat.update(26.0f, true, 24, 5000));
+    // Já frio, mas ligado há menos de 180 s
+    TEST_ASSERT_FALSE(thermostat.update(22.0f, true, 24, 5000 + 179999));
+    TEST_ASSERT_TRUE(thermostat.demand());
+    TEST_ASSERT_TRUE(thermostat.update(22.0f, true, 24, 5000 + 180000));
+    TEST_ASSERT_FALSE(thermostat.demand());
+    // Quente de novo logo depois: espera o mínimo parado
+    TEST_ASSERT_FALSE(thermostat.update(27.0f, true, 24, 185000 + 60000));
+    TEST_ASSERT_TRUE(thermostat.update(27.0f, true, 24, 185000 + 180000));
+
+    // A volta do millis() a cada 49 dias não libera antes da hora
+    Thermostat wrapped;
+    TEST_ASSERT_TRUE(wrapped.setPolicy(POLICY, ALL_FIELDS));
+    TEST_ASSERT_TRUE(wrapped.update(26.0f, true, 24, UINT32_MAX - 1000));
+    TEST_ASSERT_FALSE(wrapped.update(22.0f, true, 24, 60000));
+    TEST_ASSERT_TRUE(wrapped.update(22.0f, true, 24, 179000));
+}
+
+void test_invalid_reading_returns_control_to_unit() {
+    Thermostat thermostat;
+    TEST_ASSERT_TRUE(thermostat.setPolicy(ThermostatPolicy{true, 10, 0, 0, 16, 30}, ALL_FIELDS));
+    TEST_ASSERT_FALSE(thermostat.update(20.0f, true, 24, 0));
+    TEST_ASSERT_TRUE(thermostat.update(NAN, false, 24, 1000));
+    TEST_ASSERT_TRUE(thermostat.demand());
+}
+
+void test_policy_validation_and_limits() {
+    Thermostat thermostat;
+    TEST_ASSERT_TRUE(thermostat.setPolicy(POLICY, ALL_FIELDS));
+
+    // Só os campos presentes mudam
+    ThermostatPolicy partial{};
+    partial.maxTemp = 26;
+    TEST_ASSERT_TRUE(thermostat.setPolicy(partial, THERMOSTAT_FIELD_MAX_TEMP));
+    TEST_ASSERT_TRUE(thermostat.enabled());
+    TEST_ASSERT_EQUAL(10, thermostat.policy().hysteresis);
+    TEST_ASSERT_EQUAL(26, thermostat.policy().maxTemp);
+
+    // Mínima acima da máxima (com a máxima atual) é rejeitada sem efeito
+    partial.minTemp = 27;
+    TEST_ASSERT_FALSE(thermostat.setPolicy(partial, THERMOSTAT_FIELD_MIN_TEMP));
+    TEST_ASSERT_EQUAL(16, thermostat.policy().minTemp);
+    partial.hysteresis = 0;
+    TEST_ASSERT_FALSE(thermostat.setPolicy(partial, THERMOSTAT_FIELD_HYSTERESIS));
+
+    // O setpoint fora da faixa da Configuracao é mantido no limite
+    TEST_ASSERT_EQUAL(26, thermostat.clampSetpoint(30));
+    TEST_ASSERT_EQUAL(18, thermostat.clampSetpoint(18));
+    thermostat.update(25.8f, true, 30, 0);
+    TEST_ASSERT_FALSE(thermostat.demand());
+    thermostat.update(26.5f, true, 30, 1000);
+    TEST_ASSERT_TRUE(thermostat.demand());
+}
+
+static CommandParseResult parse(const char* json, ACCommand& command) {
+    return parseCommandJson(reinterpret_cast<const uint8_t*>(json), strlen(json), command);
+}
+
+void test_parse_thermostat_command() {
+    ACCommand command;
+    TEST_ASSERT_EQUAL(CommandParseResult::OK,
+                      parse("{\"comando\":\"TERMOSTATO\",\"parametros\":{\"ativo\":true,\"histerese\":8,"
+                            "\"minLigado\":240,\"minDesligado\":300,\"temperaturaMin\":18,\"temperaturaMax\":26}}",
+                            command));
+    TEST_ASSERT_EQUAL(ACCommandType::SET_THERMOSTAT, command.type);
+    TEST_ASSERT_EQUAL(ALL_FIELDS, command.fields);
+    TEST_ASSERT_TRUE(command.policy.enabled);
+    TEST_ASSERT_EQUAL(8, command.policy.hysteresis);
+    TEST_ASSERT_EQUAL(240, command.policy.minOnSeconds);
+    TEST_ASSERT_EQUAL(300, command.policy.minOffSeconds);
+    TEST_ASSERT_EQUAL(18, command.policy.minTemp);
+    TEST_ASSERT_EQUAL(26, command.policy.maxTemp);
+
+    TEST_ASSERT_EQUAL(CommandParseResult::OK,
+                      parse("{\"comando\":\"TERMOSTATO\",\"parametros\":{\"ativo\":false}}", command));
+    TEST_ASSERT_EQUAL(THERMOSTAT_FIELD_ENABLED, command.fields);
+    TEST_ASSERT_FALSE(command.policy.enabled);
+
+    TEST_ASSERT_EQUAL(CommandParseResult::INVALID_PARAMETER,
+                      parse("{\"comando\":\"TERMOSTATO\",\"parametros\":{}}", command));
+    TEST_ASSERT_EQUAL(CommandParseResult::INVALID_PARAMETER,
+                      parse("{\"comando\":\"TERMOSTATO\",\"parametros\":{\"histerese\":0}}", command));
+    TEST_ASSERT_EQUAL(CommandParseResult::INVALID_PARAMETER,
+                      parse("{\"comando\":\"TERMOSTATO\",\"parametros\":{\"minLigado\":4000}}", command));
+    TEST_ASSERT_EQUAL(CommandParseResult::INVALID_PARAMETER,
+                      parse("{\"comando\":\"TERMOSTATO\",\"parametros\":{\"temperaturaMax\":31}}", command));
+}
+
+void test_disabled_thermostat_leaves_unit_alone() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    ac.setMode(ACMode::COOL);
+    ac.turnOn();
+    Simulation sim = makeSimulation(22.0f);
+    simulate(sim, ac, nullptr, 600000);
+
+    // Frio demais, mas sem política o compressor segue com o aparelho
+    TEST_ASSERT_TRUE(sim.unit.cooling());
+    TEST_ASSERT_EQUAL(ACMode::COOL, ac.getEffectiveMode());
+    TEST_ASSERT_FALSE(ac.getStatus().thermostatEnabled);
+}
+
+void test_regulates_to_setpoint_in_closed_loop() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    TEST_ASSERT_TRUE(ac.setThermostat(POLICY, ALL_FIELDS));
+    ac.setTemperature(24);
+    ac.setMode(ACMode::COOL);
+    ac.turnOn();
+
+    Simulation sim = makeSimulation(30.0f);
+    // Assentou: primeira entrada na banda com folga de 0,5 °C; depois disso
+    // mede o pior afastamento (o filtro do sensor atrasa a leitura)
+    static uint64_t settledAtMs;
+    static float worstAfterSettle;
+    settledAtMs = UINT64_MAX;
+    worstAfterSettle = 0.0f;
+    simulate(sim, ac, nullptr, 6ULL * 3600 * 1000, [](Simulation& s, uint64_t t) {
+        float error = fabsf(s.room.temperature - 24.0f);
+        if (settledAtMs == UINT64_MAX && error <= 1.0f) settledAtMs = t;
+        if (settledAtMs != UINT64_MAX && error > worstAfterSettle) worstAfterSettle = error;
+    });
+
+    char report[200];
+    snprintf(report, sizeof(report),
+             "[termostato] 30->24 C: assentou em %.1f min, erro máx depois %.2f C, %u partidas em 6 h, "
+             "compressor %.0f%% do tempo, %u quadros IR",
+             settledAtMs / 60000.0, double(worstAfterSettle), (unsigned)sim.starts,
+             100.0 * sim.compressorOnMs / (6.0 * 3600 * 1000), (unsigned)sim.unit.frames);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_TRUE(settledAtMs < 60ULL * 60 * 1000);
+    TEST_ASSERT_TRUE(worstAfterSettle <= 1.0f);
+    // Tempos mínimos nunca violados (a medição tem a resolução do passo)
+    TEST_ASSERT_TRUE(sim.shortestOnMs + LOOP_STEP_MS >= POLICY.minOnSeconds * 1000ULL);
+    TEST_ASSERT_TRUE(sim.shortestOffMs + LOOP_STEP_MS >= POLICY.minOffSeconds * 1000ULL);
+    // Cada ciclo custa dois quadros (REFRIGERAR e VENTILAR) e nada mais
+    TEST_ASSERT_TRUE(sim.unit.frames <= 2 * sim.starts + 4);
+    TEST_ASSERT_TRUE(sim.starts >= 6);
+}
+
+void test_power_cycle_respects_minimum_off() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    ac.begin();
+    TEST_ASSERT_TRUE(ac.setThermostat(POLICY, ALL_FIELDS));
+    ac.setTemperature(24);
+    ac.setMode(ACMode::COOL);
+    ac.turnOn();
+
+    Simulation sim = makeSimulation(28.0f);
+    simulate(sim, ac, nullptr, 60000);
+    TEST_ASSERT_TRUE(sim.unit.cooling());
+
+    // Desligado e religado à mão: o compressor espera o mínimo parado e,
+    // até lá, o aparelho recebe VENTILAR
+    ac.turnOff();
+    simulate(sim, ac, nullptr, 30000);
+    ac.turnOn();
+    simulate(sim, ac, nullptr, 1000);
+    TEST_ASSERT_TRUE(sim.unit.on);
+    TEST_ASSERT_FALSE(sim.unit.cooling());
+    TEST_ASSERT_EQUAL(ACMode::FAN, ac.getEffectiveMode());
+    TEST_ASSERT_EQUAL(ACMode::COOL, ac.getMode());
+
+    simulate(sim, ac, nullptr, 150000);
+    TEST_ASSERT_TRUE(sim.unit.cooling());
+    TEST_ASSERT_TRUE(ac.getStatus().thermostatDemand);
+}
+
+void test_keeps_regulating_through_broker_outage() {
+    ACController ac(PIN_IR_LED, PIN_DHT);
+    NetworkManager network(DEVICE_ID, ac);
+    ac.begin();
+    network.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT, MQTT_USER, MQTT_PASSWORD);
+    for (int step = 0; step < 8 && !network.isConnected(); step++) {
+        network.update();
+    }
+    TEST_ASSERT_TRUE(network.isConnected());
+
+    // O servidor só define a política e o setpoint
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC,
+        "{\"comando\":\"TERMOSTATO\",\"parametros\":{\"ativo\":true,\"histerese\":10,"
+        "\"minLigado\":180,\"minDesligado\":180,\"temperaturaMin\":18,\"temperaturaMax\":26}}");
+    FakeBroker::instance().inject(MQTT_COMMAND_TOPIC,
+        "{\"comando\":\"SET_STATE\",\"parametros\":{\"ligado\":true,\"temperatura\":24,\"modo\":\"REFRIGERAR\"}}");
+    Simulation sim = makeSimulation(29.0f);
+    simulate(sim, ac, &network, 1000);
+    TEST_ASSERT_TRUE(ac.thermostat().enabled());
+
+    const FakeMessage* status = FakeBroker::instance().retained(MQTT_STATUS_TOPIC);
+    TEST_ASSERT_NOT_NULL(status);
+    TEST_ASSERT_NOT_NULL(strstr(status->text(), "\"termostato\":{\"ativo\":true,\"demanda\":true}"));
+
+    // Broker fora por 4 h: a sala continua regulada
+    FakeBroker::instance().setReachable(false);
+    simulate(sim, ac, &network, 4ULL * 3600 * 1000);
+    TEST_ASSERT_FALSE(network.isConnected());
+    TEST_ASSERT_TRUE(fabsf(sim.room.temperature - 24.0f) <= 1.0f);
+    TEST_ASSERT_TRUE(sim.starts >= 4);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hysteresis_band);
+    RUN_TEST(test_minimum_on_and_off_times);
+    RUN_TEST(test_invalid_reading_returns_control_to_unit);
+    RUN_TEST(test_policy_validation_and_limits);
+    RUN_TEST(test_parse_thermostat_command);
+    RUN_TEST(test_disabled_thermostat_leaves_unit_alone);
+    RUN_TEST(test_regulates_to_setpoint_in_closed_loop);
+    RUN_TEST(test_power_cycle_respects_minimum_off);
+    RUN_TEST(test_keeps_regulating_through_broker_outage);
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+// Gerador de carga da frota: N dispositivos simulados (firmware real,
+// compilado para o host) contra o FakeBroker ou um Mosquitto local.
+//
+//   pio run -e fleet
+//   .pio/build/fleet/program --dispositivos 500 --taxa 20 --duracao 600
+//   .pio/build/fleet/program --broker localhost:1883 --dispositivos 200 --duracao 120
+//
+// Ver esp32/README.md (Simulador de frota) para o significado de cada número.
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FleetSim.h"
+
+namespace {
+
+void usage(const char* program) {
+    fprintf(stderr,
+            "uso: %s [opções]\n"
+            "  --dispositivos N    dispositivos simulados (padrão 100)\n"
+            "  --taxa C            comandos por segundo para a frota toda (padrão 5)\n"
+            "  --duracao S         segundos medidos depois de todos conectarem (padrão 600)\n"
+            "  --broker HOST[:P]   broker MQTT real (padrão: FakeBroker em processo, tempo virtual)\n"
+            "  --usuario U         usuário do broker (padrão MQTT_USER)\n"
+            "  --senha S           senha do broker (padrão MQTT_PASSWORD)\n"
+            "  --prefixo P         prefixo dos IDs, P_00000... (padrão SIM)\n"
+            "  --semente N         semente da carga (padrão 1)\n"
+            "  --cbor              comandos e status em CBOR em vez de JSON\n",
+            program);
+}
+
+double ms(uint32_t us) {
+    return us / 1000.0;
+}
+
+void printReport(const FleetReport& r, const FleetConfig& config) {
+    double seconds = r.windowMs / 1000.0;
+    if (r.realBroker) {
+        printf("frota: %u dispositivos, %u conectados, broker %s:%u\n",
+               r.devices, r.connected, config.broker, config.port);
+    } else {
+        printf("frota: %u dispositivos, %u conectados, FakeBroker em processo\n", r.devices, r.connected);
+    }
+    printf("codificação: %s\n", wireFormatName(config.wireFormat));
+    printf("janela: %.1f s %s em %.1f s reais\n", seconds, r.realBroker ? "medidos" : "simulados", r.wallSeconds);
+    printf("comandos: %u enviados, %u respondidos, %u sem resposta, %u adiados (%.2f/s)\n",
+           r.commandsSent, r.commandsAnswered, r.commandsUnanswered, r.commandsDeferred,
+           seconds > 0 ? r.commandsSent / seconds : 0.0);
+    printf("latência comando->status (ms): p50 %.1f  p90 %.1f  p99 %.1f  máx %.1f\n",
+           ms(r.latencyP50Us), ms(r.latencyP90Us), ms(r.latencyP99Us), ms(r.latencyMaxUs));
+    printf("publicações dos dispositivos: %u (%.1f/s, %.2f/s por dispositivo), %.1f KB no total\n",
+           r.traffic.fromDevices(), r.publishRate(),
+           r.devices ? r.publishRate() / r.devices : 0.0, r.traffic.bytes / 1024.0);
+    printf("  status %u  delta %u  telemetria %u  diagnostico %u  erro %u  comando %u  outros %u\n",
+           r.traffic.status, r.traffic.delta, r.traffic.telemetry, r.traffic.diagnostics,
+           r.traffic.errors, r.traffic.commands, r.traffic.other);
+    if (r.brokerCountsAvailable) {
+        printf("broker: %u mensagens recebidas, %u enviadas (%.1f/s e %.1f/s)\n",
+               r.brokerReceived, r.brokerSent,
+               seconds > 0 ? r.brokerReceived / seconds : 0.0, seconds > 0 ? r.brokerSent / seconds : 0.0);
+    } else {
+        printf("broker: contadores $SYS indisponíveis (janela menor que o sys_interval?)\n");
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    static const option OPTIONS[] = {
+        {"dispositivos", required_argument, nullptr, 'n'},
+        {"taxa", required_argument, nullptr, 'c'},
+        {"duracao", required_argument, nullptr, 'd'},
+        {"broker", required_argument, nullptr, 'b'},
+        {"usuario", required_argument, nullptr, 'u'},
+        {"senha", required_argument, nullptr, 'p'},
+        {"prefixo", required_argument, nullptr, 'x'},
+        {"semente", required_argument, nullptr, 's'},
+        {"cbor", no_argument, nullptr, 'f'},
+        {"ajuda", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    FleetConfig config;
+    static char host[256];
+    int option;
+    while ((option = getopt_long(argc, argv, "n:c:d:b:u:p:x:s:fh", OPTIONS, nullptr)) != -1) {
+        switch (option) {
+            case 'n': config.devices = uint16_t(atoi(optarg)); break;
+            case 'c': config.commandsPerSecond = float(atof(optarg)); break;
+            case 'd': config.durationMs = uint32_t(atof(optarg) * 1000); break;
+            case 'b': {
+                strncpy(host, optarg, sizeof(host) - 1);
+                char* colon = strrchr(host, ':');
+                if (colon) {
+                    *colon = '\0';
+                    config.port = uint16_t(atoi(colon + 1));
+                }
+                config.broker = host;
+                break;
+            }
+            case 'u': config.user = optarg; break;
+            case 'p': config.password = optarg; break;
+            case 'x': config.idPrefix = optarg; break;
+            case 's': config.seed = uint32_t(strtoul(optarg, nullptr, 10)); break;
+            case 'f': config.wireFormat = WireFormat::CBOR; break;
+            default:
+                usage(argv[0]);
+                return option == 'h' ? 0 : 2;
+        }
+    }
+    if (config.devices == 0 || config.commandsPerSecond < 0 || config.durationMs == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FleetSim fleet(config);
+    if (!fleet.begin()) {
+        return 1;
+    }
+    fleet.run();
+    printReport(fleet.report(), config);
+    return 0;
+}
@@ -0,0 +1,237 @@
+// Gateway de agregação da frota: assina os status dos dispositivos e
+// publica os resumos em ac-control/sistema/... (ver MQTT.md, Sistema).
+//
+//   pio run -e gateway
+//   .pio/build/gateway/program --broker localhost:1883 --mapa salas.csv
+//   .pio/build/gateway/program --carga 10000 --broker localhost:1883
+//
+// Ver esp32/README.md (Gateway da frota) para o mapa de salas e o banco de carga.
+#include <getopt.h>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Backoff.h"
+#include "FleetGateway.h"
+#include "GatewayLoad.h"
+
+namespace {
+
+const char DEVICE_FILTER[] = "ac-control/dispositivos/+/status/#";
+const uint32_t STEP_MS = 10;
+const uint32_t REPORT_INTERVAL_MS = 60000;
+
+struct Options {
+    const char* broker = "localhost";
+    uint16_t port = MQTT_PORT;
+    const char* user = MQTT_USER;
+    const char* password = MQTT_PASSWORD;
+    const char* map = nullptr;
+    uint32_t intervalMs = 1000;
+    uint32_t offlineMs = 300000;
+    bool brokerGiven = false;
+
+    uint32_t loadDevices = 0;       // --carga
+    float loadRate = 0.2f;
+    uint32_t loadDurationMs = 30000;
+    uint8_t connections = 8;
+    bool cbor = false;
+};
+
+void usage(const char* program) {
+    fprintf(stderr,
+            "uso: %s [opções]\n"
+            "  --broker HOST[:P]   broker MQTT (padrão localhost:%u)\n"
+            "  --usuario U         usuário do broker (padrão MQTT_USER)\n"
+            "  --senha S           senha do broker (padrão MQTT_PASSWORD)\n"
+            "  --mapa ARQ          salas: \"idEsp32;bloco;sala\" por linha\n"
+            "  --intervalo MS      publicação dos resumos (padrão 1000)\n"
+            "  --offline S         sem mensagem há S segundos = offline (padrão 300)\n"
+            "\n"
+            "banco de carga (sem --broker: FakeBroker em processo):\n"
+            "  --carga N           N dispositivos sintéticos\n"
+            "  --taxa R            status por segundo por dispositivo (padrão 0.2)\n"
+            "  --duracao S         segundos em regime (padrão 30)\n"
+            "  --conexoes K        conexões dos publicadores no broker real (padrão 8)\n"
+            "  --cbor              status em CBOR em vez de JSON\n",
+            program, MQTT_PORT);
+}
+
+double ms(uint32_t us) {
+    return us / 1000.0;
+}
+
+int runLoad(const Options& options) {
+    GatewayLoadConfig config;
+    config.devices = options.loadDevices;
+    config.statusPerSecond = options.loadRate;
+    config.durationMs = options.loadDurationMs;
+    config.publishIntervalMs = options.intervalMs;
+    config.broker = options.brokerGiven ? options.broker : nullptr;
+    config.port = options.port;
+    config.user = options.user;
+    config.password = options.password;
+    config.connections = options.connections;
+    config.wireFormat = options.cbor ? WireFormat::CBOR : WireFormat::JSON;
+
+    GatewayLoad load(config);
+    if (!load.begin()) return 1;
+    load.runBurst();
+    load.runSteady();
+
+    GatewayLoadReport r = load.report();
+    if (r.realBroker) {
+        printf("carga: %u dispositivos, broker %s:%u, %u conexões\n", r.devices, config.broker, config.port,
+               config.connections);
+    } else {
+        printf("carga: %u dispositivos, FakeBroker em processo\n", r.devices);
+    }
+    printf("codificação: %s\n", wireFormatName(config.wireFormat));
+    printf("rajada: %u status em %.3f s (%.0f mensagens/s)\n", r.burstMessages, r.burstSeconds, r.burstRate());
+    printf("regime: %.1f s, %u enviados, %u agregados (%.0f mensagens/s), %u rejeitados\n",
+           r.windowMs / 1000.0, r.sent, r.gateway.messages, r.steadyRate(), r.gateway.rejected);
+    printf("defasagem mudança->resumo (ms): p50 %.1f  p90 %.1f  p99 %.1f  máx %.1f  (%u amostras)\n",
+           ms(r.gateway.lagP50Us), ms(r.gateway.lagP90Us), ms(r.gateway.lagP99Us), ms(r.gateway.lagMaxUs),
+           r.gateway.lagSamples);
+    printf("resumos publicados: %u (%.1f/s)\n", r.summaries, r.windowMs ? r.summaries * 1000.0 / r.windowMs : 0.0);
+    return 0;
+}
+
+uint64_t wallMicros() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool publishSummary(const char* topic, const uint8_t* payload, size_t length, bool retained, void* context) {
+    return static_cast<PubSubClient*>(context)->publish(topic, payload, unsigned(length), retained);
+}
+
+int runGateway(const Options& options) {
+    GatewayConfig config;
+    config.publishIntervalMs = options.intervalMs;
+    config.offlineMs = options.offlineMs;
+    FleetGateway gateway(config);
+    if (options.map) {
+        int assigned = gateway.loadAssignments(options.map);
+        if (assigned < 0) {
+            fprintf(stderr, "Mapa %s não abriu\n", options.map);
+            return 1;
+        }
+        printf("mapa: %d dispositivos em salas\n", assigned);
+    }
+
+    const uint64_t origin = wallMicros();
+    auto nowMicros = [origin] { return wallMicros() - origin; };
+
+    WiFi.hostReset();
+    WiFi.hostUseRealNetwork(true);
+    WiFi.begin(nullptr, nullptr);
+    WiFiClient socket;
+    PubSubClient client(socket);
+    client.setServer(options.broker, options.port);
+    client.setBufferSize(FAKE_BROKER_TOPIC_SIZE + FAKE_BROKER_PAYLOAD_SIZE);
+    client.setCallback([&gateway, &nowMicros](char* topic, byte* payload, unsigned int length) {
+        gateway.ingest(topic, payload, length, nowMicros());
+    });
+
+    Backoff backoff(RECONNECT_BACKOFF_MIN, RECONNECT_BACKOFF_MAX);
+    uint64_t retryAt = 0;
+    uint64_t reportAt = uint64_t(REPORT_INTERVAL_MS) * 1000;
+    for (;;) {
+        uint64_t now = nowMicros();
+        // O relógio virtual (keepalive do PubSubClient) segue o real
+        uint64_t virtualNow = HostClock::nowMicros();
+        if (now > virtualNow) HostClock::advanceMicros(now - virtualNow);
+
+        if (!client.connected()) {
+            if (now < retryAt) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(STEP_MS));
+                continue;
+            }
+            if (socket.connect(options.broker, options.port, MQTT_CONNECT_TIMEOUT)
+                && client.connect("gateway_frota", options.user, options.password)
+                && client.subscribe(DEVICE_FILTER)) {
+                printf("conectado a %s:%u\n", options.broker, options.port);
+                backoff.reset();
+            } else {
+                uint32_t delayMs = backoff.next();
+                fprintf(stderr, "Sem conexão com %s:%u (estado %d); nova tentativa em %u ms\n",
+                        options.broker, options.port, client.state(), delayMs);
+                retryAt = now + uint64_t(delayMs) * 1000;
+                continue;
+            }
+        }
+        client.loop();
+        gateway.publishDue(nowMicros(), uint32_t(time(nullptr)), publishSummary, &client);
+
+        if (now >= reportAt) {
+            reportAt = now + uint64_t(REPORT_INTERVAL_MS) * 1000;
+            GatewayStats stats = gateway.stats();
+            printf("%zu/%zu online, %u mensagens (%u rejeitadas), %u resumos, defasagem p99 %.1f ms\n",
+                   gateway.online(), gateway.devices(), stats.messages, stats.rejected, stats.publishes,
+                   ms(stats.lagP99Us));
+            fflush(stdout);
+            gateway.resetStats();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(STEP_MS));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    static const option OPTIONS[] = {
+        {"broker", required_argument, nullptr, 'b'},
+        {"usuario", required_argument, nullptr, 'u'},
+        {"senha", required_argument, nullptr, 'p'},
+        {"mapa", required_argument, nullptr, 'm'},
+        {"intervalo", required_argument, nullptr, 'i'},
+        {"offline", required_argument, nullptr, 'o'},
+        {"carga", required_argument, nullptr, 'n'},
+        {"taxa", required_argument, nullptr, 'r'},
+        {"duracao", required_argument, nullptr, 'd'},
+        {"conexoes", required_argument, nullptr, 'k'},
+        {"cbor", no_argument, nullptr, 'f'},
+        {"ajuda", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    Options options;
+    static char host[256];
+    int option;
+    while ((option = getopt_long(argc, argv, "b:u:p:m:i:o:n:r:d:k:fh", OPTIONS, nullptr)) != -1) {
+        switch (option) {
+            case 'b': {
+                strncpy(host, optarg, sizeof(host) - 1);
+                char* colon = strrchr(host, ':');
+                if (colon) {
+                    *colon = '\0';
+                    options.port = uint16_t(atoi(colon + 1));
+                }
+                options.broker = host;
+                options.brokerGiven = true;
+                break;
+            }
+            case 'u': options.user = optarg; break;
+            case 'p': options.password = optarg; break;
+            case 'm': options.map = optarg; break;
+            case 'i': options.intervalMs = uint32_t(atoi(optarg)); break;
+            case 'o': options.offlineMs = uint32_t(atof(optarg) * 1000); break;
+            case 'n': options.loadDevices = uint32_t(atoi(optarg)); break;
+            case 'r': options.loadRate = float(atof(optarg)); break;
+            case 'd': options.loadDurationMs = uint32_t(atof(optarg) * 1000); break;
+            case 'k': options.connections = uint8_t(atoi(optarg)); break;
+            case 'f': options.cbor = true; break;
+            default:
+                usage(argv[0]);
+                return option == 'h' ? 0 : 2;
+        }
+    }
+    if (options.intervalMs == 0 || options.offlineMs == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    return options.loadDevices ? runLoad(options) : runGateway(options);
+}
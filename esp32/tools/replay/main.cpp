@@ -0,0 +1,288 @@
+// Reprodução de gravações do dispositivo (InputRecorder) contra este
+// firmware, em tempo virtual, e comparação com o relatório de outra versão:
+// as saídas, a latência de cada comando e a CPU por passo (ver
+// esp32/README.md, Gravação e reprodução).
+//
+//   pio run -e replay
+//   .pio/build/replay/program --baixar ESP32_001 --broker localhost:1883
+//   .pio/build/replay/program gravacao-ESP32_001.bin --relatorio base.txt
+//   (outra versão) .pio/build/replay/program gravacao-ESP32_001.bin --comparar base.txt
+//
+// Saída 0 sem diferenças, 1 com diferenças ou falha, 2 em erro de uso.
+#include <getopt.h>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <WiFi.h>
+#include "InputRecorder.h"
+#include "InputReplayer.h"
+#include "MqttTopics.h"
+#include "ReplayReport.h"
+
+namespace {
+
+const uint32_t STEP_MS = 10;
+const uint32_t DOWNLOAD_TIMEOUT_MS = 120000;
+
+struct Options {
+    const char* recording = nullptr;
+    const char* report = nullptr;       // --relatorio
+    const char* base = nullptr;         // --comparar
+    const char* diffA = nullptr;        // --diferenca A B
+    const char* diffB = nullptr;
+    float tolerance = 0.25f;
+    uint32_t tailMs = 5000;
+
+    const char* download = nullptr;     // --baixar ID
+    bool previous = false;
+    const char* output = nullptr;
+    const char* broker = "localhost";
+    uint16_t port = MQTT_PORT;
+    const char* user = MQTT_USER;
+    const char* password = MQTT_PASSWORD;
+};
+
+void usage(const char* program) {
+    fprintf(stderr,
+            "uso: %s GRAVACAO [opções]\n"
+            "  --relatorio ARQ     grava o relatório em ARQ (padrão: saída padrão)\n"
+            "  --comparar BASE     compara com o relatório BASE de outra versão\n"
+            "  --tolerancia P      CPU a mais aceita na comparação (padrão 0.25)\n"
+            "  --cauda MS          roda mais MS depois do último evento (padrão 5000)\n"
+            "\n"
+            "   ou: %s --diferenca A B [--tolerancia P]\n"
+            "  compara dois relatórios já gravados\n"
+            "\n"
+            "   ou: %s --baixar ID --broker HOST[:P] [opções]\n"
+            "  --anterior          a gravação do boot anterior\n"
+            "  --saida ARQ         destino (padrão gravacao-ID.bin)\n"
+            "  --usuario U         usuário do broker (padrão MQTT_USER)\n"
+            "  --senha S           senha do broker (padrão MQTT_PASSWORD)\n",
+            program, program, program);
+}
+
+bool readFile(const char* path, std::vector<uint8_t>& bytes) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.insert(bytes.end(), buffer, buffer + read);
+    fclose(file);
+    return true;
+}
+
+bool readReport(const char* path, ReplayReport& report) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Relatório %s não abriu\n", path);
+        return false;
+    }
+    std::string error;
+    bool ok = readReplayReport(file, report, error);
+    fclose(file);
+    if (!ok) fprintf(stderr, "%s: %s\n", path, error.c_str());
+    return ok;
+}
+
+int compare(const ReplayReport& base, const ReplayReport& current, const Options& options) {
+    ReplayTolerance tolerance;
+    tolerance.cpu = options.tolerance;
+    ReplayDiff diff = compareReplayReports(base, current, tolerance, stdout);
+    printf("%s -> %s: %u faltando, %u a mais, %u deslocadas, %u comandos mais lentos, %u acima da CPU\n",
+           base.firmware.c_str(), current.firmware.c_str(), diff.missing, diff.extra, diff.shifted, diff.slower,
+           diff.cpu);
+    return diff.any() ? 1 : 0;
+}
+
+int runReplay(const Options& options) {
+    std::vector<uint8_t> recording;
+    if (!readFile(options.recording, recording)) {
+        fprintf(stderr, "Gravação %s não abriu\n", options.recording);
+        return 1;
+    }
+    ReplayReport base;
+    if (options.base && !readReport(options.base, base)) return 1;
+
+    ReplayConfig config;
+    config.tailMs = options.tailMs;
+    InputReplayer replayer(config);
+    if (!replayer.run(recording.data(), recording.size())) {
+        fprintf(stderr, "%s: %s\n", options.recording, replayer.error().c_str());
+        return 1;
+    }
+    const ReplayReport& report = replayer.report();
+    if (report.truncated) fprintf(stderr, "aviso: gravação cortada no fim (queda de energia?)\n");
+    if (report.lost) fprintf(stderr, "aviso: %u leituras do sensor perdidas na gravação\n", report.lost);
+
+    if (options.report) {
+        FILE* file = fopen(options.report, "w");
+        if (!file) {
+            fprintf(stderr, "Relatório %s não abriu para escrita\n", options.report);
+            return 1;
+        }
+        writeReplayReport(file, report);
+        fclose(file);
+    } else if (!options.base) {
+        writeReplayReport(stdout, report);
+    }
+    fprintf(stderr, "%s: %u eventos, %.1f s virtuais, %zu saídas, %zu comandos, passo p99 %.1f us\n",
+            options.recording, report.events, report.durationMs / 1000.0, report.outputs.size(),
+            report.commands.size(), report.stepP99Ns / 1000.0);
+    return options.base ? compare(base, report, options) : 0;
+}
+
+int runDiff(const Options& options) {
+    ReplayReport a;
+    ReplayReport b;
+    if (!readReport(options.diffA, a) || !readReport(options.diffB, b)) return 1;
+    return compare(a, b, options);
+}
+
+uint32_t readU32(const uint8_t* in) {
+    return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+}
+
+// Pede a gravação com GRAVACAO e junta os blocos de .../gravacao pelo offset
+int runDownload(const Options& options) {
+    if (!MqttTopics::fits(options.download)) {
+        fprintf(stderr, "Id %s maior que o máximo\n", options.download);
+        return 2;
+    }
+    MqttTopics topics(options.download);
+    std::string output = options.output ? options.output : std::string("gravacao-") + options.download + ".bin";
+
+    std::map<uint32_t, std::vector<uint8_t>> chunks;
+    uint32_t total = UINT32_MAX;
+    size_t received = 0;
+
+    WiFi.hostReset();
+    WiFi.hostUseRealNetwork(true);
+    WiFi.begin(nullptr, nullptr);
+    WiFiClient socket;
+    PubSubClient client(socket);
+    client.setServer(options.broker, options.port);
+    client.setBufferSize(uint16_t(MQTT_MAX_PACKET_SIZE));
+    client.setCallback([&](char*, byte* payload, unsigned int length) {
+        if (length < InputRecorder::CHUNK_HEADER_BYTES) return;
+        uint32_t offset = readU32(payload);
+        total = readU32(payload + 4);
+        std::vector<uint8_t>& chunk = chunks[offset];
+        if (chunk.empty()) received += length - InputRecorder::CHUNK_HEADER_BYTES;
+        chunk.assign(payload + InputRecorder::CHUNK_HEADER_BYTES, payload + length);
+    });
+    if (!socket.connect(options.broker, options.port, MQTT_CONNECT_TIMEOUT)
+        || !client.connect("reproducao_gravacao", options.user, options.password)
+        || !client.subscribe(topics.recording)) {
+        fprintf(stderr, "Sem conexão com %s:%u (estado %d)\n", options.broker, options.port, client.state());
+        return 1;
+    }
+    char command[96];
+    snprintf(command, sizeof(command), "{\"comando\":\"GRAVACAO\",\"parametros\":{\"anterior\":%s}}",
+             options.previous ? "true" : "false");
+    if (!client.publish(topics.command, command)) {
+        fprintf(stderr, "Falha ao publicar em %s\n", topics.command);
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    uint32_t idleMs = 0;
+    while (received < total && idleMs < DOWNLOAD_TIMEOUT_MS) {
+        size_t before = received;
+        HostClock::advanceMillis(STEP_MS);
+        client.loop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(STEP_MS));
+        idleMs = received > before ? 0 : idleMs + STEP_MS;
+    }
+    if (received < total) {
+        fprintf(stderr, "%s não respondeu: %zu de %s bytes\n", options.download, received,
+                total == UINT32_MAX ? "?" : std::to_string(total).c_str());
+        return 1;
+    }
+    if (total == 0) {
+        fprintf(stderr, "%s sem gravação (gravador desligado ou nenhum boot anterior)\n", options.download);
+        return 1;
+    }
+
+    FILE* file = fopen(output.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "%s não abriu para escrita\n", output.c_str());
+        return 1;
+    }
+    for (const auto& chunk : chunks) fwrite(chunk.second.data(), 1, chunk.second.size(), file);
+    fclose(file);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    printf("%s: %u bytes em %zu blocos (%.1f s)\n", output.c_str(), total, chunks.size(), seconds);
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    static const option OPTIONS[] = {
+        {"relatorio", required_argument, nullptr, 'r'},
+        {"comparar", required_argument, nullptr, 'c'},
+        {"diferenca", required_argument, nullptr, 'd'},
+        {"tolerancia", required_argument, nullptr, 't'},
+        {"cauda", required_argument, nullptr, 'e'},
+        {"baixar", required_argument, nullptr, 'g'},
+        {"anterior", no_argument, nullptr, 'a'},
+        {"saida", required_argument, nullptr, 'o'},
+        {"broker", required_argument, nullptr, 'b'},
+        {"usuario", required_argument, nullptr, 'u'},
+        {"senha", required_argument, nullptr, 'p'},
+        {"ajuda", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    Options options;
+    static char host[256];
+    int option;
+    while ((option = getopt_long(argc, argv, "r:c:d:t:e:g:ao:b:u:p:h", OPTIONS, nullptr)) != -1) {
+        switch (option) {
+            case 'r': options.report = optarg; break;
+            case 'c': options.base = optarg; break;
+            case 'd': options.diffA = optarg; break;
+            case 't': options.tolerance = float(atof(optarg)); break;
+            case 'e': options.tailMs = uint32_t(atoi(optarg)); break;
+            case 'g': options.download = optarg; break;
+            case 'a': options.previous = true; break;
+            case 'o': options.output = optarg; break;
+            case 'b': {
+                strncpy(host, optarg, sizeof(host) - 1);
+                char* colon = strrchr(host, ':');
+                if (colon) {
+                    *colon = '\0';
+                    options.port = uint16_t(atoi(colon + 1));
+                }
+                options.broker = host;
+                break;
+            }
+            case 'u': options.user = optarg; break;
+            case 'p': options.password = optarg; break;
+            default:
+                usage(argv[0]);
+                return option == 'h' ? 0 : 2;
+        }
+    }
+    if (options.download) return runDownload(options);
+    if (options.diffA) {
+        if (optind >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        options.diffB = argv[optind];
+        return runDiff(options);
+    }
+    if (optind >= argc || options.tolerance < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    options.recording = argv[optind];
+    return runReplay(options);
+}
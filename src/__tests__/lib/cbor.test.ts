@@ -0,0 +1,31 @@
+import { decodeCbor, encodeCbor, isCborPayload } from '@/lib/cbor'
+
+const hex = (text: string) => Uint8Array.from(Buffer.from(text, 'hex'))
+
+describe('cbor', () => {
+  it('deve decodificar chaves inteiras pelo dicionário do firmware', () => {
+    expect(decodeCbor(hex('a104fa41bccccd'))).toEqual({ temperaturaAtual: 23.6 })
+  })
+
+  it('deve aceitar mapas de tamanho indefinido e chaves de texto', () => {
+    expect(decodeCbor(hex('bf0063414243ff'))).toEqual({ comando: 'ABC' })
+    expect(decodeCbor(hex('a1617801'))).toEqual({ x: 1 })
+  })
+
+  it('deve codificar comandos com as chaves do dicionário', () => {
+    const command = { comando: 'LIGAR', parametros: { temperatura: 22 } }
+    expect(Buffer.from(encodeCbor(command)).toString('hex')).toBe('a200654c4947415201a10a16')
+    expect(decodeCbor(encodeCbor(command))).toEqual(command)
+  })
+
+  it('deve distinguir CBOR de JSON pelo primeiro byte', () => {
+    expect(isCborPayload(hex('a0'))).toBe(true)
+    expect(isCborPayload(Buffer.from('{}'))).toBe(false)
+    expect(isCborPayload(new Uint8Array())).toBe(false)
+  })
+
+  it('deve rejeitar payload truncado ou com bytes sobrando', () => {
+    expect(() => decodeCbor(hex('a10463'))).toThrow('CBOR truncado')
+    expect(() => decodeCbor(hex('a0a0'))).toThrow('CBOR: bytes sobrando')
+  })
+})
@@ -211,6 +211,42 @@ describe('MQTTService', () => {
         expect.any(Function)
       )
     })
+
+    it('deve publicar comando em CBOR quando o dispositivo usa esse formato', async () => {
+      mockClient.publish.mockImplementation((topic, message, options, callback) => {
+        callback()
+      })
+
+      await mqttService.publishCommand('device123', { comando: 'LIGAR', parametros: { temperatura: 22 } }, 'CBOR')
+
+      expect(mockClient.publish).toHaveBeenCalledWith(
+        'comando/device123',
+        Buffer.from('a200654c4947415201a10a16', 'hex'),
+        { qos: 1 },
+        expect.any(Function)
+      )
+    })
+  })
+
+  describe('message', () => {
+    beforeEach(async () => {
+      const connectPromise = mqttService.connect()
+      setTimeout(() => {
+        mockClient.connected = true
+        mockClient.emit('connect')
+      }, 10)
+      await connectPromise
+    })
+
+    it('deve entregar status CBOR como JSON', () => {
+      const listener = jest.fn()
+      mqttService.on('message', listener)
+
+      mockClient.emit('message', 'status/device123', Buffer.from('a104fa41bccccd', 'hex'))
+
+      expect(listener).toHaveBeenCalledWith('status/device123', '{"temperaturaAtual":23.6}')
+      mqttService.off('message', listener)
+    })
   })
 })
 
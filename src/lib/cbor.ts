@@ -0,0 +1,295 @@
+// Codificação CBOR (RFC 8949) do status e dos comandos dos dispositivos.
+// O firmware troca os nomes das chaves por inteiros deste dicionário; a
+// ordem é a de esp32/lib/Codec/include/WireKeys.h e só cresce no fim.
+export const WIRE_KEYS = [
+  'comando',
+  'parametros',
+  'online',
+  'ligado',
+  'temperaturaAtual',
+  'umidade',
+  'temperaturaDesejada',
+  'modoOperacao',
+  'velocidadeVentilador',
+  'sensorStatus',
+  'temperatura',
+  'termostato',
+  'ativo',
+  'demanda',
+  'janela',
+  'min',
+  'max',
+  'media',
+  'amostras',
+  'agenda',
+  'versao',
+  'ativa',
+  'relogio',
+  'formato',
+  'modo',
+  'velocidade',
+  'histerese',
+  'minLigado',
+  'minDesligado',
+  'temperaturaMin',
+  'temperaturaMax',
+  'fuso',
+  'transicoes',
+] as const;
+
+export type WireFormat = 'JSON' | 'CBOR';
+
+const KEY_IDS = new Map<string, number>(WIRE_KEYS.map((name, id) => [name, id]));
+
+const BREAK = 0xff;
+const MAX_DEPTH = 16;
+
+// Um mapa CBOR começa em 0xA0-0xBF, bytes que nunca abrem um JSON
+export function isCborPayload(payload: Uint8Array): boolean {
+  return payload.length > 0 && (payload[0] & 0xe0) === 0xa0;
+}
+
+function halfToNumber(half: number): number {
+  const exponent = (half >> 10) & 0x1f;
+  const mantissa = half & 0x3ff;
+  let value: number;
+  if (exponent === 0) {
+    value = mantissa * Math.pow(2, -24);
+  } else if (exponent === 31) {
+    value = mantissa ? NaN : Infinity;
+  } else {
+    value = (mantissa + 1024) * Math.pow(2, exponent - 25);
+  }
+  return half & 0x8000 ? -value : value;
+}
+
+// O menor decimal que volta ao mesmo float (23.6, não 23.600000381...)
+function shortestFloat(value: number): number {
+  for (let digits = 1; digits < 9; digits++) {
+    const candidate = Number(value.toPrecision(digits));
+    if (Math.fround(candidate) === value) return candidate;
+  }
+  return value;
+}
+
+class Decoder {
+  private offset = 0;
+  private readonly view: DataView;
+
+  constructor(private readonly bytes: Uint8Array) {
+    this.view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  }
+
+  decode(): unknown {
+    const value = this.item(0);
+    if (this.offset !== this.bytes.length) throw new Error('CBOR: bytes sobrando');
+    return value;
+  }
+
+  private need(count: number): void {
+    if (this.offset + count > this.bytes.length) throw new Error('CBOR truncado');
+  }
+
+  private argument(info: number): number {
+    if (info < 24) return info;
+    if (info > 27) throw new Error('CBOR: informação adicional reservada');
+    const size = 1 << (info - 24);
+    this.need(size);
+    let value: number;
+    if (size === 1) value = this.view.getUint8(this.offset);
+    else if (size === 2) value = this.view.getUint16(this.offset);
+    else if (size === 4) value = this.view.getUint32(this.offset);
+    else value = this.view.getUint32(this.offset) * 2 ** 32 + this.view.getUint32(this.offset + 4);
+    this.offset += size;
+    return value;
+  }
+
+  private atBreak(): boolean {
+    this.need(1);
+    if (this.bytes[this.offset] !== BREAK) return false;
+    this.offset++;
+    return true;
+  }
+
+  private text(length: number): string {
+    this.need(length);
+    const text = new TextDecoder().decode(this.bytes.subarray(this.offset, this.offset + length));
+    this.offset += length;
+    return text;
+  }
+
+  private key(depth: number): string {
+    const key = this.item(depth);
+    if (typeof key === 'number') return WIRE_KEYS[key] ?? String(key);
+    if (typeof key === 'string') return key;
+    throw new Error('CBOR: chave de mapa inválida');
+  }
+
+  private item(depth: number): unknown {
+    if (depth > MAX_DEPTH) throw new Error('CBOR: aninhamento excessivo');
+    this.need(1);
+    const initial = this.bytes[this.offset++];
+    const major = initial >> 5;
+    const info = initial & 0x1f;
+    const indefinite = info === 31 && major >= 2 && major <= 5;
+
+    switch (major) {
+      case 0:
+        return this.argument(info);
+      case 1:
+        return -1 - this.argument(info);
+      case 2:
+      case 3: {
+        if (!indefinite) {
+          const length = this.argument(info);
+          if (major === 3) return this.text(length);
+          this.need(length);
+          const bytes = this.bytes.slice(this.offset, this.offset + length);
+          this.offset += length;
+          return bytes;
+        }
+        const chunks: unknown[] = [];
+        while (!this.atBreak()) {
+          if (this.bytes[this.offset] >> 5 !== major) throw new Error('CBOR: pedaço de tipo diferente');
+          chunks.push(this.item(depth + 1));
+        }
+        return major === 3 ? chunks.join('') : Uint8Array.from(chunks.flatMap((c) => Array.from(c as Uint8Array)));
+      }
+      case 4: {
+        const items: unknown[] = [];
+        if (indefinite) {
+          while (!this.atBreak()) items.push(this.item(depth + 1));
+        } else {
+          for (let count = this.argument(info); count > 0; count--) items.push(this.item(depth + 1));
+        }
+        return items;
+      }
+      case 5: {
+        const map: Record<string, unknown> = {};
+        if (indefinite) {
+          while (!this.atBreak()) {
+            const key = this.key(depth + 1);
+            map[key] = this.item(depth + 1);
+          }
+        } else {
+          for (let count = this.argument(info); count > 0; count--) {
+            const key = this.key(depth + 1);
+            map[key] = this.item(depth + 1);
+          }
+        }
+        return map;
+      }
+      case 6:
+        // Tags não mudam o significado para o protocolo
+        this.argument(info);
+        return this.item(depth + 1);
+      default:
+        break;
+    }
+
+    if (info === 20) return false;
+    if (info === 21) return true;
+    if (info === 22 || info === 23) return null;
+    if (info === 25) {
+      this.need(2);
+      const value = halfToNumber(this.view.getUint16(this.offset));
+      this.offset += 2;
+      return value;
+    }
+    if (info === 26) {
+      this.need(4);
+      const value = shortestFloat(this.view.getFloat32(this.offset));
+      this.offset += 4;
+      return value;
+    }
+    if (info === 27) {
+      this.need(8);
+      const value = this.view.getFloat64(this.offset);
+      this.offset += 8;
+      return value;
+    }
+    if (info < 24) return null;
+    if (info === 24) {
+      this.argument(info);
+      return null;
+    }
+    throw new Error('CBOR: item simples inválido');
+  }
+}
+
+// Decodifica um payload; as chaves do dicionário voltam a ser os nomes
+export function decodeCbor(payload: Uint8Array): unknown {
+  return new Decoder(payload).decode();
+}
+
+class Encoder {
+  private readonly bytes: number[] = [];
+
+  encode(value: unknown): Uint8Array {
+    this.item(value);
+    return Uint8Array.from(this.bytes);
+  }
+
+  private head(major: number, argument: number): void {
+    const type = major << 5;
+    if (argument < 24) {
+      this.bytes.push(type | argument);
+    } else if (argument <= 0xff) {
+      this.bytes.push(type | 24, argument);
+    } else if (argument <= 0xffff) {
+      this.bytes.push(type | 25, argument >> 8, argument & 0xff);
+    } else {
+      this.bytes.push(type | 26, (argument >>> 24) & 0xff, (argument >> 16) & 0xff, (argument >> 8) & 0xff, argument & 0xff);
+    }
+  }
+
+  private number(value: number): void {
+    if (Number.isInteger(value) && Math.abs(value) <= 0xffffffff) {
+      if (value >= 0) this.head(0, value);
+      else this.head(1, -1 - value);
+      return;
+    }
+    const view = new DataView(new ArrayBuffer(8));
+    if (Math.fround(value) === value || Number.isNaN(value)) {
+      view.setFloat32(0, value);
+      this.bytes.push(0xfa, ...new Uint8Array(view.buffer, 0, 4));
+    } else {
+      view.setFloat64(0, value);
+      this.bytes.push(0xfb, ...new Uint8Array(view.buffer));
+    }
+  }
+
+  private item(value: unknown): void {
+    if (value === null || value === undefined) {
+      this.bytes.push(0xf6);
+    } else if (typeof value === 'boolean') {
+      this.bytes.push(value ? 0xf5 : 0xf4);
+    } else if (typeof value === 'number') {
+      this.number(value);
+    } else if (typeof value === 'string') {
+      const text = new TextEncoder().encode(value);
+      this.head(3, text.length);
+      this.bytes.push(...text);
+    } else if (Array.isArray(value)) {
+      this.head(4, value.length);
+      value.forEach((element) => this.item(element));
+    } else if (typeof value === 'object') {
+      const entries = Object.entries(value as Record<string, unknown>).filter(([, v]) => v !== undefined);
+      this.head(5, entries.length);
+      for (const [key, element] of entries) {
+        const id = KEY_IDS.get(key);
+        if (id === undefined) this.item(key);
+        else this.head(0, id);
+        this.item(element);
+      }
+    } else {
+      throw new Error(`CBOR: tipo não suportado (${typeof value})`);
+    }
+  }
+}
+
+// Codifica um comando como o firmware espera: nomes do dicionário viram
+// inteiros, os demais seguem como texto
+export function encodeCbor(value: unknown): Uint8Array {
+  return new Encoder().encode(value);
+}
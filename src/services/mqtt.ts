@@ -1,6 +1,7 @@
 import mqtt, { IClientOptions, MqttClient, ClientSubscribeCallback } from 'mqtt';
 import { logger } from '@/lib/logger';
 import { EventEmitter } from 'events';
+import { decodeCbor, encodeCbor, isCborPayload, WireFormat } from '@/lib/cbor';
 
 
 
@@ -81,13 +82,27 @@ class MQTTService extends EventEmitter {
       });
 
       this.client.on('message', (topic: string, payload: Buffer) => {
-        this.emit('message', topic, payload.toString());
+        this.emit('message', topic, this.decodePayload(topic, payload));
       });
     });
 
     return this.connectionPromise;
   }
 
+  // Dispositivos com "formato":"CBOR" publicam binário; os ouvintes
+  // continuam recebendo o mesmo JSON em texto
+  private decodePayload(topic: string, payload: Buffer): string {
+    if (!isCborPayload(payload)) {
+      return payload.toString();
+    }
+    try {
+      return JSON.stringify(decodeCbor(payload));
+    } catch (error) {
+      logger.warn(`Payload CBOR inválido em ${topic}:`, error);
+      return payload.toString();
+    }
+  }
+
   private handleDisconnect() {
     this.client = null;
     this.connectionPromise = null;
@@ -135,12 +150,12 @@ class MQTTService extends EventEmitter {
     });
   }
 
-  public async publish(topic: string, message: string | object): Promise<void> {
+  public async publish(topic: string, message: string | Buffer | object): Promise<void> {
     if (!this.client?.connected) {
       throw new Error('Cliente MQTT não está conectado');
     }
     
-    const messageStr = typeof message === 'string' ? message : JSON.stringify(message);
+    const messageStr = typeof message === 'string' || Buffer.isBuffer(message) ? message : JSON.stringify(message);
     
     return new Promise((resolve, reject) => {
       this.client!.publish(topic, messageStr, { qos: 1 }, (error?: Error) => {
@@ -153,8 +168,17 @@ class MQTTService extends EventEmitter {
     });
   }
 
-  public async publishCommand(deviceId: string, command: Record<string, unknown>): Promise<void> {
+  // formato segue o campo "formato" do último status do dispositivo; ele
+  // aceita os dois, mas em CBOR o comando tem menos da metade dos bytes
+  public async publishCommand(
+    deviceId: string,
+    command: Record<string, unknown>,
+    formato: WireFormat = 'JSON'
+  ): Promise<void> {
     const topic = `comando/${deviceId}`;
+    if (formato === 'CBOR') {
+      return this.publish(topic, Buffer.from(encodeCbor(command)));
+    }
     return this.publish(topic, command);
   }
 }